@@ -6,6 +6,7 @@
 #include <kaze/core/AssetLoader.h>
 #include <kaze/core/CommandQueue.h>
 #include <kaze/core/concepts.h>
+#include <kaze/core/cpu.h>
 #include <kaze/core/ConditionalAction.h>
 #include <kaze/core/CStringView.h>
 #include <kaze/core/debug.h>
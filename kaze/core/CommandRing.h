@@ -0,0 +1,209 @@
+#pragma once
+#include <kaze/core/lib.h>
+#include <kaze/core/concepts.h>
+
+#include <atomic>
+#include <mutex>
+
+KAZE_NS_BEGIN
+
+template<typename T>
+class CommandRing;
+
+/// Fixed-capacity, single-producer / single-consumer command ring.
+///
+/// Commands are stored in place as a Variant inside a ring allocated once on construction, so pushing and
+/// processing never allocate or take a lock while the ring has room. One thread may call `pushCommand`, and one
+/// (other) thread may call `processCommands`.
+///
+/// Overflow policy: when the ring is full, commands spill into a mutex-guarded overflow list instead of being
+/// dropped, and every following push goes there too until the consumer has drained it, so command order is
+/// always preserved. The consumer only `try_lock`s the overflow list, so a realtime consumer never blocks; the
+/// spilled commands are picked up on a later call instead. Spills are counted in `Stats::overflowed` - if that
+/// number is non-zero, the ring capacity is too small for the workload. A realtime producer uses
+/// `tryPushCommand` instead, which refuses a command that does not fit rather than lock, and keeps it to retry.
+///
+/// \tparam TArgs  The types of commands this ring supports. Each command type must have a default
+///                function operator(). Command functions must not push to the same ring.
+template <PlainFunctor...TArgs>
+class CommandRing< Variant<TArgs...> >
+{
+public:
+    /// Combined command variant
+    using Command = Variant<TArgs...>;
+
+    /// Default number of command slots
+    static constexpr Size DefaultCapacity = 4096;
+
+    /// Counters for diagnostics. Values are cumulative since construction.
+    struct Stats {
+        Uint64 pushed;     ///< total commands pushed
+        Uint64 processed;  ///< total commands executed by the consumer
+        Uint64 overflowed; ///< commands that did not fit into the ring and were spilled to the overflow list
+        Size   highWater;  ///< greatest number of commands that were waiting in the ring at once
+        Size   capacity;   ///< number of slots in the ring
+    };
+
+    /// \param[in]  capacity  number of command slots; rounded up to the next power of two
+    explicit CommandRing(Size capacity = DefaultCapacity) :
+        m_slots(roundCapacity(capacity)), m_mask(m_slots.size() - 1)
+    { }
+
+    KAZE_NO_COPY(CommandRing);
+
+    /// Push a command. Producer thread only.
+    template<PlainFunctor T> requires std::disjunction_v<std::is_same<T, TArgs>...>
+    auto pushCommand(const T &cmd) -> void
+    {
+        m_pushed.fetch_add(1, std::memory_order_relaxed);
+        if (pushToRing(cmd))
+            return;
+
+        // Ring is full, or earlier commands are still waiting in the overflow list
+        const auto lockGuard = std::lock_guard(m_overflowMutex);
+        m_overflow.emplace_back(cmd);
+        m_overflowCount.fetch_add(1, std::memory_order_release);
+        m_overflowed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Push a command only if it fits into the ring. Never locks or allocates, so a realtime producer can use it
+    /// in place of `pushCommand`. Producer thread only.
+    /// \param[in]  cmd  command to push
+    /// \returns whether the command was pushed; if not, the ring is full or spilled commands are still waiting,
+    ///          and the caller should hold on to the command and try again later.
+    template<PlainFunctor T> requires std::disjunction_v<std::is_same<T, TArgs>...>
+    auto tryPushCommand(const T &cmd) -> Bool
+    {
+        if ( !pushToRing(cmd) )
+            return False;
+
+        m_pushed.fetch_add(1, std::memory_order_relaxed);
+        return True;
+    }
+
+    /// Execute and remove all commands currently in the ring. Consumer thread only.
+    /// Spilled commands are executed afterward if the overflow list can be locked without waiting.
+    auto processCommands() -> void
+    {
+        auto processed = drainRing();
+
+        if (m_overflowCount.load(std::memory_order_acquire) > 0)
+        {
+            const auto lock = std::unique_lock(m_overflowMutex, std::try_to_lock);
+            if (lock.owns_lock())
+                processed += drainOverflow();
+        }
+
+        m_processed.fetch_add(processed, std::memory_order_relaxed);
+    }
+
+    /// Drain every command, waiting on the overflow list if needed. For use when the consumer thread
+    /// is known to be stopped (e.g. on shutdown), or by the consumer when blocking is acceptable.
+    auto processCommandsBlocking() -> void
+    {
+        auto processed = drainRing();
+
+        const auto lockGuard = std::lock_guard(m_overflowMutex);
+        processed += drainOverflow();
+
+        m_processed.fetch_add(processed, std::memory_order_relaxed);
+    }
+
+    /// \returns number of commands waiting to be processed, including spilled ones (approximate while in use)
+    [[nodiscard]]
+    auto size() const noexcept -> Size
+    {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire) +
+            m_overflowCount.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]]
+    auto capacity() const noexcept -> Size { return m_slots.size(); }
+
+    [[nodiscard]]
+    auto getStats() const noexcept -> Stats
+    {
+        return {
+            .pushed = m_pushed.load(std::memory_order_relaxed),
+            .processed = m_processed.load(std::memory_order_relaxed),
+            .overflowed = m_overflowed.load(std::memory_order_relaxed),
+            .highWater = m_highWater.load(std::memory_order_relaxed),
+            .capacity = m_slots.size(),
+        };
+    }
+
+private:
+    /// \returns whether the command went into the ring, which it may not while spilled commands are waiting
+    template<PlainFunctor T>
+    auto pushToRing(const T &cmd) -> Bool
+    {
+        if (m_overflowCount.load(std::memory_order_acquire) != 0)
+            return False;
+
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        const auto head = m_head.load(std::memory_order_acquire);
+        const auto used = tail - head;
+        if (used >= m_slots.size())
+            return False;
+
+        m_slots[tail & m_mask] = cmd;
+        m_tail.store(tail + 1, std::memory_order_release);
+
+        if (used + 1 > m_highWater.load(std::memory_order_relaxed))
+            m_highWater.store(used + 1, std::memory_order_relaxed);
+        return True;
+    }
+
+    auto drainRing() -> Uint64
+    {
+        const auto tail = m_tail.load(std::memory_order_acquire);
+        const auto begin = m_head.load(std::memory_order_relaxed);
+        for (auto head = begin; head != tail; ++head)
+        {
+            std::visit([](auto &command) { command(); }, m_slots[head & m_mask]);
+            m_head.store(head + 1, std::memory_order_release);
+        }
+
+        return tail - begin;
+    }
+
+    /// Overflow mutex must be held
+    auto drainOverflow() -> Uint64
+    {
+        // Commands that entered the ring before the first spill must run first. The producer stops writing
+        // to the ring while anything is spilled, so one more pass catches all of them.
+        auto processed = drainRing();
+
+        for (auto &command : m_overflow)
+            std::visit([](auto &cmd) { cmd(); }, command);
+        processed += m_overflow.size();
+        m_overflow.clear();
+        m_overflowCount.store(0, std::memory_order_release);
+        return processed;
+    }
+
+    static auto roundCapacity(Size capacity) -> Size
+    {
+        Size result = 2;
+        while (result < capacity)
+            result <<= 1;
+        return result;
+    }
+
+    static constexpr Size CacheLine = 64;
+
+    List<Command> m_slots;
+    Size m_mask;
+
+    alignas(CacheLine) std::atomic<Size> m_head{};   ///< next slot to read, written by consumer
+    alignas(CacheLine) std::atomic<Size> m_tail{};   ///< next slot to write, written by producer
+    std::atomic<Size> m_highWater{};
+
+    alignas(CacheLine) std::atomic<Size> m_overflowCount{};
+    List<Command> m_overflow{};
+    std::mutex m_overflowMutex{};
+
+    std::atomic<Uint64> m_pushed{}, m_processed{}, m_overflowed{};
+};
+
+KAZE_NS_END
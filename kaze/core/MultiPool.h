@@ -56,13 +56,12 @@ public:
         std::lock_guard lockGuard(m_mutex);
 
         PoolBase *pool = &getPool<T>();
-        const auto elemSize = static_cast<uint32_t>(pool->elemSize());
 
         // Allocate new entity
         PoolID id = pool->allocate();
         try {
             // Init the newly retrieved entity
-            ((T *)(pool->data() + id.index * elemSize))->init_(std::forward<TArgs>(args)...); // `T` poolable must implement `init`
+            ((T *)pool->get(id))->init_(std::forward<TArgs>(args)...); // `T` poolable must implement `init`
         }
         catch (const std::exception &err) { // init threw an exception, deallocate
             KAZE_PUSH_ERR(Error::RuntimeErr, "Exception was thrown during Handle<{}>::allocate in object's ctor: {}",
@@ -11,8 +11,9 @@ PoolID::operator bool() const
 }
 
 PoolBase::PoolBase(const Size elemSize) :
-    m_memory(),
-    m_meta(),
+    m_chunks(),
+    m_metaChunks(),
+    m_chunkCount(),
     m_size(),
     m_nextFree(),
     m_elemSize(elemSize), // match byte alignment
@@ -21,12 +22,15 @@ PoolBase::PoolBase(const Size elemSize) :
     m_nextFree = SIZE_MAX;
 }
 
-PoolBase::PoolBase(PoolBase &&other) noexcept : m_memory(other.m_memory), m_meta(other.m_meta), m_size(other.m_size),
+PoolBase::PoolBase(PoolBase &&other) noexcept : m_chunks(other.m_chunks), m_metaChunks(other.m_metaChunks),
+    m_chunkCount(other.m_chunkCount), m_size(other.m_size.load(std::memory_order_relaxed)),
     m_nextFree(other.m_nextFree), m_elemSize(other.m_elemSize), m_idCounter(other.m_idCounter)
 {
-    other.m_memory = nullptr;
-    other.m_meta = nullptr;
+    other.m_chunks = {};
+    other.m_metaChunks = {};
+    other.m_chunkCount = 0;
     other.m_size = 0;
+    other.m_nextFree = SIZE_MAX;
 }
 
 PoolBase &PoolBase::operator=(PoolBase &&other) noexcept
@@ -34,19 +38,25 @@ PoolBase &PoolBase::operator=(PoolBase &&other) noexcept
     if (this != &other)
     {
         // clean up existing memory
-        memory::free(m_memory);
-        memory::free(m_meta);
-
-        m_memory = other.m_memory;
-        m_meta = other.m_meta;
-        m_size = other.m_size;
+        for (Size i = 0; i < m_chunkCount; ++i)
+        {
+            memory::free(m_chunks[i]);
+            memory::free(m_metaChunks[i]);
+        }
+
+        m_chunks = other.m_chunks;
+        m_metaChunks = other.m_metaChunks;
+        m_chunkCount = other.m_chunkCount;
+        m_size = other.m_size.load(std::memory_order_relaxed);
         m_nextFree = other.m_nextFree;
         m_elemSize = other.m_elemSize;
         m_idCounter = other.m_idCounter;
 
-        other.m_memory = nullptr;
-        other.m_meta = nullptr;
+        other.m_chunks = {};
+        other.m_metaChunks = {};
+        other.m_chunkCount = 0;
         other.m_size = 0;
+        other.m_nextFree = SIZE_MAX;
     }
 
     return *this;
@@ -54,32 +64,35 @@ PoolBase &PoolBase::operator=(PoolBase &&other) noexcept
 
 PoolBase::~PoolBase()
 {
-    memory::free(m_memory);
-    memory::free(m_meta);
+    for (Size i = 0; i < m_chunkCount; ++i)
+    {
+        memory::free(m_chunks[i]);
+        memory::free(m_metaChunks[i]);
+    }
 }
 
 PoolID PoolBase::allocate()
 {
     if (isFull())
     {
-        const auto lastSize = m_size;
-        expand(lastSize * 2 + 1);
+        const auto lastSize = maxSize();
+        expand(lastSize + 1);
 
         m_nextFree = lastSize;
     }
 
-    auto &meta = m_meta[m_nextFree];
-    m_nextFree = meta.nextFree;
-    meta.id.id = m_idCounter++;
+    auto &slotMeta = meta(m_nextFree);
+    m_nextFree = slotMeta.nextFree;
+    slotMeta.id.id = m_idCounter++;
 
-    return meta.id;
+    return slotMeta.id;
 }
 
 void PoolBase::reserve(Size size)
 {
-    const auto lastSize = m_size;
+    const auto lastSize = maxSize();
     expand(size);
-    if (m_nextFree == SIZE_MAX)
+    if (m_nextFree == SIZE_MAX && maxSize() > lastSize)
         m_nextFree = lastSize;
 }
 
@@ -88,36 +101,42 @@ void PoolBase::deallocate(const PoolID &id)
     if (!isValid(id))
         return;
 
-    auto &meta = m_meta[id.index];
-    meta.nextFree = m_nextFree;
-    meta.id.id = SIZE_MAX;
+    auto &slotMeta = meta(id.index);
+    slotMeta.nextFree = m_nextFree;
+    slotMeta.id.id = SIZE_MAX;
     m_nextFree = id.index;
 }
 
 auto PoolBase::tryFind(void *ptr, PoolID *outID) const -> Bool
 {
-    if (ptr < m_memory || ptr >= m_memory + m_elemSize * m_size)
-        return false;
-    const auto index = ((char *)ptr - m_memory) / m_elemSize;
+    for (Size chunk = 0; chunk < m_chunkCount; ++chunk)
+    {
+        const auto begin = m_chunks[chunk];
+        if (ptr < begin || ptr >= begin + m_elemSize * chunkSize(chunk))
+            continue;
+
+        const auto offset = static_cast<Size>((char *)ptr - begin) / m_elemSize;
+        if (outID)
+            *outID = m_metaChunks[chunk][offset].id;
+        return true;
+    }
 
-    if (outID)
-        *outID = m_meta[index].id;
-    return true;
+    return false;
 }
 
 auto PoolBase::clear() -> void
 {
-    const auto size = m_size;
+    const auto size = maxSize();
     if (size == 0) return;
 
     for (Size i = 0; i < size; ++i)
     {
-        auto &meta = m_meta[i];
-        meta.id.id = SIZE_MAX;
-        meta.nextFree = i + 1;
+        auto &slotMeta = meta(i);
+        slotMeta.id.id = SIZE_MAX;
+        slotMeta.nextFree = i + 1;
     }
 
-    m_meta[size - 1].nextFree = SIZE_MAX;
+    meta(size - 1).nextFree = SIZE_MAX;
     m_nextFree = 0;
 }
 
@@ -2,6 +2,10 @@
 
 #include <kaze/core/lib.h>
 #include <kaze/core/memory.h>
+#include <kaze/core/debug.h>
+
+#include <atomic>
+#include <bit>
 
 KAZE_NS_BEGIN
 
@@ -33,6 +37,10 @@ struct PoolID {
 /// Abstract class.
 /// Stores fixed blocks of memory, expanding when full capacity is reached.
 /// This class is intended to be a generic base to group pools under.
+///
+/// Storage is split into chunks that double in size, and chunks are never reallocated, so the address of a
+/// slot stays the same for the lifetime of the pool. This lets one thread read objects that are already in
+/// the pool (e.g. the audio thread) while another thread allocates new ones.
 /// \note Use Pool<T> for type-safe pools.
 class PoolBase {
 public:
@@ -63,26 +71,29 @@ public:
     /// Check if an id returned from `allocate` is valid. Does not differentiate between ids from other pools,
     /// so user must make sure that PoolID is from the correct pool.
     [[nodiscard]]
-    auto isValid(const PoolID &id) const -> Bool { return id.index < m_size && m_meta[id.index].id.id == id.id; }
+    auto isValid(const PoolID &id) const -> Bool
+    {
+        return id.index < m_size.load(std::memory_order_acquire) && meta(id.index).id.id == id.id;
+    }
 
-    /// Users of the pool should access memory via this function instead of caching pointers long-term
-    /// as memory resizing can cause pointers to become invalidated should the pool be dynamically resized.
-    /// Returns `nullptr` if id is invalid
+    /// Get a pointer to a slot. The address remains stable even when the pool expands.
+    /// Does not check the validity of `id`.
     auto get(const PoolID &id) -> void *
     {
-        return m_memory + id.index * m_elemSize;
+        return slot(id.index);
     }
 
     auto tryFind(void *ptr, PoolID *outID) const -> Bool;
 
+    /// Returns `nullptr` if id is invalid
     [[nodiscard]]
     auto get(const PoolID &id) const -> const void *
     {
-        return isValid(id) ? m_memory + id.index * m_elemSize : nullptr;
+        return isValid(id) ? slot(id.index) : nullptr;
     }
 
     [[nodiscard]]
-    auto maxSize() const -> Size { return m_size; }
+    auto maxSize() const -> Size { return m_size.load(std::memory_order_acquire); }
 
     /// Size of one element in the pool
     [[nodiscard]]
@@ -92,14 +103,6 @@ public:
     /// Does not run any cleanup logic, though - please make sure to clean up memory before calling clear.
     auto clear() -> void;
 
-    /// Raw memory
-    [[nodiscard]]
-    auto data() -> char * { return m_memory; }
-
-    /// Raw memory
-    [[nodiscard]]
-    auto data() const -> const char * { return m_memory; }
-
     // /// DO NOT USE. All handles become invalidated, and there is no solution yet.
     // /// \param newSize    size to shrink to; if less than `aliveCount()`, it will use the alive count.
     // /// \param outIndices map containing inner id keys to their updated indices. (optional)
@@ -113,20 +116,51 @@ protected:
         Size nextFree;
     };
 
+    /// Number of slots in the first chunk, each following chunk is twice the size of the last
+    static constexpr Size FirstChunkSize = 16;
+    static constexpr Size MaxChunks = 40;
+
+    /// \returns the number of slots in chunk `chunk`
+    static constexpr auto chunkSize(const Size chunk) -> Size { return FirstChunkSize << chunk; }
+
+    /// \returns the index of the first slot in chunk `chunk`
+    static constexpr auto chunkBegin(const Size chunk) -> Size { return FirstChunkSize * ((Size(1) << chunk) - 1); }
+
+    /// \returns the chunk containing slot `index`
+    static constexpr auto chunkOf(const Size index) -> Size
+    {
+        return static_cast<Size>(std::bit_width(index / FirstChunkSize + 1)) - 1;
+    }
+
+    [[nodiscard]]
+    auto slot(const Size index) const -> char *
+    {
+        const auto chunk = chunkOf(index);
+        return m_chunks[chunk] + (index - chunkBegin(chunk)) * m_elemSize;
+    }
+
+    [[nodiscard]]
+    auto meta(const Size index) const -> Meta &
+    {
+        const auto chunk = chunkOf(index);
+        return m_metaChunks[chunk][index - chunkBegin(chunk)];
+    }
+
     /// Check if pool is currently filled to maximum capacity
     [[nodiscard]] bool isFull() const;
 
     virtual void expand(Size newSize) = 0;
 
-    char *m_memory;               ///< pointer to storage
-    Meta *m_meta;                 ///< contains information on a slot of memory
-    Size m_size;                ///< current pool size
-    Size m_nextFree;            ///< next free pool index
-    Size m_elemSize;            ///< size of each memory block
-    Size m_idCounter;           ///< next id to set on `allocate`
+    Array<char *, MaxChunks> m_chunks;     ///< slot storage, one block per chunk
+    Array<Meta *, MaxChunks> m_metaChunks; ///< contains information on a slot of memory, one block per chunk
+    Size m_chunkCount;                     ///< number of allocated chunks
+    std::atomic<Size> m_size;              ///< current pool size
+    Size m_nextFree;                       ///< next free pool index
+    Size m_elemSize;                       ///< size of each memory block
+    Size m_idCounter;                      ///< next id to set on `allocate`
 };
 
-// Implements type safety for non-trivial data types by calling move constructor on memory reallocation
+// Implements type safety for non-trivial data types by calling constructors and destructors on pool slots
 template <Poolable T>
 class Pool final : public PoolBase {
 public:
@@ -145,7 +179,7 @@ public:
             PoolBase::operator=(std::move(other));
         }
 
-        return this;
+        return *this;
     }
 
     ~Pool() override
@@ -153,54 +187,52 @@ public:
         cleanup();
     }
 
+    /// Adds chunks until the pool holds at least `newSize` slots. Existing slots are not moved.
     void expand(Size newSize) override
     {
-        const auto lastSize = m_size;
+        const auto lastSize = m_size.load(std::memory_order_relaxed);
         if (lastSize >= newSize) // no need to expand if new size isn't greater
             return;
 
-        if (m_memory == nullptr)
+        auto size = lastSize;
+        while (size < newSize)
         {
-            m_memory = (char *)std::malloc(newSize * sizeof(T));
-            m_meta = (Meta *)std::malloc(newSize * sizeof(Meta));
-        }
-        else
-        {
-            auto temp = (char *)memory::alloc(newSize * sizeof(T));
+            KAZE_ASSERT(m_chunkCount < MaxChunks, "Pool exceeded its maximum number of chunks");
 
-            for (T *ptr = (T *)m_memory, *end = (T *)m_memory + lastSize, *target = (T *)temp; ptr != end; ++ptr, ++target)
-            {
-                new (target) T(std::move(*ptr));
-                ptr->~T();
-            }
+            const auto chunk = m_chunkCount;
+            const auto begin = chunkBegin(chunk);
+            const auto count = chunkSize(chunk);
 
-            memory::free(m_memory);
-            m_memory = temp;
+            auto memory = (char *)memory::alloc(count * sizeof(T));
+            auto meta = (Meta *)memory::alloc(count * sizeof(Meta));
 
-            auto metaTemp = (Meta *)memory::alloc(newSize * sizeof(Meta));
-            memory::copy(metaTemp, m_meta, lastSize * sizeof(Meta));
-            memory::free(m_meta);
-            m_meta = metaTemp;
-        }
+            // TODO: unroll these loops?
+            // Initialize objects in new indices
+            for (Size i = 0; i < count; ++i)
+            {
+                new (meta + i) Meta(PoolID(begin + i, SIZE_MAX), begin + i + 1);
+                new ((T *)memory + i) T();
+            }
 
-        // TODO: unroll these loops?
-        // Initialize objects in new indices
-        for (Size i = lastSize; i < newSize; ++i)
-        {
-            new (m_meta + i) Meta(PoolID(i, SIZE_MAX), i+1);
-            new ((T *)m_memory + i) T();
+            m_chunks[chunk] = memory;
+            m_metaChunks[chunk] = meta;
+            ++m_chunkCount;
+            size = begin + count;
         }
 
-        m_meta[newSize - 1].nextFree = SIZE_MAX;
-        m_size = newSize;
+        meta(size - 1).nextFree = SIZE_MAX;
+        m_size.store(size, std::memory_order_release);
     }
 
 private:
     void cleanup()
     {
-        for (auto ptr = (T *)m_memory, end = (T *)m_memory + m_size; ptr != end; ++ptr)
+        for (Size chunk = 0; chunk < m_chunkCount; ++chunk)
         {
-            ptr->~T();
+            for (auto ptr = (T *)m_chunks[chunk], end = ptr + chunkSize(chunk); ptr != end; ++ptr)
+            {
+                ptr->~T();
+            }
         }
     }
 };
@@ -0,0 +1,77 @@
+#include "cpu.h"
+#include <kaze/core/intrinsics.h>
+
+#if KAZE_CPU_SSE && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+KAZE_NS_BEGIN
+
+namespace cpu {
+
+#if KAZE_CPU_SSE
+    /// Query cpuid leaf `leaf`, sub-leaf `subLeaf`, into eax, ebx, ecx, edx
+    static auto cpuid(const Uint leaf, const Uint subLeaf, Uint (&regs)[4]) noexcept -> void
+    {
+    #if defined(_MSC_VER)
+        int result[4];
+        __cpuidex(result, static_cast<int>(leaf), static_cast<int>(subLeaf));
+        for (int i = 0; i < 4; ++i)
+            regs[i] = static_cast<Uint>(result[i]);
+    #else
+        __asm__ __volatile__ ("cpuid"
+            : "=a"(regs[0]), "=b"(regs[1]), "=c"(regs[2]), "=d"(regs[3])
+            : "a"(leaf), "c"(subLeaf));
+    #endif
+    }
+
+    /// \returns the extended control register XCR0, which tells which register states the OS saves
+    static auto xgetbv0() noexcept -> Uint64
+    {
+    #if defined(_MSC_VER)
+        return _xgetbv(0);
+    #else
+        Uint eax, edx;
+        __asm__ __volatile__ ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (static_cast<Uint64>(edx) << 32) | eax;
+    #endif
+    }
+#endif
+
+    static auto detect() noexcept -> Features
+    {
+        Features features{};
+#if KAZE_CPU_SSE
+        Uint regs[4];
+        cpuid(0, 0, regs);
+        const auto maxLeaf = regs[0];
+
+        cpuid(1, 0, regs);
+        features.sse41 = (regs[2] & (1U << 19)) != 0;
+        features.fma = (regs[2] & (1U << 12)) != 0;
+
+        // AVX is only usable if the OS saves the xmm and ymm registers on context switch
+        const auto osxsave = (regs[2] & (1U << 27)) != 0;
+        const auto ymmSaved = osxsave && (xgetbv0() & 0x6) == 0x6;
+        features.avx = ymmSaved && (regs[2] & (1U << 28)) != 0;
+        features.fma = features.fma && features.avx;
+
+        if (maxLeaf >= 7)
+        {
+            cpuid(7, 0, regs);
+            features.avx2 = features.avx && (regs[1] & (1U << 5)) != 0;
+        }
+#elif KAZE_CPU_ARM_NEON
+        features.neon = True;
+#endif
+        return features;
+    }
+
+    auto getFeatures() noexcept -> const Features &
+    {
+        static const Features features = detect();
+        return features;
+    }
+}
+
+KAZE_NS_END
@@ -0,0 +1,25 @@
+/// \file cpu.h
+/// Runtime CPU feature detection
+#pragma once
+#include <kaze/core/lib.h>
+
+KAZE_NS_BEGIN
+
+namespace cpu {
+
+    /// Instruction set extensions supported by the CPU the program is running on. Unlike the compile-time
+    /// `KAZE_CPU_*` macros in intrinsics.h, these tell whether code built for a wider instruction set may run.
+    struct Features {
+        Bool sse41; ///< x86 SSE4.1
+        Bool avx;   ///< x86 AVX, with OS support for saving ymm registers
+        Bool avx2;  ///< x86 AVX2, with OS support for saving ymm registers
+        Bool fma;   ///< x86 FMA3
+        Bool neon;  ///< ARM NEON
+    };
+
+    /// Get the features of the running CPU. Detected once on first call; thread-safe.
+    [[nodiscard]]
+    auto getFeatures() noexcept -> const Features &;
+}
+
+KAZE_NS_END
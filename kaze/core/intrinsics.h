@@ -20,11 +20,16 @@
 #   elif defined(__EMSCRIPTEN__) // WASM SIMD
 #       define KAZE_CPU_WASM_SIMD 1
 #       include <wasm_simd128.h>
-#   elif defined(__AVX__)        // Intel
-#       define KAZE_CPU_AVX 1
-#       include <immintrin.h>
-#   elif defined(__SSE__)        // Intel
+#   elif defined(__SSE__) || defined(_M_X64) || defined(_M_IX86) // Intel
+        // AVX builds are still SSE builds: every x86 path relies on KAZE_CPU_SSE as its baseline, and wider
+        // kernels are picked at runtime (see `cpu::getFeatures`)
 #       define KAZE_CPU_SSE 1
+#       if defined(__AVX__)
+#           define KAZE_CPU_AVX 1
+#       endif
+#       if defined(__AVX2__)
+#           define KAZE_CPU_AVX2 1
+#       endif
 #       include <immintrin.h>
 #   endif
 
@@ -43,6 +48,18 @@
 #   define KAZE_CPU_AVX 0
 #endif
 
+#if !defined(KAZE_CPU_AVX2)
+#   define KAZE_CPU_AVX2 0
+#endif
+
 #if !defined(KAZE_CPU_SSE)
 #   define KAZE_CPU_SSE 0
 #endif
+
+/// Marks a function to be compiled for AVX2, regardless of the build's target architecture.
+/// Only call such functions after checking `cpu::getFeatures().avx2`.
+#if KAZE_CPU_SSE && (defined(__GNUC__) || defined(__clang__))
+#   define KAZE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#   define KAZE_TARGET_AVX2
+#endif
@@ -0,0 +1,163 @@
+#include "MappedFile.h"
+
+#include <kaze/core/debug.h>
+#include <kaze/core/io/io.h>
+#include <kaze/core/memory.h>
+#include <kaze/core/platform/defines.h>
+
+#if KAZE_PLATFORM_WINDOWS
+#include <windows.h>
+#elif !KAZE_PLATFORM_EMSCRIPTEN
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+KAZE_NS_BEGIN
+
+/// Map a whole file read-only
+/// \returns the mapping, or `nullptr` if the file could not be mapped; no error is pushed, since the caller falls
+///          back to loading the file
+static auto mapFile(const StringView filepath, Size *outSize) -> Ubyte *
+{
+    const auto path = String(filepath.data(), filepath.size()); // ensure null-termination
+#if KAZE_PLATFORM_WINDOWS
+    const auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    LARGE_INTEGER fileSize;
+    if ( !GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0 )
+    {
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    // The view keeps the file open, so both handles may be closed right away
+    const auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if ( !mapping )
+        return nullptr;
+
+    const auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if ( !view )
+        return nullptr;
+
+    *outSize = static_cast<Size>(fileSize.QuadPart);
+    return static_cast<Ubyte *>(view);
+#elif KAZE_PLATFORM_EMSCRIPTEN
+    // The virtual file system has no pages to map lazily
+    return nullptr;
+#else
+    const auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat info{};
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0)
+    {
+        ::close(fd);
+        return nullptr;
+    }
+
+    // The mapping keeps the file open, so the descriptor may be closed right away
+    const auto view = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED)
+        return nullptr;
+
+    *outSize = static_cast<Size>(info.st_size);
+    return static_cast<Ubyte *>(view);
+#endif
+}
+
+static auto unmapFile([[maybe_unused]] Ubyte *data, [[maybe_unused]] const Size size) -> void
+{
+#if KAZE_PLATFORM_WINDOWS
+    UnmapViewOfFile(data);
+#elif !KAZE_PLATFORM_EMSCRIPTEN
+    ::munmap(data, size);
+#endif
+}
+
+MappedFile::MappedFile() : m_data(), m_dataSize(), m_isMapped() { }
+
+MappedFile::MappedFile(const StringView filepath) : m_data(), m_dataSize(), m_isMapped()
+{
+    open(filepath);
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept :
+    m_data(other.m_data), m_dataSize(other.m_dataSize), m_isMapped(other.m_isMapped)
+{
+    other.m_data = nullptr;
+    other.m_dataSize = 0;
+    other.m_isMapped = False;
+}
+
+auto MappedFile::operator=(MappedFile &&other) noexcept -> MappedFile &
+{
+    if (this == &other) return *this;
+
+    close();
+    m_data = other.m_data;
+    m_dataSize = other.m_dataSize;
+    m_isMapped = other.m_isMapped;
+
+    other.m_data = nullptr;
+    other.m_dataSize = 0;
+    other.m_isMapped = False;
+
+    return *this;
+}
+
+auto MappedFile::open(const StringView filepath) -> Bool
+{
+    Size dataSize = 0;
+    if (const auto data = mapFile(filepath, &dataSize))
+    {
+        close();
+        m_data = data;
+        m_dataSize = dataSize;
+        m_isMapped = True;
+        return True;
+    }
+
+    // Not mappable here, e.g. an apk asset: load it all instead
+    Ubyte *data;
+    if ( !file::load(filepath, &data, &dataSize) )
+    {
+        return False;
+    }
+
+    close();
+    m_data = data;
+    m_dataSize = dataSize;
+    m_isMapped = False;
+    return True;
+}
+
+auto MappedFile::close() -> void
+{
+    if (m_data)
+    {
+        if (m_isMapped)
+            unmapFile(m_data, m_dataSize);
+        else
+            memory::free(m_data);
+
+        m_data = nullptr;
+        m_dataSize = 0;
+        m_isMapped = False;
+    }
+}
+
+KAZE_NS_END
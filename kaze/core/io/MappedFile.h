@@ -0,0 +1,51 @@
+#pragma once
+
+#include <kaze/core/lib.h>
+
+KAZE_NS_BEGIN
+
+/// Read-only view of a whole file, memory-mapped so that only the pages actually read are loaded.
+/// Falls back to loading the file into memory where it cannot be mapped, e.g. on the web or for Android assets.
+class MappedFile {
+public:
+    MappedFile();
+    /// Create and open file in one go
+    /// \param[in] filepath path to the file to map
+    explicit MappedFile(StringView filepath);
+    ~MappedFile();
+
+    KAZE_NO_COPY(MappedFile);
+
+    MappedFile(MappedFile &&other) noexcept;
+    auto operator=(MappedFile &&other) noexcept -> MappedFile &;
+
+    /// Map a file, closing any file mapped before
+    /// \param[in] filepath   path to the file to open
+    /// \returns whether operation was successful
+    auto open(StringView filepath) -> Bool;
+
+    /// Unmap the file, called automatically on destruction. Pointers into the data are invalid afterward.
+    auto close() -> void;
+
+    [[nodiscard]]
+    auto isOpen() const noexcept -> Bool { return m_data != nullptr; }
+
+    /// \returns whether the data is mapped from the file, rather than loaded into memory as a fallback
+    [[nodiscard]]
+    auto isMapped() const noexcept -> Bool { return m_isMapped; }
+
+    /// File data; if not open, it will be `nullptr`
+    [[nodiscard]]
+    auto data() const noexcept -> const Ubyte * { return m_data; }
+
+    /// Byte size of the file data
+    [[nodiscard]]
+    auto size() const noexcept -> Size { return m_dataSize; }
+
+private:
+    Ubyte *m_data;   ///< start of the mapping or the loaded data
+    Size m_dataSize; ///< length of the file
+    Bool m_isMapped; ///< whether `m_data` is a mapping, to be unmapped rather than freed
+};
+
+KAZE_NS_END
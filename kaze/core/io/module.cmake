@@ -9,6 +9,8 @@ set(KAZE_IO_SOURCES_PRIVATE
     FileBuffer.h
     io.cpp
     io.h
+    MappedFile.cpp
+    MappedFile.h
     StructIO.cpp
     StructIO.h
     StructLayout.h
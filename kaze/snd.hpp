@@ -1,22 +1,39 @@
 #pragma once
 #include <kaze/snd/lib.h>
 #include <kaze/snd/AudioDevice.h>
+#include <kaze/snd/AudioLatencyMonitor.h>
 #include <kaze/snd/AudioMarker.h>
+#include <kaze/snd/AudioParam.h>
+#include <kaze/snd/AudioProfiler.h>
 #include <kaze/snd/AudioSpec.h>
 #include <kaze/snd/AudioTime.h>
 #include <kaze/snd/FadePoint.h>
 #include <kaze/snd/SampleFormat.h>
 
+#include <kaze/snd/backend/offline/OfflineAudioDevice.h>
+
 #include <kaze/snd/conv/AudioDecoder.h>
+#include <kaze/snd/conv/BlockCache.h>
 
+#include <kaze/snd/AnalyzerTaps.h>
 #include <kaze/snd/AudioContext.h>
 #include <kaze/snd/AudioEffect.h>
 #include <kaze/snd/AudioEngine.h>
 #include <kaze/snd/AudioSource.h>
 #include <kaze/snd/Sound.h>
+#include <kaze/snd/SoundBank.h>
+#include <kaze/snd/SoundBankBuilder.h>
+#include <kaze/snd/Spatializer.h>
+#include <kaze/snd/VoiceLimits.h>
 
+#include <kaze/snd/effects/CompressorEffect.h>
+#include <kaze/snd/effects/ConvolutionEffect.h>
 #include <kaze/snd/effects/DelayEffect.h>
+#include <kaze/snd/effects/EqEffect.h>
+#include <kaze/snd/effects/FilterEffect.h>
+#include <kaze/snd/effects/LimiterEffect.h>
 #include <kaze/snd/effects/PanEffect.h>
+#include <kaze/snd/effects/ReverbEffect.h>
 #include <kaze/snd/effects/VolumeEffect.h>
 
 #include <kaze/snd/sources/AudioBus.h>
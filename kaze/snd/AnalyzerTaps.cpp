@@ -0,0 +1,326 @@
+#include "AnalyzerTaps.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+KSND_NS_BEGIN
+
+namespace {
+    constexpr Double Pi = 3.14159265358979323846;
+
+    /// Offset of K-weighted loudness from the log of the mean square, after ITU-R BS.1770
+    constexpr Double LoudnessOffset = -0.691;
+
+    /// \returns the BS.1770 weight of a channel: surrounds count 1.41 times, LFE not at all. Layouts as in
+    ///          `dsp::makeChannelMatrix`.
+    auto getChannelWeight(const Int channels, const Int channel) -> Double
+    {
+        switch (channels)
+        {
+        case 4: return channel >= 2 ? 1.41 : 1.0;            // FL FR BL BR
+        case 5: return channel >= 3 ? 1.41 : 1.0;            // FL FR C BL BR
+        case 6: case 7: case 8:                              // FL FR C LFE, then surrounds
+            return channel == 3 ? 0 : channel > 3 ? 1.41 : 1.0;
+        default: return 1.0;
+        }
+    }
+
+    /// \returns loudness in LUFS of a weighted mean square
+    auto toLoudness(const Double energy) -> Double
+    {
+        return energy > 0 ? LoudnessOffset + 10.0 * std::log10(energy) : -std::numeric_limits<Double>::infinity();
+    }
+}
+
+auto AnalyzerTaps::prepare(const Int sampleRate) -> void
+{
+    const auto rate = static_cast<Double>(std::max(sampleRate, 1));
+
+    // K-weighting designed for any sample rate, matching the coefficients BS.1770 lists for 48 kHz
+    {
+        const auto k = std::tan(Pi * 1681.974450955533 / rate);
+        const auto q = 0.7071752369554196;
+        const auto vh = std::pow(10.0, 3.999843853973347 / 20.0);
+        const auto vb = std::pow(vh, 0.4996667741545416);
+        const auto a0 = 1.0 + k / q + k * k;
+        m_kWeighting[0] = {
+            static_cast<Float>((vh + vb * k / q + k * k) / a0),
+            static_cast<Float>(2.0 * (k * k - vh) / a0),
+            static_cast<Float>((vh - vb * k / q + k * k) / a0),
+            static_cast<Float>(2.0 * (k * k - 1.0) / a0),
+            static_cast<Float>((1.0 - k / q + k * k) / a0),
+        };
+    }
+
+    {
+        const auto k = std::tan(Pi * 38.13547087602444 / rate);
+        const auto q = 0.5003270373238773;
+        const auto a0 = 1.0 + k / q + k * k;
+        m_kWeighting[1] = {
+            1.f, -2.f, 1.f,
+            static_cast<Float>(2.0 * (k * k - 1.0) / a0),
+            static_cast<Float>((1.0 - k / q + k * k) / a0),
+        };
+    }
+
+    // Hann-windowed sinc interpolating between the middle two of the taps; phase 0 lands on a sample itself
+    for (Int p = 0; p < dsp::TruePeakPhases; ++p)
+    {
+        Double weights[dsp::TruePeakTaps], sum = 0;
+        for (Int t = 0; t < dsp::TruePeakTaps; ++t)
+        {
+            const auto d = static_cast<Double>(dsp::TruePeakTaps / 2 - 1 - t) +
+                static_cast<Double>(p) / dsp::TruePeakPhases;
+            const auto sinc = d == 0 ? 1.0 : std::sin(Pi * d) / (Pi * d);
+            weights[t] = sinc * (.5 + .5 * std::cos(Pi * d / (dsp::TruePeakTaps / 2)));
+            sum += weights[t];
+        }
+
+        for (Int t = 0; t < dsp::TruePeakTaps; ++t)
+            m_truePeakCoefs[t * dsp::TruePeakPhases + p] = static_cast<Float>(weights[t] / sum);
+    }
+
+    // Scaled by the window's mean over two, so that a full-scale sine reads as `1`
+    m_window.resize(SpectrumSize);
+    for (Int64 n = 0; n < SpectrumSize; ++n)
+    {
+        const auto hann = .5 - .5 * std::cos(2.0 * Pi * static_cast<Double>(n) / SpectrumSize);
+        m_window[n] = static_cast<Float>(hann * 4.0 / SpectrumSize);
+    }
+
+    m_blockFrames = std::max(sampleRate / 10, 1);
+
+    const auto silence = -std::numeric_limits<Double>::infinity();
+    for (auto &tap : m_taps)
+    {
+        tap.channels = 0;
+        tap.weighted.assign(ChunkFrames * dsp::MaxChannels, 0);
+        tap.history.assign((dsp::TruePeakTaps - 1 + ChunkFrames) * dsp::MaxChannels, 0);
+        std::fill(std::begin(tap.energies), std::end(tap.energies), 0);
+        std::fill(std::begin(tap.samplePeaks), std::end(tap.samplePeaks), 0.f);
+        std::fill(std::begin(tap.truePeaks), std::end(tap.truePeaks), 0.f);
+        tap.blockEnergy = 0;
+        tap.blockPosition = 0;
+        tap.blockCount = 0;
+        tap.momentary = silence;
+        tap.shortTerm = silence;
+        tap.frames = 0;
+
+        tap.fft.prepare(SpectrumSize);
+        tap.spectrumOn = False;
+        tap.hasSpectrum = False;
+        tap.ringPosition = 0;
+        tap.ringFilled = 0;
+        tap.sinceTransform = 0;
+        tap.ring.assign(SpectrumSize, 0);
+        tap.time.assign(SpectrumSize, 0);
+        tap.re.assign(tap.fft.bins(), 0);
+        tap.im.assign(tap.fft.bins(), 0);
+        tap.magnitudes.assign(tap.fft.bins(), 0);
+
+        for (auto &snapshot : tap.snapshots)
+        {
+            snapshot.reading = {silence, silence, 0, 0, Null, 0, 0};
+            snapshot.spectrum.assign(tap.fft.bins(), 0);
+        }
+
+        tap.writeIndex = 0;
+        tap.latest.store(1, std::memory_order_relaxed);
+        tap.readIndex = 2;
+    }
+}
+
+auto AnalyzerTaps::write(const Int tapIndex, const Float *samples, const Int64 frames, const Int channels) -> void
+{
+    auto &tap = m_taps[tapIndex];
+    const auto &kernels = dsp::getKernels();
+
+    // Only a writer being replaced in this callback can overlap, so drop the late one
+    if (tap.isWriting.exchange(True, std::memory_order_acquire))
+        return;
+
+    // Filter and oversampling history belong to one channel layout
+    if (tap.channels != channels)
+    {
+        tap.channels = channels;
+        std::fill(std::begin(tap.filter), std::end(tap.filter), 0.f);
+        std::fill(tap.history.begin(), tap.history.end(), 0.f);
+    }
+
+    const auto spectrumOn = tap.spectrumEnabled.load(std::memory_order_relaxed);
+    if (spectrumOn != tap.spectrumOn)
+    {
+        tap.spectrumOn = spectrumOn;
+        tap.hasSpectrum = False;
+        tap.ringFilled = 0;
+        tap.sinceTransform = 0;
+    }
+
+    constexpr auto HistoryFrames = static_cast<Int64>(dsp::TruePeakTaps - 1);
+    for (Int64 done = 0; done < frames;)
+    {
+        auto run = std::min({frames - done, ChunkFrames, m_blockFrames - tap.blockPosition});
+        if (spectrumOn)
+            run = std::min(run, SpectrumHop - tap.sinceTransform);
+
+        const auto input = samples + done * channels;
+        const auto weighted = tap.weighted.data();
+        std::copy_n(input, run * channels, weighted);
+        kernels.biquad(weighted, run, channels, m_kWeighting, 2, tap.filter);
+
+        auto samplePeak = tap.samplePeaks[tap.blockCount % MomentaryBlocks];
+        auto truePeak = tap.truePeaks[tap.blockCount % MomentaryBlocks];
+        for (Int c = 0; c < channels; ++c)
+        {
+            auto energy = 0.f;
+            for (Int64 k = 0; k < run; ++k)
+                energy += weighted[k * channels + c] * weighted[k * channels + c];
+            tap.blockEnergy += getChannelWeight(channels, c) * energy;
+
+            const auto history = tap.history.data() + c * (HistoryFrames + ChunkFrames);
+            for (Int64 k = 0; k < run; ++k)
+            {
+                history[HistoryFrames + k] = input[k * channels + c];
+                samplePeak = std::max(samplePeak, std::abs(input[k * channels + c]));
+            }
+
+            truePeak = std::max(truePeak, kernels.truePeak(history, run, m_truePeakCoefs));
+            std::copy_n(history + run, HistoryFrames, history);
+        }
+
+        tap.samplePeaks[tap.blockCount % MomentaryBlocks] = samplePeak;
+        tap.truePeaks[tap.blockCount % MomentaryBlocks] = std::max(truePeak, samplePeak);
+
+        if (spectrumOn)
+        {
+            const auto gain = 1.f / static_cast<Float>(channels);
+            for (Int64 k = 0; k < run; ++k)
+            {
+                auto sum = 0.f;
+                for (Int c = 0; c < channels; ++c)
+                    sum += input[k * channels + c];
+                tap.ring[tap.ringPosition] = sum * gain;
+                tap.ringPosition = (tap.ringPosition + 1) & (SpectrumSize - 1);
+            }
+
+            tap.ringFilled = std::min(tap.ringFilled + run, SpectrumSize);
+            tap.sinceTransform += run;
+            if (tap.sinceTransform == SpectrumHop)
+            {
+                tap.sinceTransform = 0;
+                if (tap.ringFilled == SpectrumSize)
+                    transform(tap);
+            }
+        }
+
+        done += run;
+        tap.blockPosition += run;
+        if (tap.blockPosition == m_blockFrames)
+            endBlock(tap);
+    }
+
+    tap.frames += static_cast<Uint64>(frames);
+    publish(tap);
+    tap.isWriting.store(False, std::memory_order_release);
+}
+
+auto AnalyzerTaps::claim(const Int tap, const void *owner) -> Bool
+{
+    if (m_taps[tap].owner != Null && m_taps[tap].owner != owner)
+        return False;
+
+    m_taps[tap].owner = owner;
+    return True;
+}
+
+auto AnalyzerTaps::unclaim(const Int tap, const void *owner) -> void
+{
+    if (m_taps[tap].owner == owner)
+        m_taps[tap].owner = Null;
+}
+
+auto AnalyzerTaps::endBlock(Tap &tap) -> void
+{
+    tap.energies[tap.blockCount % LoudnessBlocks] = tap.blockEnergy / static_cast<Double>(m_blockFrames);
+    tap.blockEnergy = 0;
+    tap.blockPosition = 0;
+    ++tap.blockCount;
+
+    // Blocks not measured yet count as silence
+    Double momentary = 0, shortTerm = 0;
+    for (Int i = 0; i < LoudnessBlocks; ++i)
+    {
+        const auto energy = tap.energies[(tap.blockCount - 1 - i + LoudnessBlocks * 2) % LoudnessBlocks];
+        if (i < MomentaryBlocks)
+            momentary += energy;
+        shortTerm += energy;
+    }
+
+    tap.momentary = toLoudness(momentary / MomentaryBlocks);
+    tap.shortTerm = toLoudness(shortTerm / LoudnessBlocks);
+
+    // The oldest peak block starts over as the one being filled
+    tap.samplePeaks[tap.blockCount % MomentaryBlocks] = 0;
+    tap.truePeaks[tap.blockCount % MomentaryBlocks] = 0;
+}
+
+auto AnalyzerTaps::transform(Tap &tap) -> void
+{
+    // The ring's write position is its oldest sample
+    const auto first = SpectrumSize - tap.ringPosition;
+    std::copy_n(tap.ring.data() + tap.ringPosition, first, tap.time.data());
+    std::copy_n(tap.ring.data(), tap.ringPosition, tap.time.data() + first);
+    for (Int64 n = 0; n < SpectrumSize; ++n)
+        tap.time[n] *= m_window[n];
+
+    tap.fft.forward(tap.time.data(), tap.re.data(), tap.im.data());
+    for (Size k = 0; k < tap.magnitudes.size(); ++k)
+        tap.magnitudes[k] = std::sqrt(tap.re[k] * tap.re[k] + tap.im[k] * tap.im[k]);
+    tap.hasSpectrum = True;
+}
+
+auto AnalyzerTaps::publish(Tap &tap) -> void
+{
+    auto &snapshot = tap.snapshots[tap.writeIndex];
+    auto &reading = snapshot.reading;
+    reading.momentaryLoudness = tap.momentary;
+    reading.shortTermLoudness = tap.shortTerm;
+    reading.samplePeak = *std::max_element(std::begin(tap.samplePeaks), std::end(tap.samplePeaks));
+    reading.truePeak = *std::max_element(std::begin(tap.truePeaks), std::end(tap.truePeaks));
+    reading.frames = tap.frames;
+
+    if (tap.spectrumOn && tap.hasSpectrum)
+    {
+        std::copy(tap.magnitudes.begin(), tap.magnitudes.end(), snapshot.spectrum.begin());
+        reading.spectrum = snapshot.spectrum.data();
+        reading.bins = static_cast<Int64>(snapshot.spectrum.size());
+    }
+    else
+    {
+        reading.spectrum = Null;
+        reading.bins = 0;
+    }
+
+    tap.writeIndex = tap.latest.exchange(tap.writeIndex | FreshBit, std::memory_order_acq_rel) & ~FreshBit;
+}
+
+auto AnalyzerTaps::read(const Int tapIndex) -> const AnalyzerReading &
+{
+    auto &tap = m_taps[tapIndex];
+    if (tap.latest.load(std::memory_order_relaxed) & FreshBit)
+        tap.readIndex = tap.latest.exchange(tap.readIndex, std::memory_order_acq_rel) & ~FreshBit;
+    return tap.snapshots[tap.readIndex].reading;
+}
+
+auto AnalyzerTaps::setSpectrumEnabled(const Int tap, const Bool enabled) -> void
+{
+    m_taps[tap].spectrumEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+auto AnalyzerTaps::isSpectrumEnabled(const Int tap) const -> Bool
+{
+    return m_taps[tap].spectrumEnabled.load(std::memory_order_relaxed);
+}
+
+KSND_NS_END
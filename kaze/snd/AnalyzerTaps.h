@@ -0,0 +1,154 @@
+/// \file AnalyzerTaps.h
+/// Loudness, peak and spectrum metering of sources, readable from the owning thread
+#pragma once
+#include <kaze/snd/lib.h>
+#include <kaze/snd/dsp/Fft.h>
+#include <kaze/snd/dsp/kernels.h>
+
+#include <kaze/core/AlignedList.h>
+
+#include <atomic>
+
+KSND_NS_BEGIN
+
+/// Measurements of an analyzer tap, as last published by the audio thread
+struct AnalyzerReading {
+    Double momentaryLoudness; ///< K-weighted loudness over the last 400 ms in LUFS, `-inf` in silence
+    Double shortTermLoudness; ///< K-weighted loudness over the last 3 s in LUFS, `-inf` in silence
+    Float samplePeak;         ///< loudest sample over about the last 400 ms, linear
+    Float truePeak;           ///< loudest value between samples over about the last 400 ms, linear, at least
+                              ///< `samplePeak`
+    const Float *spectrum;    ///< magnitude of each bin from DC to Nyquist, where a full-scale sine centered on a
+                              ///< bin reads about `1`; null while the spectrum is off or still filling
+    Int64 bins;               ///< number of values in `spectrum`
+    Uint64 frames;            ///< frames analyzed since the context opened, `0` if the tap was never written
+};
+
+/// Meters that sources publish their output to, for mixing tools, level displays and music that reacts to the mix.
+///
+/// Each tap K-weights its input and measures momentary and short-term loudness after ITU-R BS.1770, the sample
+/// peak, and the true peak through 4x polyphase oversampling, see `dsp::Kernels::truePeak`. An optional spectrum
+/// transforms a Hann-windowed mono downmix every `SpectrumHop` frames. The audio thread measures, then publishes
+/// a reading per write through a lock-free triple buffer, which the owning thread takes the newest of on `read`.
+/// All memory is allocated by `prepare`, so writing neither allocates nor locks.
+///
+/// Each tap has one writer, claimed with `claim`. Since buses may render on mixer threads, a write that overlaps
+/// another on the same tap, as when a tap changes sources mid-callback, is dropped rather than mixed into it.
+class AnalyzerTaps {
+public:
+    /// Number of taps
+    static constexpr Int MaxTaps = 8;
+
+    /// Samples per spectrum transform
+    static constexpr Int64 SpectrumSize = 2048;
+
+    /// Frames between spectrum transforms, half a window for 50% overlap
+    static constexpr Int64 SpectrumHop = SpectrumSize / 2;
+
+    AnalyzerTaps() = default;
+
+    KAZE_NO_COPY(AnalyzerTaps);
+
+    /// Size every tap and clear its measurements. Only while the audio thread is not running.
+    /// \param[in]  sampleRate  sample rate in Hz
+    auto prepare(Int sampleRate) -> void;
+
+    /// Measure interleaved frames and publish the new reading, on whichever thread renders the tap's writer.
+    /// Dropped if another write to the same tap is in progress.
+    /// \param[in]  tap       tap index, from `0` to `MaxTaps - 1`
+    /// \param[in]  samples   interleaved frames
+    /// \param[in]  frames    number of frames
+    /// \param[in]  channels  channels per frame, at most `dsp::MaxChannels`
+    auto write(Int tap, const Float *samples, Int64 frames, Int channels) -> void;
+
+    /// Make `owner` the only writer of a tap. Owning thread only.
+    /// \param[in]  tap    tap index, from `0` to `MaxTaps - 1`
+    /// \param[in]  owner  writer claiming the tap
+    /// \returns whether the tap was free or already held by `owner`.
+    auto claim(Int tap, const void *owner) -> Bool;
+
+    /// Free a tap held by `owner`, so another writer can claim it; does nothing if held by another. Owning thread
+    /// only.
+    auto unclaim(Int tap, const void *owner) -> void;
+
+    /// Get the newest reading of a tap. Owning thread only.
+    /// \param[in]  tap  tap index, from `0` to `MaxTaps - 1`
+    /// \returns the reading, valid until the next `read` of the same tap.
+    [[nodiscard]]
+    auto read(Int tap) -> const AnalyzerReading &;
+
+    /// Turn the spectrum of a tap on or off, from the next write. Any thread.
+    /// \param[in]  tap      tap index, from `0` to `MaxTaps - 1`
+    /// \param[in]  enabled  whether to compute the spectrum
+    auto setSpectrumEnabled(Int tap, Bool enabled) -> void;
+
+    /// \returns whether the spectrum of a tap is computed
+    [[nodiscard]]
+    auto isSpectrumEnabled(Int tap) const -> Bool;
+
+private:
+    /// Frames measured at a time, bounding the scratch buffers
+    static constexpr Int64 ChunkFrames = 256;
+
+    /// Loudness blocks of 100 ms kept for the short-term window of 3 s; the momentary window is the last 4
+    static constexpr Int LoudnessBlocks = 30;
+    static constexpr Int MomentaryBlocks = 4;
+
+    static constexpr Uint FreshBit = 4u; ///< set in `latest` while the snapshot there has not been taken
+
+    struct Snapshot {
+        AnalyzerReading reading{};
+        AlignedList<Float, 16> spectrum{};
+    };
+
+    struct Tap {
+        // Audio thread
+        Int channels{};
+        Float filter[dsp::MaxChannels * 4]{};     ///< state of both K-weighting sections, see `Kernels::biquad`
+        AlignedList<Float, 16> weighted{};        ///< K-weighted copy of a chunk
+        AlignedList<Float, 16> history{};         ///< per channel, `TruePeakTaps - 1` samples then a chunk
+        Double energies[LoudnessBlocks]{};        ///< weighted mean square of each completed block
+        Float samplePeaks[MomentaryBlocks]{};     ///< of the block being filled and the previous ones
+        Float truePeaks[MomentaryBlocks]{};
+        Double blockEnergy{};                     ///< weighted sum of squares in the block being filled
+        Int64 blockPosition{};                    ///< frames in the block being filled
+        Int64 blockCount{};                       ///< blocks completed
+        Double momentary{}, shortTerm{};          ///< loudness as of the last completed block
+        Uint64 frames{};
+
+        Bool spectrumOn{};                        ///< whether the spectrum was computed on the last write
+        Bool hasSpectrum{};                       ///< whether `magnitudes` holds a transform since turned on
+        Int64 ringPosition{}, ringFilled{}, sinceTransform{};
+        AlignedList<Float, 16> ring{};            ///< last `SpectrumSize` samples of the mono downmix
+        AlignedList<Float, 16> time{}, re{}, im{}, magnitudes{};
+        dsp::Fft fft{};
+        Uint writeIndex{0};
+
+        // Shared
+        Snapshot snapshots[3];
+        std::atomic<Uint> latest{1};
+        std::atomic<Bool> spectrumEnabled{};
+        std::atomic<Bool> isWriting{};            ///< set for the duration of a `write`
+
+        // Owning thread
+        Uint readIndex{2};
+        const void *owner{};
+    };
+
+    /// Complete the loudness block being filled. Audio thread.
+    auto endBlock(Tap &tap) -> void;
+
+    /// Transform the ring into `magnitudes`. Audio thread.
+    auto transform(Tap &tap) -> void;
+
+    /// Fill the write snapshot and swap it in. Audio thread.
+    auto publish(Tap &tap) -> void;
+
+    Tap m_taps[MaxTaps];
+    dsp::BiquadCoefs m_kWeighting[2]{};                     ///< high shelf, then high pass
+    Float m_truePeakCoefs[dsp::TruePeakTaps * dsp::TruePeakPhases]{};
+    AlignedList<Float, 16> m_window{};                      ///< Hann window, scaled for the magnitudes
+    Int64 m_blockFrames{};                                  ///< frames per 100 ms loudness block
+};
+
+KSND_NS_END
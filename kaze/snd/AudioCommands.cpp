@@ -10,15 +10,9 @@
 // Contains the functions for each command
 
 KSND_NS_BEGIN
-auto commands::ContextFlagRemovals::operator()() -> void
+auto commands::ContextReleaseSource::operator()() -> void
 {
-    context->m_removeSourceFlag = True;
-}
-
-auto commands::EffectSetParameter::operator()() -> void
-{
-    using Param = AudioEffect::Param;
-    effect->receiveParam(paramIndex, Param(value));
+    context->releaseObject(source);
 }
 
 auto commands::SourceSetPause::operator()() -> void
@@ -56,9 +50,24 @@ auto commands::SourceFadeTo::operator()() -> void
     source->fadeToImpl(clock, value);
 }
 
+auto commands::SourceSetVirtual::operator()() -> void
+{
+    source->setVirtualImpl(isVirtual);
+}
+
+auto commands::SourceSetEmitter::operator()() -> void
+{
+    source->setEmitterImpl(slot);
+}
+
+auto commands::BusRelease::operator()() -> void
+{
+    bus->releaseImpl(recursive, masterTicket);
+}
+
 auto commands::BusConnectSource::operator()() -> void
 {
-    AudioBus::connectSourceImpl(bus, source);
+    AudioBus::connectSourceImpl(bus, source, ticket);
 }
 
 auto commands::BusDisconnectSource::operator()() -> void
@@ -66,4 +75,9 @@ auto commands::BusDisconnectSource::operator()() -> void
     AudioBus::disconnectSourceImpl(bus, source);
 }
 
+auto commands::BusGrowSources::operator()() -> void
+{
+    bus->growSourcesImpl(sources, ticket);
+}
+
 KSND_NS_END
@@ -16,32 +16,14 @@ namespace commands {
 
     // ===== Audio Context ====================================================
 
-    struct ContextFlagRemovals
+    /// Release an AudioSource that the audio thread has removed from the mixing graph.
+    /// Sent from the audio thread, and run on the engine's owning thread during `update`.
+    struct ContextReleaseSource
     {
         AudioContext *context;
 
-        auto operator()() -> void;
-    };
-
-
-    // ===== Audio Effect =====================================================
-
-    struct EffectSetParameter {
-        /// Effect to set parameter on
-        AudioEffect *effect;
-
-        /// Parameter index
-        Int paramIndex;
-
-        /// Set parameter type
-        enum class Type {
-            Int,
-            Float,
-            String,
-        };
-
-        /// Value to set, use `type` as an indexer
-        Variant<Int, Uint64, Float, String> value;
+        /// Source to release back to the pool
+        Handle<AudioSource> source;
 
         auto operator()() -> void;
     };
@@ -142,14 +124,63 @@ namespace commands {
         auto operator()() -> void;
     };
 
+    /// Virtualize an AudioSource, or make it real again
+    struct SourceSetVirtual {
+        /// Source to set
+        AudioSource *source;
+
+        /// Whether the source should advance without being decoded or mixed
+        Bool isVirtual;
+
+        auto operator()() -> void;
+    };
+
+    /// Give an AudioSource an emitter slot of the context's `Spatializer`, or take it away
+    struct SourceSetEmitter {
+        /// Source to position
+        AudioSource *source;
+
+        /// Slot whose gains the source is mixed with, `-1` to mix it unpositioned
+        Int slot;
+
+        auto operator()() -> void;
+    };
+
 
     // ===== Audio Bus ========================================================
 
+    /// Release an AudioBus, along with its sources if recursive, or reconnect them to the master bus if not
+    struct BusRelease {
+        AudioBus *bus;
+
+        /// Whether to release sub-sources, or reconnect them to the master bus
+        Bool recursive;
+
+        /// Connect ticket reserved on the master bus for the reconnected sources, if not recursive
+        Size masterTicket;
+
+        auto operator()() -> void;
+    };
+
     /// Append an AudioSource to an AudioBus
     struct BusConnectSource {
         Handle<AudioBus> bus;
         Handle<AudioSource> source;
 
+        /// Reserved on the owning thread, so that the bus has room for the source
+        Size ticket;
+
+        auto operator()() -> void;
+    };
+
+    /// Swap in the larger source list an AudioBus reserved on the owning thread
+    struct BusGrowSources {
+        AudioBus *bus;
+
+        /// Reserved for every connection pushed so far; takes the old storage in exchange
+        List< Handle<AudioSource> > *sources;
+        Size ticket;
+
         auto operator()() -> void;
     };
 
@@ -161,9 +192,8 @@ namespace commands {
         auto operator()() -> void;
     };
 
+    /// Commands sent from the engine's owning thread, run on the audio thread
     using AudioCommand = Variant<
-        ContextFlagRemovals,
-        EffectSetParameter,
         SourceSetPause,
         SourceSetUnpause,
         SourceAddEffect,
@@ -171,11 +201,21 @@ namespace commands {
         SourceAddFadePoint,
         SourceRemoveFadePoint,
         SourceFadeTo,
+        SourceSetVirtual,
+        SourceSetEmitter,
+        BusRelease,
         BusConnectSource,
-        BusDisconnectSource
+        BusDisconnectSource,
+        BusGrowSources
+    >;
+
+    /// Commands sent from the audio thread, run on the engine's owning thread
+    using AudioDeferredCommand = Variant<
+        ContextReleaseSource
     >;
 };
 
 using AudioCommand = commands::AudioCommand;
+using AudioDeferredCommand = commands::AudioDeferredCommand;
 
 KSND_NS_END
@@ -1,5 +1,8 @@
 #include "AudioContext.h"
 #include "sources/AudioBus.h"
+#include "dsp/ChannelMatrix.h"
+
+#include <kaze/core/memory.h>
 
 KSND_NS_BEGIN
 
@@ -9,12 +12,25 @@ auto AudioContext::getBufferSize() const -> Int
     return m_device->getBufferSize();
 }
 
+auto AudioContext::getMaxBufferSize() const -> Int
+{
+    KAZE_ASSERT(isOpen());
+    return m_device->getMaxBufferSize();
+}
+
 auto AudioContext::getSpec() const -> const AudioSpec &
 {
     KAZE_ASSERT(isOpen());
     return m_device->getSpec();
 }
 
+auto AudioContext::getConvolutionThread() -> ConvolutionThread &
+{
+    if ( !m_convolutionThread.isRunning() )
+        m_convolutionThread.start();
+    return m_convolutionThread;
+}
+
 auto AudioContext::open(const AudioContextOpen &config) -> Bool
 {
     if (m_device->isOpen()) // Currently only allows one open
@@ -22,11 +38,22 @@ auto AudioContext::open(const AudioContextOpen &config) -> Bool
         return True;
     }
 
+    if (config.channels > dsp::MaxChannels)
+    {
+        KAZE_PUSH_ERR(Error::OutOfRange, "AudioContext supports up to {} output channels, but {} were requested",
+            dsp::MaxChannels, config.channels);
+        return False;
+    }
+
     const auto result = m_device->open({
         .frequency = config.frequency == 0 ? m_device->getDefaultSampleRate() : config.frequency,
         .frameBufferSize = config.samples,
+        .channels = config.channels,
         .audioCallback = &audioCallback,
         .userdata = this,
+        .renderCallback = &renderCallback,
+        .minFrameBufferSize = config.minSamples,
+        .maxFrameBufferSize = config.maxSamples,
     });
 
     if ( !result )
@@ -42,36 +69,63 @@ auto AudioContext::open(const AudioContextOpen &config) -> Bool
     }
 
     m_masterBus = bus;
+    m_busLevelsDirty = True;
+    m_sidechainTaps.prepare(m_device->getMaxBufferSize() / m_device->getSpec().bytesPerFrame());
+    m_analyzerTaps.prepare(m_device->getSpec().freq);
+    m_spatializer.prepare(config.maxEmitters, m_device->getSpec().freq);
+    if (config.mixerThreads > 0)
+    {
+        m_busLevels.resize(MaxMixerBusDepth);
+        for (auto &level : m_busLevels)
+            level.reserve(MaxMixerBuses);
+        m_renderList.reserve(MaxMixerBuses);
+        m_mixerPool.start(config.mixerThreads);
+    }
+
     m_device->resume();
     return True;
 }
 
 auto AudioContext::close() -> void
 {
-    auto lockGuard = std::lock_guard(m_mixMutex);
     if (isOpen())
     {
+        // Stop the audio thread first, so that the graph can be torn down on this one
+        m_device->close();
+
         if (m_masterBus.isValid())
         {
             m_masterBus->m_isMaster = False;
             m_masterBus->release();
-            m_immediateCmds.processCommandsLocked();
-            m_deferredCmds.processCommandsLocked();
+            m_immediateCmds.processCommandsBlocking();
 
-            m_masterBus->processRemovals();
+            // Sources that did not fit into the deferred ring are handed off once it has been drained
+            do
+            {
+                m_masterBus->processRemovals();
+                m_deferredCmds.processCommandsBlocking();
+            } while (m_removeSourceFlag.exchange(False, std::memory_order_acq_rel));
             releaseObjectImpl(m_masterBus);
             m_masterBus = {};
         }
 
-        m_clock = 0;
-        m_device->close();
+        m_streamThread.stop();
+        m_blockCache.clear(); // after the streams that fill it are gone
+        m_convolutionThread.stop();
+        m_mixerPool.stop();
+        m_busLevels.clear();
+        m_renderList.clear();
+        m_busLevelsFit = False;
+        m_removeSourceFlag.store(False, std::memory_order_relaxed);
+        m_clock.store(0, std::memory_order_relaxed);
     }
 }
 
-AudioContext::AudioContext()
-{
-    m_device = AudioDevice::create();
-}
+AudioContext::AudioContext() : AudioContext(AudioDevice::create())
+{ }
+
+AudioContext::AudioContext(AudioDevice *device) : m_device(device)
+{ }
 
 AudioContext::~AudioContext()
 {
@@ -81,8 +135,16 @@ AudioContext::~AudioContext()
 
 auto AudioContext::flagRemoveSource() -> void
 {
-    //const auto lockGuard = std::lock_guard(m_mixMutex);
-    m_removeSourceFlag = True;
+    m_removeSourceFlag.store(True, std::memory_order_release);
+}
+
+auto AudioContext::releaseSourceDeferred(const Handle<AudioSource> &source) -> Bool
+{
+    // The overflow list would make the audio thread wait on `update`, so sources that do not fit are retried
+    return m_deferredCmds.tryPushCommand(commands::ContextReleaseSource {
+        .context = this,
+        .source = source,
+    });
 }
 
 auto AudioContext::audioCallback(void *userptr, AlignedList<Ubyte, 16> *outBuffer) -> void
@@ -91,25 +153,92 @@ auto AudioContext::audioCallback(void *userptr, AlignedList<Ubyte, 16> *outBuffe
     if ( !context->isOpen() )
         return;
 
-    const auto lockGuard = std::lock_guard(context->m_mixMutex);
-    // Process commands that require sample-accurate immediacy
-    // TODO: not sure why, but deferred command lock guard was set here in original repo.
-    //       This may need to be added for some reason...
-    //       Also processImmediateCommands was unlocked.
-    context->m_immediateCmds.processCommandsLocked();
+    // The master bus renders into its own buffer, which then trades places with the device's
+    context->render(Null, static_cast<Int64>(outBuffer->size()));
+    context->m_masterBus->swapBuffers(outBuffer);
+}
+
+auto AudioContext::renderCallback(void *userptr, Ubyte *output, const Int64 bytes) -> void
+{
+    const auto context = static_cast<AudioContext *>(userptr);
+    if ( !context->isOpen() )
+    {
+        memory::set(output, 0, bytes);
+        return;
+    }
+
+    context->render(output, bytes);
+}
+
+auto AudioContext::render(Ubyte *target, const Int64 bytes) -> void
+{
+    auto &profiler = m_profiler;
+    profiler.beginCallback();
+    m_sidechainTaps.beginCallback();
 
-    if (context->m_removeSourceFlag)
+    // Apply graph changes sent from the owning thread. Nothing below takes a lock: the graph is only mutated
+    // here, and released sources are handed back to the owning thread instead of returned to the pool.
+    m_immediateCmds.processCommands();
+
+    if (m_removeSourceFlag.exchange(False, std::memory_order_acq_rel))
     {
-        context->m_masterBus->processRemovals();
-        context->m_removeSourceFlag = False;
+        m_masterBus->processRemovals();
+        m_busLevelsDirty = True;
     }
 
-    const auto bufSize = outBuffer->size();
-    context->m_masterBus->read(Null, static_cast<Int64>(bufSize));
-    context->m_clock += bufSize / (2 * sizeof(Float)); // we currently only support stereo float output
-    context->m_masterBus->updateParentClock(context->m_clock);
+    // The mix is float throughout; the device converts to its own sample format
+    const auto frames = bytes / static_cast<Int64>(m_device->getSpec().bytesPerFrame());
+    m_spatializer.beginCallback(m_clock.load(std::memory_order_relaxed), frames);
+    if (m_mixerPool.getThreadCount() > 0)
+        renderBusesAhead(frames);
+    m_masterBus->read(Null, bytes, target);
+    const auto clock = m_clock.load(std::memory_order_relaxed) + static_cast<Uint64>(frames);
+    m_clock.store(clock, std::memory_order_relaxed);
+    m_masterBus->updateParentClock(clock);
 
-    context->m_masterBus->swapBuffers(outBuffer);
+    profiler.endCallback(frames, m_device->getSpec().freq);
+}
+
+auto AudioContext::renderBusesAhead(const Int64 frames) -> void
+{
+    if (m_busLevelsDirty)
+    {
+        for (auto &level : m_busLevels)
+            level.clear();
+        m_busLevelsFit = m_masterBus->collectBuses(&m_busLevels, 0);
+        m_busLevelsDirty = False;
+    }
+
+    // Buses that were not collected would be left out, so the whole graph renders on the audio thread instead
+    if ( !m_busLevelsFit )
+        return;
+
+    // A bus may only be rendered ahead if its parent will read all of it, which rules out buses below a paused
+    // bus, or one that pauses partway through this buffer. Those are left for their parent to render.
+    for (Size depth = 0; depth < m_busLevels.size(); ++depth)
+    {
+        for (const auto bus : m_busLevels[depth])
+        {
+            const auto parent = bus->m_parent.get();
+            bus->m_renderAhead = (depth == 0 || parent->m_renderAhead) && parent->willRenderFully(static_cast<Uint64>(frames));
+        }
+    }
+
+    m_renderFrames = frames;
+    for (auto depth = m_busLevels.size(); depth-- > 0;)
+    {
+        m_renderList.clear();
+        for (const auto bus : m_busLevels[depth])
+        {
+            if (bus->m_renderAhead)
+                m_renderList.emplace_back(bus);
+        }
+
+        m_mixerPool.run(static_cast<Int>(m_renderList.size()), [](void *userdata, const Int index) {
+            const auto context = static_cast<AudioContext *>(userdata);
+            context->m_renderList[index]->prerender(context->m_renderFrames);
+        }, this);
+    }
 }
 
 auto AudioContext::update() -> void
@@ -123,8 +252,13 @@ auto AudioContext::update() -> void
 
     m_device->update();
 
-    const auto lockGuard = std::lock_guard(m_mixMutex);
-    m_deferredCmds.processCommandsLocked();
+    // Release sources that the audio thread removed from the graph
+    m_deferredCmds.processCommands();
+
+    // Position every emitter at once, after releases so that the slots of released sources are freed
+    m_spatializer.publish(this);
+
+    m_profiler.collect(m_device->getUnderrunCount());
 }
 
 KSND_NS_END
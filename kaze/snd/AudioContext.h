@@ -2,20 +2,40 @@
 #include <kaze/snd/lib.h>
 #include <kaze/snd/AudioCommands.h>
 #include <kaze/snd/AudioDevice.h>
+#include <kaze/snd/AudioProfiler.h>
+#include <kaze/snd/AnalyzerTaps.h>
+#include <kaze/snd/ConvolutionThread.h>
+#include <kaze/snd/MixerThreadPool.h>
+#include <kaze/snd/SidechainTaps.h>
+#include <kaze/snd/Spatializer.h>
+#include <kaze/snd/conv/BlockCache.h>
+#include <kaze/snd/conv/StreamThread.h>
 
 #include <kaze/core/AlignedList.h>
-#include <kaze/core/CommandQueue.h>
+#include <kaze/core/CommandRing.h>
 #include <kaze/core/MultiPool.h>
 #include <kaze/core/debug.h>
 
 KSND_NS_BEGIN
 class AudioBus;
 
+using AudioCommandRing = CommandRing<AudioCommand>;
+using AudioDeferredCommandRing = CommandRing<AudioDeferredCommand>;
+
 /// Private-facing shared context by Audio-related objects.
 /// Audio* objects provide the public-facing interface.
+///
+/// Threading model: the mixing graph (bus sources, effect chains, fade points, etc.) is only mutated on the
+/// audio thread, by commands pushed from the engine's owning thread. Sources that the audio thread removes from
+/// the graph are sent back and released to the pool during `update`, so the audio callback never takes a lock.
+/// Pooled objects never move in memory, so the owning thread may create objects while the audio thread renders.
 class AudioContext {
 public:
     AudioContext();
+
+    /// Create a context that renders with a specific device.
+    /// \param[in]  device  device to render to, the context takes ownership of it
+    explicit AudioContext(AudioDevice *device);
     ~AudioContext();
 
     KAZE_NO_COPY(AudioContext);
@@ -25,16 +45,23 @@ public:
     [[nodiscard]]
     auto isOpen() const -> Bool { return m_device && m_device->isOpen(); }
 
+    /// Push a command to run at the start of the next audio callback. Call from the thread that owns
+    /// the engine only.
     template <PlainFunctor T> // must be a subtype of AudioCommand
     auto pushCommand(const T &command) -> void
     {
-        m_deferredCmds.pushCommand(command);
+        m_immediateCmds.pushCommand(command);
     }
 
-    template <PlainFunctor T> // must be a subtype of AudioCommand
-    auto pushImmediateCommand(const T &command) -> void
+    /// \returns counters of the command queue processed on the audio thread
+    [[nodiscard]]
+    auto getImmediateCommandStats() const noexcept -> AudioCommandRing::Stats { return m_immediateCmds.getStats(); }
+
+    /// \returns counters of the command queue sent from the audio thread, processed during `update`
+    [[nodiscard]]
+    auto getDeferredCommandStats() const noexcept -> AudioDeferredCommandRing::Stats
     {
-        m_immediateCmds.pushCommand(command);
+        return m_deferredCmds.getStats();
     }
 
     /// Create a poolable object. AudioSources, AudioEffects, are the primary object
@@ -43,7 +70,6 @@ public:
     [[nodiscard]]
     auto createObject(TArgs &&...args) -> Handle<T>
     {
-        const auto lockGuard = std::lock_guard(m_mixMutex);
         return createObjectImpl<T>(std::forward<TArgs>(args)...);
     }
 
@@ -55,10 +81,11 @@ public:
     }
 
     /// Release/destroy a poolable object back to the pool.
+    /// \note Objects that are part of the mixing graph must be removed from it first, e.g. via
+    ///       `AudioSource::release`, which hands them back during `update`.
     template <typename T>
     auto releaseObject(Handle<T> handle) -> Bool
     {
-        const auto lockGuard = std::lock_guard(m_mixMutex);
         return releaseObjectImpl(handle);
     }
 
@@ -74,7 +101,6 @@ public:
     template <typename T> requires (!std::is_abstract_v<T>)
     auto releaseObject(T *object) -> Bool
     {
-        const auto lockGuard = std::lock_guard(m_mixMutex);
         Handle<T> handle;
         if ( !m_pool.tryFind(object, &handle) )
         {
@@ -94,8 +120,6 @@ public:
     template <typename T>
     auto releaseObject(T *object) -> Bool
     {
-        const auto lockGuard = std::lock_guard(m_mixMutex);
-
         PoolID id;
         PoolBase *poolBase;
         if ( !m_pool.tryFindGeneric(object, &poolBase, &id, Null) )
@@ -109,48 +133,141 @@ public:
     /// \returns the current clock time in Hz =>
     ///          sample rate * seconds since context was init
     [[nodiscard]]
-    auto getClock() const noexcept -> Uint64 { return m_clock; }
+    auto getClock() const noexcept -> Uint64 { return m_clock.load(std::memory_order_relaxed); }
 
     /// Let the AudioContext know that a sub AudioSource from the master
-    /// AudioBus was removed.
+    /// AudioBus was removed. Safe to call from the audio thread.
     auto flagRemoveSource() -> void;
 
+    /// Send a source that was removed from the mixing graph back to the owning thread, to be released
+    /// during the next `update`. Never blocks. Audio thread only.
+    /// \param[in]  source  source to release
+    /// \returns whether the source was sent; if not, the deferred ring is full, and the caller must keep the
+    ///          source and try again on a later callback.
+    auto releaseSourceDeferred(const Handle<AudioSource> &source) -> Bool;
+
+    /// Let the parallel mixer know that buses were connected, disconnected or released. Audio thread only.
+    auto flagGraphChanged() -> void { m_busLevelsDirty = True; }
+
+    /// \returns number of worker threads that render buses in parallel with the audio thread
+    [[nodiscard]]
+    auto getMixerThreadCount() const -> Int { return m_mixerPool.getThreadCount(); }
+
+    /// Bounds of the bus lists the parallel mixer collects, reserved when the context opens so that the audio
+    /// thread never grows them. A graph nested deeper, or with more buses at one depth, is mixed on the audio
+    /// thread alone until it fits again.
+    static constexpr Size MaxMixerBusDepth = 16;
+    static constexpr Size MaxMixerBuses = 256; ///< per depth
+
     auto getMasterBus() -> Handle<AudioBus> { return m_masterBus; }
     auto getMasterBus() const -> Handle<const AudioBus> { return Handle<AudioBus>::makeConst(m_masterBus); }
 
     [[nodiscard]]
     auto getBufferSize() const -> Int;
 
+    /// \returns most bytes the device may ask for in one callback, what per-callback buffers are reserved for
+    [[nodiscard]]
+    auto getMaxBufferSize() const -> Int;
+
     [[nodiscard]]
     auto getSpec() const -> const AudioSpec &;
 
     [[nodiscard]]
     auto getDeviceId() const -> Uint { return m_device->getId(); }
+
+    /// Audio thread timings. Sources, buses and effects open `AudioProfiler::Scope`s on it while rendering.
+    [[nodiscard]]
+    auto getProfiler() -> AudioProfiler & { return m_profiler; }
+    [[nodiscard]]
+    auto getProfiler() const -> const AudioProfiler & { return m_profiler; }
+
+    /// Levels that sources publish for effects to key off, see `AudioSource::setSidechainTap`
+    [[nodiscard]]
+    auto getSidechainTaps() -> SidechainTaps & { return m_sidechainTaps; }
+    [[nodiscard]]
+    auto getSidechainTaps() const -> const SidechainTaps & { return m_sidechainTaps; }
+
+    /// Loudness, peak and spectrum meters that sources publish to, see `AudioSource::setAnalyzerTap`
+    [[nodiscard]]
+    auto getAnalyzerTaps() -> AnalyzerTaps & { return m_analyzerTaps; }
+    [[nodiscard]]
+    auto getAnalyzerTaps() const -> const AnalyzerTaps & { return m_analyzerTaps; }
+
+    /// Listener and emitters that position sources, see `AudioEngine::setEmitter`
+    [[nodiscard]]
+    auto getSpatializer() -> Spatializer & { return m_spatializer; }
+    [[nodiscard]]
+    auto getSpatializer() const -> const Spatializer & { return m_spatializer; }
+
+    /// Worker thread that decodes prefetched streams. Started when a stream is added, stopped when the context
+    /// closes.
+    [[nodiscard]]
+    auto getStreamThread() -> StreamThread & { return m_streamThread; }
+
+    /// Decoded blocks shared by instances of `Sound::Compressed` sounds, emptied when the context closes
+    [[nodiscard]]
+    auto getBlockCache() -> BlockCache & { return m_blockCache; }
+    [[nodiscard]]
+    auto getBlockCache() const -> const BlockCache & { return m_blockCache; }
+
+    /// Worker thread that sums the tails of convolution effects. Started on first use, stopped when the context
+    /// closes.
+    [[nodiscard]]
+    auto getConvolutionThread() -> ConvolutionThread &;
 private:
     friend class AudioEngine; // TODO: put other "driver" classes here that needs to access driving features
-    friend class commands::ContextFlagRemovals;
 
     static auto audioCallback(void *userptr, AlignedList<Ubyte, 16> *outBuffer) -> void;
+    static auto renderCallback(void *userptr, Ubyte *output, Int64 bytes) -> void;
+
+    /// Run one audio callback: apply commands, then mix the graph. Audio thread only.
+    /// \param[in]  target  device memory for the master bus to render into, or null to render into its own buffer
+    /// \param[in]  bytes   number of bytes to render
+    auto render(Ubyte *target, Int64 bytes) -> void;
 
     struct AudioContextOpen {
         Int frequency = 0;
         Int samples = 1024;
+        Int channels = 2;
+        Int mixerThreads = 0;
+        Int maxEmitters = Spatializer::DefaultMaxEmitters;
+        Int minSamples = 0; ///< lower bound of an adaptive period, see `AudioDeviceOpen::minFrameBufferSize`
+        Int maxSamples = 0; ///< upper bound of an adaptive period
     };
     auto open(const AudioContextOpen &config) -> Bool;
     auto close() -> void;
 
     auto update() -> void;
 
+    /// Render buses on the mixer threads ahead of the master bus, deepest first, so that each parent finds its
+    /// child buses already rendered. Siblings at the same depth do not depend on each other. Audio thread only.
+    /// \param[in]  frames  number of frames in this callback's buffer
+    auto renderBusesAhead(Int64 frames) -> void;
+
     MultiPool m_pool{};
-    CommandQueue<AudioCommand> m_deferredCmds{}, m_immediateCmds{};
+    AudioCommandRing m_immediateCmds{};          ///< owning thread -> audio thread
+    AudioDeferredCommandRing m_deferredCmds{};   ///< audio thread -> owning thread
     Handle<AudioBus> m_masterBus{};
+    StreamThread m_streamThread{};
+    BlockCache m_blockCache{};
+    ConvolutionThread m_convolutionThread{};
+    AudioProfiler m_profiler{};
+    SidechainTaps m_sidechainTaps{};
+    AnalyzerTaps m_analyzerTaps{};
+    Spatializer m_spatializer{};
 
-    std::mutex m_mixMutex{};
-
-    Uint64 m_clock{};
+    std::atomic<Uint64> m_clock{}; ///< written by the audio thread
     AudioDevice *m_device{};
 
-    Bool m_removeSourceFlag{}; ///< Lets us know a source from the master bus was removed
+    std::atomic<Bool> m_removeSourceFlag{}; ///< Lets us know a source from the master bus was removed
+
+    // Parallel mixing, audio thread only
+    MixerThreadPool m_mixerPool{};
+    List< List<AudioBus *> > m_busLevels{}; ///< every bus below the master bus, grouped by depth
+    List<AudioBus *> m_renderList{};        ///< buses of the depth being rendered
+    Int64 m_renderFrames{};
+    Bool m_busLevelsDirty{True};
+    Bool m_busLevelsFit{};                  ///< whether the graph fit into `m_busLevels` when last collected
 };
 
 KSND_NS_END
@@ -2,6 +2,8 @@
 #include <kaze/core/platform/defines.h>
 #include <kaze/core/debug.h>
 
+#include <kaze/snd/backend/offline/OfflineAudioDevice.h>
+
 #if KAZE_PLATFORM_DESKTOP
 #include <kaze/snd/backend/portaudio/PortAudioDevice.h>
 #elif KAZE_PLATFORM_IOS
@@ -14,8 +16,18 @@
 
 KSND_NS_BEGIN
 
-auto AudioDevice::create() -> AudioDevice *
+auto AudioDevice::create(const AudioDeviceType type) -> AudioDevice *
 {
+    switch (type)
+    {
+    case AudioDeviceType::Null:
+        return new OfflineAudioDevice(OfflineClock::Realtime);
+    case AudioDeviceType::Offline:
+        return new OfflineAudioDevice(OfflineClock::Manual);
+    default:
+        break;
+    }
+
 #if KAZE_PLATFORM_DESKTOP
     return new PortAudioDevice();
 #elif KAZE_PLATFORM_IOS
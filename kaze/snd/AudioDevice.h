@@ -1,4 +1,5 @@
 #pragma once
+#include "AudioLatencyMonitor.h"
 #include "AudioSpec.h"
 
 #include <kaze/snd/lib.h>
@@ -9,11 +10,37 @@ KSND_NS_BEGIN
 
 using AudioCallback = funcptr_t<void(void *userdata, AlignedList<Uint8, 16> *buffer)>;
 
+/// Renders `bytes` of interleaved frames straight into memory the device owns, aligned to `AudioRenderAlignment`
+/// bytes. Must fill the whole buffer, writing silence when there is nothing to play.
+using AudioRenderCallback = funcptr_t<void(void *userdata, Uint8 *output, Int64 bytes)>;
+
+/// Alignment that memory handed to an `AudioRenderCallback` must have, that of the mixer's vectors
+constexpr Size AudioRenderAlignment = 16;
+
 struct AudioDeviceOpen {
     Int frequency;               ///< Requested sample rate
     Int frameBufferSize;
+    Int channels;                ///< Requested number of output channels; backends that cannot provide it keep stereo
     AudioCallback audioCallback;
     void *userdata;
+
+    /// Optional. Backends whose API hands over the output memory each period call this instead of `audioCallback`
+    /// when that memory is aligned, saving a copy from an intermediate buffer; otherwise they fall back to
+    /// `audioCallback`.
+    AudioRenderCallback renderCallback;
+
+    /// Optional. Bounds of an adaptive period in frames: when both are positive and `minFrameBufferSize` is below
+    /// `maxFrameBufferSize`, backends with an `AudioLatencyMonitor` start at `frameBufferSize` and move the
+    /// period within the bounds as callbacks underrun or come close to. Otherwise the period stays fixed.
+    Int minFrameBufferSize;
+    Int maxFrameBufferSize;
+};
+
+/// Kind of device for `AudioDevice::create` to make
+enum class AudioDeviceType {
+    Platform, ///< the platform's hardware output
+    Null,     ///< no hardware: renders in realtime on its own thread and discards the output, for headless runs
+    Offline,  ///< no hardware: renders only when asked, as fast as possible, see `OfflineAudioDevice`
 };
 
 /// Interface over an audio i/o backend
@@ -21,9 +48,10 @@ class AudioDevice {
 public:
     virtual ~AudioDevice() = default;
 
-    /// Create a platform-specific AudioDevice.
+    /// Create a platform-specific AudioDevice, or one without hardware behind it.
     /// Make sure to call `delete` on it when done with.
-    static auto create() -> AudioDevice *;
+    /// \param[in]  type  kind of device to create
+    static auto create(AudioDeviceType type = AudioDeviceType::Platform) -> AudioDevice *;
 
     /// \note Audio devices should be in a suspended state on open
     virtual auto open(const AudioDeviceOpen &config) -> Bool = 0;
@@ -54,8 +82,24 @@ public:
     [[nodiscard]]
     virtual auto getSpec() const -> const AudioSpec & = 0;
 
+    /// \returns bytes rendered per callback now
     [[nodiscard]]
     virtual auto getBufferSize() const -> Int = 0;
+
+    /// \returns most bytes a callback may render while the device is open, which the engine reserves its buffers
+    ///          for; more than `getBufferSize` when the period is adaptive
+    [[nodiscard]]
+    virtual auto getMaxBufferSize() const -> Int { return getBufferSize(); }
+
+    /// \returns number of times the device ran out of audio because a callback finished too late, cumulative.
+    ///          Always `0` for backends that cannot detect it.
+    [[nodiscard]]
+    virtual auto getUnderrunCount() const -> Uint64 { return 0; }
+
+    /// \returns callback timings, underruns and the adaptive period of this device, or null for backends that do
+    ///          not measure their callbacks
+    [[nodiscard]]
+    virtual auto getLatencyMonitor() -> AudioLatencyMonitor * { return Null; }
 };
 
 KSND_NS_END
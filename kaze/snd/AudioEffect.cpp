@@ -2,22 +2,52 @@
 #include <kaze/snd/AudioCommands.h>
 
 #include <kaze/core/errors.h>
+#include <kaze/core/memory.h>
 
 KSND_NS_BEGIN
 
-AudioEffect::AudioEffect(AudioEffect &&other) noexcept : m_context(other.m_context)
+AudioEffect::AudioEffect(AudioEffect &&other) noexcept : m_context(other.m_context),
+    m_channels(other.m_channels), m_processMode(other.m_processMode)
 {}
 
-auto AudioEffect::sendParam(const Int index, const Param::Type value) -> Bool
+auto AudioEffect::process(const Float *input, Float *output, const Int64 count) -> Bool
+{
+    memory::copy(output, input, count * sizeof(Float));
+    return processInPlace(output, count);
+}
+
+auto AudioEffect::getParamCount() const -> Int
+{
+    Int count;
+    const_cast<AudioEffect *>(this)->getParamsImpl(&count);
+    return count;
+}
+
+auto AudioEffect::getParam(const Int index) -> AudioParam *
+{
+    Int count;
+    const auto params = getParamsImpl(&count);
+    return (index >= 0 && index < count) ? params + index : Null;
+}
+
+auto AudioEffect::getParam(const Int index) const -> const AudioParam *
+{
+    return const_cast<AudioEffect *>(this)->getParam(index);
+}
+
+auto AudioEffect::setParam(const Int index, const Float value) -> Bool
 {
     KAZE_HANDLE_GUARD_RET(False);
 
-    m_context->pushCommand(commands::EffectSetParameter {
-        .effect = this,
-        .paramIndex = index,
-        .value = value,
-    });
+    const auto param = getParam(index);
+    if ( !param )
+    {
+        KAZE_PUSH_ERR(Error::OutOfRange, "AudioEffect parameter index {} is out of range [0, {})",
+            index, getParamCount());
+        return False;
+    }
 
+    param->set(value);
     return True;
 }
 
@@ -2,46 +2,23 @@
 #include <kaze/snd/lib.h>
 #include <kaze/snd/AudioCommands.h>
 #include <kaze/snd/AudioContext.h>
+#include <kaze/snd/AudioParam.h>
 
 KSND_NS_BEGIN
 
-/// Base class for an audio effect, which is insertable into any Source object
+/// How a source passes its buffer to an effect
+enum class ProcessMode : Ubyte {
+    OutOfPlace, ///< `process` reads one buffer and writes into a second, cleared one
+    InPlace,    ///< `processInPlace` transforms the source's buffer directly, with no copy, swap or clear
+};
+
+/// Base class for an audio effect, which is insertable into any Source object.
+///
+/// Effects that transform each sample on its own, or read their input before writing to it, should construct with
+/// `ProcessMode::InPlace` and override `processInPlace`; others override `process`.
 class AudioEffect {
 public:
-    /// Contains a parameter value. (Simple wrapper around Variant)
-    struct Param {
-    public:
-        using Type = Variant<KAZE_NS::Int, KAZE_NS::Uint64, KAZE_NS::Float, KAZE_NS::String>;
-        explicit Param(const Type &value) : m_value(value) { }
-
-        enum Enum : Size {
-            Int,
-            Uint64,
-            Float,
-            String,
-        };
-
-        /// \returns the type enum index of this value
-        auto type() const noexcept -> Enum
-        {
-            return static_cast<Enum>(m_value.index());
-        }
-
-        /// Get the value from this param.
-        /// Check for the type via `Param::index()`.
-        /// \throws std::bad_variant_access on bad cast if type does not align.
-        template <typename T>
-        auto get() const -> const T &
-        {
-            return std::get<T>(m_value);
-        }
-
-        auto getVariant() const -> const Type & { return m_value; }
-    private:
-        Type m_value;
-    };
-
-    AudioEffect() : m_context() { }
+    AudioEffect() : AudioEffect(ProcessMode::OutOfPlace) { }
     AudioEffect(AudioEffect &&other) noexcept;
     virtual ~AudioEffect() = default;
 
@@ -49,43 +26,78 @@ public:
     /// Pool clean up logic
     virtual void release_() { }
 
-    /// Set a parameter value (gets sent to the command queue, so it won't appear until next frame)
-    /// \param[in]  index   Parameter index
-    /// \param[in]  value   Must be either Int, Uint64, Float, or String.
-    /// \returns whether command was sent successfully.
-    auto sendParam(Int index, Param::Type value) -> Bool;
+    /// \returns number of parameters this effect declares
+    [[nodiscard]]
+    auto getParamCount() const -> Int;
+
+    /// \param[in]  index  parameter index, from `0` to `getParamCount() - 1`
+    /// \returns the parameter, or null if `index` is out of range
+    [[nodiscard]]
+    auto getParam(Int index) -> AudioParam *;
+    [[nodiscard]]
+    auto getParam(Int index) const -> const AudioParam *;
+
+    /// Set a parameter by index. Safe from any thread, and heard from the next audio block; `Float` parameters
+    /// ramp to the new value across that block.
+    /// \param[in]  index  parameter index
+    /// \param[in]  value  value to set, clamped to the parameter's range
+    /// \returns whether the parameter exists.
+    auto setParam(Int index, Float value) -> Bool;
+
+    /// \returns which of `process` or `processInPlace` the source calls
+    [[nodiscard]]
+    auto getProcessMode() const -> ProcessMode { return m_processMode; }
 
 protected:
+    explicit AudioEffect(const ProcessMode processMode) : m_context(), m_processMode(processMode) { }
+
     [[nodiscard]]
     auto context() -> AudioContext * { return m_context; }
     [[nodiscard]]
     auto context() const -> const AudioContext * { return m_context; }
 
+    /// \returns number of interleaved channels in the buffers passed to `process`
+    [[nodiscard]]
+    auto channels() const -> Int { return m_channels; }
+
 private:
     friend class AudioEngine;
     friend class AudioSource;
-    friend class commands::EffectSetParameter;
 
     /// VIRTUAL: Optional
-    /// Override this if you need to process parameter sets.
-    /// Don't set member parameters directly as it may occur during audio thread.
-    /// Instead, set via `sendParam` function and apply changes in `receiveParam` function.
-    /// \param[in] index index passed in `sendFloat` now received
-    /// \param[in] param value passed in `sendFloat` now received
-    virtual auto receiveParam(Int index, const Param &param) -> void {}
-
-    /// VIRTUAL: Required
-    /// Required to override for this effect's processing logic
+    /// Override this to expose the effect's parameters, declared up front as an array of `AudioParam`, usually
+    /// indexed by an enum. Take each parameter's ramp once per `process` call.
+    /// \param[out] outCount  receives the number of parameters
+    /// \returns the first parameter, or null if there are none.
+    virtual auto getParamsImpl(Int *outCount) -> AudioParam * { *outCount = 0; return Null; }
+
+    /// VIRTUAL: Optional
+    /// Called on the owning thread when the effect is attached to a source, before it processes any audio.
+    /// Override this to size buffers by `channels()`.
+    virtual auto prepare() -> void {}
+
+    /// VIRTUAL: Required for `ProcessMode::OutOfPlace`
+    /// Override for this effect's processing logic. The default copies `input` to `output` and calls
+    /// `processInPlace` on it.
     /// \param[in] input  input buffer filled with data to process
     /// \param[in] output output buffer to write to (comes cleared to 0)
     /// \param[in] count  number of samples, the length of both input and output arrays. This value is guaranteed to
     ///               be a multiple of 4 for optimization purposes.
-    /// \note both input and output buffers are interleaved stereo, so samples will occur in L-R-L-R order
+    /// \note both input and output buffers are interleaved with `channels()` channels, e.g. L-R-L-R for stereo
     /// \returns whether anything has been processed. For efficiency if nothing should be altered, return false,
     ///          and it will act as if bypassed. Return true otherwise when data has been processed normally.
-    virtual auto process(const Float *input, Float *output, Int64 count) -> Bool = 0;
+    virtual auto process(const Float *input, Float *output, Int64 count) -> Bool;
+
+    /// VIRTUAL: Required for `ProcessMode::InPlace`
+    /// Override for this effect's processing logic when it can write over its input
+    /// \param[in,out] io     interleaved samples to transform, with `channels()` channels
+    /// \param[in]     count  number of samples in `io`, a multiple of 4
+    /// \returns whether anything has been altered; leave `io` untouched and return false to act as if bypassed.
+    virtual auto processInPlace([[maybe_unused]] Float *io, [[maybe_unused]] Int64 count) -> Bool { return False; }
 
     AudioContext *m_context;
+    Int m_channels{2};
+    ProcessMode m_processMode;
 };
 
 KSND_NS_END
@@ -1,6 +1,7 @@
 #include "AudioEngine.h"
 #include "sources/AudioBus.h"
 #include "AudioContext.h"
+#include "VoiceManager.h"
 
 #include <kaze/core/debug.h>
 
@@ -23,10 +24,15 @@ KSND_NS_BEGIN
 
 struct AudioEngine::Impl
 {
+    Impl() : voices(&context) { }
+    explicit Impl(AudioDevice *device) : context(device), voices(&context) { }
+
     AudioContext context;
+    VoiceManager voices;
 };
 
 AudioEngine::AudioEngine() : m(new Impl) { }
+AudioEngine::AudioEngine(AudioDevice *device) : m(new Impl(device)) { }
 AudioEngine::~AudioEngine() { delete m; }
 
 auto AudioEngine::open(const AudioEngineInit &config) -> Bool
@@ -34,11 +40,17 @@ auto AudioEngine::open(const AudioEngineInit &config) -> Bool
     return m->context.open({
         .frequency = config.samplerate,
         .samples = config.bufferFrameSize,
+        .channels = config.channels,
+        .mixerThreads = config.mixerThreads,
+        .maxEmitters = config.maxEmitters,
+        .minSamples = config.minBufferFrameSize,
+        .maxSamples = config.maxBufferFrameSize,
     });
 }
 
 auto AudioEngine::close() -> void
 {
+    m->voices.clear();
     m->context.close();
 }
 
@@ -104,6 +116,26 @@ auto AudioEngine::createSound(const ManagedMem &mem, const Sound::InitFlags flag
     return sound;
 }
 
+auto AudioEngine::createSound(const SoundBank &bank, const StringView name, const Sound::InitFlags flags)
+    -> Handle<Sound>
+{
+    INIT_GUARD_RET(Handle<Sound>{});
+
+    const auto sound = m->context.createObject<Sound>();
+    if ( !sound )
+    {
+        return {};
+    }
+
+    if ( !sound->openBank(bank, name, flags, m->context.getSpec()) )
+    {
+        m->context.releaseObject(sound);
+        return {};
+    }
+
+    return sound;
+}
+
 auto AudioEngine::releaseSound(const Handle<Sound> &sound) -> void
 {
     INIT_GUARD();
@@ -122,10 +154,11 @@ auto AudioEngine::playSound(
         return {};
     }
 
+    m->voices.add(outHandle, sound);
     return outHandle;
 }
 
-auto AudioEngine::createBus(Bool paused, const Handle<AudioBus> &output) -> Handle<AudioBus>
+auto AudioEngine::createBus(Bool paused, const Handle<AudioBus> &output, const Int channels) -> Handle<AudioBus>
 {
     INIT_GUARD_RET(Handle<AudioBus>{});
     if (output && !output.isValid()) // Output was provided, but it's invalid => error
@@ -157,13 +190,14 @@ auto AudioEngine::createBus(Bool paused, const Handle<AudioBus> &output) -> Hand
     const auto newBusHandle = m->context.createObject<AudioBus>(
         &m->context,
         outputBus,
-        paused);
+        paused,
+        channels);
 
-    if (outputBus)
-        m->context.pushCommand(commands::BusConnectSource {
-            .bus = outputBus,
-            .source = newBusHandle.cast<AudioSource>()
-        });
+    if (newBusHandle && !AudioBus::connect(outputBus, newBusHandle.cast<AudioSource>()))
+    {
+        m->context.releaseObject(newBusHandle);
+        return {};
+    }
 
     return newBusHandle;
 }
@@ -188,6 +222,11 @@ auto AudioEngine::getMasterBus() const -> Handle<AudioBus>
     return m->context.getMasterBus();
 }
 
+auto AudioEngine::getMixerThreadCount() const -> Int
+{
+    return m->context.getMixerThreadCount();
+}
+
 auto AudioEngine::setPaused(const Bool value) -> void
 {
     if (value)
@@ -201,9 +240,142 @@ auto AudioEngine::getPaused() const -> Bool
     return !m->context.m_device->isRunning();
 }
 
+auto AudioEngine::getCommandStats() const -> CommandStats
+{
+    return {
+        .immediate = m->context.getImmediateCommandStats(),
+        .deferred = m->context.getDeferredCommandStats(),
+    };
+}
+
+auto AudioEngine::setMaxVoices(const Int maxVoices) -> void
+{
+    m->voices.setMaxVoices(maxVoices);
+}
+
+auto AudioEngine::getMaxVoices() const -> Int
+{
+    return m->voices.getMaxVoices();
+}
+
+auto AudioEngine::setStealPolicy(const VoiceSteal policy) -> void
+{
+    m->voices.setStealPolicy(policy);
+}
+
+auto AudioEngine::getStealPolicy() const -> VoiceSteal
+{
+    return m->voices.getStealPolicy();
+}
+
+auto AudioEngine::getVoiceStats() const -> VoiceStats
+{
+    return m->voices.getStats();
+}
+
+auto AudioEngine::isVirtual(const Handle<AudioSource> &source) const -> Bool
+{
+    return m->voices.isVirtual(source);
+}
+
+auto AudioEngine::setProfilerEnabled(const Bool enabled) -> void
+{
+    INIT_GUARD();
+    m->context.getProfiler().setEnabled(enabled, m->context.m_device->getUnderrunCount());
+}
+
+auto AudioEngine::isProfilerEnabled() const -> Bool
+{
+    return m->context.getProfiler().isEnabled();
+}
+
+auto AudioEngine::getProfilerStats(const Int topN) const -> AudioProfilerStats
+{
+    return m->context.getProfiler().getStats(topN);
+}
+
+auto AudioEngine::getLatencyHistogram() const -> AudioLatencyHistogram
+{
+    INIT_GUARD_RET(AudioLatencyHistogram{});
+    const auto monitor = m->context.m_device->getLatencyMonitor();
+    return monitor ? monitor->getHistogram() : AudioLatencyHistogram{};
+}
+
+auto AudioEngine::resetLatencyHistogram() -> void
+{
+    INIT_GUARD();
+    if (const auto monitor = m->context.m_device->getLatencyMonitor())
+        monitor->reset();
+}
+
+auto AudioEngine::getBlockCacheStats() const -> BlockCache::Stats
+{
+    return m->context.getBlockCache().getStats();
+}
+
+auto AudioEngine::setBlockCacheCapacity(const Size bytes) -> void
+{
+    m->context.getBlockCache().setCapacity(bytes);
+}
+
+auto AudioEngine::setListener(const Listener &listener) -> void
+{
+    m->context.getSpatializer().setListener(listener);
+}
+
+auto AudioEngine::getListener() const -> const Listener &
+{
+    return m->context.getSpatializer().getListener();
+}
+
+auto AudioEngine::setEmitter(const Handle<AudioSource> &source, const Emitter &emitter) -> Bool
+{
+    INIT_GUARD_RET(False);
+    return m->context.getSpatializer().setEmitter(source, emitter);
+}
+
+auto AudioEngine::removeEmitter(const Handle<AudioSource> &source) -> void
+{
+    INIT_GUARD();
+    m->context.getSpatializer().removeEmitter(source);
+}
+
+auto AudioEngine::getAnalyzerReading(const Int tap) -> const AnalyzerReading *
+{
+    INIT_GUARD_RET(Null);
+    if (tap < 0 || tap >= AnalyzerTaps::MaxTaps)
+    {
+        KAZE_PUSH_ERR(Error::OutOfRange, "Analyzer tap must be in [0, {}], but got {}", AnalyzerTaps::MaxTaps - 1,
+            tap);
+        return Null;
+    }
+
+    return &m->context.getAnalyzerTaps().read(tap);
+}
+
+auto AudioEngine::setAnalyzerSpectrum(const Int tap, const Bool enabled) -> void
+{
+    if (tap < 0 || tap >= AnalyzerTaps::MaxTaps)
+    {
+        KAZE_PUSH_ERR(Error::OutOfRange, "Analyzer tap must be in [0, {}], but got {}", AnalyzerTaps::MaxTaps - 1,
+            tap);
+        return;
+    }
+
+    m->context.getAnalyzerTaps().setSpectrumEnabled(tap, enabled);
+}
+
+auto AudioEngine::getAnalyzerSpectrum(const Int tap) const -> Bool
+{
+    return tap >= 0 && tap < AnalyzerTaps::MaxTaps && m->context.getAnalyzerTaps().isSpectrumEnabled(tap);
+}
+
 auto AudioEngine::update() -> void
 {
     m->context.update();
+
+    // Released voices were just returned to the pool, so their slots can go to virtual voices
+    m->voices.update();
 }
 
 
@@ -5,6 +5,7 @@
 #include <kaze/snd/AudioDevice.h>
 #include <kaze/snd/AudioEffect.h>
 #include <kaze/snd/Sound.h>
+#include <kaze/snd/VoiceLimits.h>
 
 #include <kaze/core/Handle.h>
 #include <kaze/core/ManagedMem.h>
@@ -23,11 +24,36 @@ class StreamSource;
 struct AudioEngineInit {
     Int samplerate;
     Int bufferFrameSize;
+
+    /// Number of output channels [optional, default: `2`]. Up to 8 are mixed in the default WAVE speaker layouts,
+    /// see `dsp::makeChannelMatrix`. Backends that cannot open the count fall back to stereo; check `getSpec`.
+    Int channels = 2;
+
+    /// Number of worker threads that help the audio thread render sibling buses in parallel [optional,
+    /// default: `0`, everything renders on the audio thread]. Worth it when several buses carry heavy work; the
+    /// mixed output is identical either way. Keep it below the number of CPU cores, since workers spin briefly
+    /// between batches.
+    Int mixerThreads = 0;
+
+    /// Number of sources that may be positioned at once with `AudioEngine::setEmitter` [optional, default:
+    /// `1024`]. Every slot up to the highest in use is spatialized each callback.
+    Int maxEmitters = Spatializer::DefaultMaxEmitters;
+
+    /// Bounds of an adaptive buffer size in frames [optional, default: `0`, the size stays at `bufferFrameSize`].
+    /// When both are set and `minBufferFrameSize < maxBufferFrameSize`, the device doubles its buffer after an
+    /// underrun or a callback close to one, and halves it again after a few seconds of light load, so latency
+    /// only grows while the mix needs it. The engine keeps playing throughout; see `getLatencyHistogram`.
+    Int minBufferFrameSize = 0;
+    Int maxBufferFrameSize = 0;
 };
 
 class AudioEngine {
 public:
     AudioEngine();
+
+    /// Create an engine that renders with a specific device instead of the platform default.
+    /// \param[in]  device  device to render to, the engine takes ownership of it
+    explicit AudioEngine(AudioDevice *device);
     ~AudioEngine();
 
     auto open(const AudioEngineInit &config) -> Bool;
@@ -65,6 +91,15 @@ public:
     [[nodiscard]]
     auto createSound(const ManagedMem &mem, Sound::InitFlags flags) -> Handle<Sound>;
 
+    /// Create a sound from a sound bank, pointing into the bank without copying or parsing its file data.
+    /// \param[in]  bank      Open sound bank; it must stay open until the sound is released.
+    /// \param[in]  name      Name of the sound in the bank.
+    /// \param[in]  flags     Attributes to open the sound with.
+    ///
+    /// \returns Sound object, or an invalid handle if the bank has no such sound or on error.
+    [[nodiscard]]
+    auto createSound(const SoundBank &bank, StringView name, Sound::InitFlags flags) -> Handle<Sound>;
+
     /// Release a created sound.
     /// \param[in] sound       sound to release
     auto releaseSound(const Handle<Sound> &sound) -> void;
@@ -76,16 +111,19 @@ public:
     ///
     /// \param[in] bus       Bus to output this sound to, use `{}` to indicate null, which
     ///                          defaults to the master bus.
-    /// \returns AudioSource sound instance, or an invalid handle on error.
+    /// \returns AudioSource sound instance, or an invalid handle on error. If a voice limit was reached, the
+    ///          instance may start virtual, see `setMaxVoices`.
     auto playSound(const Handle<Sound> &sound, Bool paused = False, const Handle<AudioBus> &bus = {}) -> Handle<AudioSource>;
 
     /// Create a new bus to use in the mixing graph
     /// \param paused whether bus should start off paused on initialization
     /// \param output output bus to feed this bus to [optional, default: master bus]
+    /// \param channels number of channels the bus mixes in, its output bus upmixes or downmixes them
+    ///                 [optional, default: `0`, same as the output bus]
     ///
     /// \returns AudioBus instance, or an invalid handle on error.
     [[nodiscard]]
-    auto createBus(Bool paused, const Handle<AudioBus> &output = {}) -> Handle<AudioBus>;
+    auto createBus(Bool paused, const Handle<AudioBus> &output = {}, Int channels = 0) -> Handle<AudioBus>;
 
     /// Retrieve the engine's device ID. If zero, the audio device is uninitialized.
     [[nodiscard]]
@@ -103,6 +141,10 @@ public:
     [[nodiscard]]
     auto getMasterBus() const -> Handle<AudioBus>;
 
+    /// \returns number of worker threads rendering buses in parallel, see `AudioEngineInit::mixerThreads`
+    [[nodiscard]]
+    auto getMixerThreadCount() const -> Int;
+
     /// Pause the audio device
     auto setPaused(Bool value) -> void;
 
@@ -110,6 +152,112 @@ public:
     [[nodiscard]]
     auto getPaused() const -> Bool;
 
+    /// Counters of the engine's command rings, useful to tune capacity. A non-zero `overflowed` count means
+    /// commands were pushed faster than the ring could be drained.
+    struct CommandStats {
+        AudioCommandRing::Stats immediate;         ///< commands processed at the start of each audio callback
+        AudioDeferredCommandRing::Stats deferred;  ///< commands sent from the audio thread, processed during `update`
+    };
+
+    /// \returns current command ring counters
+    [[nodiscard]]
+    auto getCommandStats() const -> CommandStats;
+
+    /// Limit how many sound instances may be heard at once. Instances over the limit are virtualized: they keep
+    /// their place in time without being decoded or mixed, and become real again during `update` as slots free
+    /// up, highest priority first. Also see `Sound::setMaxVoices` for a per-sound limit.
+    /// \param[in]  maxVoices  maximum number of real voices; `0` for no limit (default)
+    auto setMaxVoices(Int maxVoices) -> void;
+
+    [[nodiscard]]
+    auto getMaxVoices() const -> Int;
+
+    /// Set which voice is taken over when the engine-wide voice limit is reached
+    /// \param[in]  policy  voice to virtualize [default: `VoiceSteal::LowestPriority`]
+    auto setStealPolicy(VoiceSteal policy) -> void;
+
+    [[nodiscard]]
+    auto getStealPolicy() const -> VoiceSteal;
+
+    /// \returns number of real and virtual voices, as of the last `playSound` or `update`
+    [[nodiscard]]
+    auto getVoiceStats() const -> VoiceStats;
+
+    /// \returns whether a sound instance is currently virtualized by a voice limit
+    [[nodiscard]]
+    auto isVirtual(const Handle<AudioSource> &source) const -> Bool;
+
+    /// Start or stop timing the audio thread. While enabled, every callback, source, bus and effect is timed and
+    /// the results are gathered during `update`; while disabled the cost is negligible.
+    /// \param[in]  enabled  whether to profile [default: `False`]
+    auto setProfilerEnabled(Bool enabled) -> void;
+
+    [[nodiscard]]
+    auto isProfilerEnabled() const -> Bool;
+
+    /// \param[in]  topN  maximum number of sources and of effects to list, most expensive first
+    /// \returns audio thread timings over the last `AudioProfiler::WindowCallbacks` callbacks gathered by `update`
+    [[nodiscard]]
+    auto getProfilerStats(Int topN = 8) const -> AudioProfilerStats;
+
+    /// Get how long the device's callbacks take against their deadline, with underruns, near misses and the
+    /// buffer size adaptive mode settled on, see `AudioEngineInit::maxBufferFrameSize`. Counted since the engine
+    /// opened or the last `resetLatencyHistogram`, and read without locks, so it may be polled every frame.
+    /// \returns the histogram, all zero for devices that do not measure their callbacks.
+    [[nodiscard]]
+    auto getLatencyHistogram() const -> AudioLatencyHistogram;
+
+    /// Clear the counts of the latency histogram, keeping the current buffer size
+    auto resetLatencyHistogram() -> void;
+
+    /// \returns hits, misses and memory of the cache of decoded blocks that instances of `Sound::Compressed` sounds
+    ///          share; see `Sound::getMemoryUsage` for a single sound's share
+    [[nodiscard]]
+    auto getBlockCacheStats() const -> BlockCache::Stats;
+
+    /// Set how much memory decoded blocks of `Sound::Compressed` sounds may take, evicting the least recently used
+    /// blocks over it
+    /// \param[in]  bytes  budget in bytes [default: `BlockCache::DefaultCapacity`, 32 MiB]
+    auto setBlockCacheCapacity(Size bytes) -> void;
+
+    /// Set the point of view that emitters are panned and attenuated around. Published on the next `update`.
+    auto setListener(const Listener &listener) -> void;
+
+    [[nodiscard]]
+    auto getListener() const -> const Listener &;
+
+    /// Position a sound instance or bus in the 2D scene. Positions are published all at once on the next
+    /// `update`, and the audio thread pans and attenuates every emitter in one pass per callback, moving each
+    /// along its velocity between updates and ramping its gains across the buffer. Mono and stereo sources are
+    /// positioned in buses of two or more channels; stereo sources are balanced rather than panned. Other sources
+    /// mix as if unpositioned. The source's own volume, panner and effects still apply.
+    /// \param[in]  source   source to position
+    /// \param[in]  emitter  position, velocity and attenuation
+    /// \returns whether the source is positioned, `False` if the handle is invalid or every slot is taken, see
+    ///          `AudioEngineInit::maxEmitters`.
+    auto setEmitter(const Handle<AudioSource> &source, const Emitter &emitter) -> Bool;
+
+    /// Stop positioning a source, mixing it as before `setEmitter` from the next `update`. Released sources stop
+    /// being positioned on their own.
+    auto removeEmitter(const Handle<AudioSource> &source) -> void;
+
+    /// Get the newest loudness, peak and spectrum measurements of an analyzer tap, which sources and buses meter
+    /// their output on with `AudioSource::setAnalyzerTap`. Taken without locks from what the audio thread last
+    /// published, so it may be read every game frame.
+    /// \param[in]  tap  tap index from `0` to `AnalyzerTaps::MaxTaps - 1`
+    /// \returns the reading, valid until the next call for the same tap, or null if `tap` is out of range.
+    [[nodiscard]]
+    auto getAnalyzerReading(Int tap) -> const AnalyzerReading *;
+
+    /// Compute the spectrum of an analyzer tap, see `AnalyzerReading::spectrum`, at the cost of a 2048-point
+    /// transform every 1024 frames on the audio thread
+    /// \param[in]  tap      tap index from `0` to `AnalyzerTaps::MaxTaps - 1`
+    /// \param[in]  enabled  whether to compute the spectrum [default: `False`]
+    auto setAnalyzerSpectrum(Int tap, Bool enabled) -> void;
+
+    [[nodiscard]]
+    auto getAnalyzerSpectrum(Int tap) const -> Bool;
+
     /// Call this once per game frame ~30-60fps
     auto update() -> void;
 
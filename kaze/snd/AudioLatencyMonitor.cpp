@@ -0,0 +1,140 @@
+#include "AudioLatencyMonitor.h"
+
+#include <algorithm>
+
+KSND_NS_BEGIN
+
+auto AudioLatencyMonitor::prepare(const Int periodFrames, const Int minFrames, const Int maxFrames,
+    const Int sampleRate, const Bool reportsUnderruns) -> void
+{
+    if (minFrames > 0 && minFrames < maxFrames)
+    {
+        m_minFrames = minFrames;
+        m_maxFrames = maxFrames;
+    }
+    else
+    {
+        m_minFrames = m_maxFrames = periodFrames;
+    }
+
+    m_sampleRate = sampleRate;
+    m_reportsUnderruns = reportsUnderruns;
+    m_stableFrames = 0;
+    m_periodFrames.store(std::clamp(periodFrames, m_minFrames, m_maxFrames), std::memory_order_relaxed);
+    m_pending.store(False, std::memory_order_relaxed);
+    m_totalUnderruns.store(0, std::memory_order_relaxed);
+    reset();
+}
+
+auto AudioLatencyMonitor::beginCallback() -> void
+{
+    m_callbackStart = Clock::now();
+}
+
+auto AudioLatencyMonitor::endCallback(const Int64 frames, const Bool underrun) -> void
+{
+    record(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_callbackStart).count(), frames,
+        underrun);
+}
+
+auto AudioLatencyMonitor::record(const Int64 nanos, const Int64 frames, Bool underrun) -> void
+{
+    if (frames <= 0 || m_sampleRate <= 0)
+        return;
+
+    const auto deadlineNanos = static_cast<Double>(frames) * 1'000'000'000.0 / m_sampleRate;
+    const auto load = static_cast<Double>(nanos) / deadlineNanos;
+    if ( !m_reportsUnderruns )
+        underrun = load > 1.0;
+
+    const auto bucket = std::min(static_cast<Int>(load * 100.0 / AudioLatencyHistogram::BucketPercent),
+        AudioLatencyHistogram::Buckets - 1);
+    m_load[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_callbacks.fetch_add(1, std::memory_order_relaxed);
+    if (underrun)
+    {
+        m_underruns.fetch_add(1, std::memory_order_relaxed);
+        m_totalUnderruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if (load >= NearMissLoad)
+    {
+        m_nearMisses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (nanos > m_worstNanos.load(std::memory_order_relaxed))
+        m_worstNanos.store(nanos, std::memory_order_relaxed);
+
+    if (isAdaptive())
+        adapt(load, frames, underrun);
+}
+
+auto AudioLatencyMonitor::adapt(const Double load, const Int64 frames, const Bool underrun) -> void
+{
+    // Wait for the device to settle on the last period chosen
+    if (m_pending.load(std::memory_order_relaxed))
+        return;
+
+    const auto period = m_periodFrames.load(std::memory_order_relaxed);
+    auto next = period;
+    if (underrun || load >= NearMissLoad)
+    {
+        m_stableFrames = 0;
+        next = std::min(period * 2, m_maxFrames);
+    }
+    else if (load < ShrinkLoad)
+    {
+        m_stableFrames += frames;
+        if (m_stableFrames >= static_cast<Int64>(m_sampleRate) * StableSeconds)
+        {
+            m_stableFrames = 0;
+            next = std::max(period / 2, m_minFrames);
+        }
+    }
+    else
+    {
+        m_stableFrames = 0;
+    }
+
+    if (next == period)
+        return;
+
+    m_periodFrames.store(next, std::memory_order_relaxed);
+    m_periodChanges.fetch_add(1, std::memory_order_relaxed);
+    m_pending.store(True, std::memory_order_release);
+}
+
+auto AudioLatencyMonitor::applyPeriod(const Int frames) -> void
+{
+    m_periodFrames.store(std::clamp(frames, m_minFrames, m_maxFrames), std::memory_order_relaxed);
+    m_pending.store(False, std::memory_order_release);
+}
+
+auto AudioLatencyMonitor::getHistogram() const -> AudioLatencyHistogram
+{
+    AudioLatencyHistogram histogram{};
+    for (Int i = 0; i < AudioLatencyHistogram::Buckets; ++i)
+        histogram.load[i] = m_load[i].load(std::memory_order_relaxed);
+    histogram.callbacks = m_callbacks.load(std::memory_order_relaxed);
+    histogram.nearMisses = m_nearMisses.load(std::memory_order_relaxed);
+    histogram.underruns = m_underruns.load(std::memory_order_relaxed);
+    histogram.worstMs = static_cast<Double>(m_worstNanos.load(std::memory_order_relaxed)) / 1'000'000.0;
+    histogram.periodFrames = getPeriodFrames();
+    histogram.minPeriodFrames = m_minFrames;
+    histogram.maxPeriodFrames = m_maxFrames;
+    histogram.periodChanges = m_periodChanges.load(std::memory_order_relaxed);
+    histogram.latencyMs = m_sampleRate > 0 ? histogram.periodFrames * 1000.0 / m_sampleRate : 0;
+    return histogram;
+}
+
+auto AudioLatencyMonitor::reset() -> void
+{
+    for (auto &bucket : m_load)
+        bucket.store(0, std::memory_order_relaxed);
+    m_callbacks.store(0, std::memory_order_relaxed);
+    m_nearMisses.store(0, std::memory_order_relaxed);
+    m_underruns.store(0, std::memory_order_relaxed);
+    m_worstNanos.store(0, std::memory_order_relaxed);
+    m_periodChanges.store(0, std::memory_order_relaxed);
+}
+
+KSND_NS_END
@@ -0,0 +1,126 @@
+#pragma once
+#include <kaze/snd/lib.h>
+
+#include <atomic>
+#include <chrono>
+
+KSND_NS_BEGIN
+
+/// Callback timings and underruns of an audio device, reported by `AudioEngine::getLatencyHistogram`
+struct AudioLatencyHistogram {
+    static constexpr Int Buckets = 12;       ///< number of load buckets
+    static constexpr Int BucketPercent = 10; ///< share of the period each load bucket spans
+
+    /// Callbacks by the time they took as a share of their period: bucket `i` counts loads from `i * 10%` up to
+    /// `(i + 1) * 10%`, and the last bucket every load from 110% up
+    Uint64 load[Buckets];
+    Uint64 callbacks;     ///< callbacks measured
+    Uint64 nearMisses;    ///< callbacks that took `AudioLatencyMonitor::NearMissLoad` of their period or more,
+                          ///< without an underrun
+    Uint64 underruns;     ///< underruns reported by the device, or on devices that cannot report them, callbacks
+                          ///< that took longer than their period
+    Double worstMs;       ///< longest callback
+    Int periodFrames;     ///< frames rendered per callback now
+    Int minPeriodFrames;  ///< lower bound of the adaptive period, `periodFrames` when fixed
+    Int maxPeriodFrames;  ///< upper bound of the adaptive period, `periodFrames` when fixed
+    Uint64 periodChanges; ///< times adaptive mode grew or shrank the period
+    Double latencyMs;     ///< playback time of one period, the latency the engine's buffering adds
+};
+
+/// Watches the callbacks of an audio device for underruns and near misses, and in adaptive mode picks the period
+/// the device should render at.
+///
+/// The audio thread records every callback into relaxed atomic counters, so any thread may read them without
+/// locking. In adaptive mode, an underrun or a near miss doubles the period up to its upper bound, and
+/// `StableSeconds` of callbacks under `ShrinkLoad` halve it down to its lower bound. The device applies a new
+/// period at a point where it can change it safely, e.g. between buffers or by reopening its stream, and
+/// reports it back with `applyPeriod`; no further change is made until it has.
+class AudioLatencyMonitor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr Double NearMissLoad = .8; ///< share of the period past which a callback is a near miss
+    static constexpr Double ShrinkLoad = .4;   ///< share of the period under which a callback counts as stable
+    static constexpr Int StableSeconds = 5;    ///< stable playback before adaptive mode shrinks the period
+
+    AudioLatencyMonitor() = default;
+    KAZE_NO_COPY(AudioLatencyMonitor);
+
+    /// Set the period and clear all counts. Call on open, before the device starts calling back.
+    /// \param[in]  periodFrames       frames per callback to start at, clamped within the bounds
+    /// \param[in]  minFrames          lower bound of the adaptive period; adaptive mode is on when both bounds
+    ///                                are positive and `minFrames < maxFrames`
+    /// \param[in]  maxFrames          upper bound of the adaptive period
+    /// \param[in]  sampleRate         output sample rate, to find each callback's deadline
+    /// \param[in]  reportsUnderruns   whether the device passes its own underruns to `endCallback`; when it
+    ///                                does not, callbacks that take longer than their period count instead
+    auto prepare(Int periodFrames, Int minFrames, Int maxFrames, Int sampleRate, Bool reportsUnderruns) -> void;
+
+    /// Start timing a callback. Audio thread only.
+    auto beginCallback() -> void;
+
+    /// Finish timing a callback started with `beginCallback`. Audio thread only.
+    /// \param[in]  frames    frames rendered in the callback
+    /// \param[in]  underrun  whether the device reported running out of audio before this callback
+    auto endCallback(Int64 frames, Bool underrun) -> void;
+
+    /// Record a callback the device timed itself. Audio thread only.
+    /// \param[in]  nanos     time spent in the callback
+    /// \param[in]  frames    frames rendered in the callback
+    /// \param[in]  underrun  whether the device reported running out of audio before this callback
+    auto record(Int64 nanos, Int64 frames, Bool underrun) -> void;
+
+    /// \returns whether adaptive mode chose a period the device has not applied yet. Any thread.
+    [[nodiscard]]
+    auto hasPendingPeriod() const -> Bool { return m_pending.load(std::memory_order_acquire); }
+
+    /// \returns frames per callback the device should render at. Any thread.
+    [[nodiscard]]
+    auto getPeriodFrames() const -> Int { return m_periodFrames.load(std::memory_order_relaxed); }
+
+    /// Report the period the device renders at from now on, normally `getPeriodFrames`, or the old one if it
+    /// could not change. Lets adaptive mode choose again. Device thread that applies the change only.
+    /// \param[in]  frames  frames per callback
+    auto applyPeriod(Int frames) -> void;
+
+    /// \returns the largest period adaptive mode may choose, what buffers must be reserved for
+    [[nodiscard]]
+    auto getMaxPeriodFrames() const -> Int { return m_maxFrames; }
+
+    [[nodiscard]]
+    auto isAdaptive() const -> Bool { return m_minFrames < m_maxFrames; }
+
+    /// \returns underruns since `prepare`, not cleared by `reset`. Any thread.
+    [[nodiscard]]
+    auto getUnderrunCount() const -> Uint64 { return m_totalUnderruns.load(std::memory_order_relaxed); }
+
+    /// \returns the counts since `prepare` or the last `reset`. Any thread.
+    [[nodiscard]]
+    auto getHistogram() const -> AudioLatencyHistogram;
+
+    /// Clear the counts of the histogram, keeping the period. Any thread.
+    auto reset() -> void;
+
+private:
+    /// Choose the next period after a callback. Audio thread.
+    auto adapt(Double load, Int64 frames, Bool underrun) -> void;
+
+    // Audio thread
+    Clock::time_point m_callbackStart{};
+    Int64 m_stableFrames{};
+
+    // Shared
+    std::atomic<Uint64> m_load[AudioLatencyHistogram::Buckets]{};
+    std::atomic<Uint64> m_callbacks{}, m_nearMisses{}, m_underruns{}, m_totalUnderruns{};
+    std::atomic<Int64> m_worstNanos{};
+    std::atomic<Int> m_periodFrames{};
+    std::atomic<Bool> m_pending{};
+    std::atomic<Uint64> m_periodChanges{};
+
+    // Fixed by `prepare`
+    Int m_minFrames{}, m_maxFrames{};
+    Int m_sampleRate{};
+    Bool m_reportsUnderruns{};
+};
+
+KSND_NS_END
@@ -0,0 +1,127 @@
+#pragma once
+#include <kaze/snd/lib.h>
+
+#include <atomic>
+#include <cmath>
+
+KSND_NS_BEGIN
+
+/// Kind of value an `AudioParam` holds
+enum class ParamType : Ubyte {
+    Float, ///< continuous, ramped across each block so that changes do not click
+    Int,   ///< whole number, applied at the start of the next block
+    Enum,  ///< index into a fixed set of options, applied at the start of the next block
+};
+
+/// An effect parameter declared up front with its type and range.
+///
+/// Any thread may `set` the target, which is a single atomic store, so gameplay code can automate parameters at
+/// any rate without queueing commands or allocating; only the latest value per block is heard. The audio thread
+/// takes one `Ramp` per block from `nextRamp`, which moves from the value it ended the last block on to the
+/// target. The first ramp after `reset` starts right at the target, so values set before a source plays do not
+/// fade in.
+class AudioParam {
+public:
+    /// Start and end value of a parameter over one block
+    struct Ramp {
+        Float start, end;
+
+        /// \returns whether the value holds still across the block
+        [[nodiscard]]
+        auto isSteady() const noexcept -> Bool { return start == end; }
+    };
+
+    /// \param[in]  name   display name, must outlive the parameter, e.g. a string literal
+    /// \param[in]  type   kind of value
+    /// \param[in]  value  initial value
+    /// \param[in]  min    smallest value
+    /// \param[in]  max    largest value; for `ParamType::Enum` the number of options minus one
+    AudioParam(Cstring name, ParamType type, Float value, Float min, Float max) :
+        m_name(name), m_type(type), m_min(min), m_max(max), m_target(constrain(value)), m_start(m_target),
+        m_current(m_target)
+    { }
+
+    AudioParam(AudioParam &&other) noexcept :
+        m_name(other.m_name), m_type(other.m_type), m_min(other.m_min), m_max(other.m_max),
+        m_target(other.m_target.load(std::memory_order_relaxed)), m_start(other.m_start), m_current(other.m_current),
+        m_hasRamped(other.m_hasRamped)
+    { }
+
+    KAZE_NO_COPY(AudioParam);
+
+    [[nodiscard]]
+    auto getName() const noexcept -> Cstring { return m_name; }
+    [[nodiscard]]
+    auto getType() const noexcept -> ParamType { return m_type; }
+    [[nodiscard]]
+    auto getMin() const noexcept -> Float { return m_min; }
+    [[nodiscard]]
+    auto getMax() const noexcept -> Float { return m_max; }
+
+    /// Set the value to move to, clamped to the range and rounded for whole-number types. Any thread.
+    auto set(Float value) noexcept -> void { m_target.store(constrain(value), std::memory_order_relaxed); }
+
+    /// \returns the last value set. Any thread.
+    [[nodiscard]]
+    auto get() const noexcept -> Float { return m_target.load(std::memory_order_relaxed); }
+
+    /// \returns the last value set, as a whole number. Any thread.
+    [[nodiscard]]
+    auto getInt() const noexcept -> Int { return static_cast<Int>(get()); }
+
+    /// Jump straight to `value`, without ramping into it. Only while the audio thread is not processing the
+    /// parameter, e.g. from an effect's `init_`.
+    auto reset(Float value) noexcept -> void
+    {
+        m_current = m_start = constrain(value);
+        m_target.store(m_current, std::memory_order_relaxed);
+        m_hasRamped = False;
+    }
+
+    /// Change the range, clamping the value into it. Only while the audio thread is not processing the parameter.
+    auto setRange(Float min, Float max) noexcept -> void
+    {
+        m_min = min;
+        m_max = max;
+        reset(get());
+    }
+
+    /// Take the ramp for the next block, from the value at the end of the last block to the current target.
+    /// Whole-number types jump instead of ramping. Audio thread only.
+    auto nextRamp() noexcept -> Ramp
+    {
+        const auto target = m_target.load(std::memory_order_relaxed);
+        const auto start = (m_hasRamped && m_type == ParamType::Float) ? m_current : target;
+        m_start = start;
+        m_current = target;
+        m_hasRamped = True;
+        return {start, target};
+    }
+
+    /// \returns the value the last block ended on. Audio thread only.
+    [[nodiscard]]
+    auto current() const noexcept -> Float { return m_current; }
+
+    /// \returns the ramp taken by the last `nextRamp`, for code that applies the parameter after its owner has
+    ///          processed the block. Audio thread only.
+    [[nodiscard]]
+    auto lastRamp() const noexcept -> Ramp { return {m_start, m_current}; }
+
+private:
+    auto constrain(Float value) const noexcept -> Float
+    {
+        if (m_type != ParamType::Float)
+            value = std::round(value);
+        return value < m_min ? m_min : (value > m_max ? m_max : value);
+    }
+
+    Cstring m_name;
+    ParamType m_type;
+    Float m_min, m_max;
+    std::atomic<Float> m_target; ///< set from any thread
+    Float m_start;               ///< value at the start of the last block, audio thread only
+    Float m_current;             ///< value at the end of the last block, audio thread only
+    Bool m_hasRamped{};
+};
+
+KSND_NS_END
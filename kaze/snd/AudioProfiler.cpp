@@ -0,0 +1,248 @@
+#include "AudioProfiler.h"
+
+#include <algorithm>
+#include <limits>
+
+KSND_NS_BEGIN
+
+/// Time spent in scopes nested inside the innermost open scope on this thread, so that each scope reports its
+/// self time only
+static thread_local Int64 t_childNanos;
+
+static auto toNanos(const AudioProfiler::Clock::duration duration) -> Int64
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+static auto toMs(const Double nanos) -> Double
+{
+    return nanos / 1'000'000.0;
+}
+
+AudioProfiler::Scope::Scope(AudioProfiler &profiler, const ProfileKind kind, const void *object,
+    const std::type_info &type) :
+    m_profiler(profiler.m_current.load(std::memory_order_relaxed) ? &profiler : Null),
+    m_object(object), m_type(&type), m_start(), m_outerChildNanos(), m_kind(kind)
+{
+    if ( !m_profiler )
+        return;
+
+    m_outerChildNanos = t_childNanos;
+    t_childNanos = 0;
+    m_start = Clock::now();
+}
+
+AudioProfiler::Scope::~Scope()
+{
+    if ( !m_profiler )
+        return;
+
+    const auto elapsed = toNanos(Clock::now() - m_start);
+    const auto self = std::max<Int64>(elapsed - t_childNanos, 0);
+    t_childNanos = m_outerChildNanos + elapsed;
+
+    m_profiler->addEntry({
+        .object = m_object,
+        .type = m_type,
+        .nanos = static_cast<Uint>(std::min<Int64>(self, std::numeric_limits<Uint>::max())),
+        .kind = m_kind,
+    });
+}
+
+auto AudioProfiler::setEnabled(const Bool enabled, const Uint64 deviceUnderruns) -> void
+{
+    if ( !enabled )
+    {
+        m_enabled.store(False, std::memory_order_relaxed);
+        return;
+    }
+
+    if (m_records.empty())
+        m_records = List<Record>(RecordCapacity);
+
+    // Skip records left over from an earlier run
+    m_head.store(m_tail.load(std::memory_order_acquire), std::memory_order_release);
+    m_dropped.store(0, std::memory_order_relaxed);
+
+    resetWindow();
+    m_lastWindow = {};
+    m_hasLastWindow = False;
+    m_lastUnderruns = deviceUnderruns;
+
+    m_enabled.store(True, std::memory_order_release);
+}
+
+auto AudioProfiler::beginCallback() -> void
+{
+    if ( !m_enabled.load(std::memory_order_acquire) )
+        return;
+
+    const auto tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_head.load(std::memory_order_acquire) >= RecordCapacity)
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const auto record = &m_records[tail & (RecordCapacity - 1)];
+    record->entryCount.store(0, std::memory_order_relaxed);
+
+    t_childNanos = 0;
+    m_callbackStart = Clock::now();
+    m_current.store(record, std::memory_order_relaxed);
+}
+
+auto AudioProfiler::endCallback(const Int64 frames, const Int sampleRate) -> void
+{
+    const auto record = m_current.load(std::memory_order_relaxed);
+    if ( !record )
+        return;
+    m_current.store(Null, std::memory_order_relaxed);
+
+    record->callbackNanos = toNanos(Clock::now() - m_callbackStart);
+    record->deadlineNanos = sampleRate > 0 ? frames * 1'000'000'000 / sampleRate : 0;
+
+    // Mixer threads finished their entries before the mixer pool returned, so publishing here covers them too
+    m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+auto AudioProfiler::addEntry(const Entry &entry) -> void
+{
+    const auto record = m_current.load(std::memory_order_relaxed);
+    const auto index = record->entryCount.fetch_add(1, std::memory_order_relaxed);
+    if (index < MaxEntries)
+        record->entries[index] = entry;
+}
+
+auto AudioProfiler::collect(const Uint64 deviceUnderruns) -> void
+{
+    if (m_records.empty())
+        return;
+
+    auto head = m_head.load(std::memory_order_relaxed);
+    const auto tail = m_tail.load(std::memory_order_acquire);
+    for (; head != tail; ++head)
+    {
+        fold(m_records[head & (RecordCapacity - 1)]);
+    }
+    m_head.store(head, std::memory_order_release);
+
+    m_window.underruns += deviceUnderruns - m_lastUnderruns;
+    m_lastUnderruns = deviceUnderruns;
+}
+
+auto AudioProfiler::fold(const Record &record) -> void
+{
+    ++m_folded;
+
+    auto &window = m_window;
+    ++window.callbacks;
+    window.totalNanos += record.callbackNanos;
+    window.maxNanos = std::max(window.maxNanos, record.callbackNanos);
+    window.deadlineNanos = record.deadlineNanos;
+    if (record.deadlineNanos > 0 && record.callbackNanos > record.deadlineNanos)
+        ++window.deadlineMisses;
+
+    const auto count = std::min(record.entryCount.load(std::memory_order_relaxed), MaxEntries);
+    for (Int i = 0; i < count; ++i)
+    {
+        const auto &entry = record.entries[i];
+        auto &acc = window.objects[entry.object];
+        if (acc.record != m_folded)
+        {
+            flushRecord(acc);
+            acc.record = m_folded;
+        }
+
+        // A bus is timed both as a source and while mixing; report it as a bus
+        if (acc.type == Null || entry.kind == ProfileKind::Bus)
+        {
+            acc.type = entry.type;
+            acc.kind = entry.kind;
+        }
+
+        acc.totalNanos += entry.nanos;
+        acc.recordNanos += entry.nanos;
+    }
+
+    if (window.callbacks >= WindowCallbacks)
+    {
+        for (auto &[object, acc] : window.objects)
+            flushRecord(acc);
+        m_lastWindow = std::move(window);
+        m_hasLastWindow = True;
+        resetWindow();
+    }
+}
+
+auto AudioProfiler::flushRecord(Accumulator &acc) -> void
+{
+    acc.maxNanos = std::max(acc.maxNanos, acc.recordNanos);
+    acc.recordNanos = 0;
+}
+
+auto AudioProfiler::resetWindow() -> void
+{
+    m_window.callbacks = 0;
+    m_window.totalNanos = 0;
+    m_window.maxNanos = 0;
+    m_window.deadlineNanos = 0;
+    m_window.deadlineMisses = 0;
+    m_window.underruns = 0;
+    m_window.objects.clear();
+}
+
+auto AudioProfiler::getStats(const Int topN) const -> AudioProfilerStats
+{
+    const auto &window = m_hasLastWindow ? m_lastWindow : m_window;
+
+    AudioProfilerStats stats{};
+    stats.callbacks = window.callbacks;
+    stats.maxMs = toMs(static_cast<Double>(window.maxNanos));
+    stats.deadlineMs = toMs(static_cast<Double>(window.deadlineNanos));
+    stats.deadlineMisses = window.deadlineMisses;
+    stats.underruns = window.underruns;
+    stats.droppedCallbacks = m_dropped.load(std::memory_order_relaxed);
+    if (window.callbacks == 0)
+        return stats;
+
+    const auto callbacks = static_cast<Double>(window.callbacks);
+    stats.averageMs = toMs(static_cast<Double>(window.totalNanos) / callbacks);
+    if (stats.deadlineMs > 0)
+    {
+        stats.averageLoad = stats.averageMs / stats.deadlineMs * 100.0;
+        stats.maxLoad = stats.maxMs / stats.deadlineMs * 100.0;
+    }
+
+    for (const auto &[object, acc] : window.objects)
+    {
+        const auto entry = AudioProfileEntry {
+            .object = object,
+            .type = acc.type,
+            .kind = acc.kind,
+            .averageMs = toMs(static_cast<Double>(acc.totalNanos) / callbacks),
+            .maxMs = toMs(static_cast<Double>(std::max(acc.maxNanos, acc.recordNanos))),
+            .share = window.totalNanos > 0 ?
+                static_cast<Double>(acc.totalNanos) / static_cast<Double>(window.totalNanos) : 0,
+        };
+
+        if (acc.kind == ProfileKind::Effect)
+            stats.effects.emplace_back(entry);
+        else
+            stats.sources.emplace_back(entry);
+    }
+
+    const auto keepTop = [topN](List<AudioProfileEntry> &entries) {
+        std::sort(entries.begin(), entries.end(), [](const AudioProfileEntry &a, const AudioProfileEntry &b) {
+            return a.averageMs > b.averageMs;
+        });
+        if (static_cast<Int>(entries.size()) > topN)
+            entries.resize(std::max(topN, 0));
+    };
+    keepTop(stats.sources);
+    keepTop(stats.effects);
+
+    return stats;
+}
+
+KSND_NS_END
@@ -0,0 +1,163 @@
+#pragma once
+#include <kaze/snd/lib.h>
+
+#include <atomic>
+#include <chrono>
+#include <typeinfo>
+#include <unordered_map>
+
+KSND_NS_BEGIN
+
+/// Kind of work timed by the `AudioProfiler`
+enum class ProfileKind : Ubyte {
+    Source, ///< an AudioSource rendering its own content, e.g. decoding or resampling
+    Bus,    ///< an AudioBus mixing its sources
+    Effect, ///< an AudioEffect processing a source's buffer
+};
+
+/// Time spent in one source, bus or effect over a profiler window
+struct AudioProfileEntry {
+    const void *object;         ///< the AudioSource or AudioEffect timed, compare with `Handle::get`
+    const std::type_info *type; ///< its concrete type
+    ProfileKind kind;
+    Double averageMs;           ///< time per callback, averaged over the window
+    Double maxMs;               ///< longest time in a single callback
+    Double share;               ///< fraction of all callback time in the window, from `0` to `1`
+};
+
+/// Rolling audio thread timings reported by `AudioEngine::getProfilerStats`
+struct AudioProfilerStats {
+    Int callbacks;           ///< callbacks measured in the window
+    Double averageMs;        ///< average time spent in the audio callback
+    Double maxMs;            ///< longest audio callback
+    Double deadlineMs;       ///< playback time of one buffer, which each callback must finish within
+    Double averageLoad;      ///< `averageMs` as a percentage of `deadlineMs`
+    Double maxLoad;          ///< `maxMs` as a percentage of `deadlineMs`
+    Int deadlineMisses;      ///< callbacks that took longer than `deadlineMs`
+    Uint64 underruns;        ///< underruns reported by the device in the window, if it reports them
+    Uint64 droppedCallbacks; ///< callbacks not measured because `update` was not called often enough, cumulative
+
+    /// Most expensive sources and buses, by self time: a bus does not include its sources, and a source does
+    /// not include its effects
+    List<AudioProfileEntry> sources;
+    List<AudioProfileEntry> effects; ///< most expensive effects
+};
+
+/// Measures where the audio thread spends its time.
+///
+/// The audio thread and mixer threads write timestamps into a per-callback record without locking or allocating;
+/// finished records are handed to the owning thread through a fixed ring and folded into windows of
+/// `WindowCallbacks` callbacks during `collect`. Stats describe the last full window. While disabled, each timed
+/// scope costs one relaxed load.
+class AudioProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr Int MaxEntries = 512;     ///< timed scopes kept per callback, the rest are dropped
+    static constexpr Size RecordCapacity = 32; ///< callbacks that may wait for `collect`, power of two
+    static constexpr Int WindowCallbacks = 64; ///< callbacks per stats window
+
+    AudioProfiler() = default;
+    KAZE_NO_COPY(AudioProfiler);
+
+    /// Times a source, bus or effect from construction to destruction, excluding the time of scopes nested
+    /// inside it on the same thread. Audio or mixer threads only.
+    class Scope {
+    public:
+        Scope(AudioProfiler &profiler, ProfileKind kind, const void *object, const std::type_info &type);
+        ~Scope();
+
+        KAZE_NO_COPY(Scope);
+    private:
+        AudioProfiler *m_profiler;
+        const void *m_object;
+        const std::type_info *m_type;
+        Clock::time_point m_start;
+        Int64 m_outerChildNanos;
+        ProfileKind m_kind;
+    };
+
+    /// Start or stop measuring. Enabling discards previous stats. Owning thread only.
+    /// \param[in]  enabled          whether to measure
+    /// \param[in]  deviceUnderruns  cumulative underrun count reported by the device, counted from on enable
+    auto setEnabled(Bool enabled, Uint64 deviceUnderruns = 0) -> void;
+
+    [[nodiscard]]
+    auto isEnabled() const -> Bool { return m_enabled.load(std::memory_order_relaxed); }
+
+    /// Start measuring a callback. Audio thread only.
+    auto beginCallback() -> void;
+
+    /// Finish measuring a callback and hand its record to the owning thread. Audio thread only.
+    /// \param[in]  frames      frames rendered in the callback
+    /// \param[in]  sampleRate  output sample rate, to find the callback's deadline
+    auto endCallback(Int64 frames, Int sampleRate) -> void;
+
+    /// Fold finished records into the current window. Owning thread only.
+    /// \param[in]  deviceUnderruns  cumulative underrun count reported by the device
+    auto collect(Uint64 deviceUnderruns) -> void;
+
+    /// \param[in]  topN  maximum number of sources and of effects to list
+    /// \returns stats of the last full window, or of the callbacks so far if no window has completed yet.
+    ///          Owning thread only.
+    [[nodiscard]]
+    auto getStats(Int topN) const -> AudioProfilerStats;
+
+private:
+    struct Entry {
+        const void *object;
+        const std::type_info *type;
+        Uint nanos;
+        ProfileKind kind;
+    };
+
+    struct Record {
+        Int64 callbackNanos;
+        Int64 deadlineNanos;
+        std::atomic<Int> entryCount;
+        Entry entries[MaxEntries];
+    };
+
+    /// Per-object totals within a window
+    struct Accumulator {
+        const std::type_info *type;
+        ProfileKind kind;
+        Int64 totalNanos;
+        Int64 maxNanos;
+        Int64 recordNanos; ///< time in the record being folded, an object may be timed more than once per callback
+        Uint64 record;     ///< index of the record `recordNanos` belongs to
+    };
+
+    struct Window {
+        Int callbacks;
+        Int64 totalNanos;
+        Int64 maxNanos;
+        Int64 deadlineNanos;
+        Int deadlineMisses;
+        Uint64 underruns;
+        std::unordered_map<const void *, Accumulator> objects;
+    };
+
+    auto addEntry(const Entry &entry) -> void;
+    auto fold(const Record &record) -> void;
+    auto resetWindow() -> void;
+    static auto flushRecord(Accumulator &acc) -> void;
+
+    // Audio thread
+    std::atomic<Bool> m_enabled{};
+    std::atomic<Record *> m_current{};
+    Clock::time_point m_callbackStart{};
+
+    // Ring of records, audio thread -> owning thread
+    List<Record> m_records{};
+    std::atomic<Uint64> m_head{}, m_tail{};
+    std::atomic<Uint64> m_dropped{};
+
+    // Owning thread
+    Window m_window{}, m_lastWindow{};
+    Bool m_hasLastWindow{};
+    Uint64 m_folded{};
+    Uint64 m_lastUnderruns{};
+};
+
+KSND_NS_END
@@ -1,8 +1,12 @@
 #include "AudioSource.h"
 #include <kaze/snd/AudioCommands.h>
-#include <kaze/core/intrinsics.h>
+#include <kaze/snd/dsp/kernels.h>
+
+#include <kaze/core/math/mathf.h>
 #include <kaze/core/memory.h>
 
+#include <algorithm>
+
 KSND_NS_BEGIN
 
 // Returns if AudioSource is accessed via an invalid handle
@@ -22,10 +26,20 @@ AudioSource::AudioSource(AudioSource &&other) noexcept :
     m_volume(other.m_volume), m_panner(other.m_panner),
     m_effects(other.m_effects),
     m_outBuffer(std::move(other.m_outBuffer)), m_inBuffer(std::move(other.m_inBuffer)),
-    m_fadePoints(std::move(other.m_fadePoints)), m_fadeValue(other.m_fadeValue),
-    m_clock(other.m_clock), m_parentClock(other.m_parentClock),
+    m_fadePoints(std::move(other.m_fadePoints)), m_fadeCursor(other.m_fadeCursor),
+    m_fadeStart(other.m_fadeStart), m_fadeSlope(other.m_fadeSlope), m_isFadeSegmentCached(other.m_isFadeSegmentCached),
+    m_fadeValue(other.m_fadeValue),
+    m_clock(other.m_clock.load(std::memory_order_relaxed)),
+    m_parentClock(other.m_parentClock.load(std::memory_order_relaxed)),
     m_paused(other.m_paused), m_pauseClock(other.m_pauseClock), m_unpauseClock(other.m_unpauseClock),
-    m_releaseOnPauseClock(other.m_releaseOnPauseClock), m_shouldDiscard(other.m_shouldDiscard)
+    m_releaseOnPauseClock(other.m_releaseOnPauseClock), m_shouldDiscard(other.m_shouldDiscard.load(std::memory_order_relaxed)),
+    m_isVirtual(other.m_isVirtual.load(std::memory_order_relaxed)), m_gain(other.m_gain.load(std::memory_order_relaxed)),
+    m_resampler(std::move(other.m_resampler)), m_pitch(other.m_pitch.load(std::memory_order_relaxed)),
+    m_resampleQuality(other.m_resampleQuality.load(std::memory_order_relaxed)),
+    m_sidechainTap(other.m_sidechainTap.load(std::memory_order_relaxed)),
+    m_analyzerTap(other.m_analyzerTap.load(std::memory_order_relaxed)),
+    m_emitter(other.m_emitter), m_spatialSlot(other.m_spatialSlot),
+    m_channels(other.m_channels)
 {
 
 }
@@ -33,18 +47,37 @@ AudioSource::AudioSource(AudioSource &&other) noexcept :
 auto AudioSource::init_(AudioContext *context, const Uint64 parentClock, const Bool paused) -> Bool
 {
     m_context = context;
-    m_clock = 0;
-    m_parentClock = parentClock;
+    m_clock.store(0, std::memory_order_relaxed);
+    m_parentClock.store(parentClock, std::memory_order_relaxed);
     m_paused = paused;
 
     m_pauseClock = std::numeric_limits<Uint64>::max();
     m_unpauseClock = std::numeric_limits<Uint64>::max();
 
-    m_shouldDiscard = False;
+    m_shouldDiscard.store(False, std::memory_order_relaxed);
+    m_isVirtual.store(False, std::memory_order_relaxed);
+    m_gain.store(1.f, std::memory_order_relaxed);
+    m_prerenderedLength = -1;
+    m_fadePoints.clear();
+    m_fadeCursor = 0;
+    m_isFadeSegmentCached = False;
     m_fadeValue = 1.f;
+    m_pitch.store(1.f, std::memory_order_relaxed);
+    m_resampleQuality.store(ResampleQuality::Sinc, std::memory_order_relaxed);
+    m_sidechainTap.store(-1, std::memory_order_relaxed);
+    m_analyzerTap.store(-1, std::memory_order_relaxed);
+    m_emitter = -1;
+    m_spatialSlot = -1;
+    m_channels = m_context->getSpec().channels;
+    m_resampler.setChannels(m_channels);
+    reserveBuffers();
 
     m_panner = m_context->createObjectImpl<PanEffect>();
     m_volume = m_context->createObjectImpl<VolumeEffect>();
+    m_panner->m_context = m_context; // lets the effects send parameter commands
+    m_volume->m_context = m_context;
+    m_panner->m_channels = m_channels;
+    m_volume->m_channels = m_channels;
 
     addEffectImpl(0, m_panner.cast<AudioEffect>());
     addEffectImpl(1, m_volume.cast<AudioEffect>());
@@ -53,6 +86,9 @@ auto AudioSource::init_(AudioContext *context, const Uint64 parentClock, const B
 
 auto AudioSource::release_() -> void // callback on destruct
 {
+    if (const auto tap = m_analyzerTap.exchange(-1, std::memory_order_relaxed); tap > -1)
+        m_context->getAnalyzerTaps().unclaim(tap, this);
+
     for (auto &effect : m_effects)
     {
         m_context->releaseObjectImpl(effect);
@@ -63,64 +99,54 @@ auto AudioSource::release_() -> void // callback on destruct
 auto AudioSource::release() -> void
 {
     HANDLE_GUARD();
-    m_shouldDiscard = True;
-    m_context->pushCommand(commands::ContextFlagRemovals {
-        .context = m_context,
-    });
-}
-
-/// Find starting fade point index, if there is no fade, e.g. < 2 points available, or the last fadepoint clock time
-/// was surpassed, -1 is returned.
-/// @param points list of points to check, must be sorted by clock time, low to high
-/// @param clock  current clock point to check
-/// @param outIndex [out] index to retrieve - this value is the last fadepoint that is less than `clock`, thus the
-///                       first of two points to interpolate the resulting fade value.
-/// @returns whether there is a next available fade at the index after `outIndex`. Since there must be a second
-///          fade point to interpolate between, this also means whether to perform the fade or not.
-static auto findFadePointIndex(const List<FadePoint> &points, const Uint64 clock, Int *outIndex) -> Bool
-{
-    Int res = -1;
-    const Size size = points.size();
-    for (Size i = 0; i < size; ++i)
-    {
-        if (points[i].clock > clock)
-        {
-            break;
-        }
-
-        ++res;
-    }
+    m_shouldDiscard.store(True, std::memory_order_release);
 
-    *outIndex = res;
-
-    return res + 1 < size;
+    // Flag directly instead of sending a command, since release may be called from the audio thread
+    // (e.g. one-shot ends), and the command queues only accept pushes from the engine's owning thread.
+    m_context->flagRemoveSource();
 }
 
-auto AudioSource::read(const Ubyte **pcmPtr, Int64 length) -> Int64
+auto AudioSource::read(const Ubyte **pcmPtr, Int64 length, Ubyte *target) -> Int64
 {
-    if (m_inBuffer.size() != length)
+    if (m_prerenderedLength > -1)
     {
-        m_inBuffer.resize(length, 0);
+        // Already rendered for this callback by the parallel mixer
+        const auto result = m_prerenderedLength;
+        m_prerenderedLength = -1;
+        if (target && result > 0)
+            memory::copy(target, m_outBuffer.data(), result);
+        if (pcmPtr && result > 0)
+            *pcmPtr = target ? target : m_outBuffer.data();
+        return result;
     }
 
-    if (m_outBuffer.size() != length)
+    auto &profiler = m_context->getProfiler();
+    const auto profile = AudioProfiler::Scope(profiler, ProfileKind::Source, this, typeid(*this));
+
+    // Within the capacity reserved on open unless the device delivers a larger buffer than it reported
+    if ( !target && m_outBuffer.size() != length )
     {
         m_outBuffer.resize(length, 0);
     }
 
-    memory::set(m_outBuffer.data(), 0, m_outBuffer.size());
+    const auto out = target ? target : m_outBuffer.data();
+    const auto bytesPerFrame = static_cast<Int64>(m_channels * sizeof(Float));
+    const auto isVirtual = m_isVirtual.load(std::memory_order_relaxed);
+    if ( !isVirtual )
+        memory::set(out, 0, length);
 
-    Int64 unpauseClock = (Int64)m_unpauseClock - (Int64)m_parentClock;
-    Int64 pauseClock = (Int64)m_pauseClock - (Int64)m_parentClock;
+    const auto parentClock = m_parentClock.load(std::memory_order_relaxed);
+    Int64 unpauseClock = (Int64)m_unpauseClock - (Int64)parentClock;
+    Int64 pauseClock = (Int64)m_pauseClock - (Int64)parentClock;
 
     for (Int i = 0; i < length;)
     {
         if (m_paused)
         {
             // Next unpause occurs within this chunk
-            if (unpauseClock < (length - i) / (2 * sizeof(Float)) && unpauseClock > -1)
+            if (unpauseClock < (length - i) / bytesPerFrame && unpauseClock > -1)
             {
-                i += (Int)unpauseClock;
+                i += static_cast<Int>(unpauseClock * bytesPerFrame);
 
                 if (pauseClock < unpauseClock) // if pause clock comes before unpause, unset it, it's redundant
                 {
@@ -141,13 +167,16 @@ auto AudioSource::read(const Ubyte **pcmPtr, Int64 length) -> Int64
         else
         {
             // Check if there is a pause clock ahead to see how many samples to read until then
-            const bool pauseThisFrame = (pauseClock < (length - i) / (2 * sizeof(Float)) && pauseClock > -1);
-            const Int64 bytesToRead = pauseThisFrame ? (Int64)pauseClock * 2LL * sizeof(Float) : length - i;
+            const bool pauseThisFrame = (pauseClock < (length - i) / bytesPerFrame && pauseClock > -1);
+            const Int64 bytesToRead = pauseThisFrame ? pauseClock * bytesPerFrame : length - i;
 
             Int bytesRead = 0;
             // read bytes here
             if (bytesToRead > 0)
-                bytesRead = readImpl(m_outBuffer.data() + i, bytesToRead);
+            {
+                bytesRead = isVirtual ? skipPitched(bytesToRead) :
+                    readPitched(out + i, bytesToRead);
+            }
 
             i += bytesRead;
 
@@ -170,234 +199,75 @@ auto AudioSource::read(const Ubyte **pcmPtr, Int64 length) -> Int64
             }
 
             if (pauseClock > -1)
-                pauseClock -= bytesToRead / (2 * sizeof(Float)); // 2 for each channel
+                pauseClock -= bytesToRead / bytesPerFrame;
             if (unpauseClock > -1)
-                unpauseClock -= bytesToRead / (2 * sizeof(Float)); // 2 for each channel
+                unpauseClock -= bytesToRead / bytesPerFrame;
         }
     }
 
-    const auto sampleCount = length / sizeof(Float);
-    for (auto &effect : m_effects)
+    if (isVirtual)
     {
-        if (effect->process((Float *)m_outBuffer.data(), (Float *)m_inBuffer.data(), (Int)sampleCount))
-        {
-            std::swap(m_outBuffer, m_inBuffer);
-
-            // clear inBuffer to 0
-            memory::set(m_inBuffer.data(), 0, m_inBuffer.size());
-        }
-
+        // Keep time with the fade points, but skip effects, fades and mixing
+        skipFade(parentClock, length / bytesPerFrame);
+        m_gain.store(m_fadeValue * m_volume->volume(), std::memory_order_relaxed);
+        m_clock.fetch_add(length / bytesPerFrame, std::memory_order_relaxed);
+        return 0;
     }
 
-    // Apply fade points
-    Int fadeIndex = -1;
-    Uint64 fadeClock = m_parentClock;
-
-    for (auto sample = (float *)m_outBuffer.data(), end = (float *)(m_outBuffer.data() + m_outBuffer.size());
-        sample < end;
-        )
+    const auto sampleCount = static_cast<Int64>(length / sizeof(Float));
+    for (auto &effect : m_effects)
     {
-        if (findFadePointIndex(m_fadePoints, fadeClock, &fadeIndex)) // returns whether we are currently in a fade
+        const auto profileEffect = AudioProfiler::Scope(profiler, ProfileKind::Effect, effect.get(),
+            typeid(*effect.get()));
+        if (effect->getProcessMode() == ProcessMode::InPlace)
         {
-            // Get fadepoint data
-            const auto clock0 = m_fadePoints[fadeIndex].clock; // starting clock
-            const auto value0 = m_fadePoints[fadeIndex].value; // starting value
-
-            const auto clock1 = m_fadePoints[fadeIndex + 1].clock; // end clock
-            const auto value1 = m_fadePoints[fadeIndex + 1].value; // end value
-
-            // Perform fade until end or clock1, whichever comes first
-            const auto fadeEnd = std::min<uint32_t>(static_cast<uint32_t>(end - sample) / 2U, clock1 + 1 - fadeClock);
-            const auto clockDiff = clock1 - clock0;
-            const auto valueDiff = value1 - value0;
-
-            uint32_t f = 0;
-#if KAZE_CPU_SSE
-            const auto clockDiffVec = _mm_set1_ps(static_cast<float>(clockDiff));
-            const auto valueDiffVec = _mm_set1_ps(valueDiff);
-            const auto value0Vec = _mm_set1_ps(value0);
-            for (; f <= fadeEnd - 16; f += 16)
-            {
-                const auto clockOffsetVec = _mm_set1_ps(
-                    static_cast<float>(fadeClock) - static_cast<float>(clock0));
-
-                const auto amounts0 = _mm_div_ps(_mm_add_ps(_mm_set_ps(1, 1, 0, 0), clockOffsetVec), clockDiffVec);
-                const auto amounts1 = _mm_div_ps(_mm_add_ps(_mm_set_ps(3, 3, 2, 2), clockOffsetVec), clockDiffVec);
-                const auto amounts2 = _mm_div_ps(_mm_add_ps(_mm_set_ps(5, 5, 4, 4), clockOffsetVec), clockDiffVec);
-                const auto amounts3 = _mm_div_ps(_mm_add_ps(_mm_set_ps(7, 7, 6, 6), clockOffsetVec), clockDiffVec);
-                const auto amounts4 = _mm_div_ps(_mm_add_ps(_mm_set_ps(9, 9, 8, 8), clockOffsetVec), clockDiffVec);
-                const auto amounts5 = _mm_div_ps(_mm_add_ps(_mm_set_ps(11, 11, 10, 10), clockOffsetVec), clockDiffVec);
-                const auto amounts6 = _mm_div_ps(_mm_add_ps(_mm_set_ps(13, 13, 12, 12), clockOffsetVec), clockDiffVec);
-                const auto amounts7 = _mm_div_ps(_mm_add_ps(_mm_set_ps(15, 15, 14, 14), clockOffsetVec), clockDiffVec);
-                const auto result0 = _mm_add_ps(_mm_mul_ps(valueDiffVec, amounts0), value0Vec);
-                const auto result1 = _mm_add_ps(_mm_mul_ps(valueDiffVec, amounts1), value0Vec);
-                const auto result2 = _mm_add_ps(_mm_mul_ps(valueDiffVec, amounts2), value0Vec);
-                const auto result3 = _mm_add_ps(_mm_mul_ps(valueDiffVec, amounts3), value0Vec);
-                const auto result4 = _mm_add_ps(_mm_mul_ps(valueDiffVec, amounts4), value0Vec);
-                const auto result5 = _mm_add_ps(_mm_mul_ps(valueDiffVec, amounts5), value0Vec);
-                const auto result6 = _mm_add_ps(_mm_mul_ps(valueDiffVec, amounts6), value0Vec);
-                const auto result7 = _mm_add_ps(_mm_mul_ps(valueDiffVec, amounts7), value0Vec);
-                _mm_store_ps(sample, _mm_mul_ps(_mm_load_ps(sample), result0));
-                _mm_store_ps(sample + 4, _mm_mul_ps(_mm_load_ps(sample + 4), result1));
-                _mm_store_ps(sample + 8, _mm_mul_ps(_mm_load_ps(sample + 8), result2));
-                _mm_store_ps(sample + 12, _mm_mul_ps(_mm_load_ps(sample + 12), result3));
-                _mm_store_ps(sample + 16, _mm_mul_ps(_mm_load_ps(sample + 16), result4));
-                _mm_store_ps(sample + 20, _mm_mul_ps(_mm_load_ps(sample + 20), result5));
-                _mm_store_ps(sample + 24, _mm_mul_ps(_mm_load_ps(sample + 24), result6));
-                _mm_store_ps(sample + 28, _mm_mul_ps(_mm_load_ps(sample + 28), result7));
-
-                fadeClock += 16;
-                sample += 32;
-            }
-#elif KAZE_CPU_WASM_SIMD
-            const auto clockDiffVec = wasm_f32x4_splat(static_cast<float>(clockDiff));
-            const auto valueDiffVec = wasm_f32x4_splat(valueDiff);
-            const auto value0Vec = wasm_f32x4_splat(value0);
-            for (; f <= fadeEnd - 16; f += 16)
-            {
-                const auto clockOffsetVec = wasm_f32x4_splat(static_cast<float>(fadeClock) - static_cast<float>(clock0));
-                const auto amounts0 = wasm_f32x4_div(wasm_f32x4_add(wasm_f32x4_make(0, 0, 1, 1), clockOffsetVec), clockDiffVec);
-                const auto amounts1 = wasm_f32x4_div(wasm_f32x4_add(wasm_f32x4_make(2, 2, 3, 3), clockOffsetVec), clockDiffVec);
-                const auto amounts2 = wasm_f32x4_div(wasm_f32x4_add(wasm_f32x4_make(4, 4, 5, 5), clockOffsetVec), clockDiffVec);
-                const auto amounts3 = wasm_f32x4_div(wasm_f32x4_add(wasm_f32x4_make(6, 6, 7, 7), clockOffsetVec), clockDiffVec);
-                const auto amounts4 = wasm_f32x4_div(wasm_f32x4_add(wasm_f32x4_make(8, 8, 9, 9), clockOffsetVec), clockDiffVec);
-                const auto amounts5 = wasm_f32x4_div(wasm_f32x4_add(wasm_f32x4_make(10, 10, 11, 11), clockOffsetVec), clockDiffVec);
-                const auto amounts6 = wasm_f32x4_div(wasm_f32x4_add(wasm_f32x4_make(12, 12, 13, 13), clockOffsetVec), clockDiffVec);
-                const auto amounts7 = wasm_f32x4_div(wasm_f32x4_add(wasm_f32x4_make(14, 14, 15, 15), clockOffsetVec), clockDiffVec);
-
-                const auto results0 = wasm_f32x4_add(wasm_f32x4_mul(valueDiffVec, amounts0), value0Vec);
-                const auto results1 = wasm_f32x4_add(wasm_f32x4_mul(valueDiffVec, amounts1), value0Vec);
-                const auto results2 = wasm_f32x4_add(wasm_f32x4_mul(valueDiffVec, amounts2), value0Vec);
-                const auto results3 = wasm_f32x4_add(wasm_f32x4_mul(valueDiffVec, amounts3), value0Vec);
-                const auto results4 = wasm_f32x4_add(wasm_f32x4_mul(valueDiffVec, amounts4), value0Vec);
-                const auto results5 = wasm_f32x4_add(wasm_f32x4_mul(valueDiffVec, amounts5), value0Vec);
-                const auto results6 = wasm_f32x4_add(wasm_f32x4_mul(valueDiffVec, amounts6), value0Vec);
-                const auto results7 = wasm_f32x4_add(wasm_f32x4_mul(valueDiffVec, amounts7), value0Vec);
-
-                wasm_v128_store(sample, wasm_f32x4_mul(wasm_v128_load(sample), results0));
-                wasm_v128_store(sample + 4, wasm_f32x4_mul(wasm_v128_load(sample + 4), results1));
-                wasm_v128_store(sample + 8, wasm_f32x4_mul(wasm_v128_load(sample + 8), results2));
-                wasm_v128_store(sample + 12, wasm_f32x4_mul(wasm_v128_load(sample + 12), results3));
-                wasm_v128_store(sample + 16, wasm_f32x4_mul(wasm_v128_load(sample + 16), results4));
-                wasm_v128_store(sample + 20, wasm_f32x4_mul(wasm_v128_load(sample + 20), results5));
-                wasm_v128_store(sample + 24, wasm_f32x4_mul(wasm_v128_load(sample + 24), results6));
-                wasm_v128_store(sample + 28, wasm_f32x4_mul(wasm_v128_load(sample + 28), results7));
-
-                fadeClock += 16;
-                sample += 32;
-            }
-#elif KAZE_CPU_ARM_NEON
-            const auto clockDiffVec = vdupq_n_f32(static_cast<float>(clockDiff));
-            const auto valueDiffVec = vdupq_n_f32(static_cast<float>(valueDiff));
-            const auto value0Vec = vdupq_n_f32(static_cast<float>(value0));
-            for (; f < fadeEnd - 16; f += 16)
-            {
-                const auto clockOffsetVec = vdupq_n_f32(static_cast<float>(fadeClock) - static_cast<float>(clock0));
-                const auto amounts0 = vdivq_f32(vaddq_f32(float32x4_t{0, 0, 1, 1}, clockOffsetVec), clockDiffVec);
-                const auto amounts1 = vdivq_f32(vaddq_f32(float32x4_t{2, 2, 3, 3}, clockOffsetVec), clockDiffVec);
-                const auto amounts2 = vdivq_f32(vaddq_f32(float32x4_t{4, 4, 5, 5}, clockOffsetVec), clockDiffVec);
-                const auto amounts3 = vdivq_f32(vaddq_f32(float32x4_t{6, 6, 7, 7}, clockOffsetVec), clockDiffVec);
-                const auto amounts4 = vdivq_f32(vaddq_f32(float32x4_t{8, 8, 9, 9}, clockOffsetVec), clockDiffVec);
-                const auto amounts5 = vdivq_f32(vaddq_f32(float32x4_t{10, 10, 11, 11}, clockOffsetVec), clockDiffVec);
-                const auto amounts6 = vdivq_f32(vaddq_f32(float32x4_t{12, 12, 13, 13}, clockOffsetVec), clockDiffVec);
-                const auto amounts7 = vdivq_f32(vaddq_f32(float32x4_t{14, 14, 15, 15}, clockOffsetVec), clockDiffVec);
-
-                const auto results0 = vaddq_f32(vmulq_f32(valueDiffVec, amounts0), value0Vec);
-                const auto results1 = vaddq_f32(vmulq_f32(valueDiffVec, amounts1), value0Vec);
-                const auto results2 = vaddq_f32(vmulq_f32(valueDiffVec, amounts2), value0Vec);
-                const auto results3 = vaddq_f32(vmulq_f32(valueDiffVec, amounts3), value0Vec);
-                const auto results4 = vaddq_f32(vmulq_f32(valueDiffVec, amounts4), value0Vec);
-                const auto results5 = vaddq_f32(vmulq_f32(valueDiffVec, amounts5), value0Vec);
-                const auto results6 = vaddq_f32(vmulq_f32(valueDiffVec, amounts6), value0Vec);
-                const auto results7 = vaddq_f32(vmulq_f32(valueDiffVec, amounts7), value0Vec);
-
-                vst1q_f32(sample, vmulq_f32(vld1q_f32(sample), results0));
-                vst1q_f32(sample + 4, vmulq_f32(vld1q_f32(sample + 4), results1));
-                vst1q_f32(sample + 8, vmulq_f32(vld1q_f32(sample + 8), results2));
-                vst1q_f32(sample + 12, vmulq_f32(vld1q_f32(sample + 12), results3));
-                vst1q_f32(sample + 16, vmulq_f32(vld1q_f32(sample + 16), results4));
-                vst1q_f32(sample + 20, vmulq_f32(vld1q_f32(sample + 20), results5));
-                vst1q_f32(sample + 24, vmulq_f32(vld1q_f32(sample + 24), results6));
-                vst1q_f32(sample + 28, vmulq_f32(vld1q_f32(sample + 28), results7));
-
-                sample += 32;
-                fadeClock += 16;
-            }
-#else
-            for (; f <= fadeEnd - 4; f += 4)
-            {
-                const auto clockOffset = fadeClock - clock0; // current offset from clock0
-                const float amount0 = (float)(clockOffset) / (float)(clockDiff);
-                const float amount1 = (float)(clockOffset + 1) / (float)(clockDiff);
-                const float amount2 = (float)(clockOffset + 2) / (float)(clockDiff);
-                const float amount3 = (float)(clockOffset + 3) / (float)(clockDiff);
-                const auto result0 = valueDiff * amount0 + value0;
-                const auto result1 = valueDiff * amount1 + value0;
-                const auto result2 = valueDiff * amount2 + value0;
-                const auto result3 = valueDiff * amount3 + value0;
-                sample[0] *= result0;
-                sample[1] *= result0;
-                sample[2] *= result1;
-                sample[3] *= result1;
-                sample[4] *= result2;
-                sample[5] *= result2;
-                sample[6] *= result3;
-                sample[7] *= result3;
-
-                fadeClock += 4;
-                sample += 8;
-            }
-#endif
-            for (;f < fadeEnd; ++f)
-            {
-                const float amount = (float)(fadeClock - clock0) / (float)(clockDiff);
-                const auto result = valueDiff * amount + value0;
-                *sample++ *= result;
-                *sample++ *= result;
-                ++fadeClock;
-            }
-
-            m_fadeValue = value1;
+            effect->processInPlace(reinterpret_cast<Float *>(target ? target : m_outBuffer.data()), sampleCount);
+            continue;
         }
-        else
+
+        // Only out-of-place effects need the scratch buffer, handed to them cleared
+        if (m_inBuffer.size() != length)
+            m_inBuffer.resize(length);
+        memory::set(m_inBuffer.data(), 0, length);
+
+        if (effect->process(reinterpret_cast<const Float *>(target ? target : m_outBuffer.data()),
+            reinterpret_cast<Float *>(m_inBuffer.data()), sampleCount))
         {
-            // find end point
-            Uint64 endIndex;
-            if (fadeIndex + 1 < m_fadePoints.size()) // there's next fadepoint
-            {
-                endIndex = std::min<Uint64>(m_fadePoints[fadeIndex + 1].clock - fadeClock, static_cast<Uint64>(end - sample));
-            }
+            // A target cannot trade places with the scratch buffer, so it takes a copy instead
+            if (target)
+                memory::copy(target, m_inBuffer.data(), length);
             else
-            {
-                endIndex = static_cast<Uint64>(end - sample);
-            }
-
-            if (m_fadeValue == 1.f) // fade of 1 has no effect, just move the sample ptr
-                sample += endIndex;
-            else                    // perform fade multiplier on all samples until endIndex
-            {
-                for (Uint64 i = 0; i < endIndex; ++i)
-                    *sample++ *= m_fadeValue;
-            }
+                std::swap(m_outBuffer, m_inBuffer);
         }
+    }
+
+    const auto output = target ? target : m_outBuffer.data();
+    applyFade(reinterpret_cast<Float *>(output), parentClock, length / bytesPerFrame);
 
+    if (const auto tap = m_sidechainTap.load(std::memory_order_relaxed); tap > -1)
+    {
+        m_context->getSidechainTaps().write(tap, reinterpret_cast<const Float *>(output), length / bytesPerFrame,
+            m_channels);
     }
 
-    // Remove all fade points that have been passed
-    if (fadeIndex > 0)
-        m_fadePoints.erase(m_fadePoints.begin(), m_fadePoints.begin() + (fadeIndex - 1));
+    if (const auto tap = m_analyzerTap.load(std::memory_order_relaxed); tap > -1)
+    {
+        m_context->getAnalyzerTaps().write(tap, reinterpret_cast<const Float *>(output), length / bytesPerFrame,
+            m_channels);
+    }
 
     if (pcmPtr)
-        *pcmPtr = m_outBuffer.data();
+        *pcmPtr = output;
 
-    m_clock += length / (2 * sizeof(Float));
+    m_gain.store(m_fadeValue * m_volume->volume(), std::memory_order_relaxed);
+    m_clock.fetch_add(length / bytesPerFrame, std::memory_order_relaxed);
     return length;
 }
 
 auto AudioSource::pauseAt(Uint64 clock, Bool releaseOnPause) -> Bool
 {
     HANDLE_GUARD_RET(False);
-    m_context->pushImmediateCommand(
+    m_context->pushCommand(
         commands::SourceSetPause{
             .source = this,
             .releaseOnPause = releaseOnPause,
@@ -411,7 +281,7 @@ auto AudioSource::pauseAt(Uint64 clock, Bool releaseOnPause) -> Bool
 auto AudioSource::unpauseAt(Uint64 clock) -> Bool
 {
     HANDLE_GUARD_RET(False);
-    m_context->pushImmediateCommand(
+    m_context->pushCommand(
         commands::SourceSetUnpause {
             .source = this,
             .clock = clock
@@ -502,12 +372,91 @@ auto AudioSource::setVolume(Float value) -> void
     m_volume->volume(value);
 }
 
+auto AudioSource::setChannels(const Int channels) -> void
+{
+    m_channels = channels;
+    m_resampler.setChannels(channels);
+    reserveBuffers();
+    for (auto &effect : m_effects)
+    {
+        effect->m_channels = channels;
+        effect->prepare();
+    }
+}
+
+auto AudioSource::getPitch() const -> Float
+{
+    return m_pitch.load(std::memory_order_relaxed);
+}
+
+auto AudioSource::setPitch(const Float pitch) -> void
+{
+    m_pitch.store(mathf::clamp(pitch, static_cast<Float>(dsp::Resampler::MinRate),
+        static_cast<Float>(dsp::Resampler::MaxRate)), std::memory_order_relaxed);
+}
+
+auto AudioSource::getResampleQuality() const -> ResampleQuality
+{
+    return m_resampleQuality.load(std::memory_order_relaxed);
+}
+
+auto AudioSource::setResampleQuality(const ResampleQuality quality) -> void
+{
+    m_resampleQuality.store(quality, std::memory_order_relaxed);
+}
+
+auto AudioSource::getSidechainTap() const -> Int
+{
+    return m_sidechainTap.load(std::memory_order_relaxed);
+}
+
+auto AudioSource::setSidechainTap(const Int tap) -> void
+{
+    if (tap < -1 || tap >= SidechainTaps::MaxTaps)
+    {
+        KAZE_PUSH_ERR(Error::OutOfRange, "Sidechain tap must be in [-1, {}], but got {}",
+            SidechainTaps::MaxTaps - 1, tap);
+        return;
+    }
+
+    m_sidechainTap.store(tap, std::memory_order_relaxed);
+}
+
+auto AudioSource::getAnalyzerTap() const -> Int
+{
+    return m_analyzerTap.load(std::memory_order_relaxed);
+}
+
+auto AudioSource::setAnalyzerTap(const Int tap) -> void
+{
+    if (tap < -1 || tap >= AnalyzerTaps::MaxTaps)
+    {
+        KAZE_PUSH_ERR(Error::OutOfRange, "Analyzer tap must be in [-1, {}], but got {}",
+            AnalyzerTaps::MaxTaps - 1, tap);
+        return;
+    }
+
+    const auto current = m_analyzerTap.load(std::memory_order_relaxed);
+    if (tap == current)
+        return;
+
+    auto &taps = m_context->getAnalyzerTaps();
+    if (tap > -1 && !taps.claim(tap, this))
+    {
+        KAZE_PUSH_ERR(Error::LogicErr, "Analyzer tap {} is already metering another source", tap);
+        return;
+    }
+
+    if (current > -1)
+        taps.unclaim(current, this);
+    m_analyzerTap.store(tap, std::memory_order_relaxed);
+}
 
 auto AudioSource::getClock() const -> Uint64
 {
     HANDLE_GUARD_RET(0);
 
-    return m_clock;
+    return m_clock.load(std::memory_order_relaxed);
 }
 
 
@@ -515,14 +464,14 @@ auto AudioSource::getParentClock() const -> Uint64
 {
     HANDLE_GUARD_RET(0);
 
-    return m_parentClock;
+    return m_parentClock.load(std::memory_order_relaxed);
 }
 
 auto AudioSource::addFadePoint(Uint64 clock, Float value) -> Bool
 {
     HANDLE_GUARD_RET(False);
 
-    m_context->pushImmediateCommand(
+    m_context->pushCommand(
         commands::SourceAddFadePoint {
             .source = this,
             .clock = clock,
@@ -537,7 +486,7 @@ auto AudioSource::fadeTo(Uint64 clock, Float value) -> Bool
 {
     HANDLE_GUARD_RET(False);
 
-    m_context->pushImmediateCommand(
+    m_context->pushCommand(
         commands::SourceFadeTo {
             .source = this,
             .clock = clock,
@@ -552,7 +501,7 @@ auto AudioSource::removeFadePoints(Uint64 clockBeginPoint, Uint64 clockEndPoint)
 {
     HANDLE_GUARD_RET(False);
 
-    m_context->pushImmediateCommand(
+    m_context->pushCommand(
         commands::SourceRemoveFadePoint {
             .source = this,
             .beginClock = clockBeginPoint,
@@ -572,7 +521,7 @@ auto AudioSource::getFadeValue() const -> Float
 auto AudioSource::updateParentClock(const Uint64 parentClock) -> Bool
 {
     HANDLE_GUARD_RET(False);
-    m_parentClock = parentClock;
+    m_parentClock.store(parentClock, std::memory_order_relaxed);
     return True;
 }
 
@@ -582,16 +531,181 @@ auto AudioSource::swapBuffers(AlignedList<Ubyte , 16> *buffer) -> void
     m_outBuffer.swap(*buffer);
 }
 
+auto AudioSource::reserveBuffers() -> void
+{
+    if ( !m_context->isOpen() || m_context->getSpec().bytesPerFrame() == 0 )
+        return;
+
+    const auto frames = static_cast<Size>(m_context->getMaxBufferSize()) / m_context->getSpec().bytesPerFrame();
+    const auto bytes = frames * m_channels * sizeof(Float);
+    m_outBuffer.reserve(bytes);
+    m_inBuffer.reserve(bytes);
+    m_resampler.reserve(static_cast<Int64>(frames));
+}
+
+auto AudioSource::readPitched(Ubyte *output, const Int64 length) -> Int64
+{
+    const auto bytesPerFrame = static_cast<Int64>(m_channels * sizeof(Float));
+    const auto frames = length / bytesPerFrame;
+    const auto pitch = m_pitch.load(std::memory_order_relaxed);
+
+    if (pitch == 1.f)
+    {
+        // Play out any input read ahead at another pitch, then read directly
+        const auto drainedBytes = m_resampler.drain(reinterpret_cast<Float *>(output), frames) * bytesPerFrame;
+        if (drainedBytes == length)
+            return length;
+
+        const auto bytesRead = readImpl(output + drainedBytes, length - drainedBytes);
+        return bytesRead < 0 ? bytesRead : drainedBytes + bytesRead;
+    }
+
+    // Resample at most as many frames at once as the resampler reserved input for, so that it never grows here
+    m_resampler.setQuality(m_resampleQuality.load(std::memory_order_relaxed));
+    const auto block = m_resampler.getMaxFrames() > 0 ? m_resampler.getMaxFrames() : frames;
+    for (Int64 offset = 0; offset < frames; offset += block)
+    {
+        const auto count = mathf::min(block, frames - offset);
+        if (const auto inputFrames = m_resampler.getInputFramesNeeded(count, pitch); inputFrames > 0)
+        {
+            const auto input = reinterpret_cast<Ubyte *>(m_resampler.prepareInput(inputFrames));
+            const auto inputLength = inputFrames * bytesPerFrame;
+            const auto bytesRead = readImpl(input, inputLength);
+            if (bytesRead < 0)
+                return bytesRead;
+            if (bytesRead < inputLength)
+                memory::set(input + bytesRead, 0, inputLength - bytesRead);
+        }
+
+        m_resampler.process(reinterpret_cast<Float *>(output + offset * bytesPerFrame), count, pitch);
+    }
+
+    return length;
+}
+
+auto AudioSource::skipPitched(const Int64 length) -> Int64
+{
+    const auto bytesPerFrame = static_cast<Int64>(m_channels * sizeof(Float));
+    const auto pitch = m_pitch.load(std::memory_order_relaxed);
+    if (pitch == 1.f && m_resampler.getBufferedFrames() == 0)
+        return skipImpl(length);
+
+    // Input read ahead counts toward the skip; resampling restarts from silence once real again
+    const auto inputFrames = static_cast<Int64>(static_cast<Double>(length / bytesPerFrame) * pitch + .5) -
+        m_resampler.getBufferedFrames();
+    m_resampler.reset();
+    if (inputFrames > 0)
+        skipImpl(inputFrames * bytesPerFrame);
+    return length;
+}
+
+auto AudioSource::applyFade(Float *samples, Uint64 clock, Int64 frames) -> void
+{
+    const auto &kernels = dsp::getKernels();
+    while (frames > 0)
+    {
+        advanceFadeCursor(clock);
+
+        // Frames until the next point, where the fade changes course
+        const auto hasNext = m_fadeCursor < m_fadePoints.size();
+        const auto run = hasNext ? std::min<Int64>(frames, static_cast<Int64>(m_fadePoints[m_fadeCursor].clock - clock)) :
+            frames;
+
+        if (hasNext && m_fadeCursor > 0) // between two points
+        {
+            if (!m_isFadeSegmentCached)
+                cacheFadeSegment();
+            const auto start = m_fadeStart +
+                m_fadeSlope * static_cast<Double>(clock - m_fadePoints[m_fadeCursor - 1].clock);
+
+            kernels.fade(samples, run, m_channels, 0, static_cast<Float>(start), static_cast<Float>(m_fadeSlope));
+            m_fadeValue = static_cast<Float>(start + m_fadeSlope * static_cast<Double>(run));
+        }
+        else if (m_fadeValue != 1.f) // holding a value, before the first point or after the last
+        {
+            kernels.scale(samples, samples, m_fadeValue, run * m_channels);
+        }
+
+        samples += run * m_channels;
+        clock += static_cast<Uint64>(run);
+        frames -= run;
+    }
+
+    advanceFadeCursor(clock);
+    dropPassedFadePoints();
+}
+
+auto AudioSource::skipFade(const Uint64 parentClock, const Uint64 frames) -> void
+{
+    const auto endClock = parentClock + frames;
+    advanceFadeCursor(endClock);
+
+    if (m_fadeCursor > 0 && m_fadeCursor < m_fadePoints.size())
+    {
+        // Still inside of a fade, interpolate to where it will be at the end of this buffer
+        if (!m_isFadeSegmentCached)
+            cacheFadeSegment();
+        m_fadeValue = static_cast<Float>(m_fadeStart +
+            m_fadeSlope * static_cast<Double>(endClock - m_fadePoints[m_fadeCursor - 1].clock));
+    }
+
+    dropPassedFadePoints();
+}
+
+auto AudioSource::advanceFadeCursor(const Uint64 clock) -> void
+{
+    while (m_fadeCursor < m_fadePoints.size() && m_fadePoints[m_fadeCursor].clock <= clock)
+    {
+        m_fadeValue = m_fadePoints[m_fadeCursor].value;
+        m_isFadeSegmentCached = False; // moved onto a new segment
+        ++m_fadeCursor;
+    }
+}
+
+auto AudioSource::cacheFadeSegment() -> void
+{
+    const auto &point0 = m_fadePoints[m_fadeCursor - 1];
+    const auto &point1 = m_fadePoints[m_fadeCursor];
+    m_fadeStart = point0.value;
+    m_fadeSlope = static_cast<Double>(point1.value - point0.value) / static_cast<Double>(point1.clock - point0.clock);
+    m_isFadeSegmentCached = True;
+}
+
+auto AudioSource::dropPassedFadePoints() -> void
+{
+    if (m_fadeCursor > 1)
+    {
+        m_fadePoints.erase(m_fadePoints.begin(), m_fadePoints.begin() + static_cast<Int64>(m_fadeCursor - 1));
+        m_fadeCursor = 1;
+    }
+}
+
+auto AudioSource::willRenderFully(const Uint64 frames) const -> Bool
+{
+    if (m_paused)
+        return False;
+
+    const auto pauseClock = (Int64)m_pauseClock - (Int64)m_parentClock.load(std::memory_order_relaxed);
+    return pauseClock < 0 || pauseClock >= static_cast<Int64>(frames);
+}
+
+auto AudioSource::prerender(const Int64 frames) -> void
+{
+    m_prerenderedLength = -1;
+    m_prerenderedLength = read(Null, frames * m_channels * static_cast<Int64>(sizeof(Float)));
+}
+
 // ===== Command implementations ==============================================
 
 auto AudioSource::setPauseImpl(Bool pause, Uint64 clock, Bool releaseOnPause) -> void
 {
+    const auto parentClock = m_parentClock.load(std::memory_order_relaxed);
     if (pause)
     {
-        if (clock == std::numeric_limits<Uint64>::max() || (clock > 0 && clock < m_parentClock))
+        if (clock == std::numeric_limits<Uint64>::max() || (clock > 0 && clock < parentClock))
         {
             // command took too long to send, activate at the next clock buffer
-            m_pauseClock = m_parentClock;
+            m_pauseClock = parentClock;
         }
         else
         {
@@ -602,10 +716,10 @@ auto AudioSource::setPauseImpl(Bool pause, Uint64 clock, Bool releaseOnPause) ->
     }
     else
     {
-        if (clock == std::numeric_limits<Uint64>::max() || (clock > 0 && clock < m_parentClock))
+        if (clock == std::numeric_limits<Uint64>::max() || (clock > 0 && clock < parentClock))
         {
             // command took too long to send, activate at the next clock buffer
-            m_unpauseClock = m_parentClock;
+            m_unpauseClock = parentClock;
         }
         else
         {
@@ -634,47 +748,57 @@ auto AudioSource::removeEffectImpl(const Handle<AudioEffect> &effect) -> void
 
 auto AudioSource::addFadePointImpl(Uint64 clock, Float value) -> void
 {
-    Bool didInsert = False;
-    for (auto it = m_fadePoints.begin(); it != m_fadePoints.end(); ++it)
-    {
-        if (clock == it->clock) // If same, replace the value
-        {
-            it->value = value;
-            didInsert = True;
-            break;
-        }
+    const auto it = std::lower_bound(m_fadePoints.begin(), m_fadePoints.end(), clock,
+        [](const FadePoint &point, const Uint64 clock) { return point.clock < clock; });
 
-        if (clock < it->clock)
-        {
-            m_fadePoints.insert(it, FadePoint(clock, value));
-            didInsert = True;
-            break;
-        }
-    }
-
-    if ( !didInsert )
+    m_isFadeSegmentCached = False;
+    if (it != m_fadePoints.end() && it->clock == clock) // If same, replace the value
     {
-        m_fadePoints.emplace_back(clock, value);
+        it->value = value;
+        return;
     }
+
+    // A point inserted before the cursor has already been passed
+    if (static_cast<Size>(it - m_fadePoints.begin()) < m_fadeCursor)
+        ++m_fadeCursor;
+    m_fadePoints.insert(it, FadePoint(clock, value));
 }
 
 auto AudioSource::removeFadePointImpl(Uint64 clockBegin, Uint64 clockEnd) -> void
 {
+    const auto isInRange = [clockBegin, clockEnd](const FadePoint &point) {
+        return point.clock >= clockBegin && point.clock < clockEnd;
+    };
+
+    // Keep the cursor on the same upcoming point
+    m_fadeCursor -= std::count_if(m_fadePoints.begin(), m_fadePoints.begin() + static_cast<Int64>(m_fadeCursor),
+        isInRange);
+
     // remove-erase idiom on all fadepoints between clock values
-    m_fadePoints.erase(
-        std::remove_if(m_fadePoints.begin(), m_fadePoints.end(), [clockBegin, clockEnd](const FadePoint &point) {
-            return point.clock >= clockBegin && point.clock < clockEnd;
-        }),
-        m_fadePoints.end());
+    m_fadePoints.erase(std::remove_if(m_fadePoints.begin(), m_fadePoints.end(), isInRange), m_fadePoints.end());
+    m_isFadeSegmentCached = False;
+}
+
+auto AudioSource::setVirtualImpl(const Bool isVirtual) -> void
+{
+    m_isVirtual.store(isVirtual, std::memory_order_release);
+}
+
+auto AudioSource::setEmitterImpl(const Int slot) -> void
+{
+    m_spatialSlot = slot;
+    if (slot > -1)
+        m_context->getSpatializer().markFresh(slot);
 }
 
 auto AudioSource::fadeToImpl(Uint clock, Float value) -> void
 {
     // Remove any fade point between now and the fade value
-    removeFadePointImpl(m_parentClock, clock);
+    const auto parentClock = m_parentClock.load(std::memory_order_relaxed);
+    removeFadePointImpl(parentClock, clock);
 
     // Set fade point ramp
-    addFadePointImpl(m_parentClock, m_fadeValue); // from now
+    addFadePointImpl(parentClock, m_fadeValue); // from now
     addFadePointImpl(clock, value);               // to target
 }
 
@@ -4,6 +4,7 @@
 #include <kaze/snd/AudioEffect.h>
 #include <kaze/snd/AudioContext.h>
 #include <kaze/snd/FadePoint.h>
+#include <kaze/snd/dsp/Resampler.h>
 #include <kaze/snd/effects/PanEffect.h>
 #include <kaze/snd/effects/VolumeEffect.h>
 
@@ -90,12 +91,15 @@ public:
     template <Poolable T, typename ...TArgs> requires std::is_base_of_v<AudioEffect, T>
     auto addEffect(const Int index, TArgs &&...args) -> Handle<T> //TODO: add this function to the Engine, so you don't need to access the lock guard or object pool
     {
-        const auto effect = m_context->createObject(std::forward<TArgs>(args)...);
+        const auto effect = m_context->createObject<T>(std::forward<TArgs>(args)...);
         if ( !effect.isValid() )
         {
             return {};
         }
 
+        effect->m_context = m_context; // lets the effect send parameter commands
+        effect->m_channels = m_channels;
+        static_cast<AudioEffect *>(effect.get())->prepare();
         m_context->pushCommand(commands::SourceAddEffect {
             .source = this,
             .effect = static_cast<Handle<AudioEffect>>(effect),
@@ -142,6 +146,46 @@ public:
         return static_cast< Handle<const VolumeEffect> >(m_volume);
     }
 
+    /// \returns number of interleaved channels this AudioSource renders; its parent bus mixes them into its own
+    ///          channel layout
+    [[nodiscard]]
+    auto getChannels() const -> Int { return m_channels; }
+
+    /// \returns the playback rate; see `setPitch`
+    [[nodiscard]]
+    auto getPitch() const -> Float;
+
+    /// Set the playback rate, resampled in the mix. At `2` the source plays an octave higher and twice as fast,
+    /// at `0.5` an octave lower and half as fast. Takes effect on the next audio callback.
+    /// \param[in]  pitch  playback rate, clamped to [`dsp::Resampler::MinRate`, `dsp::Resampler::MaxRate`]
+    auto setPitch(Float pitch) -> void;
+
+    [[nodiscard]]
+    auto getResampleQuality() const -> ResampleQuality;
+
+    /// Set the interpolation used while the pitch is not `1` [default: `ResampleQuality::Sinc`]
+    auto setResampleQuality(ResampleQuality quality) -> void;
+
+    /// \returns the sidechain tap this source publishes its output to, or `-1` if none; see `setSidechainTap`
+    [[nodiscard]]
+    auto getSidechainTap() const -> Int;
+
+    /// Publish the level of this source's output, after its effects and fades, for effects elsewhere in the graph
+    /// to key off, e.g. a `CompressorEffect` ducking music under a dialogue bus. Readers hear it one buffer late.
+    /// Takes effect on the next audio callback.
+    /// \param[in]  tap  tap index from `0` to `SidechainTaps::MaxTaps - 1`, one source per tap, or `-1` to stop
+    auto setSidechainTap(Int tap) -> void;
+
+    /// \returns the analyzer tap this source's output is metered on, or `-1` if none; see `setAnalyzerTap`
+    [[nodiscard]]
+    auto getAnalyzerTap() const -> Int;
+
+    /// Meter this source's output, after its effects and fades, for `AudioEngine::getAnalyzerReading`. Takes effect
+    /// on the next audio callback; the tap keeps its measurements when it changes sources. Pushes an error if
+    /// another source holds the tap, until that source stops or is released.
+    /// \param[in]  tap  tap index from `0` to `AnalyzerTaps::MaxTaps - 1`, one source per tap, or `-1` to stop
+    auto setAnalyzerTap(Int tap) -> void;
+
     auto addFadePoint(Uint64 clock, Float value) -> Bool;
 
     auto fadeTo(Uint64 clock, Float value) -> Bool;
@@ -151,19 +195,40 @@ public:
     [[nodiscard]]
     auto getFadeValue() const -> Float;
 
-    /// Whether this AudioSource is marked for discard, i.e. release was called.
-    auto shouldDiscard() const -> Bool { return m_shouldDiscard; }
+    /// \returns the gain applied on the last audio callback, the volume times the fade value.
+    ///          Updated by the audio thread, readable from any thread.
+    [[nodiscard]]
+    auto getGain() const -> Float { return m_gain.load(std::memory_order_relaxed); }
+
+    /// Whether this AudioSource is virtual: its clock and play position advance, but it is neither decoded nor
+    /// mixed. Voices are virtualized by the AudioEngine when voice limits are reached.
+    [[nodiscard]]
+    auto isVirtual() const -> Bool { return m_isVirtual.load(std::memory_order_acquire); }
 
-    auto read(const Ubyte **pcmPtr, Int64 length) -> Int64;
+    /// Whether this AudioSource is marked for discard, i.e. release was called.
+    auto shouldDiscard() const -> Bool { return m_shouldDiscard.load(std::memory_order_acquire); }
+
+    /// Render the next buffer of this AudioSource. Audio thread only.
+    /// \param[out] pcmPtr  receives a pointer to the rendered samples
+    /// \param[in]  length  number of bytes to render, whole frames of `getChannels()` floats
+    /// \param[in]  target  memory to render into in place of this source's own buffer, e.g. a device's, aligned
+    ///                     to 16 bytes; out-of-place effects then cost a copy each [optional, default: null]
+    /// \returns the number of bytes rendered, or `0` while virtual, in which case `pcmPtr` is left unset.
+    auto read(const Ubyte **pcmPtr, Int64 length, Ubyte *target = Null) -> Int64;
 protected:
     [[nodiscard]]
     auto context() -> AudioContext * { return m_context; }
     [[nodiscard]]
     auto context() const -> const AudioContext * { return m_context; }
 
+    /// Set the number of channels rendered, defaulting to the output's on init, and prepare every attached
+    /// effect for it. Call from `init_` or while opening content, before the source is connected to a bus.
+    auto setChannels(Int channels) -> void;
+
 private:
     friend class AudioContext;
     friend class AudioBus;
+    friend class Spatializer;
 
     /// VIRTUAL: Required
     /// Implementation for retrieving PCM data from this AudioSource
@@ -172,6 +237,13 @@ private:
     /// \returns the number of bytes actually read, `-1` on error.
     virtual auto readImpl(Ubyte *output, Int64 length) -> Int64 = 0;
 
+    /// VIRTUAL: Optional
+    /// Advance the play position as if `length` bytes were read, without producing audio.
+    /// Called in place of `readImpl` while this AudioSource is virtual.
+    /// \param[in]  length  number of bytes to skip
+    /// \returns the number of bytes actually skipped.
+    virtual auto skipImpl(Int64 length) -> Int64 { return length; }
+
     /// VIRTUAL: Optional
     /// The engine calls this in the mixer thread to update clock values
     /// (called recursively from master bus)
@@ -183,6 +255,43 @@ private:
 
     auto swapBuffers(AlignedList<Ubyte , 16> *buffer) -> void;
 
+    /// `readImpl` at the current pitch, resampling when it is not `1`
+    /// \param[in]  output  buffer to fill with interleaved frames
+    /// \param[in]  length  number of bytes of output to produce
+    /// \returns the number of bytes produced, `-1` on error.
+    auto readPitched(Ubyte *output, Int64 length) -> Int64;
+
+    /// `skipImpl` at the current pitch, skipping past the input that `length` bytes of output would consume
+    /// \returns the number of output bytes skipped.
+    auto skipPitched(Int64 length) -> Int64;
+
+    /// Multiply interleaved frames by the fade, advancing along the fade points
+    /// \param[in]  samples  frames to fade
+    /// \param[in]  clock    parent clock of the first frame
+    /// \param[in]  frames   number of frames
+    auto applyFade(Float *samples, Uint64 clock, Int64 frames) -> void;
+
+    /// Move the fade value along the fade points without applying it to any samples, for virtual reads
+    auto skipFade(Uint64 parentClock, Uint64 frames) -> void;
+
+    /// Move the fade cursor past every point at or before `clock`, taking on the value of the last one passed
+    auto advanceFadeCursor(Uint64 clock) -> void;
+
+    /// Compute the start value and slope of the segment between the points either side of the fade cursor
+    auto cacheFadeSegment() -> void;
+
+    /// Drop fade points that are no longer needed, keeping the start of the current segment
+    auto dropPassedFadePoints() -> void;
+
+    /// \returns whether the next `read` renders all `frames`, i.e. no pause is in effect or due within them
+    [[nodiscard]]
+    auto willRenderFully(Uint64 frames) const -> Bool;
+
+    /// Render ahead of the parent bus, which then receives the result from its next `read` call instead of
+    /// rendering again. Lets the parallel mixer render independent buses on worker threads.
+    /// \param[in]  frames  number of frames to render
+    auto prerender(Int64 frames) -> void;
+
     // ----- Commands ---------------------------------------------------------
     friend struct commands::SourceSetPause;
     friend struct commands::SourceSetUnpause;
@@ -203,6 +312,16 @@ private:
     friend struct commands::SourceFadeTo;
     auto fadeToImpl(Uint clock, Float value) -> void;
 
+    friend struct commands::SourceSetVirtual;
+    auto setVirtualImpl(Bool isVirtual) -> void;
+
+    friend struct commands::SourceSetEmitter;
+    auto setEmitterImpl(Int slot) -> void;
+
+    /// Reserve the scratch buffers for a full device buffer in this source's channel count, so that `read` does
+    /// not allocate on the audio thread
+    auto reserveBuffers() -> void;
+
     // ----- Data members -----------------------------------------------------
     /// Cached ref to the engine
     AudioContext *m_context{};
@@ -213,19 +332,44 @@ private:
     Handle<VolumeEffect> m_volume{};
     Handle<PanEffect> m_panner{};
 
-    /// Temporary audio buffers
-    AlignedList<Ubyte, 16> m_outBuffer{}, m_inBuffer{};
+    /// Rendered audio, processed in place by in-place effects
+    AlignedList<Ubyte, 16> m_outBuffer{};
+    /// Scratch output for effects that cannot process in place, swapped with `m_outBuffer` after each
+    AlignedList<Ubyte, 16> m_inBuffer{};
 
-    /// Current fade points
+    /// Fade points sorted by clock. Points before `m_fadeCursor` have been passed; the last of them starts the
+    /// segment being faded through, and the rest are dropped at the end of each read.
     List<FadePoint> m_fadePoints{};
+    Size m_fadeCursor{};
+    /// Value and slope per frame of the current segment from its first point, valid if `m_isFadeSegmentCached`.
+    /// Computed on the first read of each segment, and again after fade points are added or removed.
+    Double m_fadeStart{}, m_fadeSlope{};
+    Bool m_isFadeSegmentCached{};
 
     // Core State
     Float m_fadeValue{1.f};
-    Uint64 m_clock{}, m_parentClock{};
+    std::atomic<Uint64> m_clock{}, m_parentClock{}; ///< written by the audio thread, readable from any thread
     Bool m_paused{};
     Uint64 m_pauseClock{std::numeric_limits<Uint64>::max()}, m_unpauseClock{std::numeric_limits<Uint64>::max()};
     Bool m_releaseOnPauseClock{};
-    Bool m_shouldDiscard{};
+    std::atomic<Bool> m_shouldDiscard{}; ///< set from any thread, read by the audio thread
+    std::atomic<Bool> m_isVirtual{};     ///< written by the audio thread, readable from any thread
+    std::atomic<Float> m_gain{1.f};      ///< written by the audio thread, readable from any thread
+    Int64 m_prerenderedLength{-1};       ///< result of a `prerender` not yet read by the parent, `-1` if none
+
+    // Pitch
+    dsp::Resampler m_resampler{};
+    std::atomic<Float> m_pitch{1.f}; ///< set from any thread, read by the audio thread
+    std::atomic<ResampleQuality> m_resampleQuality{ResampleQuality::Sinc};
+
+    std::atomic<Int> m_sidechainTap{-1}; ///< set from any thread, read by the audio thread
+    std::atomic<Int> m_analyzerTap{-1};  ///< set from any thread, read by the audio thread
+
+    // Spatialization, see `Spatializer`
+    Int m_emitter{-1};     ///< emitter slot, owning thread
+    Int m_spatialSlot{-1}; ///< emitter slot mixed with, audio thread; lags `m_emitter` until the next publish
+
+    Int m_channels{2}; ///< interleaved channels per rendered frame
 };
 
 KSND_NS_END
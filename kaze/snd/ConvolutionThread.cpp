@@ -0,0 +1,72 @@
+#include "ConvolutionThread.h"
+
+#include <kaze/snd/dsp/Convolver.h>
+
+#include <algorithm>
+
+KSND_NS_BEGIN
+
+ConvolutionThread::~ConvolutionThread()
+{
+    stop();
+}
+
+auto ConvolutionThread::start() -> void
+{
+    if (isRunning())
+        return;
+
+    m_isRunning.store(True, std::memory_order_release);
+    m_thread = std::thread([this]() { run(); });
+}
+
+auto ConvolutionThread::stop() -> void
+{
+    if (isRunning())
+    {
+        m_isRunning.store(False, std::memory_order_release);
+        signal();
+        m_thread.join();
+    }
+
+    const auto lockGuard = std::lock_guard(m_mutex);
+    m_convolvers.clear();
+}
+
+auto ConvolutionThread::add(dsp::Convolver *convolver) -> void
+{
+    const auto lockGuard = std::lock_guard(m_mutex);
+    m_convolvers.emplace_back(convolver);
+}
+
+auto ConvolutionThread::remove(dsp::Convolver *convolver) -> void
+{
+    // Waits out a pass in progress, which holds the lock
+    const auto lockGuard = std::lock_guard(m_mutex);
+    std::erase(m_convolvers, convolver);
+}
+
+auto ConvolutionThread::signal() -> void
+{
+    m_wake.fetch_add(1, std::memory_order_release);
+    m_wake.notify_one();
+}
+
+auto ConvolutionThread::run() -> void
+{
+    // Check before the first wait as well, since the worker may only get scheduled after `stop` was called
+    auto seen = m_wake.load(std::memory_order_acquire);
+    while (isRunning())
+    {
+        {
+            const auto lockGuard = std::lock_guard(m_mutex);
+            for (const auto convolver : m_convolvers)
+                convolver->runPending();
+        }
+
+        m_wake.wait(seen, std::memory_order_acquire);
+        seen = m_wake.load(std::memory_order_acquire);
+    }
+}
+
+KSND_NS_END
@@ -0,0 +1,53 @@
+#pragma once
+#include <kaze/snd/lib.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+KSND_NS_BEGIN
+
+namespace dsp { class Convolver; }
+
+/// Worker thread that sums the tail partitions of every registered `dsp::Convolver`, keeping the bulk of long
+/// impulse responses off the audio thread.
+///
+/// Convolvers are added and removed from the owning thread. The audio thread only calls `signal` after queueing
+/// work, which bumps an atomic and wakes the worker without taking a lock.
+class ConvolutionThread {
+public:
+    ConvolutionThread() = default;
+    ~ConvolutionThread();
+
+    KAZE_NO_COPY(ConvolutionThread);
+
+    /// Start the worker thread, if not already running
+    auto start() -> void;
+
+    /// Stop and join the worker thread, and forget every convolver
+    auto stop() -> void;
+
+    [[nodiscard]]
+    auto isRunning() const -> Bool { return m_isRunning.load(std::memory_order_acquire); }
+
+    /// Register a convolver whose queued tails the worker computes. Owning thread only.
+    auto add(dsp::Convolver *convolver) -> void;
+
+    /// Unregister a convolver. Once this returns, the worker no longer touches it, so it may be deleted.
+    /// Owning thread only.
+    auto remove(dsp::Convolver *convolver) -> void;
+
+    /// Wake the worker after queueing work. Lock-free, for the audio thread.
+    auto signal() -> void;
+
+private:
+    auto run() -> void;
+
+    std::thread m_thread{};
+    std::mutex m_mutex{};
+    List<dsp::Convolver *> m_convolvers{}; ///< guarded by `m_mutex`
+    std::atomic<Uint> m_wake{};            ///< bumped per signal to wake the worker
+    std::atomic<Bool> m_isRunning{};
+};
+
+KSND_NS_END
@@ -0,0 +1,143 @@
+#include "MixerThreadPool.h"
+
+#include <kaze/core/intrinsics.h>
+#include <kaze/core/platform/defines.h>
+
+#if KAZE_PLATFORM_WINDOWS
+#include <windows.h>
+#elif !KAZE_PLATFORM_EMSCRIPTEN
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+KSND_NS_BEGIN
+
+/// Hint to the CPU that the calling thread is busy-waiting
+static auto spinPause() -> void
+{
+#if KAZE_CPU_SSE
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+/// Ask the OS to schedule the calling thread like an audio thread. Failure is not an error, since most
+/// platforms require extra privileges for it.
+static auto requestRealtimePriority() -> void
+{
+#if KAZE_PLATFORM_WINDOWS
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+#elif !KAZE_PLATFORM_EMSCRIPTEN
+    sched_param param{};
+    param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+#endif
+}
+
+MixerThreadPool::~MixerThreadPool()
+{
+    stop();
+}
+
+auto MixerThreadPool::start(const Int threadCount) -> void
+{
+    if ( !m_threads.empty() )
+        return;
+
+    m_isRunning.store(True, std::memory_order_release);
+    m_threads.reserve(threadCount);
+    for (Int i = 0; i < threadCount; ++i)
+        m_threads.emplace_back([this]() { runWorker(); });
+}
+
+auto MixerThreadPool::stop() -> void
+{
+    if (m_threads.empty())
+        return;
+
+    m_isRunning.store(False, std::memory_order_release);
+    m_wake.fetch_add(1, std::memory_order_release);
+    m_wake.notify_all();
+
+    for (auto &thread : m_threads)
+        thread.join();
+    m_threads.clear();
+}
+
+auto MixerThreadPool::run(const Int count, const Task task, void *userdata) -> void
+{
+    if (count <= 0)
+        return;
+
+    if (m_threads.empty() || count == 1)
+    {
+        for (Int i = 0; i < count; ++i)
+            task(userdata, i);
+        return;
+    }
+
+    // Retire the last batch before touching it. A worker still holding a claim on it may see the new count below,
+    // but its claim can no longer succeed: the count is published after this store, so the claim reads it too.
+    const auto claim = ((m_claim.load(std::memory_order_relaxed) >> 32) + 1) << 32;
+    m_claim.store(claim | RetiredIndex, std::memory_order_relaxed);
+
+    // Workers of the last batch finished running its tasks before `m_remaining` reached zero
+    m_task = task;
+    m_userdata = userdata;
+    m_remaining.store(count, std::memory_order_relaxed);
+    m_count.store(count, std::memory_order_release);
+
+    m_claim.store(claim, std::memory_order_release);
+
+    m_wake.fetch_add(1, std::memory_order_release);
+    m_wake.notify_all();
+
+    work(claim);
+
+    // Wait for tasks still running on workers
+    while (m_remaining.load(std::memory_order_acquire) > 0)
+        spinPause();
+}
+
+auto MixerThreadPool::runWorker() -> void
+{
+    requestRealtimePriority();
+
+    // Check before the first wait as well, since a worker may only get scheduled after `stop` was called
+    auto seen = m_wake.load(std::memory_order_acquire);
+    while (m_isRunning.load(std::memory_order_acquire))
+    {
+        for (Int spin = 0; spin < SpinCount && m_wake.load(std::memory_order_acquire) == seen; ++spin)
+            spinPause();
+        m_wake.wait(seen, std::memory_order_acquire);
+
+        seen = m_wake.load(std::memory_order_acquire);
+        if ( !m_isRunning.load(std::memory_order_acquire) )
+            return;
+
+        work(m_claim.load(std::memory_order_acquire));
+    }
+}
+
+auto MixerThreadPool::work(Uint64 claim) -> void
+{
+    const auto generation = claim >> 32;
+    while (True)
+    {
+        // Stop once the batch is exhausted, or a newer batch was published while this thread was catching up
+        const auto index = static_cast<Int>(claim & 0xFFFFFFFFull);
+        if (claim >> 32 != generation || index >= m_count.load(std::memory_order_acquire))
+            return;
+
+        if (m_claim.compare_exchange_weak(claim, claim + 1,
+            std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            m_task(m_userdata, index);
+            m_remaining.fetch_sub(1, std::memory_order_release);
+            ++claim;
+        }
+    }
+}
+
+KSND_NS_END
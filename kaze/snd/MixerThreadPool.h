@@ -0,0 +1,72 @@
+#pragma once
+#include <kaze/snd/lib.h>
+
+#include <atomic>
+#include <thread>
+
+KSND_NS_BEGIN
+
+/// Small pool of worker threads that helps the audio thread render independent parts of the mixing graph.
+///
+/// The audio thread hands out a batch of tasks with `run`, works on the batch itself, and returns once every task
+/// is done. Neither side takes a lock: tasks are claimed from an atomic counter, and idle workers sleep on an
+/// atomic wait, so the audio thread only issues a wake-up per batch. Workers spin for a short while before going
+/// back to sleep, since the batches of one callback arrive in quick succession.
+class MixerThreadPool {
+public:
+    /// Task callback, called once for each index in `[0, count)` of a batch
+    using Task = void (*)(void *userdata, Int index);
+
+    MixerThreadPool() = default;
+    ~MixerThreadPool();
+
+    KAZE_NO_COPY(MixerThreadPool);
+
+    /// Start the worker threads, if not already running. Workers request realtime scheduling, and fall back to
+    /// normal priority where the platform denies it.
+    /// \param[in]  threadCount  number of workers to start, not counting the audio thread
+    auto start(Int threadCount) -> void;
+
+    /// Stop and join the worker threads. Must not be called while `run` is in progress.
+    auto stop() -> void;
+
+    /// \returns number of worker threads, not counting the audio thread; `0` if stopped
+    [[nodiscard]]
+    auto getThreadCount() const -> Int { return static_cast<Int>(m_threads.size()); }
+
+    /// Run a batch of tasks across the workers and the calling thread, and wait for all of them to finish.
+    /// Only one thread may call this at a time.
+    /// \param[in]  count     number of tasks in the batch
+    /// \param[in]  task      callback to run per task
+    /// \param[in]  userdata  context passed to `task`
+    auto run(Int count, Task task, void *userdata) -> void;
+
+private:
+    auto runWorker() -> void;
+
+    /// Claim and run tasks of the batch published as `claim`, until none are left
+    auto work(Uint64 claim) -> void;
+
+    /// Number of polls an idle worker makes before sleeping
+    static constexpr Int SpinCount = 4096;
+
+    static constexpr Size CacheLine = 64;
+
+    /// Task index stored in `m_claim` while a new batch is being set up, at or past the end of any batch
+    static constexpr Uint64 RetiredIndex = 0x7FFFFFFF;
+
+    List<std::thread> m_threads{};
+
+    // Current batch. Task and userdata are only read after a successful claim, which keeps the batch alive.
+    Task m_task{};
+    void *m_userdata{};
+    std::atomic<Int> m_count{};
+
+    /// Batch generation in the upper 32 bits, next task index in the lower 32 bits
+    alignas(CacheLine) std::atomic<Uint64> m_claim{};
+    alignas(CacheLine) std::atomic<Int> m_remaining{};  ///< tasks not yet finished
+    alignas(CacheLine) std::atomic<Uint> m_wake{};       ///< bumped per batch to wake sleeping workers
+    std::atomic<Bool> m_isRunning{};
+};
+
+KSND_NS_END
@@ -0,0 +1,41 @@
+#include "SidechainTaps.h"
+#include <kaze/snd/dsp/kernels.h>
+
+#include <algorithm>
+
+KSND_NS_BEGIN
+
+auto SidechainTaps::prepare(const Int64 maxFrames) -> void
+{
+    for (auto &tap : m_buffers)
+    {
+        for (auto &buffer : tap)
+        {
+            buffer.levels.assign(maxFrames, 0);
+            buffer.frames = 0;
+            buffer.callback = 0;
+        }
+    }
+
+    m_callback = 1;
+}
+
+auto SidechainTaps::write(const Int tap, const Float *samples, const Int64 frames, const Int channels) -> void
+{
+    auto &buffer = m_buffers[tap][m_callback % 2];
+    buffer.frames = std::min(frames, static_cast<Int64>(buffer.levels.size()));
+    buffer.callback = m_callback;
+    dsp::getKernels().peak(samples, buffer.levels.data(), buffer.frames, channels);
+}
+
+auto SidechainTaps::read(const Int tap, Int64 *outFrames) const -> const Float *
+{
+    const auto &buffer = m_buffers[tap][(m_callback - 1) % 2];
+    if (buffer.callback != m_callback - 1 || buffer.frames == 0)
+        return Null;
+
+    *outFrames = buffer.frames;
+    return buffer.levels.data();
+}
+
+KSND_NS_END
@@ -0,0 +1,56 @@
+#pragma once
+#include <kaze/snd/lib.h>
+
+#include <kaze/core/AlignedList.h>
+
+KSND_NS_BEGIN
+
+/// Levels of sources published for effects elsewhere in the mixing graph to key off, e.g. a compressor on the music
+/// bus ducking under a dialogue bus.
+///
+/// Each tap holds the level of the loudest channel per frame, see `dsp::Kernels::peak`. Readers get the levels
+/// written in the previous callback, one buffer late, so that neither the order buses render in nor rendering them
+/// on the parallel mixer's threads matters. A tap that was not written in the previous callback reads as silence.
+class SidechainTaps {
+public:
+    /// Number of taps
+    static constexpr Int MaxTaps = 8;
+
+    SidechainTaps() = default;
+
+    KAZE_NO_COPY(SidechainTaps);
+
+    /// Size every tap for callbacks of up to `maxFrames` frames and clear them. Only while the audio thread is not
+    /// running.
+    auto prepare(Int64 maxFrames) -> void;
+
+    /// Start a callback, making the levels written during the last one readable. Audio thread, before rendering.
+    auto beginCallback() -> void { ++m_callback; }
+
+    /// Publish the levels of interleaved frames, beyond the size given to `prepare` dropped. Each tap takes one
+    /// writer per callback, on whichever thread renders it.
+    /// \param[in]  tap       tap index, from `0` to `MaxTaps - 1`
+    /// \param[in]  samples   interleaved frames
+    /// \param[in]  frames    number of frames
+    /// \param[in]  channels  channels per frame
+    auto write(Int tap, const Float *samples, Int64 frames, Int channels) -> void;
+
+    /// Get the levels written to a tap during the previous callback. Any thread rendering this callback.
+    /// \param[in]  tap        tap index, from `0` to `MaxTaps - 1`
+    /// \param[out] outFrames  receives the number of levels
+    /// \returns one level per frame, or null if nothing was written to the tap.
+    [[nodiscard]]
+    auto read(Int tap, Int64 *outFrames) const -> const Float *;
+
+private:
+    struct Buffer {
+        AlignedList<Float, 16> levels{};
+        Int64 frames{};
+        Uint64 callback{}; ///< callback the levels were written in
+    };
+
+    Buffer m_buffers[MaxTaps][2]{}; ///< written and read on alternate callbacks
+    Uint64 m_callback{1};           ///< starts past the callback every cleared buffer claims
+};
+
+KSND_NS_END
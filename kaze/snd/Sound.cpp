@@ -1,16 +1,32 @@
 #include "Sound.h"
 #include <kaze/core/math/mathf.h>
 #include <kaze/snd/AudioContext.h>
+#include <kaze/snd/SoundBank.h>
+#include <kaze/snd/conv/BlockCache.h>
 #include <kaze/snd/conv/extern/miniaudio/miniaudio_ext.h>
 #include <kaze/core/io/io.h>
 #include <kaze/core/platform/defines.h>
 
 #include "sources/AudioBus.h"
+#include "sources/PCMSource.h"
 #include "sources/StreamSource.h"
 
 KSND_NS_BEGIN
 
 // ===== WAV Marker retrieval code =====
+/// Move marker positions from one sample rate to another
+static auto convertMarkerRate(List<AudioMarker> *markers, const Int freq, const Int targetFreq) -> void
+{
+    if (freq == targetFreq || freq <= 0)
+        return;
+
+    const auto sizeFactor = (float)targetFreq / (float)freq;
+    for (auto &marker : *markers)
+    {
+        marker.position = static_cast<Uint64>(mathf::round((float)marker.position * sizeFactor));
+    }
+}
+
 static bool loadAudioMarkersImpl(
     void *userdata,
     bool(*getMarkersCallback)(void *, List<AudioMarker> *, int *),
@@ -25,15 +41,7 @@ static bool loadAudioMarkersImpl(
         int freq = targetSpec.freq;
         getMarkersCallback(userdata, &markers, &freq);
 
-        if (targetSpec.freq != freq)
-        {
-            const auto sizeFactor = (float)targetSpec.freq / (float)freq;
-            for (auto &marker : markers)
-            {
-                marker.position = static_cast<Uint64>(mathf::round((float)marker.position * sizeFactor));
-            }
-        }
-
+        convertMarkerRate(&markers, freq, targetSpec.freq);
         outMarkers->swap(markers);
     }
 
@@ -66,14 +74,35 @@ static auto loadAudioMarkers(
 }
 
 
+/// Decode sound file data into a new shared SoundBuffer
+static auto decodeBuffer(const MemView<void> mem, const AudioSpec &targetSpec, SharedSoundBuffer *outBuffer) -> Bool
+{
+    auto buffer = std::make_shared<SoundBuffer>();
+    if ( !buffer->load(mem, targetSpec) )
+    {
+        return False;
+    }
+
+    *outBuffer = std::move(buffer);
+    return True;
+}
+
 // ===== Sound::Impl =====
 struct Sound::Impl {
     List<AudioMarker> markers{};
     Variant< ManagedMem, MemView<void>, String > data{};
+    SharedSoundBuffer buffer{}; ///< decoded data, when opened with `Sound::Decoded`
+    BlockCache *blockCache{};   ///< where instances of a `Sound::Compressed` sound share blocks, once played
+    Uint64 blockCacheKey{};
     AudioSpec targetSpec{};
     InitFlags flags{};
     Bool isOpen{};
 
+    // Voice management
+    Int maxVoices{};
+    Int priority{};
+    VoiceSteal stealPolicy{VoiceSteal::Oldest};
+
     enum class Type : size_t {
         ManagedMem,
         MemView,
@@ -126,11 +155,26 @@ auto Sound::openFile(const String &filename, InitFlags flags, const AudioSpec &t
         return False;
     }
 
+    if (flags & Compressed)
+        flags |= Sound::InMemory;
+
 #if KAZE_PLATFORM_EMSCRIPTEN
     // force in-memory streams in Emscripten builds, since it does not support streaming via the virtual FS.
     flags |= Sound::InMemory;
 #endif
-    if (flags & InMemory)
+    if (flags & Decoded)
+    {
+        // Decode up front, instances never read from the file
+        auto buffer = std::make_shared<SoundBuffer>();
+        if ( !buffer->load(filename, targetSpec) )
+        {
+            return False;
+        }
+
+        m->buffer = std::move(buffer);
+        m->data = filename;
+    }
+    else if (flags & InMemory)
     {
         Ubyte *fileData;
         Size fileSize;
@@ -173,6 +217,11 @@ auto Sound::openMem(
 
     flags |= InitFlags::InMemory; // this is in-memory data
 
+    if (flags & Decoded && !decodeBuffer({mem.data(), mem.size()}, targetSpec, &m->buffer))
+    {
+        return False;
+    }
+
     m->data = mem;
     m->targetSpec = targetSpec;
     m->flags = flags;
@@ -195,6 +244,53 @@ auto Sound::openConstMem(const MemView<void> mem, InitFlags flags, const AudioSp
 
     flags |= Sound::InMemory;  // this is in-memory data
 
+    if (flags & Decoded && !decodeBuffer(mem, targetSpec, &m->buffer))
+    {
+        return False;
+    }
+
+    m->data = mem;
+    m->targetSpec = targetSpec;
+    m->flags = flags;
+    m->markers.swap(markers);
+    m->isOpen = True;
+    return True;
+}
+
+auto Sound::openBank(const SoundBank &bank, const StringView name, InitFlags flags, const AudioSpec &targetSpec)
+    -> Bool
+{
+    KAZE_HANDLE_GUARD_RET(False);
+
+    const auto entry = bank.find(name);
+    if ( !entry )
+    {
+        KAZE_PUSH_ERR(Error::MissingKeyErr, "sound bank has no sound named \"{}\"", name);
+        return False;
+    }
+
+    // Markers were parsed when the bank was built
+    List<AudioMarker> markers;
+    if ( !bank.getMarkers(*entry, &markers) )
+    {
+        return False;
+    }
+
+    convertMarkerRate(&markers, entry->freq, targetSpec.freq);
+
+    const auto mem = bank.getPayload(*entry);
+    if ( !mem.data() )
+    {
+        return False;
+    }
+
+    flags |= Sound::InMemory; // points into the bank
+
+    if (flags & Decoded && !decodeBuffer(mem, targetSpec, &m->buffer))
+    {
+        return False;
+    }
+
     m->data = mem;
     m->targetSpec = targetSpec;
     m->flags = flags;
@@ -252,6 +348,42 @@ auto Sound::getMarkerCount() const -> Size
     return m->markers.size();
 }
 
+auto Sound::setMaxVoices(const Int maxVoices) -> void
+{
+    KAZE_HANDLE_GUARD();
+    m->maxVoices = maxVoices;
+}
+
+auto Sound::getMaxVoices() const -> Int
+{
+    KAZE_HANDLE_GUARD_RET(0);
+    return m->maxVoices;
+}
+
+auto Sound::setPriority(const Int priority) -> void
+{
+    KAZE_HANDLE_GUARD();
+    m->priority = priority;
+}
+
+auto Sound::getPriority() const -> Int
+{
+    KAZE_HANDLE_GUARD_RET(0);
+    return m->priority;
+}
+
+auto Sound::setStealPolicy(const VoiceSteal policy) -> void
+{
+    KAZE_HANDLE_GUARD();
+    m->stealPolicy = policy;
+}
+
+auto Sound::getStealPolicy() const -> VoiceSteal
+{
+    KAZE_HANDLE_GUARD_RET(VoiceSteal::Oldest);
+    return m->stealPolicy;
+}
+
 auto Sound::getSpec() const -> AudioSpec
 {
     KAZE_HANDLE_GUARD_RET(AudioSpec{});
@@ -260,13 +392,37 @@ auto Sound::getSpec() const -> AudioSpec
 }
 
 
+auto Sound::getMemoryUsage() const -> SoundMemoryUsage
+{
+    KAZE_HANDLE_GUARD_RET(SoundMemoryUsage{});
+    SOUND_INIT_GUARD(SoundMemoryUsage{});
+
+    SoundMemoryUsage usage{};
+    if ((Impl::Type)m->data.index() == Impl::Type::ManagedMem)
+        usage.fileBytes = std::get<ManagedMem>(m->data).size();
+    else if ((Impl::Type)m->data.index() == Impl::Type::MemView)
+        usage.fileBytes = std::get<MemView<void>>(m->data).size();
+
+    if (m->buffer)
+        usage.decodedBytes = m->buffer->size();
+    if (m->blockCache)
+        usage.cachedBytes = m->blockCache->getBytes(m->blockCacheKey);
+    return usage;
+}
+
 auto Sound::init_() -> Bool
 {
     m->data = MemView<void>{};
+    m->buffer.reset();
+    m->blockCache = Null;
+    m->blockCacheKey = 0;
     m->flags = InitFlags::None;
     m->isOpen = False;
     m->targetSpec = {};
-    
+    m->maxVoices = 0;
+    m->priority = 0;
+    m->stealPolicy = VoiceSteal::Oldest;
+
     return True;
 }
 
@@ -280,6 +436,14 @@ void Sound::release_()
         }
     }
 
+    m->buffer.reset(); // instances still playing keep their own reference
+    if (m->blockCache)
+    {
+        // Instances still playing may cache a few more blocks under the key, which age out of the cache
+        m->blockCache->evict(m->blockCacheKey);
+        m->blockCache = Null;
+        m->blockCacheKey = 0;
+    }
     m->flags = InitFlags::None;
     m->markers.clear();
     m->isOpen = False;
@@ -312,6 +476,35 @@ auto Sound::instantiate(AudioContext *context, Bool paused, Handle<AudioBus> bus
     const Bool oneShot = m->flags & Sound::OneShot;
     const Bool inMemory = m->flags & Sound::InMemory;
 
+    if (m->buffer)
+    {
+        // Decoded sounds play straight from the shared buffer
+        const Handle<AudioSource> source = context->createObjectImpl<PCMSource>(
+            PCMSourceInit {
+                .context = context,
+                .buffer = m->buffer,
+                .parentClock = parentClock,
+                .paused = paused,
+                .isLooping = looping,
+                .isOneShot = oneShot,
+            }
+        ).cast<AudioSource>();
+
+        if ( !source )
+            return False;
+
+        if ( !AudioBus::connect(bus, source) )
+        {
+            context->releaseObject(source);
+            return False;
+        }
+
+        if (outSource)
+            *outSource = source;
+
+        return True;
+    }
+
     Variant< ManagedMem, MemView<void>, String > data;
     if (m->data.index() == 0)
     {
@@ -323,6 +516,13 @@ auto Sound::instantiate(AudioContext *context, Bool paused, Handle<AudioBus> bus
         data = m->data;
     }
 
+    const Bool compressed = m->flags & Sound::Compressed;
+    if (compressed && !m->blockCache)
+    {
+        m->blockCache = &context->getBlockCache();
+        m->blockCacheKey = m->blockCache->makeKey();
+    }
+
     const Handle<AudioSource> source = context->createObjectImpl<StreamSource>(
         StreamSourceInit {
             .context = context,
@@ -332,14 +532,20 @@ auto Sound::instantiate(AudioContext *context, Bool paused, Handle<AudioBus> bus
             .isLooping = looping,
             .isOneShot = oneShot,
             .inMemory = inMemory,
+            .prefetch = compressed || static_cast<Bool>(m->flags & Sound::Prefetch),
+            .blockCache = compressed ? m->blockCache : Null,
+            .blockCacheKey = m->blockCacheKey,
         }
     ).cast<AudioSource>();
 
     if ( !source )
         return False;
 
-    context->pushImmediateCommand(
-        commands::BusConnectSource(bus, source));
+    if ( !AudioBus::connect(bus, source) )
+    {
+        context->releaseObject(source);
+        return False;
+    }
 
     if (outSource)
         *outSource = source.cast<AudioSource>();
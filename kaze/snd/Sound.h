@@ -3,6 +3,7 @@
 #include <kaze/snd/lib.h>
 #include <kaze/snd/AudioTime.h>
 #include <kaze/snd/AudioMarker.h>
+#include <kaze/snd/VoiceLimits.h>
 
 #include <kaze/core/Handle.h>
 #include <kaze/core/MemView.h>
@@ -15,6 +16,18 @@ class AudioBus;
 class AudioContext;
 struct AudioSpec;
 class AudioSource;
+class BlockCache;
+class SoundBank;
+
+/// Memory held for a sound, see `Sound::getMemoryUsage`
+struct SoundMemoryUsage {
+    Size fileBytes;    ///< file data kept in memory, owned or borrowed; `0` when streamed from disk
+    Size decodedBytes; ///< PCM decoded up front with `Sound::Decoded`
+    Size cachedBytes;  ///< decoded blocks in the context's `BlockCache` with `Sound::Compressed`
+
+    [[nodiscard]]
+    auto total() const -> Size { return fileBytes + decodedBytes + cachedBytes; }
+};
 
 /// Description to instantiate a sound source
 class Sound {
@@ -38,6 +51,16 @@ public:
         OneShot   = 1 << 1,
         Stream    = 1 << 2, ///< Stream data (default streams from file)
         InMemory  = 1 << 3, ///< Store file data in memory, as opposed to streaming from file (forced true on web)
+        Decoded   = 1 << 4, ///< Decode the whole sound to PCM once on open, and play every instance from that shared
+                            ///< buffer. Uses more memory, but instances skip decoding, conversion and resampling;
+                            ///< best for short, frequently played sounds.
+        Prefetch  = 1 << 5, ///< Decode streamed instances on a background thread ahead of the play head, so file
+                            ///< reads and decoding stay off the audio thread. Best for long music and ambiences.
+        Compressed = 1 << 6, ///< Keep the file compressed in memory, like `InMemory`, and decode it in blocks
+                             ///< ahead of the play head, like `Prefetch`. Decoded blocks are kept in the
+                             ///< context's `BlockCache` for every instance to share, so replays and overlapping
+                             ///< instances decode each stretch once. A middle ground between `InMemory` and
+                             ///< `Decoded` for large libraries of music and ambiences.
     };
 
     /// Add a marker into the Sound at a given position. Native units are in `TimeUnit::PCM`.
@@ -55,9 +78,36 @@ public:
     /// \returns the number of markers available in the Sound
     auto getMarkerCount() const -> Size;
 
+    /// Limit how many instances of this sound may be heard at once. Instances over the limit are virtualized.
+    /// \param[in]  maxVoices  maximum number of real voices; `0` for no limit (default)
+    auto setMaxVoices(Int maxVoices) -> void;
+
+    [[nodiscard]]
+    auto getMaxVoices() const -> Int;
+
+    /// Set the priority of new instances when voice limits are reached. A new instance may only take over the
+    /// slot of a voice with the same or a lower priority.
+    /// \param[in]  priority  higher is more important [default: `0`]
+    auto setPriority(Int priority) -> void;
+
+    [[nodiscard]]
+    auto getPriority() const -> Int;
+
+    /// Set which instance is taken over when this sound's own voice limit is reached
+    /// \param[in]  policy  voice to virtualize [default: `VoiceSteal::Oldest`]
+    auto setStealPolicy(VoiceSteal policy) -> void;
+
+    [[nodiscard]]
+    auto getStealPolicy() const -> VoiceSteal;
+
     /// \returns the source Audio spec of the sound
     auto getSpec() const -> AudioSpec;
 
+    /// \returns memory held for the sound: its file data, PCM decoded up front, and its decoded blocks in the
+    ///          context's `BlockCache`
+    [[nodiscard]]
+    auto getMemoryUsage() const -> SoundMemoryUsage;
+
     /// \returns whether the sound is valid and ready to instantiate AudioSources
     [[nodiscard]]
     auto isOpen() const -> Bool;
@@ -79,6 +129,15 @@ public:
     /// \returns `True` if open was successful.
     auto openMem(ManagedMem mem, InitFlags flags, const AudioSpec &targetSpec) -> Bool;
 
+    /// Open a sound from a sound bank, pointing into the bank's memory without copying it. The markers stored in
+    /// the bank are used as is, so no file header is parsed.
+    /// \param[in]  bank        open bank to find the sound in; must stay open while the sound is alive
+    /// \param[in]  name        name of the sound in the bank
+    /// \param[in]  flags       sound attributes; `InMemory` is implied
+    /// \param[in]  targetSpec  target sound spec, grab this from the Engine/Context.
+    /// \returns `True` if the bank has the sound and open was successful.
+    auto openBank(const SoundBank &bank, StringView name, InitFlags flags, const AudioSpec &targetSpec) -> Bool;
+
     auto init_() -> Bool;
 
     /// Release the sound resources. All instances of the sound should be released.
@@ -0,0 +1,248 @@
+#include "SoundBank.h"
+
+#include <kaze/core/debug.h>
+#include <kaze/core/endian.h>
+
+#include <algorithm>
+#include <cstdint>
+
+KSND_NS_BEGIN
+
+/// \returns whether `size` bytes from `offset` lie within `total` bytes, without overflowing
+static auto isInBounds(const Uint64 offset, const Uint64 size, const Uint64 total) -> Bool
+{
+    return offset <= total && size <= total - offset;
+}
+
+SoundBank::SoundBank() : m_file(), m_data(), m_size(), m_header(), m_entries(), m_markers()
+{ }
+
+SoundBank::~SoundBank()
+{
+    close();
+}
+
+SoundBank::SoundBank(SoundBank &&other) noexcept :
+    m_file(std::move(other.m_file)), m_data(other.m_data), m_size(other.m_size), m_header(other.m_header),
+    m_entries(other.m_entries), m_markers(other.m_markers)
+{
+    other.m_data = Null;
+    other.m_size = 0;
+    other.m_header = Null;
+    other.m_entries = Null;
+    other.m_markers = Null;
+}
+
+auto SoundBank::operator=(SoundBank &&other) noexcept -> SoundBank &
+{
+    if (this == &other) return *this;
+
+    close();
+    m_file = std::move(other.m_file);
+    m_data = other.m_data;
+    m_size = other.m_size;
+    m_header = other.m_header;
+    m_entries = other.m_entries;
+    m_markers = other.m_markers;
+
+    other.m_data = Null;
+    other.m_size = 0;
+    other.m_header = Null;
+    other.m_entries = Null;
+    other.m_markers = Null;
+    return *this;
+}
+
+auto SoundBank::openFile(const StringView path) -> Bool
+{
+    MappedFile file;
+    if ( !file.open(path) )
+    {
+        return False;
+    }
+
+    if ( !openImpl(file.data(), file.size()) )
+    {
+        return False;
+    }
+
+    m_file = std::move(file);
+    return True;
+}
+
+auto SoundBank::openConstMem(const MemView<void> mem) -> Bool
+{
+    return openImpl(static_cast<const Ubyte *>(mem.data()), mem.size());
+}
+
+auto SoundBank::openImpl(const Ubyte *data, const Size size) -> Bool
+{
+    if constexpr (Endian::isBig())
+    {
+        KAZE_PUSH_ERR(Error::Unsupported, "sound banks are little endian, and cannot be read on big endian hosts");
+        return False;
+    }
+
+    if ( !data )
+    {
+        KAZE_PUSH_ERR(Error::NullArgErr, "sound bank data was null");
+        return False;
+    }
+
+    if (reinterpret_cast<std::uintptr_t>(data) % alignof(SoundBankEntry) != 0)
+    {
+        KAZE_PUSH_ERR(Error::InvalidArgErr, "sound bank data must be aligned to {} bytes", alignof(SoundBankEntry));
+        return False;
+    }
+
+    if (size < sizeof(SoundBankHeader))
+    {
+        KAZE_PUSH_ERR(Error::RuntimeErr, "sound bank is too small to hold a header");
+        return False;
+    }
+
+    const auto header = reinterpret_cast<const SoundBankHeader *>(data);
+    if ( !std::equal(header->magic, header->magic + 4, SoundBankHeader::Magic) )
+    {
+        KAZE_PUSH_ERR(Error::RuntimeErr, "data is not a sound bank");
+        return False;
+    }
+
+    if (header->version != SoundBankHeader::CurrentVersion)
+    {
+        KAZE_PUSH_ERR(Error::Unsupported, "sound bank version {} is unsupported, expected {}",
+            header->version, SoundBankHeader::CurrentVersion);
+        return False;
+    }
+
+    if (header->fileSize != size)
+    {
+        KAZE_PUSH_ERR(Error::RuntimeErr, "sound bank is {} bytes, but its header expects {}; was it truncated?",
+            size, header->fileSize);
+        return False;
+    }
+
+    // Only the tables are checked here, each entry is checked when it is used
+    if ( !isInBounds(header->entryOffset, static_cast<Uint64>(header->entryCount) * sizeof(SoundBankEntry), size) ||
+        !isInBounds(header->markerOffset, static_cast<Uint64>(header->markerCount) * sizeof(SoundBankMarker), size) ||
+        !isInBounds(header->stringOffset, header->stringSize, size) ||
+        header->entryOffset % alignof(SoundBankEntry) != 0 || header->markerOffset % alignof(SoundBankMarker) != 0 )
+    {
+        KAZE_PUSH_ERR(Error::RuntimeErr, "sound bank tables are out of bounds");
+        return False;
+    }
+
+    close();
+    m_data = data;
+    m_size = size;
+    m_header = header;
+    m_entries = reinterpret_cast<const SoundBankEntry *>(data + header->entryOffset);
+    m_markers = reinterpret_cast<const SoundBankMarker *>(data + header->markerOffset);
+    return True;
+}
+
+auto SoundBank::close() -> void
+{
+    m_file.close();
+    m_data = Null;
+    m_size = 0;
+    m_header = Null;
+    m_entries = Null;
+    m_markers = Null;
+}
+
+auto SoundBank::getEntryCount() const -> Int
+{
+    return m_header ? static_cast<Int>(m_header->entryCount) : 0;
+}
+
+auto SoundBank::getEntry(const Int index) const -> const SoundBankEntry *
+{
+    if (index < 0 || index >= getEntryCount())
+    {
+        KAZE_PUSH_ERR(Error::OutOfRange, "sound bank entry index {} is out of range", index);
+        return Null;
+    }
+
+    return m_entries + index;
+}
+
+auto SoundBank::find(const StringView name) const -> const SoundBankEntry *
+{
+    if ( !m_header )
+    {
+        KAZE_PUSH_ERR(Error::NotInitialized, "attempted to look up a sound in a closed sound bank");
+        return Null;
+    }
+
+    const auto hash = hashName(name);
+    const auto end = m_entries + m_header->entryCount;
+    for (auto it = std::lower_bound(m_entries, end, hash, [](const SoundBankEntry &entry, const Uint64 value) {
+            return entry.nameHash < value;
+        }); it != end && it->nameHash == hash; ++it)
+    {
+        if (getName(*it) == name)
+            return it;
+    }
+
+    return Null;
+}
+
+auto SoundBank::getName(const SoundBankEntry &entry) const -> StringView
+{
+    return getString(entry.nameOffset, entry.nameLength);
+}
+
+auto SoundBank::getPayload(const SoundBankEntry &entry) const -> MemView<void>
+{
+    if ( !m_header || !isInBounds(entry.payloadOffset, entry.payloadSize, m_size) )
+    {
+        KAZE_PUSH_ERR(Error::RuntimeErr, "sound bank payload is out of bounds");
+        return {};
+    }
+
+    return {m_data + entry.payloadOffset, static_cast<Size>(entry.payloadSize)};
+}
+
+auto SoundBank::getSpec(const SoundBankEntry &entry) const -> AudioSpec
+{
+    return {
+        entry.freq,
+        entry.channels,
+        SampleFormat(entry.format & 0xFFu, entry.format >> 8 & 1u, entry.format >> 12 & 1u, entry.format >> 15 & 1u),
+    };
+}
+
+auto SoundBank::getMarkers(const SoundBankEntry &entry, List<AudioMarker> *outMarkers) const -> Bool
+{
+    if ( !m_header || !isInBounds(entry.markerIndex, entry.markerCount, m_header->markerCount) )
+    {
+        KAZE_PUSH_ERR(Error::RuntimeErr, "sound bank markers are out of bounds");
+        return False;
+    }
+
+    if (outMarkers)
+    {
+        outMarkers->clear();
+        outMarkers->reserve(entry.markerCount);
+        for (auto marker = m_markers + entry.markerIndex, end = marker + entry.markerCount; marker != end; ++marker)
+        {
+            const auto label = getString(marker->labelOffset, marker->labelLength);
+            outMarkers->emplace_back(String(label.data(), label.size()), marker->position);
+        }
+    }
+
+    return True;
+}
+
+auto SoundBank::getString(const Uint offset, const Uint length) const -> StringView
+{
+    if ( !m_header || !isInBounds(offset, length, m_header->stringSize) )
+    {
+        return {};
+    }
+
+    return {reinterpret_cast<const Char *>(m_data + m_header->stringOffset + offset), length};
+}
+
+KSND_NS_END
@@ -0,0 +1,172 @@
+#pragma once
+#include <kaze/snd/lib.h>
+#include <kaze/snd/AudioMarker.h>
+#include <kaze/snd/AudioSpec.h>
+
+#include <kaze/core/io/MappedFile.h>
+#include <kaze/core/MemView.h>
+
+KSND_NS_BEGIN
+
+// ===== Sound bank file format =====
+// Little endian, laid out as:
+//   SoundBankHeader
+//   SoundBankEntry[entryCount]    sorted by `nameHash`, for binary search
+//   SoundBankMarker[markerCount]  each entry's markers are a contiguous run, sorted by position
+//   strings                       names and marker labels, UTF-8 without terminators
+//   payloads                      each sound's file data, stored as-is and aligned to `SoundBankAlignment`
+// Payloads keep their original encoding: WAV stays PCM, FLAC, MP3 and Vorbis stay compressed.
+
+/// Alignment of each payload from the start of the bank
+static constexpr Size SoundBankAlignment = 64;
+
+/// Encoding of a payload, detected from its file header when the bank is built
+enum class SoundBankCodec : Uint {
+    Unknown,
+    Wav,
+    Flac,
+    Mp3,
+    Vorbis,
+};
+
+struct SoundBankHeader {
+    static constexpr Char Magic[4] = {'K', 'S', 'B', 'K'};
+    static constexpr Uint CurrentVersion = 1;
+
+    Char magic[4];       ///< `Magic`
+    Uint version;        ///< `CurrentVersion`
+    Uint entryCount;
+    Uint markerCount;
+    Uint64 entryOffset;  ///< start of the entry table
+    Uint64 markerOffset; ///< start of the marker table
+    Uint64 stringOffset; ///< start of the strings
+    Uint64 stringSize;   ///< bytes of strings
+    Uint64 fileSize;     ///< size of the whole bank, to catch truncated files
+};
+
+struct SoundBankEntry {
+    Uint64 nameHash;      ///< `SoundBank::hashName` of the name
+    Uint64 payloadOffset; ///< start of the file data, a multiple of `SoundBankAlignment`
+    Uint64 payloadSize;   ///< bytes of file data
+    Int64 frameLength;    ///< length in frames at the native rate, or `-1` if unknown
+    Uint nameOffset;      ///< offset of the name into the strings
+    Uint nameLength;
+    Uint markerIndex;     ///< index of the first marker in the marker table
+    Uint markerCount;
+    Int freq;             ///< native sample rate
+    Uint16 channels;      ///< native channel count
+    Uint16 format;        ///< `SampleFormat::flags` of the native sample format
+    SoundBankCodec codec;
+    Uint reserved;
+};
+
+struct SoundBankMarker {
+    Uint64 position;  ///< position in frames at the entry's native rate
+    Uint labelOffset; ///< offset of the label into the strings
+    Uint labelLength;
+};
+
+static_assert(sizeof(SoundBankHeader) == 56);
+static_assert(sizeof(SoundBankEntry) == 64);
+static_assert(sizeof(SoundBankMarker) == 16);
+
+/// Read-only sound bank: many sounds and their markers in one memory-mapped file, built with `SoundBankBuilder`
+/// or the `ksbank` tool.
+///
+/// Opening a bank maps it and checks its header only, so it costs the same however many sounds it holds. Sounds
+/// are looked up by name with a binary search over the hashed index, and `Sound::openBank` points them straight
+/// into the mapping, so only the pages of the sounds actually used are ever read from disk. The bank must stay
+/// open while any Sound opened from it is alive.
+class SoundBank {
+public:
+    SoundBank();
+    ~SoundBank();
+
+    KAZE_NO_COPY(SoundBank);
+
+    SoundBank(SoundBank &&other) noexcept;
+    auto operator=(SoundBank &&other) noexcept -> SoundBank &;
+
+    /// Map a bank file, closing any bank opened before
+    /// \param[in]  path  path to the bank
+    /// \returns whether the file opened and holds a valid bank header.
+    auto openFile(StringView path) -> Bool;
+
+    /// Open a bank that is already in memory, e.g. embedded in the executable
+    /// \param[in]  mem  bank data, aligned to 8 bytes; must outlive the bank and every Sound opened from it
+    /// \returns whether the memory holds a valid bank header.
+    auto openConstMem(MemView<void> mem) -> Bool;
+
+    /// Close the bank. Sounds opened from it must be released first.
+    auto close() -> void;
+
+    [[nodiscard]]
+    auto isOpen() const -> Bool { return m_header != Null; }
+
+    /// \returns number of sounds in the bank
+    [[nodiscard]]
+    auto getEntryCount() const -> Int;
+
+    /// \returns entry at an index of the table, in hash order, or `Null` if out of range
+    [[nodiscard]]
+    auto getEntry(Int index) const -> const SoundBankEntry *;
+
+    /// Look up a sound by name
+    /// \param[in]  name  name of the sound
+    /// \returns its entry, or `Null` if the bank has no sound by that name.
+    [[nodiscard]]
+    auto find(StringView name) const -> const SoundBankEntry *;
+
+    /// \returns name of an entry
+    [[nodiscard]]
+    auto getName(const SoundBankEntry &entry) const -> StringView;
+
+    /// \returns file data of an entry, pointing into the bank
+    [[nodiscard]]
+    auto getPayload(const SoundBankEntry &entry) const -> MemView<void>;
+
+    /// \returns native spec of an entry
+    [[nodiscard]]
+    auto getSpec(const SoundBankEntry &entry) const -> AudioSpec;
+
+    /// Copy out the markers of an entry
+    /// \param[in]   entry       entry to read
+    /// \param[out]  outMarkers  receives the markers, positioned in frames at the entry's native rate
+    /// \returns whether the entry's markers lie within the bank.
+    auto getMarkers(const SoundBankEntry &entry, List<AudioMarker> *outMarkers) const -> Bool;
+
+    /// \returns whether the bank is memory-mapped, rather than loaded whole because mapping is unavailable
+    [[nodiscard]]
+    auto isMapped() const -> Bool { return m_file.isMapped(); }
+
+    /// Hash of a sound name in the index, 64-bit FNV-1a
+    [[nodiscard]]
+    static constexpr auto hashName(const StringView name) -> Uint64
+    {
+        Uint64 hash = 0xcbf29ce484222325ull;
+        for (const auto c : name)
+        {
+            hash ^= static_cast<Ubyte>(c);
+            hash *= 0x100000001b3ull;
+        }
+
+        return hash;
+    }
+
+private:
+    /// Check the header and the bounds of the tables, and take the bank if they hold
+    auto openImpl(const Ubyte *data, Size size) -> Bool;
+
+    /// \returns a string of the string section, or empty if out of bounds
+    [[nodiscard]]
+    auto getString(Uint offset, Uint length) const -> StringView;
+
+    MappedFile m_file;
+    const Ubyte *m_data;
+    Size m_size;
+    const SoundBankHeader *m_header;
+    const SoundBankEntry *m_entries;
+    const SoundBankMarker *m_markers;
+};
+
+KSND_NS_END
@@ -0,0 +1,209 @@
+#include "SoundBankBuilder.h"
+
+#include <kaze/snd/conv/AudioDecoder.h>
+#include <kaze/snd/conv/extern/miniaudio/miniaudio_ext.h>
+
+#include <kaze/core/debug.h>
+#include <kaze/core/io/io.h>
+#include <kaze/core/memory.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+KSND_NS_BEGIN
+
+/// Identify the encoding of sound file data from its header
+static auto detectCodec(const MemView<void> mem) -> SoundBankCodec
+{
+    const auto data = static_cast<const Ubyte *>(mem.data());
+    const auto startsWith = [data, &mem](const char *magic) {
+        const auto length = std::strlen(magic);
+        return mem.size() >= length && std::memcmp(data, magic, length) == 0;
+    };
+
+    if (startsWith("RIFF") || startsWith("RIFX") || startsWith("RF64"))
+        return SoundBankCodec::Wav;
+    if (startsWith("fLaC"))
+        return SoundBankCodec::Flac;
+    if (startsWith("OggS"))
+        return SoundBankCodec::Vorbis;
+    if (startsWith("ID3") || (mem.size() >= 2 && data[0] == 0xFF && (data[1] & 0xE0) == 0xE0))
+        return SoundBankCodec::Mp3; // tagged, or starting on a frame sync
+    return SoundBankCodec::Unknown;
+}
+
+static auto alignUp(const Size value, const Size alignment) -> Size
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+auto SoundBankBuilder::add(const StringView name, const MemView<void> mem) -> Bool
+{
+    const auto hash = SoundBank::hashName(name);
+    for (const auto &item : m_items)
+    {
+        if (item.hash != hash)
+            continue;
+
+        if (item.name == name)
+            KAZE_PUSH_ERR(Error::DuplicateKey, "sound bank already has a sound named \"{}\"", name);
+        else
+            KAZE_PUSH_ERR(Error::DuplicateKey, "the name \"{}\" has the same hash as \"{}\"; rename either sound",
+                name, item.name);
+        return False;
+    }
+
+    Item item;
+    item.name = String(name.data(), name.size());
+    item.hash = hash;
+    item.data.assign(static_cast<const Ubyte *>(mem.data()), static_cast<const Ubyte *>(mem.data()) + mem.size());
+    item.codec = detectCodec(mem);
+
+    // An empty target spec keeps the native one
+    AudioDecoder decoder;
+    if ( !decoder.openConstMem(MemView<void>(item.data.data(), item.data.size()), AudioSpec{}) )
+    {
+        KAZE_PUSH_ERR(Error::RuntimeErr, "failed to decode sound \"{}\" for the sound bank", name);
+        return False;
+    }
+
+    item.spec = decoder.getSpec();
+    item.frameLength = decoder.getPCMFrameLength();
+
+    if (item.codec == SoundBankCodec::Wav)
+    {
+        // Positions are in frames at the file's own rate, the native rate stored in the entry
+        Int freq;
+        kaze_ma_dr_wav_get_markers_mem({item.data.data(), item.data.size()}, &item.markers, &freq);
+
+        std::stable_sort(item.markers.begin(), item.markers.end(), [](const AudioMarker &a, const AudioMarker &b) {
+            return a.position < b.position;
+        });
+    }
+
+    m_items.emplace_back(std::move(item));
+    return True;
+}
+
+auto SoundBankBuilder::addFile(const StringView name, const StringView path) -> Bool
+{
+    Ubyte *data;
+    Size size;
+    if ( !file::load(path, &data, &size) )
+    {
+        return False;
+    }
+
+    const auto result = add(name, MemView<void>(data, size));
+    memory::free(data);
+    return result;
+}
+
+auto SoundBankBuilder::build(List<Ubyte> *outData) const -> Bool
+{
+    if ( !outData )
+    {
+        KAZE_PUSH_ERR(Error::NullArgErr, "required argument `outData` was null");
+        return False;
+    }
+
+    // Sort the index by hash for binary search
+    List<const Item *> items;
+    items.reserve(m_items.size());
+    for (const auto &item : m_items)
+        items.emplace_back(&item);
+    std::sort(items.begin(), items.end(), [](const Item *a, const Item *b) { return a->hash < b->hash; });
+
+    // Strings and markers
+    String strings;
+    List<SoundBankMarker> markers;
+    List<SoundBankEntry> entries(items.size());
+    const auto addString = [&strings](const StringView string, Uint *outOffset, Uint *outLength) {
+        *outOffset = static_cast<Uint>(strings.size());
+        *outLength = static_cast<Uint>(string.size());
+        strings.append(string);
+    };
+
+    for (Size i = 0; i < items.size(); ++i)
+    {
+        const auto &item = *items[i];
+        auto &entry = entries[i];
+        std::memset(&entry, 0, sizeof(entry));
+
+        entry.nameHash = item.hash;
+        entry.frameLength = item.frameLength;
+        entry.freq = item.spec.freq;
+        entry.channels = static_cast<Uint16>(item.spec.channels);
+        entry.format = item.spec.format.flags();
+        entry.codec = item.codec;
+        addString(item.name, &entry.nameOffset, &entry.nameLength);
+
+        entry.markerIndex = static_cast<Uint>(markers.size());
+        entry.markerCount = static_cast<Uint>(item.markers.size());
+        for (const auto &marker : item.markers)
+        {
+            auto &bankMarker = markers.emplace_back();
+            bankMarker.position = marker.position;
+            addString(marker.label, &bankMarker.labelOffset, &bankMarker.labelLength);
+        }
+    }
+
+    if (strings.size() > std::numeric_limits<Uint>::max() || items.size() > std::numeric_limits<Uint>::max())
+    {
+        KAZE_PUSH_ERR(Error::OutOfRange, "too many sounds or names for one sound bank");
+        return False;
+    }
+
+    // Lay out the tables, then each payload aligned after them
+    SoundBankHeader header{};
+    std::memcpy(header.magic, SoundBankHeader::Magic, sizeof(header.magic));
+    header.version = SoundBankHeader::CurrentVersion;
+    header.entryCount = static_cast<Uint>(entries.size());
+    header.markerCount = static_cast<Uint>(markers.size());
+    header.entryOffset = sizeof(SoundBankHeader);
+    header.markerOffset = header.entryOffset + entries.size() * sizeof(SoundBankEntry);
+    header.stringOffset = header.markerOffset + markers.size() * sizeof(SoundBankMarker);
+    header.stringSize = strings.size();
+
+    auto size = static_cast<Size>(header.stringOffset + header.stringSize);
+    for (Size i = 0; i < items.size(); ++i)
+    {
+        size = alignUp(size, SoundBankAlignment);
+        entries[i].payloadOffset = size;
+        entries[i].payloadSize = items[i]->data.size();
+        size += items[i]->data.size();
+    }
+    header.fileSize = size;
+
+    List<Ubyte> data(size, 0);
+    std::memcpy(data.data(), &header, sizeof(header));
+    if ( !entries.empty() )
+        std::memcpy(data.data() + header.entryOffset, entries.data(), entries.size() * sizeof(SoundBankEntry));
+    if ( !markers.empty() )
+        std::memcpy(data.data() + header.markerOffset, markers.data(), markers.size() * sizeof(SoundBankMarker));
+    std::memcpy(data.data() + header.stringOffset, strings.data(), strings.size());
+    for (Size i = 0; i < items.size(); ++i)
+        std::memcpy(data.data() + entries[i].payloadOffset, items[i]->data.data(), items[i]->data.size());
+
+    outData->swap(data);
+    return True;
+}
+
+auto SoundBankBuilder::write(const StringView path) const -> Bool
+{
+    List<Ubyte> data;
+    if ( !build(&data) )
+    {
+        return False;
+    }
+
+    return file::write(path, Mem(data.data(), data.size()));
+}
+
+auto SoundBankBuilder::clear() -> void
+{
+    m_items.clear();
+}
+
+KSND_NS_END
@@ -0,0 +1,58 @@
+#pragma once
+#include <kaze/snd/lib.h>
+#include <kaze/snd/SoundBank.h>
+
+KSND_NS_BEGIN
+
+/// Packs sound files into a sound bank, see `SoundBank` for the format. Backs the `ksbank` tool.
+///
+/// Each sound is probed once here for its spec, length and WAV markers, so that opening it from the bank needs no
+/// parsing beyond a lookup. File data is copied in as-is, keeping each sound's encoding.
+class SoundBankBuilder {
+public:
+    SoundBankBuilder() = default;
+
+    /// Add a sound
+    /// \param[in]  name  name to look the sound up by, unique in the bank
+    /// \param[in]  mem   sound file data: WAV, FLAC, MP3 or Ogg Vorbis; copied
+    /// \returns whether the data could be decoded and the name is free.
+    auto add(StringView name, MemView<void> mem) -> Bool;
+
+    /// Add a sound from a file
+    /// \param[in]  name  name to look the sound up by, unique in the bank
+    /// \param[in]  path  path to the sound file
+    /// \returns whether the file loaded, could be decoded, and the name is free.
+    auto addFile(StringView name, StringView path) -> Bool;
+
+    /// \returns number of sounds added
+    [[nodiscard]]
+    auto getCount() const -> Int { return static_cast<Int>(m_items.size()); }
+
+    /// Lay out the bank in memory
+    /// \param[out]  outData  receives the bank
+    /// \returns whether the sounds fit the format's limits.
+    auto build(List<Ubyte> *outData) const -> Bool;
+
+    /// Lay out the bank and write it to a file
+    /// \param[in]  path  path of the bank file, overwritten if it exists
+    /// \returns whether the bank was written.
+    auto write(StringView path) const -> Bool;
+
+    /// Remove every sound added
+    auto clear() -> void;
+
+private:
+    struct Item {
+        String name;
+        Uint64 hash;
+        List<Ubyte> data;
+        AudioSpec spec;
+        Int64 frameLength;
+        SoundBankCodec codec;
+        List<AudioMarker> markers;
+    };
+
+    List<Item> m_items{};
+};
+
+KSND_NS_END
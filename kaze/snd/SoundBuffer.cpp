@@ -3,17 +3,19 @@
 
 #include <kaze/core/debug.h>
 #include <kaze/core/io/io.h>
+#include <kaze/core/math/mathf.h>
 #include <kaze/core/memory.h>
 
 KSND_NS_BEGIN
 
-const Int64 BytesPerRead = 1024;
+const Int64 FramesPerRead = 1024;
 
 static auto loadAudio(
     const MemView<void> mem,
     const AudioSpec &targetSpec,
     Ubyte **outBuffer,
-    Size *outByteLength) -> Bool
+    Size *outByteLength,
+    AudioSpec *outSpec) -> Bool
 {
     AudioDecoder decoder{};
     if ( !decoder.openConstMem(mem, targetSpec) )
@@ -21,24 +23,45 @@ static auto loadAudio(
         return False;
     }
 
-    const auto size = decoder.size();
-    const auto outMem = memory::alloc(size);
+    // Length is in frames of the decoder's output, which may have fewer channels than the target
+    const auto frameLength = decoder.getPCMFrameLength();
+    if (frameLength <= 0)
+    {
+        KAZE_PUSH_ERR(Error::RuntimeErr, "Failed to get length of sound to decode");
+        return False;
+    }
 
-    for (Int curPosition = 0; curPosition < size; )
+    const auto bytesPerFrame = static_cast<Int64>(decoder.getSpec().bytesPerFrame());
+    const auto size = frameLength * bytesPerFrame;
+    const auto outMem = (Ubyte *)memory::alloc(size);
+    if ( !outMem )
     {
-        const auto bytesRead = decoder.read((Ubyte *)outMem + curPosition, BytesPerRead);
-        if (bytesRead < 0)
+        return False;
+    }
+
+    Int64 curFrame = 0;
+    while (curFrame < frameLength)
+    {
+        const auto framesRead = decoder.readFrames(outMem + curFrame * bytesPerFrame,
+            mathf::min(FramesPerRead, frameLength - curFrame));
+        if (framesRead < 0)
         {
             memory::free(outMem);
             return False;
         }
 
-        curPosition += bytesRead;
+        if (framesRead == 0) // reported length was longer than the actual data
+            break;
+        curFrame += framesRead;
     }
 
+    // Fill any unread frames with silence
+    if (curFrame < frameLength)
+        memory::set(outMem + curFrame * bytesPerFrame, 0, (frameLength - curFrame) * bytesPerFrame);
+
     if (outBuffer)
     {
-        *outBuffer = (Ubyte *)outMem;
+        *outBuffer = outMem;
     }
     else
     {
@@ -47,6 +70,8 @@ static auto loadAudio(
 
     if (outByteLength)
         *outByteLength = static_cast<Size>(size);
+    if (outSpec)
+        *outSpec = decoder.getSpec();
 
     return True;
 }
@@ -55,13 +80,17 @@ static auto loadAudio(
     const String &filepath, const
     AudioSpec &targetSpec,
     Ubyte **outBuffer,
-    Size *outByteLength) -> Bool
+    Size *outByteLength,
+    AudioSpec *outSpec) -> Bool
 {
     Ubyte *fileData;
     Size fileSize;
     if ( !file::load(filepath, &fileData, &fileSize) )
         return False;
-    return loadAudio({fileData, fileSize}, targetSpec, outBuffer, outByteLength);
+
+    const auto result = loadAudio({fileData, fileSize}, targetSpec, outBuffer, outByteLength, outSpec);
+    memory::free(fileData);
+    return result;
 }
 
 SoundBuffer::SoundBuffer() : m_bufferSize(), m_buffer(), m_spec()
@@ -97,7 +126,7 @@ SoundBuffer &SoundBuffer::operator=(SoundBuffer &&other) noexcept
         // Move other SoundBuffer data over here
         m_spec = other.m_spec;
         m_bufferSize = other.m_bufferSize;
-        other.m_buffer.store(
+        m_buffer.store(
             other.m_buffer.load(std::memory_order_acquire),
             std::memory_order_release);
 
@@ -114,12 +143,13 @@ auto SoundBuffer::load(const String &filepath, const AudioSpec &targetSpec) -> B
 {
     Ubyte *buffer;
     Size byteLength;
-    if (!loadAudio(filepath, targetSpec, &buffer, &byteLength))
+    AudioSpec spec;
+    if (!loadAudio(filepath, targetSpec, &buffer, &byteLength, &spec))
     {
         return false;
     }
 
-    emplace({buffer, byteLength}, targetSpec);
+    emplace({buffer, byteLength}, spec);
     return true;
 }
 
@@ -127,10 +157,11 @@ auto SoundBuffer::load(MemView<void> mem, const AudioSpec &targetSpec) -> Bool
 {
     Ubyte *buffer;
     Size byteLength;
-    if (!loadAudio(mem, targetSpec, &buffer, &byteLength))
+    AudioSpec spec;
+    if (!loadAudio(mem, targetSpec, &buffer, &byteLength, &spec))
         return false;
 
-    emplace({buffer, byteLength}, targetSpec);
+    emplace({buffer, byteLength}, spec);
     return true;
 }
 
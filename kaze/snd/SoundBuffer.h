@@ -6,6 +6,7 @@
 
 KSND_NS_BEGIN
 
+/// Sound data decoded up front into a PCM buffer of a target spec, which can be played directly by `PCMSource`.
 class SoundBuffer {
 public:
     SoundBuffer();
@@ -15,13 +16,15 @@ public:
     SoundBuffer(SoundBuffer &&other) noexcept;
     SoundBuffer &operator=(SoundBuffer &&other) noexcept;
 
-    /// Load sound and convert it to the target specification
+    /// Load sound and convert it to the target specification. Mono and stereo sounds with fewer channels than the
+    /// target keep their own; check `spec` for the result.
     /// \param[in] filepath    path to the sound file
     /// \param[in] targetSpec  the specification to convert this buffer to on load
     /// \returns whether load succeeded.
     auto load(const String &filepath, const AudioSpec &targetSpec) -> Bool;
 
-    /// Load sound and convert it to the target specification
+    /// Load sound and convert it to the target specification. Mono and stereo sounds with fewer channels than the
+    /// target keep their own; check `spec` for the result.
     /// \param[in]  mem        in-memory sound file data
     /// \param[in]  targetSpec the specification to convert this buffer to on load
     /// \returns whether load succeeded.
@@ -32,7 +35,7 @@ public:
 
     /// \returns if sound is currently loaded with data
     [[nodiscard]]
-    auto isLoaded() -> bool  const { return m_buffer.load() != nullptr; }
+    auto isLoaded() const -> Bool { return m_buffer.load() != nullptr; }
 
     /// \returns the size of buffer in bytes
     [[nodiscard]]
@@ -46,6 +49,10 @@ public:
     [[nodiscard]]
     auto data() const -> const Ubyte * { return m_buffer.load(); }
 
+    /// \returns the number of sample frames in the buffer
+    [[nodiscard]]
+    auto frameCount() const -> Size { return m_spec.channels ? m_bufferSize / m_spec.bytesPerFrame() : 0; }
+
     /// \returns spec of the sound buffer data
     [[nodiscard]]
     auto spec() const -> const AudioSpec & { return m_spec; }
@@ -0,0 +1,239 @@
+#include "Spatializer.h"
+#include "AudioContext.h"
+#include "AudioSource.h"
+
+#include <kaze/core/debug.h>
+
+#include <algorithm>
+#include <cmath>
+
+KSND_NS_BEGIN
+
+auto Spatializer::prepare(const Int maxEmitters, const Int sampleRate) -> void
+{
+    const auto slots = static_cast<Size>(std::max(maxEmitters, 0));
+    m_emitters.assign(slots, Emitter{});
+    m_owners.assign(slots, Handle<AudioSource>{});
+    m_freeSlots.resize(slots);
+    for (Size i = 0; i < slots; ++i)
+        m_freeSlots[i] = static_cast<Int>(slots - 1 - i);
+    m_releasedSlots.clear();
+    m_assignments.clear();
+    m_emitterCount = 0;
+
+    for (auto &snapshot : m_snapshots)
+    {
+        for (auto list : {&snapshot.x, &snapshot.y, &snapshot.velocityX, &snapshot.velocityY, &snapshot.radius,
+            &snapshot.squared, &snapshot.inner, &snapshot.outer, &snapshot.rolloff, &snapshot.offset, &snapshot.slope})
+        {
+            list->assign(slots, 0);
+        }
+
+        snapshot.count = 0;
+        snapshot.clock = 0;
+    }
+
+    m_writeIndex = 0;
+    m_latest.store(1, std::memory_order_relaxed);
+    m_readIndex = 2;
+
+    m_left.assign(slots, 0);
+    m_right.assign(slots, 0);
+    m_previousLeft.assign(slots, 0);
+    m_previousRight.assign(slots, 0);
+    m_fresh.clear();
+    m_fresh.reserve(slots);
+    m_sampleRate = std::max(sampleRate, 1);
+}
+
+auto Spatializer::setEmitter(const Handle<AudioSource> &source, const Emitter &emitter) -> Bool
+{
+    if ( !source.isValid() )
+    {
+        KAZE_PUSH_ERR(Error::InvalidHandle, "Spatializer::setEmitter was passed an invalid source");
+        return False;
+    }
+
+    auto slot = source->m_emitter;
+    if (slot < 0)
+    {
+        if (m_freeSlots.empty())
+        {
+            KAZE_PUSH_ERR(Error::OutOfRange, "All {} emitter slots are taken, see `AudioEngineInit::maxEmitters`",
+                m_owners.size());
+            return False;
+        }
+
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        m_owners[slot] = source;
+        source->m_emitter = slot;
+        m_assignments.emplace_back(source, slot);
+        ++m_emitterCount;
+    }
+
+    m_emitters[slot] = emitter;
+    return True;
+}
+
+auto Spatializer::removeEmitter(const Handle<AudioSource> &source) -> void
+{
+    if ( !source.isValid() || source->m_emitter < 0 )
+        return;
+
+    freeSlot(source->m_emitter);
+    source->m_emitter = -1;
+    m_assignments.emplace_back(source, -1);
+}
+
+auto Spatializer::freeSlot(const Int slot) -> void
+{
+    m_owners[slot] = {};
+    m_releasedSlots.emplace_back(slot);
+    --m_emitterCount;
+}
+
+auto Spatializer::publish(AudioContext *context) -> void
+{
+    // Sources released since the last publish left the graph without removing their emitters
+    Int64 count = 0;
+    for (Size slot = 0; slot < m_owners.size(); ++slot)
+    {
+        if ( !m_owners[slot] )
+            continue;
+
+        if ( !m_owners[slot].isValid() )
+            freeSlot(static_cast<Int>(slot));
+        else
+            count = static_cast<Int64>(slot) + 1;
+    }
+
+    // Fill the free snapshot. Free slots below the highest taken keep their last emitter, which is never mixed.
+    auto &snapshot = m_snapshots[m_writeIndex];
+    for (Int64 i = 0; i < count; ++i)
+    {
+        const auto &emitter = m_emitters[i];
+        const auto minDistance = std::max(emitter.minDistance, 1e-3f);
+        const auto maxDistance = std::max(emitter.maxDistance, minDistance);
+
+        snapshot.x[i] = emitter.position.x;
+        snapshot.y[i] = emitter.position.y;
+        snapshot.velocityX[i] = emitter.velocity.x;
+        snapshot.velocityY[i] = emitter.velocity.y;
+        snapshot.radius[i] = minDistance;
+        snapshot.inner[i] = minDistance;
+        snapshot.outer[i] = maxDistance;
+        snapshot.squared[i] = 0;
+
+        // Each curve as `1 - rolloff * over / (offset + slope * over)`, with `over` the distance past the minimum
+        switch (emitter.curve)
+        {
+        case AttenuationCurve::Linear:
+            snapshot.rolloff[i] = 1.f;
+            snapshot.offset[i] = std::max(maxDistance - minDistance, 1e-6f);
+            snapshot.slope[i] = 0;
+            break;
+        case AttenuationCurve::Inverse:
+            snapshot.rolloff[i] = emitter.rolloff;
+            snapshot.offset[i] = minDistance;
+            snapshot.slope[i] = emitter.rolloff;
+            break;
+        case AttenuationCurve::InverseSquare:
+            snapshot.squared[i] = 1.f;
+            snapshot.inner[i] = minDistance * minDistance;
+            snapshot.outer[i] = maxDistance * maxDistance;
+            snapshot.rolloff[i] = emitter.rolloff;
+            snapshot.offset[i] = minDistance * minDistance;
+            snapshot.slope[i] = emitter.rolloff;
+            break;
+        default:
+            snapshot.rolloff[i] = 0;
+            snapshot.offset[i] = 1.f;
+            snapshot.slope[i] = 0;
+            break;
+        }
+    }
+
+    snapshot.count = count;
+    snapshot.listener = {
+        .x = m_listener.position.x,
+        .y = m_listener.position.y,
+        .rightX = std::cos(m_listener.rotation),
+        .rightY = std::sin(m_listener.rotation),
+        .time = 0,
+    };
+    snapshot.listenerVelocity = m_listener.velocity;
+    snapshot.clock = context->getClock();
+    m_writeIndex = m_latest.exchange(m_writeIndex | FreshBit, std::memory_order_acq_rel) & ~FreshBit;
+
+    // Sources switch slots only now, so that the snapshot they find holds their emitter
+    for (const auto &[source, slot] : m_assignments)
+    {
+        if (source.isValid())
+            context->pushCommand(commands::SourceSetEmitter {
+                .source = source.get(),
+                .slot = slot,
+            });
+    }
+    m_assignments.clear();
+
+    if ( !m_releasedSlots.empty() )
+    {
+        m_freeSlots.insert(m_freeSlots.end(), m_releasedSlots.begin(), m_releasedSlots.end());
+        std::sort(m_freeSlots.begin(), m_freeSlots.end(), std::greater{});
+        m_releasedSlots.clear();
+    }
+}
+
+auto Spatializer::beginCallback(const Uint64 clock, const Int64 frames) -> void
+{
+    if (m_latest.load(std::memory_order_relaxed) & FreshBit)
+        m_readIndex = m_latest.exchange(m_readIndex, std::memory_order_acq_rel) & ~FreshBit;
+
+    // This callback ramps from the gains of the last one
+    std::swap(m_left, m_previousLeft);
+    std::swap(m_right, m_previousRight);
+
+    const auto &snapshot = m_snapshots[m_readIndex];
+    if (snapshot.count > 0)
+    {
+        const auto elapsed = static_cast<Int64>(clock) + frames - static_cast<Int64>(snapshot.clock);
+        const auto time = std::clamp(static_cast<Float>(static_cast<Double>(elapsed) / m_sampleRate), 0.f,
+            MaxExtrapolation);
+
+        auto listener = snapshot.listener;
+        listener.x += snapshot.listenerVelocity.x * time;
+        listener.y += snapshot.listenerVelocity.y * time;
+        listener.time = time;
+
+        dsp::getKernels().spatialize({
+            .x = snapshot.x.data(),
+            .y = snapshot.y.data(),
+            .velocityX = snapshot.velocityX.data(),
+            .velocityY = snapshot.velocityY.data(),
+            .radius = snapshot.radius.data(),
+            .squared = snapshot.squared.data(),
+            .inner = snapshot.inner.data(),
+            .outer = snapshot.outer.data(),
+            .rolloff = snapshot.rolloff.data(),
+            .offset = snapshot.offset.data(),
+            .slope = snapshot.slope.data(),
+            .count = snapshot.count,
+        }, listener, m_left.data(), m_right.data());
+    }
+
+    for (const auto slot : m_fresh)
+    {
+        m_previousLeft[slot] = m_left[slot];
+        m_previousRight[slot] = m_right[slot];
+    }
+    m_fresh.clear();
+}
+
+auto Spatializer::markFresh(const Int slot) -> void
+{
+    if (m_fresh.size() < m_fresh.capacity())
+        m_fresh.emplace_back(slot);
+}
+
+KSND_NS_END
@@ -0,0 +1,156 @@
+/// \file Spatializer.h
+/// Batched 2D positioning of sources around a listener
+#pragma once
+#include <kaze/snd/lib.h>
+#include <kaze/snd/dsp/kernels.h>
+
+#include <kaze/core/AlignedList.h>
+#include <kaze/core/Handle.h>
+#include <kaze/core/math/Vec/Vec2.h>
+
+#include <atomic>
+
+KSND_NS_BEGIN
+
+class AudioContext;
+class AudioSource;
+
+/// How an emitter's gain falls off between its minimum and maximum distance
+enum class AttenuationCurve : Ubyte {
+    None,          ///< full gain at any distance, panned only
+    Linear,        ///< falls in a straight line to silence at the maximum distance
+    Inverse,       ///< `minDistance / (minDistance + rolloff * (distance - minDistance))`, as in OpenAL
+    InverseSquare, ///< inverse of the squared distance, falling off sharply like a point source in free field
+    Count          ///< number of attenuation curves
+};
+
+/// Point of view that emitters are panned and attenuated around
+struct Listener {
+    Vec2f position{};
+    Vec2f velocity{};  ///< units per second, to extrapolate the position between updates
+    Float rotation{};  ///< radians counterclockwise; at `0` the listener's right points along +x
+};
+
+/// Position and attenuation of a sound source in the 2D scene
+struct Emitter {
+    Vec2f position{};
+    Vec2f velocity{};          ///< units per second, to extrapolate the position between updates
+    Float minDistance = 1.f;   ///< distance within which the gain stays at its loudest, also the radius within
+                               ///< which the pan narrows toward the center
+    Float maxDistance = 100.f; ///< distance beyond which the gain stops falling
+    Float rolloff = 1.f;       ///< steepness of the `Inverse` and `InverseSquare` curves
+    AttenuationCurve curve = AttenuationCurve::Inverse;
+};
+
+/// Pans and attenuates every positioned source in one pass per audio callback.
+///
+/// The owning thread stages the listener and emitters, and publishes them all at once during `AudioEngine::update`
+/// through a lock-free triple buffer, in place of a command per source. At the start of each callback the audio
+/// thread takes the newest snapshot, moves every emitter along its velocity to the end of the buffer, and runs
+/// `dsp::Kernels::spatialize` over the structure-of-arrays snapshot. Buses then ramp each source from the gains of
+/// the previous callback to these, so that movement never clicks.
+class Spatializer {
+public:
+    /// Default number of emitter slots
+    static constexpr Int DefaultMaxEmitters = 1024;
+
+    /// Per-sample gain ramp of a source across the current callback
+    struct Gains {
+        Float fromLeft, fromRight; ///< at the start of the buffer
+        Float toLeft, toRight;     ///< at its end
+    };
+
+    Spatializer() = default;
+
+    KAZE_NO_COPY(Spatializer);
+
+    /// Size every slot list and clear all emitters. Only while the audio thread is not running.
+    /// \param[in]  maxEmitters  number of emitter slots
+    /// \param[in]  sampleRate   sample rate in Hz
+    auto prepare(Int maxEmitters, Int sampleRate) -> void;
+
+    // ----- Owning thread ----------------------------------------------------
+
+    /// Set the listener, published on the next `publish`
+    auto setListener(const Listener &listener) -> void { m_listener = listener; }
+
+    [[nodiscard]]
+    auto getListener() const -> const Listener & { return m_listener; }
+
+    /// Position a source, taking an emitter slot on first use. Published on the next `publish`.
+    /// \param[in]  source   source to position, mixed by buses of two or more channels
+    /// \param[in]  emitter  position and attenuation
+    /// \returns whether the source is positioned, `False` if every slot is taken.
+    auto setEmitter(const Handle<AudioSource> &source, const Emitter &emitter) -> Bool;
+
+    /// Stop positioning a source, freeing its slot. Published on the next `publish`.
+    auto removeEmitter(const Handle<AudioSource> &source) -> void;
+
+    /// \returns the number of sources positioned
+    [[nodiscard]]
+    auto getEmitterCount() const -> Int { return m_emitterCount; }
+
+    /// Publish the listener and every emitter to the audio thread, and free the slots of released sources.
+    /// \param[in]  context  context to send slot changes through
+    auto publish(AudioContext *context) -> void;
+
+    // ----- Audio thread -----------------------------------------------------
+
+    /// Take the newest snapshot and compute the gains of every emitter at the end of this callback's buffer.
+    /// Before rendering, after commands were processed.
+    /// \param[in]  clock   clock at the start of the buffer
+    /// \param[in]  frames  number of frames in the buffer
+    auto beginCallback(Uint64 clock, Int64 frames) -> void;
+
+    /// Let a slot that was just given to a source start at its target gains instead of ramping from those of its
+    /// previous owner. Run by the command that assigns the slot.
+    auto markFresh(Int slot) -> void;
+
+    /// \returns the gain ramp of a slot across the current callback. Any thread rendering this callback.
+    [[nodiscard]]
+    auto getGains(const Int slot) const -> Gains
+    {
+        return {m_previousLeft[slot], m_previousRight[slot], m_left[slot], m_right[slot]};
+    }
+
+private:
+    /// Structure-of-arrays copy of the scene, see `dsp::SpatialEmitters`
+    struct Snapshot {
+        AlignedList<Float, 16> x, y, velocityX, velocityY, radius, squared, inner, outer, rolloff, offset, slope;
+        Int64 count{};                      ///< emitters up to the highest slot taken
+        dsp::SpatialListener listener{};    ///< at the publishing clock
+        Vec2f listenerVelocity{};
+        Uint64 clock{};                     ///< context clock when published
+    };
+
+    static constexpr Uint FreshBit = 4u; ///< set in `m_latest` while the snapshot there has not been taken
+
+    /// Longest an emitter is moved along its velocity, in seconds, should updates stall
+    static constexpr Float MaxExtrapolation = .25f;
+
+    /// Give a slot back to the free list on the next publish. Owning thread.
+    auto freeSlot(Int slot) -> void;
+
+    // Owning thread
+    List<Emitter> m_emitters{};
+    List< Handle<AudioSource> > m_owners{}; ///< per slot, invalid while free
+    List<Int> m_freeSlots{};                ///< popped from the back, lowest slot last
+    List<Int> m_releasedSlots{};            ///< freed since the last publish, reusable after it
+    struct Assignment { Handle<AudioSource> source; Int slot; };
+    List<Assignment> m_assignments{};       ///< slot changes to send on the next publish, `-1` to remove
+    Listener m_listener{};
+    Int m_emitterCount{};
+    Uint m_writeIndex{0};
+
+    // Shared
+    Snapshot m_snapshots[3]{};
+    std::atomic<Uint> m_latest{1};
+
+    // Audio thread
+    Uint m_readIndex{2};
+    AlignedList<Float, 16> m_left{}, m_right{}, m_previousLeft{}, m_previousRight{};
+    List<Int> m_fresh{};
+    Int m_sampleRate{};
+};
+
+KSND_NS_END
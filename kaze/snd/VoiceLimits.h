@@ -0,0 +1,21 @@
+#pragma once
+#include <kaze/snd/lib.h>
+
+KSND_NS_BEGIN
+
+/// Which voice to take over when a voice limit is reached
+enum class VoiceSteal {
+    None,           ///< never steal, the new voice starts virtual
+    Oldest,         ///< virtualize the voice that started first
+    Quietest,       ///< virtualize the voice with the lowest gain (volume times fade)
+    LowestPriority, ///< virtualize the voice with the lowest priority, the oldest on ties
+};
+
+/// Voice counters reported by `AudioEngine::getVoiceStats`
+struct VoiceStats {
+    Int active;      ///< voices being decoded and mixed
+    Int virtualized; ///< voices whose clock advances without being decoded or mixed
+    Uint64 stolen;   ///< times a voice was virtualized to make room for another, cumulative
+};
+
+KSND_NS_END
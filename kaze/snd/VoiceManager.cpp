@@ -0,0 +1,191 @@
+#include "VoiceManager.h"
+#include "AudioContext.h"
+#include "AudioSource.h"
+#include "Sound.h"
+
+#include <algorithm>
+
+KSND_NS_BEGIN
+
+auto VoiceManager::add(const Handle<AudioSource> &source, const Handle<Sound> &sound) -> void
+{
+    const auto hasSound = sound.isValid();
+    Voice voice {
+        .source = source,
+        .sound = sound,
+        .priority = hasSound ? sound->getPriority() : 0,
+        .isVirtual = False,
+    };
+
+    // Check the sound's own limit first, since taking over one of its voices frees a global slot as well
+    if (hasSound && sound->getMaxVoices() > 0 && countReal(sound) >= sound->getMaxVoices())
+    {
+        if (const auto victim = findVictim(sound, voice.priority, sound->getStealPolicy()))
+        {
+            setVirtual(*victim, True);
+            ++m_stolen;
+        }
+        else
+        {
+            voice.isVirtual = True;
+        }
+    }
+
+    if ( !voice.isVirtual && m_maxVoices > 0 && countReal() >= m_maxVoices)
+    {
+        if (const auto victim = findVictim({}, voice.priority, m_policy))
+        {
+            setVirtual(*victim, True);
+            ++m_stolen;
+        }
+        else
+        {
+            voice.isVirtual = True;
+        }
+    }
+
+    if (voice.isVirtual)
+        setVirtual(voice, True);
+
+    m_voices.emplace_back(voice);
+}
+
+auto VoiceManager::update() -> void
+{
+    std::erase_if(m_voices, [](const Voice &voice) {
+        return !voice.source.isValid() || voice.source->shouldDiscard();
+    });
+
+    // Voices are kept in start order, so a stable sort by priority promotes the oldest voice first on ties
+    m_promotions.clear();
+    for (auto &voice : m_voices)
+    {
+        if (voice.isVirtual)
+            m_promotions.emplace_back(&voice);
+    }
+
+    if (m_promotions.empty())
+        return;
+
+    std::stable_sort(m_promotions.begin(), m_promotions.end(), [](const Voice *a, const Voice *b) {
+        return a->priority > b->priority;
+    });
+
+    auto realCount = countReal();
+    for (const auto voice : m_promotions)
+    {
+        if (m_maxVoices > 0 && realCount >= m_maxVoices)
+            break;
+
+        if (voice->sound.isValid() && voice->sound->getMaxVoices() > 0 &&
+            countReal(voice->sound) >= voice->sound->getMaxVoices())
+        {
+            continue;
+        }
+
+        setVirtual(*voice, False);
+        ++realCount;
+    }
+}
+
+auto VoiceManager::clear() -> void
+{
+    m_voices.clear();
+    m_promotions.clear();
+}
+
+auto VoiceManager::isVirtual(const Handle<AudioSource> &source) const -> Bool
+{
+    for (const auto &voice : m_voices)
+    {
+        if (voice.source == source)
+            return voice.isVirtual;
+    }
+
+    return False;
+}
+
+auto VoiceManager::getStats() const -> VoiceStats
+{
+    const auto active = countReal();
+    return {
+        .active = active,
+        .virtualized = static_cast<Int>(m_voices.size()) - active,
+        .stolen = m_stolen,
+    };
+}
+
+auto VoiceManager::countReal(const Handle<Sound> &sound) const -> Int
+{
+    Int count = 0;
+    for (const auto &voice : m_voices)
+    {
+        if ( !voice.isVirtual && (!sound || voice.sound == sound) )
+            ++count;
+    }
+
+    return count;
+}
+
+auto VoiceManager::findVictim(const Handle<Sound> &sound, const Int priority, const VoiceSteal policy) -> Voice *
+{
+    if (policy == VoiceSteal::None)
+        return Null;
+
+    Voice *victim = Null;
+    Float victimGain = 0;
+    for (auto &voice : m_voices)
+    {
+        if (voice.isVirtual || voice.priority > priority || (sound && voice.sound != sound))
+            continue;
+
+        // Voices ended on the audio thread, but not yet released, make the best victims
+        if ( !voice.source.isValid() || voice.source->shouldDiscard() )
+            return &voice;
+
+        const auto gain = voice.source->getGain();
+        if ( !victim )
+        {
+            victim = &voice;
+            victimGain = gain;
+            continue;
+        }
+
+        // `m_voices` is in start order, so only replace the current pick on a strictly better match
+        switch (policy)
+        {
+        case VoiceSteal::Quietest:
+            if (gain < victimGain)
+            {
+                victim = &voice;
+                victimGain = gain;
+            }
+            break;
+        case VoiceSteal::LowestPriority:
+            if (voice.priority < victim->priority)
+            {
+                victim = &voice;
+                victimGain = gain;
+            }
+            break;
+        default: // VoiceSteal::Oldest
+            break;
+        }
+    }
+
+    return victim;
+}
+
+auto VoiceManager::setVirtual(Voice &voice, const Bool isVirtual) -> void
+{
+    voice.isVirtual = isVirtual;
+    if ( !voice.source.isValid() )
+        return;
+
+    m_context->pushCommand(commands::SourceSetVirtual {
+        .source = voice.source.get(),
+        .isVirtual = isVirtual,
+    });
+}
+
+KSND_NS_END
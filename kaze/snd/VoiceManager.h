@@ -0,0 +1,83 @@
+#pragma once
+#include <kaze/snd/lib.h>
+#include <kaze/snd/VoiceLimits.h>
+
+#include <kaze/core/Handle.h>
+
+KSND_NS_BEGIN
+
+class AudioContext;
+class AudioSource;
+class Sound;
+
+/// Keeps the number of real voices within the engine's global and each Sound's own limit.
+///
+/// A voice over its limit is virtualized instead of stopped: it keeps its place in time but skips decoding,
+/// effects and mixing, then becomes real again once a slot frees up. A new voice only takes over a slot from a
+/// voice of equal or lower priority; otherwise it starts virtual. Lives on the engine's owning thread.
+class VoiceManager {
+public:
+    explicit VoiceManager(AudioContext *context) : m_context(context) { }
+
+    /// \param[in]  maxVoices  maximum number of real voices across all sounds; `0` for no limit
+    auto setMaxVoices(Int maxVoices) -> void { m_maxVoices = maxVoices; }
+
+    [[nodiscard]]
+    auto getMaxVoices() const -> Int { return m_maxVoices; }
+
+    /// \param[in]  policy  which voice to take over when the global limit is reached
+    auto setStealPolicy(VoiceSteal policy) -> void { m_policy = policy; }
+
+    [[nodiscard]]
+    auto getStealPolicy() const -> VoiceSteal { return m_policy; }
+
+    /// Track a voice that was just instantiated from `sound`, making room for it or virtualizing it if its
+    /// limits are full. Call before the next audio callback, so that a virtual voice is never heard.
+    /// \param[in]  source  new voice
+    /// \param[in]  sound   sound the voice was instantiated from
+    auto add(const Handle<AudioSource> &source, const Handle<Sound> &sound) -> void;
+
+    /// Forget released voices and make virtual voices real where slots have freed up
+    auto update() -> void;
+
+    /// Forget every voice, e.g. when the engine closes
+    auto clear() -> void;
+
+    /// \returns whether `source` is a tracked voice that is currently virtual
+    [[nodiscard]]
+    auto isVirtual(const Handle<AudioSource> &source) const -> Bool;
+
+    [[nodiscard]]
+    auto getStats() const -> VoiceStats;
+
+private:
+    struct Voice {
+        Handle<AudioSource> source;
+        Handle<Sound> sound;
+        Int priority;
+        Bool isVirtual;
+    };
+
+    /// \returns number of real voices, only counting voices of `sound` if provided
+    [[nodiscard]]
+    auto countReal(const Handle<Sound> &sound = {}) const -> Int;
+
+    /// Pick a real voice to virtualize in favor of a voice with `priority`
+    /// \param[in]  sound     only consider voices of this sound, or every voice if null
+    /// \param[in]  priority  priority of the voice that needs the slot
+    /// \param[in]  policy    which voice to prefer
+    /// \returns the voice to steal, or null if none may be stolen
+    [[nodiscard]]
+    auto findVictim(const Handle<Sound> &sound, Int priority, VoiceSteal policy) -> Voice *;
+
+    auto setVirtual(Voice &voice, Bool isVirtual) -> void;
+
+    AudioContext *m_context;
+    List<Voice> m_voices{};
+    List<Voice *> m_promotions{}; ///< scratch list of virtual voices, reused by `update`
+    Int m_maxVoices{};
+    VoiceSteal m_policy{VoiceSteal::LowestPriority};
+    Uint64 m_stolen{};
+};
+
+KSND_NS_END
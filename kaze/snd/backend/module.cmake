@@ -1,5 +1,11 @@
 set(KAZE_MODULE KSND_BACKEND)
 
+# Available on every platform
+list(APPEND KSND_BACKEND_SOURCES_PRIVATE
+    offline/OfflineAudioDevice.cpp
+    offline/OfflineAudioDevice.h
+)
+
 if (KAZE_PLATFORM_IOS) # ===== iOS ============================================
 
     list(APPEND KSND_BACKEND_SOURCES_PRIVATE
@@ -0,0 +1,330 @@
+#include "OfflineAudioDevice.h"
+
+#include <kaze/core/debug.h>
+#include <kaze/core/endian.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+KSND_NS_BEGIN
+
+/// Size of the canonical .wav header written before the sample data
+static constexpr Uint WavHeaderSize = 44;
+
+struct OfflineAudioDevice::Impl {
+    using Clock = std::chrono::steady_clock;
+
+    explicit Impl(const OfflineClock clockType, const Int sampleRate) :
+        clockType(clockType), defaultSampleRate(sampleRate)
+    { }
+
+    OfflineClock clockType;
+    Int defaultSampleRate;
+
+    AudioSpec spec{};
+    AlignedList<Uint8, 16> buffer{};
+    AudioCallback callback{};
+    AudioRenderCallback renderCallback{};
+    void *userdata{};
+    Bool isOpen{};
+    std::atomic<Bool> isRunning{};
+    std::thread thread{};
+    AudioLatencyMonitor monitor{};
+
+    // Guards the recording and stats, which the render thread updates with `OfflineClock::Realtime`
+    mutable std::mutex mutex{};
+    std::ofstream wav{};
+    Uint64 wavBytes{};
+    OfflineRenderStats stats{};
+
+    /// Run the audio callback once, then time and record its output
+    auto renderBuffer() -> void
+    {
+        // Take up a new adaptive period between buffers, within the memory reserved on open
+        if (monitor.hasPendingPeriod())
+        {
+            const auto frames = monitor.getPeriodFrames();
+            buffer.resize(static_cast<Size>(frames) * spec.bytesPerFrame());
+            monitor.applyPeriod(frames);
+        }
+
+        // Like hardware, render straight into the device's own memory when the engine can
+        const auto start = Clock::now();
+        if (renderCallback)
+            renderCallback(userdata, buffer.data(), static_cast<Int64>(buffer.size()));
+        else
+            callback(userdata, &buffer);
+        const auto ns = std::chrono::duration<Double, std::nano>(Clock::now() - start).count();
+        monitor.record(static_cast<Int64>(ns), static_cast<Int64>(buffer.size() / spec.bytesPerFrame()), False);
+
+        auto lockGuard = std::lock_guard(mutex);
+        stats.frames += buffer.size() / spec.bytesPerFrame();
+        ++stats.callbacks;
+        stats.renderNs += ns;
+        stats.worstNs = std::max(stats.worstNs, ns);
+
+        if (wav.is_open())
+            writeSamples();
+    }
+
+    /// Append the current buffer to the .wav file, which stores samples in little endian
+    auto writeSamples() -> void
+    {
+        if constexpr (Endian::isBig())
+        {
+            const auto samples = reinterpret_cast<const Float *>(buffer.data());
+            for (Size i = 0, count = buffer.size() / sizeof(Float); i < count; ++i)
+            {
+                const auto sample = Endian::swap(samples[i]);
+                wav.write(reinterpret_cast<const char *>(&sample), sizeof(Float));
+            }
+        }
+        else
+        {
+            wav.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        }
+
+        wavBytes += buffer.size();
+    }
+
+    /// Write the .wav header, with chunk sizes covering `wavBytes` of sample data
+    auto writeHeader() -> void
+    {
+        const auto write = [this](const Uint value, const Int bytes) {
+            for (Int i = 0; i < bytes; ++i)
+                wav.put(static_cast<char>(value >> (i * 8)));
+        };
+        const auto dataSize = static_cast<Uint>(std::min<Uint64>(wavBytes, UINT32_MAX - WavHeaderSize));
+        const auto bytesPerFrame = static_cast<Uint>(spec.bytesPerFrame());
+
+        wav.seekp(0);
+        wav.write("RIFF", 4); write(WavHeaderSize - 8 + dataSize, 4); wav.write("WAVE", 4);
+        wav.write("fmt ", 4); write(16, 4);
+        write(3, 2); // IEEE float
+        write(spec.channels, 2);
+        write(spec.freq, 4);
+        write(spec.freq * bytesPerFrame, 4);
+        write(bytesPerFrame, 2);
+        write(sizeof(Float) * CHAR_BIT, 2);
+        wav.write("data", 4); write(dataSize, 4);
+        wav.seekp(0, std::ios::end);
+    }
+
+    auto closeRecording() -> void
+    {
+        if ( !wav.is_open() )
+            return;
+
+        writeHeader();
+        wav.close();
+        wavBytes = 0;
+    }
+
+    /// Render on the device's own thread, pacing callbacks by the buffer period
+    auto runRealtime() -> void
+    {
+        auto next = Clock::now();
+        while (isRunning.load(std::memory_order_acquire))
+        {
+            renderBuffer();
+
+            // The period may change with each buffer in adaptive mode
+            const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<Double>(
+                static_cast<Double>(buffer.size() / spec.bytesPerFrame()) / spec.freq));
+
+            // Skip ahead instead of rushing to catch up after a stall, as a hardware device would drop buffers
+            next += period;
+            if (const auto now = Clock::now(); now > next + period)
+                next = now;
+            std::this_thread::sleep_until(next);
+        }
+    }
+};
+
+OfflineAudioDevice::OfflineAudioDevice(const OfflineClock clock, const Int sampleRate) :
+    m(new Impl(clock, sampleRate))
+{ }
+
+OfflineAudioDevice::~OfflineAudioDevice()
+{
+    close();
+    delete m;
+}
+
+auto OfflineAudioDevice::open(const AudioDeviceOpen &config) -> Bool
+{
+    if (config.frameBufferSize <= 0)
+    {
+        KAZE_PUSH_ERR(Error::InvalidArgErr, "OfflineAudioDevice requires a positive frame buffer size");
+        return False;
+    }
+
+    if ( !config.audioCallback )
+    {
+        KAZE_PUSH_ERR(Error::NullArgErr, "OfflineAudioDevice requires an audio callback");
+        return False;
+    }
+
+    close();
+
+    m->spec = AudioSpec(config.frequency > 0 ? config.frequency : m->defaultSampleRate,
+        config.channels > 0 ? config.channels : 2,
+        SampleFormat(sizeof(Float) * CHAR_BIT, true, Endian::isBig(), true));
+    m->monitor.prepare(config.frameBufferSize, config.minFrameBufferSize, config.maxFrameBufferSize,
+        m->spec.freq, False);
+    m->buffer.reserve(static_cast<Size>(m->monitor.getMaxPeriodFrames()) * m->spec.bytesPerFrame());
+    m->buffer.assign(static_cast<Size>(m->monitor.getPeriodFrames()) * m->spec.bytesPerFrame(), 0);
+    m->callback = config.audioCallback;
+    m->renderCallback = config.renderCallback;
+    m->userdata = config.userdata;
+    m->stats = {};
+    m->isOpen = True;
+    return True;
+}
+
+auto OfflineAudioDevice::close() -> void
+{
+    if ( !m->isOpen )
+        return;
+
+    suspend();
+
+    auto lockGuard = std::lock_guard(m->mutex);
+    m->closeRecording();
+    m->isOpen = False;
+}
+
+auto OfflineAudioDevice::suspend() -> void
+{
+    m->isRunning.store(False, std::memory_order_release);
+    if (m->thread.joinable())
+        m->thread.join();
+}
+
+auto OfflineAudioDevice::resume() -> void
+{
+    if ( !m->isOpen || m->isRunning.load(std::memory_order_acquire) )
+        return;
+
+    m->isRunning.store(True, std::memory_order_release);
+    if (m->clockType == OfflineClock::Realtime)
+        m->thread = std::thread([this]() { m->runRealtime(); });
+}
+
+auto OfflineAudioDevice::isOpen() const -> Bool
+{
+    return m->isOpen;
+}
+
+auto OfflineAudioDevice::isRunning() const -> Bool
+{
+    return m->isRunning.load(std::memory_order_acquire);
+}
+
+auto OfflineAudioDevice::getId() const -> Uint
+{
+    return 0;
+}
+
+auto OfflineAudioDevice::getSpec() const -> const AudioSpec &
+{
+    return m->spec;
+}
+
+auto OfflineAudioDevice::getBufferSize() const -> Int
+{
+    return static_cast<Int>(m->buffer.size());
+}
+
+auto OfflineAudioDevice::getMaxBufferSize() const -> Int
+{
+    return static_cast<Int>(std::max<Size>(m->buffer.size(),
+        static_cast<Size>(m->monitor.getMaxPeriodFrames()) * m->spec.bytesPerFrame()));
+}
+
+auto OfflineAudioDevice::getLatencyMonitor() -> AudioLatencyMonitor *
+{
+    return &m->monitor;
+}
+
+auto OfflineAudioDevice::getDefaultSampleRate() const -> Int
+{
+    return m->defaultSampleRate;
+}
+
+auto OfflineAudioDevice::getClockType() const -> OfflineClock
+{
+    return m->clockType;
+}
+
+auto OfflineAudioDevice::render(const Int64 frames) -> Int64
+{
+    if (m->clockType != OfflineClock::Manual)
+    {
+        KAZE_PUSH_ERR(Error::LogicErr, "OfflineAudioDevice::render requires OfflineClock::Manual");
+        return 0;
+    }
+
+    if ( !m->isRunning.load(std::memory_order_acquire) )
+        return 0;
+
+    Int64 rendered = 0;
+    while (rendered < frames)
+    {
+        m->renderBuffer();
+        rendered += static_cast<Int64>(m->buffer.size() / m->spec.bytesPerFrame());
+    }
+
+    return rendered;
+}
+
+auto OfflineAudioDevice::getBuffer() const -> const AlignedList<Uint8, 16> &
+{
+    return m->buffer;
+}
+
+auto OfflineAudioDevice::startRecording(const StringView path) -> Bool
+{
+    if ( !m->isOpen )
+    {
+        KAZE_PUSH_ERR(Error::LogicErr, "OfflineAudioDevice must be open to record");
+        return False;
+    }
+
+    auto lockGuard = std::lock_guard(m->mutex);
+    m->closeRecording();
+
+    m->wav.open(String(path), std::ios::binary | std::ios::out | std::ios::trunc);
+    if ( !m->wav.is_open() )
+    {
+        KAZE_PUSH_ERR(Error::FileOpenErr, "Failed to open file for recording: {}", path);
+        return False;
+    }
+
+    m->writeHeader();
+    return True;
+}
+
+auto OfflineAudioDevice::stopRecording() -> void
+{
+    auto lockGuard = std::lock_guard(m->mutex);
+    m->closeRecording();
+}
+
+auto OfflineAudioDevice::isRecording() const -> Bool
+{
+    auto lockGuard = std::lock_guard(m->mutex);
+    return m->wav.is_open();
+}
+
+auto OfflineAudioDevice::getStats() const -> OfflineRenderStats
+{
+    auto lockGuard = std::lock_guard(m->mutex);
+    return m->stats;
+}
+
+KSND_NS_END
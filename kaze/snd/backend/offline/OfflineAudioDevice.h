@@ -0,0 +1,87 @@
+#pragma once
+#include <kaze/snd/AudioDevice.h>
+#include <kaze/snd/lib.h>
+
+KSND_NS_BEGIN
+
+/// How an `OfflineAudioDevice` drives the audio callback
+enum class OfflineClock {
+    Manual,   ///< renders only on calls to `render`, on the calling thread, as fast as the CPU allows
+    Realtime, ///< renders on its own thread while running, one buffer per buffer period, like a hardware device
+};
+
+/// Render counters of an `OfflineAudioDevice`, cumulative since the device was opened
+struct OfflineRenderStats {
+    Uint64 frames;    ///< frames rendered
+    Uint64 callbacks; ///< audio callbacks made
+    Double renderNs;  ///< time spent inside the audio callback
+    Double worstNs;   ///< longest single callback
+
+    /// \returns frames rendered per second of callback time, i.e. how many times faster than realtime the
+    ///          mixer runs when divided by the sample rate; `0` if nothing was rendered yet
+    [[nodiscard]]
+    auto getFramesPerSecond() const -> Double { return renderNs > 0 ? frames * 1e9 / renderNs : 0; }
+};
+
+/// Audio device without hardware behind it, for headless runs, benchmarks, and bouncing a mix to disk.
+///
+/// Output is 32-bit float with the requested number of channels, stereo by default, and can be recorded to a .wav
+/// file while rendering.
+class OfflineAudioDevice final : public AudioDevice {
+public:
+    /// \param[in]  clock       how the audio callback is driven
+    /// \param[in]  sampleRate  rate used when the device is opened without one
+    explicit OfflineAudioDevice(OfflineClock clock = OfflineClock::Manual, Int sampleRate = 48000);
+    ~OfflineAudioDevice() override;
+
+    auto open(const AudioDeviceOpen &config) -> Bool override;
+    auto close() -> void override;
+    auto suspend() -> void override;
+    auto resume() -> void override;
+
+    [[nodiscard]] auto isOpen() const -> Bool override;
+    [[nodiscard]] auto isRunning() const -> Bool override;
+    [[nodiscard]] auto getId() const -> Uint override;
+    [[nodiscard]] auto getSpec() const -> const AudioSpec & override;
+    [[nodiscard]] auto getBufferSize() const -> Int override;
+    [[nodiscard]] auto getMaxBufferSize() const -> Int override;
+    [[nodiscard]] auto getDefaultSampleRate() const -> Int override;
+
+    /// Times every callback. Callbacks that take longer than their period count as underruns, and in adaptive mode
+    /// the period changes between buffers.
+    [[nodiscard]] auto getLatencyMonitor() -> AudioLatencyMonitor * override;
+
+public: // OfflineAudioDevice-specific functions
+    [[nodiscard]]
+    auto getClockType() const -> OfflineClock;
+
+    /// Render whole buffers on the calling thread until at least `frames` frames are done. Only available with
+    /// `OfflineClock::Manual`, while the device is open and running.
+    /// \param[in]  frames  number of frames to render
+    /// \returns number of frames rendered, whole buffers; `0` if the device cannot render
+    auto render(Int64 frames) -> Int64;
+
+    /// \returns the most recently rendered buffer of interleaved stereo floats
+    [[nodiscard]]
+    auto getBuffer() const -> const AlignedList<Uint8, 16> &;
+
+    /// Start writing rendered output to a 32-bit float .wav file, replacing any recording in progress
+    /// \param[in]  path  path of the file to write, truncated if it exists
+    /// \returns whether the file could be opened
+    auto startRecording(StringView path) -> Bool;
+
+    /// Finish the .wav file being recorded, if any
+    auto stopRecording() -> void;
+
+    [[nodiscard]]
+    auto isRecording() const -> Bool;
+
+    [[nodiscard]]
+    auto getStats() const -> OfflineRenderStats;
+
+private:
+    struct Impl;
+    Impl *m;
+};
+
+KSND_NS_END
@@ -7,7 +7,10 @@
 #include <kaze/core/memory.h>
 
 #include <portaudio.h>
-#include <mutex>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 
 #if KAZE_PLATFORM_MACOS
 #include <CoreAudio/CoreAudio.h>
@@ -30,9 +33,8 @@ struct PortAudioDevice::Impl {
         STDMETHODIMP OnDefaultDeviceChanged(EDataFlow flow, ERole role, LPCWSTR pwstrDeviceId) override {
             // Handle default device change
             KAZE_CORE_LOG("Device changed");
-            // Implement your logic here
-            auto lock = std::lock_guard(m->mutex);
-            m->id = -1;
+            // Picked up by `update` on the owning thread, which reopens the stream
+            m->id.store(-1, std::memory_order_relaxed);
             return S_OK;
         }
 
@@ -75,15 +77,31 @@ struct PortAudioDevice::Impl {
     IMMDeviceEnumerator *devEnumerator{};
 #endif
 
+    /// Everything the callback of one stream reads, fixed before the stream starts and freed after it closes, so
+    /// that reopening on a device change never has the callback wait on a lock
+    struct StreamState {
+        AudioCallback callback{};
+        AudioRenderCallback renderCallback{};
+        void *userdata{};
+        Int64 bytesPerFrame{};
+        Int64 periodBytes{};               ///< most bytes rendered per engine callback
+        AlignedList<Uint8, 16> buffer{};   ///< for `callback` when PortAudio's buffer is misaligned
+        AudioLatencyMonitor *monitor{};
+        std::atomic<Bool> isLive{};        ///< set once the stream it replaces has closed; silent until then
+    };
+
+    static constexpr Int DefaultFrequency = 48000;
+
     Bool paWasInit{};
     std::atomic<PaStream *> stream{};
-    PaDeviceIndex id{};
+    std::atomic<PaDeviceIndex> id{};       ///< set to `-1` by device change notifications
+    std::unique_ptr<StreamState> state{};  ///< of `stream`
     AudioCallback callback{};
+    AudioRenderCallback renderCallback{};
     void *userdata{};
-    AlignedList<Uint8, 16> buffer{};
     AudioSpec spec{};
-    std::mutex mutex{};
     Uint requestedBufferFrames{};
+    AudioLatencyMonitor monitor{};   ///< outlives the streams, so that a reopen keeps the counts
 
     Impl()
     {
@@ -129,8 +147,7 @@ struct PortAudioDevice::Impl {
         void *inClientData) -> OSStatus
     {
         auto dev = static_cast<Impl *>(inClientData);
-        auto lockGuard = std::lock_guard(dev->mutex);
-        dev->id = -1;
+        dev->id.store(-1, std::memory_order_relaxed);
         return noErr;
     }
 #endif
@@ -155,6 +172,7 @@ struct PortAudioDevice::Impl {
                 return false;
             }
 
+            state.reset(); // its stream was closed by the terminate
             if (const auto result = Pa_Initialize(); result != paNoError)
             {
                 KAZE_PUSH_ERR(Error::RuntimeErr, "Pa_Initialize failed: {}", Pa_GetErrorText(result));
@@ -163,52 +181,69 @@ struct PortAudioDevice::Impl {
         }
 
         return open(Pa_GetDefaultOutputDevice(),
-            spec.freq, static_cast<Int>(requestedBufferFrames),
-            callback, userdata);
+            spec.freq, static_cast<Int>(requestedBufferFrames), spec.channels,
+            callback, renderCallback, userdata);
     }
 
-    auto open(PaDeviceIndex devId, Int frequency, Int sampleFrameBufferSize, AudioCallback engineCallback, void *userdata) -> Bool
+    auto open(PaDeviceIndex devId, Int frequency, Int sampleFrameBufferSize, Int channels,
+        AudioCallback engineCallback, AudioRenderCallback engineRenderCallback, void *userdata) -> Bool
     {
-        std::unique_lock lockGuard(this->mutex);
+        frequency = frequency ? frequency : DefaultFrequency;
+
+        // Fall back to stereo if the device has fewer outputs than requested
+        const auto info = Pa_GetDeviceInfo(devId);
+        if (channels <= 0 || (info && channels > info->maxOutputChannels))
+            channels = 2;
+
+        const auto format = SampleFormat(sizeof(float) * CHAR_BIT, true, Endian::isBig(), true);
+        auto state = std::make_unique<StreamState>();
+        state->callback = engineCallback;
+        state->renderCallback = engineRenderCallback;
+        state->userdata = userdata;
+        state->bytesPerFrame = static_cast<Int64>(format.bytes()) * channels;
+        state->periodBytes = std::max(sampleFrameBufferSize, 1) * state->bytesPerFrame;
+        state->buffer.resize(state->periodBytes);
+        state->monitor = &monitor;
 
-        frequency = frequency ? frequency : 48000;
         PaStream *stream;
         PaStreamParameters outParams{};
         outParams.device = devId;
-        outParams.channelCount = 2;
+        outParams.channelCount = channels;
         outParams.sampleFormat = paFloat32;
         outParams.suggestedLatency = 0;
         outParams.hostApiSpecificStreamInfo = nullptr;
 
         auto err = Pa_OpenStream(&stream, nullptr, &outParams, frequency, sampleFrameBufferSize, 0,
-            Impl::paCallback, this);
+            Impl::paCallback, state.get());
         if (err != paNoError)
         {
             KAZE_PUSH_ERR(Error::RuntimeErr, "Pa_OpenStream failed: {}", Pa_GetErrorText(err));
             return False;
         }
 
-        auto id = Pa_GetDefaultOutputDevice();
-
+        // Start the new stream before touching the previous one, so that if it fails to start, the previous one
+        // keeps playing as it was. It outputs silence until it goes live, so the two never render at once.
         if (err = Pa_StartStream(stream); err != paNoError)
         {
             KAZE_PUSH_ERR(Error::RuntimeErr, "Pa_StartStream failed: {}", Pa_GetErrorText(err));
+            Pa_CloseStream(stream);
             return False;
         }
 
-        lockGuard.unlock();
+        // The previous stream closes before its state is freed, and its callback has returned by then
         close();
-        lockGuard.lock();
 
         this->requestedBufferFrames = sampleFrameBufferSize;
-        this->spec.channels = 2;
+        this->spec.channels = channels;
         this->spec.freq = frequency;
-        this->spec.format = SampleFormat(sizeof(float) * CHAR_BIT, true, Endian::isBig(), true);
+        this->spec.format = format;
         this->callback = engineCallback;
+        this->renderCallback = engineRenderCallback;
         this->userdata = userdata;
+        this->state = std::move(state);
         this->stream = stream;
-        this->buffer.resize(sampleFrameBufferSize * sizeof(float) * 2);
-        this->id = id;
+        this->id.store(Pa_GetDefaultOutputDevice(), std::memory_order_relaxed);
+        this->state->isLive.store(True, std::memory_order_release);
 
 #if KAZE_PLATFORM_MACOS
         // Register device change listener
@@ -225,7 +260,6 @@ struct PortAudioDevice::Impl {
 
     void close()
     {
-        std::lock_guard lockGuard(this->mutex);
         auto stream = this->stream.load(std::memory_order_acquire);
         if (stream)
         {
@@ -253,6 +287,7 @@ struct PortAudioDevice::Impl {
 #endif
             Pa_CloseStream(stream);
             this->stream.store(nullptr, std::memory_order_release);
+            this->state.reset();
         }
     }
 
@@ -262,18 +297,42 @@ struct PortAudioDevice::Impl {
                        PaStreamCallbackFlags statusFlags,
                        void *userData)
     {
-        const auto dev = static_cast<Impl *>(userData);
+        const auto state = static_cast<StreamState *>(userData);
+        if ( !state->isLive.load(std::memory_order_acquire) )
+        {
+            memory::set(outputBuffer, 0, framesPerBuffer * static_cast<Size>(state->bytesPerFrame));
+            return paContinue;
+        }
 
-        auto lockGuard = std::lock_guard(dev->mutex);
-        const auto bufferByteSize = framesPerBuffer * sizeof(float) * 2;
+        state->monitor->beginCallback();
 
-        if (dev->buffer.size() != bufferByteSize)
-            dev->buffer.resize(bufferByteSize);
-        dev->callback(dev->userdata, &dev->buffer);
+        // Render straight into PortAudio's buffer when it is aligned for the mixer, otherwise through the
+        // intermediate buffer. Longer buffers than requested are rendered a period at a time, so the engine's
+        // buffers never grow here.
+        const auto output = static_cast<Uint8 *>(outputBuffer);
+        const auto bytes = static_cast<Int64>(framesPerBuffer) * state->bytesPerFrame;
+        for (Int64 offset = 0; offset < bytes;)
+        {
+            const auto size = std::min(bytes - offset, state->periodBytes);
+            const auto target = output + offset;
+            if (state->renderCallback &&
+                reinterpret_cast<std::uintptr_t>(target) % AudioRenderAlignment == 0)
+            {
+                state->renderCallback(state->userdata, target, size);
+            }
+            else
+            {
+                state->buffer.resize(size); // never past the size reserved on open
+                state->callback(state->userdata, &state->buffer);
+                memory::copy(target, state->buffer.data(), size);
+            }
 
-        memory::copy(outputBuffer, dev->buffer.data(), bufferByteSize);
+            offset += size;
+        }
 
-        return 0;
+        // An underflow flagged here happened since the last callback returned
+        state->monitor->endCallback(static_cast<Int64>(framesPerBuffer), (statusFlags & paOutputUnderflow) != 0);
+        return paContinue;
     }
 };
 
@@ -295,9 +354,13 @@ auto PortAudioDevice::open(const AudioDeviceOpen &config) -> Bool
         return False;
     }
 
+    // The stream calls back on the monitor as soon as it starts, so it is prepared first
+    m->monitor.prepare(config.frameBufferSize, config.minFrameBufferSize, config.maxFrameBufferSize,
+        config.frequency ? config.frequency : Impl::DefaultFrequency, True);
+
     return m->open(device,
-        config.frequency, config.frameBufferSize,
-        config.audioCallback, config.userdata);
+        config.frequency, m->monitor.getPeriodFrames(), config.channels,
+        config.audioCallback, config.renderCallback, config.userdata);
 }
 
 auto PortAudioDevice::close() -> void
@@ -327,7 +390,7 @@ auto PortAudioDevice::isRunning() const -> Bool
 
 auto PortAudioDevice::getId() const -> Uint
 {
-    return m->id;
+    return static_cast<Uint>(m->id.load(std::memory_order_relaxed));
 }
 
 const AudioSpec & PortAudioDevice::getSpec() const
@@ -337,7 +400,15 @@ const AudioSpec & PortAudioDevice::getSpec() const
 
 auto PortAudioDevice::getBufferSize() const -> Int
 {
-    return static_cast<Int>(m->buffer.size());
+    return m->state ? static_cast<Int>(m->state->periodBytes) : 0;
+}
+
+auto PortAudioDevice::getMaxBufferSize() const -> Int
+{
+    if ( !m->state )
+        return 0;
+    return static_cast<Int>(std::max<Int64>(m->state->periodBytes,
+        m->monitor.getMaxPeriodFrames() * m->state->bytesPerFrame));
 }
 
 auto PortAudioDevice::getDefaultSampleRate() const -> Int
@@ -359,13 +430,36 @@ auto PortAudioDevice::getDefaultSampleRate() const -> Int
     return static_cast<Int>(info->defaultSampleRate);
 }
 
+auto PortAudioDevice::getUnderrunCount() const -> Uint64
+{
+    return m->monitor.getUnderrunCount();
+}
+
+auto PortAudioDevice::getLatencyMonitor() -> AudioLatencyMonitor *
+{
+    return &m->monitor;
+}
+
 auto PortAudioDevice::update() -> void
 {
-    //auto lockGuard = std::lock_guard(m->mutex);
-    if (m->id != Pa_GetDefaultOutputDevice())
+    if (m->id.load(std::memory_order_relaxed) != Pa_GetDefaultOutputDevice())
     {
         m->refreshDefaultDevice();
     }
+    else if (m->monitor.hasPendingPeriod())
+    {
+        // PortAudio fixes the period per stream, so a new one takes a new stream. The engine keeps its graph,
+        // and its buffers were reserved for the largest period. If the new stream fails to start, the old one
+        // keeps playing, and its period is reported back instead.
+        const auto stream = m->stream.load(std::memory_order_acquire);
+        if (stream && Pa_IsStreamActive(stream) == 1)
+        {
+            m->open(Pa_GetDefaultOutputDevice(), m->spec.freq, m->monitor.getPeriodFrames(), m->spec.channels,
+                m->callback, m->renderCallback, m->userdata);
+        }
+
+        m->monitor.applyPeriod(static_cast<Int>(m->requestedBufferFrames));
+    }
 }
 
 KSND_NS_END
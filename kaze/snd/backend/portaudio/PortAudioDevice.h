@@ -20,7 +20,10 @@ public:
     [[nodiscard]] auto getId() const -> Uint override;
     [[nodiscard]] auto getSpec() const -> const AudioSpec & override;
     [[nodiscard]] auto getBufferSize() const -> Int override;
+    [[nodiscard]] auto getMaxBufferSize() const -> Int override;
     [[nodiscard]] auto getDefaultSampleRate() const -> Int override;
+    [[nodiscard]] auto getUnderrunCount() const -> Uint64 override;
+    [[nodiscard]] auto getLatencyMonitor() -> AudioLatencyMonitor * override;
 
     void update() override;
 private:
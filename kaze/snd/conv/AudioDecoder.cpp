@@ -71,7 +71,7 @@ AudioDecoder::AudioDecoder()
 
 AudioDecoder::~AudioDecoder()
 {
-
+    close();
 }
 
 AudioDecoder::AudioDecoder(AudioDecoder &&other) noexcept :
@@ -134,16 +134,16 @@ auto AudioDecoder::openMem(const ManagedMem mem, const AudioSpec &targetSpec) ->
     return postOpen(targetSpec);
 }
 
-// This helper handles setting up the decoder
-auto AudioDecoder::postOpen(const AudioSpec &targetSpec) -> Bool
+/// Create a miniaudio decoder reading from `stream`
+/// \returns the decoder, or null on error.
+static auto initDecoder(Rstreamable *stream, const AudioSpec &targetSpec, const Int channels) -> ma_decoder *
 {
-    // Allocate the decoder
     const auto decoder = new ma_decoder();
 
     // Set up the config
     auto config = ma_decoder_config_init(
         static_cast<ma_format>(targetSpec.format.toMaFormat()),
-        targetSpec.channels,
+        channels,
         targetSpec.freq);
 
     if ( !customBackendVTables.empty() )
@@ -156,7 +156,7 @@ auto AudioDecoder::postOpen(const AudioSpec &targetSpec) -> Bool
     if (const auto result = ma_decoder_init(
             ma_decoder_on_read_rstream,
             reinterpret_cast<ma_decoder_seek_proc>(ma_decoder_on_seek_rstream),
-            m_stream.stream(),
+            stream,
             &config,
             decoder);
         result != MA_SUCCESS)
@@ -164,7 +164,36 @@ auto AudioDecoder::postOpen(const AudioSpec &targetSpec) -> Bool
         KAZE_PUSH_ERR(Error::RuntimeErr, "ma_decoder_init error: {}",
             ma_result_description(result));
         delete decoder;
+        return Null;
+    }
+
+    return decoder;
+}
+
+// This helper handles setting up the decoder
+auto AudioDecoder::postOpen(const AudioSpec &targetSpec) -> Bool
+{
+    auto decoder = initDecoder(m_stream.stream(), targetSpec, targetSpec.channels);
+    if ( !decoder )
         return False;
+
+    // Mono or stereo audio narrower than the target keeps its channels, for the mixer to upmix
+    ma_uint32 nativeChannels;
+    if (ma_data_source_get_data_format(decoder->pBackend, nullptr, &nativeChannels, nullptr, nullptr, 0) ==
+        MA_SUCCESS && nativeChannels <= 2 && static_cast<Int>(nativeChannels) < targetSpec.channels)
+    {
+        ma_decoder_uninit(decoder);
+        delete decoder;
+
+        if ( !m_stream.stream()->seek(0, SeekBase::Begin) )
+        {
+            KAZE_PUSH_ERR(Error::RuntimeErr, "AudioDecoder: failed to rewind stream");
+            return False;
+        }
+
+        decoder = initDecoder(m_stream.stream(), targetSpec, static_cast<Int>(nativeChannels));
+        if ( !decoder )
+            return False;
     }
 
     // Get format data
@@ -281,9 +310,12 @@ auto AudioDecoder::readFrames(void *buffer, Int64 frames) -> Int64
 
             if (framesRead >= frames)
                 break;
-            framesRead += readFrames(
-                (Ubyte *)buffer + framesRead,
+            const auto result = readFrames(
+                (Ubyte *)buffer + framesRead * m_spec.bytesPerFrame(),
                 frames - static_cast<Int64>(framesRead));
+            if (result <= 0)
+                break;
+            framesRead += result;
         }
     }
 
@@ -312,7 +344,7 @@ auto AudioDecoder::tell(const AudioTime::Unit units) const -> Double
         getCurrentPCMFrame(),
         AudioTime::PCMFrames,
         units,
-        m_targetSpec
+        m_spec
     );
 }
 
@@ -327,7 +359,7 @@ auto AudioDecoder::seek(const Int64 position, const AudioTime::Unit units, const
 
     // Get frame
     auto frame = mathf::round(
-        AudioTime::convert(position, units, AudioTime::PCMFrames, m_targetSpec));
+        AudioTime::convert(position, units, AudioTime::PCMFrames, m_spec));
 
     // Apply seek base
     if (base == SeekBase::Current)
@@ -72,13 +72,13 @@ public:
     [[nodiscard]]
     auto tell(AudioTime::Unit units) const -> Double;
 
-    /// Read pcm frames into a buffer. Make sure to check target spec for details on sample size, channels, etc.
+    /// Read pcm frames into a buffer. Make sure to check `getSpec` for details on sample size, channels, etc.
     /// \param[in] buffer   buffer to fill
     /// \param[in] frames   number of pcm frames to read
     /// \returns actual number of pcm frames read
     auto readFrames(void *buffer, Int64 frames) -> Int64;
 
-    /// Raw read in byte count. Make sure to check target spec for details on sample size, channels, etc.
+    /// Raw read in byte count. Make sure to check `getSpec` for details on sample size, channels, etc.
     /// \param[in] buffer  buffer to fill
     /// \param[in] bytes   number of bytes to read
     /// \returns actual number of bytes read into `buffer`
@@ -107,11 +107,12 @@ public:
     [[nodiscard]]
     auto isLooping() const -> Bool { return m_looping; }
 
-    /// \returns the target spec that the data is being converted to.
+    /// \returns the target spec that was requested on open.
     [[nodiscard]]
     auto getTargetSpec() const -> const AudioSpec & { return m_targetSpec; }
 
-    /// \returns the audio spec of the source audio file data.
+    /// \returns the spec of the decoded output: the target's format and rate, and the target's channels, except
+    ///          that mono or stereo audio with fewer channels than the target keeps its own, for the mixer to upmix.
     [[nodiscard]]
     auto getSpec() const -> const AudioSpec & { return m_spec; }
 
@@ -122,12 +123,14 @@ public:
 
     [[nodiscard]]
     auto size() const -> Int64;
+
+    /// \returns the length of the stream in pcm frames of the output spec, or `-1` on error.
+    [[nodiscard]]
+    auto getPCMFrameLength() const -> Int64;
 private:
     [[nodiscard]]
     auto getCurrentPCMFrame() const -> Int64;
     [[nodiscard]]
-    auto getPCMFrameLength() const -> Int64;
-    [[nodiscard]]
     auto getAvailableFrames() const -> Int64;
 
     /// Seek to a pcm frame
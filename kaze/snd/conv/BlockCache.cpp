@@ -0,0 +1,174 @@
+#include "BlockCache.h"
+
+#include <kaze/core/memory.h>
+
+KSND_NS_BEGIN
+
+auto BlockCache::makeKey() -> Uint64
+{
+    const auto lockGuard = std::lock_guard(m_mutex);
+    return m_nextKey++;
+}
+
+auto BlockCache::lookup(const Uint64 key, const Int64 block, Ubyte *output, Int64 *outFrames) -> Bool
+{
+    const auto lockGuard = std::lock_guard(m_mutex);
+    const auto it = m_index.find({key, block});
+    if (it == m_index.end())
+    {
+        ++m_misses;
+        return False;
+    }
+
+    ++m_hits;
+    const auto &entry = m_entries[it->second];
+    memory::copy(output, entry.data.data(), entry.data.size());
+    *outFrames = entry.frames;
+
+    unlink(it->second);
+    pushFront(it->second);
+    return True;
+}
+
+auto BlockCache::insert(const Uint64 key, const Int64 block, const Ubyte *data, const Int64 frames,
+    const Int64 bytesPerFrame) -> void
+{
+    const auto bytes = static_cast<Size>(frames * bytesPerFrame);
+    const auto lockGuard = std::lock_guard(m_mutex);
+    if (bytes > m_capacity || m_index.contains({key, block}))
+        return;
+
+    evictOver(m_capacity - bytes);
+
+    Int index;
+    if ( !m_freeEntries.empty() )
+    {
+        index = m_freeEntries.back();
+        m_freeEntries.pop_back();
+    }
+    else
+    {
+        index = static_cast<Int>(m_entries.size());
+        m_entries.emplace_back();
+    }
+
+    auto &entry = m_entries[index];
+    entry.key = {key, block};
+    entry.data.assign(data, data + bytes);
+    entry.frames = frames;
+    pushFront(index);
+
+    m_index.emplace(entry.key, index);
+    m_soundBytes[key] += bytes;
+    m_bytes += bytes;
+}
+
+auto BlockCache::evict(const Uint64 key) -> void
+{
+    const auto lockGuard = std::lock_guard(m_mutex);
+    if ( !m_soundBytes.contains(key) )
+        return;
+
+    for (auto index = m_head; index != -1;)
+    {
+        const auto next = m_entries[index].next;
+        if (m_entries[index].key.sound == key)
+            remove(index);
+        index = next;
+    }
+}
+
+auto BlockCache::clear() -> void
+{
+    const auto lockGuard = std::lock_guard(m_mutex);
+    m_entries.clear();
+    m_freeEntries.clear();
+    m_index.clear();
+    m_soundBytes.clear();
+    m_head = m_tail = -1;
+    m_bytes = 0;
+    m_hits = m_misses = 0;
+}
+
+auto BlockCache::setCapacity(const Size bytes) -> void
+{
+    const auto lockGuard = std::lock_guard(m_mutex);
+    m_capacity = bytes;
+    evictOver(bytes);
+}
+
+auto BlockCache::getCapacity() const -> Size
+{
+    const auto lockGuard = std::lock_guard(m_mutex);
+    return m_capacity;
+}
+
+auto BlockCache::getBytes(const Uint64 key) const -> Size
+{
+    const auto lockGuard = std::lock_guard(m_mutex);
+    const auto it = m_soundBytes.find(key);
+    return it != m_soundBytes.end() ? it->second : 0;
+}
+
+auto BlockCache::getStats() const -> Stats
+{
+    const auto lockGuard = std::lock_guard(m_mutex);
+    return {
+        .hits = m_hits,
+        .misses = m_misses,
+        .bytes = m_bytes,
+        .capacity = m_capacity,
+        .blocks = static_cast<Int64>(m_index.size()),
+    };
+}
+
+auto BlockCache::unlink(const Int index) -> void
+{
+    auto &entry = m_entries[index];
+    if (entry.prev != -1)
+        m_entries[entry.prev].next = entry.next;
+    else
+        m_head = entry.next;
+
+    if (entry.next != -1)
+        m_entries[entry.next].prev = entry.prev;
+    else
+        m_tail = entry.prev;
+
+    entry.prev = entry.next = -1;
+}
+
+auto BlockCache::pushFront(const Int index) -> void
+{
+    auto &entry = m_entries[index];
+    entry.prev = -1;
+    entry.next = m_head;
+    if (m_head != -1)
+        m_entries[m_head].prev = index;
+    m_head = index;
+    if (m_tail == -1)
+        m_tail = index;
+}
+
+auto BlockCache::remove(const Int index) -> void
+{
+    auto &entry = m_entries[index];
+    unlink(index);
+    m_index.erase(entry.key);
+
+    const auto bytes = entry.data.size();
+    m_bytes -= bytes;
+    if (const auto it = m_soundBytes.find(entry.key.sound); it != m_soundBytes.end() && (it->second -= bytes) == 0)
+        m_soundBytes.erase(it);
+
+    AlignedList<Ubyte, 16>().swap(entry.data);
+    m_freeEntries.emplace_back(index);
+}
+
+auto BlockCache::evictOver(const Size capacity) -> void
+{
+    while (m_bytes > capacity && m_tail != -1)
+        remove(m_tail);
+}
+
+KSND_NS_END
@@ -0,0 +1,124 @@
+#pragma once
+#include <kaze/snd/lib.h>
+
+#include <kaze/core/AlignedList.h>
+
+#include <mutex>
+#include <unordered_map>
+
+KSND_NS_BEGIN
+
+/// Decoded blocks of `Sound::Compressed` sounds, shared by all of their instances and evicted least recently used
+/// first once over a byte budget.
+///
+/// A block holds `BlockFrames` frames decoded to the context's spec, keyed by its sound and its index from the
+/// start of the sound. PrefetchStreams look each block up here before decoding it, so retriggered sounds, loops
+/// and overlapping instances decode each stretch once while the file stays compressed in memory. Only the stream
+/// thread and the owning thread touch the cache, under a mutex; the audio thread never does.
+class BlockCache {
+public:
+    /// Frames per cached block, also the block size of the PrefetchStreams that use the cache
+    static constexpr Int64 BlockFrames = 2048;
+
+    /// Default budget for decoded blocks, in bytes
+    static constexpr Size DefaultCapacity = 32 * 1024 * 1024;
+
+    struct Stats {
+        Uint64 hits;     ///< lookups that found their block, cumulative
+        Uint64 misses;   ///< lookups that had to decode their block, cumulative
+        Size bytes;      ///< decoded bytes held
+        Size capacity;   ///< budget for `bytes`
+        Int64 blocks;    ///< blocks held
+
+        /// \returns share of lookups that found their block, from `0` to `1`; `0` before any lookup
+        [[nodiscard]]
+        auto getHitRate() const -> Double
+        {
+            return hits + misses > 0 ? static_cast<Double>(hits) / static_cast<Double>(hits + misses) : 0;
+        }
+    };
+
+    BlockCache() = default;
+    KAZE_NO_COPY(BlockCache);
+
+    /// \returns a key for a sound's blocks, unique for the cache's lifetime
+    auto makeKey() -> Uint64;
+
+    /// Copy a block out of the cache and mark it most recently used. Counts a hit or a miss.
+    /// \param[in]   key        key of the block's sound
+    /// \param[in]   block      index of the block in the sound
+    /// \param[out]  output     buffer of at least `BlockFrames` frames
+    /// \param[out]  outFrames  number of frames copied; fewer than `BlockFrames` for the last block of a sound
+    /// \returns whether the block was cached.
+    auto lookup(Uint64 key, Int64 block, Ubyte *output, Int64 *outFrames) -> Bool;
+
+    /// Add a decoded block, evicting the least recently used blocks to stay within the capacity
+    /// \param[in]  key            key of the block's sound
+    /// \param[in]  block          index of the block in the sound
+    /// \param[in]  data           decoded frames
+    /// \param[in]  frames         number of frames in `data`, at most `BlockFrames`
+    /// \param[in]  bytesPerFrame  size of a frame in `data`
+    auto insert(Uint64 key, Int64 block, const Ubyte *data, Int64 frames, Int64 bytesPerFrame) -> void;
+
+    /// Drop every block of a sound
+    auto evict(Uint64 key) -> void;
+
+    /// Drop every block and reset the stats
+    auto clear() -> void;
+
+    /// Set the budget for decoded blocks, evicting blocks over it
+    /// \param[in]  bytes  budget in bytes; `0` turns caching off, blocks are still decoded ahead
+    auto setCapacity(Size bytes) -> void;
+
+    [[nodiscard]]
+    auto getCapacity() const -> Size;
+
+    /// \returns decoded bytes held for a sound
+    [[nodiscard]]
+    auto getBytes(Uint64 key) const -> Size;
+
+    [[nodiscard]]
+    auto getStats() const -> Stats;
+
+private:
+    struct Key {
+        Uint64 sound;
+        Int64 block;
+
+        auto operator==(const Key &other) const -> Bool = default;
+    };
+
+    struct KeyHash {
+        auto operator()(const Key &key) const noexcept -> Size
+        {
+            return static_cast<Size>(key.sound * 0x9E3779B97F4A7C15ull ^ static_cast<Uint64>(key.block));
+        }
+    };
+
+    struct Entry {
+        Key key;
+        AlignedList<Ubyte, 16> data;
+        Int64 frames;
+        Int prev, next; ///< neighbours in recency order, `-1` past either end
+    };
+
+    auto unlink(Int index) -> void;
+    auto pushFront(Int index) -> void;
+
+    /// Free an entry, its memory included
+    auto remove(Int index) -> void;
+    auto evictOver(Size capacity) -> void;
+
+    mutable std::mutex m_mutex{};
+    List<Entry> m_entries{};
+    List<Int> m_freeEntries{};
+    std::unordered_map<Key, Int, KeyHash> m_index{};
+    std::unordered_map<Uint64, Size> m_soundBytes{};
+    Int m_head{-1}, m_tail{-1}; ///< most and least recently used
+    Size m_bytes{};
+    Size m_capacity{DefaultCapacity};
+    Uint64 m_hits{}, m_misses{};
+    Uint64 m_nextKey{1};
+};
+
+KSND_NS_END
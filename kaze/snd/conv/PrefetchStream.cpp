@@ -0,0 +1,229 @@
+#include "PrefetchStream.h"
+
+#include <kaze/core/debug.h>
+#include <kaze/core/math/mathf.h>
+#include <kaze/core/memory.h>
+
+KSND_NS_BEGIN
+
+PrefetchStream::PrefetchStream(AudioDecoder &&decoder, const Int blockCount, const Int blockFrames,
+    BlockCache *cache, const Uint64 cacheKey) :
+    m_blocks(mathf::max(blockCount, 2)),
+    m_blockFrames(cache ? BlockCache::BlockFrames : mathf::max(blockFrames, 1)),
+    m_bytesPerFrame(static_cast<Int64>(decoder.getSpec().bytesPerFrame())),
+    m_frameLength(decoder.getPCMFrameLength()),
+    m_cache(cache),
+    m_cacheKey(cacheKey),
+    m_decoder(std::move(decoder))
+{
+    for (auto &block : m_blocks)
+    {
+        block.data.resize(m_blockFrames * m_bytesPerFrame, 0);
+        block.frames = 0;
+        block.startFrame = 0;
+        block.skip = 0;
+        block.generation = 0;
+        block.endOfStream = False;
+    }
+
+    m_looping.store(m_decoder.isLooping(), std::memory_order_relaxed);
+
+    if (m_cache)
+    {
+        // Blocks of a cached stream end at the end of the sound, so loops wrap between blocks instead
+        m_decoder.setLooping(False);
+        m_decoderFrame = m_fillFrame = static_cast<Int64>(m_decoder.tell(AudioTime::PCMFrames));
+    }
+}
+
+auto PrefetchStream::fill() -> Bool
+{
+    Bool decoded = False;
+    while (True)
+    {
+        // Apply any requested seek before decoding further
+        const auto generation = m_generation.load(std::memory_order_acquire);
+        if (generation != m_fillGeneration)
+        {
+            m_fillGeneration = generation;
+            m_fillEnded = False;
+
+            const auto frame = m_seekFrame.load(std::memory_order_relaxed);
+            if (m_cache)
+            {
+                // Start from the block holding the frame, which the audio thread plays from partway
+                const auto start = mathf::max<Int64>(frame, 0);
+                m_fillFrame = start - start % m_blockFrames;
+                m_fillSkip = start - m_fillFrame;
+                m_fillEnded = m_frameLength > 0 && start >= m_frameLength;
+            }
+            else if ( !m_decoder.seek(frame, AudioTime::PCMFrames) )
+            {
+                m_fillEnded = True;
+            }
+        }
+
+        const auto looping = m_looping.load(std::memory_order_acquire);
+        if (m_fillEnded && !looping) // a looping stream wraps around on the next read
+            break;
+
+        const auto writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+        if (writeIndex - m_readIndex.load(std::memory_order_acquire) >= m_blocks.size())
+            break;
+
+        auto &block = m_blocks[writeIndex % m_blocks.size()];
+        if (m_cache)
+        {
+            fillCached(block, looping);
+        }
+        else
+        {
+            m_decoder.setLooping(looping);
+
+            block.startFrame = static_cast<Int64>(m_decoder.tell(AudioTime::PCMFrames));
+            const auto framesRead = m_decoder.readFrames(block.data.data(), m_blockFrames);
+            block.frames = mathf::max<Int64>(framesRead, 0);
+            block.skip = 0;
+            block.endOfStream = framesRead < m_blockFrames && !looping;
+        }
+
+        block.generation = generation;
+        m_fillEnded = block.endOfStream;
+
+        m_writeIndex.store(writeIndex + 1, std::memory_order_release);
+        m_blocksDecoded.fetch_add(1, std::memory_order_relaxed);
+        decoded = True;
+    }
+
+    return decoded;
+}
+
+auto PrefetchStream::fillCached(Block &block, const Bool looping) -> void
+{
+    // Only a looping stream fills past the end, starting over
+    if (m_frameLength > 0 && m_fillFrame >= m_frameLength)
+    {
+        m_fillFrame = 0;
+        m_fillSkip = 0;
+    }
+
+    const auto index = m_fillFrame / m_blockFrames;
+    Int64 frames = 0;
+    if ( !m_cache->lookup(m_cacheKey, index, block.data.data(), &frames) )
+    {
+        if (m_decoderFrame == m_fillFrame || m_decoder.seek(m_fillFrame, AudioTime::PCMFrames))
+            frames = mathf::max<Int64>(m_decoder.readFrames(block.data.data(), m_blockFrames), 0);
+        m_decoderFrame = m_fillFrame + frames;
+
+        if (frames > 0)
+            m_cache->insert(m_cacheKey, index, block.data.data(), frames, m_bytesPerFrame);
+    }
+
+    block.startFrame = m_fillFrame;
+    block.frames = frames;
+    block.skip = mathf::min(m_fillSkip, frames);
+    m_fillSkip = 0;
+    m_fillFrame += frames;
+
+    // A short block is the last of the sound
+    const auto atEnd = frames < m_blockFrames || (m_frameLength > 0 && m_fillFrame >= m_frameLength);
+    if (atEnd && looping)
+        m_fillFrame = 0;
+    block.endOfStream = atEnd && !looping;
+}
+
+auto PrefetchStream::read(Ubyte *output, const Int64 frames) -> Int64
+{
+    const auto generation = m_generation.load(std::memory_order_acquire);
+    if (generation != m_readGeneration)
+    {
+        // A seek occurred, anything left from the last generation is dropped below
+        m_readGeneration = generation;
+        m_readOffset = 0;
+        m_seekPending = True;
+        m_playEnded.store(False, std::memory_order_release);
+        m_position.store(m_seekFrame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    Int64 framesCopied = 0;
+    while (framesCopied < frames)
+    {
+        const auto readIndex = m_readIndex.load(std::memory_order_relaxed);
+        if (readIndex == m_writeIndex.load(std::memory_order_acquire))
+            break; // ring is empty
+
+        const auto &block = m_blocks[readIndex % m_blocks.size()];
+        if (block.generation < generation)
+        {
+            m_readIndex.store(readIndex + 1, std::memory_order_release);
+            continue;
+        }
+
+        if (block.generation > generation)
+        {
+            // A seek landed during this read, leave its blocks for the next read to start from
+            m_seekPending = True;
+            break;
+        }
+
+        m_seekPending = False;
+        if (m_readOffset < block.skip)
+            m_readOffset = block.skip;
+
+        const auto count = mathf::min(frames - framesCopied, block.frames - m_readOffset);
+        if (count > 0)
+        {
+            memory::copy(output + framesCopied * m_bytesPerFrame,
+                block.data.data() + m_readOffset * m_bytesPerFrame,
+                count * m_bytesPerFrame);
+            framesCopied += count;
+            m_readOffset += count;
+
+            const auto position = block.startFrame + m_readOffset;
+            m_position.store(m_frameLength > 0 ? position % m_frameLength : position, std::memory_order_relaxed);
+            m_playEnded.store(False, std::memory_order_relaxed);
+        }
+
+        if (m_readOffset >= block.frames)
+        {
+            // The block belongs to the decoding thread once the index is published, so read it first
+            const auto endOfStream = block.endOfStream;
+            m_readOffset = 0;
+            m_readIndex.store(readIndex + 1, std::memory_order_release);
+
+            if (endOfStream)
+            {
+                m_playEnded.store(True, std::memory_order_release);
+                break;
+            }
+        }
+    }
+
+    if (framesCopied < frames && !m_seekPending && !m_playEnded.load(std::memory_order_relaxed))
+    {
+        m_starvations.fetch_add(1, std::memory_order_relaxed);
+        m_starvedFrames.fetch_add(frames - framesCopied, std::memory_order_relaxed);
+    }
+
+    return framesCopied;
+}
+
+auto PrefetchStream::seek(const Int64 frame) -> void
+{
+    m_seekFrame.store(frame, std::memory_order_relaxed);
+    m_generation.fetch_add(1, std::memory_order_release);
+}
+
+auto PrefetchStream::getStats() const -> Stats
+{
+    const auto blocks = m_writeIndex.load(std::memory_order_acquire) - m_readIndex.load(std::memory_order_acquire);
+    return {
+        .bufferedFrames = static_cast<Int64>(blocks) * m_blockFrames,
+        .capacityFrames = static_cast<Int64>(m_blocks.size()) * m_blockFrames,
+        .starvations = m_starvations.load(std::memory_order_relaxed),
+        .starvedFrames = m_starvedFrames.load(std::memory_order_relaxed),
+        .blocksDecoded = m_blocksDecoded.load(std::memory_order_relaxed),
+    };
+}
+
+KSND_NS_END
@@ -0,0 +1,145 @@
+#pragma once
+#include <kaze/snd/lib.h>
+#include <kaze/snd/conv/AudioDecoder.h>
+#include <kaze/snd/conv/BlockCache.h>
+
+#include <kaze/core/AlignedList.h>
+
+#include <atomic>
+
+KSND_NS_BEGIN
+
+/// Decodes an AudioDecoder ahead of the play head into a ring of fixed-size blocks.
+///
+/// Three threads share a stream:
+/// - the decoding thread (see `StreamThread`) owns the decoder and calls `fill`
+/// - the audio thread calls `read` and `isEnded`
+/// - the owning thread may call `seek`, `setLooping`, `getPosition` and `getStats`
+///
+/// The block ring is single-producer / single-consumer, so neither `fill` nor `read` take a lock. Seeks are
+/// requested by bumping a generation counter; the decoding thread tags each block with the generation it was
+/// decoded for, and the audio thread drops any block from an older generation. A block from a newer generation
+/// ends the read, so that a seek landing mid-read is picked up from its first block by the next one.
+///
+/// With a `BlockCache`, blocks are aligned to `BlockCache::BlockFrames` from the start of the sound, looked up in
+/// the cache before being decoded, and added to it after. A seek then starts from the block holding its frame, and
+/// the audio thread skips the frames before it.
+class PrefetchStream {
+public:
+    static constexpr Int DefaultBlockCount = 8;
+    static constexpr Int DefaultBlockFrames = 2048;
+
+    /// Counters for diagnostics. Values are cumulative since construction, except for `bufferedFrames`.
+    struct Stats {
+        Int64 bufferedFrames;  ///< decoded frames waiting ahead of the play head
+        Int64 capacityFrames;  ///< frames the ring can hold
+        Uint64 starvations;    ///< audio callbacks that found the ring empty before the end of the stream
+        Uint64 starvedFrames;  ///< frames filled with silence due to starvation
+        Uint64 blocksDecoded;  ///< blocks filled by the decoding thread, decoded or taken from a cache
+    };
+
+    /// \param[in]  decoder      open decoder to stream; the stream takes ownership of it
+    /// \param[in]  blockCount   number of blocks in the ring
+    /// \param[in]  blockFrames  number of pcm frames per block, `BlockCache::BlockFrames` with a cache
+    /// \param[in]  cache        cache to share decoded blocks through [optional]; must outlive the stream
+    /// \param[in]  cacheKey     key of the sound in `cache`, see `BlockCache::makeKey`
+    explicit PrefetchStream(AudioDecoder &&decoder,
+        Int blockCount = DefaultBlockCount, Int blockFrames = DefaultBlockFrames,
+        BlockCache *cache = Null, Uint64 cacheKey = 0);
+
+    KAZE_NO_COPY(PrefetchStream);
+
+    // ----- Decoding thread ---------------------------------------------------
+
+    /// Decode blocks until the ring is full, the stream ends, or a seek interrupts.
+    /// May also be called by the owning thread before the stream is handed to a StreamThread.
+    /// \returns whether any block was decoded.
+    auto fill() -> Bool;
+
+    // ----- Audio thread ------------------------------------------------------
+
+    /// Copy decoded frames into `output`
+    /// \param[in]  output  buffer to fill, in the decoder's target spec
+    /// \param[in]  frames  number of frames to copy
+    /// \returns number of frames copied. Any shortfall is left untouched for the caller to fill.
+    auto read(Ubyte *output, Int64 frames) -> Int64;
+
+    /// \returns whether the play head has reached the end of a non-looping stream
+    [[nodiscard]]
+    auto isEnded() const -> Bool { return m_playEnded.load(std::memory_order_acquire); }
+
+    // ----- Owning thread -----------------------------------------------------
+
+    /// Request the play head to move to a pcm frame. Takes effect once the decoding thread has refilled the ring.
+    /// Lock-free, so the audio thread may call it too, e.g. when a virtual source catches up.
+    auto seek(Int64 frame) -> void;
+
+    auto setLooping(Bool looping) -> void { m_looping.store(looping, std::memory_order_release); }
+
+    [[nodiscard]]
+    auto isLooping() const -> Bool { return m_looping.load(std::memory_order_acquire); }
+
+    /// \returns current play head position in pcm frames
+    [[nodiscard]]
+    auto getPosition() const -> Int64 { return m_position.load(std::memory_order_relaxed); }
+
+    /// \returns total length of the stream in pcm frames
+    [[nodiscard]]
+    auto getFrameLength() const -> Int64 { return m_frameLength; }
+
+    [[nodiscard]]
+    auto getStats() const -> Stats;
+
+    /// Mark the stream for deletion by its StreamThread
+    auto flagRelease() -> void { m_released.store(True, std::memory_order_release); }
+
+    [[nodiscard]]
+    auto isReleased() const -> Bool { return m_released.load(std::memory_order_acquire); }
+
+private:
+    struct Block {
+        AlignedList<Ubyte, 16> data;
+        Int64 frames;      ///< number of valid frames in `data`
+        Int64 startFrame;  ///< stream position of the first frame
+        Int64 skip;        ///< frames before the seek target that the block starts with, which are not played
+        Uint64 generation; ///< seek generation this block was decoded for
+        Bool endOfStream;  ///< last block of a non-looping stream
+    };
+
+    static constexpr Size CacheLine = 64;
+
+    /// Look up or decode the block starting at `m_fillFrame` into `block`, for a cached stream. Decoding thread.
+    auto fillCached(Block &block, Bool looping) -> void;
+
+    // Fixed on construction
+    List<Block> m_blocks;
+    Int64 m_blockFrames;
+    Int64 m_bytesPerFrame;
+    Int64 m_frameLength;
+    BlockCache *m_cache;
+    Uint64 m_cacheKey;
+
+    // Decoding thread
+    AudioDecoder m_decoder;
+    Uint64 m_fillGeneration{};
+    Bool m_fillEnded{};
+    Int64 m_fillFrame{};     ///< start of the next block, for a cached stream
+    Int64 m_fillSkip{};      ///< frames the next block skips, after a seek into the middle of a cached block
+    Int64 m_decoderFrame{};  ///< where the decoder is, for a cached stream that skips it on cache hits
+
+    // Audio thread
+    Int64 m_readOffset{};      ///< frames consumed from the block at `m_readIndex`
+    Uint64 m_readGeneration{};
+    Bool m_seekPending{};      ///< a seek was seen, but no block for it was read yet
+
+    alignas(CacheLine) std::atomic<Size> m_writeIndex{}; ///< written by decoding thread
+    alignas(CacheLine) std::atomic<Size> m_readIndex{};  ///< written by audio thread
+
+    alignas(CacheLine) std::atomic<Uint64> m_generation{}; ///< bumped by owning thread on seek
+    std::atomic<Int64> m_seekFrame{};
+    std::atomic<Int64> m_position{};
+    std::atomic<Bool> m_looping{}, m_playEnded{}, m_released{};
+    std::atomic<Uint64> m_starvations{}, m_starvedFrames{}, m_blocksDecoded{};
+};
+
+KSND_NS_END
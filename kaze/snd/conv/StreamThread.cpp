@@ -0,0 +1,115 @@
+#include "StreamThread.h"
+#include "PrefetchStream.h"
+
+KSND_NS_BEGIN
+
+StreamThread::~StreamThread()
+{
+    stop();
+
+    // Streams whose sources were never released go down with the thread
+    for (const auto stream : m_streams)
+        delete stream;
+    m_streams.clear();
+}
+
+auto StreamThread::start(const Int intervalMs) -> void
+{
+    if (isRunning())
+        return;
+
+    m_intervalMs = intervalMs;
+    m_isRunning.store(True, std::memory_order_release);
+    m_thread = std::thread([this]() { run(); });
+}
+
+auto StreamThread::stop() -> void
+{
+    if (isRunning())
+    {
+        m_isRunning.store(False, std::memory_order_release);
+        wake();
+        m_thread.join();
+    }
+
+    // Worker is stopped, so its streams can be freed here. Streams still in use stay, since their sources read them.
+    {
+        const auto lockGuard = std::lock_guard(m_mutex);
+        m_streams.insert(m_streams.end(), m_pending.begin(), m_pending.end());
+        m_pending.clear();
+    }
+    deleteReleased();
+}
+
+auto StreamThread::add(PrefetchStream *stream) -> void
+{
+    start(m_intervalMs);
+
+    {
+        const auto lockGuard = std::lock_guard(m_mutex);
+        m_pending.emplace_back(stream);
+        m_wakeFlag = True;
+    }
+
+    m_wake.notify_one();
+}
+
+auto StreamThread::release(PrefetchStream *stream) -> void
+{
+    stream->flagRelease();
+    if (isRunning())
+    {
+        wake();
+        return;
+    }
+
+    // No worker to pass it on to, and `add` only queues streams while it runs
+    deleteReleased();
+}
+
+auto StreamThread::wake() -> void
+{
+    {
+        const auto lockGuard = std::lock_guard(m_mutex);
+        m_wakeFlag = True;
+    }
+
+    m_wake.notify_one();
+}
+
+auto StreamThread::run() -> void
+{
+    while (isRunning())
+    {
+        // Take ownership of newly added streams
+        {
+            auto lock = std::unique_lock(m_mutex);
+            m_streams.insert(m_streams.end(), m_pending.begin(), m_pending.end());
+            m_pending.clear();
+        }
+
+        // Delete released streams, fill the rest
+        deleteReleased();
+        for (const auto stream : m_streams)
+            stream->fill();
+
+        auto lock = std::unique_lock(m_mutex);
+        m_wake.wait_for(lock, std::chrono::milliseconds(m_intervalMs), [this]() {
+            return m_wakeFlag || !isRunning();
+        });
+        m_wakeFlag = False;
+    }
+}
+
+auto StreamThread::deleteReleased() -> void
+{
+    std::erase_if(m_streams, [](PrefetchStream *stream) {
+        if ( !stream->isReleased() )
+            return False;
+
+        delete stream;
+        return True;
+    });
+}
+
+KSND_NS_END
@@ -0,0 +1,66 @@
+#pragma once
+#include <kaze/snd/lib.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+KSND_NS_BEGIN
+
+class PrefetchStream;
+
+/// Worker thread that keeps every registered PrefetchStream filled ahead of its play head, so file reads and
+/// decoding happen outside of the audio callback.
+///
+/// Streams are added and released from the owning thread. The audio thread never interacts with this class.
+/// A stream stays owned by this class until it is released, even across `stop`, so that its source never reads a
+/// deleted stream.
+class StreamThread {
+public:
+    /// Default time between fill passes, in milliseconds
+    static constexpr Int DefaultIntervalMs = 5;
+
+    StreamThread() = default;
+    ~StreamThread();
+
+    KAZE_NO_COPY(StreamThread);
+
+    /// Start the worker thread, if not already running
+    /// \param[in]  intervalMs  time to wait between fill passes when there is no other work
+    auto start(Int intervalMs = DefaultIntervalMs) -> void;
+
+    /// Stop the worker thread and delete the streams already released. The rest are filled again on restart, or
+    /// deleted by `release` or on destruction.
+    auto stop() -> void;
+
+    [[nodiscard]]
+    auto isRunning() const -> Bool { return m_isRunning.load(std::memory_order_acquire); }
+
+    /// Hand a stream over to the worker thread, which takes ownership of it. Starts the worker if not running.
+    auto add(PrefetchStream *stream) -> void;
+
+    /// Release a stream that was added. It is deleted by the worker thread on its next pass, or right away if the
+    /// worker is stopped.
+    auto release(PrefetchStream *stream) -> void;
+
+    /// Wake the worker thread early, e.g. after a seek
+    auto wake() -> void;
+
+private:
+    auto run() -> void;
+
+    /// Delete the streams flagged by `release`. Worker thread, or owning thread once the worker is stopped.
+    auto deleteReleased() -> void;
+
+    std::thread m_thread{};
+    std::mutex m_mutex{};
+    std::condition_variable m_wake{};
+    List<PrefetchStream *> m_pending{}; ///< streams added since the last pass, guarded by `m_mutex`
+    List<PrefetchStream *> m_streams{}; ///< streams owned by the worker thread
+    Int m_intervalMs{DefaultIntervalMs};
+    Bool m_wakeFlag{};                  ///< guarded by `m_mutex`
+    std::atomic<Bool> m_isRunning{};
+};
+
+KSND_NS_END
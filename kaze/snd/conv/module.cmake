@@ -52,4 +52,10 @@ list(APPEND KAZE_SND_CONV_SOURCES_PRIVATE
 
     AudioDecoder.cpp
     AudioDecoder.h
+    BlockCache.cpp
+    BlockCache.h
+    PrefetchStream.cpp
+    PrefetchStream.h
+    StreamThread.cpp
+    StreamThread.h
 )
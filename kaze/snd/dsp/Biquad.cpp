@@ -0,0 +1,202 @@
+#include "Biquad.h"
+
+#include <algorithm>
+#include <cmath>
+
+KSND_NS_BEGIN
+
+namespace dsp {
+
+    auto makeBiquad(const BiquadDesign &design, const Int sampleRate) -> BiquadCoefs
+    {
+        constexpr Double Pi = 3.14159265358979323846;
+
+        const auto rate = static_cast<Double>(std::max(sampleRate, 1));
+        const auto frequency = std::clamp(static_cast<Double>(design.frequency), 10.0, rate * 0.49);
+        const auto q = std::max(static_cast<Double>(design.q), 0.01);
+
+        const auto w0 = 2.0 * Pi * frequency / rate;
+        const auto cosW0 = std::cos(w0);
+        const auto alpha = std::sin(w0) / (2.0 * q);
+        const auto a = std::pow(10.0, static_cast<Double>(design.gain) / 40.0);
+
+        Double b0, b1, b2, a0, a1, a2;
+        switch (design.type)
+        {
+        case FilterType::HighPass:
+            b0 = (1.0 + cosW0) / 2.0;
+            b1 = -(1.0 + cosW0);
+            b2 = b0;
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * cosW0;
+            a2 = 1.0 - alpha;
+            break;
+        case FilterType::BandPass:
+            b0 = alpha;
+            b1 = 0;
+            b2 = -alpha;
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * cosW0;
+            a2 = 1.0 - alpha;
+            break;
+        case FilterType::Notch:
+            b0 = 1.0;
+            b1 = -2.0 * cosW0;
+            b2 = 1.0;
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * cosW0;
+            a2 = 1.0 - alpha;
+            break;
+        case FilterType::Peaking:
+            b0 = 1.0 + alpha * a;
+            b1 = -2.0 * cosW0;
+            b2 = 1.0 - alpha * a;
+            a0 = 1.0 + alpha / a;
+            a1 = -2.0 * cosW0;
+            a2 = 1.0 - alpha / a;
+            break;
+        case FilterType::LowShelf:
+        {
+            const auto k = 2.0 * std::sqrt(a) * alpha;
+            b0 = a * ((a + 1.0) - (a - 1.0) * cosW0 + k);
+            b1 = 2.0 * a * ((a - 1.0) - (a + 1.0) * cosW0);
+            b2 = a * ((a + 1.0) - (a - 1.0) * cosW0 - k);
+            a0 = (a + 1.0) + (a - 1.0) * cosW0 + k;
+            a1 = -2.0 * ((a - 1.0) + (a + 1.0) * cosW0);
+            a2 = (a + 1.0) + (a - 1.0) * cosW0 - k;
+            break;
+        }
+        case FilterType::HighShelf:
+        {
+            const auto k = 2.0 * std::sqrt(a) * alpha;
+            b0 = a * ((a + 1.0) + (a - 1.0) * cosW0 + k);
+            b1 = -2.0 * a * ((a - 1.0) + (a + 1.0) * cosW0);
+            b2 = a * ((a + 1.0) + (a - 1.0) * cosW0 - k);
+            a0 = (a + 1.0) - (a - 1.0) * cosW0 + k;
+            a1 = 2.0 * ((a - 1.0) - (a + 1.0) * cosW0);
+            a2 = (a + 1.0) - (a - 1.0) * cosW0 - k;
+            break;
+        }
+        case FilterType::LowPass:
+        default:
+            b0 = (1.0 - cosW0) / 2.0;
+            b1 = 1.0 - cosW0;
+            b2 = b0;
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * cosW0;
+            a2 = 1.0 - alpha;
+            break;
+        }
+
+        return {
+            .b0 = static_cast<Float>(b0 / a0),
+            .b1 = static_cast<Float>(b1 / a0),
+            .b2 = static_cast<Float>(b2 / a0),
+            .a1 = static_cast<Float>(a1 / a0),
+            .a2 = static_cast<Float>(a2 / a0),
+        };
+    }
+
+    /// Design partway between two, with the frequency moving on a log scale
+    static auto lerpDesign(const BiquadDesign &from, const BiquadDesign &to, const Float t) -> BiquadDesign
+    {
+        if (from == to)
+            return to;
+
+        const auto fromFrequency = std::max(from.frequency, 1.f), toFrequency = std::max(to.frequency, 1.f);
+        return {
+            .type = to.type,
+            .frequency = fromFrequency * std::pow(toFrequency / fromFrequency, t),
+            .q = from.q + (to.q - from.q) * t,
+            .gain = from.gain + (to.gain - from.gain) * t,
+        };
+    }
+
+    BiquadCascade::BiquadCascade() : m_coefs(), m_designs(), m_hasDesign(), m_sampleRate(),
+        m_state(), m_stages(), m_activeStages(), m_channels()
+    {
+    }
+
+    auto BiquadCascade::prepare(const Int stages, const Int channels) -> void
+    {
+        m_stages = std::clamp(stages, 0, MaxBiquadStages);
+        m_channels = channels;
+        m_state.assign(static_cast<Size>(m_stages) * channels * 2, 0);
+        m_activeStages = 0;
+        std::fill(std::begin(m_hasDesign), std::end(m_hasDesign), False);
+    }
+
+    auto BiquadCascade::clear() -> void
+    {
+        std::fill(m_state.begin(), m_state.end(), 0.f);
+    }
+
+    auto BiquadCascade::setDesigns(const BiquadDesign *designs, const Int stages, const Int sampleRate) -> void
+    {
+        if (sampleRate != m_sampleRate)
+        {
+            std::fill(std::begin(m_hasDesign), std::end(m_hasDesign), False);
+            m_sampleRate = sampleRate;
+        }
+
+        for (Int s = 0; s < stages; ++s)
+        {
+            if (m_hasDesign[s] && m_designs[s] == designs[s])
+                continue;
+
+            m_coefs[s] = makeBiquad(designs[s], sampleRate);
+            m_designs[s] = designs[s];
+            m_hasDesign[s] = True;
+        }
+    }
+
+    auto BiquadCascade::process(Float *samples, const Int64 frames, const BiquadDesign *from,
+        const BiquadDesign *to, Int stages, const Int sampleRate) -> void
+    {
+        stages = std::clamp(stages, 0, m_stages);
+        if (stages == 0 || frames <= 0)
+        {
+            m_activeStages = stages;
+            return;
+        }
+
+        // Sections switched on since the last call must not ring with a stale tail
+        if (stages > m_activeStages)
+        {
+            std::fill(m_state.begin() + m_activeStages * m_channels * 2, m_state.begin() + stages * m_channels * 2,
+                0.f);
+        }
+        m_activeStages = stages;
+
+        const auto &kernels = getKernels();
+        if (std::equal(from, from + stages, to))
+        {
+            setDesigns(to, stages, sampleRate);
+            kernels.biquad(samples, frames, m_channels, m_coefs, stages, m_state.data());
+            return;
+        }
+
+        BiquadDesign designs[MaxBiquadStages];
+        for (Int64 offset = 0; offset < frames; offset += RampFrames)
+        {
+            const auto count = std::min(RampFrames, frames - offset);
+            if (offset + count < frames)
+            {
+                // Aim for the middle of the step, so the ramp is centered on the values it passes through
+                const auto t = (static_cast<Float>(offset) + static_cast<Float>(count) * .5f) /
+                    static_cast<Float>(frames);
+                for (Int s = 0; s < stages; ++s)
+                    designs[s] = lerpDesign(from[s], to[s], t);
+                setDesigns(designs, stages, sampleRate);
+            }
+            else
+            {
+                setDesigns(to, stages, sampleRate);
+            }
+
+            kernels.biquad(samples + offset * m_channels, count, m_channels, m_coefs, stages, m_state.data());
+        }
+    }
+}
+
+KSND_NS_END
@@ -0,0 +1,85 @@
+/// \file Biquad.h
+/// Biquad filter design, and cascades that glide between designs without clicks
+#pragma once
+#include "kernels.h"
+
+#include <kaze/snd/lib.h>
+
+KSND_NS_BEGIN
+
+/// Frequency response of a biquad filter section, after the Audio EQ Cookbook
+enum class FilterType : Ubyte {
+    LowPass,   ///< passes below the frequency, -12 dB per octave above it
+    HighPass,  ///< passes above the frequency, -12 dB per octave below it
+    BandPass,  ///< passes around the frequency at 0 dB, narrowing as Q rises
+    Notch,     ///< removes a narrow band around the frequency
+    Peaking,   ///< boosts or cuts by the gain around the frequency
+    LowShelf,  ///< boosts or cuts by the gain below the frequency
+    HighShelf, ///< boosts or cuts by the gain above the frequency
+    Count      ///< number of filter types
+};
+
+namespace dsp {
+
+    /// Settings a biquad section is designed from
+    struct BiquadDesign {
+        FilterType type;
+        Float frequency; ///< cutoff or center in Hz
+        Float q;         ///< resonance; `0.7071` is the flattest pass band
+        Float gain;      ///< boost or cut in dB, only used by `Peaking` and the shelves
+
+        auto operator==(const BiquadDesign &other) const -> Bool = default;
+    };
+
+    /// Compute the coefficients of a biquad section. The frequency is kept between 10 Hz and just below Nyquist.
+    /// \param[in]  design      filter settings
+    /// \param[in]  sampleRate  sample rate in Hz
+    /// \returns coefficients normalized so that `a0 = 1`.
+    [[nodiscard]]
+    auto makeBiquad(const BiquadDesign &design, Int sampleRate) -> BiquadCoefs;
+
+    /// A cascade of biquad sections holding the filter state of one voice.
+    ///
+    /// Each `process` call moves every section from one design to another. While a design changes, coefficients
+    /// are recomputed every `RampFrames` frames along the way, with frequency gliding on a log scale, so sweeps
+    /// sound smooth instead of stepping or clicking. Steady designs are only computed once.
+    class BiquadCascade {
+    public:
+        /// Frames filtered with one set of coefficients while a design changes
+        static constexpr Int64 RampFrames = 32;
+
+        BiquadCascade();
+
+        /// Size the filter state and clear it. Owning thread only.
+        /// \param[in]  stages    most sections `process` runs, at most `MaxBiquadStages`
+        /// \param[in]  channels  interleaved channels per frame
+        auto prepare(Int stages, Int channels) -> void;
+
+        /// Clear the filter state, silencing any ringing tail
+        auto clear() -> void;
+
+        /// Filter interleaved frames in place through the first `stages` sections. Sections that were inactive in
+        /// the previous call start from a cleared state.
+        /// \param[in,out] samples     frames to filter, with the channel count given to `prepare`
+        /// \param[in]     frames      number of frames
+        /// \param[in]     from        design of each section at the start of the buffer
+        /// \param[in]     to          design of each section at the end of the buffer
+        /// \param[in]     stages      number of sections to run, clamped to the count given to `prepare`
+        /// \param[in]     sampleRate  sample rate in Hz
+        auto process(Float *samples, Int64 frames, const BiquadDesign *from, const BiquadDesign *to, Int stages,
+            Int sampleRate) -> void;
+
+    private:
+        /// Compute coefficients for `designs`, skipping sections whose design has not changed
+        auto setDesigns(const BiquadDesign *designs, Int stages, Int sampleRate) -> void;
+
+        BiquadCoefs m_coefs[MaxBiquadStages];
+        BiquadDesign m_designs[MaxBiquadStages]; ///< designs `m_coefs` were computed from
+        Bool m_hasDesign[MaxBiquadStages];
+        Int m_sampleRate;
+        List<Float> m_state;                     ///< see `Kernels::biquad`
+        Int m_stages, m_activeStages, m_channels;
+    };
+}
+
+KSND_NS_END
@@ -0,0 +1,144 @@
+#include "ChannelMatrix.h"
+
+#include <kaze/core/errors.h>
+
+KSND_NS_BEGIN
+
+namespace dsp {
+
+    enum Speaker : Int {
+        FrontLeft,
+        FrontRight,
+        Center,
+        LowFrequency,
+        BackLeft,
+        BackRight,
+        BackCenter,
+        SideLeft,
+        SideRight,
+        SpeakerCount,
+    };
+
+    static constexpr Speaker Layouts[MaxChannels][MaxChannels] = {
+        {Center},
+        {FrontLeft, FrontRight},
+        {FrontLeft, FrontRight, Center},
+        {FrontLeft, FrontRight, BackLeft, BackRight},
+        {FrontLeft, FrontRight, Center, BackLeft, BackRight},
+        {FrontLeft, FrontRight, Center, LowFrequency, BackLeft, BackRight},
+        {FrontLeft, FrontRight, Center, LowFrequency, BackCenter, SideLeft, SideRight},
+        {FrontLeft, FrontRight, Center, LowFrequency, BackLeft, BackRight, SideLeft, SideRight},
+    };
+
+    static constexpr Float MinusThreeDb = 0.70710678f;
+
+    namespace {
+        /// Gains from one input speaker to each speaker of the output layout
+        class SpeakerGains {
+        public:
+            explicit SpeakerGains(const Int destChannels) : m_channels(destChannels)
+            {
+                for (auto &index : m_index)
+                    index = -1;
+                for (Int i = 0; i < destChannels; ++i)
+                    m_index[Layouts[destChannels - 1][i]] = i;
+            }
+
+            [[nodiscard]]
+            auto has(const Speaker speaker) const -> Bool { return m_index[speaker] > -1; }
+
+            /// Route `gain` to `speaker`, or to the center at half gain if it is a front speaker the layout lacks
+            auto add(const Speaker speaker, const Float gain) -> void
+            {
+                if (has(speaker))
+                    m_gains[m_index[speaker]] += gain;
+                else if ((speaker == FrontLeft || speaker == FrontRight) && has(Center))
+                    m_gains[m_index[Center]] += gain * .5f;
+            }
+
+            /// Route `gain` to a left/right pair at -3 dB each
+            auto addPair(const Speaker left, const Speaker right, const Float gain) -> void
+            {
+                add(left, gain * MinusThreeDb);
+                add(right, gain * MinusThreeDb);
+            }
+
+            /// Write the gains into column `column` of a matrix with `srcChannels` columns
+            auto write(Float *matrix, const Int column, const Int srcChannels) const -> void
+            {
+                for (Int i = 0; i < m_channels; ++i)
+                    matrix[i * srcChannels + column] = m_gains[i];
+            }
+
+        private:
+            Int m_channels;
+            Int m_index[SpeakerCount]{};
+            Float m_gains[MaxChannels]{};
+        };
+    }
+
+    auto makeChannelMatrix(const Int srcChannels, const Int destChannels, Float *matrix) -> Bool
+    {
+        if (srcChannels < 1 || srcChannels > MaxChannels || destChannels < 1 || destChannels > MaxChannels)
+        {
+            KAZE_PUSH_ERR(Error::OutOfRange, "Channel counts must be in [1, {}], but got {} -> {}",
+                MaxChannels, srcChannels, destChannels);
+            return False;
+        }
+
+        for (Int column = 0; column < srcChannels; ++column)
+        {
+            SpeakerGains gains(destChannels);
+            const auto speaker = Layouts[srcChannels - 1][column];
+
+            if (srcChannels == 1 && destChannels > 1)
+            {
+                // Mono plays as a centered stereo image, like a duplicated channel
+                gains.add(FrontLeft, 1.f);
+                gains.add(FrontRight, 1.f);
+            }
+            else if (gains.has(speaker))
+            {
+                gains.add(speaker, 1.f);
+            }
+            else
+            {
+                switch (speaker)
+                {
+                case Center:
+                    gains.addPair(FrontLeft, FrontRight, 1.f);
+                    break;
+                case BackLeft:
+                case SideLeft:
+                    {
+                        const auto other = speaker == BackLeft ? SideLeft : BackLeft;
+                        gains.add(gains.has(other) ? other : FrontLeft, gains.has(other) ? 1.f : MinusThreeDb);
+                    } break;
+                case BackRight:
+                case SideRight:
+                    {
+                        const auto other = speaker == BackRight ? SideRight : BackRight;
+                        gains.add(gains.has(other) ? other : FrontRight, gains.has(other) ? 1.f : MinusThreeDb);
+                    } break;
+                case BackCenter:
+                    if (gains.has(BackLeft))
+                        gains.addPair(BackLeft, BackRight, 1.f);
+                    else if (gains.has(SideLeft))
+                        gains.addPair(SideLeft, SideRight, 1.f);
+                    else
+                        gains.addPair(FrontLeft, FrontRight, MinusThreeDb);
+                    break;
+                default: // LFE, or a front speaker folded to the center by `add`
+                    gains.add(speaker, 1.f);
+                    break;
+                }
+            }
+
+            gains.write(matrix, column, srcChannels);
+        }
+
+        return True;
+    }
+}
+
+KSND_NS_END
@@ -0,0 +1,26 @@
+/// \file ChannelMatrix.h
+/// Gain matrices for mixing between speaker layouts
+#pragma once
+#include "kernels.h"
+
+#include <kaze/snd/lib.h>
+
+KSND_NS_BEGIN
+
+namespace dsp {
+
+    /// Fill the gain matrix used by `Kernels::mixMatrix` to mix frames of `srcChannels` into `destChannels`.
+    ///
+    /// Channel counts map to the default WAVE layouts: 1 = C, 2 = FL FR, 3 = FL FR C, 4 = FL FR BL BR,
+    /// 5 = FL FR C BL BR, 6 = FL FR C LFE BL BR, 7 = FL FR C LFE BC SL SR, 8 = FL FR C LFE BL BR SL SR.
+    /// Speakers present in both layouts pass through; mono plays at full gain on the front pair, stereo folds
+    /// to mono at half gain each, and other speakers fold into their nearest neighbors at -3 dB. LFE is dropped
+    /// when the output has none.
+    /// \param[in]  srcChannels   channels per input frame, in [1, `MaxChannels`]
+    /// \param[in]  destChannels  channels per output frame, in [1, `MaxChannels`]
+    /// \param[out] matrix        receives `destChannels * srcChannels` gains, one row of inputs per output
+    /// \returns whether both channel counts are supported; `matrix` is left unchanged if not.
+    auto makeChannelMatrix(Int srcChannels, Int destChannels, Float *matrix) -> Bool;
+}
+
+KSND_NS_END
@@ -0,0 +1,239 @@
+#include "Convolver.h"
+#include "kernels.h"
+
+#include <algorithm>
+
+KSND_NS_BEGIN
+
+namespace dsp {
+
+    Convolver::Convolver() : m_fft(), m_bins(), m_stride(), m_partitions(), m_channels(), m_ring(), m_irRe(),
+        m_irIm(), m_inputRe(), m_inputIm(), m_accRe(), m_accIm(), m_lateRe(),
+        m_lateIm(), m_input(), m_output(), m_time(), m_tails(),
+        m_block(), m_position()
+    {
+    }
+
+    auto Convolver::prepare(const Float *ir, const Int64 irFrames, const Int irChannels, const Int channels) -> void
+    {
+        m_fft.prepare(BlockFrames * 2);
+        m_bins = m_fft.bins();
+        m_stride = (m_bins + 7) & ~static_cast<Int64>(7);
+        m_channels = std::clamp(channels, 1, MaxChannels);
+        m_partitions = static_cast<Int>(std::max<Int64>((irFrames + BlockFrames - 1) / BlockFrames, 1));
+        m_ring = m_partitions + HeadPartitions;
+
+        // The inverse transform is left unscaled, so its `1 / size` is folded into the partitions
+        const auto scale = 1.f / static_cast<Float>(BlockFrames * 2);
+        const auto partitionFloats = static_cast<Int64>(m_channels) * m_partitions * m_stride;
+        m_irRe.assign(partitionFloats, 0);
+        m_irIm.assign(partitionFloats, 0);
+        m_time.assign(BlockFrames * 2, 0);
+        for (Int c = 0; c < m_channels; ++c)
+        {
+            const auto source = std::min(c, std::max(irChannels, 1) - 1);
+            for (Int p = 0; p < m_partitions; ++p)
+            {
+                const auto start = static_cast<Int64>(p) * BlockFrames;
+                const auto count = ir ? std::clamp<Int64>(irFrames - start, 0, BlockFrames) : 0;
+                std::fill(m_time.begin(), m_time.end(), 0.f);
+                for (Int64 k = 0; k < count; ++k)
+                    m_time[k] = ir[(start + k) * irChannels + source] * scale;
+
+                const auto offset = irOffset(c, p);
+                m_fft.forward(m_time.data(), m_irRe.data() + offset, m_irIm.data() + offset);
+            }
+        }
+
+        const auto inputFloats = static_cast<Int64>(m_channels) * m_ring * m_stride;
+        m_inputRe.assign(inputFloats, 0);
+        m_inputIm.assign(inputFloats, 0);
+        m_accRe.assign(m_channels * m_stride, 0);
+        m_accIm.assign(m_channels * m_stride, 0);
+        m_lateRe.assign(m_channels * m_stride, 0);
+        m_lateIm.assign(m_channels * m_stride, 0);
+        m_input.assign(m_channels * BlockFrames * 2, 0);
+        m_output.assign(m_channels * BlockFrames, 0);
+
+        for (auto &tail : m_tails)
+        {
+            tail.state.store(Tail::Idle, std::memory_order_relaxed);
+            tail.block = 0;
+            tail.re.assign(m_channels * m_stride, 0);
+            tail.im.assign(m_channels * m_stride, 0);
+        }
+
+        m_block = 0;
+        m_position = 0;
+    }
+
+    auto Convolver::process(Float *io, const Int64 frames, const Int stride, const Float wetFrom,
+        const Float wetTo) -> Bool
+    {
+        const auto slope = frames > 0 ? (wetTo - wetFrom) / static_cast<Float>(frames) : 0.f;
+        const auto channels = std::min(m_channels, stride);
+
+        auto queued = False;
+        for (Int64 done = 0; done < frames;)
+        {
+            // Fill the current block up to its end, trading each sample for the wet one of the last block
+            const auto run = std::min(frames - done, BlockFrames - m_position);
+            for (Int c = 0; c < channels; ++c)
+            {
+                const auto input = m_input.data() + (c * 2 + 1) * BlockFrames + m_position;
+                const auto output = m_output.data() + c * BlockFrames + m_position;
+                const auto samples = io + done * stride + c;
+                for (Int64 k = 0; k < run; ++k)
+                {
+                    const auto dry = samples[k * stride];
+                    const auto wet = wetFrom + slope * static_cast<Float>(done + k);
+                    input[k] = dry;
+                    samples[k * stride] = dry + wet * (output[k] - dry);
+                }
+            }
+
+            for (Int c = channels; c < stride; ++c)
+            {
+                const auto samples = io + done * stride + c;
+                for (Int64 k = 0; k < run; ++k)
+                    samples[k * stride] *= 1.f - (wetFrom + slope * static_cast<Float>(done + k));
+            }
+
+            done += run;
+            m_position += run;
+            if (m_position == BlockFrames)
+            {
+                queued = processBlock() || queued;
+                m_position = 0;
+            }
+        }
+
+        return queued;
+    }
+
+    auto Convolver::processBlock() -> Bool
+    {
+        const auto &kernels = getKernels();
+        const auto block = m_block;
+        const auto head = static_cast<Int>(std::min<Int64>(std::min(m_partitions, HeadPartitions), block + 1));
+
+        for (Int c = 0; c < m_channels; ++c)
+        {
+            // Transform the previous and current block, then keep the current one as the next previous
+            const auto input = m_input.data() + c * BlockFrames * 2;
+            const auto spectrum = inputOffset(c, block);
+            m_fft.forward(input, m_inputRe.data() + spectrum, m_inputIm.data() + spectrum);
+            std::copy_n(input + BlockFrames, BlockFrames, input);
+
+            const auto accRe = m_accRe.data() + c * m_stride, accIm = m_accIm.data() + c * m_stride;
+            std::fill_n(accRe, m_bins, 0.f);
+            std::fill_n(accIm, m_bins, 0.f);
+            for (Int p = 0; p < head; ++p)
+            {
+                const auto x = inputOffset(c, block - p), h = irOffset(c, p);
+                kernels.spectrumMac(accRe, accIm, m_inputRe.data() + x, m_inputIm.data() + x, m_irRe.data() + h,
+                    m_irIm.data() + h, m_bins);
+            }
+        }
+
+        auto queued = False;
+        if (m_partitions > HeadPartitions)
+        {
+            // Add the tail queued `HeadPartitions` blocks ago, computing it here if the worker has not started it
+            auto &tail = m_tails[block % HeadPartitions];
+            auto state = tail.state.load(std::memory_order_acquire);
+            if (state == Tail::Pending &&
+                tail.state.compare_exchange_strong(state, Tail::Working, std::memory_order_acquire))
+            {
+                computeTail(block, tail.re.data(), tail.im.data(), Null);
+                state = Tail::Done;
+            }
+            else if (state == Tail::Working)
+            {
+                // Never wait on the worker. Unless it finished in the meantime, which leaves `state` as `Done`,
+                // the tail is abandoned to it and summed below instead.
+                tail.state.compare_exchange_strong(state, Tail::Abandoned, std::memory_order_acq_rel);
+            }
+
+            if (state == Tail::Done)
+            {
+                kernels.mix(m_accRe.data(), tail.re.data(), m_channels * m_stride);
+                kernels.mix(m_accIm.data(), tail.im.data(), m_channels * m_stride);
+            }
+            else
+            {
+                // Not queued, or abandoned, now or blocks ago. The slot's buffers may still be written by the
+                // worker, so the sum goes into separate ones.
+                computeTail(block, m_lateRe.data(), m_lateIm.data(), Null);
+                kernels.mix(m_accRe.data(), m_lateRe.data(), m_channels * m_stride);
+                kernels.mix(m_accIm.data(), m_lateIm.data(), m_channels * m_stride);
+            }
+
+            // Every input spectrum the next tail in this slot reads now exists. A slot the worker has yet to let
+            // go of is left alone, and its next tail summed here when due.
+            if (tail.state.load(std::memory_order_acquire) != Tail::Abandoned)
+            {
+                tail.block = block + HeadPartitions;
+                tail.state.store(Tail::Pending, std::memory_order_release);
+                queued = True;
+            }
+        }
+
+        // Overlap-save: the second half of each inverse transform is the wet block
+        for (Int c = 0; c < m_channels; ++c)
+        {
+            m_fft.inverse(m_accRe.data() + c * m_stride, m_accIm.data() + c * m_stride, m_time.data());
+            std::copy_n(m_time.data() + BlockFrames, BlockFrames, m_output.data() + c * BlockFrames);
+        }
+
+        ++m_block;
+        return queued;
+    }
+
+    auto Convolver::computeTail(const Int64 block, Float *re, Float *im, const Tail *tail,
+        const PartitionHook hook, void *userdata) -> Bool
+    {
+        const auto &kernels = getKernels();
+        const auto last = static_cast<Int>(std::min<Int64>(m_partitions - 1, block));
+        for (Int c = 0; c < m_channels; ++c)
+        {
+            const auto channelRe = re + c * m_stride, channelIm = im + c * m_stride;
+            std::fill_n(channelRe, m_bins, 0.f);
+            std::fill_n(channelIm, m_bins, 0.f);
+            for (Int p = HeadPartitions; p <= last; ++p)
+            {
+                // The audio thread sums an abandoned tail itself, so there is no use finishing it
+                if (tail && tail->state.load(std::memory_order_relaxed) == Tail::Abandoned)
+                    return False;
+
+                const auto x = inputOffset(c, block - p), h = irOffset(c, p);
+                kernels.spectrumMac(channelRe, channelIm, m_inputRe.data() + x, m_inputIm.data() + x,
+                    m_irRe.data() + h, m_irIm.data() + h, m_bins);
+                if (hook)
+                    hook(userdata);
+            }
+        }
+
+        return True;
+    }
+
+    auto Convolver::runPending(const PartitionHook hook, void *userdata) -> void
+    {
+        for (auto &tail : m_tails)
+        {
+            auto expected = static_cast<Int>(Tail::Pending);
+            if ( !tail.state.compare_exchange_strong(expected, Tail::Working, std::memory_order_acquire) )
+                continue;
+
+            // Publish the sum, unless the audio thread abandoned it meanwhile; then drop it and free the slot
+            expected = Tail::Working;
+            if ( !computeTail(tail.block, tail.re.data(), tail.im.data(), &tail, hook, userdata) ||
+                !tail.state.compare_exchange_strong(expected, Tail::Done, std::memory_order_acq_rel) )
+            {
+                tail.state.store(Tail::Idle, std::memory_order_release);
+            }
+        }
+    }
+}
+
+KSND_NS_END
@@ -0,0 +1,139 @@
+/// \file Convolver.h
+/// Uniformly partitioned convolution with long impulse responses
+#pragma once
+#include "Fft.h"
+
+#include <kaze/snd/lib.h>
+
+#include <kaze/core/AlignedList.h>
+
+#include <atomic>
+
+KSND_NS_BEGIN
+
+namespace dsp {
+
+    /// Convolves up to two channels of interleaved frames with an impulse response, by uniformly partitioned
+    /// overlap-save in the frequency domain.
+    ///
+    /// The impulse response is cut into partitions of `BlockFrames` frames, each transformed once by `prepare`.
+    /// Every `BlockFrames` frames of input, the newest two blocks are transformed, and each partition's spectrum is
+    /// multiplied with the input spectrum of its age and summed, so the cost per block grows with the number of
+    /// partitions instead of their product with the block length. The wet signal is `BlockFrames` frames late.
+    ///
+    /// Only the first `HeadPartitions` are summed on the audio thread. The sum of the rest, the tail, only needs
+    /// input spectra that already exist `HeadPartitions` blocks ahead of the block it is added to, so it is queued
+    /// that early, and computed by `runPending` on a worker thread. Should the worker not have finished it by the
+    /// time it is needed, the audio thread computes it inline instead of dropping it, and never waits on the
+    /// worker: a tail still in progress is abandoned, and the worker throws its late result away.
+    class Convolver {
+    public:
+        /// Frames per partition, and the latency of the wet signal
+        static constexpr Int64 BlockFrames = 256;
+
+        /// Partitions summed on the audio thread
+        static constexpr Int HeadPartitions = 4;
+
+        /// Most channels convolved
+        static constexpr Int MaxChannels = 2;
+
+        Convolver();
+
+        KAZE_NO_COPY(Convolver);
+
+        /// Transform an impulse response and clear the state. Owning thread only, before any other call.
+        /// \param[in]  ir          interleaved frames of the impulse response, scaled as the wet signal should be
+        /// \param[in]  irFrames    number of frames in `ir`
+        /// \param[in]  irChannels  interleaved channels in `ir`; a channel without its own response uses the last
+        /// \param[in]  channels    channels to convolve, at most `MaxChannels`
+        auto prepare(const Float *ir, Int64 irFrames, Int irChannels, Int channels) -> void;
+
+        /// Convolve interleaved frames in place, crossfading each convolved channel from dry to wet by `wet`.
+        /// Audio thread only.
+        /// \param[in,out] io        interleaved frames
+        /// \param[in]     frames    number of frames
+        /// \param[in]     stride    interleaved channels per frame in `io`; channels past those prepared are only
+        ///                          scaled by the dry share, `1 - wet`
+        /// \param[in]     wetFrom   wet mix at the start of the buffer, from `0` to `1`
+        /// \param[in]     wetTo     wet mix at the end of the buffer
+        /// \returns whether tail work was queued, for `runPending` to pick up.
+        auto process(Float *io, Int64 frames, Int stride, Float wetFrom, Float wetTo) -> Bool;
+
+        /// Called by `runPending` after each partition it sums
+        using PartitionHook = void (*)(void *userdata);
+
+        /// Compute every queued tail. Worker thread, while the convolver is alive.
+        /// \param[in]  hook      called after each partition summed, e.g. for tests to hold the worker mid-tail
+        ///                       [optional]
+        /// \param[in]  userdata  passed to `hook`
+        auto runPending(PartitionHook hook = Null, void *userdata = Null) -> void;
+
+        /// \returns the number of partitions the impulse response was cut into
+        [[nodiscard]]
+        auto getPartitionCount() const noexcept -> Int { return m_partitions; }
+
+        /// \returns the number of channels convolved
+        [[nodiscard]]
+        auto getChannels() const noexcept -> Int { return m_channels; }
+
+    private:
+        /// Tail sum of one future block
+        struct Tail {
+            /// `Abandoned` marks a tail the audio thread computed itself while the worker was still on it; the
+            /// worker returns the slot to `Idle` once it notices.
+            enum State : Int { Idle, Pending, Working, Done, Abandoned };
+
+            std::atomic<Int> state{Idle};
+            Int64 block{};                  ///< block the sum is added to
+            AlignedList<Float, 16> re, im;  ///< spectrum per channel, `m_stride` apart
+        };
+
+        /// Transform the block just filled and compute its output. Audio thread.
+        /// \returns whether tail work was queued.
+        auto processBlock() -> Bool;
+
+        /// Sum the tail partitions of a block
+        /// \param[in]   block  block the sum is added to
+        /// \param[out]  re     real parts per channel, `m_stride` apart
+        /// \param[out]  im     imaginary parts per channel
+        /// \param[in]   tail   tail to stop early for once abandoned, or null when the audio thread sums it
+        /// \param[in]   hook   see `runPending`
+        /// \returns whether the sum is complete.
+        auto computeTail(Int64 block, Float *re, Float *im, const Tail *tail, PartitionHook hook = Null,
+            void *userdata = Null) -> Bool;
+
+        /// \returns the offset of an input spectrum in `m_inputRe` and `m_inputIm`
+        [[nodiscard]]
+        auto inputOffset(Int channel, Int64 block) const -> Int64
+        {
+            return (channel * m_ring + block % m_ring) * m_stride;
+        }
+
+        /// \returns the offset of a partition's spectrum in `m_irRe` and `m_irIm`
+        [[nodiscard]]
+        auto irOffset(Int channel, Int partition) const -> Int64
+        {
+            return (static_cast<Int64>(channel) * m_partitions + partition) * m_stride;
+        }
+
+        Fft m_fft;
+        Int64 m_bins;                          ///< complex bins per spectrum
+        Int64 m_stride;                        ///< floats between spectra, `m_bins` rounded up to whole vectors
+        Int m_partitions;
+        Int m_channels;
+        Int m_ring;                            ///< input spectra kept per channel
+
+        AlignedList<Float, 16> m_irRe, m_irIm;       ///< partition spectra per channel
+        AlignedList<Float, 16> m_inputRe, m_inputIm; ///< ring of input spectra per channel
+        AlignedList<Float, 16> m_accRe, m_accIm;     ///< output spectrum per channel
+        AlignedList<Float, 16> m_lateRe, m_lateIm;   ///< tail computed inline while its slot is still in use
+        AlignedList<Float, 16> m_input;              ///< previous and current block per channel, `BlockFrames * 2`
+        AlignedList<Float, 16> m_output;             ///< wet block per channel
+        AlignedList<Float, 16> m_time;               ///< one transform's worth of samples
+        Tail m_tails[HeadPartitions];                ///< slot `block % HeadPartitions` of each queued block
+        Int64 m_block;                               ///< index of the block being filled
+        Int64 m_position;                            ///< frames filled in the current block
+    };
+}
+
+KSND_NS_END
@@ -0,0 +1,186 @@
+#include "Dynamics.h"
+#include "kernels.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+KSND_NS_BEGIN
+
+namespace dsp {
+
+    namespace {
+        constexpr Int TargetSlots = Dynamics::MaxLookaheadBlocks + 1;
+
+        /// Frames in the delay line, enough for the longest lookahead plus the block being written
+        constexpr auto DelayFrames = std::bit_ceil(
+            static_cast<Uint64>((Dynamics::MaxLookaheadBlocks + 1) * Dynamics::ControlFrames));
+    }
+
+    Dynamics::Dynamics() : m_delay(), m_delayHead(), m_targets(), m_targetHead(), m_envelope(), m_gain(1.f),
+        m_channels(), m_sampleRate()
+    {
+    }
+
+    auto Dynamics::prepare(const Int channels, const Int sampleRate) -> void
+    {
+        m_channels = channels;
+        m_sampleRate = std::max(sampleRate, 1);
+        m_delay.assign(DelayFrames * channels, 0);
+        clear();
+    }
+
+    auto Dynamics::clear() -> void
+    {
+        std::fill(m_delay.begin(), m_delay.end(), 0.f);
+        std::fill(std::begin(m_targets), std::end(m_targets), 1.f);
+        m_delayHead = 0;
+        m_targetHead = 0;
+        m_envelope = 0;
+        m_gain = 1.f;
+    }
+
+    auto Dynamics::computeGain(const Float level, const DynamicsSettings &settings) -> Float
+    {
+        if (level <= 0)
+            return 1.f;
+
+        // Soft knee curve in dB, after Giannoulis, Massberg and Reiss
+        const auto over = 20.f * std::log10(level) - settings.threshold;
+        const auto knee = settings.knee;
+        if (2.f * over <= -knee)
+            return 1.f;
+
+        const auto slope = settings.ratio > 0 ? 1.f / settings.ratio - 1.f : -1.f; // gain per dB over
+        Float gain;
+        if (2.f * over < knee)
+        {
+            const auto t = over + knee * .5f;
+            gain = slope * t * t / (2.f * knee);
+        }
+        else
+        {
+            gain = slope * over;
+        }
+
+        return std::pow(10.f, gain / 20.f);
+    }
+
+    auto Dynamics::delayBlock(Float *samples, const Int64 frames, const Int64 delay) -> void
+    {
+        // Write the block, then read the frames `delay` back, each in at most two runs around the end of the ring.
+        // The delay is at least a full block, so the frames read never overlap the frames just written.
+        const auto channels = static_cast<Uint64>(m_channels);
+        const auto head = static_cast<Uint64>(m_delayHead);
+
+        auto position = head;
+        for (Int64 done = 0; done < frames;)
+        {
+            const auto run = std::min(static_cast<Uint64>(frames - done), DelayFrames - position);
+            std::copy_n(samples + done * channels, run * channels, m_delay.data() + position * channels);
+            done += static_cast<Int64>(run);
+            position = (position + run) & (DelayFrames - 1);
+        }
+
+        position = (head - static_cast<Uint64>(delay)) & (DelayFrames - 1);
+        for (Int64 done = 0; done < frames;)
+        {
+            const auto run = std::min(static_cast<Uint64>(frames - done), DelayFrames - position);
+            std::copy_n(m_delay.data() + position * channels, run * channels, samples + done * channels);
+            done += static_cast<Int64>(run);
+            position = (position + run) & (DelayFrames - 1);
+        }
+
+        m_delayHead = static_cast<Int64>((head + frames) & (DelayFrames - 1));
+    }
+
+    auto Dynamics::process(Float *samples, const Int64 frames, const Float *key, const Int64 keyFrames,
+        const DynamicsSettings &settings, const Float makeupFrom, const Float makeupTo) -> Float
+    {
+        const auto &kernels = getKernels();
+        const auto lookahead = std::clamp(static_cast<Int>(std::ceil(static_cast<Double>(settings.lookahead) *
+            m_sampleRate / ControlFrames - 1e-6)), 0, MaxLookaheadBlocks);
+
+        const auto coefficient = [this](const Float seconds) {
+            return seconds > 0 ?
+                1.f - std::exp(-static_cast<Float>(ControlFrames) / (seconds * static_cast<Float>(m_sampleRate))) :
+                1.f;
+        };
+        const auto attack = coefficient(settings.attack);
+        const auto release = coefficient(settings.release);
+        const auto isRms = settings.detector == DetectorMode::Rms;
+
+        // Gain needed by input block `i` of the lookahead window, `0` being the block about to be output
+        const auto target = [this, lookahead](const Int i) {
+            return m_targets[(m_targetHead - 1 - lookahead + i + TargetSlots) % TargetSlots];
+        };
+
+        Float levels[ControlFrames];
+        auto lowest = 1.f;
+        for (Int64 offset = 0; offset < frames; offset += ControlFrames)
+        {
+            const auto count = std::min(ControlFrames, frames - offset);
+            const auto block = samples + offset * m_channels;
+
+            // Detect the block's level
+            if (key)
+            {
+                const auto available = std::clamp<Int64>(keyFrames - offset, 0, count);
+                std::copy_n(key + offset, available, levels);
+                std::fill(levels + available, levels + count, 0.f);
+            }
+            else
+            {
+                kernels.peak(block, levels, count, m_channels);
+            }
+
+            Float level = 0;
+            if (isRms)
+            {
+                for (Int64 k = 0; k < count; ++k)
+                    level += levels[k] * levels[k];
+                level /= static_cast<Float>(count);
+            }
+            else
+            {
+                for (Int64 k = 0; k < count; ++k)
+                    level = std::max(level, levels[k]);
+            }
+
+            m_envelope += (level - m_envelope) * (level > m_envelope ? attack : release);
+            if (m_envelope < FlushThreshold)
+                m_envelope = 0;
+
+            m_targets[m_targetHead] = computeGain(isRms ? std::sqrt(m_envelope) : m_envelope, settings);
+            m_targetHead = (m_targetHead + 1) % TargetSlots;
+
+            // Gain at the end of the output block: no more than either block it borders needs, and low enough that
+            // a straight ramp reaches each later boundary's gain in time
+            auto next = lookahead > 0 ? std::min(target(0), target(1)) : target(0);
+            for (Int k = 1; k <= lookahead; ++k)
+            {
+                const auto bound = k < lookahead ? std::min(target(k), target(k + 1)) : target(k);
+                if (bound < m_gain)
+                    next = std::min(next, m_gain + (bound - m_gain) / static_cast<Float>(k + 1));
+            }
+
+            if (lookahead > 0)
+                delayBlock(block, count, lookahead * ControlFrames);
+
+            const auto total = static_cast<Float>(frames);
+            const auto makeupStart = makeupFrom + (makeupTo - makeupFrom) * (static_cast<Float>(offset) / total);
+            const auto makeupEnd = makeupFrom + (makeupTo - makeupFrom) *
+                (static_cast<Float>(offset + count) / total);
+            const auto start = m_gain * makeupStart, end = next * makeupEnd;
+            if (start != 1.f || end != 1.f)
+                kernels.fade(block, count, m_channels, 0, start, (end - start) / static_cast<Float>(count));
+
+            lowest = std::min(lowest, next);
+            m_gain = next;
+        }
+
+        return lowest;
+    }
+}
+
+KSND_NS_END
@@ -0,0 +1,85 @@
+/// \file Dynamics.h
+/// Level detection and gain reduction shared by the compressor and limiter effects
+#pragma once
+#include <kaze/snd/lib.h>
+
+#include <kaze/core/AlignedList.h>
+
+KSND_NS_BEGIN
+
+/// What a dynamics processor's level detector measures
+enum class DetectorMode : Ubyte {
+    Peak,  ///< loudest sample of each control block, catching every transient
+    Rms,   ///< root mean square of each control block, closer to perceived loudness
+    Count  ///< number of detector modes
+};
+
+namespace dsp {
+
+    /// Settings a `Dynamics` processor runs one buffer with
+    struct DynamicsSettings {
+        Float threshold;       ///< level in dB above which gain is reduced
+        Float ratio;           ///< dB over the threshold in, per dB over it out; `0` for infinity, i.e. limiting
+        Float knee;            ///< width in dB of the soft knee centered on the threshold, `0` for a hard knee
+        Float attack;          ///< seconds for the envelope to rise 63% of the way to a louder level
+        Float release;         ///< seconds for the envelope to fall 63% of the way to a quieter level
+        Float lookahead;       ///< seconds the signal is delayed by, rounded up to whole control blocks
+        DetectorMode detector;
+    };
+
+    /// Downward compressor of interleaved frames.
+    ///
+    /// Levels are detected on blocks of `ControlFrames` frames: the vectorized `Kernels::peak` reduces each frame
+    /// to its loudest channel, and an attack/release envelope follows the block's peak or mean square. The gain
+    /// computed from the envelope ramps linearly across each block. With lookahead, the signal is delayed, and the
+    /// gain ramps down ahead of every loud block to reach the reduction it needs by the time the block arrives, so
+    /// that an infinite ratio limits without overshoot.
+    class Dynamics {
+    public:
+        /// Frames per control block
+        static constexpr Int64 ControlFrames = 16;
+
+        /// Most control blocks of lookahead
+        static constexpr Int MaxLookaheadBlocks = 64;
+
+        Dynamics();
+
+        /// Size the delay line and clear the state. Owning thread only.
+        /// \param[in]  channels    interleaved channels per frame
+        /// \param[in]  sampleRate  sample rate in Hz
+        auto prepare(Int channels, Int sampleRate) -> void;
+
+        /// Clear the envelope, gain and delay line
+        auto clear() -> void;
+
+        /// Reduce the gain of interleaved frames in place, delayed by the lookahead.
+        /// \param[in,out] samples     frames with the channel count given to `prepare`
+        /// \param[in]     frames      number of frames
+        /// \param[in]     key         level per frame to detect in place of `samples`, e.g. from a sidechain, or
+        ///                            null to detect the frames themselves
+        /// \param[in]     keyFrames   number of levels in `key`, past which the key is silent
+        /// \param[in]     settings    detector and gain settings
+        /// \param[in]     makeupFrom  linear gain applied after reduction at the start of the buffer
+        /// \param[in]     makeupTo    linear gain applied after reduction at the end of the buffer
+        /// \returns the lowest reduction gain of the buffer, from `0` to `1`, without makeup.
+        auto process(Float *samples, Int64 frames, const Float *key, Int64 keyFrames,
+            const DynamicsSettings &settings, Float makeupFrom, Float makeupTo) -> Float;
+
+    private:
+        /// \returns the linear gain that the settings' curve applies to a linear level
+        static auto computeGain(Float level, const DynamicsSettings &settings) -> Float;
+
+        /// Delay a block of frames by `delay` frames through the delay line
+        auto delayBlock(Float *samples, Int64 frames, Int64 delay) -> void;
+
+        AlignedList<Float, 16> m_delay; ///< ring of interleaved frames, a power of two long
+        Int64 m_delayHead;              ///< frame written next
+        Float m_targets[MaxLookaheadBlocks + 1]; ///< ring of the gains needed by the latest input blocks
+        Int m_targetHead;               ///< slot written next in `m_targets`
+        Float m_envelope;               ///< detected level, or mean square in `DetectorMode::Rms`
+        Float m_gain;                   ///< reduction gain at the start of the next output block
+        Int m_channels, m_sampleRate;
+    };
+}
+
+KSND_NS_END
@@ -0,0 +1,147 @@
+#include "Fft.h"
+#include "kernels.h"
+
+#include <bit>
+#include <cmath>
+#include <numbers>
+
+KSND_NS_BEGIN
+
+namespace dsp {
+
+    Fft::Fft() : m_size(), m_reverse(), m_twiddleRe(), m_twiddleIm(), m_splitRe(), m_splitIm(), m_workRe(),
+        m_workIm()
+    {
+    }
+
+    auto Fft::prepare(const Int64 size) -> void
+    {
+        KAZE_ASSERT(size >= MinSize && std::has_single_bit(static_cast<Uint64>(size)),
+            "FFT size must be a power of two of at least `Fft::MinSize`");
+
+        m_size = size;
+        const auto points = size / 2;
+        const auto bits = std::countr_zero(static_cast<Uint64>(points));
+
+        m_reverse.resize(points);
+        for (Int64 k = 0; k < points; ++k)
+        {
+            Int64 reversed = 0;
+            for (Int bit = 0; bit < bits; ++bit)
+                reversed |= ((k >> bit) & 1) << (bits - 1 - bit);
+            m_reverse[k] = reversed;
+        }
+
+        // Pass with butterflies `half` apart turns by `exp(-2 pi i j / (2 * half))`
+        m_twiddleRe.assign(points, 0);
+        m_twiddleIm.assign(points, 0);
+        for (Int64 half = 4; half < points; half *= 2)
+        {
+            for (Int64 j = 0; j < half; ++j)
+            {
+                const auto angle = -std::numbers::pi * static_cast<Double>(j) / static_cast<Double>(half);
+                m_twiddleRe[half + j] = static_cast<Float>(std::cos(angle));
+                m_twiddleIm[half + j] = static_cast<Float>(std::sin(angle));
+            }
+        }
+
+        m_splitRe.resize(points);
+        m_splitIm.resize(points);
+        for (Int64 k = 0; k < points; ++k)
+        {
+            const auto angle = -2.0 * std::numbers::pi * static_cast<Double>(k) / static_cast<Double>(size);
+            m_splitRe[k] = static_cast<Float>(std::cos(angle));
+            m_splitIm[k] = static_cast<Float>(std::sin(angle));
+        }
+
+        m_workRe.assign(points, 0);
+        m_workIm.assign(points, 0);
+    }
+
+    auto Fft::transform(Float *re, Float *im) const -> void
+    {
+        const auto points = m_size / 2;
+
+        // First two stages as one radix-4 pass, whose twiddles are all `1` or `-i`
+        for (Int64 b = 0; b < points; b += 4)
+        {
+            const auto t0r = re[b] + re[b + 1], t0i = im[b] + im[b + 1];
+            const auto t1r = re[b] - re[b + 1], t1i = im[b] - im[b + 1];
+            const auto t2r = re[b + 2] + re[b + 3], t2i = im[b + 2] + im[b + 3];
+            const auto t3r = re[b + 2] - re[b + 3], t3i = im[b + 2] - im[b + 3];
+
+            re[b] = t0r + t2r;     im[b] = t0i + t2i;
+            re[b + 1] = t1r + t3i; im[b + 1] = t1i - t3r;
+            re[b + 2] = t0r - t2r; im[b + 2] = t0i - t2i;
+            re[b + 3] = t1r - t3i; im[b + 3] = t1i + t3r;
+        }
+
+        const auto &kernels = getKernels();
+        for (Int64 half = 4; half < points; half *= 2)
+        {
+            kernels.fftPass(re, im, m_twiddleRe.data() + half, m_twiddleIm.data() + half, half, points);
+        }
+    }
+
+    auto Fft::forward(const Float *input, Float *re, Float *im) -> void
+    {
+        // Even samples as real parts, odd samples as imaginary parts
+        const auto points = m_size / 2;
+        for (Int64 k = 0; k < points; ++k)
+        {
+            const auto from = m_reverse[k] * 2;
+            m_workRe[k] = input[from];
+            m_workIm[k] = input[from + 1];
+        }
+
+        transform(m_workRe.data(), m_workIm.data());
+
+        // Split `Z` into the spectra of the even samples `E` and odd samples `O`, then `X[k] = E[k] + W^k O[k]`
+        re[0] = m_workRe[0] + m_workIm[0];
+        im[0] = 0;
+        re[points] = m_workRe[0] - m_workIm[0];
+        im[points] = 0;
+        for (Int64 k = 1; k < points; ++k)
+        {
+            const auto zr = m_workRe[k], zi = m_workIm[k];
+            const auto cr = m_workRe[points - k], ci = -m_workIm[points - k];
+
+            const auto er = .5f * (zr + cr), ei = .5f * (zi + ci);
+            const auto orr = .5f * (zi - ci), oi = -.5f * (zr - cr);
+            const auto wr = m_splitRe[k], wi = m_splitIm[k];
+            re[k] = er + (wr * orr - wi * oi);
+            im[k] = ei + (wr * oi + wi * orr);
+        }
+    }
+
+    auto Fft::inverse(const Float *re, const Float *im, Float *output) -> void
+    {
+        // Rebuild `Z = E + i O` from the real spectrum in bit-reversed order. Transforming it with its parts swapped
+        // runs the forward transform as an inverse one, leaving the result in the right parts.
+        const auto points = m_size / 2;
+        for (Int64 k = 0; k < points; ++k)
+        {
+            const auto xr = re[k], xi = k == 0 ? 0.f : im[k];
+            const auto cr = re[points - k], ci = k == 0 ? 0.f : -im[points - k];
+
+            const auto er = xr + cr, ei = xi + ci;
+            const auto dr = xr - cr, di = xi - ci;
+            const auto wr = m_splitRe[k], wi = m_splitIm[k];
+            const auto orr = dr * wr + di * wi, oi = di * wr - dr * wi;
+
+            const auto to = m_reverse[k];
+            m_workRe[to] = er - oi;
+            m_workIm[to] = ei + orr;
+        }
+
+        transform(m_workIm.data(), m_workRe.data());
+
+        for (Int64 k = 0; k < points; ++k)
+        {
+            output[k * 2] = m_workRe[k];
+            output[k * 2 + 1] = m_workIm[k];
+        }
+    }
+}
+
+KSND_NS_END
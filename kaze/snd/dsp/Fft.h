@@ -0,0 +1,63 @@
+/// \file Fft.h
+/// Real-input fast Fourier transform in split format
+#pragma once
+#include <kaze/snd/lib.h>
+
+#include <kaze/core/AlignedList.h>
+
+KSND_NS_BEGIN
+
+namespace dsp {
+
+    /// Fast Fourier transform of real signals, a power of two long.
+    ///
+    /// A signal of `N` samples is packed into `N / 2` complex points, transformed by a complex FFT, and split back
+    /// into the `N / 2 + 1` bins of the real spectrum. The complex FFT runs its first two stages as one radix-4 pass,
+    /// then radix-2 passes through the vectorized `Kernels::fftPass`. Spectra are kept in split format, real and
+    /// imaginary parts in separate lists, so that every pass and `Kernels::spectrumMac` run on whole vectors.
+    class Fft {
+    public:
+        /// Smallest transform size
+        static constexpr Int64 MinSize = 8;
+
+        Fft();
+
+        /// Compute the tables of a transform size. Owning thread only.
+        /// \param[in]  size  number of real samples, a power of two of at least `MinSize`
+        auto prepare(Int64 size) -> void;
+
+        /// \returns the number of real samples transformed
+        [[nodiscard]]
+        auto size() const noexcept -> Int64 { return m_size; }
+
+        /// \returns the number of complex bins in a spectrum, from DC to Nyquist
+        [[nodiscard]]
+        auto bins() const noexcept -> Int64 { return m_size / 2 + 1; }
+
+        /// Transform a real signal to its spectrum
+        /// \param[in]  input  `size()` samples
+        /// \param[out] re     `bins()` real parts
+        /// \param[out] im     `bins()` imaginary parts
+        auto forward(const Float *input, Float *re, Float *im) -> void;
+
+        /// Transform a spectrum back to a real signal, scaled by `size()`
+        /// \param[in]  re      `bins()` real parts
+        /// \param[in]  im      `bins()` imaginary parts; those of DC and Nyquist are ignored
+        /// \param[out] output  `size()` samples
+        auto inverse(const Float *re, const Float *im, Float *output) -> void;
+
+    private:
+        /// Complex FFT of `m_size / 2` points in place, loaded in bit-reversed order
+        auto transform(Float *re, Float *im) const -> void;
+
+        Int64 m_size;
+        List<Int64> m_reverse;                   ///< bit-reversed index of each complex point
+        AlignedList<Float, 16> m_twiddleRe;      ///< twiddles of the radix-2 pass of each `half`, from offset `half`
+        AlignedList<Float, 16> m_twiddleIm;
+        AlignedList<Float, 16> m_splitRe;        ///< `exp(-2 pi i k / N)`, splitting the real spectrum
+        AlignedList<Float, 16> m_splitIm;
+        AlignedList<Float, 16> m_workRe, m_workIm;
+    };
+}
+
+KSND_NS_END
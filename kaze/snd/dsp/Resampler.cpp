@@ -0,0 +1,216 @@
+#include "Resampler.h"
+#include "kernels.h"
+
+#include <kaze/core/math/mathf.h>
+#include <kaze/core/memory.h>
+
+#include <array>
+#include <cmath>
+
+KSND_NS_BEGIN
+
+namespace dsp {
+
+    /// Frames kept before the current position, the left half of the sinc window
+    static constexpr Int64 HistoryFrames = ResampleTaps / 2 - 1;
+
+    /// Rates each sinc table is band-limited for; a rate uses the first table at or above it
+    static constexpr Double SincTableRates[] = {1.0, 1.5, 2.0, 3.0};
+    static constexpr Int SincTableCount = static_cast<Int>(std::size(SincTableRates));
+
+    using SincTable = std::array<Float, ResamplePhases * ResampleTaps * 2>;
+
+    /// Blackman-windowed sinc lowpass with its cutoff at `1 / rate` of the input Nyquist, normalized per phase
+    static auto makeSincTable(const Double rate) -> SincTable
+    {
+        constexpr Double Pi = 3.14159265358979323846;
+        constexpr Double HalfWidth = ResampleTaps / 2;
+        const auto cutoff = 1.0 / rate;
+
+        SincTable table{};
+        for (Int phase = 0; phase < ResamplePhases; ++phase)
+        {
+            const auto fraction = static_cast<Double>(phase) / ResamplePhases;
+
+            Double weights[ResampleTaps];
+            Double sum = 0;
+            for (Int tap = 0; tap < ResampleTaps; ++tap)
+            {
+                // Distance of the input frame at `tap` from the output position
+                const auto x = static_cast<Double>(tap - HistoryFrames) - fraction;
+                const auto sinc = x == 0 ? 1.0 : std::sin(Pi * cutoff * x) / (Pi * cutoff * x);
+                const auto window = 0.42 + 0.5 * std::cos(Pi * x / HalfWidth) +
+                    0.08 * std::cos(2.0 * Pi * x / HalfWidth);
+                weights[tap] = sinc * window;
+                sum += weights[tap];
+            }
+
+            auto row = table.data() + phase * ResampleTaps * 2;
+            for (Int tap = 0; tap < ResampleTaps; ++tap)
+            {
+                row[tap * 2] = row[tap * 2 + 1] = static_cast<Float>(weights[tap] / sum);
+            }
+        }
+
+        return table;
+    }
+
+    static auto getSincTable(const Double rate) -> const Float *
+    {
+        static const auto tables = [] {
+            std::array<SincTable, SincTableCount> result;
+            for (Int i = 0; i < SincTableCount; ++i)
+                result[i] = makeSincTable(SincTableRates[i]);
+            return result;
+        }();
+
+        Int i = 0;
+        while (i < SincTableCount - 1 && rate > SincTableRates[i])
+            ++i;
+        return tables[i].data();
+    }
+
+    /// \returns 32.32 fixed-point step for `rate`
+    static auto toStep(const Double rate) -> Uint64
+    {
+        return static_cast<Uint64>(mathf::clamp(rate, Resampler::MinRate, Resampler::MaxRate) * 4294967296.0 + .5);
+    }
+
+    Resampler::Resampler()
+    {
+        getSincTable(1.0); // build the tables now, instead of on the audio thread
+        reset();
+    }
+
+    auto Resampler::reset() -> void
+    {
+        m_input.assign(HistoryFrames * m_channels, 0);
+        m_position = static_cast<Uint64>(HistoryFrames) << 32;
+    }
+
+    auto Resampler::setChannels(const Int channels) -> void
+    {
+        KAZE_ASSERT(channels > 0);
+        m_channels = channels;
+        reset();
+    }
+
+    auto Resampler::reserve(const Int64 maxFrames) -> void
+    {
+        // History and the window's lookahead around the input of the fastest supported rate
+        const auto frames = static_cast<Int64>(std::ceil(static_cast<Double>(maxFrames) * MaxRate)) +
+            ResampleTaps * 2;
+        m_input.reserve(static_cast<Size>(frames * m_channels));
+        m_maxFrames = maxFrames;
+    }
+
+    auto Resampler::getBufferedFrames() const -> Int64
+    {
+        return static_cast<Int64>(m_input.size() / m_channels) - static_cast<Int64>(m_position >> 32);
+    }
+
+    auto Resampler::getInputFramesNeeded(const Int64 frames, const Double rate) const -> Int64
+    {
+        if (frames <= 0)
+            return 0;
+
+        // Frames read past the integer position of the last output frame
+        const Int64 lookahead = m_quality == ResampleQuality::Sinc ? ResampleTaps - HistoryFrames - 1 : 1;
+        const auto last = m_position + static_cast<Uint64>(frames - 1) * toStep(rate);
+        const auto end = static_cast<Int64>(last >> 32) + lookahead + 1;
+        return mathf::max<Int64>(end - static_cast<Int64>(m_input.size() / m_channels), 0);
+    }
+
+    auto Resampler::prepareInput(const Int64 frames) -> Float *
+    {
+        const auto size = m_input.size();
+        KAZE_ASSERT(m_maxFrames == 0 || size + static_cast<Size>(frames * m_channels) <= m_input.capacity(),
+            "resampler input exceeds its reserve; process at most `getMaxFrames` frames at a time");
+        m_input.resize(size + frames * m_channels);
+        return m_input.data() + size;
+    }
+
+    auto Resampler::process(Float *output, const Int64 frames, const Double rate) -> void
+    {
+        const auto step = toStep(rate);
+        const auto channels = m_channels;
+        if (m_quality == ResampleQuality::Sinc)
+        {
+            const auto table = getSincTable(rate);
+            const auto start = m_position - (static_cast<Uint64>(HistoryFrames) << 32);
+            if (channels == 2)
+            {
+                getKernels().resampleStereo(output, frames, m_input.data(), start, step, table);
+            }
+            else
+            {
+                // Same sums as the stereo kernel, reading one tap column of each duplicated table row
+                auto position = start;
+                for (Int64 k = 0; k < frames; ++k, output += channels, position += step)
+                {
+                    const auto x = m_input.data() + (position >> 32) * channels;
+                    const auto row = table + ((position >> (32 - ResamplePhaseBits)) & (ResamplePhases - 1)) *
+                        ResampleTaps * 2;
+                    for (Int c = 0; c < channels; ++c)
+                    {
+                        Float even = x[c] * row[0], odd = x[channels + c] * row[2];
+                        for (Int tap = 2; tap < ResampleTaps; tap += 2)
+                        {
+                            even = even + x[tap * channels + c] * row[tap * 2];
+                            odd = odd + x[(tap + 1) * channels + c] * row[(tap + 1) * 2];
+                        }
+                        output[c] = even + odd;
+                    }
+                }
+            }
+        }
+        else
+        {
+            auto position = m_position;
+            for (Int64 k = 0; k < frames; ++k, output += channels, position += step)
+            {
+                const auto x = m_input.data() + (position >> 32) * channels;
+                const auto fraction = static_cast<Float>(position & 0xFFFFFFFFull) * (1.f / 4294967296.f);
+                for (Int c = 0; c < channels; ++c)
+                    output[c] = x[c] + fraction * (x[channels + c] - x[c]);
+            }
+        }
+
+        m_position += static_cast<Uint64>(frames) * step;
+        dropPassedInput();
+    }
+
+    auto Resampler::drain(Float *output, const Int64 frames) -> Int64
+    {
+        const auto count = mathf::min(getBufferedFrames(), frames);
+        if (count <= 0)
+            return 0;
+
+        const auto frame = static_cast<Int64>(m_position >> 32);
+        memory::copy(output, m_input.data() + frame * m_channels, count * m_channels * sizeof(Float));
+
+        if (count == getBufferedFrames())
+        {
+            reset();
+        }
+        else
+        {
+            m_position = static_cast<Uint64>(frame + count) << 32;
+            dropPassedInput();
+        }
+
+        return count;
+    }
+
+    auto Resampler::dropPassedInput() -> void
+    {
+        const auto passed = static_cast<Int64>(m_position >> 32) - HistoryFrames;
+        if (passed > 0)
+        {
+            m_input.erase(m_input.begin(), m_input.begin() + passed * m_channels);
+            m_position -= static_cast<Uint64>(passed) << 32;
+        }
+    }
+}
+
+KSND_NS_END
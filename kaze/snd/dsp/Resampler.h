@@ -0,0 +1,97 @@
+/// \file Resampler.h
+/// Playback rate conversion of interleaved frames
+#pragma once
+#include <kaze/snd/lib.h>
+
+KSND_NS_BEGIN
+
+/// Interpolation used to play an AudioSource at a pitch other than `1`
+enum class ResampleQuality {
+    Linear, ///< two-point interpolation; cheapest, but dulls high frequencies and aliases when pitched up
+    Sinc,   ///< 16-tap windowed sinc, band-limited to the output rate
+};
+
+namespace dsp {
+
+    /// Streaming resampler holding the input history of one voice. Input is read ahead into the resampler, which
+    /// then produces output frames at any rate, keeping its fractional position from call to call.
+    ///
+    /// Audio thread usage per buffer:
+    /// 1. `getInputFramesNeeded` to learn how much input the next `process` consumes
+    /// 2. `prepareInput` and fill the returned pointer with that many frames
+    /// 3. `process` to render the output
+    class Resampler {
+    public:
+        /// Highest supported rate; input is skipped through faster than this aliases regardless of quality
+        static constexpr Double MaxRate = 4.0;
+
+        /// Lowest supported rate
+        static constexpr Double MinRate = 1.0 / 8.0;
+
+        Resampler();
+
+        /// Discard all buffered input and return to position zero
+        auto reset() -> void;
+
+        /// Set the number of interleaved channels per frame, discarding all buffered input [default: `2`]
+        auto setChannels(Int channels) -> void;
+
+        [[nodiscard]]
+        auto getChannels() const -> Int { return m_channels; }
+
+        /// Reserve input for `process` calls of up to `maxFrames` output frames at any supported rate, so that
+        /// `prepareInput` never allocates on the audio thread. Call after `setChannels`.
+        /// \param[in]  maxFrames  most output frames per `process` call
+        auto reserve(Int64 maxFrames) -> void;
+
+        /// \returns most output frames per `process` call that input is reserved for; `0` if not reserved
+        [[nodiscard]]
+        auto getMaxFrames() const -> Int64 { return m_maxFrames; }
+
+        auto setQuality(ResampleQuality quality) -> void { m_quality = quality; }
+
+        [[nodiscard]]
+        auto getQuality() const -> ResampleQuality { return m_quality; }
+
+        /// \returns number of frames read ahead of the current position, not yet played out
+        [[nodiscard]]
+        auto getBufferedFrames() const -> Int64;
+
+        /// \param[in]  frames  number of output frames to produce
+        /// \param[in]  rate    input frames consumed per output frame
+        /// \returns number of input frames to append with `prepareInput` before calling `process`
+        [[nodiscard]]
+        auto getInputFramesNeeded(Int64 frames, Double rate) const -> Int64;
+
+        /// Make room for more input after the frames already buffered. Stays within the reserved input as long as
+        /// `process` is called with no more than `getMaxFrames` frames.
+        /// \param[in]  frames  number of frames to append
+        /// \returns pointer to write `frames` interleaved frames into
+        auto prepareInput(Int64 frames) -> Float *;
+
+        /// Produce output frames from the buffered input, which must hold `getInputFramesNeeded` frames
+        /// \param[out] output  receives `frames` interleaved frames
+        /// \param[in]  frames  number of output frames to produce
+        /// \param[in]  rate    input frames consumed per output frame, clamped to [`MinRate`, `MaxRate`]
+        auto process(Float *output, Int64 frames, Double rate) -> void;
+
+        /// Copy out buffered input unchanged, snapping to the whole frame at the current position. Lets a voice
+        /// that returns to its original pitch play out what was read ahead, then continue reading directly.
+        /// \param[out] output  receives up to `frames` interleaved frames
+        /// \param[in]  frames  maximum number of frames to copy
+        /// \returns number of frames copied; once everything is played out the resampler is reset.
+        auto drain(Float *output, Int64 frames) -> Int64;
+
+    private:
+        /// Drop input frames that lie entirely behind the history needed at the current position
+        auto dropPassedInput() -> void;
+
+        List<Float> m_input;                          ///< interleaved history, then frames read ahead
+        Uint64 m_position;                            ///< 32.32 fixed-point frame position in `m_input`
+        Int64 m_maxFrames{};                          ///< output frames per `process` that input is reserved for
+        Int m_channels{2};
+        ResampleQuality m_quality{ResampleQuality::Sinc};
+    };
+}
+
+KSND_NS_END
@@ -0,0 +1,1863 @@
+#include "kernels.h"
+#include "private/kernels_scalar.h"
+
+#include <kaze/core/cpu.h>
+#include <kaze/core/intrinsics.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+KSND_NS_BEGIN
+
+namespace dsp {
+
+    // ===== Scalar reference =================================================
+
+    namespace scalar {
+        auto mix(Float *dest, const Float *src, const Int64 count) -> void
+        {
+            for (Int64 i = 0; i < count; ++i)
+                dest[i] += src[i];
+        }
+
+        auto mix4(Float *dest, const Float *a, const Float *b, const Float *c, const Float *d,
+            const Int64 count) -> void
+        {
+            for (Int64 i = 0; i < count; ++i)
+                dest[i] += (a[i] + b[i]) + (c[i] + d[i]);
+        }
+
+        auto scale(const Float *input, Float *output, const Float gain, const Int64 count) -> void
+        {
+            for (Int64 i = 0; i < count; ++i)
+                output[i] = input[i] * gain;
+        }
+
+        auto pan(const Float *input, Float *output, const Float left, const Float right, const Int64 count) -> void
+        {
+            const auto invLeft = 1.f - left, invRight = 1.f - right;
+            for (Int64 i = 0; i + 1 < count; i += 2)
+            {
+                const auto inL = input[i], inR = input[i + 1];
+                output[i]     = inR * invRight + inL * left;
+                output[i + 1] = inL * invLeft + inR * right;
+            }
+        }
+
+        auto delay(const Float *input, Float *output, Float *buffer, const Float dry, const Float wet,
+            const Float feedback, const Int64 count) -> void
+        {
+            for (Int64 i = 0; i < count; ++i)
+            {
+                const auto in = input[i];
+                output[i] = in * dry + buffer[i] * wet;
+                buffer[i] = in * feedback;
+            }
+        }
+
+        auto fade(Float *samples, const Int64 frames, const Int channels, const Int64 offset, const Float start,
+            const Float slope) -> void
+        {
+            for (Int64 k = 0; k < frames; ++k, samples += channels)
+            {
+                const auto gain = slope * static_cast<Float>(offset + k) + start;
+                for (Int c = 0; c < channels; ++c)
+                    samples[c] *= gain;
+            }
+        }
+
+        auto mixMatrix(Float *dest, const Int destChannels, const Float *src, const Int srcChannels,
+            const Float *matrix, const Int64 frames) -> void
+        {
+            for (Int64 k = 0; k < frames; ++k, dest += destChannels, src += srcChannels)
+            {
+                for (Int out = 0; out < destChannels; ++out)
+                {
+                    const auto gains = matrix + out * srcChannels;
+                    auto sum = src[0] * gains[0];
+                    for (Int in = 1; in < srcChannels; ++in)
+                        sum = sum + src[in] * gains[in];
+                    dest[out] += sum;
+                }
+            }
+        }
+
+        auto getMixColumns(const Float *matrix, const Int srcChannels, const Int destChannels,
+            Float (*columns)[MaxChannels]) -> void
+        {
+            for (Int in = 0; in < srcChannels; ++in)
+            {
+                for (Int out = 0; out < MaxChannels; ++out)
+                    columns[in][out] = out < destChannels ? matrix[out * srcChannels + in] : 0;
+            }
+        }
+
+        auto resampleStereo(Float *output, const Int64 frames, const Float *input, Uint64 position,
+            const Uint64 step, const Float *table) -> void
+        {
+            for (Int64 k = 0; k < frames; ++k, output += 2, position += step)
+            {
+                const auto x = input + (position >> 32) * 2;
+                const auto w = table + ((position >> (32 - ResamplePhaseBits)) & (ResamplePhases - 1)) *
+                    ResampleTaps * 2;
+
+                // Even and odd taps in separate sums, like the lanes of a 4-wide vector
+                auto left0 = x[0] * w[0], right0 = x[1] * w[1], left1 = x[2] * w[2], right1 = x[3] * w[3];
+                for (Int t = 4; t < ResampleTaps * 2; t += 4)
+                {
+                    left0 = left0 + x[t] * w[t];
+                    right0 = right0 + x[t + 1] * w[t + 1];
+                    left1 = left1 + x[t + 2] * w[t + 2];
+                    right1 = right1 + x[t + 3] * w[t + 3];
+                }
+
+                output[0] = left0 + left1;
+                output[1] = right0 + right1;
+            }
+        }
+
+        auto biquad(Float *samples, const Int64 frames, const Int channels, const BiquadCoefs *coefs,
+            const Int stages, Float *state) -> void
+        {
+            // Sections run one after another over the whole buffer, which gives the same result as running every
+            // section per frame
+            for (Int s = 0; s < stages; ++s)
+            {
+                const auto &c = coefs[s];
+                for (Int ch = 0; ch < channels; ++ch)
+                {
+                    auto z1 = state[s * channels * 2 + ch], z2 = state[s * channels * 2 + channels + ch];
+                    for (Int64 k = 0; k < frames; ++k)
+                    {
+                        const auto x = samples[k * channels + ch];
+                        const auto y = c.b0 * x + z1;
+                        z1 = (c.b1 * x + z2) - c.a1 * y;
+                        z2 = c.b2 * x - c.a2 * y;
+                        samples[k * channels + ch] = y;
+                    }
+
+                    state[s * channels * 2 + ch] = z1;
+                    state[s * channels * 2 + channels + ch] = z2;
+                }
+            }
+
+            flushBiquadState(state, static_cast<Int64>(stages) * channels * 2);
+        }
+
+        auto flushBiquadState(Float *state, const Int64 count) -> void
+        {
+            for (Int64 i = 0; i < count; ++i)
+            {
+                if (state[i] < FlushThreshold && state[i] > -FlushThreshold)
+                    state[i] = 0;
+            }
+        }
+
+        static auto flush(const Float value) -> Float
+        {
+            return (value < FlushThreshold && value > -FlushThreshold) ? 0 : value;
+        }
+
+        /// Sum one value per network line, in the order documented by `Kernels::fdn`
+        static auto sumLines(const Float *v) -> Float
+        {
+            return ((v[0] + v[4]) + (v[2] + v[6])) + ((v[1] + v[5]) + (v[3] + v[7]));
+        }
+
+        auto fdn(const Float *input, Float *left, Float *right, const Int64 frames, FdnState *state) -> void
+        {
+            static_assert(FdnLines == 8);
+            const auto mask = state->mask;
+            auto position = state->position;
+            auto lowpass = state->lowpass;
+
+            for (Int64 k = 0; k < frames; ++k)
+            {
+                for (Int i = 0; i < FdnLines; ++i)
+                {
+                    const auto delayed = state->lines[((position - state->delays[i]) & mask) * FdnLines + i];
+                    lowpass[i] = flush(delayed + (lowpass[i] - delayed) * state->damping);
+                }
+
+                const auto feedback = sumLines(lowpass) * (2.f / FdnLines);
+                const auto frame = state->lines + position * FdnLines;
+                Float wetLeft[FdnLines], wetRight[FdnLines];
+                for (Int i = 0; i < FdnLines; ++i)
+                {
+                    frame[i] = flush((lowpass[i] - feedback) * state->feedbackGains[i] +
+                        input[k] * state->inputGains[i]);
+                    wetLeft[i] = lowpass[i] * state->leftGains[i];
+                    wetRight[i] = lowpass[i] * state->rightGains[i];
+                }
+
+                left[k] = sumLines(wetLeft);
+                right[k] = sumLines(wetRight);
+                position = (position + 1) & mask;
+            }
+
+            state->position = position;
+        }
+
+        auto peak(const Float *samples, Float *peaks, const Int64 frames, const Int channels) -> void
+        {
+            for (Int64 k = 0; k < frames; ++k)
+            {
+                auto level = 0.f;
+                for (Int ch = 0; ch < channels; ++ch)
+                    level = std::max(level, std::abs(samples[k * channels + ch]));
+                peaks[k] = level;
+            }
+        }
+
+        auto spatializeFrom(const SpatialEmitters &emitters, const SpatialListener &listener, Float *left,
+            Float *right, const Int64 first) -> void
+        {
+            for (Int64 i = first; i < emitters.count; ++i)
+            {
+                const auto dx = (emitters.x[i] + emitters.velocityX[i] * listener.time) - listener.x;
+                const auto dy = (emitters.y[i] + emitters.velocityY[i] * listener.time) - listener.y;
+                const auto distanceSquared = dx * dx + dy * dy;
+                const auto distance = std::sqrt(distanceSquared);
+
+                const auto lateral = dx * listener.rightX + dy * listener.rightY;
+                const auto pan = std::min(std::max(lateral / std::max(distance, emitters.radius[i]), -1.f), 1.f);
+
+                const auto measured = emitters.squared[i] != 0 ? distanceSquared : distance;
+                const auto over = std::min(std::max(measured, emitters.inner[i]), emitters.outer[i]) -
+                    emitters.inner[i];
+                const auto gain = std::max(
+                    1.f - emitters.rolloff[i] * over / (emitters.offset[i] + emitters.slope[i] * over), 0.f);
+
+                left[i] = gain * std::sqrt((1.f - pan) * .5f);
+                right[i] = gain * std::sqrt((1.f + pan) * .5f);
+            }
+        }
+
+        auto spatialize(const SpatialEmitters &emitters, const SpatialListener &listener, Float *left,
+            Float *right) -> void
+        {
+            spatializeFrom(emitters, listener, left, right, 0);
+        }
+
+        auto mixPanned(Float *dest, const Int destChannels, const Float *src, const Int srcChannels,
+            const Int64 frames, const Int64 offset, const Float left, const Float right, const Float leftSlope,
+            const Float rightSlope) -> void
+        {
+            for (Int64 k = 0; k < frames; ++k, dest += destChannels, src += srcChannels)
+            {
+                const auto index = static_cast<Float>(offset + k);
+                dest[0] += src[0] * (leftSlope * index + left);
+                dest[1] += src[srcChannels - 1] * (rightSlope * index + right);
+            }
+        }
+
+        auto fftPass(Float *re, Float *im, const Float *twiddleRe, const Float *twiddleIm, const Int64 half,
+            const Int64 size) -> void
+        {
+            for (Int64 b = 0; b < size; b += half * 2)
+            {
+                for (Int64 j = 0; j < half; ++j)
+                {
+                    const auto xr = re[b + half + j], xi = im[b + half + j];
+                    const auto tr = xr * twiddleRe[j] - xi * twiddleIm[j];
+                    const auto ti = xr * twiddleIm[j] + xi * twiddleRe[j];
+                    re[b + half + j] = re[b + j] - tr;
+                    im[b + half + j] = im[b + j] - ti;
+                    re[b + j] += tr;
+                    im[b + j] += ti;
+                }
+            }
+        }
+
+        auto spectrumMac(Float *accRe, Float *accIm, const Float *aRe, const Float *aIm, const Float *bRe,
+            const Float *bIm, const Int64 bins) -> void
+        {
+            for (Int64 k = 0; k < bins; ++k)
+            {
+                accRe[k] += aRe[k] * bRe[k] - aIm[k] * bIm[k];
+                accIm[k] += aRe[k] * bIm[k] + aIm[k] * bRe[k];
+            }
+        }
+
+        auto truePeak(const Float *samples, const Int64 count, const Float *coefs) -> Float
+        {
+            auto level = 0.f;
+            for (Int64 k = 0; k < count; ++k)
+            {
+                for (Int p = 0; p < TruePeakPhases; ++p)
+                {
+                    auto sum = samples[k] * coefs[p];
+                    for (Int t = 1; t < TruePeakTaps; ++t)
+                        sum += samples[k + t] * coefs[t * TruePeakPhases + p];
+                    level = std::max(level, std::abs(sum));
+                }
+            }
+
+            return level;
+        }
+
+        static constexpr Kernels kernels = {
+            .mix = mix,
+            .mix4 = mix4,
+            .scale = scale,
+            .pan = pan,
+            .delay = delay,
+            .fade = fade,
+            .mixMatrix = mixMatrix,
+            .resampleStereo = resampleStereo,
+            .biquad = biquad,
+            .fdn = fdn,
+            .peak = peak,
+            .spatialize = spatialize,
+            .mixPanned = mixPanned,
+            .fftPass = fftPass,
+            .spectrumMac = spectrumMac,
+            .truePeak = truePeak,
+        };
+    }
+
+    // ===== Baseline SIMD ====================================================
+
+#if KAZE_CPU_SSE
+    namespace sse {
+        static auto mix(Float *dest, const Float *src, const Int64 count) -> void
+        {
+            Int64 i = 0;
+            for (; i <= count - 16; i += 16)
+            {
+                _mm_storeu_ps(dest + i,      _mm_add_ps(_mm_loadu_ps(dest + i),      _mm_loadu_ps(src + i)));
+                _mm_storeu_ps(dest + i + 4,  _mm_add_ps(_mm_loadu_ps(dest + i + 4),  _mm_loadu_ps(src + i + 4)));
+                _mm_storeu_ps(dest + i + 8,  _mm_add_ps(_mm_loadu_ps(dest + i + 8),  _mm_loadu_ps(src + i + 8)));
+                _mm_storeu_ps(dest + i + 12, _mm_add_ps(_mm_loadu_ps(dest + i + 12), _mm_loadu_ps(src + i + 12)));
+            }
+
+            scalar::mix(dest + i, src + i, count - i);
+        }
+
+        static auto mix4(Float *dest, const Float *a, const Float *b, const Float *c, const Float *d,
+            const Int64 count) -> void
+        {
+            Int64 i = 0;
+            for (; i <= count - 8; i += 8)
+            {
+                const auto sample0 = _mm_add_ps(
+                    _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)),
+                    _mm_add_ps(_mm_loadu_ps(c + i), _mm_loadu_ps(d + i)));
+                const auto sample1 = _mm_add_ps(
+                    _mm_add_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)),
+                    _mm_add_ps(_mm_loadu_ps(c + i + 4), _mm_loadu_ps(d + i + 4)));
+
+                _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), sample0));
+                _mm_storeu_ps(dest + i + 4, _mm_add_ps(_mm_loadu_ps(dest + i + 4), sample1));
+            }
+
+            scalar::mix4(dest + i, a + i, b + i, c + i, d + i, count - i);
+        }
+
+        static auto scale(const Float *input, Float *output, const Float gain, const Int64 count) -> void
+        {
+            const auto gains = _mm_set1_ps(gain);
+            Int64 i = 0;
+            for (; i <= count - 16; i += 16)
+            {
+                const auto a = _mm_loadu_ps(input + i);
+                const auto b = _mm_loadu_ps(input + i + 4);
+                const auto c = _mm_loadu_ps(input + i + 8);
+                const auto d = _mm_loadu_ps(input + i + 12);
+                _mm_storeu_ps(output + i, _mm_mul_ps(a, gains));
+                _mm_storeu_ps(output + i + 4, _mm_mul_ps(b, gains));
+                _mm_storeu_ps(output + i + 8, _mm_mul_ps(c, gains));
+                _mm_storeu_ps(output + i + 12, _mm_mul_ps(d, gains));
+            }
+
+            scalar::scale(input + i, output + i, gain, count - i);
+        }
+
+        static auto pan(const Float *input, Float *output, const Float left, const Float right,
+            const Int64 count) -> void
+        {
+            const auto a = _mm_set_ps(1.f - left, 1.f - right, 1.f - left, 1.f - right); // reverse order
+            const auto b = _mm_set_ps(right, left, right, left);
+            Int64 i = 0;
+            for (; i <= count - 8; i += 8)
+            {
+                const auto in0 = _mm_loadu_ps(input + i);
+                const auto in1 = _mm_loadu_ps(input + i + 4);
+                const auto swapped0 = _mm_shuffle_ps(in0, in0, _MM_SHUFFLE(2, 3, 0, 1)); // R L R L
+                const auto swapped1 = _mm_shuffle_ps(in1, in1, _MM_SHUFFLE(2, 3, 0, 1));
+                _mm_storeu_ps(output + i, _mm_add_ps(_mm_mul_ps(swapped0, a), _mm_mul_ps(in0, b)));
+                _mm_storeu_ps(output + i + 4, _mm_add_ps(_mm_mul_ps(swapped1, a), _mm_mul_ps(in1, b)));
+            }
+
+            scalar::pan(input + i, output + i, left, right, count - i);
+        }
+
+        static auto delay(const Float *input, Float *output, Float *buffer, const Float dry, const Float wet,
+            const Float feedback, const Int64 count) -> void
+        {
+            const auto dryVec = _mm_set1_ps(dry);
+            const auto wetVec = _mm_set1_ps(wet);
+            const auto feedbackVec = _mm_set1_ps(feedback);
+            Int64 i = 0;
+            for (; i <= count - 8; i += 8)
+            {
+                const auto input0 = _mm_loadu_ps(input + i);
+                const auto input1 = _mm_loadu_ps(input + i + 4);
+                const auto buffer0 = _mm_loadu_ps(buffer + i);
+                const auto buffer1 = _mm_loadu_ps(buffer + i + 4);
+
+                _mm_storeu_ps(output + i, _mm_add_ps(_mm_mul_ps(input0, dryVec), _mm_mul_ps(buffer0, wetVec)));
+                _mm_storeu_ps(output + i + 4, _mm_add_ps(_mm_mul_ps(input1, dryVec), _mm_mul_ps(buffer1, wetVec)));
+                _mm_storeu_ps(buffer + i, _mm_mul_ps(input0, feedbackVec));
+                _mm_storeu_ps(buffer + i + 4, _mm_mul_ps(input1, feedbackVec));
+            }
+
+            scalar::delay(input + i, output + i, buffer + i, dry, wet, feedback, count - i);
+        }
+
+        static auto fade(Float *samples, const Int64 frames, const Int channels, const Int64 offset,
+            const Float start, const Float slope) -> void
+        {
+            const auto startVec = _mm_set1_ps(start);
+            const auto slopeVec = _mm_set1_ps(slope);
+
+            Int64 k = 0;
+            if (channels == 1)
+            {
+                const auto frameIndex = _mm_set_epi32(3, 2, 1, 0);
+                for (; k <= frames - 4; k += 4, samples += 4)
+                {
+                    const auto index = _mm_cvtepi32_ps(
+                        _mm_add_epi32(_mm_set1_epi32(static_cast<Int>(offset + k)), frameIndex));
+                    const auto gains = _mm_add_ps(_mm_mul_ps(slopeVec, index), startVec);
+                    _mm_storeu_ps(samples, _mm_mul_ps(_mm_loadu_ps(samples), gains));
+                }
+            }
+            else if (channels == 2)
+            {
+                const auto frameIndex0 = _mm_set_epi32(1, 1, 0, 0); // two stereo frames per vector
+                const auto frameIndex1 = _mm_set_epi32(3, 3, 2, 2);
+                for (; k <= frames - 4; k += 4, samples += 8)
+                {
+                    const auto base = _mm_set1_epi32(static_cast<Int>(offset + k));
+                    const auto index0 = _mm_cvtepi32_ps(_mm_add_epi32(base, frameIndex0));
+                    const auto index1 = _mm_cvtepi32_ps(_mm_add_epi32(base, frameIndex1));
+                    const auto gains0 = _mm_add_ps(_mm_mul_ps(slopeVec, index0), startVec);
+                    const auto gains1 = _mm_add_ps(_mm_mul_ps(slopeVec, index1), startVec);
+                    _mm_storeu_ps(samples, _mm_mul_ps(_mm_loadu_ps(samples), gains0));
+                    _mm_storeu_ps(samples + 4, _mm_mul_ps(_mm_loadu_ps(samples + 4), gains1));
+                }
+            }
+
+            scalar::fade(samples, frames - k, channels, offset + k, start, slope);
+        }
+
+        static auto mixMatrix(Float *dest, const Int destChannels, const Float *src, const Int srcChannels,
+            const Float *matrix, const Int64 frames) -> void
+        {
+            Int64 k = 0;
+            if (srcChannels == 1 && destChannels == 2)
+            {
+                const auto gains = _mm_set_ps(matrix[1], matrix[0], matrix[1], matrix[0]);
+                for (; k <= frames - 4; k += 4, src += 4, dest += 8)
+                {
+                    const auto in = _mm_loadu_ps(src);
+                    const auto frames01 = _mm_mul_ps(_mm_unpacklo_ps(in, in), gains); // s0 s0 s1 s1
+                    const auto frames23 = _mm_mul_ps(_mm_unpackhi_ps(in, in), gains);
+                    _mm_storeu_ps(dest, _mm_add_ps(_mm_loadu_ps(dest), frames01));
+                    _mm_storeu_ps(dest + 4, _mm_add_ps(_mm_loadu_ps(dest + 4), frames23));
+                }
+            }
+            else if (srcChannels == 2 && destChannels == 1)
+            {
+                const auto gains = _mm_set_ps(matrix[1], matrix[0], matrix[1], matrix[0]);
+                for (; k <= frames - 4; k += 4, src += 8, dest += 4)
+                {
+                    const auto products01 = _mm_mul_ps(_mm_loadu_ps(src), gains);
+                    const auto products23 = _mm_mul_ps(_mm_loadu_ps(src + 4), gains);
+                    const auto left = _mm_shuffle_ps(products01, products23, _MM_SHUFFLE(2, 0, 2, 0));
+                    const auto right = _mm_shuffle_ps(products01, products23, _MM_SHUFFLE(3, 1, 3, 1));
+                    _mm_storeu_ps(dest, _mm_add_ps(_mm_loadu_ps(dest), _mm_add_ps(left, right)));
+                }
+            }
+            else if (scalar::isMixedInLanes(srcChannels, destChannels))
+            {
+                // One frame at a time, output channels in lanes
+                alignas(16) Float columns[2][MaxChannels];
+                scalar::getMixColumns(matrix, srcChannels, destChannels, columns);
+                const auto low0 = _mm_load_ps(columns[0]), high0 = _mm_load_ps(columns[0] + 4);
+                const auto low1 = _mm_load_ps(columns[1]), high1 = _mm_load_ps(columns[1] + 4);
+                for (; k < frames; ++k, src += srcChannels, dest += destChannels)
+                {
+                    const auto in0 = _mm_set1_ps(src[0]);
+                    auto low = _mm_mul_ps(in0, low0), high = _mm_mul_ps(in0, high0);
+                    if (srcChannels == 2)
+                    {
+                        const auto in1 = _mm_set1_ps(src[1]);
+                        low = _mm_add_ps(low, _mm_mul_ps(in1, low1));
+                        high = _mm_add_ps(high, _mm_mul_ps(in1, high1));
+                    }
+
+                    _mm_storeu_ps(dest, _mm_add_ps(_mm_loadu_ps(dest), low));
+                    if (destChannels == 8)
+                    {
+                        _mm_storeu_ps(dest + 4, _mm_add_ps(_mm_loadu_ps(dest + 4), high));
+                    }
+                    else if (destChannels == 6) // only the low pair, keeping clear of the next frame
+                    {
+                        const auto pair = reinterpret_cast<__m64 *>(dest + 4);
+                        _mm_storel_pi(pair, _mm_add_ps(_mm_loadl_pi(_mm_setzero_ps(), pair), high));
+                    }
+                }
+            }
+
+            scalar::mixMatrix(dest, destChannels, src, srcChannels, matrix, frames - k);
+        }
+
+        static auto resampleStereo(Float *output, const Int64 frames, const Float *input, Uint64 position,
+            const Uint64 step, const Float *table) -> void
+        {
+            for (Int64 k = 0; k < frames; ++k, output += 2, position += step)
+            {
+                const auto x = input + (position >> 32) * 2;
+                const auto w = table + ((position >> (32 - ResamplePhaseBits)) & (ResamplePhases - 1)) *
+                    ResampleTaps * 2;
+
+                auto sum = _mm_mul_ps(_mm_loadu_ps(x), _mm_loadu_ps(w)); // L0 R0 L1 R1
+                for (Int t = 4; t < ResampleTaps * 2; t += 4)
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(x + t), _mm_loadu_ps(w + t)));
+
+                _mm_storel_pi(reinterpret_cast<__m64 *>(output), _mm_add_ps(sum, _mm_movehl_ps(sum, sum)));
+            }
+        }
+
+        /// One transposed direct form II section on the left and right channel in the low lanes
+        static auto biquadSection(__m128 &x, const __m128 *c, __m128 &z1, __m128 &z2) -> void
+        {
+            const auto y = _mm_add_ps(_mm_mul_ps(c[0], x), z1);
+            z1 = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(c[1], x), z2), _mm_mul_ps(c[3], y));
+            z2 = _mm_sub_ps(_mm_mul_ps(c[2], x), _mm_mul_ps(c[4], y));
+            x = y;
+        }
+
+        /// Stereo cascade of a fixed number of sections, unrolled so that every section's state stays in
+        /// registers
+        template <Int... Stage>
+        static auto biquadStereo(Float *samples, const Int64 frames, const BiquadCoefs *coefs, Float *state,
+            std::integer_sequence<Int, Stage...>) -> void
+        {
+            const auto splat = [](const BiquadCoefs &c) -> std::array<__m128, 5> {
+                return {_mm_set1_ps(c.b0), _mm_set1_ps(c.b1), _mm_set1_ps(c.b2), _mm_set1_ps(c.a1),
+                    _mm_set1_ps(c.a2)};
+            };
+            const std::array<__m128, 5> c[] = {splat(coefs[Stage])...};
+            __m128 z1[] = {_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(state + Stage * 4))...};
+            __m128 z2[] = {_mm_loadl_pi(_mm_setzero_ps(),
+                reinterpret_cast<const __m64 *>(state + Stage * 4 + 2))...};
+
+            for (Int64 k = 0; k < frames; ++k)
+            {
+                const auto frame = reinterpret_cast<__m64 *>(samples + k * 2);
+                auto x = _mm_loadl_pi(_mm_setzero_ps(), frame);
+                (biquadSection(x, c[Stage].data(), z1[Stage], z2[Stage]), ...);
+                _mm_storel_pi(frame, x);
+            }
+
+            (_mm_storel_pi(reinterpret_cast<__m64 *>(state + Stage * 4), z1[Stage]), ...);
+            (_mm_storel_pi(reinterpret_cast<__m64 *>(state + Stage * 4 + 2), z2[Stage]), ...);
+        }
+
+        auto biquad(Float *samples, const Int64 frames, const Int channels, const BiquadCoefs *coefs,
+            const Int stages, Float *state) -> void
+        {
+            if (channels != 2)
+            {
+                scalar::biquad(samples, frames, channels, coefs, stages, state);
+                return;
+            }
+
+            switch (stages)
+            {
+            case 1: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 1>()); break;
+            case 2: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 2>()); break;
+            case 3: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 3>()); break;
+            case 4: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 4>()); break;
+            case 5: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 5>()); break;
+            case 6: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 6>()); break;
+            case 7: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 7>()); break;
+            case 8: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 8>()); break;
+            default: break;
+            }
+            static_assert(MaxBiquadStages == 8);
+            scalar::flushBiquadState(state, static_cast<Int64>(stages) * 4);
+        }
+
+        /// Zero lanes below `FlushThreshold` in magnitude
+        static auto flush(const __m128 v) -> __m128
+        {
+            const auto magnitude = _mm_andnot_ps(_mm_set1_ps(-0.f), v);
+            return _mm_and_ps(v, _mm_cmpge_ps(magnitude, _mm_set1_ps(FlushThreshold)));
+        }
+
+        /// Sum the eight lanes of two vectors, in the order of `scalar::sumLines`
+        static auto sumLines(const __m128 a, const __m128 b) -> Float
+        {
+            const auto pairs = _mm_add_ps(a, b);                                // 0+4 1+5 2+6 3+7
+            const auto halves = _mm_add_ps(pairs, _mm_movehl_ps(pairs, pairs)); // (0+4)+(2+6) (1+5)+(3+7)
+            return _mm_cvtss_f32(halves) + _mm_cvtss_f32(_mm_shuffle_ps(halves, halves, _MM_SHUFFLE(1, 1, 1, 1)));
+        }
+
+        auto fdn(const Float *input, Float *left, Float *right, const Int64 frames, FdnState *state) -> void
+        {
+            const auto lines = state->lines;
+            const auto mask = state->mask;
+            const auto &delays = state->delays;
+            auto position = state->position;
+
+            const auto inputA = _mm_loadu_ps(state->inputGains), inputB = _mm_loadu_ps(state->inputGains + 4);
+            const auto gainA = _mm_loadu_ps(state->feedbackGains), gainB = _mm_loadu_ps(state->feedbackGains + 4);
+            const auto leftA = _mm_loadu_ps(state->leftGains), leftB = _mm_loadu_ps(state->leftGains + 4);
+            const auto rightA = _mm_loadu_ps(state->rightGains), rightB = _mm_loadu_ps(state->rightGains + 4);
+            const auto damping = _mm_set1_ps(state->damping);
+            const auto scale = _mm_set1_ps(2.f / FdnLines);
+            auto lowpassA = _mm_loadu_ps(state->lowpass), lowpassB = _mm_loadu_ps(state->lowpass + 4);
+
+            for (Int64 k = 0; k < frames; ++k)
+            {
+                const auto read = [&](const Int i) { return lines[((position - delays[i]) & mask) * FdnLines + i]; };
+                const auto delayedA = _mm_setr_ps(read(0), read(1), read(2), read(3));
+                const auto delayedB = _mm_setr_ps(read(4), read(5), read(6), read(7));
+                lowpassA = flush(_mm_add_ps(delayedA, _mm_mul_ps(_mm_sub_ps(lowpassA, delayedA), damping)));
+                lowpassB = flush(_mm_add_ps(delayedB, _mm_mul_ps(_mm_sub_ps(lowpassB, delayedB), damping)));
+
+                const auto feedback = _mm_mul_ps(_mm_set1_ps(sumLines(lowpassA, lowpassB)), scale);
+                const auto x = _mm_set1_ps(input[k]);
+                const auto frame = lines + position * FdnLines;
+                _mm_storeu_ps(frame, flush(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(lowpassA, feedback), gainA),
+                    _mm_mul_ps(x, inputA))));
+                _mm_storeu_ps(frame + 4, flush(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(lowpassB, feedback), gainB),
+                    _mm_mul_ps(x, inputB))));
+
+                left[k] = sumLines(_mm_mul_ps(lowpassA, leftA), _mm_mul_ps(lowpassB, leftB));
+                right[k] = sumLines(_mm_mul_ps(lowpassA, rightA), _mm_mul_ps(lowpassB, rightB));
+                position = (position + 1) & mask;
+            }
+
+            _mm_storeu_ps(state->lowpass, lowpassA);
+            _mm_storeu_ps(state->lowpass + 4, lowpassB);
+            state->position = position;
+        }
+
+        static auto peak(const Float *samples, Float *peaks, const Int64 frames, const Int channels) -> void
+        {
+            const auto sign = _mm_set1_ps(-0.f);
+            Int64 k = 0;
+            if (channels == 1)
+            {
+                for (; k <= frames - 4; k += 4)
+                    _mm_storeu_ps(peaks + k, _mm_andnot_ps(sign, _mm_loadu_ps(samples + k)));
+            }
+            else if (channels == 2)
+            {
+                for (; k <= frames - 4; k += 4)
+                {
+                    const auto a = _mm_andnot_ps(sign, _mm_loadu_ps(samples + k * 2));     // L0 R0 L1 R1
+                    const auto b = _mm_andnot_ps(sign, _mm_loadu_ps(samples + k * 2 + 4)); // L2 R2 L3 R3
+                    _mm_storeu_ps(peaks + k, _mm_max_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)),
+                        _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+                }
+            }
+
+            scalar::peak(samples + k * channels, peaks + k, frames - k, channels);
+        }
+
+        auto spatialize(const SpatialEmitters &emitters, const SpatialListener &listener, Float *left,
+            Float *right) -> void
+        {
+            const auto time = _mm_set1_ps(listener.time);
+            const auto listenerX = _mm_set1_ps(listener.x), listenerY = _mm_set1_ps(listener.y);
+            const auto rightX = _mm_set1_ps(listener.rightX), rightY = _mm_set1_ps(listener.rightY);
+            const auto one = _mm_set1_ps(1.f), minusOne = _mm_set1_ps(-1.f), half = _mm_set1_ps(.5f);
+            const auto zero = _mm_setzero_ps();
+
+            Int64 i = 0;
+            for (; i <= emitters.count - 4; i += 4)
+            {
+                const auto dx = _mm_sub_ps(_mm_add_ps(_mm_loadu_ps(emitters.x + i),
+                    _mm_mul_ps(_mm_loadu_ps(emitters.velocityX + i), time)), listenerX);
+                const auto dy = _mm_sub_ps(_mm_add_ps(_mm_loadu_ps(emitters.y + i),
+                    _mm_mul_ps(_mm_loadu_ps(emitters.velocityY + i), time)), listenerY);
+                const auto distanceSquared = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+                const auto distance = _mm_sqrt_ps(distanceSquared);
+
+                const auto lateral = _mm_add_ps(_mm_mul_ps(dx, rightX), _mm_mul_ps(dy, rightY));
+                const auto pan = _mm_min_ps(_mm_max_ps(_mm_div_ps(lateral,
+                    _mm_max_ps(distance, _mm_loadu_ps(emitters.radius + i))), minusOne), one);
+
+                const auto isSquared = _mm_cmpneq_ps(_mm_loadu_ps(emitters.squared + i), zero);
+                const auto measured = _mm_or_ps(_mm_and_ps(isSquared, distanceSquared),
+                    _mm_andnot_ps(isSquared, distance));
+                const auto inner = _mm_loadu_ps(emitters.inner + i);
+                const auto over = _mm_sub_ps(_mm_min_ps(_mm_max_ps(measured, inner),
+                    _mm_loadu_ps(emitters.outer + i)), inner);
+                const auto gain = _mm_max_ps(_mm_sub_ps(one, _mm_div_ps(_mm_mul_ps(_mm_loadu_ps(emitters.rolloff + i),
+                    over), _mm_add_ps(_mm_loadu_ps(emitters.offset + i), _mm_mul_ps(_mm_loadu_ps(emitters.slope + i),
+                    over)))), zero);
+
+                _mm_storeu_ps(left + i, _mm_mul_ps(gain, _mm_sqrt_ps(_mm_mul_ps(_mm_sub_ps(one, pan), half))));
+                _mm_storeu_ps(right + i, _mm_mul_ps(gain, _mm_sqrt_ps(_mm_mul_ps(_mm_add_ps(one, pan), half))));
+            }
+
+            scalar::spatializeFrom(emitters, listener, left, right, i);
+        }
+
+        auto mixPanned(Float *dest, const Int destChannels, const Float *src, const Int srcChannels,
+            const Int64 frames, const Int64 offset, const Float left, const Float right, const Float leftSlope,
+            const Float rightSlope) -> void
+        {
+            Int64 k = 0;
+            if (destChannels == 2 && srcChannels == 1)
+            {
+                const auto leftVec = _mm_set1_ps(left), rightVec = _mm_set1_ps(right);
+                const auto leftSlopeVec = _mm_set1_ps(leftSlope), rightSlopeVec = _mm_set1_ps(rightSlope);
+                const auto frameIndex = _mm_set_epi32(3, 2, 1, 0);
+                for (; k <= frames - 4; k += 4, src += 4, dest += 8)
+                {
+                    const auto index = _mm_cvtepi32_ps(
+                        _mm_add_epi32(_mm_set1_epi32(static_cast<Int>(offset + k)), frameIndex));
+                    const auto in = _mm_loadu_ps(src);
+                    const auto l = _mm_mul_ps(in, _mm_add_ps(_mm_mul_ps(leftSlopeVec, index), leftVec));
+                    const auto r = _mm_mul_ps(in, _mm_add_ps(_mm_mul_ps(rightSlopeVec, index), rightVec));
+                    _mm_storeu_ps(dest, _mm_add_ps(_mm_loadu_ps(dest), _mm_unpacklo_ps(l, r)));
+                    _mm_storeu_ps(dest + 4, _mm_add_ps(_mm_loadu_ps(dest + 4), _mm_unpackhi_ps(l, r)));
+                }
+            }
+            else if (destChannels == 2 && srcChannels == 2)
+            {
+                const auto starts = _mm_set_ps(right, left, right, left);
+                const auto slopes = _mm_set_ps(rightSlope, leftSlope, rightSlope, leftSlope);
+                const auto frameIndex0 = _mm_set_epi32(1, 1, 0, 0); // two stereo frames per vector
+                const auto frameIndex1 = _mm_set_epi32(3, 3, 2, 2);
+                for (; k <= frames - 4; k += 4, src += 8, dest += 8)
+                {
+                    const auto base = _mm_set1_epi32(static_cast<Int>(offset + k));
+                    const auto gains0 = _mm_add_ps(_mm_mul_ps(slopes,
+                        _mm_cvtepi32_ps(_mm_add_epi32(base, frameIndex0))), starts);
+                    const auto gains1 = _mm_add_ps(_mm_mul_ps(slopes,
+                        _mm_cvtepi32_ps(_mm_add_epi32(base, frameIndex1))), starts);
+                    _mm_storeu_ps(dest, _mm_add_ps(_mm_loadu_ps(dest), _mm_mul_ps(_mm_loadu_ps(src), gains0)));
+                    _mm_storeu_ps(dest + 4, _mm_add_ps(_mm_loadu_ps(dest + 4),
+                        _mm_mul_ps(_mm_loadu_ps(src + 4), gains1)));
+                }
+            }
+
+            scalar::mixPanned(dest, destChannels, src, srcChannels, frames - k, offset + k, left, right, leftSlope,
+                rightSlope);
+        }
+
+        auto fftPass(Float *re, Float *im, const Float *twiddleRe, const Float *twiddleIm, const Int64 half,
+            const Int64 size) -> void
+        {
+            if (half < 4)
+            {
+                scalar::fftPass(re, im, twiddleRe, twiddleIm, half, size);
+                return;
+            }
+
+            for (Int64 b = 0; b < size; b += half * 2)
+            {
+                for (Int64 j = 0; j < half; j += 4)
+                {
+                    const auto xr = _mm_loadu_ps(re + b + half + j), xi = _mm_loadu_ps(im + b + half + j);
+                    const auto wr = _mm_loadu_ps(twiddleRe + j), wi = _mm_loadu_ps(twiddleIm + j);
+                    const auto tr = _mm_sub_ps(_mm_mul_ps(xr, wr), _mm_mul_ps(xi, wi));
+                    const auto ti = _mm_add_ps(_mm_mul_ps(xr, wi), _mm_mul_ps(xi, wr));
+                    const auto ur = _mm_loadu_ps(re + b + j), ui = _mm_loadu_ps(im + b + j);
+                    _mm_storeu_ps(re + b + half + j, _mm_sub_ps(ur, tr));
+                    _mm_storeu_ps(im + b + half + j, _mm_sub_ps(ui, ti));
+                    _mm_storeu_ps(re + b + j, _mm_add_ps(ur, tr));
+                    _mm_storeu_ps(im + b + j, _mm_add_ps(ui, ti));
+                }
+            }
+        }
+
+        static auto spectrumMac(Float *accRe, Float *accIm, const Float *aRe, const Float *aIm, const Float *bRe,
+            const Float *bIm, const Int64 bins) -> void
+        {
+            Int64 k = 0;
+            for (; k <= bins - 4; k += 4)
+            {
+                const auto ar = _mm_loadu_ps(aRe + k), ai = _mm_loadu_ps(aIm + k);
+                const auto br = _mm_loadu_ps(bRe + k), bi = _mm_loadu_ps(bIm + k);
+                _mm_storeu_ps(accRe + k, _mm_add_ps(_mm_loadu_ps(accRe + k),
+                    _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi))));
+                _mm_storeu_ps(accIm + k, _mm_add_ps(_mm_loadu_ps(accIm + k),
+                    _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br))));
+            }
+
+            scalar::spectrumMac(accRe + k, accIm + k, aRe + k, aIm + k, bRe + k, bIm + k, bins - k);
+        }
+
+        auto truePeak(const Float *samples, const Int64 count, const Float *coefs) -> Float
+        {
+            const auto sign = _mm_set1_ps(-0.f);
+            __m128 taps[TruePeakTaps];
+            for (Int t = 0; t < TruePeakTaps; ++t)
+                taps[t] = _mm_loadu_ps(coefs + t * TruePeakPhases);
+
+            auto levels = _mm_setzero_ps();
+            for (Int64 k = 0; k < count; ++k)
+            {
+                auto sum = _mm_mul_ps(_mm_set1_ps(samples[k]), taps[0]);
+                for (Int t = 1; t < TruePeakTaps; ++t)
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(samples[k + t]), taps[t]));
+                levels = _mm_max_ps(levels, _mm_andnot_ps(sign, sum));
+            }
+
+            alignas(16) Float lanes[4];
+            _mm_store_ps(lanes, levels);
+            return std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+        }
+
+        static constexpr Kernels kernels = {
+            .mix = mix,
+            .mix4 = mix4,
+            .scale = scale,
+            .pan = pan,
+            .delay = delay,
+            .fade = fade,
+            .mixMatrix = mixMatrix,
+            .resampleStereo = resampleStereo,
+            .biquad = biquad,
+            .fdn = fdn,
+            .peak = peak,
+            .spatialize = spatialize,
+            .mixPanned = mixPanned,
+            .fftPass = fftPass,
+            .spectrumMac = spectrumMac,
+            .truePeak = truePeak,
+        };
+    }
+#elif KAZE_CPU_WASM_SIMD
+    namespace wasm {
+        static auto mix(Float *dest, const Float *src, const Int64 count) -> void
+        {
+            Int64 i = 0;
+            for (; i <= count - 8; i += 8)
+            {
+                wasm_v128_store(dest + i, wasm_f32x4_add(wasm_v128_load(dest + i), wasm_v128_load(src + i)));
+                wasm_v128_store(dest + i + 4,
+                    wasm_f32x4_add(wasm_v128_load(dest + i + 4), wasm_v128_load(src + i + 4)));
+            }
+
+            scalar::mix(dest + i, src + i, count - i);
+        }
+
+        static auto mix4(Float *dest, const Float *a, const Float *b, const Float *c, const Float *d,
+            const Int64 count) -> void
+        {
+            Int64 i = 0;
+            for (; i <= count - 8; i += 8)
+            {
+                const auto sample0 = wasm_f32x4_add(
+                    wasm_f32x4_add(wasm_v128_load(a + i), wasm_v128_load(b + i)),
+                    wasm_f32x4_add(wasm_v128_load(c + i), wasm_v128_load(d + i)));
+                const auto sample1 = wasm_f32x4_add(
+                    wasm_f32x4_add(wasm_v128_load(a + i + 4), wasm_v128_load(b + i + 4)),
+                    wasm_f32x4_add(wasm_v128_load(c + i + 4), wasm_v128_load(d + i + 4)));
+
+                wasm_v128_store(dest + i, wasm_f32x4_add(wasm_v128_load(dest + i), sample0));
+                wasm_v128_store(dest + i + 4, wasm_f32x4_add(wasm_v128_load(dest + i + 4), sample1));
+            }
+
+            scalar::mix4(dest + i, a + i, b + i, c + i, d + i, count - i);
+        }
+
+        static auto scale(const Float *input, Float *output, const Float gain, const Int64 count) -> void
+        {
+            const auto gains = wasm_f32x4_splat(gain);
+            Int64 i = 0;
+            for (; i <= count - 8; i += 8)
+            {
+                wasm_v128_store(output + i, wasm_f32x4_mul(wasm_v128_load(input + i), gains));
+                wasm_v128_store(output + i + 4, wasm_f32x4_mul(wasm_v128_load(input + i + 4), gains));
+            }
+
+            scalar::scale(input + i, output + i, gain, count - i);
+        }
+
+        static auto pan(const Float *input, Float *output, const Float left, const Float right,
+            const Int64 count) -> void
+        {
+            const auto a = wasm_f32x4_make(1.f - right, 1.f - left, 1.f - right, 1.f - left);
+            const auto b = wasm_f32x4_make(left, right, left, right);
+            Int64 i = 0;
+            for (; i <= count - 4; i += 4)
+            {
+                const auto in = wasm_v128_load(input + i);
+                const auto swapped = wasm_i32x4_shuffle(in, in, 1, 0, 3, 2); // R L R L
+                wasm_v128_store(output + i, wasm_f32x4_add(wasm_f32x4_mul(swapped, a), wasm_f32x4_mul(in, b)));
+            }
+
+            scalar::pan(input + i, output + i, left, right, count - i);
+        }
+
+        static auto delay(const Float *input, Float *output, Float *buffer, const Float dry, const Float wet,
+            const Float feedback, const Int64 count) -> void
+        {
+            const auto dryVec = wasm_f32x4_splat(dry);
+            const auto wetVec = wasm_f32x4_splat(wet);
+            const auto feedbackVec = wasm_f32x4_splat(feedback);
+            Int64 i = 0;
+            for (; i <= count - 4; i += 4)
+            {
+                const auto in = wasm_v128_load(input + i);
+                const auto buf = wasm_v128_load(buffer + i);
+                wasm_v128_store(output + i, wasm_f32x4_add(wasm_f32x4_mul(in, dryVec), wasm_f32x4_mul(buf, wetVec)));
+                wasm_v128_store(buffer + i, wasm_f32x4_mul(in, feedbackVec));
+            }
+
+            scalar::delay(input + i, output + i, buffer + i, dry, wet, feedback, count - i);
+        }
+
+        static auto fade(Float *samples, const Int64 frames, const Int channels, const Int64 offset,
+            const Float start, const Float slope) -> void
+        {
+            const auto startVec = wasm_f32x4_splat(start);
+            const auto slopeVec = wasm_f32x4_splat(slope);
+
+            Int64 k = 0;
+            if (channels == 1 || channels == 2)
+            {
+                const auto frameIndex = channels == 1 ? wasm_i32x4_make(0, 1, 2, 3) : wasm_i32x4_make(0, 0, 1, 1);
+                const auto framesPerVector = 4 / channels;
+                for (; k <= frames - framesPerVector; k += framesPerVector, samples += 4)
+                {
+                    const auto index = wasm_i32x4_add(wasm_i32x4_splat(static_cast<Int>(offset + k)), frameIndex);
+                    const auto gains = wasm_f32x4_add(wasm_f32x4_mul(slopeVec, wasm_f32x4_convert_i32x4(index)),
+                        startVec);
+                    wasm_v128_store(samples, wasm_f32x4_mul(wasm_v128_load(samples), gains));
+                }
+            }
+
+            scalar::fade(samples, frames - k, channels, offset + k, start, slope);
+        }
+
+        static auto mixMatrix(Float *dest, const Int destChannels, const Float *src, const Int srcChannels,
+            const Float *matrix, const Int64 frames) -> void
+        {
+            Int64 k = 0;
+            if (srcChannels == 1 && destChannels == 2)
+            {
+                const auto gains = wasm_f32x4_make(matrix[0], matrix[1], matrix[0], matrix[1]);
+                for (; k <= frames - 4; k += 4, src += 4, dest += 8)
+                {
+                    const auto in = wasm_v128_load(src);
+                    const auto frames01 = wasm_f32x4_mul(wasm_i32x4_shuffle(in, in, 0, 0, 1, 1), gains);
+                    const auto frames23 = wasm_f32x4_mul(wasm_i32x4_shuffle(in, in, 2, 2, 3, 3), gains);
+                    wasm_v128_store(dest, wasm_f32x4_add(wasm_v128_load(dest), frames01));
+                    wasm_v128_store(dest + 4, wasm_f32x4_add(wasm_v128_load(dest + 4), frames23));
+                }
+            }
+            else if (srcChannels == 2 && destChannels == 1)
+            {
+                const auto gains = wasm_f32x4_make(matrix[0], matrix[1], matrix[0], matrix[1]);
+                for (; k <= frames - 4; k += 4, src += 8, dest += 4)
+                {
+                    const auto products01 = wasm_f32x4_mul(wasm_v128_load(src), gains);
+                    const auto products23 = wasm_f32x4_mul(wasm_v128_load(src + 4), gains);
+                    const auto left = wasm_i32x4_shuffle(products01, products23, 0, 2, 4, 6);
+                    const auto right = wasm_i32x4_shuffle(products01, products23, 1, 3, 5, 7);
+                    wasm_v128_store(dest, wasm_f32x4_add(wasm_v128_load(dest), wasm_f32x4_add(left, right)));
+                }
+            }
+            else if (scalar::isMixedInLanes(srcChannels, destChannels))
+            {
+                // One frame at a time, output channels in lanes
+                alignas(16) Float columns[2][MaxChannels];
+                scalar::getMixColumns(matrix, srcChannels, destChannels, columns);
+                const auto low0 = wasm_v128_load(columns[0]), high0 = wasm_v128_load(columns[0] + 4);
+                const auto low1 = wasm_v128_load(columns[1]), high1 = wasm_v128_load(columns[1] + 4);
+                for (; k < frames; ++k, src += srcChannels, dest += destChannels)
+                {
+                    const auto in0 = wasm_f32x4_splat(src[0]);
+                    auto low = wasm_f32x4_mul(in0, low0), high = wasm_f32x4_mul(in0, high0);
+                    if (srcChannels == 2)
+                    {
+                        const auto in1 = wasm_f32x4_splat(src[1]);
+                        low = wasm_f32x4_add(low, wasm_f32x4_mul(in1, low1));
+                        high = wasm_f32x4_add(high, wasm_f32x4_mul(in1, high1));
+                    }
+
+                    wasm_v128_store(dest, wasm_f32x4_add(wasm_v128_load(dest), low));
+                    if (destChannels == 8)
+                    {
+                        wasm_v128_store(dest + 4, wasm_f32x4_add(wasm_v128_load(dest + 4), high));
+                    }
+                    else if (destChannels == 6) // only the low pair, keeping clear of the next frame
+                    {
+                        wasm_v128_store64_lane(dest + 4,
+                            wasm_f32x4_add(wasm_v128_load64_zero(dest + 4), high), 0);
+                    }
+                }
+            }
+
+            scalar::mixMatrix(dest, destChannels, src, srcChannels, matrix, frames - k);
+        }
+
+        static auto resampleStereo(Float *output, const Int64 frames, const Float *input, Uint64 position,
+            const Uint64 step, const Float *table) -> void
+        {
+            for (Int64 k = 0; k < frames; ++k, output += 2, position += step)
+            {
+                const auto x = input + (position >> 32) * 2;
+                const auto w = table + ((position >> (32 - ResamplePhaseBits)) & (ResamplePhases - 1)) *
+                    ResampleTaps * 2;
+
+                auto sum = wasm_f32x4_mul(wasm_v128_load(x), wasm_v128_load(w)); // L0 R0 L1 R1
+                for (Int t = 4; t < ResampleTaps * 2; t += 4)
+                    sum = wasm_f32x4_add(sum, wasm_f32x4_mul(wasm_v128_load(x + t), wasm_v128_load(w + t)));
+
+                wasm_v128_store64_lane(output, wasm_f32x4_add(sum, wasm_i32x4_shuffle(sum, sum, 2, 3, 2, 3)), 0);
+            }
+        }
+
+        /// One transposed direct form II section on the left and right channel in the low lanes
+        static auto biquadSection(v128_t &x, const v128_t *c, v128_t &z1, v128_t &z2) -> void
+        {
+            const auto y = wasm_f32x4_add(wasm_f32x4_mul(c[0], x), z1);
+            z1 = wasm_f32x4_sub(wasm_f32x4_add(wasm_f32x4_mul(c[1], x), z2), wasm_f32x4_mul(c[3], y));
+            z2 = wasm_f32x4_sub(wasm_f32x4_mul(c[2], x), wasm_f32x4_mul(c[4], y));
+            x = y;
+        }
+
+        /// Stereo cascade of a fixed number of sections, unrolled so that every section's state stays in
+        /// registers
+        template <Int... Stage>
+        static auto biquadStereo(Float *samples, const Int64 frames, const BiquadCoefs *coefs, Float *state,
+            std::integer_sequence<Int, Stage...>) -> void
+        {
+            const auto splat = [](const BiquadCoefs &c) -> std::array<v128_t, 5> {
+                return {wasm_f32x4_splat(c.b0), wasm_f32x4_splat(c.b1), wasm_f32x4_splat(c.b2),
+                    wasm_f32x4_splat(c.a1), wasm_f32x4_splat(c.a2)};
+            };
+            const std::array<v128_t, 5> c[] = {splat(coefs[Stage])...};
+            v128_t z1[] = {wasm_v128_load64_zero(state + Stage * 4)...};
+            v128_t z2[] = {wasm_v128_load64_zero(state + Stage * 4 + 2)...};
+
+            for (Int64 k = 0; k < frames; ++k)
+            {
+                auto x = wasm_v128_load64_zero(samples + k * 2);
+                (biquadSection(x, c[Stage].data(), z1[Stage], z2[Stage]), ...);
+                wasm_v128_store64_lane(samples + k * 2, x, 0);
+            }
+
+            (wasm_v128_store64_lane(state + Stage * 4, z1[Stage], 0), ...);
+            (wasm_v128_store64_lane(state + Stage * 4 + 2, z2[Stage], 0), ...);
+        }
+
+        static auto biquad(Float *samples, const Int64 frames, const Int channels, const BiquadCoefs *coefs,
+            const Int stages, Float *state) -> void
+        {
+            if (channels != 2)
+            {
+                scalar::biquad(samples, frames, channels, coefs, stages, state);
+                return;
+            }
+
+            switch (stages)
+            {
+            case 1: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 1>()); break;
+            case 2: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 2>()); break;
+            case 3: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 3>()); break;
+            case 4: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 4>()); break;
+            case 5: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 5>()); break;
+            case 6: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 6>()); break;
+            case 7: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 7>()); break;
+            case 8: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 8>()); break;
+            default: break;
+            }
+            static_assert(MaxBiquadStages == 8);
+            scalar::flushBiquadState(state, static_cast<Int64>(stages) * 4);
+        }
+
+        /// Zero lanes below `FlushThreshold` in magnitude
+        static auto flush(const v128_t v) -> v128_t
+        {
+            return wasm_v128_and(v, wasm_f32x4_ge(wasm_f32x4_abs(v), wasm_f32x4_splat(FlushThreshold)));
+        }
+
+        /// Sum the eight lanes of two vectors, in the order of `scalar::sumLines`
+        static auto sumLines(const v128_t a, const v128_t b) -> Float
+        {
+            const auto pairs = wasm_f32x4_add(a, b);                                            // 0+4 1+5 2+6 3+7
+            const auto halves = wasm_f32x4_add(pairs, wasm_i32x4_shuffle(pairs, pairs, 2, 3, 2, 3));
+            return wasm_f32x4_extract_lane(halves, 0) + wasm_f32x4_extract_lane(halves, 1);
+        }
+
+        static auto fdn(const Float *input, Float *left, Float *right, const Int64 frames, FdnState *state) -> void
+        {
+            const auto lines = state->lines;
+            const auto mask = state->mask;
+            const auto &delays = state->delays;
+            auto position = state->position;
+
+            const auto inputA = wasm_v128_load(state->inputGains), inputB = wasm_v128_load(state->inputGains + 4);
+            const auto gainA = wasm_v128_load(state->feedbackGains);
+            const auto gainB = wasm_v128_load(state->feedbackGains + 4);
+            const auto leftA = wasm_v128_load(state->leftGains), leftB = wasm_v128_load(state->leftGains + 4);
+            const auto rightA = wasm_v128_load(state->rightGains), rightB = wasm_v128_load(state->rightGains + 4);
+            const auto damping = wasm_f32x4_splat(state->damping);
+            const auto scale = wasm_f32x4_splat(2.f / FdnLines);
+            auto lowpassA = wasm_v128_load(state->lowpass), lowpassB = wasm_v128_load(state->lowpass + 4);
+
+            for (Int64 k = 0; k < frames; ++k)
+            {
+                const auto read = [&](const Int i) { return lines[((position - delays[i]) & mask) * FdnLines + i]; };
+                const auto delayedA = wasm_f32x4_make(read(0), read(1), read(2), read(3));
+                const auto delayedB = wasm_f32x4_make(read(4), read(5), read(6), read(7));
+                lowpassA = flush(wasm_f32x4_add(delayedA,
+                    wasm_f32x4_mul(wasm_f32x4_sub(lowpassA, delayedA), damping)));
+                lowpassB = flush(wasm_f32x4_add(delayedB,
+                    wasm_f32x4_mul(wasm_f32x4_sub(lowpassB, delayedB), damping)));
+
+                const auto feedback = wasm_f32x4_mul(wasm_f32x4_splat(sumLines(lowpassA, lowpassB)), scale);
+                const auto x = wasm_f32x4_splat(input[k]);
+                const auto frame = lines + position * FdnLines;
+                wasm_v128_store(frame, flush(wasm_f32x4_add(
+                    wasm_f32x4_mul(wasm_f32x4_sub(lowpassA, feedback), gainA), wasm_f32x4_mul(x, inputA))));
+                wasm_v128_store(frame + 4, flush(wasm_f32x4_add(
+                    wasm_f32x4_mul(wasm_f32x4_sub(lowpassB, feedback), gainB), wasm_f32x4_mul(x, inputB))));
+
+                left[k] = sumLines(wasm_f32x4_mul(lowpassA, leftA), wasm_f32x4_mul(lowpassB, leftB));
+                right[k] = sumLines(wasm_f32x4_mul(lowpassA, rightA), wasm_f32x4_mul(lowpassB, rightB));
+                position = (position + 1) & mask;
+            }
+
+            wasm_v128_store(state->lowpass, lowpassA);
+            wasm_v128_store(state->lowpass + 4, lowpassB);
+            state->position = position;
+        }
+
+        static auto peak(const Float *samples, Float *peaks, const Int64 frames, const Int channels) -> void
+        {
+            Int64 k = 0;
+            if (channels == 1)
+            {
+                for (; k <= frames - 4; k += 4)
+                    wasm_v128_store(peaks + k, wasm_f32x4_abs(wasm_v128_load(samples + k)));
+            }
+            else if (channels == 2)
+            {
+                for (; k <= frames - 4; k += 4)
+                {
+                    const auto a = wasm_f32x4_abs(wasm_v128_load(samples + k * 2));     // L0 R0 L1 R1
+                    const auto b = wasm_f32x4_abs(wasm_v128_load(samples + k * 2 + 4)); // L2 R2 L3 R3
+                    wasm_v128_store(peaks + k, wasm_f32x4_max(wasm_i32x4_shuffle(a, b, 0, 2, 4, 6),
+                        wasm_i32x4_shuffle(a, b, 1, 3, 5, 7)));
+                }
+            }
+
+            scalar::peak(samples + k * channels, peaks + k, frames - k, channels);
+        }
+
+        static auto spatialize(const SpatialEmitters &emitters, const SpatialListener &listener, Float *left,
+            Float *right) -> void
+        {
+            const auto time = wasm_f32x4_splat(listener.time);
+            const auto listenerX = wasm_f32x4_splat(listener.x), listenerY = wasm_f32x4_splat(listener.y);
+            const auto rightX = wasm_f32x4_splat(listener.rightX), rightY = wasm_f32x4_splat(listener.rightY);
+            const auto one = wasm_f32x4_splat(1.f), minusOne = wasm_f32x4_splat(-1.f);
+            const auto half = wasm_f32x4_splat(.5f), zero = wasm_f32x4_splat(0);
+
+            // `pmin` and `pmax` pick operands as `std::min` and `std::max` do
+            Int64 i = 0;
+            for (; i <= emitters.count - 4; i += 4)
+            {
+                const auto dx = wasm_f32x4_sub(wasm_f32x4_add(wasm_v128_load(emitters.x + i),
+                    wasm_f32x4_mul(wasm_v128_load(emitters.velocityX + i), time)), listenerX);
+                const auto dy = wasm_f32x4_sub(wasm_f32x4_add(wasm_v128_load(emitters.y + i),
+                    wasm_f32x4_mul(wasm_v128_load(emitters.velocityY + i), time)), listenerY);
+                const auto distanceSquared = wasm_f32x4_add(wasm_f32x4_mul(dx, dx), wasm_f32x4_mul(dy, dy));
+                const auto distance = wasm_f32x4_sqrt(distanceSquared);
+
+                const auto lateral = wasm_f32x4_add(wasm_f32x4_mul(dx, rightX), wasm_f32x4_mul(dy, rightY));
+                const auto pan = wasm_f32x4_pmin(wasm_f32x4_pmax(wasm_f32x4_div(lateral,
+                    wasm_f32x4_pmax(distance, wasm_v128_load(emitters.radius + i))), minusOne), one);
+
+                const auto isSquared = wasm_f32x4_ne(wasm_v128_load(emitters.squared + i), zero);
+                const auto measured = wasm_v128_bitselect(distanceSquared, distance, isSquared);
+                const auto inner = wasm_v128_load(emitters.inner + i);
+                const auto over = wasm_f32x4_sub(wasm_f32x4_pmin(wasm_f32x4_pmax(measured, inner),
+                    wasm_v128_load(emitters.outer + i)), inner);
+                const auto gain = wasm_f32x4_pmax(wasm_f32x4_sub(one, wasm_f32x4_div(
+                    wasm_f32x4_mul(wasm_v128_load(emitters.rolloff + i), over),
+                    wasm_f32x4_add(wasm_v128_load(emitters.offset + i),
+                        wasm_f32x4_mul(wasm_v128_load(emitters.slope + i), over)))), zero);
+
+                wasm_v128_store(left + i, wasm_f32x4_mul(gain,
+                    wasm_f32x4_sqrt(wasm_f32x4_mul(wasm_f32x4_sub(one, pan), half))));
+                wasm_v128_store(right + i, wasm_f32x4_mul(gain,
+                    wasm_f32x4_sqrt(wasm_f32x4_mul(wasm_f32x4_add(one, pan), half))));
+            }
+
+            scalar::spatializeFrom(emitters, listener, left, right, i);
+        }
+
+        static auto mixPanned(Float *dest, const Int destChannels, const Float *src, const Int srcChannels,
+            const Int64 frames, const Int64 offset, const Float left, const Float right, const Float leftSlope,
+            const Float rightSlope) -> void
+        {
+            Int64 k = 0;
+            if (destChannels == 2 && srcChannels == 1)
+            {
+                const auto leftVec = wasm_f32x4_splat(left), rightVec = wasm_f32x4_splat(right);
+                const auto leftSlopeVec = wasm_f32x4_splat(leftSlope), rightSlopeVec = wasm_f32x4_splat(rightSlope);
+                const auto frameIndex = wasm_i32x4_make(0, 1, 2, 3);
+                for (; k <= frames - 4; k += 4, src += 4, dest += 8)
+                {
+                    const auto index = wasm_f32x4_convert_i32x4(
+                        wasm_i32x4_add(wasm_i32x4_splat(static_cast<Int>(offset + k)), frameIndex));
+                    const auto in = wasm_v128_load(src);
+                    const auto l = wasm_f32x4_mul(in, wasm_f32x4_add(wasm_f32x4_mul(leftSlopeVec, index), leftVec));
+                    const auto r = wasm_f32x4_mul(in,
+                        wasm_f32x4_add(wasm_f32x4_mul(rightSlopeVec, index), rightVec));
+                    wasm_v128_store(dest, wasm_f32x4_add(wasm_v128_load(dest), wasm_i32x4_shuffle(l, r, 0, 4, 1, 5)));
+                    wasm_v128_store(dest + 4,
+                        wasm_f32x4_add(wasm_v128_load(dest + 4), wasm_i32x4_shuffle(l, r, 2, 6, 3, 7)));
+                }
+            }
+            else if (destChannels == 2 && srcChannels == 2)
+            {
+                const auto starts = wasm_f32x4_make(left, right, left, right);
+                const auto slopes = wasm_f32x4_make(leftSlope, rightSlope, leftSlope, rightSlope);
+                const auto frameIndex0 = wasm_i32x4_make(0, 0, 1, 1); // two stereo frames per vector
+                const auto frameIndex1 = wasm_i32x4_make(2, 2, 3, 3);
+                for (; k <= frames - 4; k += 4, src += 8, dest += 8)
+                {
+                    const auto base = wasm_i32x4_splat(static_cast<Int>(offset + k));
+                    const auto gains0 = wasm_f32x4_add(wasm_f32x4_mul(slopes,
+                        wasm_f32x4_convert_i32x4(wasm_i32x4_add(base, frameIndex0))), starts);
+                    const auto gains1 = wasm_f32x4_add(wasm_f32x4_mul(slopes,
+                        wasm_f32x4_convert_i32x4(wasm_i32x4_add(base, frameIndex1))), starts);
+                    wasm_v128_store(dest, wasm_f32x4_add(wasm_v128_load(dest),
+                        wasm_f32x4_mul(wasm_v128_load(src), gains0)));
+                    wasm_v128_store(dest + 4, wasm_f32x4_add(wasm_v128_load(dest + 4),
+                        wasm_f32x4_mul(wasm_v128_load(src + 4), gains1)));
+                }
+            }
+
+            scalar::mixPanned(dest, destChannels, src, srcChannels, frames - k, offset + k, left, right, leftSlope,
+                rightSlope);
+        }
+
+        static auto fftPass(Float *re, Float *im, const Float *twiddleRe, const Float *twiddleIm,
+            const Int64 half, const Int64 size) -> void
+        {
+            if (half < 4)
+            {
+                scalar::fftPass(re, im, twiddleRe, twiddleIm, half, size);
+                return;
+            }
+
+            for (Int64 b = 0; b < size; b += half * 2)
+            {
+                for (Int64 j = 0; j < half; j += 4)
+                {
+                    const auto xr = wasm_v128_load(re + b + half + j), xi = wasm_v128_load(im + b + half + j);
+                    const auto wr = wasm_v128_load(twiddleRe + j), wi = wasm_v128_load(twiddleIm + j);
+                    const auto tr = wasm_f32x4_sub(wasm_f32x4_mul(xr, wr), wasm_f32x4_mul(xi, wi));
+                    const auto ti = wasm_f32x4_add(wasm_f32x4_mul(xr, wi), wasm_f32x4_mul(xi, wr));
+                    const auto ur = wasm_v128_load(re + b + j), ui = wasm_v128_load(im + b + j);
+                    wasm_v128_store(re + b + half + j, wasm_f32x4_sub(ur, tr));
+                    wasm_v128_store(im + b + half + j, wasm_f32x4_sub(ui, ti));
+                    wasm_v128_store(re + b + j, wasm_f32x4_add(ur, tr));
+                    wasm_v128_store(im + b + j, wasm_f32x4_add(ui, ti));
+                }
+            }
+        }
+
+        static auto spectrumMac(Float *accRe, Float *accIm, const Float *aRe, const Float *aIm, const Float *bRe,
+            const Float *bIm, const Int64 bins) -> void
+        {
+            Int64 k = 0;
+            for (; k <= bins - 4; k += 4)
+            {
+                const auto ar = wasm_v128_load(aRe + k), ai = wasm_v128_load(aIm + k);
+                const auto br = wasm_v128_load(bRe + k), bi = wasm_v128_load(bIm + k);
+                wasm_v128_store(accRe + k, wasm_f32x4_add(wasm_v128_load(accRe + k),
+                    wasm_f32x4_sub(wasm_f32x4_mul(ar, br), wasm_f32x4_mul(ai, bi))));
+                wasm_v128_store(accIm + k, wasm_f32x4_add(wasm_v128_load(accIm + k),
+                    wasm_f32x4_add(wasm_f32x4_mul(ar, bi), wasm_f32x4_mul(ai, br))));
+            }
+
+            scalar::spectrumMac(accRe + k, accIm + k, aRe + k, aIm + k, bRe + k, bIm + k, bins - k);
+        }
+
+        static auto truePeak(const Float *samples, const Int64 count, const Float *coefs) -> Float
+        {
+            v128_t taps[TruePeakTaps];
+            for (Int t = 0; t < TruePeakTaps; ++t)
+                taps[t] = wasm_v128_load(coefs + t * TruePeakPhases);
+
+            auto levels = wasm_f32x4_splat(0);
+            for (Int64 k = 0; k < count; ++k)
+            {
+                auto sum = wasm_f32x4_mul(wasm_f32x4_splat(samples[k]), taps[0]);
+                for (Int t = 1; t < TruePeakTaps; ++t)
+                    sum = wasm_f32x4_add(sum, wasm_f32x4_mul(wasm_f32x4_splat(samples[k + t]), taps[t]));
+                levels = wasm_f32x4_max(levels, wasm_f32x4_abs(sum));
+            }
+
+            return std::max(std::max(wasm_f32x4_extract_lane(levels, 0), wasm_f32x4_extract_lane(levels, 1)),
+                std::max(wasm_f32x4_extract_lane(levels, 2), wasm_f32x4_extract_lane(levels, 3)));
+        }
+
+        static constexpr Kernels kernels = {
+            .mix = mix,
+            .mix4 = mix4,
+            .scale = scale,
+            .pan = pan,
+            .delay = delay,
+            .fade = fade,
+            .mixMatrix = mixMatrix,
+            .resampleStereo = resampleStereo,
+            .biquad = biquad,
+            .fdn = fdn,
+            .peak = peak,
+            .spatialize = spatialize,
+            .mixPanned = mixPanned,
+            .fftPass = fftPass,
+            .spectrumMac = spectrumMac,
+            .truePeak = truePeak,
+        };
+    }
+#elif KAZE_CPU_ARM_NEON
+    namespace neon {
+        static auto mix(Float *dest, const Float *src, const Int64 count) -> void
+        {
+            Int64 i = 0;
+            for (; i <= count - 8; i += 8)
+            {
+                vst1q_f32(dest + i, vaddq_f32(vld1q_f32(dest + i), vld1q_f32(src + i)));
+                vst1q_f32(dest + i + 4, vaddq_f32(vld1q_f32(dest + i + 4), vld1q_f32(src + i + 4)));
+            }
+
+            scalar::mix(dest + i, src + i, count - i);
+        }
+
+        static auto mix4(Float *dest, const Float *a, const Float *b, const Float *c, const Float *d,
+            const Int64 count) -> void
+        {
+            Int64 i = 0;
+            for (; i <= count - 8; i += 8)
+            {
+                const auto sample0 = vaddq_f32(
+                    vaddq_f32(vld1q_f32(a + i), vld1q_f32(b + i)),
+                    vaddq_f32(vld1q_f32(c + i), vld1q_f32(d + i)));
+                const auto sample1 = vaddq_f32(
+                    vaddq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4)),
+                    vaddq_f32(vld1q_f32(c + i + 4), vld1q_f32(d + i + 4)));
+
+                vst1q_f32(dest + i, vaddq_f32(vld1q_f32(dest + i), sample0));
+                vst1q_f32(dest + i + 4, vaddq_f32(vld1q_f32(dest + i + 4), sample1));
+            }
+
+            scalar::mix4(dest + i, a + i, b + i, c + i, d + i, count - i);
+        }
+
+        static auto scale(const Float *input, Float *output, const Float gain, const Int64 count) -> void
+        {
+            const auto gains = vdupq_n_f32(gain);
+            Int64 i = 0;
+            for (; i <= count - 8; i += 8)
+            {
+                vst1q_f32(output + i, vmulq_f32(vld1q_f32(input + i), gains));
+                vst1q_f32(output + i + 4, vmulq_f32(vld1q_f32(input + i + 4), gains));
+            }
+
+            scalar::scale(input + i, output + i, gain, count - i);
+        }
+
+        static auto pan(const Float *input, Float *output, const Float left, const Float right,
+            const Int64 count) -> void
+        {
+            const float32x4_t a { 1.f - right, 1.f - left, 1.f - right, 1.f - left };
+            const float32x4_t b { left, right, left, right };
+            Int64 i = 0;
+            for (; i <= count - 4; i += 4)
+            {
+                const auto in = vld1q_f32(input + i);
+                const auto swapped = vrev64q_f32(in); // R L R L
+                vst1q_f32(output + i, vaddq_f32(vmulq_f32(swapped, a), vmulq_f32(in, b)));
+            }
+
+            scalar::pan(input + i, output + i, left, right, count - i);
+        }
+
+        static auto delay(const Float *input, Float *output, Float *buffer, const Float dry, const Float wet,
+            const Float feedback, const Int64 count) -> void
+        {
+            const auto dryVec = vdupq_n_f32(dry);
+            const auto wetVec = vdupq_n_f32(wet);
+            const auto feedbackVec = vdupq_n_f32(feedback);
+            Int64 i = 0;
+            for (; i <= count - 4; i += 4)
+            {
+                const auto in = vld1q_f32(input + i);
+                const auto buf = vld1q_f32(buffer + i);
+                vst1q_f32(output + i, vaddq_f32(vmulq_f32(in, dryVec), vmulq_f32(buf, wetVec)));
+                vst1q_f32(buffer + i, vmulq_f32(in, feedbackVec));
+            }
+
+            scalar::delay(input + i, output + i, buffer + i, dry, wet, feedback, count - i);
+        }
+
+        static auto fade(Float *samples, const Int64 frames, const Int channels, const Int64 offset,
+            const Float start, const Float slope) -> void
+        {
+            const auto startVec = vdupq_n_f32(start);
+            const auto slopeVec = vdupq_n_f32(slope);
+
+            Int64 k = 0;
+            if (channels == 1 || channels == 2)
+            {
+                const int32x4_t monoIndex { 0, 1, 2, 3 };
+                const int32x4_t stereoIndex { 0, 0, 1, 1 };
+                const auto frameIndex = channels == 1 ? monoIndex : stereoIndex;
+                const auto framesPerVector = 4 / channels;
+                for (; k <= frames - framesPerVector; k += framesPerVector, samples += 4)
+                {
+                    const auto index = vaddq_s32(vdupq_n_s32(static_cast<Int>(offset + k)), frameIndex);
+                    const auto gains = vaddq_f32(vmulq_f32(slopeVec, vcvtq_f32_s32(index)), startVec);
+                    vst1q_f32(samples, vmulq_f32(vld1q_f32(samples), gains));
+                }
+            }
+
+            scalar::fade(samples, frames - k, channels, offset + k, start, slope);
+        }
+
+        static auto mixMatrix(Float *dest, const Int destChannels, const Float *src, const Int srcChannels,
+            const Float *matrix, const Int64 frames) -> void
+        {
+            Int64 k = 0;
+            if (srcChannels == 1 && destChannels == 2)
+            {
+                const float32x4_t gains { matrix[0], matrix[1], matrix[0], matrix[1] };
+                for (; k <= frames - 4; k += 4, src += 4, dest += 8)
+                {
+                    const auto in = vld1q_f32(src);
+                    const auto pairs = vzipq_f32(in, in); // s0 s0 s1 s1, s2 s2 s3 s3
+                    vst1q_f32(dest, vaddq_f32(vld1q_f32(dest), vmulq_f32(pairs.val[0], gains)));
+                    vst1q_f32(dest + 4, vaddq_f32(vld1q_f32(dest + 4), vmulq_f32(pairs.val[1], gains)));
+                }
+            }
+            else if (srcChannels == 2 && destChannels == 1)
+            {
+                for (; k <= frames - 4; k += 4, src += 8, dest += 4)
+                {
+                    const auto in = vld2q_f32(src); // deinterleaved left and right
+                    const auto sum = vaddq_f32(vmulq_n_f32(in.val[0], matrix[0]), vmulq_n_f32(in.val[1], matrix[1]));
+                    vst1q_f32(dest, vaddq_f32(vld1q_f32(dest), sum));
+                }
+            }
+            else if (scalar::isMixedInLanes(srcChannels, destChannels))
+            {
+                // One frame at a time, output channels in lanes
+                Float columns[2][MaxChannels];
+                scalar::getMixColumns(matrix, srcChannels, destChannels, columns);
+                const auto low0 = vld1q_f32(columns[0]), high0 = vld1q_f32(columns[0] + 4);
+                const auto low1 = vld1q_f32(columns[1]), high1 = vld1q_f32(columns[1] + 4);
+                for (; k < frames; ++k, src += srcChannels, dest += destChannels)
+                {
+                    auto low = vmulq_n_f32(low0, src[0]), high = vmulq_n_f32(high0, src[0]);
+                    if (srcChannels == 2)
+                    {
+                        low = vaddq_f32(low, vmulq_n_f32(low1, src[1]));
+                        high = vaddq_f32(high, vmulq_n_f32(high1, src[1]));
+                    }
+
+                    vst1q_f32(dest, vaddq_f32(vld1q_f32(dest), low));
+                    if (destChannels == 8)
+                        vst1q_f32(dest + 4, vaddq_f32(vld1q_f32(dest + 4), high));
+                    else if (destChannels == 6) // only the low pair, keeping clear of the next frame
+                        vst1_f32(dest + 4, vadd_f32(vld1_f32(dest + 4), vget_low_f32(high)));
+                }
+            }
+
+            scalar::mixMatrix(dest, destChannels, src, srcChannels, matrix, frames - k);
+        }
+
+        static auto resampleStereo(Float *output, const Int64 frames, const Float *input, Uint64 position,
+            const Uint64 step, const Float *table) -> void
+        {
+            for (Int64 k = 0; k < frames; ++k, output += 2, position += step)
+            {
+                const auto x = input + (position >> 32) * 2;
+                const auto w = table + ((position >> (32 - ResamplePhaseBits)) & (ResamplePhases - 1)) *
+                    ResampleTaps * 2;
+
+                auto sum = vmulq_f32(vld1q_f32(x), vld1q_f32(w)); // L0 R0 L1 R1
+                for (Int t = 4; t < ResampleTaps * 2; t += 4)
+                    sum = vaddq_f32(sum, vmulq_f32(vld1q_f32(x + t), vld1q_f32(w + t)));
+
+                vst1_f32(output, vadd_f32(vget_low_f32(sum), vget_high_f32(sum)));
+            }
+        }
+
+        /// One transposed direct form II section on the left and right channel
+        static auto biquadSection(float32x2_t &x, const float32x2_t *c, float32x2_t &z1, float32x2_t &z2) -> void
+        {
+            const auto y = vadd_f32(vmul_f32(c[0], x), z1);
+            z1 = vsub_f32(vadd_f32(vmul_f32(c[1], x), z2), vmul_f32(c[3], y));
+            z2 = vsub_f32(vmul_f32(c[2], x), vmul_f32(c[4], y));
+            x = y;
+        }
+
+        /// Stereo cascade of a fixed number of sections, unrolled so that every section's state stays in
+        /// registers
+        template <Int... Stage>
+        static auto biquadStereo(Float *samples, const Int64 frames, const BiquadCoefs *coefs, Float *state,
+            std::integer_sequence<Int, Stage...>) -> void
+        {
+            const auto splat = [](const BiquadCoefs &c) -> std::array<float32x2_t, 5> {
+                return {vdup_n_f32(c.b0), vdup_n_f32(c.b1), vdup_n_f32(c.b2), vdup_n_f32(c.a1), vdup_n_f32(c.a2)};
+            };
+            const std::array<float32x2_t, 5> c[] = {splat(coefs[Stage])...};
+            float32x2_t z1[] = {vld1_f32(state + Stage * 4)...};
+            float32x2_t z2[] = {vld1_f32(state + Stage * 4 + 2)...};
+
+            for (Int64 k = 0; k < frames; ++k)
+            {
+                auto x = vld1_f32(samples + k * 2);
+                (biquadSection(x, c[Stage].data(), z1[Stage], z2[Stage]), ...);
+                vst1_f32(samples + k * 2, x);
+            }
+
+            (vst1_f32(state + Stage * 4, z1[Stage]), ...);
+            (vst1_f32(state + Stage * 4 + 2, z2[Stage]), ...);
+        }
+
+        static auto biquad(Float *samples, const Int64 frames, const Int channels, const BiquadCoefs *coefs,
+            const Int stages, Float *state) -> void
+        {
+            if (channels != 2)
+            {
+                scalar::biquad(samples, frames, channels, coefs, stages, state);
+                return;
+            }
+
+            switch (stages)
+            {
+            case 1: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 1>()); break;
+            case 2: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 2>()); break;
+            case 3: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 3>()); break;
+            case 4: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 4>()); break;
+            case 5: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 5>()); break;
+            case 6: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 6>()); break;
+            case 7: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 7>()); break;
+            case 8: biquadStereo(samples, frames, coefs, state, std::make_integer_sequence<Int, 8>()); break;
+            default: break;
+            }
+            static_assert(MaxBiquadStages == 8);
+            scalar::flushBiquadState(state, static_cast<Int64>(stages) * 4);
+        }
+
+        /// Zero lanes below `FlushThreshold` in magnitude
+        static auto flush(const float32x4_t v) -> float32x4_t
+        {
+            const auto keep = vcgeq_f32(vabsq_f32(v), vdupq_n_f32(FlushThreshold));
+            return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(v), keep));
+        }
+
+        /// Sum the eight lanes of two vectors, in the order of `scalar::sumLines`
+        static auto sumLines(const float32x4_t a, const float32x4_t b) -> Float
+        {
+            const auto pairs = vaddq_f32(a, b);                                     // 0+4 1+5 2+6 3+7
+            const auto halves = vadd_f32(vget_low_f32(pairs), vget_high_f32(pairs)); // (0+4)+(2+6) (1+5)+(3+7)
+            return vget_lane_f32(halves, 0) + vget_lane_f32(halves, 1);
+        }
+
+        static auto fdn(const Float *input, Float *left, Float *right, const Int64 frames, FdnState *state) -> void
+        {
+            const auto lines = state->lines;
+            const auto mask = state->mask;
+            const auto &delays = state->delays;
+            auto position = state->position;
+
+            const auto inputA = vld1q_f32(state->inputGains), inputB = vld1q_f32(state->inputGains + 4);
+            const auto gainA = vld1q_f32(state->feedbackGains), gainB = vld1q_f32(state->feedbackGains + 4);
+            const auto leftA = vld1q_f32(state->leftGains), leftB = vld1q_f32(state->leftGains + 4);
+            const auto rightA = vld1q_f32(state->rightGains), rightB = vld1q_f32(state->rightGains + 4);
+            const auto damping = vdupq_n_f32(state->damping);
+            const auto scale = vdupq_n_f32(2.f / FdnLines);
+            auto lowpassA = vld1q_f32(state->lowpass), lowpassB = vld1q_f32(state->lowpass + 4);
+
+            for (Int64 k = 0; k < frames; ++k)
+            {
+                Float delayed[FdnLines];
+                for (Int i = 0; i < FdnLines; ++i)
+                    delayed[i] = lines[((position - delays[i]) & mask) * FdnLines + i];
+                const auto delayedA = vld1q_f32(delayed), delayedB = vld1q_f32(delayed + 4);
+                lowpassA = flush(vaddq_f32(delayedA, vmulq_f32(vsubq_f32(lowpassA, delayedA), damping)));
+                lowpassB = flush(vaddq_f32(delayedB, vmulq_f32(vsubq_f32(lowpassB, delayedB), damping)));
+
+                const auto feedback = vmulq_f32(vdupq_n_f32(sumLines(lowpassA, lowpassB)), scale);
+                const auto x = vdupq_n_f32(input[k]);
+                const auto frame = lines + position * FdnLines;
+                vst1q_f32(frame, flush(vaddq_f32(vmulq_f32(vsubq_f32(lowpassA, feedback), gainA),
+                    vmulq_f32(x, inputA))));
+                vst1q_f32(frame + 4, flush(vaddq_f32(vmulq_f32(vsubq_f32(lowpassB, feedback), gainB),
+                    vmulq_f32(x, inputB))));
+
+                left[k] = sumLines(vmulq_f32(lowpassA, leftA), vmulq_f32(lowpassB, leftB));
+                right[k] = sumLines(vmulq_f32(lowpassA, rightA), vmulq_f32(lowpassB, rightB));
+                position = (position + 1) & mask;
+            }
+
+            vst1q_f32(state->lowpass, lowpassA);
+            vst1q_f32(state->lowpass + 4, lowpassB);
+            state->position = position;
+        }
+
+        static auto peak(const Float *samples, Float *peaks, const Int64 frames, const Int channels) -> void
+        {
+            Int64 k = 0;
+            if (channels == 1)
+            {
+                for (; k <= frames - 4; k += 4)
+                    vst1q_f32(peaks + k, vabsq_f32(vld1q_f32(samples + k)));
+            }
+            else if (channels == 2)
+            {
+                for (; k <= frames - 4; k += 4)
+                {
+                    const auto frame = vld2q_f32(samples + k * 2); // lefts, rights
+                    vst1q_f32(peaks + k, vmaxq_f32(vabsq_f32(frame.val[0]), vabsq_f32(frame.val[1])));
+                }
+            }
+
+            scalar::peak(samples + k * channels, peaks + k, frames - k, channels);
+        }
+
+        static auto spatialize(const SpatialEmitters &emitters, const SpatialListener &listener, Float *left,
+            Float *right) -> void
+        {
+            Int64 i = 0;
+#if defined(__aarch64__) || defined(_M_ARM64) // 32-bit NEON has no exact vector division or square root
+            const auto time = vdupq_n_f32(listener.time);
+            const auto listenerX = vdupq_n_f32(listener.x), listenerY = vdupq_n_f32(listener.y);
+            const auto rightX = vdupq_n_f32(listener.rightX), rightY = vdupq_n_f32(listener.rightY);
+            const auto one = vdupq_n_f32(1.f), minusOne = vdupq_n_f32(-1.f), half = vdupq_n_f32(.5f);
+            const auto zero = vdupq_n_f32(0);
+
+            for (; i <= emitters.count - 4; i += 4)
+            {
+                const auto dx = vsubq_f32(vaddq_f32(vld1q_f32(emitters.x + i),
+                    vmulq_f32(vld1q_f32(emitters.velocityX + i), time)), listenerX);
+                const auto dy = vsubq_f32(vaddq_f32(vld1q_f32(emitters.y + i),
+                    vmulq_f32(vld1q_f32(emitters.velocityY + i), time)), listenerY);
+                const auto distanceSquared = vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy));
+                const auto distance = vsqrtq_f32(distanceSquared);
+
+                const auto lateral = vaddq_f32(vmulq_f32(dx, rightX), vmulq_f32(dy, rightY));
+                const auto pan = vminq_f32(vmaxq_f32(vdivq_f32(lateral,
+                    vmaxq_f32(distance, vld1q_f32(emitters.radius + i))), minusOne), one);
+
+                const auto isSquared = vmvnq_u32(vceqq_f32(vld1q_f32(emitters.squared + i), zero));
+                const auto measured = vbslq_f32(isSquared, distanceSquared, distance);
+                const auto inner = vld1q_f32(emitters.inner + i);
+                const auto over = vsubq_f32(vminq_f32(vmaxq_f32(measured, inner), vld1q_f32(emitters.outer + i)),
+                    inner);
+                const auto gain = vmaxq_f32(vsubq_f32(one, vdivq_f32(vmulq_f32(vld1q_f32(emitters.rolloff + i), over),
+                    vaddq_f32(vld1q_f32(emitters.offset + i), vmulq_f32(vld1q_f32(emitters.slope + i), over)))), zero);
+
+                vst1q_f32(left + i, vmulq_f32(gain, vsqrtq_f32(vmulq_f32(vsubq_f32(one, pan), half))));
+                vst1q_f32(right + i, vmulq_f32(gain, vsqrtq_f32(vmulq_f32(vaddq_f32(one, pan), half))));
+            }
+#endif
+            scalar::spatializeFrom(emitters, listener, left, right, i);
+        }
+
+        static auto mixPanned(Float *dest, const Int destChannels, const Float *src, const Int srcChannels,
+            const Int64 frames, const Int64 offset, const Float left, const Float right, const Float leftSlope,
+            const Float rightSlope) -> void
+        {
+            Int64 k = 0;
+            if (destChannels == 2 && srcChannels == 1)
+            {
+                const auto leftVec = vdupq_n_f32(left), rightVec = vdupq_n_f32(right);
+                const auto leftSlopeVec = vdupq_n_f32(leftSlope), rightSlopeVec = vdupq_n_f32(rightSlope);
+                const int32x4_t frameIndex { 0, 1, 2, 3 };
+                for (; k <= frames - 4; k += 4, src += 4, dest += 8)
+                {
+                    const auto index = vcvtq_f32_s32(vaddq_s32(vdupq_n_s32(static_cast<Int>(offset + k)),
+                        frameIndex));
+                    const auto in = vld1q_f32(src);
+                    float32x4x2_t out = vld2q_f32(dest);
+                    out.val[0] = vaddq_f32(out.val[0],
+                        vmulq_f32(in, vaddq_f32(vmulq_f32(leftSlopeVec, index), leftVec)));
+                    out.val[1] = vaddq_f32(out.val[1],
+                        vmulq_f32(in, vaddq_f32(vmulq_f32(rightSlopeVec, index), rightVec)));
+                    vst2q_f32(dest, out);
+                }
+            }
+            else if (destChannels == 2 && srcChannels == 2)
+            {
+                const float32x4_t starts { left, right, left, right };
+                const float32x4_t slopes { leftSlope, rightSlope, leftSlope, rightSlope };
+                const int32x4_t frameIndex0 { 0, 0, 1, 1 }; // two stereo frames per vector
+                const int32x4_t frameIndex1 { 2, 2, 3, 3 };
+                for (; k <= frames - 4; k += 4, src += 8, dest += 8)
+                {
+                    const auto base = vdupq_n_s32(static_cast<Int>(offset + k));
+                    const auto gains0 = vaddq_f32(vmulq_f32(slopes, vcvtq_f32_s32(vaddq_s32(base, frameIndex0))),
+                        starts);
+                    const auto gains1 = vaddq_f32(vmulq_f32(slopes, vcvtq_f32_s32(vaddq_s32(base, frameIndex1))),
+                        starts);
+                    vst1q_f32(dest, vaddq_f32(vld1q_f32(dest), vmulq_f32(vld1q_f32(src), gains0)));
+                    vst1q_f32(dest + 4, vaddq_f32(vld1q_f32(dest + 4), vmulq_f32(vld1q_f32(src + 4), gains1)));
+                }
+            }
+
+            scalar::mixPanned(dest, destChannels, src, srcChannels, frames - k, offset + k, left, right, leftSlope,
+                rightSlope);
+        }
+
+        static auto fftPass(Float *re, Float *im, const Float *twiddleRe, const Float *twiddleIm,
+            const Int64 half, const Int64 size) -> void
+        {
+            if (half < 4)
+            {
+                scalar::fftPass(re, im, twiddleRe, twiddleIm, half, size);
+                return;
+            }
+
+            for (Int64 b = 0; b < size; b += half * 2)
+            {
+                for (Int64 j = 0; j < half; j += 4)
+                {
+                    const auto xr = vld1q_f32(re + b + half + j), xi = vld1q_f32(im + b + half + j);
+                    const auto wr = vld1q_f32(twiddleRe + j), wi = vld1q_f32(twiddleIm + j);
+                    const auto tr = vsubq_f32(vmulq_f32(xr, wr), vmulq_f32(xi, wi));
+                    const auto ti = vaddq_f32(vmulq_f32(xr, wi), vmulq_f32(xi, wr));
+                    const auto ur = vld1q_f32(re + b + j), ui = vld1q_f32(im + b + j);
+                    vst1q_f32(re + b + half + j, vsubq_f32(ur, tr));
+                    vst1q_f32(im + b + half + j, vsubq_f32(ui, ti));
+                    vst1q_f32(re + b + j, vaddq_f32(ur, tr));
+                    vst1q_f32(im + b + j, vaddq_f32(ui, ti));
+                }
+            }
+        }
+
+        static auto spectrumMac(Float *accRe, Float *accIm, const Float *aRe, const Float *aIm, const Float *bRe,
+            const Float *bIm, const Int64 bins) -> void
+        {
+            Int64 k = 0;
+            for (; k <= bins - 4; k += 4)
+            {
+                const auto ar = vld1q_f32(aRe + k), ai = vld1q_f32(aIm + k);
+                const auto br = vld1q_f32(bRe + k), bi = vld1q_f32(bIm + k);
+                vst1q_f32(accRe + k, vaddq_f32(vld1q_f32(accRe + k), vsubq_f32(vmulq_f32(ar, br), vmulq_f32(ai, bi))));
+                vst1q_f32(accIm + k, vaddq_f32(vld1q_f32(accIm + k), vaddq_f32(vmulq_f32(ar, bi), vmulq_f32(ai, br))));
+            }
+
+            scalar::spectrumMac(accRe + k, accIm + k, aRe + k, aIm + k, bRe + k, bIm + k, bins - k);
+        }
+
+        static auto truePeak(const Float *samples, const Int64 count, const Float *coefs) -> Float
+        {
+            float32x4_t taps[TruePeakTaps];
+            for (Int t = 0; t < TruePeakTaps; ++t)
+                taps[t] = vld1q_f32(coefs + t * TruePeakPhases);
+
+            auto levels = vdupq_n_f32(0);
+            for (Int64 k = 0; k < count; ++k)
+            {
+                auto sum = vmulq_f32(vdupq_n_f32(samples[k]), taps[0]);
+                for (Int t = 1; t < TruePeakTaps; ++t)
+                    sum = vaddq_f32(sum, vmulq_f32(vdupq_n_f32(samples[k + t]), taps[t]));
+                levels = vmaxq_f32(levels, vabsq_f32(sum));
+            }
+
+            return std::max(std::max(vgetq_lane_f32(levels, 0), vgetq_lane_f32(levels, 1)),
+                std::max(vgetq_lane_f32(levels, 2), vgetq_lane_f32(levels, 3)));
+        }
+
+        static constexpr Kernels kernels = {
+            .mix = mix,
+            .mix4 = mix4,
+            .scale = scale,
+            .pan = pan,
+            .delay = delay,
+            .fade = fade,
+            .mixMatrix = mixMatrix,
+            .resampleStereo = resampleStereo,
+            .biquad = biquad,
+            .fdn = fdn,
+            .peak = peak,
+            .spatialize = spatialize,
+            .mixPanned = mixPanned,
+            .fftPass = fftPass,
+            .spectrumMac = spectrumMac,
+            .truePeak = truePeak,
+        };
+    }
+#endif
+
+    // ===== Dispatch =========================================================
+
+    static auto selectKernelSet() noexcept -> KernelSet
+    {
+#if KAZE_CPU_SSE
+        if (cpu::getFeatures().avx2)
+            return KernelSet::AVX2;
+        return KernelSet::SSE;
+#elif KAZE_CPU_WASM_SIMD
+        return KernelSet::Wasm;
+#elif KAZE_CPU_ARM_NEON
+        return KernelSet::Neon;
+#else
+        return KernelSet::Scalar;
+#endif
+    }
+
+    auto getKernelSet() noexcept -> KernelSet
+    {
+        static const auto set = selectKernelSet();
+        return set;
+    }
+
+    auto getKernels() noexcept -> const Kernels &
+    {
+        static const auto kernels = getKernels(getKernelSet());
+        return *kernels;
+    }
+
+    auto getKernels(const KernelSet set) noexcept -> const Kernels *
+    {
+        switch (set)
+        {
+        case KernelSet::Scalar:
+            return &scalar::kernels;
+#if KAZE_CPU_SSE
+        case KernelSet::SSE:
+            return &sse::kernels;
+        case KernelSet::AVX2:
+            return cpu::getFeatures().avx2 ? &avx2::getKernels() : Null;
+#elif KAZE_CPU_WASM_SIMD
+        case KernelSet::Wasm:
+            return &wasm::kernels;
+#elif KAZE_CPU_ARM_NEON
+        case KernelSet::Neon:
+            return &neon::kernels;
+#endif
+        default:
+            return Null;
+        }
+    }
+}
+
+KSND_NS_END
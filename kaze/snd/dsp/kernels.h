@@ -0,0 +1,231 @@
+/// \file kernels.h
+/// Vectorized sample-processing kernels shared by the mixer and built-in effects
+#pragma once
+#include <kaze/snd/lib.h>
+
+KSND_NS_BEGIN
+
+namespace dsp {
+
+    /// Most channels per frame the mixer handles, see `Kernels::mixMatrix`
+    constexpr Int MaxChannels = 8;
+
+    /// Input frames weighed into each output frame by `Kernels::resampleStereo`
+    constexpr Int ResampleTaps = 16;
+
+    /// Fraction bits selecting the phase of a `Kernels::resampleStereo` table
+    constexpr Int ResamplePhaseBits = 7;
+
+    /// Number of phases in a `Kernels::resampleStereo` table
+    constexpr Int ResamplePhases = 1 << ResamplePhaseBits;
+
+    /// Most sections a single `Kernels::biquad` call runs in cascade
+    constexpr Int MaxBiquadStages = 8;
+
+    /// Recursive state smaller than this in magnitude is flushed to zero by `Kernels::biquad` and `Kernels::fdn`,
+    /// so that decaying tails never reach denormals, which are slow on most CPUs
+    constexpr Float FlushThreshold = 1e-15f;
+
+    /// Delay lines in a `Kernels::fdn` network, one per lane of two 128-bit vectors
+    constexpr Int FdnLines = 8;
+
+    /// Oversampling factor of `Kernels::truePeak`, one phase per lane of a 128-bit vector
+    constexpr Int TruePeakPhases = 4;
+
+    /// Input samples weighed into each oversampled value by `Kernels::truePeak`
+    constexpr Int TruePeakTaps = 12;
+
+    /// Coefficients of one biquad section, normalized so that `a0 = 1`
+    struct BiquadCoefs {
+        Float b0, b1, b2, a1, a2;
+    };
+
+    /// Delay lines, gains and filter state of a feedback delay network, see `Kernels::fdn`
+    struct FdnState {
+        Float *lines;                  ///< ring of `mask + 1` frames, each holding one sample of every line
+        Uint64 mask;                   ///< ring length minus one, where the length is a power of two
+        Uint64 position;               ///< ring frame written next
+        Uint64 delays[FdnLines];       ///< delay of each line in frames, from 1 to `mask`
+        Float inputGains[FdnLines];    ///< share of the input fed into each line
+        Float feedbackGains[FdnLines]; ///< gain of each line per trip through it, below 1 to decay
+        Float leftGains[FdnLines];     ///< share of each line in the left output
+        Float rightGains[FdnLines];    ///< share of each line in the right output
+        Float damping;                 ///< one-pole low-pass coefficient from 0 to below 1; higher darkens the tail
+        Float lowpass[FdnLines];       ///< low-pass state of each line
+    };
+
+    /// Emitters in structure-of-arrays layout, see `Kernels::spatialize`. Each array holds `count` values.
+    struct SpatialEmitters {
+        const Float *x, *y;                 ///< position
+        const Float *velocityX, *velocityY; ///< units per second
+        const Float *radius;  ///< distance within which the pan narrows toward the center, above zero
+        const Float *squared; ///< `1` to attenuate by the squared distance, `0` by the distance
+        const Float *inner;   ///< measured distance below which the gain stays at its loudest
+        const Float *outer;   ///< measured distance beyond which the gain stops falling
+        const Float *rolloff; ///< steepness of the attenuation; `0` for none
+        const Float *offset;  ///< constant term of the attenuation's denominator, above zero
+        const Float *slope;   ///< term of the attenuation's denominator that grows with distance
+        Int64 count;
+    };
+
+    /// Listener that `Kernels::spatialize` pans and attenuates emitters around
+    struct SpatialListener {
+        Float x, y;           ///< position
+        Float rightX, rightY; ///< unit vector pointing to the listener's right
+        Float time;           ///< seconds to move each emitter along its velocity first
+    };
+
+    /// Instruction set a kernel table was written for
+    enum class KernelSet {
+        Scalar, ///< plain C++, the reference every other set must match
+        SSE,    ///< x86 128-bit
+        AVX2,   ///< x86 256-bit, selected at runtime
+        Neon,   ///< ARM 128-bit
+        Wasm,   ///< WebAssembly 128-bit
+    };
+
+    /// Table of kernels for one instruction set.
+    ///
+    /// Every implementation performs the same float operations in the same order as the scalar reference, so the
+    /// output is bit-exact no matter which set runs. Fused multiply-add is not used for that reason.
+    ///
+    /// Unless noted otherwise, `count` is a number of float samples. Buffers need no particular alignment, and
+    /// kernels may be called with any `count`; the remainder of a vector width is processed by scalar code.
+    struct Kernels {
+        /// `dest[i] += src[i]`
+        void (*mix)(Float *dest, const Float *src, Int64 count);
+
+        /// `dest[i] += (a[i] + b[i]) + (c[i] + d[i])`
+        void (*mix4)(Float *dest, const Float *a, const Float *b, const Float *c, const Float *d, Int64 count);
+
+        /// `output[i] = input[i] * gain`; input and output may be the same buffer
+        void (*scale)(const Float *input, Float *output, Float gain, Int64 count);
+
+        /// Stereo balance on interleaved frames; input and output may be the same buffer
+        /// - `outL = inR * (1 - right) + inL * left`
+        /// - `outR = inL * (1 - left) + inR * right`
+        void (*pan)(const Float *input, Float *output, Float left, Float right, Int64 count);
+
+        /// `output[i] = input[i] * dry + buffer[i] * wet`, then `buffer[i] = input[i] * feedback`.
+        /// Input and output may be the same buffer.
+        void (*delay)(const Float *input, Float *output, Float *buffer, Float dry, Float wet, Float feedback,
+            Int64 count);
+
+        /// Multiply interleaved frames by a linear ramp, where every channel of frame `k` is scaled by
+        /// `slope * (Float)(offset + k) + start`, a multiply-add per frame.
+        /// Here `frames` is a number of frames; `offset + frames` must fit into an Int.
+        void (*fade)(Float *samples, Int64 frames, Int channels, Int64 offset, Float start, Float slope);
+
+        /// Mix interleaved frames into frames of another channel count: for each frame and output channel `out`,
+        /// `dest[out] += src[0] * row[0] + src[1] * row[1] + ...`, summed left to right, where
+        /// `row = matrix + out * srcChannels`. Mono to stereo, stereo to mono, and mono or stereo into 4, 6, or 8
+        /// channels are vectorized.
+        /// Here `frames` is a number of frames, and both channel counts are at most `MaxChannels`.
+        void (*mixMatrix)(Float *dest, Int destChannels, const Float *src, Int srcChannels, const Float *matrix,
+            Int64 frames);
+
+        /// Polyphase FIR resampling of interleaved stereo frames. Output frame `k` reads from the 32.32 fixed-point
+        /// input position `p = position + k * step`: the `ResampleTaps` input frames starting at `p >> 32` are
+        /// weighed by the table phase picked by the top `ResamplePhaseBits` of the fraction.
+        ///
+        /// `table` holds `ResamplePhases` rows of `ResampleTaps` weights, each stored twice in a row, for the left
+        /// and right channel. Both channels sum their even and odd taps separately, then add the two sums.
+        /// Here `frames` is a number of output frames.
+        void (*resampleStereo)(Float *output, Int64 frames, const Float *input, Uint64 position, Uint64 step,
+            const Float *table);
+
+        /// Cascade of biquad sections in transposed direct form II, filtering interleaved frames in place. Each
+        /// section feeds the next; per channel, with input `x` and output `y`:
+        /// - `y = b0 * x + z1`
+        /// - `z1 = (b1 * x + z2) - a1 * y`, which keeps `z2` off the path from one output to the next
+        /// - `z2 = b2 * x - a2 * y`
+        ///
+        /// `state` holds `stages` blocks of `z1` for every channel followed by `z2` for every channel, and is
+        /// flushed below `FlushThreshold` on return. Stereo runs both channels in one vector.
+        /// Here `frames` is a number of frames, and `stages` is at most `MaxBiquadStages`.
+        void (*biquad)(Float *samples, Int64 frames, Int channels, const BiquadCoefs *coefs, Int stages,
+            Float *state);
+
+        /// Feedback delay network of `FdnLines` lines, turning a mono input into a decorrelated stereo tail. For
+        /// each frame `k` and line `i`:
+        /// - `d = lines[((position - delays[i]) & mask) * FdnLines + i]`, the delayed output of the line
+        /// - `lowpass[i] = d + (lowpass[i] - d) * damping`
+        /// - `lines[position * FdnLines + i] = (lowpass[i] - sum(lowpass) * (2 / FdnLines)) * feedbackGains[i] +
+        ///   input[k] * inputGains[i]`, mixing the lines through a Householder matrix
+        /// - `left[k] = sum(lowpass * leftGains)` and `right[k] = sum(lowpass * rightGains)`
+        ///
+        /// where `sum(v) = ((v0 + v4) + (v2 + v6)) + ((v1 + v5) + (v3 + v7))`, then `position` moves to the next
+        /// frame. Low-pass state and line samples are flushed below `FlushThreshold` as they are written. The lines
+        /// of one frame are processed in vector lanes.
+        /// Here `frames` is a number of frames.
+        void (*fdn)(const Float *input, Float *left, Float *right, Int64 frames, FdnState *state);
+
+        /// Level of the loudest channel in each interleaved frame, `peaks[k] = max(|samples[k * channels + c]|)`
+        /// over every channel `c`, as the input of a level detector. Mono and stereo are vectorized.
+        /// Here `frames` is a number of frames.
+        void (*peak)(const Float *samples, Float *peaks, Int64 frames, Int channels);
+
+        /// Constant-power pan and distance gain of every emitter, in lanes. For emitter `i`, moved along its
+        /// velocity for `time` seconds, with `(dx, dy)` from the listener to it:
+        /// - `distance = sqrt(dx * dx + dy * dy)`
+        /// - `pan = clamp((dx * rightX + dy * rightY) / max(distance, radius), -1, 1)`
+        /// - `measured` is `dx * dx + dy * dy` where `squared` is set, else `distance`; then
+        ///   `over = clamp(measured, inner, outer) - inner`
+        /// - `gain = max(1 - rolloff * over / (offset + slope * over), 0)`
+        /// - `left[i] = gain * sqrt((1 - pan) * 0.5)` and `right[i] = gain * sqrt((1 + pan) * 0.5)`
+        void (*spatialize)(const SpatialEmitters &emitters, const SpatialListener &listener, Float *left,
+            Float *right);
+
+        /// Mix mono or stereo frames into the front pair of wider frames under two linear gain ramps: for frame
+        /// `k`, `dest[0] += src[0] * (leftSlope * (Float)(offset + k) + left)`, and `dest[1]` likewise from the
+        /// last source channel and the right ramp. Other channels of `dest` are left alone. Into stereo is
+        /// vectorized.
+        /// Here `frames` is a number of frames, `srcChannels` is 1 or 2, `destChannels` is at least 2, and
+        /// `offset + frames` must fit into an Int.
+        void (*mixPanned)(Float *dest, Int destChannels, const Float *src, Int srcChannels, Int64 frames,
+            Int64 offset, Float left, Float right, Float leftSlope, Float rightSlope);
+
+        /// One radix-2 decimation-in-time pass of a complex FFT in split format, over every block of `half * 2`
+        /// points. For block start `b` and `j < half`, with `x = (re, im)[b + half + j]` and
+        /// `w = (twiddleRe, twiddleIm)[j]`:
+        /// - `t = (x.re * w.re - x.im * w.im, x.re * w.im + x.im * w.re)`
+        /// - `x = (re, im)[b + j] - t`, then `(re, im)[b + j] += t`
+        /// Here `half` is a power of two and `size` a multiple of `half * 2`. Passes with `half` of 4 or more are
+        /// vectorized.
+        void (*fftPass)(Float *re, Float *im, const Float *twiddleRe, const Float *twiddleIm, Int64 half,
+            Int64 size);
+
+        /// Complex multiply-accumulate of spectra in split format, the inner loop of convolution in the frequency
+        /// domain: `accRe[k] += aRe[k] * bRe[k] - aIm[k] * bIm[k]`, and
+        /// `accIm[k] += aRe[k] * bIm[k] + aIm[k] * bRe[k]`.
+        /// Here `bins` is the number of complex values.
+        void (*spectrumMac)(Float *accRe, Float *accIm, const Float *aRe, const Float *aIm, const Float *bRe,
+            const Float *bIm, Int64 bins);
+
+        /// Loudest value of a signal oversampled by a polyphase FIR, which catches the peaks between samples that a
+        /// converter reconstructs. For sample `k` and phase `p < TruePeakPhases`:
+        /// - `y = samples[k] * coefs[p] + samples[k + 1] * coefs[TruePeakPhases + p] + ...`, summed left to right
+        ///   over `TruePeakTaps` samples, each tap's phases stored next to each other
+        /// - returns `max(|y|)` over every `k < count` and phase, or `0` when `count` is `0`
+        ///
+        /// `samples` holds `count + TruePeakTaps - 1` samples of one channel, the history of the last call first.
+        /// The phases are computed in lanes.
+        Float (*truePeak)(const Float *samples, Int64 count, const Float *coefs);
+    };
+
+    /// Get the fastest kernels supported by the running CPU. Selected once on first call; thread-safe.
+    [[nodiscard]]
+    auto getKernels() noexcept -> const Kernels &;
+
+    /// \returns the instruction set of the table returned by `getKernels()`
+    [[nodiscard]]
+    auto getKernelSet() noexcept -> KernelSet;
+
+    /// Get the kernels of a specific instruction set, e.g. to compare them in tests and benchmarks
+    /// \param[in]  set  instruction set to get
+    /// \returns kernel table, or null if `set` was not compiled in or the running CPU does not support it
+    [[nodiscard]]
+    auto getKernels(KernelSet set) noexcept -> const Kernels *;
+}
+
+KSND_NS_END
@@ -0,0 +1,363 @@
+/// \file kernels_avx2.cpp
+/// 256-bit kernels. Each function is compiled for AVX2 through `KAZE_TARGET_AVX2`, so the rest of the library
+/// keeps the build's baseline instruction set, and these are only reached after a runtime CPU check.
+#include "kernels.h"
+#include "private/kernels_scalar.h"
+
+#include <kaze/core/intrinsics.h>
+
+#if KAZE_CPU_SSE
+
+KSND_NS_BEGIN
+
+namespace dsp::avx2 {
+
+    KAZE_TARGET_AVX2
+    static auto mix(Float *dest, const Float *src, const Int64 count) -> void
+    {
+        Int64 i = 0;
+        for (; i <= count - 32; i += 32)
+        {
+            _mm256_storeu_ps(dest + i,
+                _mm256_add_ps(_mm256_loadu_ps(dest + i), _mm256_loadu_ps(src + i)));
+            _mm256_storeu_ps(dest + i + 8,
+                _mm256_add_ps(_mm256_loadu_ps(dest + i + 8), _mm256_loadu_ps(src + i + 8)));
+            _mm256_storeu_ps(dest + i + 16,
+                _mm256_add_ps(_mm256_loadu_ps(dest + i + 16), _mm256_loadu_ps(src + i + 16)));
+            _mm256_storeu_ps(dest + i + 24,
+                _mm256_add_ps(_mm256_loadu_ps(dest + i + 24), _mm256_loadu_ps(src + i + 24)));
+        }
+
+        scalar::mix(dest + i, src + i, count - i);
+    }
+
+    KAZE_TARGET_AVX2
+    static auto mix4(Float *dest, const Float *a, const Float *b, const Float *c, const Float *d,
+        const Int64 count) -> void
+    {
+        Int64 i = 0;
+        for (; i <= count - 16; i += 16)
+        {
+            const auto sample0 = _mm256_add_ps(
+                _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)),
+                _mm256_add_ps(_mm256_loadu_ps(c + i), _mm256_loadu_ps(d + i)));
+            const auto sample1 = _mm256_add_ps(
+                _mm256_add_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)),
+                _mm256_add_ps(_mm256_loadu_ps(c + i + 8), _mm256_loadu_ps(d + i + 8)));
+
+            _mm256_storeu_ps(dest + i, _mm256_add_ps(_mm256_loadu_ps(dest + i), sample0));
+            _mm256_storeu_ps(dest + i + 8, _mm256_add_ps(_mm256_loadu_ps(dest + i + 8), sample1));
+        }
+
+        scalar::mix4(dest + i, a + i, b + i, c + i, d + i, count - i);
+    }
+
+    KAZE_TARGET_AVX2
+    static auto scale(const Float *input, Float *output, const Float gain, const Int64 count) -> void
+    {
+        const auto gains = _mm256_set1_ps(gain);
+        Int64 i = 0;
+        for (; i <= count - 32; i += 32)
+        {
+            const auto a = _mm256_loadu_ps(input + i);
+            const auto b = _mm256_loadu_ps(input + i + 8);
+            const auto c = _mm256_loadu_ps(input + i + 16);
+            const auto d = _mm256_loadu_ps(input + i + 24);
+            _mm256_storeu_ps(output + i, _mm256_mul_ps(a, gains));
+            _mm256_storeu_ps(output + i + 8, _mm256_mul_ps(b, gains));
+            _mm256_storeu_ps(output + i + 16, _mm256_mul_ps(c, gains));
+            _mm256_storeu_ps(output + i + 24, _mm256_mul_ps(d, gains));
+        }
+
+        scalar::scale(input + i, output + i, gain, count - i);
+    }
+
+    KAZE_TARGET_AVX2
+    static auto pan(const Float *input, Float *output, const Float left, const Float right,
+        const Int64 count) -> void
+    {
+        const auto a = _mm256_setr_ps(
+            1.f - right, 1.f - left, 1.f - right, 1.f - left,
+            1.f - right, 1.f - left, 1.f - right, 1.f - left);
+        const auto b = _mm256_setr_ps(left, right, left, right, left, right, left, right);
+        Int64 i = 0;
+        for (; i <= count - 16; i += 16)
+        {
+            const auto in0 = _mm256_loadu_ps(input + i);
+            const auto in1 = _mm256_loadu_ps(input + i + 8);
+            const auto swapped0 = _mm256_permute_ps(in0, _MM_SHUFFLE(2, 3, 0, 1)); // R L R L ...
+            const auto swapped1 = _mm256_permute_ps(in1, _MM_SHUFFLE(2, 3, 0, 1));
+            _mm256_storeu_ps(output + i, _mm256_add_ps(_mm256_mul_ps(swapped0, a), _mm256_mul_ps(in0, b)));
+            _mm256_storeu_ps(output + i + 8, _mm256_add_ps(_mm256_mul_ps(swapped1, a), _mm256_mul_ps(in1, b)));
+        }
+
+        scalar::pan(input + i, output + i, left, right, count - i);
+    }
+
+    KAZE_TARGET_AVX2
+    static auto delay(const Float *input, Float *output, Float *buffer, const Float dry, const Float wet,
+        const Float feedback, const Int64 count) -> void
+    {
+        const auto dryVec = _mm256_set1_ps(dry);
+        const auto wetVec = _mm256_set1_ps(wet);
+        const auto feedbackVec = _mm256_set1_ps(feedback);
+        Int64 i = 0;
+        for (; i <= count - 16; i += 16)
+        {
+            const auto input0 = _mm256_loadu_ps(input + i);
+            const auto input1 = _mm256_loadu_ps(input + i + 8);
+            const auto buffer0 = _mm256_loadu_ps(buffer + i);
+            const auto buffer1 = _mm256_loadu_ps(buffer + i + 8);
+
+            _mm256_storeu_ps(output + i,
+                _mm256_add_ps(_mm256_mul_ps(input0, dryVec), _mm256_mul_ps(buffer0, wetVec)));
+            _mm256_storeu_ps(output + i + 8,
+                _mm256_add_ps(_mm256_mul_ps(input1, dryVec), _mm256_mul_ps(buffer1, wetVec)));
+            _mm256_storeu_ps(buffer + i, _mm256_mul_ps(input0, feedbackVec));
+            _mm256_storeu_ps(buffer + i + 8, _mm256_mul_ps(input1, feedbackVec));
+        }
+
+        scalar::delay(input + i, output + i, buffer + i, dry, wet, feedback, count - i);
+    }
+
+    KAZE_TARGET_AVX2
+    static auto fade(Float *samples, const Int64 frames, const Int channels, const Int64 offset, const Float start,
+        const Float slope) -> void
+    {
+        const auto startVec = _mm256_set1_ps(start);
+        const auto slopeVec = _mm256_set1_ps(slope);
+
+        Int64 k = 0;
+        if (channels == 1)
+        {
+            const auto frameIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            for (; k <= frames - 8; k += 8, samples += 8)
+            {
+                const auto index = _mm256_cvtepi32_ps(
+                    _mm256_add_epi32(_mm256_set1_epi32(static_cast<Int>(offset + k)), frameIndex));
+                const auto gains = _mm256_add_ps(_mm256_mul_ps(slopeVec, index), startVec);
+                _mm256_storeu_ps(samples, _mm256_mul_ps(_mm256_loadu_ps(samples), gains));
+            }
+        }
+        else if (channels == 2)
+        {
+            const auto frameIndex0 = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3); // four stereo frames per vector
+            const auto frameIndex1 = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+            for (; k <= frames - 8; k += 8, samples += 16)
+            {
+                const auto base = _mm256_set1_epi32(static_cast<Int>(offset + k));
+                const auto index0 = _mm256_cvtepi32_ps(_mm256_add_epi32(base, frameIndex0));
+                const auto index1 = _mm256_cvtepi32_ps(_mm256_add_epi32(base, frameIndex1));
+                const auto gains0 = _mm256_add_ps(_mm256_mul_ps(slopeVec, index0), startVec);
+                const auto gains1 = _mm256_add_ps(_mm256_mul_ps(slopeVec, index1), startVec);
+                _mm256_storeu_ps(samples, _mm256_mul_ps(_mm256_loadu_ps(samples), gains0));
+                _mm256_storeu_ps(samples + 8, _mm256_mul_ps(_mm256_loadu_ps(samples + 8), gains1));
+            }
+        }
+
+        scalar::fade(samples, frames - k, channels, offset + k, start, slope);
+    }
+
+    KAZE_TARGET_AVX2
+    static auto mixMatrix(Float *dest, const Int destChannels, const Float *src, const Int srcChannels,
+        const Float *matrix, const Int64 frames) -> void
+    {
+        Int64 k = 0;
+        if (srcChannels == 1 && destChannels == 2)
+        {
+            const auto gains = _mm256_setr_ps(matrix[0], matrix[1], matrix[0], matrix[1],
+                matrix[0], matrix[1], matrix[0], matrix[1]);
+            for (; k <= frames - 8; k += 8, src += 8, dest += 16)
+            {
+                const auto in0 = _mm_loadu_ps(src), in1 = _mm_loadu_ps(src + 4);
+                const auto frames0 = _mm256_insertf128_ps(
+                    _mm256_castps128_ps256(_mm_unpacklo_ps(in0, in0)), _mm_unpackhi_ps(in0, in0), 1);
+                const auto frames1 = _mm256_insertf128_ps(
+                    _mm256_castps128_ps256(_mm_unpacklo_ps(in1, in1)), _mm_unpackhi_ps(in1, in1), 1);
+                _mm256_storeu_ps(dest, _mm256_add_ps(_mm256_loadu_ps(dest), _mm256_mul_ps(frames0, gains)));
+                _mm256_storeu_ps(dest + 8,
+                    _mm256_add_ps(_mm256_loadu_ps(dest + 8), _mm256_mul_ps(frames1, gains)));
+            }
+        }
+        else if (srcChannels == 2 && destChannels == 1)
+        {
+            const auto gains = _mm256_setr_ps(matrix[0], matrix[1], matrix[0], matrix[1],
+                matrix[0], matrix[1], matrix[0], matrix[1]);
+            for (; k <= frames - 8; k += 8, src += 16, dest += 8)
+            {
+                const auto products0 = _mm256_mul_ps(_mm256_loadu_ps(src), gains);
+                const auto products1 = _mm256_mul_ps(_mm256_loadu_ps(src + 8), gains);
+                const auto left = _mm256_shuffle_ps(products0, products1, _MM_SHUFFLE(2, 0, 2, 0));
+                const auto right = _mm256_shuffle_ps(products0, products1, _MM_SHUFFLE(3, 1, 3, 1));
+
+                // Shuffles stay within 128-bit halves, leaving frames in 0 1 4 5 2 3 6 7 order
+                const auto sum = _mm256_castpd_ps(_mm256_permute4x64_pd(
+                    _mm256_castps_pd(_mm256_add_ps(left, right)), _MM_SHUFFLE(3, 1, 2, 0)));
+                _mm256_storeu_ps(dest, _mm256_add_ps(_mm256_loadu_ps(dest), sum));
+            }
+        }
+        else if (scalar::isMixedInLanes(srcChannels, destChannels))
+        {
+            // One frame at a time, output channels in lanes
+            alignas(32) Float columns[2][MaxChannels];
+            scalar::getMixColumns(matrix, srcChannels, destChannels, columns);
+            const auto column0 = _mm256_load_ps(columns[0]), column1 = _mm256_load_ps(columns[1]);
+            for (; k < frames; ++k, src += srcChannels, dest += destChannels)
+            {
+                auto sum = _mm256_mul_ps(_mm256_set1_ps(src[0]), column0);
+                if (srcChannels == 2)
+                    sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(src[1]), column1));
+
+                if (destChannels == 8)
+                {
+                    _mm256_storeu_ps(dest, _mm256_add_ps(_mm256_loadu_ps(dest), sum));
+                    continue;
+                }
+
+                _mm_storeu_ps(dest, _mm_add_ps(_mm_loadu_ps(dest), _mm256_castps256_ps128(sum)));
+                if (destChannels == 6) // only the low pair, keeping clear of the next frame
+                {
+                    const auto pair = reinterpret_cast<__m64 *>(dest + 4);
+                    _mm_storel_pi(pair, _mm_add_ps(_mm_loadl_pi(_mm_setzero_ps(), pair),
+                        _mm256_extractf128_ps(sum, 1)));
+                }
+            }
+        }
+
+        scalar::mixMatrix(dest, destChannels, src, srcChannels, matrix, frames - k);
+    }
+
+    /// Load two unaligned 128-bit halves into one 256-bit vector
+    KAZE_TARGET_AVX2
+    static auto loadPair(const Float *low, const Float *high) -> __m256
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(low)), _mm_loadu_ps(high), 1);
+    }
+
+    KAZE_TARGET_AVX2
+    static auto resampleStereo(Float *output, const Int64 frames, const Float *input, Uint64 position,
+        const Uint64 step, const Float *table) -> void
+    {
+        const auto getWeights = [table](const Uint64 position) {
+            return table + ((position >> (32 - ResamplePhaseBits)) & (ResamplePhases - 1)) * ResampleTaps * 2;
+        };
+
+        // Two output frames per vector, one in each 128-bit half, so every lane sums in the scalar order
+        Int64 k = 0;
+        for (; k <= frames - 2; k += 2, output += 4, position += step * 2)
+        {
+            const auto position1 = position + step;
+            const auto x0 = input + (position >> 32) * 2, x1 = input + (position1 >> 32) * 2;
+            const auto w0 = getWeights(position), w1 = getWeights(position1);
+
+            auto sum = _mm256_mul_ps(loadPair(x0, x1), loadPair(w0, w1));
+            for (Int t = 4; t < ResampleTaps * 2; t += 4)
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(loadPair(x0 + t, x1 + t), loadPair(w0 + t, w1 + t)));
+
+            const auto frames01 = _mm256_add_ps(sum, _mm256_permute_ps(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+            _mm_storeu_ps(output, _mm_movelh_ps(_mm256_castps256_ps128(frames01),
+                _mm256_extractf128_ps(frames01, 1)));
+        }
+
+        scalar::resampleStereo(output, frames - k, input, position, step, table);
+    }
+
+    KAZE_TARGET_AVX2
+    static auto peak(const Float *samples, Float *peaks, const Int64 frames, const Int channels) -> void
+    {
+        const auto sign = _mm256_set1_ps(-0.f);
+        Int64 k = 0;
+        if (channels == 1)
+        {
+            for (; k <= frames - 8; k += 8)
+                _mm256_storeu_ps(peaks + k, _mm256_andnot_ps(sign, _mm256_loadu_ps(samples + k)));
+        }
+        else if (channels == 2)
+        {
+            for (; k <= frames - 8; k += 8)
+            {
+                const auto a = _mm256_andnot_ps(sign, _mm256_loadu_ps(samples + k * 2));     // frames 0-1 | 2-3
+                const auto b = _mm256_andnot_ps(sign, _mm256_loadu_ps(samples + k * 2 + 8)); // frames 4-5 | 6-7
+                const auto levels = _mm256_max_ps(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)),
+                    _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));                    // 0 1 4 5 | 2 3 6 7
+                _mm256_storeu_ps(peaks + k, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(levels),
+                    _MM_SHUFFLE(3, 1, 2, 0))));
+            }
+        }
+
+        scalar::peak(samples + k * channels, peaks + k, frames - k, channels);
+    }
+
+    KAZE_TARGET_AVX2
+    static auto fftPass(Float *re, Float *im, const Float *twiddleRe, const Float *twiddleIm, const Int64 half,
+        const Int64 size) -> void
+    {
+        if (half < 8)
+        {
+            sse::fftPass(re, im, twiddleRe, twiddleIm, half, size);
+            return;
+        }
+
+        for (Int64 b = 0; b < size; b += half * 2)
+        {
+            for (Int64 j = 0; j < half; j += 8)
+            {
+                const auto xr = _mm256_loadu_ps(re + b + half + j), xi = _mm256_loadu_ps(im + b + half + j);
+                const auto wr = _mm256_loadu_ps(twiddleRe + j), wi = _mm256_loadu_ps(twiddleIm + j);
+                const auto tr = _mm256_sub_ps(_mm256_mul_ps(xr, wr), _mm256_mul_ps(xi, wi));
+                const auto ti = _mm256_add_ps(_mm256_mul_ps(xr, wi), _mm256_mul_ps(xi, wr));
+                const auto ur = _mm256_loadu_ps(re + b + j), ui = _mm256_loadu_ps(im + b + j);
+                _mm256_storeu_ps(re + b + half + j, _mm256_sub_ps(ur, tr));
+                _mm256_storeu_ps(im + b + half + j, _mm256_sub_ps(ui, ti));
+                _mm256_storeu_ps(re + b + j, _mm256_add_ps(ur, tr));
+                _mm256_storeu_ps(im + b + j, _mm256_add_ps(ui, ti));
+            }
+        }
+    }
+
+    KAZE_TARGET_AVX2
+    static auto spectrumMac(Float *accRe, Float *accIm, const Float *aRe, const Float *aIm, const Float *bRe,
+        const Float *bIm, const Int64 bins) -> void
+    {
+        Int64 k = 0;
+        for (; k <= bins - 8; k += 8)
+        {
+            const auto ar = _mm256_loadu_ps(aRe + k), ai = _mm256_loadu_ps(aIm + k);
+            const auto br = _mm256_loadu_ps(bRe + k), bi = _mm256_loadu_ps(bIm + k);
+            _mm256_storeu_ps(accRe + k, _mm256_add_ps(_mm256_loadu_ps(accRe + k),
+                _mm256_sub_ps(_mm256_mul_ps(ar, br), _mm256_mul_ps(ai, bi))));
+            _mm256_storeu_ps(accIm + k, _mm256_add_ps(_mm256_loadu_ps(accIm + k),
+                _mm256_add_ps(_mm256_mul_ps(ar, bi), _mm256_mul_ps(ai, br))));
+        }
+
+        scalar::spectrumMac(accRe + k, accIm + k, aRe + k, aIm + k, bRe + k, bIm + k, bins - k);
+    }
+
+    static constexpr Kernels kernels = {
+        .mix = mix,
+        .mix4 = mix4,
+        .scale = scale,
+        .pan = pan,
+        .delay = delay,
+        .fade = fade,
+        .mixMatrix = mixMatrix,
+        .resampleStereo = resampleStereo,
+        .biquad = sse::biquad,
+        .fdn = sse::fdn,
+        .peak = peak,
+        .spatialize = sse::spatialize,
+        .mixPanned = sse::mixPanned,
+        .fftPass = fftPass,
+        .spectrumMac = spectrumMac,
+        .truePeak = sse::truePeak,
+    };
+
+    auto getKernels() noexcept -> const Kernels &
+    {
+        return kernels;
+    }
+}
+
+KSND_NS_END
+
+#endif // KAZE_CPU_SSE
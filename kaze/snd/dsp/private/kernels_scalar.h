@@ -0,0 +1,85 @@
+/// \file kernels_scalar.h
+/// Scalar reference kernels, shared by every instruction set for the samples left over after its vector loops
+#pragma once
+#include <kaze/snd/dsp/kernels.h>
+#include <kaze/core/intrinsics.h>
+
+KSND_NS_BEGIN
+
+namespace dsp::scalar {
+    auto mix(Float *dest, const Float *src, Int64 count) -> void;
+    auto mix4(Float *dest, const Float *a, const Float *b, const Float *c, const Float *d, Int64 count) -> void;
+    auto scale(const Float *input, Float *output, Float gain, Int64 count) -> void;
+    auto pan(const Float *input, Float *output, Float left, Float right, Int64 count) -> void;
+    auto delay(const Float *input, Float *output, Float *buffer, Float dry, Float wet, Float feedback,
+        Int64 count) -> void;
+    auto fade(Float *samples, Int64 frames, Int channels, Int64 offset, Float start, Float slope) -> void;
+    auto mixMatrix(Float *dest, Int destChannels, const Float *src, Int srcChannels, const Float *matrix,
+        Int64 frames) -> void;
+    auto resampleStereo(Float *output, Int64 frames, const Float *input, Uint64 position, Uint64 step,
+        const Float *table) -> void;
+    auto biquad(Float *samples, Int64 frames, Int channels, const BiquadCoefs *coefs, Int stages, Float *state)
+        -> void;
+
+    auto fdn(const Float *input, Float *left, Float *right, Int64 frames, FdnState *state) -> void;
+    auto peak(const Float *samples, Float *peaks, Int64 frames, Int channels) -> void;
+    auto spatialize(const SpatialEmitters &emitters, const SpatialListener &listener, Float *left, Float *right)
+        -> void;
+    auto mixPanned(Float *dest, Int destChannels, const Float *src, Int srcChannels, Int64 frames, Int64 offset,
+        Float left, Float right, Float leftSlope, Float rightSlope) -> void;
+    auto fftPass(Float *re, Float *im, const Float *twiddleRe, const Float *twiddleIm, Int64 half, Int64 size)
+        -> void;
+    auto spectrumMac(Float *accRe, Float *accIm, const Float *aRe, const Float *aIm, const Float *bRe,
+        const Float *bIm, Int64 bins) -> void;
+    auto truePeak(const Float *samples, Int64 count, const Float *coefs) -> Float;
+
+    /// `spatialize` from emitter `first` on, for the emitters left over after vector loops
+    auto spatializeFrom(const SpatialEmitters &emitters, const SpatialListener &listener, Float *left,
+        Float *right, Int64 first) -> void;
+
+    /// Zero filter state values below `FlushThreshold` in magnitude
+    auto flushBiquadState(Float *state, Int64 count) -> void;
+
+    /// Whether vector `mixMatrix` kernels keep output channels in lanes for these channel counts: mono or stereo
+    /// into 4, 6, or 8 channels
+    constexpr auto isMixedInLanes(const Int srcChannels, const Int destChannels) -> Bool
+    {
+        return srcChannels <= 2 && (destChannels == 4 || destChannels == 6 || destChannels == 8);
+    }
+
+    /// Transpose the `mixMatrix` gains of each input channel into a column of `MaxChannels` outputs, zero-padded,
+    /// for kernels that keep output channels in lanes
+    auto getMixColumns(const Float *matrix, Int srcChannels, Int destChannels, Float (*columns)[MaxChannels])
+        -> void;
+}
+
+#if KAZE_CPU_SSE
+namespace dsp::sse {
+    /// Defined in kernels.cpp and shared with the AVX2 table, where wider vectors would not help: stereo filters
+    /// fill only half a 128-bit vector, and network lines are read one lane at a time
+    auto biquad(Float *samples, Int64 frames, Int channels, const BiquadCoefs *coefs, Int stages, Float *state)
+        -> void;
+    auto fdn(const Float *input, Float *left, Float *right, Int64 frames, FdnState *state) -> void;
+
+    /// Also shared with the AVX2 table: emitters are spatialized once per callback, where the division and
+    /// square roots dominate either way, and panned mixing is bound by memory
+    auto spatialize(const SpatialEmitters &emitters, const SpatialListener &listener, Float *left, Float *right)
+        -> void;
+    auto mixPanned(Float *dest, Int destChannels, const Float *src, Int srcChannels, Int64 frames, Int64 offset,
+        Float left, Float right, Float leftSlope, Float rightSlope) -> void;
+
+    /// Also shared with the AVX2 table, for passes of 4-point butterflies that fill only half a 256-bit vector
+    auto fftPass(Float *re, Float *im, const Float *twiddleRe, const Float *twiddleIm, Int64 half, Int64 size)
+        -> void;
+
+    /// Also shared with the AVX2 table, as the oversampled phases fill one 128-bit vector
+    auto truePeak(const Float *samples, Int64 count, const Float *coefs) -> Float;
+}
+
+namespace dsp::avx2 {
+    /// Defined in kernels_avx2.cpp. Only call if the running CPU supports AVX2.
+    auto getKernels() noexcept -> const Kernels &;
+}
+#endif
+
+KSND_NS_END
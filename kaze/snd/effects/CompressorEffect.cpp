@@ -0,0 +1,148 @@
+#include "CompressorEffect.h"
+
+#include <kaze/snd/SidechainTaps.h>
+
+#include <cmath>
+
+KSND_NS_BEGIN
+
+CompressorEffect::CompressorEffect() : AudioEffect(ProcessMode::InPlace),
+    m_params{
+        {"Threshold", ParamType::Float, -18.f, -60.f, 0},
+        {"Ratio", ParamType::Float, 4.f, 1.f, 20.f},
+        {"Knee", ParamType::Float, 6.f, 0, 24.f},
+        {"Attack", ParamType::Float, 10.f, 0, 500.f},
+        {"Release", ParamType::Float, 150.f, 1.f, 5000.f},
+        {"Makeup", ParamType::Float, 0, 0, 24.f},
+        {"Lookahead", ParamType::Int, 0, 0, static_cast<Float>(MaxLookahead)},
+        {"Detector", ParamType::Enum, static_cast<Float>(DetectorMode::Rms), 0,
+            static_cast<Float>(DetectorMode::Count) - 1.f},
+        {"Sidechain", ParamType::Int, -1.f, -1.f, static_cast<Float>(SidechainTaps::MaxTaps - 1)},
+    },
+    m_dynamics()
+{
+}
+
+CompressorEffect::CompressorEffect(CompressorEffect &&other) noexcept :
+    AudioEffect(std::move(other)),
+    m_params{
+        std::move(other.m_params[Threshold]),
+        std::move(other.m_params[Ratio]),
+        std::move(other.m_params[Knee]),
+        std::move(other.m_params[Attack]),
+        std::move(other.m_params[Release]),
+        std::move(other.m_params[Makeup]),
+        std::move(other.m_params[Lookahead]),
+        std::move(other.m_params[Detector]),
+        std::move(other.m_params[Sidechain]),
+    },
+    m_dynamics(std::move(other.m_dynamics)),
+    m_gainReduction(other.m_gainReduction.load(std::memory_order_relaxed))
+{
+}
+
+auto CompressorEffect::init_(const Float threshold, const Float ratio, const Float attack, const Float release,
+    const Int sidechain) -> Bool
+{
+    m_params[Threshold].reset(threshold);
+    m_params[Ratio].reset(ratio);
+    m_params[Knee].reset(6.f);
+    m_params[Attack].reset(attack);
+    m_params[Release].reset(release);
+    m_params[Makeup].reset(0);
+    m_params[Lookahead].reset(0);
+    m_params[Detector].reset(static_cast<Float>(DetectorMode::Rms));
+    m_params[Sidechain].reset(static_cast<Float>(sidechain));
+    m_dynamics.clear();
+    m_gainReduction.store(0, std::memory_order_relaxed);
+    return True;
+}
+
+auto CompressorEffect::prepare() -> void
+{
+    m_dynamics.prepare(channels(), context()->getSpec().freq);
+}
+
+auto CompressorEffect::processInPlace(Float *io, const Int64 count) -> Bool
+{
+    const dsp::DynamicsSettings settings{
+        .threshold = m_params[Threshold].nextRamp().end,
+        .ratio = m_params[Ratio].nextRamp().end,
+        .knee = m_params[Knee].nextRamp().end,
+        .attack = m_params[Attack].nextRamp().end * .001f,
+        .release = m_params[Release].nextRamp().end * .001f,
+        .lookahead = m_params[Lookahead].nextRamp().end * .001f,
+        .detector = static_cast<DetectorMode>(m_params[Detector].nextRamp().end),
+    };
+    const auto makeup = m_params[Makeup].nextRamp();
+    const auto tap = static_cast<Int>(m_params[Sidechain].nextRamp().end);
+
+    // A tap that was not written last callback keys off silence, rather than falling back to the input
+    const Float silence = 0;
+    const Float *key = Null;
+    Int64 keyFrames = 0;
+    if (tap > -1)
+    {
+        key = context()->getSidechainTaps().read(tap, &keyFrames);
+        if (!key)
+            key = &silence;
+    }
+
+    const auto gain = m_dynamics.process(io, count / channels(), key, keyFrames, settings,
+        std::pow(10.f, makeup.start / 20.f), std::pow(10.f, makeup.end / 20.f));
+    m_gainReduction.store(-20.f * std::log10(gain), std::memory_order_relaxed);
+    return True;
+}
+
+auto CompressorEffect::getParamsImpl(Int *outCount) -> AudioParam *
+{
+    *outCount = ParamCount;
+    return m_params;
+}
+
+auto CompressorEffect::threshold(const Float db) -> void
+{
+    m_params[Threshold].set(db);
+}
+
+auto CompressorEffect::ratio(const Float value) -> void
+{
+    m_params[Ratio].set(value);
+}
+
+auto CompressorEffect::knee(const Float db) -> void
+{
+    m_params[Knee].set(db);
+}
+
+auto CompressorEffect::attack(const Float milliseconds) -> void
+{
+    m_params[Attack].set(milliseconds);
+}
+
+auto CompressorEffect::release(const Float milliseconds) -> void
+{
+    m_params[Release].set(milliseconds);
+}
+
+auto CompressorEffect::makeup(const Float db) -> void
+{
+    m_params[Makeup].set(db);
+}
+
+auto CompressorEffect::lookahead(const Int milliseconds) -> void
+{
+    m_params[Lookahead].set(static_cast<Float>(milliseconds));
+}
+
+auto CompressorEffect::detector(const DetectorMode mode) -> void
+{
+    m_params[Detector].set(static_cast<Float>(mode));
+}
+
+auto CompressorEffect::sidechain(const Int tap) -> void
+{
+    m_params[Sidechain].set(static_cast<Float>(tap));
+}
+
+KSND_NS_END
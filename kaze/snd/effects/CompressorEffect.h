@@ -0,0 +1,101 @@
+#pragma once
+#include <kaze/snd/lib.h>
+#include <kaze/snd/AudioEffect.h>
+#include <kaze/snd/dsp/Dynamics.h>
+
+#include <atomic>
+
+KSND_NS_BEGIN
+
+/// Downward compressor, e.g. on a submix bus to even out its level, or ducking music under dialogue by keying off a
+/// sidechain tap, see `AudioSource::setSidechainTap`. A sidechain is heard one buffer late.
+///
+/// With lookahead, the output is delayed so that gain reduction starts ahead of each transient.
+class CompressorEffect final : public AudioEffect {
+public:
+    /// Parameter indices, see `AudioEffect::setParam`
+    enum Param : Int {
+        Threshold,  ///< level in dB above which gain is reduced; applied per buffer
+        Ratio,      ///< dB over the threshold in, per dB over it out; applied per buffer
+        Knee,       ///< width in dB of the soft knee, `0` for a hard knee; applied per buffer
+        Attack,     ///< milliseconds for the detector to rise 63% of the way to a louder level; applied per buffer
+        Release,    ///< milliseconds for the detector to fall 63% of the way to a quieter level; applied per buffer
+        Makeup,     ///< gain in dB after compression; ramped
+        Lookahead,  ///< milliseconds the output is delayed by, up to `MaxLookahead`; jumps
+        Detector,   ///< `DetectorMode` index; jumps
+        Sidechain,  ///< sidechain tap to detect instead of the input, or `-1` for none; jumps
+        ParamCount,
+    };
+
+    /// Longest lookahead in milliseconds
+    static constexpr Int MaxLookahead = 10;
+
+    CompressorEffect();
+    CompressorEffect(CompressorEffect &&other) noexcept;
+
+    /// \param[in]  threshold  level in dB above which gain is reduced [optional, default: `-18`]
+    /// \param[in]  ratio      dB over the threshold in, per dB over it out [optional, default: `4`]
+    /// \param[in]  attack     milliseconds for the detector to rise [optional, default: `10`]
+    /// \param[in]  release    milliseconds for the detector to fall [optional, default: `150`]
+    /// \param[in]  sidechain  sidechain tap to detect, or `-1` to detect the input [optional, default: `-1`]
+    auto init_(Float threshold = -18.f, Float ratio = 4.f, Float attack = 10.f, Float release = 150.f,
+        Int sidechain = -1) -> Bool;
+
+    auto processInPlace(Float *io, Int64 count) -> Bool override;
+
+    /// Deepest gain reduction in dB over the last buffer processed, positive while compressing. Any thread, without
+    /// locking, e.g. to draw a meter.
+    [[nodiscard]]
+    auto gainReduction() const -> Float { return m_gainReduction.load(std::memory_order_relaxed); }
+
+    // ----- getters / setters -----
+
+    auto threshold(Float db) -> void;
+    [[nodiscard]]
+    auto threshold() const -> Float { return m_params[Threshold].get(); }
+
+    auto ratio(Float value) -> void;
+    [[nodiscard]]
+    auto ratio() const -> Float { return m_params[Ratio].get(); }
+
+    auto knee(Float db) -> void;
+    [[nodiscard]]
+    auto knee() const -> Float { return m_params[Knee].get(); }
+
+    auto attack(Float milliseconds) -> void;
+    [[nodiscard]]
+    auto attack() const -> Float { return m_params[Attack].get(); }
+
+    auto release(Float milliseconds) -> void;
+    [[nodiscard]]
+    auto release() const -> Float { return m_params[Release].get(); }
+
+    auto makeup(Float db) -> void;
+    [[nodiscard]]
+    auto makeup() const -> Float { return m_params[Makeup].get(); }
+
+    auto lookahead(Int milliseconds) -> void;
+    [[nodiscard]]
+    auto lookahead() const -> Int { return m_params[Lookahead].getInt(); }
+
+    auto detector(DetectorMode mode) -> void;
+    [[nodiscard]]
+    auto detector() const -> DetectorMode { return static_cast<DetectorMode>(m_params[Detector].getInt()); }
+
+    auto sidechain(Int tap) -> void;
+    [[nodiscard]]
+    auto sidechain() const -> Int { return m_params[Sidechain].getInt(); }
+
+protected:
+    /// Size the lookahead delay for the channel count and clear the detector
+    auto prepare() -> void override;
+
+private:
+    auto getParamsImpl(Int *outCount) -> AudioParam * override;
+
+    AudioParam m_params[ParamCount];
+    dsp::Dynamics m_dynamics;
+    std::atomic<Float> m_gainReduction{}; ///< written by the audio thread, readable from any thread
+};
+
+KSND_NS_END
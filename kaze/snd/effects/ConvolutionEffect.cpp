@@ -0,0 +1,214 @@
+#include "ConvolutionEffect.h"
+
+#include <kaze/snd/SoundBuffer.h>
+#include <kaze/snd/dsp/Convolver.h>
+
+#include <kaze/core/endian.h>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+KSND_NS_BEGIN
+
+ConvolutionEffect::ConvolutionEffect() : AudioEffect(ProcessMode::InPlace),
+    m_params{
+        {"Wet", ParamType::Float, .3f, 0, 1.f},
+    },
+    m_impulse(), m_impulseChannels(), m_thread(), m_pending(), m_retired(), m_active()
+{
+}
+
+ConvolutionEffect::ConvolutionEffect(ConvolutionEffect &&other) noexcept :
+    AudioEffect(std::move(other)),
+    m_params{
+        std::move(other.m_params[Wet]),
+    },
+    m_impulse(std::move(other.m_impulse)), m_impulseChannels(other.m_impulseChannels), m_thread(other.m_thread),
+    m_pending(other.m_pending.exchange(Null)), m_retired(other.m_retired.exchange(Null)), m_active(other.m_active)
+{
+    other.m_active = Null;
+}
+
+ConvolutionEffect::~ConvolutionEffect()
+{
+    // Left over only when the pool is destroyed without releasing the effect, after the context has stopped its
+    // convolution thread
+    delete m_pending.exchange(Null);
+    delete m_retired.exchange(Null);
+    delete m_active;
+}
+
+auto ConvolutionEffect::init_(const Float wet) -> Bool
+{
+    m_params[Wet].reset(wet);
+    return True;
+}
+
+auto ConvolutionEffect::release_() -> void
+{
+    // The effect has left the graph, so the audio thread holds none of the convolvers
+    destroy(m_pending.exchange(Null, std::memory_order_acq_rel));
+    destroy(m_retired.exchange(Null, std::memory_order_acq_rel));
+    destroy(m_active);
+    m_active = Null;
+    m_impulse.clear();
+    m_impulseChannels = 0;
+}
+
+auto ConvolutionEffect::prepare() -> void
+{
+    if ( !m_impulse.empty() )
+        rebuild();
+}
+
+auto ConvolutionEffect::loadImpulse(const String &filepath, const Bool normalize) -> Bool
+{
+    if ( !context() )
+    {
+        KAZE_PUSH_ERR(Error::NotInitialized, "ConvolutionEffect must be added to a source before loading an "
+            "impulse response");
+        return False;
+    }
+
+    const auto &spec = context()->getSpec();
+    SoundBuffer buffer;
+    if ( !buffer.load(filepath, AudioSpec(spec.freq, dsp::Convolver::MaxChannels,
+        SampleFormat(sizeof(Float) * CHAR_BIT, true, Endian::isBig(), true))) )
+    {
+        return False;
+    }
+
+    return setImpulse(reinterpret_cast<const Float *>(buffer.data()), static_cast<Int64>(buffer.frameCount()),
+        buffer.spec().channels, normalize);
+}
+
+auto ConvolutionEffect::loadImpulse(const MemView<void> mem, const Bool normalize) -> Bool
+{
+    if ( !context() )
+    {
+        KAZE_PUSH_ERR(Error::NotInitialized, "ConvolutionEffect must be added to a source before loading an "
+            "impulse response");
+        return False;
+    }
+
+    const auto &spec = context()->getSpec();
+    SoundBuffer buffer;
+    if ( !buffer.load(mem, AudioSpec(spec.freq, dsp::Convolver::MaxChannels,
+        SampleFormat(sizeof(Float) * CHAR_BIT, true, Endian::isBig(), true))) )
+    {
+        return False;
+    }
+
+    return setImpulse(reinterpret_cast<const Float *>(buffer.data()), static_cast<Int64>(buffer.frameCount()),
+        buffer.spec().channels, normalize);
+}
+
+auto ConvolutionEffect::setImpulse(const Float *frames, const Int64 count, const Int channels,
+    const Bool normalize) -> Bool
+{
+    if ( !context() )
+    {
+        KAZE_PUSH_ERR(Error::NotInitialized, "ConvolutionEffect must be added to a source before setting an "
+            "impulse response");
+        return False;
+    }
+
+    if ( !frames || count <= 0 || channels <= 0 )
+    {
+        KAZE_PUSH_ERR(Error::InvalidArgErr, "ConvolutionEffect::setImpulse was passed an empty impulse response");
+        return False;
+    }
+
+    auto scale = 1.f;
+    if (normalize)
+    {
+        // Unit energy in the loudest channel keeps the power of noise through the response
+        Double energy = 0;
+        for (Int c = 0; c < channels; ++c)
+        {
+            Double sum = 0;
+            for (Int64 k = 0; k < count; ++k)
+                sum += static_cast<Double>(frames[k * channels + c]) * frames[k * channels + c];
+            energy = std::max(energy, sum);
+        }
+
+        if (energy > 0)
+            scale = static_cast<Float>(1.0 / std::sqrt(energy));
+    }
+
+    m_impulse.resize(count * channels);
+    for (Int64 i = 0; i < count * channels; ++i)
+        m_impulse[i] = frames[i] * scale;
+    m_impulseChannels = channels;
+
+    return rebuild();
+}
+
+auto ConvolutionEffect::getImpulseFrames() const -> Int64
+{
+    return m_impulseChannels > 0 ? static_cast<Int64>(m_impulse.size()) / m_impulseChannels : 0;
+}
+
+auto ConvolutionEffect::rebuild() -> Bool
+{
+    // Only one convolver is retired at a time; free it so the audio thread can take the new one
+    destroy(m_retired.exchange(Null, std::memory_order_acq_rel));
+
+    const auto convolver = new dsp::Convolver();
+    convolver->prepare(m_impulse.data(), getImpulseFrames(), m_impulseChannels,
+        std::min(channels(), dsp::Convolver::MaxChannels));
+
+    // Also restarts the thread after the context reopened; the audio thread reads `m_thread` once it has a convolver
+    const auto thread = &context()->getConvolutionThread();
+    if (m_thread != thread)
+        m_thread = thread;
+    m_thread->add(convolver);
+
+    // Replace a convolver the audio thread has not taken yet
+    destroy(m_pending.exchange(convolver, std::memory_order_acq_rel));
+    return True;
+}
+
+auto ConvolutionEffect::destroy(dsp::Convolver *convolver) -> void
+{
+    if ( !convolver )
+        return;
+
+    if (m_thread)
+        m_thread->remove(convolver);
+    delete convolver;
+}
+
+auto ConvolutionEffect::processInPlace(Float *io, const Int64 count) -> Bool
+{
+    const auto wet = m_params[Wet].nextRamp();
+
+    // Take a new convolver once the owning thread has collected the last one replaced
+    if (m_pending.load(std::memory_order_relaxed) && !m_retired.load(std::memory_order_acquire))
+    {
+        m_retired.store(m_active, std::memory_order_release);
+        m_active = m_pending.exchange(Null, std::memory_order_acq_rel);
+    }
+
+    if ( !m_active )
+        return False;
+
+    const auto channels = this->channels();
+    if (m_active->process(io, count / channels, channels, wet.start, wet.end))
+        m_thread->signal();
+    return True;
+}
+
+auto ConvolutionEffect::getParamsImpl(Int *outCount) -> AudioParam *
+{
+    *outCount = ParamCount;
+    return m_params;
+}
+
+auto ConvolutionEffect::wetDry(const Float value) -> void
+{
+    m_params[Wet].set(value);
+}
+
+KSND_NS_END
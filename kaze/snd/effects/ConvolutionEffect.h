@@ -0,0 +1,101 @@
+#pragma once
+#include <kaze/snd/lib.h>
+#include <kaze/snd/AudioEffect.h>
+
+#include <kaze/core/AlignedList.h>
+#include <kaze/core/MemView.h>
+
+#include <atomic>
+
+KSND_NS_BEGIN
+
+class ConvolutionThread;
+namespace dsp { class Convolver; }
+
+/// Convolution reverb that places its source in a recorded or designed space, from an impulse response.
+///
+/// The first two channels are convolved with the first two channels of the response, a mono response feeding both
+/// sides; other channels only keep the dry signal. Convolution runs by `dsp::Convolver`, whose partitions past the
+/// first few are summed on the context's `ConvolutionThread`, so responses several seconds long stay cheap on the
+/// audio thread. The wet signal lags the dry by `dsp::Convolver::BlockFrames` frames.
+class ConvolutionEffect final : public AudioEffect {
+public:
+    /// Parameter indices, see `AudioEffect::setParam`
+    enum Param : Int {
+        Wet,        ///< share of the convolved signal in the output, the dry signal is `1 - Wet`; ramped
+        ParamCount,
+    };
+
+    ConvolutionEffect();
+    ConvolutionEffect(ConvolutionEffect &&other) noexcept;
+    ~ConvolutionEffect() override;
+
+    /// \param[in]  wet  share of the convolved signal in the output, dry is `1 - wet` [optional, default: `0.3`]
+    auto init_(Float wet = .3f) -> Bool;
+
+    auto release_() -> void override;
+
+    auto processInPlace(Float *io, Int64 count) -> Bool override;
+
+    /// Load an impulse response from a sound file, decoded and resampled to the context's sample rate. The new
+    /// response replaces the current one from the next audio block. Owning thread only.
+    /// \param[in]  filepath   path to the sound file
+    /// \param[in]  normalize  whether to scale the response to unit energy, so the tail is about as loud as the
+    ///                        dry signal whatever its length [optional, default: `True`]
+    /// \returns whether the response was loaded.
+    auto loadImpulse(const String &filepath, Bool normalize = True) -> Bool;
+
+    /// Load an impulse response from an in-memory sound file. Owning thread only.
+    /// \param[in]  mem        sound file data
+    /// \param[in]  normalize  whether to scale the response to unit energy [optional, default: `True`]
+    /// \returns whether the response was loaded.
+    auto loadImpulse(MemView<void> mem, Bool normalize = True) -> Bool;
+
+    /// Use interleaved frames as the impulse response, already at the context's sample rate. Owning thread only.
+    /// \param[in]  frames     interleaved samples
+    /// \param[in]  count      number of frames
+    /// \param[in]  channels   interleaved channels in `frames`
+    /// \param[in]  normalize  whether to scale the response to unit energy [optional, default: `True`]
+    /// \returns whether the response was set.
+    auto setImpulse(const Float *frames, Int64 count, Int channels, Bool normalize = True) -> Bool;
+
+    /// \returns the number of frames in the impulse response, `0` while none is loaded
+    [[nodiscard]]
+    auto getImpulseFrames() const -> Int64;
+
+    // ----- getters / setters -----
+
+    auto wetDry(Float value) -> void;
+    [[nodiscard]]
+    auto wetDry() const -> Float { return m_params[Wet].get(); }
+
+protected:
+    /// Rebuild the convolver of a loaded response for the current channel count
+    auto prepare() -> void override;
+
+private:
+    auto getParamsImpl(Int *outCount) -> AudioParam * override;
+
+    /// Build a convolver from `m_impulse` and hand it to the audio thread. Owning thread.
+    auto rebuild() -> Bool;
+
+    /// Unregister and delete a convolver the audio thread no longer holds. Owning thread.
+    auto destroy(dsp::Convolver *convolver) -> void;
+
+    AudioParam m_params[ParamCount];
+
+    // Owning thread
+    AlignedList<Float, 16> m_impulse;  ///< interleaved response, scaled
+    Int m_impulseChannels;
+    ConvolutionThread *m_thread;       ///< set before the first convolver is handed over
+
+    // Shared: a new convolver waits in `m_pending` until the audio thread swaps it in, and the one it replaces
+    // waits in `m_retired` until the owning thread deletes it
+    std::atomic<dsp::Convolver *> m_pending;
+    std::atomic<dsp::Convolver *> m_retired;
+
+    // Audio thread
+    dsp::Convolver *m_active;
+};
+
+KSND_NS_END
@@ -6,31 +6,45 @@ KSND_NS_BEGIN
 
 class DelayEffect final : public AudioEffect {
     public:
+        /// Parameter indices, see `AudioEffect::setParam`
+        enum Param : Int {
+            DelayTime,  ///< delay in sample frames, up to the length set on init; jumps
+            Feedback,   ///< share of the input captured into the delay line; ramped
+            Wet,        ///< share of the delayed signal in the output, the dry signal is `1 - Wet`; ramped
+            ParamCount,
+        };
+
+        /// Shortest delay time in sample frames, the number of samples per WebAudio frame
+        static constexpr Uint64 MinDelayTime = 256;
+
         DelayEffect();
         ~DelayEffect() override = default;
         DelayEffect(DelayEffect &&other) noexcept;
 
         /// Initialize the DelayEffect
-        /// @param delayTime number of samples to delay
-        /// @param wet       percentage of the effect signal to output, dry signal is calculated as `1.f - wet`.
-        /// @param feedback  percentage of signal to capture
-        bool init_(Uint64 delayTime, Float wet, Float feedback);
+        /// @param delayTime     number of samples to delay
+        /// @param wet           percentage of the effect signal to output, dry signal is calculated as `1.f - wet`.
+        /// @param feedback      percentage of signal to capture
+        /// @param maxDelayTime  longest delay time `delayTime` may be set to later, which sizes the delay line
+        ///                      [optional, default: `0`, the initial `delayTime`]
+        bool init_(Uint64 delayTime, Float wet, Float feedback, Uint64 maxDelayTime = 0);
 
-        bool process(const Float *input, Float *output, Int64 count) override;
+        bool processInPlace(Float *io, Int64 count) override;
 
-        /// Set the delay time in sample frames, (use engine spec to find sample rate)
+        /// Set the delay time in sample frames, (use engine spec to find sample rate), clamped to the range
+        /// given on init
         void delayTime(Uint64 samples);
 
         /// Get the current delay time in sample frames
         [[nodiscard]]
-        auto delayTime() const { return m_delayTime; }
+        auto delayTime() const -> Uint64 { return static_cast<Uint64>(m_params[DelayTime].getInt()); }
 
         /// Set the input feedback percentage, where 0 = 0% through 1.f = 100%
         void feedback(Float value);
 
         /// Get the input feedback percentage, where 0 = 0% through 1.f = 100%
         [[nodiscard]]
-        Float feedback() const { return m_feedback; }
+        Float feedback() const { return m_params[Feedback].get(); }
 
         /// Set the wet and dry signal percentages at once, where the value of the wet signal is equal to `value`,
         /// and dry is `1.f - value`.
@@ -43,24 +57,21 @@ class DelayEffect final : public AudioEffect {
         /// For example, 0 results in 0% wet signal (no effect applied with 100% dry
         /// signal), and 1.f results in 100% of the wet signal and 0% of the dry.
         [[nodiscard]]
-        Float wetDry() const { return m_wet; }
+        Float wetDry() const { return m_params[Wet].get(); }
 
     protected:
-        enum Enum
-        {
-            DelayTime,
-            Feedback,
-            Wet,
-        };
+        /// Size the delay line for the source's channel count
+        auto prepare() -> void override;
 
+    private:
+        auto getParamsImpl(Int *outCount) -> AudioParam * override;
 
-        auto receiveParam(Int index, const Param &value) -> void override;
+        /// Samples processed per step while wet or feedback ramps
+        static constexpr Int64 RampStep = 64;
 
-    private:
         AlignedList<Float, 16> m_buffer;
-        Uint64 m_delayTime; // delay time in sample frames
-        Float m_feedback;
-        Float m_wet;
+        AudioParam m_params[ParamCount];
+        Uint64 m_maxDelayTime; // delay line length in sample frames
 
         Uint64 m_delayHead;
     };
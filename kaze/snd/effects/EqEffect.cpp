@@ -0,0 +1,117 @@
+#include "EqEffect.h"
+
+#include <kaze/core/errors.h>
+
+KSND_NS_BEGIN
+
+/// Design of each band after `init_`
+static constexpr dsp::BiquadDesign DefaultBands[EqEffect::BandCount] = {
+    {.type = FilterType::LowShelf, .frequency = 100.f, .q = 0.7071f, .gain = 0},
+    {.type = FilterType::Peaking, .frequency = 500.f, .q = 1.f, .gain = 0},
+    {.type = FilterType::Peaking, .frequency = 2000.f, .q = 1.f, .gain = 0},
+    {.type = FilterType::HighShelf, .frequency = 8000.f, .q = 0.7071f, .gain = 0},
+};
+
+/// Display names of each band's parameters
+static constexpr Cstring BandParamNames[EqEffect::BandCount][EqEffect::BandParamCount] = {
+    {"Band 1 Type", "Band 1 Frequency", "Band 1 Q", "Band 1 Gain"},
+    {"Band 2 Type", "Band 2 Frequency", "Band 2 Q", "Band 2 Gain"},
+    {"Band 3 Type", "Band 3 Frequency", "Band 3 Q", "Band 3 Gain"},
+    {"Band 4 Type", "Band 4 Frequency", "Band 4 Q", "Band 4 Gain"},
+};
+
+EqEffect::EqEffect() : AudioEffect(ProcessMode::InPlace), m_params(), m_cascade()
+{
+    m_params.reserve(BandCount * BandParamCount);
+    for (Int band = 0; band < BandCount; ++band)
+    {
+        const auto &design = DefaultBands[band];
+        const auto names = BandParamNames[band];
+        m_params.emplace_back(names[Type], ParamType::Enum, static_cast<Float>(design.type), 0.f,
+            static_cast<Float>(FilterType::Count) - 1.f);
+        m_params.emplace_back(names[Frequency], ParamType::Float, design.frequency, 10.f, 48000.f);
+        m_params.emplace_back(names[Q], ParamType::Float, design.q, 0.1f, 24.f);
+        m_params.emplace_back(names[Gain], ParamType::Float, design.gain, -48.f, 48.f);
+    }
+}
+
+EqEffect::EqEffect(EqEffect &&other) noexcept : AudioEffect(std::move(other)),
+    m_params(std::move(other.m_params)), m_cascade(std::move(other.m_cascade))
+{
+}
+
+auto EqEffect::init_() -> Bool
+{
+    for (Int band = 0; band < BandCount; ++band)
+    {
+        const auto &design = DefaultBands[band];
+        m_params[getParamIndex(band, Type)].reset(static_cast<Float>(design.type));
+        m_params[getParamIndex(band, Frequency)].reset(design.frequency);
+        m_params[getParamIndex(band, Q)].reset(design.q);
+        m_params[getParamIndex(band, Gain)].reset(design.gain);
+    }
+
+    m_cascade.clear();
+    return True;
+}
+
+auto EqEffect::prepare() -> void
+{
+    m_cascade.prepare(BandCount, channels());
+}
+
+auto EqEffect::processInPlace(Float *io, const Int64 count) -> Bool
+{
+    dsp::BiquadDesign from[BandCount], to[BandCount];
+    for (Int band = 0; band < BandCount; ++band)
+    {
+        const auto params = m_params.data() + getParamIndex(band, Type);
+        const auto type = static_cast<FilterType>(params[Type].nextRamp().end);
+        const auto frequency = params[Frequency].nextRamp();
+        const auto q = params[Q].nextRamp();
+        const auto gain = params[Gain].nextRamp();
+
+        from[band] = {.type = type, .frequency = frequency.start, .q = q.start, .gain = gain.start};
+        to[band] = {.type = type, .frequency = frequency.end, .q = q.end, .gain = gain.end};
+    }
+
+    m_cascade.process(io, count / channels(), from, to, BandCount, context()->getSpec().freq);
+    return True;
+}
+
+auto EqEffect::setBand(const Int band, const FilterType type, const Float frequency, const Float q,
+    const Float gain) -> Bool
+{
+    if (band < 0 || band >= BandCount)
+    {
+        KAZE_PUSH_ERR(Error::OutOfRange, "EqEffect band {} is out of range [0, {})", band, BandCount);
+        return False;
+    }
+
+    m_params[getParamIndex(band, Type)].set(static_cast<Float>(type));
+    m_params[getParamIndex(band, Frequency)].set(frequency);
+    m_params[getParamIndex(band, Q)].set(q);
+    m_params[getParamIndex(band, Gain)].set(gain);
+    return True;
+}
+
+auto EqEffect::getBand(const Int band) const -> dsp::BiquadDesign
+{
+    if (band < 0 || band >= BandCount)
+        return {.type = FilterType::Peaking, .frequency = 1000.f, .q = 1.f, .gain = 0};
+
+    return {
+        .type = static_cast<FilterType>(m_params[getParamIndex(band, Type)].getInt()),
+        .frequency = m_params[getParamIndex(band, Frequency)].get(),
+        .q = m_params[getParamIndex(band, Q)].get(),
+        .gain = m_params[getParamIndex(band, Gain)].get(),
+    };
+}
+
+auto EqEffect::getParamsImpl(Int *outCount) -> AudioParam *
+{
+    *outCount = static_cast<Int>(m_params.size());
+    return m_params.data();
+}
+
+KSND_NS_END
@@ -0,0 +1,66 @@
+#pragma once
+#include <kaze/snd/lib.h>
+#include <kaze/snd/AudioEffect.h>
+#include <kaze/snd/dsp/Biquad.h>
+
+KSND_NS_BEGIN
+
+/// Parametric equalizer of `BandCount` biquad bands in cascade. Bands start as a low shelf at 100 Hz, peaks at
+/// 500 Hz and 2 kHz, and a high shelf at 8 kHz, all flat.
+class EqEffect final : public AudioEffect {
+public:
+    /// Number of bands
+    static constexpr Int BandCount = 4;
+
+    /// Parameters of each band
+    enum BandParam : Int {
+        Type,      ///< `FilterType` index; jumps
+        Frequency, ///< cutoff or center in Hz; ramped on a log scale
+        Q,         ///< resonance or bandwidth; ramped
+        Gain,      ///< boost or cut in dB for peaking and shelf bands; ramped
+        BandParamCount,
+    };
+
+    /// \param[in]  band   band index, from `0` to `BandCount - 1`
+    /// \param[in]  param  parameter of the band
+    /// \returns index to pass to `AudioEffect::setParam`
+    [[nodiscard]]
+    static constexpr auto getParamIndex(const Int band, const BandParam param) -> Int
+    {
+        return band * BandParamCount + param;
+    }
+
+    EqEffect();
+    EqEffect(EqEffect &&other) noexcept;
+
+    /// Reset every band to its default, flat
+    auto init_() -> Bool;
+
+    auto processInPlace(Float *io, Int64 count) -> Bool override;
+
+    /// Set all of a band's parameters at once
+    /// \param[in]  band       band index, from `0` to `BandCount - 1`
+    /// \param[in]  type       frequency response
+    /// \param[in]  frequency  cutoff or center in Hz
+    /// \param[in]  q          resonance or bandwidth
+    /// \param[in]  gain       boost or cut in dB for peaking and shelf bands
+    /// \returns whether `band` is in range.
+    auto setBand(Int band, FilterType type, Float frequency, Float q, Float gain) -> Bool;
+
+    /// \param[in]  band  band index, from `0` to `BandCount - 1`
+    /// \returns the band's current design, or a flat peak if `band` is out of range.
+    [[nodiscard]]
+    auto getBand(Int band) const -> dsp::BiquadDesign;
+
+protected:
+    /// Size the filter state for the source's channel count
+    auto prepare() -> void override;
+
+private:
+    auto getParamsImpl(Int *outCount) -> AudioParam * override;
+
+    List<AudioParam> m_params;
+    dsp::BiquadCascade m_cascade;
+};
+
+KSND_NS_END
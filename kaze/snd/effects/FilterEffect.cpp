@@ -0,0 +1,99 @@
+#include "FilterEffect.h"
+
+KSND_NS_BEGIN
+
+FilterEffect::FilterEffect() : AudioEffect(ProcessMode::InPlace),
+    m_params{
+        {"Type", ParamType::Enum, static_cast<Float>(FilterType::LowPass), 0,
+            static_cast<Float>(FilterType::Count) - 1.f},
+        {"Frequency", ParamType::Float, 20000.f, 10.f, 48000.f},
+        {"Q", ParamType::Float, 0.7071f, 0.1f, 24.f},
+        {"Gain", ParamType::Float, 0, -48.f, 48.f},
+        {"Stages", ParamType::Int, 1.f, 1.f, static_cast<Float>(MaxStages)},
+    },
+    m_cascade()
+{
+}
+
+FilterEffect::FilterEffect(FilterEffect &&other) noexcept :
+    AudioEffect(std::move(other)),
+    m_params{
+        std::move(other.m_params[Type]),
+        std::move(other.m_params[Frequency]),
+        std::move(other.m_params[Q]),
+        std::move(other.m_params[Gain]),
+        std::move(other.m_params[Stages]),
+    },
+    m_cascade(std::move(other.m_cascade))
+{
+}
+
+auto FilterEffect::init_(const FilterType type, const Float frequency, const Float q, const Float gain,
+    const Int stages) -> Bool
+{
+    m_params[Type].reset(static_cast<Float>(type));
+    m_params[Frequency].reset(frequency);
+    m_params[Q].reset(q);
+    m_params[Gain].reset(gain);
+    m_params[Stages].reset(static_cast<Float>(stages));
+    m_cascade.clear();
+    return True;
+}
+
+auto FilterEffect::prepare() -> void
+{
+    m_cascade.prepare(MaxStages, channels());
+}
+
+auto FilterEffect::processInPlace(Float *io, const Int64 count) -> Bool
+{
+    const auto type = static_cast<FilterType>(m_params[Type].nextRamp().end);
+    const auto frequency = m_params[Frequency].nextRamp();
+    const auto q = m_params[Q].nextRamp();
+    const auto gain = m_params[Gain].nextRamp();
+    const auto stages = static_cast<Int>(m_params[Stages].nextRamp().end);
+
+    // Every section shares one design
+    dsp::BiquadDesign from[MaxStages], to[MaxStages];
+    for (Int s = 0; s < stages; ++s)
+    {
+        from[s] = {.type = type, .frequency = frequency.start, .q = q.start, .gain = gain.start};
+        to[s] = {.type = type, .frequency = frequency.end, .q = q.end, .gain = gain.end};
+    }
+
+    m_cascade.process(io, count / channels(), from, to, stages, context()->getSpec().freq);
+    return True;
+}
+
+auto FilterEffect::getParamsImpl(Int *outCount) -> AudioParam *
+{
+    *outCount = ParamCount;
+    return m_params;
+}
+
+auto FilterEffect::type(const FilterType value) -> void
+{
+    m_params[Type].set(static_cast<Float>(value));
+}
+
+auto FilterEffect::frequency(const Float hz) -> void
+{
+    m_params[Frequency].set(hz);
+}
+
+auto FilterEffect::q(const Float value) -> void
+{
+    m_params[Q].set(value);
+}
+
+auto FilterEffect::gain(const Float db) -> void
+{
+    m_params[Gain].set(db);
+}
+
+auto FilterEffect::stages(const Int value) -> void
+{
+    m_params[Stages].set(static_cast<Float>(value));
+}
+
+KSND_NS_END
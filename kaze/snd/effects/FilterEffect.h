@@ -0,0 +1,71 @@
+#pragma once
+#include <kaze/snd/lib.h>
+#include <kaze/snd/AudioEffect.h>
+#include <kaze/snd/dsp/Biquad.h>
+
+KSND_NS_BEGIN
+
+/// Low-pass, high-pass, band-pass, notch, shelf or peaking filter, e.g. to muffle occluded or underwater voices.
+/// Identical biquad sections run in cascade for steeper slopes.
+class FilterEffect final : public AudioEffect {
+public:
+    /// Parameter indices, see `AudioEffect::setParam`
+    enum Param : Int {
+        Type,       ///< `FilterType` index; jumps
+        Frequency,  ///< cutoff or center in Hz; ramped on a log scale
+        Q,          ///< resonance, `0.7071` is the flattest pass band; ramped
+        Gain,       ///< boost or cut in dB for peaking and shelf filters; ramped
+        Stages,     ///< number of sections in cascade, each adds 12 dB per octave to a pass filter's slope; jumps
+        ParamCount,
+    };
+
+    /// Most sections in cascade
+    static constexpr Int MaxStages = 4;
+
+    FilterEffect();
+    FilterEffect(FilterEffect &&other) noexcept;
+
+    /// \param[in]  type       frequency response
+    /// \param[in]  frequency  cutoff or center in Hz
+    /// \param[in]  q          resonance [optional, default: `0.7071`]
+    /// \param[in]  gain       boost or cut in dB for peaking and shelf filters [optional, default: `0`]
+    /// \param[in]  stages     sections in cascade, from `1` to `MaxStages` [optional, default: `1`]
+    auto init_(FilterType type = FilterType::LowPass, Float frequency = 20000.f, Float q = 0.7071f,
+        Float gain = 0, Int stages = 1) -> Bool;
+
+    auto processInPlace(Float *io, Int64 count) -> Bool override;
+
+    // ----- getters / setters -----
+
+    auto type(FilterType value) -> void;
+    [[nodiscard]]
+    auto type() const -> FilterType { return static_cast<FilterType>(m_params[Type].getInt()); }
+
+    auto frequency(Float hz) -> void;
+    [[nodiscard]]
+    auto frequency() const -> Float { return m_params[Frequency].get(); }
+
+    auto q(Float value) -> void;
+    [[nodiscard]]
+    auto q() const -> Float { return m_params[Q].get(); }
+
+    auto gain(Float db) -> void;
+    [[nodiscard]]
+    auto gain() const -> Float { return m_params[Gain].get(); }
+
+    auto stages(Int value) -> void;
+    [[nodiscard]]
+    auto stages() const -> Int { return m_params[Stages].getInt(); }
+
+protected:
+    /// Size the filter state for the source's channel count
+    auto prepare() -> void override;
+
+private:
+    auto getParamsImpl(Int *outCount) -> AudioParam * override;
+
+    AudioParam m_params[ParamCount];
+    dsp::BiquadCascade m_cascade;
+};
+
+KSND_NS_END
@@ -0,0 +1,88 @@
+#include "LimiterEffect.h"
+
+#include <algorithm>
+#include <cmath>
+
+KSND_NS_BEGIN
+
+LimiterEffect::LimiterEffect() : AudioEffect(ProcessMode::InPlace),
+    m_params{
+        {"Ceiling", ParamType::Float, -1.f, -24.f, 0},
+        {"Release", ParamType::Float, 100.f, 1.f, 2000.f},
+        {"Lookahead", ParamType::Int, 5.f, 0, static_cast<Float>(MaxLookahead)},
+    },
+    m_dynamics()
+{
+}
+
+LimiterEffect::LimiterEffect(LimiterEffect &&other) noexcept :
+    AudioEffect(std::move(other)),
+    m_params{
+        std::move(other.m_params[Ceiling]),
+        std::move(other.m_params[Release]),
+        std::move(other.m_params[Lookahead]),
+    },
+    m_dynamics(std::move(other.m_dynamics)),
+    m_gainReduction(other.m_gainReduction.load(std::memory_order_relaxed))
+{
+}
+
+auto LimiterEffect::init_(const Float ceiling, const Float release, const Int lookahead) -> Bool
+{
+    m_params[Ceiling].reset(ceiling);
+    m_params[Release].reset(release);
+    m_params[Lookahead].reset(static_cast<Float>(lookahead));
+    m_dynamics.clear();
+    m_gainReduction.store(0, std::memory_order_relaxed);
+    return True;
+}
+
+auto LimiterEffect::prepare() -> void
+{
+    m_dynamics.prepare(channels(), context()->getSpec().freq);
+}
+
+auto LimiterEffect::processInPlace(Float *io, const Int64 count) -> Bool
+{
+    // An infinite ratio with an instant attack: the gain each block needs is reached by the time it plays
+    const dsp::DynamicsSettings settings{
+        .threshold = m_params[Ceiling].nextRamp().end,
+        .ratio = 0,
+        .knee = 0,
+        .attack = 0,
+        .release = m_params[Release].nextRamp().end * .001f,
+        .lookahead = m_params[Lookahead].nextRamp().end * .001f,
+        .detector = DetectorMode::Peak,
+    };
+
+    const auto gain = m_dynamics.process(io, count / channels(), Null, 0, settings, 1.f, 1.f);
+    m_gainReduction.store(-20.f * std::log10(gain), std::memory_order_relaxed);
+
+    const auto ceiling = std::pow(10.f, settings.threshold / 20.f);
+    for (Int64 i = 0; i < count; ++i)
+        io[i] = std::clamp(io[i], -ceiling, ceiling);
+    return True;
+}
+
+auto LimiterEffect::getParamsImpl(Int *outCount) -> AudioParam *
+{
+    *outCount = ParamCount;
+    return m_params;
+}
+
+auto LimiterEffect::ceiling(const Float db) -> void
+{
+    m_params[Ceiling].set(db);
+}
+
+auto LimiterEffect::release(const Float milliseconds) -> void
+{
+    m_params[Release].set(milliseconds);
+}
+
+auto LimiterEffect::lookahead(const Int milliseconds) -> void
+{
+    m_params[Lookahead].set(static_cast<Float>(milliseconds));
+}
+
+KSND_NS_END
@@ -0,0 +1,68 @@
+#pragma once
+#include <kaze/snd/lib.h>
+#include <kaze/snd/AudioEffect.h>
+#include <kaze/snd/dsp/Dynamics.h>
+
+#include <atomic>
+
+KSND_NS_BEGIN
+
+/// Brickwall peak limiter, e.g. last on the master bus so that many loud voices at once never clip the device.
+///
+/// The output is delayed by the lookahead so that gain ramps down ahead of each peak instead of distorting it, and
+/// is clamped to the ceiling in case a peak still gets through, e.g. with no lookahead.
+class LimiterEffect final : public AudioEffect {
+public:
+    /// Parameter indices, see `AudioEffect::setParam`
+    enum Param : Int {
+        Ceiling,    ///< highest peak out in dB; applied per buffer
+        Release,    ///< milliseconds for the gain to recover 63% of the way after a peak; applied per buffer
+        Lookahead,  ///< milliseconds the output is delayed by, up to `MaxLookahead`; jumps
+        ParamCount,
+    };
+
+    /// Longest lookahead in milliseconds
+    static constexpr Int MaxLookahead = 10;
+
+    LimiterEffect();
+    LimiterEffect(LimiterEffect &&other) noexcept;
+
+    /// \param[in]  ceiling    highest peak out in dB [optional, default: `-1`]
+    /// \param[in]  release    milliseconds for the gain to recover [optional, default: `100`]
+    /// \param[in]  lookahead  milliseconds the output is delayed by [optional, default: `5`]
+    auto init_(Float ceiling = -1.f, Float release = 100.f, Int lookahead = 5) -> Bool;
+
+    auto processInPlace(Float *io, Int64 count) -> Bool override;
+
+    /// Deepest gain reduction in dB over the last buffer processed, positive while limiting. Any thread, without
+    /// locking, e.g. to draw a meter.
+    [[nodiscard]]
+    auto gainReduction() const -> Float { return m_gainReduction.load(std::memory_order_relaxed); }
+
+    // ----- getters / setters -----
+
+    auto ceiling(Float db) -> void;
+    [[nodiscard]]
+    auto ceiling() const -> Float { return m_params[Ceiling].get(); }
+
+    auto release(Float milliseconds) -> void;
+    [[nodiscard]]
+    auto release() const -> Float { return m_params[Release].get(); }
+
+    auto lookahead(Int milliseconds) -> void;
+    [[nodiscard]]
+    auto lookahead() const -> Int { return m_params[Lookahead].getInt(); }
+
+protected:
+    /// Size the lookahead delay for the channel count and clear the detector
+    auto prepare() -> void override;
+
+private:
+    auto getParamsImpl(Int *outCount) -> AudioParam * override;
+
+    AudioParam m_params[ParamCount];
+    dsp::Dynamics m_dynamics;
+    std::atomic<Float> m_gainReduction{}; ///< written by the audio thread, readable from any thread
+};
+
+KSND_NS_END
@@ -6,16 +6,28 @@ KSND_NS_BEGIN
 
 class PanEffect : public AudioEffect {
 public:
-    PanEffect() : m_left(1.f), m_right(1.f) { }
-    PanEffect(Float left, Float right) : m_left(left), m_right(right) { }
+    /// Parameter indices, see `AudioEffect::setParam`
+    enum Param : Int {
+        Left,       ///< share of the left input kept on the left, the rest moves right; ramped
+        Right,      ///< share of the right input kept on the right, the rest moves left; ramped
+        ParamCount,
+    };
+
+    PanEffect() : PanEffect(1.f, 1.f) { }
+    PanEffect(Float left, Float right) : AudioEffect(ProcessMode::InPlace),
+        m_params{
+            {"Left", ParamType::Float, left, 0, 1.f},
+            {"Right", ParamType::Float, right, 0, 1.f},
+        }
+    { }
     PanEffect(PanEffect &&other) noexcept;
 
-    auto process(const Float *input, Float *output, Int64 count) -> Bool override;
+    auto processInPlace(Float *io, Int64 count) -> Bool override;
 
     auto init_(Float left = 1.f, Float right = 1.f) -> Bool
     {
-        m_left = left;
-        m_right = right;
+        m_params[Left].reset(left);
+        m_params[Right].reset(right);
         return True;
     }
 
@@ -25,19 +37,21 @@ public:
     auto right(Float value) -> void;
 
     [[nodiscard]]
-    auto left() const { return m_left; }
+    auto left() const { return m_params[Left].get(); }
     [[nodiscard]]
-    auto right() const { return m_right; }
+    auto right() const { return m_params[Right].get(); }
 
-private:
-    enum Enum {
-        Left,
-        Right
-    };
+    /// \returns ramps of the balance over the block last processed, which mono sources leave to their parent bus
+    ///          to apply. Audio thread only.
+    [[nodiscard]]
+    auto leftRamp() const -> AudioParam::Ramp { return m_params[Left].lastRamp(); }
+    [[nodiscard]]
+    auto rightRamp() const -> AudioParam::Ramp { return m_params[Right].lastRamp(); }
 
-    auto receiveParam(Int index, const Param &value) -> void override;
+private:
+    auto getParamsImpl(Int *outCount) -> AudioParam * override;
 
-    float m_left, m_right;
+    AudioParam m_params[ParamCount];
 };
 
 KSND_NS_END
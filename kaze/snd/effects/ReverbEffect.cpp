@@ -0,0 +1,198 @@
+#include "ReverbEffect.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+KSND_NS_BEGIN
+
+namespace {
+    /// Line lengths in frames at 48 kHz, mutually prime so that echoes of different lines rarely coincide
+    constexpr Double BaseDelays[dsp::FdnLines] = {1063, 1201, 1327, 1451, 1559, 1693, 1811, 1949};
+
+    /// `1 / sqrt(FdnLines)`, keeping the power of the input and of each output near that of one line
+    constexpr Float LineGain = .35355339f;
+
+    /// Signs of the input into each line, and of each line in the left and right output. The three are mutually
+    /// orthogonal, which decorrelates the two sides of the tail.
+    constexpr Float InputSigns[dsp::FdnLines] = {1, 1, 1, 1, -1, -1, -1, -1};
+    constexpr Float LeftSigns[dsp::FdnLines] = {1, -1, 1, -1, 1, -1, 1, -1};
+    constexpr Float RightSigns[dsp::FdnLines] = {1, 1, -1, -1, 1, 1, -1, -1};
+
+    /// Low-pass coefficient at full damping
+    constexpr Float MaxDamping = .9f;
+}
+
+ReverbEffect::ReverbEffect() : AudioEffect(ProcessMode::InPlace),
+    m_params{
+        {"Decay Time", ParamType::Float, 1.5f, .1f, 30.f},
+        {"Damping", ParamType::Float, .3f, 0, 1.f},
+        {"Size", ParamType::Float, 1.f, MinSize, MaxSize},
+        {"Pre-Delay", ParamType::Int, 10.f, 0, static_cast<Float>(MaxPreDelay)},
+        {"Wet", ParamType::Float, .3f, 0, 1.f},
+    },
+    m_lines(), m_preDelay(), m_preDelayHead(), m_fdn(), m_sampleRate(), m_roomSize(), m_roomDecayTime()
+{
+    for (Int i = 0; i < dsp::FdnLines; ++i)
+    {
+        m_fdn.inputGains[i] = InputSigns[i] * LineGain;
+        m_fdn.leftGains[i] = LeftSigns[i] * LineGain;
+        m_fdn.rightGains[i] = RightSigns[i] * LineGain;
+    }
+}
+
+ReverbEffect::ReverbEffect(ReverbEffect &&other) noexcept :
+    AudioEffect(std::move(other)),
+    m_params{
+        std::move(other.m_params[DecayTime]),
+        std::move(other.m_params[Damping]),
+        std::move(other.m_params[Size]),
+        std::move(other.m_params[PreDelay]),
+        std::move(other.m_params[Wet]),
+    },
+    m_lines(std::move(other.m_lines)), m_preDelay(std::move(other.m_preDelay)),
+    m_preDelayHead(other.m_preDelayHead), m_fdn(other.m_fdn), m_sampleRate(other.m_sampleRate),
+    m_roomSize(other.m_roomSize), m_roomDecayTime(other.m_roomDecayTime)
+{
+}
+
+auto ReverbEffect::init_(const Float decayTime, const Float damping, const Float size, const Int preDelay,
+    const Float wet) -> Bool
+{
+    m_params[DecayTime].reset(decayTime);
+    m_params[Damping].reset(damping);
+    m_params[Size].reset(size);
+    m_params[PreDelay].reset(static_cast<Float>(preDelay));
+    m_params[Wet].reset(wet);
+    return True;
+}
+
+auto ReverbEffect::prepare() -> void
+{
+    m_sampleRate = std::max(context()->getSpec().freq, 1);
+
+    // Every line shares one ring, long enough for the longest line in the largest room
+    const auto longest = static_cast<Uint64>(std::ceil(BaseDelays[dsp::FdnLines - 1] * MaxSize * m_sampleRate /
+        48000.0));
+    const auto ringFrames = std::bit_ceil(longest + 1);
+    m_lines.assign(ringFrames * dsp::FdnLines, 0);
+    m_fdn.lines = m_lines.data();
+    m_fdn.mask = ringFrames - 1;
+    m_fdn.position = 0;
+    std::fill(std::begin(m_fdn.lowpass), std::end(m_fdn.lowpass), 0.f);
+
+    m_preDelay.assign(std::bit_ceil(static_cast<Uint64>(MaxPreDelay) * m_sampleRate / 1000 + 1), 0);
+    m_preDelayHead = 0;
+
+    setRoom(m_params[Size].get(), m_params[DecayTime].get());
+}
+
+auto ReverbEffect::setRoom(const Float size, const Float decayTime) -> void
+{
+    const auto scale = static_cast<Double>(size) * m_sampleRate / 48000.0;
+    for (Int i = 0; i < dsp::FdnLines; ++i)
+    {
+        const auto delay = std::clamp<Uint64>(static_cast<Uint64>(std::lround(BaseDelays[i] * scale)), 1,
+            m_fdn.mask);
+        m_fdn.delays[i] = delay;
+
+        // Lose 60 dB over the passes a sample makes through this line in `decayTime` seconds
+        m_fdn.feedbackGains[i] = static_cast<Float>(std::pow(10.0,
+            -3.0 * static_cast<Double>(delay) / (static_cast<Double>(decayTime) * m_sampleRate)));
+    }
+
+    m_roomSize = size;
+    m_roomDecayTime = decayTime;
+}
+
+auto ReverbEffect::processInPlace(Float *io, const Int64 count) -> Bool
+{
+    const auto decayTime = m_params[DecayTime].nextRamp().end;
+    const auto damping = m_params[Damping].nextRamp().end;
+    const auto size = m_params[Size].nextRamp().end;
+    const auto preDelay = static_cast<Uint64>(m_params[PreDelay].nextRamp().end) * m_sampleRate / 1000;
+    const auto wet = m_params[Wet].nextRamp();
+
+    if (size != m_roomSize || decayTime != m_roomDecayTime)
+        setRoom(size, decayTime);
+    m_fdn.damping = damping * MaxDamping;
+
+    const auto channels = this->channels();
+    const auto frames = count / channels;
+    const auto preDelayMask = m_preDelay.size() - 1;
+    const auto &kernels = dsp::getKernels();
+
+    Float input[ChunkFrames], left[ChunkFrames], right[ChunkFrames];
+    for (Int64 offset = 0; offset < frames; offset += ChunkFrames)
+    {
+        const auto chunk = std::min(ChunkFrames, frames - offset);
+        const auto samples = io + offset * channels;
+
+        // Sum the first two channels into the network, held back by the pre-delay
+        for (Int64 k = 0; k < chunk; ++k)
+        {
+            const auto frame = samples + k * channels;
+            m_preDelay[m_preDelayHead] = channels == 1 ? frame[0] : (frame[0] + frame[1]) * .5f;
+            input[k] = m_preDelay[(m_preDelayHead - preDelay) & preDelayMask];
+            m_preDelayHead = (m_preDelayHead + 1) & preDelayMask;
+        }
+
+        kernels.fdn(input, left, right, chunk, &m_fdn);
+
+        // Step through the wet ramp once per chunk, small enough that the steps are not heard
+        const auto t = static_cast<Float>(offset) / static_cast<Float>(frames);
+        const auto wetValue = wet.isSteady() ? wet.end : wet.start + (wet.end - wet.start) * t;
+        const auto dry = 1.f - wetValue;
+
+        if (channels == 1)
+        {
+            for (Int64 k = 0; k < chunk; ++k)
+                samples[k] = samples[k] * dry + (left[k] + right[k]) * (.5f * wetValue);
+            continue;
+        }
+
+        for (Int64 k = 0; k < chunk; ++k)
+        {
+            const auto frame = samples + k * channels;
+            frame[0] = frame[0] * dry + left[k] * wetValue;
+            frame[1] = frame[1] * dry + right[k] * wetValue;
+            for (Int ch = 2; ch < channels; ++ch)
+                frame[ch] *= dry;
+        }
+    }
+
+    return True;
+}
+
+auto ReverbEffect::getParamsImpl(Int *outCount) -> AudioParam *
+{
+    *outCount = ParamCount;
+    return m_params;
+}
+
+auto ReverbEffect::decayTime(const Float seconds) -> void
+{
+    m_params[DecayTime].set(seconds);
+}
+
+auto ReverbEffect::damping(const Float value) -> void
+{
+    m_params[Damping].set(value);
+}
+
+auto ReverbEffect::size(const Float value) -> void
+{
+    m_params[Size].set(value);
+}
+
+auto ReverbEffect::preDelay(const Int milliseconds) -> void
+{
+    m_params[PreDelay].set(static_cast<Float>(milliseconds));
+}
+
+auto ReverbEffect::wetDry(const Float value) -> void
+{
+    m_params[Wet].set(value);
+}
+
+KSND_NS_END
@@ -0,0 +1,86 @@
+#pragma once
+#include <kaze/snd/lib.h>
+#include <kaze/snd/AudioEffect.h>
+#include <kaze/snd/dsp/kernels.h>
+
+KSND_NS_BEGIN
+
+/// Algorithmic room reverb from a feedback delay network of `dsp::FdnLines` lines, meant to sit on a bus that
+/// several voices send into. The first two channels are summed into the network, whose decorrelated stereo tail is
+/// mixed back over them; mono sources hear both sides of the tail, other channels only the dry signal.
+class ReverbEffect final : public AudioEffect {
+public:
+    /// Parameter indices, see `AudioEffect::setParam`
+    enum Param : Int {
+        DecayTime,  ///< seconds for the tail to fall by 60 dB; applied per block
+        Damping,    ///< high-frequency absorption, from `0` for none to `1` for the darkest tail; applied per block
+        Size,       ///< scale of the room, stretching every delay line; applied per block
+        PreDelay,   ///< milliseconds before the tail starts, up to `MaxPreDelay`; jumps
+        Wet,        ///< share of the tail in the output, the dry signal is `1 - Wet`; ramped
+        ParamCount,
+    };
+
+    /// Smallest and largest room size
+    static constexpr Float MinSize = .25f, MaxSize = 2.f;
+
+    /// Longest pre-delay in milliseconds
+    static constexpr Int MaxPreDelay = 250;
+
+    ReverbEffect();
+    ReverbEffect(ReverbEffect &&other) noexcept;
+
+    /// \param[in]  decayTime  seconds for the tail to fall by 60 dB [optional, default: `1.5`]
+    /// \param[in]  damping    high-frequency absorption from `0` to `1` [optional, default: `0.3`]
+    /// \param[in]  size       room size from `MinSize` to `MaxSize` [optional, default: `1`]
+    /// \param[in]  preDelay   milliseconds before the tail starts [optional, default: `10`]
+    /// \param[in]  wet        share of the tail in the output, dry is `1 - wet` [optional, default: `0.3`]
+    auto init_(Float decayTime = 1.5f, Float damping = .3f, Float size = 1.f, Int preDelay = 10,
+        Float wet = .3f) -> Bool;
+
+    auto processInPlace(Float *io, Int64 count) -> Bool override;
+
+    // ----- getters / setters -----
+
+    auto decayTime(Float seconds) -> void;
+    [[nodiscard]]
+    auto decayTime() const -> Float { return m_params[DecayTime].get(); }
+
+    auto damping(Float value) -> void;
+    [[nodiscard]]
+    auto damping() const -> Float { return m_params[Damping].get(); }
+
+    auto size(Float value) -> void;
+    [[nodiscard]]
+    auto size() const -> Float { return m_params[Size].get(); }
+
+    auto preDelay(Int milliseconds) -> void;
+    [[nodiscard]]
+    auto preDelay() const -> Int { return m_params[PreDelay].getInt(); }
+
+    auto wetDry(Float value) -> void;
+    [[nodiscard]]
+    auto wetDry() const -> Float { return m_params[Wet].get(); }
+
+protected:
+    /// Size the delay lines for the sample rate and clear the tail
+    auto prepare() -> void override;
+
+private:
+    auto getParamsImpl(Int *outCount) -> AudioParam * override;
+
+    /// Set the delay and feedback gain of each line for a room size and decay time
+    auto setRoom(Float size, Float decayTime) -> void;
+
+    /// Frames run through the network per kernel call, and steps of the wet ramp
+    static constexpr Int64 ChunkFrames = 64;
+
+    AudioParam m_params[ParamCount];
+    AlignedList<Float, 16> m_lines;    ///< ring of `dsp::FdnLines` interleaved lines
+    AlignedList<Float, 16> m_preDelay; ///< ring of the mono input, a power of two long
+    Uint64 m_preDelayHead;
+    dsp::FdnState m_fdn;
+    Int m_sampleRate;
+    Float m_roomSize, m_roomDecayTime; ///< values `m_fdn` was set up for
+};
+
+KSND_NS_END
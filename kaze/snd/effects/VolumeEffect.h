@@ -2,40 +2,42 @@
 #include <kaze/snd/lib.h>
 #include <kaze/snd/AudioEffect.h>
 
+#include <limits>
+
 KSND_NS_BEGIN
 
 class VolumeEffect final : public AudioEffect {
 public:
-    VolumeEffect()
-        : m_volume(1.f)
-    {
-    }
+    /// Parameter indices, see `AudioEffect::setParam`
+    enum Param : Int {
+        Volume,     ///< linear gain, ramped
+        ParamCount,
+    };
+
+    VolumeEffect() : VolumeEffect(1.f) { }
 
     VolumeEffect(VolumeEffect &&other) noexcept;
 
     auto init_(const Float volume = 1.f) -> Bool
     {
-        m_volume = volume;
-
+        m_params[Volume].reset(volume);
         return true;
     }
 
-    explicit VolumeEffect(const Float volume) : m_volume(volume) { }
+    explicit VolumeEffect(const Float volume) : AudioEffect(ProcessMode::InPlace),
+        m_params{ {"Volume", ParamType::Float, volume, 0, std::numeric_limits<Float>::max()} }
+    { }
 
-    auto process(const Float *input, Float *output, Int64 count) -> Bool override;
+    auto processInPlace(Float *io, Int64 count) -> Bool override;
 
     [[nodiscard]]
-    auto volume() const -> Float { return m_volume; }
+    auto volume() const -> Float { return m_params[Volume].get(); }
     auto volume(Float value) -> void;
 
 private:
-    auto receiveParam(Int index, const Param &value) -> void override;
-
-    enum Enum {
-        Volume,
-    };
+    auto getParamsImpl(Int *outCount) -> AudioParam * override;
 
-    float m_volume;
+    AudioParam m_params[ParamCount];
 };
 
 KSND_NS_END
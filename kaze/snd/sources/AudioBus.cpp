@@ -1,27 +1,64 @@
 #include "AudioBus.h"
-#include <kaze/core/intrinsics.h>
+#include <kaze/snd/dsp/ChannelMatrix.h>
+#include <kaze/snd/dsp/kernels.h>
 
 KSND_NS_BEGIN
 
 AudioBus::AudioBus(AudioBus &&other) noexcept :
     AudioSource(std::move(other)),
     m_sources(std::move(other.m_sources)),
+    m_grownSources(std::move(other.m_grownSources)),
+    m_sourceCapacity(other.m_sourceCapacity),
+    m_connectTicket(other.m_connectTicket),
+    m_growTicket(other.m_growTicket),
+    m_sourceCount(other.m_sourceCount.load(std::memory_order_relaxed)),
+    m_connectsApplied(other.m_connectsApplied.load(std::memory_order_relaxed)),
+    m_growsApplied(other.m_growsApplied.load(std::memory_order_relaxed)),
     m_buffer(std::move(other.m_buffer)),
     m_parent(other.m_parent),
     m_isMaster(other.m_isMaster)
 {
     other.m_sources.clear();
+    other.m_grownSources.clear();
     other.m_parent = {};
     other.m_isMaster = False;
 }
 
-auto AudioBus::init_(AudioContext *context, const Handle<AudioBus> &parent, Bool paused) -> Bool
+AudioBus::~AudioBus()
 {
+    // Left over only when the pool is destroyed without releasing the bus
+    freeGrownSources(True);
+}
+
+auto AudioBus::init_(AudioContext *context, const Handle<AudioBus> &parent, Bool paused, Int channels) -> Bool
+{
+    if (channels < 0 || channels > dsp::MaxChannels)
+    {
+        KAZE_PUSH_ERR(Error::OutOfRange, "AudioBus channel count must be in [0, {}], but got {}",
+            dsp::MaxChannels, channels);
+        return False;
+    }
+
     if ( !AudioSource::init_(context, context && parent && parent.isValid() ? parent->getClock() : 0, paused) )
         return False;
 
+    if (channels == 0 && parent && parent.isValid())
+        channels = parent->getChannels();
+    if (channels > 0)
+        setChannels(channels);
+
     m_parent = parent;
     m_isMaster = !parent;
+
+    // Connections are made on the audio thread, so reserve room to keep typical graphs from allocating there.
+    // Larger graphs grow the list from this thread, see `reserveConnections`.
+    m_sources.reserve(DefaultSourceCapacity);
+    m_sourceCapacity = m_sources.capacity();
+    m_connectTicket = 0;
+    m_growTicket = 0;
+    m_sourceCount.store(m_sources.size(), std::memory_order_relaxed);
+    m_connectsApplied.store(0, std::memory_order_relaxed);
+    m_growsApplied.store(0, std::memory_order_relaxed);
     return True;
 }
 
@@ -35,51 +72,26 @@ auto AudioBus::release(const Bool recursive) -> void
         return;
     }
 
-    if (recursive)
+    // Sub-sources belong to the graph, which only the audio thread may touch
+    Size masterTicket = 0;
+    if ( !recursive )
     {
-        // Recursively release all sources
-        for (auto &handle : m_sources)
-        {
-            if ( !handle.isValid() )
-                continue;
-
-            const auto source = handle.get();
-            if (const auto bus = dynamic_cast<AudioBus *>(source))
-            {
-                bus->release(True);
-            }
-            else
-            {
-                source->release();
-            }
-        }
+        // Make room on the master bus for the sources reconnected to it
+        if (const auto masterBus = context()->getMasterBus(); masterBus.isValid())
+            masterTicket = masterBus->reserveConnections(getConnectionBound());
     }
-    else
-    {
-        const auto masterBus = context()->getMasterBus();
-        if ( !masterBus.isValid() )
-        {
-            // Most likely, the context was closed or uninit state
-            KAZE_PUSH_ERR(Error::RuntimeErr, "Failed to get master bus from AudioContext");
-            return;
-        }
 
-        // Reconnect all children to the master bus
-        for (auto &handle : m_sources)
-        {
-            if ( !handle.isValid() )
-                continue;
-
-            AudioBus::connect(masterBus, handle);
-        }
-    }
-
-    AudioSource::release();
+    context()->pushCommand(commands::BusRelease {
+        .bus = this,
+        .recursive = recursive,
+        .masterTicket = masterTicket,
+    });
 }
 
 auto AudioBus::release_() -> void
 {
     m_sources.clear();
+    freeGrownSources(True); // the bus has left the graph, so no growth is still pending
     m_parent = {};
     AudioSource::release_();
 }
@@ -103,6 +115,7 @@ auto AudioBus::connect(const Handle<AudioBus> &bus, const Handle<AudioSource> &s
     bus->context()->pushCommand(commands::BusConnectSource {
         .bus = bus,
         .source = source,
+        .ticket = bus->reserveConnections(1),
     });
     return True;
 }
@@ -133,160 +146,123 @@ auto AudioBus::disconnect(const Handle<AudioBus> &bus, const Handle<AudioSource>
 
 auto AudioBus::readImpl(Ubyte *output, Int64 length) -> Int64
 {
-    // calculate mix
-    Int sourcei = 0;
-    for (const Int sourcemax = static_cast<Int>(m_sources.size()) - 4; sourcei <= sourcemax; sourcei += 4)
+    const auto &kernels = dsp::getKernels();
+    const auto profile = AudioProfiler::Scope(context()->getProfiler(), ProfileKind::Bus, this, typeid(AudioBus));
+
+    // Calculate mix, summing sources four at a time. Virtual sources render nothing, so only sources that
+    // produced audio are gathered. Sources with another channel count are mixed through a channel matrix, and
+    // positioned sources along their emitter's gain ramps.
+    // note: sources are guaranteed valid, since they are only released after `processRemovals` unlinks them
+    const auto mix = reinterpret_cast<Float *>(output);
+    const auto channels = getChannels();
+    const auto sampleCount = static_cast<Int64>(length / sizeof(Float));
+    const auto frames = sampleCount / channels;
+    const Float *pending[4];
+    Int pendingCount = 0;
+    for (const auto &source : m_sources)
     {
-        // Read data from sources (unrolled).
-        // note: these should be guaranteed valid because invalidation won't take place until deferred commands
-        const auto &sourceA = m_sources[sourcei].get();
-        const auto &sourceB = m_sources[sourcei + 1].get();
-        const auto &sourceC = m_sources[sourcei + 2].get();
-        const auto &sourceD = m_sources[sourcei + 3].get();
-
-        const Float *dataA, *dataB, *dataC, *dataD;
-        sourceA->read(reinterpret_cast<const uint8_t **>(&dataA), length);
-        sourceB->read(reinterpret_cast<const uint8_t **>(&dataB), length);
-        sourceC->read(reinterpret_cast<const uint8_t **>(&dataC), length);
-        sourceD->read(reinterpret_cast<const uint8_t **>(&dataD), length);
-
-        // Sum each source together with output
-        const auto sampleLength =static_cast<int>(length / sizeof(float));
-        auto head = reinterpret_cast<float *>(output);
-        Int i = 0;
-#if KAZE_CPU_SSE
-        for (; i <= sampleLength - 16; i += 16)
-        {
-            const auto a0 = _mm_load_ps(dataA + i);
-            const auto a1 = _mm_load_ps(dataA + i + 4);
-            const auto a2 = _mm_load_ps(dataA + i + 8);
-            const auto a3 = _mm_load_ps(dataA + i + 12);
-            const auto b0 = _mm_load_ps(dataB + i);
-            const auto b1 = _mm_load_ps(dataB + i + 4);
-            const auto b2 = _mm_load_ps(dataB + i + 8);
-            const auto b3 = _mm_load_ps(dataB + i + 12);
-            const auto c0 = _mm_load_ps(dataC + i);
-            const auto c1 = _mm_load_ps(dataC + i + 4);
-            const auto c2 = _mm_load_ps(dataC + i + 8);
-            const auto c3 = _mm_load_ps(dataC + i + 12);
-            const auto d0 = _mm_load_ps(dataD + i);
-            const auto d1 = _mm_load_ps(dataD + i + 4);
-            const auto d2 = _mm_load_ps(dataD + i + 8);
-            const auto d3 = _mm_load_ps(dataD + i + 12);
-
-            const auto sample0 = _mm_add_ps(_mm_add_ps(a0, b0), _mm_add_ps(c0, d0));
-            const auto sample1 = _mm_add_ps(_mm_add_ps(a1, b1), _mm_add_ps(c1, d1));
-            const auto sample2 = _mm_add_ps(_mm_add_ps(a2, b2), _mm_add_ps(c2, d2));
-            const auto sample3 = _mm_add_ps(_mm_add_ps(a3, b3), _mm_add_ps(c3, d3));
-
-            const auto head0 = _mm_load_ps(head + i);
-            const auto head1 = _mm_load_ps(head + i + 4);
-            const auto head2 = _mm_load_ps(head + i + 8);
-            const auto head3 = _mm_load_ps(head + i + 12);
-
-            _mm_store_ps(head + i, _mm_add_ps(head0, sample0));
-            _mm_store_ps(head + i + 4, _mm_add_ps(head1, sample1));
-            _mm_store_ps(head + i + 8, _mm_add_ps(head2, sample2));
-            _mm_store_ps(head + i + 12, _mm_add_ps(head3, sample3));
-        }
-#elif KAZE_CPU_WASM_SIMD
-        for (; i <= sampleLength - 16; i += 16)
+        if (source->shouldDiscard())
+            continue; // released, but still waiting for room to be handed off
+
+        const auto sourceChannels = source->getChannels();
+        const Float *data;
+        if (source.get()->read(reinterpret_cast<const Ubyte **>(&data),
+            frames * sourceChannels * static_cast<Int64>(sizeof(Float))) <= 0)
+            continue;
+
+        if (source->m_spatialSlot > -1 && channels > 1 && sourceChannels <= 2)
         {
-            const auto a0 = wasm_v128_load(dataA + i);
-            const auto a1 = wasm_v128_load(dataA + i + 4);
-            const auto a2 = wasm_v128_load(dataA + i + 8);
-            const auto a3 = wasm_v128_load(dataA + i + 12);
-            const auto b0 = wasm_v128_load(dataB + i);
-            const auto b1 = wasm_v128_load(dataB + i + 4);
-            const auto b2 = wasm_v128_load(dataB + i + 8);
-            const auto b3 = wasm_v128_load(dataB + i + 12);
-            const auto c0 = wasm_v128_load(dataC + i);
-            const auto c1 = wasm_v128_load(dataC + i + 4);
-            const auto c2 = wasm_v128_load(dataC + i + 8);
-            const auto c3 = wasm_v128_load(dataC + i + 12);
-            const auto d0 = wasm_v128_load(dataD + i);
-            const auto d1 = wasm_v128_load(dataD + i + 4);
-            const auto d2 = wasm_v128_load(dataD + i + 8);
-            const auto d3 = wasm_v128_load(dataD + i + 12);
-
-            const auto sample0 = wasm_f32x4_add(wasm_f32x4_add(a0, b0), wasm_f32x4_add(c0, d0));
-            const auto sample1 = wasm_f32x4_add(wasm_f32x4_add(a1, b1), wasm_f32x4_add(c1, d1));
-            const auto sample2 = wasm_f32x4_add(wasm_f32x4_add(a2, b2), wasm_f32x4_add(c2, d2));
-            const auto sample3 = wasm_f32x4_add(wasm_f32x4_add(a3, b3), wasm_f32x4_add(c3, d3));
-
-            const auto head0 = wasm_v128_load(head + i);
-            const auto head1 = wasm_v128_load(head + i + 4);
-            const auto head2 = wasm_v128_load(head + i + 8);
-            const auto head3 = wasm_v128_load(head + i + 12);
-
-            wasm_v128_store(head + i, wasm_f32x4_add(head0, sample0));
-            wasm_v128_store(head + i + 4, wasm_f32x4_add(head1, sample1));
-            wasm_v128_store(head + i + 8, wasm_f32x4_add(head2, sample2));
-            wasm_v128_store(head + i + 12, wasm_f32x4_add(head3, sample3));
+            mixSpatialized(mix, data, *source.get(), frames);
+            continue;
         }
-#elif KAZE_CPU_ARM_NEON
-        for (; i <= static_cast<Int>(sampleLength) - 16; i += 16)
+
+        if (sourceChannels != channels)
         {
-            const auto a0 = vld1q_f32(dataA + i);
-            const auto a1 = vld1q_f32(dataA + i + 4);
-            const auto a2 = vld1q_f32(dataA + i + 8);
-            const auto a3 = vld1q_f32(dataA + i +  12);
-            const auto b0 = vld1q_f32(dataB + i);
-            const auto b1 = vld1q_f32(dataB + i + 4);
-            const auto b2 = vld1q_f32(dataB + i + 8);
-            const auto b3 = vld1q_f32(dataB + i + 12);
-            const auto c0 = vld1q_f32(dataC + i);
-            const auto c1 = vld1q_f32(dataC + i + 4);
-            const auto c2 = vld1q_f32(dataC + i + 8);
-            const auto c3 = vld1q_f32(dataC + i + 12);
-            const auto d0 = vld1q_f32(dataD + i);
-            const auto d1 = vld1q_f32(dataD + i + 4);
-            const auto d2 = vld1q_f32(dataD + i + 8);
-            const auto d3 = vld1q_f32(dataD + i + 12);
-
-            const auto sample0 = vaddq_f32(vaddq_f32(a0, b0), vaddq_f32(c0, d0));
-            const auto sample1 = vaddq_f32(vaddq_f32(a1, b1), vaddq_f32(c1, d1));
-            const auto sample2 = vaddq_f32(vaddq_f32(a2, b2), vaddq_f32(c2, d2));
-            const auto sample3 = vaddq_f32(vaddq_f32(a3, b3), vaddq_f32(c3, d3));
-
-            const auto head0 = vld1q_f32(head + i);
-            const auto head1 = vld1q_f32(head + i + 4);
-            const auto head2 = vld1q_f32(head + i + 8);
-            const auto head3 = vld1q_f32(head + i + 12);
-
-            vst1q_f32(head + i, vaddq_f32(head0, sample0));
-            vst1q_f32(head + i + 4, vaddq_f32(head1, sample1));
-            vst1q_f32(head + i + 8, vaddq_f32(head2, sample2));
-            vst1q_f32(head + i + 12, vaddq_f32(head3, sample3));
+            mixConverted(mix, data, *source.get(), frames);
+            continue;
         }
-#endif
-        // Catch the leftover samples (should be divisible by 2 because of stereo)
-        for (; i <= sampleLength - 2; i += 2)
+
+        pending[pendingCount++] = data;
+        if (pendingCount == 4)
         {
-            const auto sample0 = dataA[i] + dataB[i] + dataC[i] + dataD[i];
-            const auto sample1 = dataA[i + 1] + dataB[i + 1] + dataC[i + 1] + dataD[i + 1];
-            head[i] += sample0;
-            head[i + 1] += sample1;
+            kernels.mix4(mix, pending[0], pending[1], pending[2], pending[3], sampleCount);
+            pendingCount = 0;
         }
     }
+
     // Catch the leftover sources
-    for (const int sourcecount = (int)m_sources.size(); sourcei < sourcecount; ++sourcei)
-    {
-        auto source = m_sources[sourcei].get();
+    for (Int i = 0; i < pendingCount; ++i)
+        kernels.mix(mix, pending[i], sampleCount);
+
+    return length;
+}
 
-        const float *data0;
-        auto floatsToRead0 = source->read(reinterpret_cast<const Ubyte**>(&data0), length) / sizeof(float);
+auto AudioBus::mixConverted(Float *mix, const Float *data, const AudioSource &source, const Int64 frames) const
+    -> void
+{
+    const auto channels = getChannels();
+    const auto sourceChannels = source.getChannels();
+
+    Float matrix[dsp::MaxChannels * dsp::MaxChannels];
+    if ( !dsp::makeChannelMatrix(sourceChannels, channels, matrix) )
+        return;
 
-        auto head = reinterpret_cast<float *>(output);
-        for (int i = 0; i < floatsToRead0; i += 4)
+    if (sourceChannels == 1 && channels > 1)
+    {
+        // The source's panner leaves mono alone, so apply its balance to the front pair while upmixing. This is
+        // the pan kernel's result for a mono signal duplicated to both sides.
+        const auto left = source.m_panner->leftRamp(), right = source.m_panner->rightRamp();
+        if ( !left.isSteady() || !right.isSteady() )
         {
-            head[i] += data0[i];
-            head[i + 1] += data0[i + 1];
-            head[i + 2] += data0[i + 2];
-            head[i + 3] += data0[i + 3];
+            // Ramp the front pair along the panner's ramps, sample by sample, and upmix the rest as usual
+            const auto total = static_cast<Float>(frames);
+            const auto fromLeft = matrix[0] * ((1.f - right.start) + left.start);
+            const auto fromRight = matrix[1] * ((1.f - left.start) + right.start);
+            const auto toLeft = matrix[0] * ((1.f - right.end) + left.end);
+            const auto toRight = matrix[1] * ((1.f - left.end) + right.end);
+
+            matrix[0] = matrix[1] = 0;
+            if (channels > 2)
+                dsp::getKernels().mixMatrix(mix, channels, data, sourceChannels, matrix, frames);
+            dsp::getKernels().mixPanned(mix, channels, data, sourceChannels, frames, 0, fromLeft, fromRight,
+                (toLeft - fromLeft) / total, (toRight - fromRight) / total);
+            return;
         }
+
+        matrix[0] *= (1.f - right.end) + left.end;
+        matrix[1] *= (1.f - left.end) + right.end;
     }
-    return length;
+
+    dsp::getKernels().mixMatrix(mix, channels, data, sourceChannels, matrix, frames);
+}
+
+auto AudioBus::mixSpatialized(Float *mix, const Float *data, const AudioSource &source, const Int64 frames) const
+    -> void
+{
+    auto gains = context()->getSpatializer().getGains(source.m_spatialSlot);
+    if (source.getChannels() == 1)
+    {
+        // As in `mixConverted`, the panner's balance applies to mono while it is mixed, ramped along with the
+        // emitter's gains
+        const auto left = source.m_panner->leftRamp(), right = source.m_panner->rightRamp();
+        gains.fromLeft *= (1.f - right.start) + left.start;
+        gains.toLeft *= (1.f - right.end) + left.end;
+        gains.fromRight *= (1.f - left.start) + right.start;
+        gains.toRight *= (1.f - left.end) + right.end;
+    }
+    else
+    {
+        // Constant-power gains are -3 dB at the center, where stereo should pass through at unity
+        constexpr auto Unity = 1.41421356f;
+        gains.fromLeft *= Unity;
+        gains.toLeft *= Unity;
+        gains.fromRight *= Unity;
+        gains.toRight *= Unity;
+    }
+
+    const auto total = static_cast<Float>(frames);
+    dsp::getKernels().mixPanned(mix, getChannels(), data, source.getChannels(), frames, 0, gains.fromLeft,
+        gains.fromRight, (gains.toLeft - gains.fromLeft) / total, (gains.toRight - gains.fromRight) / total);
 }
 
 auto AudioBus::updateParentClock(Uint64 parentClock) -> Bool
@@ -308,6 +284,77 @@ auto AudioBus::updateParentClock(Uint64 parentClock) -> Bool
     return result;
 }
 
+auto AudioBus::collectBuses(List< List<AudioBus *> > *levels, const Size depth) -> Bool
+{
+    for (const auto &handle : m_sources)
+    {
+        if ( !handle.isValid() )
+            continue;
+
+        if (const auto bus = handle.getAs<AudioBus>())
+        {
+            // The lists are reserved by the context; growing them here would allocate on the audio thread
+            if (depth >= levels->size() || (*levels)[depth].size() == (*levels)[depth].capacity())
+                return False;
+
+            (*levels)[depth].emplace_back(bus);
+            if ( !bus->collectBuses(levels, depth + 1) )
+                return False;
+        }
+    }
+
+    return True;
+}
+
+auto AudioBus::reserveConnections(const Size count) -> Size
+{
+    freeGrownSources(False);
+
+    const auto needed = getConnectionBound() + count;
+    if (needed > m_sourceCapacity)
+    {
+        auto capacity = m_sourceCapacity * 2;
+        while (capacity < needed)
+            capacity *= 2;
+
+        const auto sources = new List< Handle<AudioSource> >();
+        sources->reserve(capacity);
+        m_grownSources.emplace_back(GrownSources {
+            .ticket = ++m_growTicket,
+            .sources = sources,
+        });
+        m_sourceCapacity = capacity;
+
+        context()->pushCommand(commands::BusGrowSources {
+            .bus = this,
+            .sources = sources,
+            .ticket = m_growTicket,
+        });
+    }
+
+    m_connectTicket += count;
+    return m_connectTicket;
+}
+
+auto AudioBus::freeGrownSources(const Bool all) -> void
+{
+    const auto growsApplied = m_growsApplied.load(std::memory_order_acquire);
+    std::erase_if(m_grownSources, [all, growsApplied](const GrownSources &grown) {
+        if ( !all && grown.ticket > growsApplied )
+            return False;
+
+        delete grown.sources;
+        return True;
+    });
+}
+
+auto AudioBus::getConnectionBound() const -> Size
+{
+    // Read the ticket first: a connect it counts as run is already in the size, one it misses is counted twice
+    const auto applied = m_connectsApplied.load(std::memory_order_acquire);
+    return m_sourceCount.load(std::memory_order_acquire) + (m_connectTicket - applied);
+}
+
 auto AudioBus::processRemovals() -> void
 {
     const auto ctx = context();
@@ -327,17 +374,72 @@ auto AudioBus::processRemovals() -> void
 
         if (source->shouldDiscard())
         {
-            ctx->releaseObjectImpl(handle);
-            return True;
+            if (ctx->releaseSourceDeferred(handle))
+                return True;
+
+            // No room to hand it off; keep it linked, silent, and retry on the next callback
+            ctx->flagRemoveSource();
         }
 
         return False;
     });
+    publishSourceCount();
 }
 
 // Private Impl functions don't need to check for validity since it's the caller's responsibility to check
 
-auto AudioBus::connectSourceImpl(const Handle<AudioBus> &bus, const Handle<AudioSource> &source) -> void
+auto AudioBus::releaseImpl(const Bool recursive, const Size masterTicket) -> void
+{
+    if (recursive)
+    {
+        // Recursively release all sources
+        for (auto &handle : m_sources)
+        {
+            if ( !handle.isValid() )
+                continue;
+
+            const auto source = handle.get();
+            if (const auto bus = dynamic_cast<AudioBus *>(source))
+            {
+                bus->releaseImpl(True, 0);
+            }
+            else
+            {
+                source->release();
+            }
+        }
+    }
+    else
+    {
+        const auto masterBus = context()->getMasterBus();
+        if ( !masterBus.isValid() )
+        {
+            // Most likely, the context was closed or uninit state
+            KAZE_PUSH_ERR(Error::RuntimeErr, "Failed to get master bus from AudioContext");
+            return;
+        }
+
+        // Reconnect all children to the master bus. Pop each one first, since connecting a sub-bus
+        // disconnects it from this bus.
+        while ( !m_sources.empty() )
+        {
+            const auto handle = m_sources.back();
+            m_sources.pop_back();
+
+            if (handle.isValid())
+                connectSourceImpl(masterBus, handle, 0);
+        }
+
+        publishSourceCount();
+        if (masterTicket != 0)
+            masterBus->m_connectsApplied.store(masterTicket, std::memory_order_release);
+    }
+
+    context()->flagGraphChanged();
+    AudioSource::release();
+}
+
+auto AudioBus::connectSourceImpl(const Handle<AudioBus> &bus, const Handle<AudioSource> &source, const Size ticket) -> void
 {
     // If source is a bus, remove itself from its parent first
     if (const auto sourceBus = source.getAs<AudioBus>())
@@ -348,9 +450,14 @@ auto AudioBus::connectSourceImpl(const Handle<AudioBus> &bus, const Handle<Audio
         }
 
         sourceBus->m_parent = bus;
+        bus->context()->flagGraphChanged();
     }
 
+    // Never reallocates: the owning thread grew the list before pushing the command, see `reserveConnections`
     bus->m_sources.emplace_back(source);
+    bus->publishSourceCount();
+    if (ticket != 0)
+        bus->m_connectsApplied.store(ticket, std::memory_order_release);
 }
 
 auto AudioBus::disconnectSourceImpl(const Handle<AudioBus> &bus, const Handle<AudioSource> &source) -> void
@@ -361,9 +468,22 @@ auto AudioBus::disconnectSourceImpl(const Handle<AudioBus> &bus, const Handle<Au
         if (*it == source)
         {
             sources.erase(it);
+            bus->publishSourceCount();
+            bus->context()->flagGraphChanged();
             break;
         }
     }
 }
 
+auto AudioBus::growSourcesImpl(List< Handle<AudioSource> > *sources, const Size ticket) -> void
+{
+    // Sized for every connection pushed so far, so moving the sources over does not allocate
+    for (auto &handle : m_sources)
+        sources->emplace_back(std::move(handle));
+    std::swap(m_sources, *sources);
+    sources->clear(); // keeps the old storage for the owning thread to free
+
+    m_growsApplied.store(ticket, std::memory_order_release);
+}
+
 KSND_NS_END
@@ -8,10 +8,11 @@ class AudioBus final : public AudioSource {
 public:
     AudioBus() = default;
     AudioBus(AudioBus &&other) noexcept;
-    ~AudioBus() override = default;
+    ~AudioBus() override;
 
     // pool lifetime functions
-    auto init_(AudioContext *context, const Handle<AudioBus> &parent, Bool paused) -> Bool;
+    /// \param[in]  channels  channels to mix in, `0` for the parent's, or the output's for the master bus
+    auto init_(AudioContext *context, const Handle<AudioBus> &parent, Bool paused, Int channels = 0) -> Bool;
     auto release(Bool recursive = True) -> void;
     auto release_() -> void override;
 
@@ -28,21 +29,89 @@ public:
 private:
     auto readImpl(Ubyte *output, Int64 length) -> Int64 override;
 
+    /// Mix the rendered frames of a source with a different channel count into this bus's layout
+    /// \param[in]  mix     this bus's interleaved output
+    /// \param[in]  data    frames rendered by `source`
+    /// \param[in]  source  child source, for its channel count and panner
+    /// \param[in]  frames  number of frames
+    auto mixConverted(Float *mix, const Float *data, const AudioSource &source, Int64 frames) const -> void;
+
+    /// Mix the rendered frames of a mono or stereo source into the front pair of this bus, ramping between the
+    /// gains its emitter had at the end of the previous callback and has at the end of this one
+    /// \param[in]  mix     this bus's interleaved output, of two or more channels
+    /// \param[in]  data    frames rendered by `source`
+    /// \param[in]  source  child source with an emitter slot
+    /// \param[in]  frames  number of frames
+    auto mixSpatialized(Float *mix, const Float *data, const AudioSource &source, Int64 frames) const -> void;
+
     friend class AudioContext;
     auto updateParentClock(Uint64 parentClock) -> Bool override;
-    auto processRemovals() -> void; // only AudioContext, during AudioContext::update should call this
+    auto processRemovals() -> void; // only AudioContext, on the audio thread or while closing, should call this
+
+    /// Append every bus below this one to `levels`, grouped by depth, for the parallel mixer. Audio thread only.
+    /// \param[out] levels  lists of buses per depth, where depth `0` holds this bus's direct children; never grown
+    /// \param[in]  depth   depth of this bus's children
+    /// \returns whether every bus fit into the lists as they were sized and reserved.
+    auto collectBuses(List< List<AudioBus *> > *levels, Size depth) -> Bool;
+
+    /// Make room for more sources before their connect commands are pushed, so that the audio thread never grows
+    /// `m_sources`. A larger list is reserved here and handed over to be swapped in. Owning thread only.
+    /// \param[in]  count  number of sources about to be connected
+    /// \returns ticket for the audio thread to publish once they are connected
+    auto reserveConnections(Size count) -> Size;
+
+    /// Delete the lists the audio thread swapped out. Owning thread only.
+    /// \param[in]  all  whether to delete every list, once the bus has left the graph
+    auto freeGrownSources(Bool all) -> void;
+
+    /// \returns upper bound of the sources connected once the pushed commands have run. Owning thread only.
+    [[nodiscard]]
+    auto getConnectionBound() const -> Size;
+
+    /// Publish the number of connected sources for `getConnectionBound`. Audio thread only.
+    auto publishSourceCount() -> void { m_sourceCount.store(m_sources.size(), std::memory_order_release); }
 
     // ----- Commands ---------------------------------------------------------
+    friend commands::BusRelease;
+    /// \param[in]  masterTicket  connect ticket reserved on the master bus for the reconnected sources, if not recursive
+    auto releaseImpl(Bool recursive, Size masterTicket) -> void;
+
     friend commands::BusConnectSource;
-    static auto connectSourceImpl(const Handle<AudioBus> &bus, const Handle<AudioSource> &source) -> void;
+    /// \param[in]  ticket  from `reserveConnections`, or `0` if the caller publishes it after connecting a batch
+    static auto connectSourceImpl(const Handle<AudioBus> &bus, const Handle<AudioSource> &source, Size ticket) -> void;
 
     friend commands::BusDisconnectSource;
     static auto disconnectSourceImpl(const Handle<AudioBus> &bus, const Handle<AudioSource> &source) -> void;
 
+    friend commands::BusGrowSources;
+    auto growSourcesImpl(List< Handle<AudioSource> > *sources, Size ticket) -> void;
+
+    /// Number of source slots to reserve on init
+    static constexpr Size DefaultSourceCapacity = 64;
+
     // ----- Data members -----------------------------------------------------
     /// Sub-mix graph
     List< Handle<AudioSource> > m_sources{};
 
+    /// A larger list reserved on the owning thread for `growSourcesImpl` to swap in
+    struct GrownSources {
+        Size ticket;                          ///< of the growth
+        List< Handle<AudioSource> > *sources; ///< holds the old storage once swapped in
+    };
+
+    /// Lists handed to the audio thread, deleted by the owning thread once swapped in
+    List<GrownSources> m_grownSources{};
+
+    // Owning thread's view of `m_sources`, see `reserveConnections`
+    Size m_sourceCapacity{};  ///< capacity once every pushed growth is taken up
+    Size m_connectTicket{};   ///< last ticket handed out for connections
+    Size m_growTicket{};      ///< last growth pushed
+
+    // Published by the audio thread
+    std::atomic<Size> m_sourceCount{};    ///< size of `m_sources`
+    std::atomic<Size> m_connectsApplied{}; ///< last connect ticket run
+    std::atomic<Size> m_growsApplied{};    ///< last growth taken up
+
     /// Temp buffer to calculate mix
     AlignedList<Float, 16> m_buffer{};
 
@@ -51,6 +120,9 @@ private:
 
     /// Whether this is the master bus or not
     Bool m_isMaster{};
+
+    /// Whether the parallel mixer renders this bus ahead of its parent in the current callback
+    Bool m_renderAhead{};
 };
 
 KSND_NS_END
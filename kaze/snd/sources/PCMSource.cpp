@@ -0,0 +1,194 @@
+#include "PCMSource.h"
+
+#include <kaze/snd/dsp/ChannelMatrix.h>
+
+#include <kaze/core/math/mathf.h>
+#include <kaze/core/memory.h>
+
+KSND_NS_BEGIN
+/// Macro to ensure that the PCMSource is open in a PCMSource function
+#ifdef KAZE_DEBUG
+#define INIT_GUARD_RET(ret) do { if (!isOpen()) { \
+    KAZE_PUSH_ERR(Error::NotInitialized, "Attempted to access PCMSource in uninit state."); \
+    return (ret); \
+} } while(0)
+#else
+#define INIT_GUARD_RET(ret) KAZE_NOOP
+#endif
+
+PCMSource::PCMSource(PCMSource &&other) noexcept :
+    AudioSource(std::move(other)),
+    m_buffer(std::move(other.m_buffer)),
+    m_bytesPerFrame(other.m_bytesPerFrame),
+    m_frameCount(other.m_frameCount),
+    m_frame(other.m_frame.load(std::memory_order_relaxed)),
+    m_looping(other.m_looping.load(std::memory_order_relaxed)),
+    m_isOneShot(other.m_isOneShot)
+{
+    other.m_bytesPerFrame = 0;
+    other.m_frameCount = 0;
+}
+
+auto PCMSource::init_(const PCMSourceInit &config) -> Bool
+{
+    if ( !config.buffer || !config.buffer->isLoaded() )
+    {
+        KAZE_PUSH_ERR(Error::InvalidArgErr, "PCMSource requires a loaded SoundBuffer");
+        return False;
+    }
+
+    // The channel count may differ, the parent bus mixes it into its own layout
+    const auto &spec = config.buffer->spec();
+    const auto &contextSpec = config.context->getSpec();
+    if (spec.freq != contextSpec.freq || spec.format != contextSpec.format ||
+        spec.channels < 1 || spec.channels > dsp::MaxChannels)
+    {
+        KAZE_PUSH_ERR(Error::InvalidArgErr, "PCMSource SoundBuffer spec does not match the AudioContext spec");
+        return False;
+    }
+
+    if (!AudioSource::init_(config.context, config.parentClock, config.paused))
+    {
+        return False;
+    }
+
+    setChannels(spec.channels);
+
+    m_buffer = config.buffer;
+    m_bytesPerFrame = static_cast<Int64>(m_buffer->spec().bytesPerFrame());
+    m_frameCount = static_cast<Int64>(m_buffer->frameCount());
+    m_frame.store(0, std::memory_order_relaxed);
+    m_looping.store(config.isLooping, std::memory_order_relaxed);
+    m_isOneShot = config.isOneShot;
+    return True;
+}
+
+auto PCMSource::release_() -> void
+{
+    m_buffer.reset(); // drop reference, last owner frees the buffer
+    AudioSource::release_();
+}
+
+auto PCMSource::readImpl(Ubyte *output, const Int64 length) -> Int64
+{
+    if ( !isOpen() )
+    {
+        memory::set(output, 0, length);
+        return length;
+    }
+
+    const auto data = m_buffer->data();
+    const auto looping = m_looping.load(std::memory_order_relaxed);
+    const auto framesToRead = length / m_bytesPerFrame;
+
+    const auto startFrame = m_frame.load(std::memory_order_relaxed);
+    auto frame = startFrame;
+    Int64 framesRead = 0;
+    while (framesRead < framesToRead)
+    {
+        if (frame >= m_frameCount)
+        {
+            if ( !looping || m_frameCount == 0 )
+                break;
+            frame = 0;
+        }
+
+        const auto count = mathf::min(framesToRead - framesRead, m_frameCount - frame);
+        memory::copy(output + framesRead * m_bytesPerFrame, data + frame * m_bytesPerFrame,
+            count * m_bytesPerFrame);
+        framesRead += count;
+        frame += count;
+    }
+
+    // Only publish the new position if no seek occurred in the meantime
+    auto expected = startFrame;
+    m_frame.compare_exchange_strong(expected, frame, std::memory_order_relaxed);
+
+    // Ensure any remaining frame is filled with silence
+    if (framesRead * m_bytesPerFrame < length)
+    {
+        const auto bytesRead = framesRead * m_bytesPerFrame;
+        memory::set(output + bytesRead, 0, length - bytesRead);
+    }
+
+    if (m_isOneShot && !looping && frame >= m_frameCount)
+    {
+        release();
+    }
+
+    return length;
+}
+
+auto PCMSource::skipImpl(const Int64 length) -> Int64
+{
+    if ( !isOpen() )
+        return length;
+
+    const auto looping = m_looping.load(std::memory_order_relaxed);
+    const auto startFrame = m_frame.load(std::memory_order_relaxed);
+    auto frame = startFrame + length / m_bytesPerFrame;
+    if (frame >= m_frameCount)
+        frame = looping && m_frameCount > 0 ? frame % m_frameCount : m_frameCount;
+
+    // Only publish the new position if no seek occurred in the meantime
+    auto expected = startFrame;
+    m_frame.compare_exchange_strong(expected, frame, std::memory_order_relaxed);
+
+    if (m_isOneShot && !looping && frame >= m_frameCount)
+    {
+        release();
+    }
+
+    return length;
+}
+
+auto PCMSource::getLooping() const -> Bool
+{
+    INIT_GUARD_RET(False);
+    return m_looping.load(std::memory_order_relaxed);
+}
+
+auto PCMSource::setLooping(const Bool looping) -> Bool
+{
+    INIT_GUARD_RET(False);
+    m_looping.store(looping, std::memory_order_relaxed);
+    return True;
+}
+
+auto PCMSource::getPosition(const AudioTime::Unit units) const -> Double
+{
+    INIT_GUARD_RET(-1.0);
+    return AudioTime::convert(
+        static_cast<Double>(m_frame.load(std::memory_order_relaxed)),
+        AudioTime::PCMFrames,
+        units,
+        m_buffer->spec());
+}
+
+auto PCMSource::setPosition(
+    const AudioTime::Unit units,
+    const Uint64 position,
+    const SeekBase base) -> Bool
+{
+    INIT_GUARD_RET(False);
+
+    auto frame = static_cast<Int64>(mathf::round(
+        AudioTime::convert(static_cast<Double>(position), units, AudioTime::PCMFrames, m_buffer->spec())));
+
+    // Apply seek base
+    if (base == SeekBase::Current)
+        frame += m_frame.load(std::memory_order_relaxed);
+    else if (base == SeekBase::End)
+        frame += m_frameCount;
+
+    if (frame < 0 || frame > m_frameCount)
+    {
+        KAZE_PUSH_ERR(Error::OutOfRange, "PCMSource::setPosition: position is out of range");
+        return False;
+    }
+
+    m_frame.store(frame, std::memory_order_relaxed);
+    return True;
+}
+
+KSND_NS_END
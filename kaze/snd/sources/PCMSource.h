@@ -0,0 +1,72 @@
+#pragma once
+#include <kaze/snd/lib.h>
+#include <kaze/snd/AudioSource.h>
+#include <kaze/snd/AudioTime.h>
+#include <kaze/snd/SoundBuffer.h>
+
+#include <kaze/core/io/stream/SeekBase.h>
+
+#include <memory>
+
+KSND_NS_BEGIN
+
+/// SoundBuffer that may be shared by any number of PCMSources. The buffer is freed when the last owner releases it.
+using SharedSoundBuffer = std::shared_ptr<const SoundBuffer>;
+
+/// PCMSource Initialization struct used in PCMSource::init_
+struct PCMSourceInit {
+    /// Audio context object
+    AudioContext *context;
+
+    /// Decoded sound data to play, must match the context's spec
+    SharedSoundBuffer buffer;
+
+    /// Initial parent clock value
+    Uint64 parentClock;
+
+    /// Whether source should start paused
+    Bool paused;
+
+    /// Whether source should loop
+    Bool isLooping;
+
+    /// Whether source is a oneshot (auto-release on end)
+    Bool isOneShot;
+};
+
+/// Plays a SoundBuffer that was decoded ahead of time. Reading is a copy out of the shared buffer,
+/// so there is no decoding, conversion or resampling work per voice.
+class PCMSource final : public AudioSource {
+public:
+    PCMSource() = default;
+    ~PCMSource() override = default;
+    PCMSource(PCMSource &&other) noexcept;
+
+    // Pool init/release
+    auto init_(const PCMSourceInit &config) -> Bool;
+    auto release_() -> void override;
+
+    [[nodiscard]]
+    auto isOpen() const -> Bool { return static_cast<Bool>(m_buffer); }
+
+    auto setLooping(Bool looping) -> Bool;
+    [[nodiscard]]
+    auto getLooping() const -> Bool;
+
+    [[nodiscard]]
+    auto getPosition(AudioTime::Unit units) const -> Double;
+    auto setPosition(AudioTime::Unit units, Uint64 position, SeekBase base) -> Bool;
+
+private:
+    auto readImpl(Ubyte *output, Int64 length) -> Int64 override;
+    auto skipImpl(Int64 length) -> Int64 override;
+
+    SharedSoundBuffer m_buffer{};
+    Int64 m_bytesPerFrame{};
+    Int64 m_frameCount{};
+    std::atomic<Int64> m_frame{};     ///< current read position in frames, written by either thread on seek
+    std::atomic<Bool> m_looping{};
+    Bool m_isOneShot{};
+};
+
+KSND_NS_END
@@ -1,6 +1,7 @@
 #include "StreamSource.h"
 
 #include <kaze/snd/conv/AudioDecoder.h>
+#include <kaze/core/math/mathf.h>
 #include <kaze/core/memory.h>
 
 KSND_NS_BEGIN
@@ -23,8 +24,13 @@ struct StreamSource::Impl {
     Impl() = default;
 
     AudioDecoder decoder{};
-    Bool looping{}, isOneShot{};
+    PrefetchStream *stream{}; ///< owned by the context's StreamThread, if prefetching
+    BlockCache *blockCache{};
+    Uint64 blockCacheKey{};
+    Bool looping{}, isOneShot{}, prefetch{};
     Int bytesPerFrame{};
+    Int64 frameLength{};   ///< length of the stream in pcm frames, `-1` if unknown
+    Int64 skippedFrames{}; ///< frames passed while virtual, caught up on the next read
 };
 
 StreamSource::StreamSource() : m(new Impl)
@@ -46,7 +52,7 @@ StreamSource::~StreamSource()
 
 auto StreamSource::isOpen() const -> Bool
 {
-    return m != Null && m->decoder.isOpen();
+    return m != Null && (m->stream != Null || m->decoder.isOpen());
 }
 
 auto StreamSource::openConstMem(const MemView<void> mem) -> Bool
@@ -60,8 +66,8 @@ auto StreamSource::openConstMem(const MemView<void> mem) -> Bool
     }
 
     decoder.setLooping(m->looping);
-    m->decoder = std::move(decoder);
-    m->bytesPerFrame = static_cast<int>(targetSpec.bytesPerFrame());
+    m->bytesPerFrame = static_cast<Int>(decoder.getSpec().bytesPerFrame());
+    setDecoder(std::move(decoder));
     return True;
 }
 
@@ -76,8 +82,8 @@ auto StreamSource::openMem(const ManagedMem mem) -> Bool
     }
 
     decoder.setLooping(m->looping);
-    m->decoder = std::move(decoder);
-    m->bytesPerFrame = static_cast<Int>(targetSpec.bytesPerFrame());
+    m->bytesPerFrame = static_cast<Int>(decoder.getSpec().bytesPerFrame());
+    setDecoder(std::move(decoder));
     return True;
 }
 
@@ -93,17 +99,52 @@ auto StreamSource::openFile(const String &filepath, const Bool inMemory) -> Bool
     }
 
     decoder.setLooping(m->looping);
-    m->bytesPerFrame = static_cast<int>(targetSpec.bytesPerFrame());
-    m->decoder = std::move(decoder);
+    m->bytesPerFrame = static_cast<Int>(decoder.getSpec().bytesPerFrame());
+    setDecoder(std::move(decoder));
     return True;
 }
 
+auto StreamSource::setDecoder(AudioDecoder &&decoder) -> void
+{
+    setChannels(decoder.getSpec().channels);
+    m->frameLength = decoder.getPCMFrameLength();
+    m->skippedFrames = 0;
+
+    if (m->stream)
+    {
+        context()->getStreamThread().release(m->stream);
+        m->stream = Null;
+    }
+
+    if (m->prefetch)
+    {
+        // Fill the ring before the first callback, then let the worker thread take over
+        const auto stream = new PrefetchStream(std::move(decoder), PrefetchStream::DefaultBlockCount,
+            PrefetchStream::DefaultBlockFrames, m->blockCache, m->blockCacheKey);
+        stream->fill();
+        m->stream = stream;
+        context()->getStreamThread().add(stream);
+    }
+    else
+    {
+        m->decoder = std::move(decoder);
+    }
+}
+
 auto StreamSource::release_() -> void
 {
     if (m)
     {
+        if (m->stream)
+        {
+            context()->getStreamThread().release(m->stream);
+            m->stream = Null;
+        }
+
         m->decoder.close();
     }
+
+    AudioSource::release_();
 }
 
 auto StreamSource::readImpl(Ubyte *output, const Int64 length) -> Int64
@@ -115,8 +156,25 @@ auto StreamSource::readImpl(Ubyte *output, const Int64 length) -> Int64
         return length;
     }
 
-    // Read the frames!
+    if (m->skippedFrames > 0)
+        applySkippedFrames();
+
     const auto framesToRead = length / m->bytesPerFrame;
+    if (m->stream)
+    {
+        // Prefetched: copy what the worker thread has decoded
+        const auto framesRead = m->stream->read(output, framesToRead);
+        const auto bytesRead = framesRead * m->bytesPerFrame;
+        if (bytesRead < length)
+            memory::set(output + bytesRead, 0, length - bytesRead);
+
+        if (m->isOneShot && m->stream->isEnded())
+            release();
+
+        return length;
+    }
+
+    // Read the frames!
     const auto framesRead = m->decoder.readFrames(output, framesToRead);
 
     // Error check
@@ -145,6 +203,48 @@ auto StreamSource::readImpl(Ubyte *output, const Int64 length) -> Int64
     return length;
 }
 
+auto StreamSource::skipImpl(const Int64 length) -> Int64
+{
+    if ( !isOpen() )
+        return length;
+
+    // Seeking is deferred until the source becomes real again, so a virtual source costs no decoding
+    m->skippedFrames += length / m->bytesPerFrame;
+
+    const auto looping = m->stream ? m->stream->isLooping() : m->decoder.isLooping();
+    if (m->isOneShot && !looping && m->frameLength > 0)
+    {
+        const auto position = m->stream ? m->stream->getPosition() :
+            static_cast<Int64>(m->decoder.tell(AudioTime::PCMFrames));
+        if (position + m->skippedFrames >= m->frameLength)
+            release();
+    }
+
+    return length;
+}
+
+auto StreamSource::applySkippedFrames() -> void
+{
+    const auto looping = m->stream ? m->stream->isLooping() : m->decoder.isLooping();
+    const auto position = m->stream ? m->stream->getPosition() :
+        static_cast<Int64>(m->decoder.tell(AudioTime::PCMFrames));
+
+    auto frame = position + m->skippedFrames;
+    m->skippedFrames = 0;
+    if (m->frameLength > 0 && frame >= m->frameLength)
+        frame = looping ? frame % m->frameLength : m->frameLength;
+
+    if (m->stream)
+    {
+        // The decoding thread picks up the seek on its next pass; waking it would take a lock
+        m->stream->seek(frame);
+    }
+    else
+    {
+        m->decoder.seek(frame, AudioTime::PCMFrames);
+    }
+}
+
 auto StreamSource::getLooping() const -> Bool
 {
     INIT_GUARD_RET(False);
@@ -156,13 +256,28 @@ auto StreamSource::setLooping(const Bool looping) -> Bool
 {
     INIT_GUARD_RET(False);
 
-    m->decoder.setLooping(looping);
+    if (m->stream)
+        m->stream->setLooping(looping);
+    else
+        m->decoder.setLooping(looping);
     return True;
 }
 
+auto StreamSource::getStreamSpec() const -> AudioSpec
+{
+    const auto &spec = context()->getSpec();
+    return {spec.freq, getChannels(), spec.format};
+}
+
 auto StreamSource::getPosition(const AudioTime::Unit units) const -> Double
 {
     INIT_GUARD_RET(-1.0);
+    if (m->stream)
+    {
+        return AudioTime::convert(static_cast<Double>(m->stream->getPosition()), AudioTime::PCMFrames, units,
+            getStreamSpec());
+    }
+
     return m->decoder.tell(units);
 }
 
@@ -172,9 +287,37 @@ auto StreamSource::setPosition(
     const SeekBase base) -> Bool
 {
     INIT_GUARD_RET(False);
+    if (m->stream)
+    {
+        auto frame = static_cast<Int64>(mathf::round(
+            AudioTime::convert(static_cast<Double>(position), units, AudioTime::PCMFrames, getStreamSpec())));
+
+        // Apply seek base
+        if (base == SeekBase::Current)
+            frame += m->stream->getPosition();
+        else if (base == SeekBase::End)
+            frame += m->stream->getFrameLength();
+
+        m->stream->seek(frame);
+        context()->getStreamThread().wake();
+        return True;
+    }
+
     return m->decoder.seek(position, units, base);
 }
 
+auto StreamSource::isPrefetching() const -> Bool
+{
+    return m != Null && m->stream != Null;
+}
+
+auto StreamSource::getPrefetchStats() const -> PrefetchStream::Stats
+{
+    if ( !isPrefetching() )
+        return {};
+    return m->stream->getStats();
+}
+
 auto StreamSource::init_(const StreamSourceInit &config) -> Bool
 {
     if (!AudioSource::init_(config.context, config.parentClock, config.paused))
@@ -184,6 +327,9 @@ auto StreamSource::init_(const StreamSourceInit &config) -> Bool
 
     m->isOneShot = config.isOneShot;
     m->looping = config.isLooping;
+    m->prefetch = config.prefetch;
+    m->blockCache = config.blockCache;
+    m->blockCacheKey = config.blockCacheKey;
 
     Bool result = False;
     if (config.pathOrMemory.index() == 0)
@@ -1,6 +1,7 @@
 #pragma once
 #include <kaze/snd/lib.h>
 #include <kaze/snd/AudioSource.h>
+#include <kaze/snd/conv/PrefetchStream.h>
 
 #include <kaze/core/ManagedMem.h>
 #include <kaze/core/io/stream/SeekBase.h>
@@ -31,6 +32,17 @@ struct StreamSourceInit {
     /// Whether to load file into memory and stream from RAM [optional, default: `False`]
     /// \note Only relevant if you pass a filename String to `pathOrMemory`.
     Bool inMemory = False;
+
+    /// Whether to decode on the context's StreamThread ahead of the play head, instead of on the audio thread
+    /// [optional, default: `False`]
+    Bool prefetch = False;
+
+    /// Cache to share decoded blocks through with other instances of the same sound, when prefetching
+    /// [optional, default: `Null`, no sharing]
+    BlockCache *blockCache = Null;
+
+    /// Key of the sound in `blockCache`, see `BlockCache::makeKey`
+    Uint64 blockCacheKey = 0;
 };
 
 class StreamSource final : public AudioSource {
@@ -61,8 +73,28 @@ public:
     auto getPosition(AudioTime::Unit units) const -> Double;
     auto setPosition(AudioTime::Unit units, Uint64 position, SeekBase base) -> Bool;
 
+    /// \returns whether this source decodes on the StreamThread
+    [[nodiscard]]
+    auto isPrefetching() const -> Bool;
+
+    /// \returns fill level and starvation counters of the prefetch ring; all zero if not prefetching
+    [[nodiscard]]
+    auto getPrefetchStats() const -> PrefetchStream::Stats;
+
 private:
     auto readImpl(Ubyte *output, Int64 length) -> Int64 override;
+    auto skipImpl(Int64 length) -> Int64 override;
+
+    /// Seek past the frames skipped while virtual. Audio thread only.
+    auto applySkippedFrames() -> void;
+
+    /// Hand the opened decoder over to a PrefetchStream if prefetching, or keep it for direct reads otherwise
+    auto setDecoder(AudioDecoder &&decoder) -> void;
+
+    /// \returns spec of the frames this source reads: the output's rate and format, in the stream's channels
+    [[nodiscard]]
+    auto getStreamSpec() const -> AudioSpec;
+
     struct Impl;
     Impl *m;
 };
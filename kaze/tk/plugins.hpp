@@ -1,3 +1,4 @@
 #pragma once
+#include "plugins/imgui/imgui_audio_profiler.h"
 #include "plugins/imgui/imgui_plugin.h"
 
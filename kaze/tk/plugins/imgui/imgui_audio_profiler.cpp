@@ -0,0 +1,115 @@
+#include "imgui_audio_profiler.h"
+
+#include <imgui/imgui.h>
+
+#include <cstdio>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+KAZE_NS_BEGIN
+
+namespace plugins::imgui {
+    auto AudioProfilerPanel::draw(snd::AudioEngine &engine, Bool *open) -> void
+    {
+        if ( !ImGui::Begin("Audio Profiler", open) )
+        {
+            ImGui::End();
+            return;
+        }
+
+        auto enabled = engine.isProfilerEnabled();
+        if (ImGui::Checkbox("Enabled", &enabled))
+            engine.setProfilerEnabled(enabled);
+
+        const auto stats = engine.getProfilerStats(m_topN);
+        if ( !enabled || stats.callbacks == 0 )
+        {
+            ImGui::TextDisabled(enabled ? "Waiting for callbacks..." : "Enable to time the audio thread");
+            ImGui::End();
+            return;
+        }
+
+        ImGui::Text("Callback  avg %.3f ms  max %.3f ms  deadline %.3f ms",
+            stats.averageMs, stats.maxMs, stats.deadlineMs);
+
+        char overlay[32];
+        std::snprintf(overlay, sizeof(overlay), "avg %.1f%%", stats.averageLoad);
+        ImGui::ProgressBar(static_cast<Float>(stats.averageLoad / 100.0), ImVec2(-1, 0), overlay);
+        std::snprintf(overlay, sizeof(overlay), "max %.1f%%", stats.maxLoad);
+        ImGui::ProgressBar(static_cast<Float>(stats.maxLoad / 100.0), ImVec2(-1, 0), overlay);
+
+        m_loadHistory[m_historyOffset] = static_cast<Float>(stats.maxLoad);
+        m_historyOffset = (m_historyOffset + 1) % HistorySize;
+        ImGui::PlotLines("##load", m_loadHistory, HistorySize, m_historyOffset, "max load %", 0, 100.f,
+            ImVec2(-1, 60.f));
+
+        ImGui::Text("Deadline misses %d  underruns %llu  dropped %llu (over %d callbacks)",
+            stats.deadlineMisses,
+            static_cast<unsigned long long>(stats.underruns),
+            static_cast<unsigned long long>(stats.droppedCallbacks),
+            stats.callbacks);
+
+        if (ImGui::CollapsingHeader("Sources", ImGuiTreeNodeFlags_DefaultOpen))
+            drawEntries("sources", stats.sources);
+        if (ImGui::CollapsingHeader("Effects", ImGuiTreeNodeFlags_DefaultOpen))
+            drawEntries("effects", stats.effects);
+
+        ImGui::End();
+    }
+
+    auto AudioProfilerPanel::drawEntries(const char *id, const List<snd::AudioProfileEntry> &entries) -> void
+    {
+        if ( !ImGui::BeginTable(id, 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV) )
+            return;
+
+        ImGui::TableSetupColumn("Object");
+        ImGui::TableSetupColumn("Avg ms");
+        ImGui::TableSetupColumn("Max ms");
+        ImGui::TableSetupColumn("Share");
+        ImGui::TableHeadersRow();
+
+        for (const auto &entry : entries)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s %p", getTypeName(entry.type).c_str(), entry.object);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.4f", entry.averageMs);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.4f", entry.maxMs);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f%%", entry.share * 100.0);
+        }
+
+        ImGui::EndTable();
+    }
+
+    auto AudioProfilerPanel::getTypeName(const std::type_info *type) -> const String &
+    {
+        const auto it = m_typeNames.find(type);
+        if (it != m_typeNames.end())
+            return it->second;
+
+        String name = type->name();
+#if defined(__GNUG__)
+        Int status = 0;
+        if (const auto demangled = abi::__cxa_demangle(type->name(), nullptr, nullptr, &status); status == 0)
+        {
+            name = demangled;
+            std::free(demangled);
+        }
+#endif
+        // Keep the class name only
+        if (const auto colon = name.rfind(':'); colon != String::npos)
+            name.erase(0, colon + 1);
+        if (const auto space = name.rfind(' '); space != String::npos)
+            name.erase(0, space + 1);
+
+        return m_typeNames.emplace(type, std::move(name)).first->second;
+    }
+}
+
+KAZE_NS_END
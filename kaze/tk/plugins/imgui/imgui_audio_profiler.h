@@ -0,0 +1,40 @@
+#pragma once
+#include <kaze/tk/lib.h>
+
+#include <kaze/snd/AudioEngine.h>
+#include <kaze/snd/AudioProfiler.h>
+
+#include <typeinfo>
+#include <unordered_map>
+
+KAZE_NS_BEGIN
+
+namespace plugins::imgui {
+    /// ImGui window showing live audio thread timings from `snd::AudioEngine::getProfilerStats`: callback load
+    /// against the buffer deadline, underruns, and the most expensive sources and effects.
+    class AudioProfilerPanel {
+    public:
+        /// \param[in]  topN  number of sources and of effects to list
+        explicit AudioProfilerPanel(Int topN = 8) : m_topN(topN) { }
+
+        /// Draw the window. Call while building the UI, e.g. from `App::renderUI`.
+        /// \param[in]     engine  engine to profile; the window has a checkbox to enable its profiler
+        /// \param[in,out] open    when not null, shows a close button that sets it to `False`
+        auto draw(snd::AudioEngine &engine, Bool *open = nullptr) -> void;
+
+    private:
+        /// \returns a readable name for an object's type, without the engine namespace
+        auto getTypeName(const std::type_info *type) -> const String &;
+
+        auto drawEntries(const char *id, const List<snd::AudioProfileEntry> &entries) -> void;
+
+        static constexpr Int HistorySize = 120;
+
+        Int m_topN;
+        Float m_loadHistory[HistorySize]{}; ///< peak callback load, sampled per draw
+        Int m_historyOffset{};
+        std::unordered_map<const std::type_info *, String> m_typeNames{};
+    };
+}
+
+KAZE_NS_END
@@ -1,6 +1,8 @@
 set(KAZE_MODULE IMGUI)
 
 set(IMGUI_SOURCES_PRIVATE
+    imgui_audio_profiler.cpp
+    imgui_audio_profiler.h
     imgui_plugin.cpp
     imgui_plugin.h
 )
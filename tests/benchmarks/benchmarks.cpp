@@ -0,0 +1,77 @@
+#include "benchmarks.h"
+
+#include <kaze/core/main.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace bench {
+    namespace {
+        struct Entry {
+            const char *name;
+            Benchmark benchmark;
+        };
+
+        auto getRegistry() -> List<Entry> &
+        {
+            static List<Entry> registry;
+            return registry;
+        }
+    }
+
+    Registrar::Registrar(const char *name, const Benchmark benchmark)
+    {
+        getRegistry().emplace_back(Entry{name, benchmark});
+    }
+
+    auto timeRender(snd::AudioEngine &engine, snd::OfflineAudioDevice &device, const Double seconds) -> RenderTiming
+    {
+        const auto &spec = device.getSpec();
+        const auto bufferFrames = static_cast<Int64>(device.getBufferSize() / spec.bytesPerFrame());
+        const auto bufferCount = std::max<Int64>(static_cast<Int64>(seconds * spec.freq) / bufferFrames, 1);
+
+        // Warm up caches, allocations, and worker threads before measuring
+        for (Int i = 0; i < 16; ++i)
+        {
+            device.render(bufferFrames);
+            engine.update();
+        }
+
+        RenderTiming timing{.budgetNs = 1e9 * static_cast<Double>(bufferFrames) / spec.freq};
+        Double totalNs = 0;
+        for (Int64 i = 0; i < bufferCount; ++i)
+        {
+            Timer timer;
+            device.render(bufferFrames);
+            const auto ns = timer.getNanoseconds();
+            totalNs += ns;
+            timing.worstNs = std::max(timing.worstNs, ns);
+
+            engine.update();
+        }
+
+        timing.nsPerFrame = totalNs / static_cast<Double>(bufferCount * bufferFrames);
+        return timing;
+    }
+}
+
+/// Usage: kaze_snd_benchmarks [name filter...]
+auto kaze::kmain(int argc, char *argv[]) -> Int
+{
+    for (const auto &[name, benchmark] : bench::getRegistry())
+    {
+        Bool isSelected = argc <= 1;
+        for (int i = 1; i < argc && !isSelected; ++i)
+            isSelected = std::strstr(name, argv[i]) != nullptr;
+
+        if ( !isSelected )
+            continue;
+
+        std::printf("== %s ==\n", name);
+        benchmark();
+        std::printf("\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <kaze/core/lib.h>
+
+#include <kaze/snd/AudioEngine.h>
+#include <kaze/snd/backend/offline/OfflineAudioDevice.h>
+
+#include <wav.h>
+
+#include <chrono>
+
+/// Define a benchmark, which runs when its name matches the command line filter, or when no filter is given
+#define KAZE_BENCHMARK(name) \
+    static auto name() -> void; \
+    static const bench::Registrar name ## _registrar(#name, name); \
+    static auto name() -> void
+
+namespace bench {
+    USING_KAZE_NAMESPACE;
+
+    using Benchmark = void (*)();
+
+    struct Registrar {
+        Registrar(const char *name, Benchmark benchmark);
+    };
+
+    /// Measures wall time on the calling thread
+    class Timer {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        Timer() : m_start(Clock::now()) { }
+
+        auto reset() -> void { m_start = Clock::now(); }
+
+        /// \returns nanoseconds passed since construction or the last `reset`
+        [[nodiscard]]
+        auto getNanoseconds() const -> Double
+        {
+            return std::chrono::duration<Double, std::nano>(Clock::now() - m_start).count();
+        }
+
+    private:
+        Clock::time_point m_start;
+    };
+
+    /// Callback timings of an offline render
+    struct RenderTiming {
+        Double nsPerFrame; ///< mean callback time per output frame
+        Double worstNs;    ///< longest single callback
+        Double budgetNs;   ///< length of one buffer in realtime, which a callback must never exceed
+    };
+
+    /// Render `seconds` of audio, after a short warm-up, timing each callback. The engine is updated between
+    /// callbacks, outside of the timing.
+    /// \param[in]  engine   open engine rendering to `device`
+    /// \param[in]  device   device with `OfflineClock::Manual`
+    /// \param[in]  seconds  length of audio to render
+    auto timeRender(snd::AudioEngine &engine, snd::OfflineAudioDevice &device, Double seconds) -> RenderTiming;
+}
@@ -0,0 +1,359 @@
+#include <benchmarks.h>
+
+#include <kaze/snd/effects/CompressorEffect.h>
+#include <kaze/snd/effects/ConvolutionEffect.h>
+#include <kaze/snd/effects/DelayEffect.h>
+#include <kaze/snd/effects/EqEffect.h>
+#include <kaze/snd/effects/FilterEffect.h>
+#include <kaze/snd/effects/LimiterEffect.h>
+#include <kaze/snd/effects/PanEffect.h>
+#include <kaze/snd/effects/ReverbEffect.h>
+#include <kaze/snd/effects/VolumeEffect.h>
+#include <kaze/snd/sources/AudioBus.h>
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+
+namespace {
+    constexpr Int SampleRate = 48000;
+    constexpr Int DefaultBufferFrames = 512;
+    constexpr Int DefaultVoices = 64;
+    constexpr Double Seconds = 2;
+
+    /// Extra effects inserted after each voice's built-in panner and volume
+    enum class EffectChain {
+        None,
+        Pan,
+        PanVolume,
+        PanVolumeDelay,
+        Filter,         ///< a two-section low-pass, as for an occluded voice
+        Eq,             ///< a four-band equalizer
+    };
+
+    /// Dynamics processing on the master bus
+    enum class MasterDynamics {
+        None,
+        Limiter,
+        Compressor,
+        CompressorLookahead, ///< compressor with 5 ms of lookahead
+    };
+
+    struct Scene {
+        Int voices = DefaultVoices;
+        Int bufferFrames = DefaultBufferFrames;
+        EffectChain effects = EffectChain::None;
+        Int busDepth = 0;        ///< number of nested buses between the voices and the master bus
+        Int fadePoints = 0;      ///< fade points per voice, spread over the render
+        Int outputChannels = 2;
+        Int stackedEffects = 0;  ///< extra volume effects inserted into each voice
+        Int reverbBuses = 0;     ///< buses with a reverb each, that the voices are spread across
+        MasterDynamics master = MasterDynamics::None;
+        Bool spatialized = False; ///< whether every voice is a moving emitter around the listener
+        Double impulseSeconds = 0; ///< length of a stereo impulse response convolved on the master bus, `0` for none
+    };
+
+    /// \returns interleaved stereo noise decaying by 60 dB over its length, like a room's impulse response
+    auto makeImpulse(const Int64 frames) -> List<Float>
+    {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<Float> dist(-1.f, 1.f);
+        List<Float> impulse(frames * 2);
+        for (Int64 i = 0; i < frames; ++i)
+        {
+            const auto envelope = std::pow(10.f, -3.f * static_cast<Float>(i) / static_cast<Float>(frames));
+            impulse[i * 2] = dist(rng) * envelope;
+            impulse[i * 2 + 1] = dist(rng) * envelope;
+        }
+
+        return impulse;
+    }
+
+    /// Render `scene` offline and time its callbacks
+    auto renderScene(const List<Ubyte> &wav, const Scene &scene) -> bench::RenderTiming
+    {
+        const auto device = new OfflineAudioDevice;
+        AudioEngine engine(device);
+        if ( !engine.open({.samplerate = SampleRate, .bufferFrameSize = scene.bufferFrames,
+            .channels = scene.outputChannels}) )
+            return {};
+
+        const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()),
+            Sound::Decoded | Sound::Looping);
+
+        switch (scene.master)
+        {
+        case MasterDynamics::Limiter:
+            engine.getMasterBus()->addEffect<LimiterEffect>(0);
+            break;
+        case MasterDynamics::Compressor:
+            engine.getMasterBus()->addEffect<CompressorEffect>(0);
+            break;
+        case MasterDynamics::CompressorLookahead:
+            engine.getMasterBus()->addEffect<CompressorEffect>(0)->lookahead(5);
+            break;
+        default:
+            break;
+        }
+
+        if (scene.impulseSeconds > 0)
+        {
+            const auto frames = static_cast<Int64>(scene.impulseSeconds * SampleRate);
+            const auto impulse = makeImpulse(frames);
+            engine.getMasterBus()->addEffect<ConvolutionEffect>(0, .3f)->setImpulse(impulse.data(), frames, 2);
+        }
+
+        Handle<AudioBus> output{};
+        for (Int i = 0; i < scene.busDepth; ++i)
+            output = engine.createBus(False, output);
+
+        List< Handle<AudioBus> > reverbBuses;
+        for (Int i = 0; i < scene.reverbBuses; ++i)
+        {
+            reverbBuses.emplace_back(engine.createBus(False, output));
+            reverbBuses.back()->addEffect<ReverbEffect>(0, 2.f, .3f, 1.f, 20, 1.f);
+        }
+
+        const auto fadeLength = static_cast<Uint64>(Seconds * SampleRate);
+        for (Int i = 0; i < scene.voices; ++i)
+        {
+            const auto voice = engine.playSound(sound, False,
+                reverbBuses.empty() ? output : reverbBuses[i % reverbBuses.size()]);
+            switch (scene.effects)
+            {
+            case EffectChain::PanVolumeDelay:
+                voice->addEffect<DelayEffect>(2, 1200 + i * 7, 0.3f, 0.2f);
+                [[fallthrough]];
+            case EffectChain::PanVolume:
+                voice->addEffect<VolumeEffect>(2, 0.8f);
+                [[fallthrough]];
+            case EffectChain::Pan:
+                voice->addEffect<PanEffect>(2, 0.9f, 0.6f);
+                break;
+            case EffectChain::Filter:
+                voice->addEffect<FilterEffect>(2, FilterType::LowPass, 800.f + static_cast<Float>(i), 0.7071f,
+                    0.f, 2);
+                break;
+            case EffectChain::Eq:
+                voice->addEffect<EqEffect>(2)->setBand(1, FilterType::Peaking, 1000.f, 1.f, -6.f);
+                break;
+            default:
+                break;
+            }
+
+            if (scene.spatialized)
+            {
+                // Spread around the listener, circling it
+                const auto angle = static_cast<Float>(i) * 2.39996f, distance = 2.f + static_cast<Float>(i % 32);
+                engine.setEmitter(voice, {
+                    .position = {std::cos(angle) * distance, std::sin(angle) * distance},
+                    .velocity = {-std::sin(angle) * 3.f, std::cos(angle) * 3.f},
+                    .maxDistance = 40.f,
+                });
+            }
+
+            for (Int e = 0; e < scene.stackedEffects; ++e)
+                voice->addEffect<VolumeEffect>(2, 0.99f);
+
+            const auto clock = voice->getParentClock();
+            for (Int p = 0; p < scene.fadePoints; ++p)
+                voice->addFadePoint(clock + fadeLength * (p + 1) / scene.fadePoints, p % 2 ? 1.f : .25f);
+        }
+        engine.update();
+
+        const auto timing = bench::timeRender(engine, *device, Seconds);
+        engine.close();
+        return timing;
+    }
+
+    auto printHeader(const char *parameter) -> void
+    {
+        std::printf("%16s %18s %14s %14s %10s\n",
+            parameter, "ns/frame/voice", "ns/frame", "worst us", "worst/budget");
+    }
+
+    auto printRow(const char *value, const Scene &scene, const bench::RenderTiming &timing) -> void
+    {
+        std::printf("%16s %18.2f %14.1f %14.1f %11.1f%%\n", value,
+            timing.nsPerFrame / scene.voices, timing.nsPerFrame, timing.worstNs / 1000,
+            100 * timing.worstNs / timing.budgetNs);
+    }
+}
+
+KAZE_BENCHMARK(MixerSourceCount)
+{
+    const auto wav = testing::makeSineWav(SampleRate, SampleRate);
+    printHeader("voices");
+    for (const Int voices : {1, 4, 16, 64, 256, 1024})
+    {
+        const Scene scene{.voices = voices};
+        printRow(std::to_string(voices).c_str(), scene, renderScene(wav, scene));
+    }
+}
+
+KAZE_BENCHMARK(MixerEffects)
+{
+    const auto wav = testing::makeSineWav(SampleRate, SampleRate);
+    const std::pair<const char *, EffectChain> chains[] = {
+        {"none", EffectChain::None},
+        {"pan", EffectChain::Pan},
+        {"pan+volume", EffectChain::PanVolume},
+        {"pan+volume+delay", EffectChain::PanVolumeDelay},
+        {"low-pass x2", EffectChain::Filter},
+        {"4-band eq", EffectChain::Eq},
+    };
+
+    printHeader("extra effects");
+    for (const auto &[name, effects] : chains)
+    {
+        const Scene scene{.effects = effects};
+        printRow(name, scene, renderScene(wav, scene));
+    }
+}
+
+KAZE_BENCHMARK(MixerEffectChainLength)
+{
+    const auto wav = testing::makeSineWav(SampleRate, SampleRate);
+    printHeader("stacked effects");
+    for (const Int stacked : {0, 2, 4, 8, 16})
+    {
+        const Scene scene{.voices = 256, .effects = EffectChain::PanVolumeDelay, .stackedEffects = stacked};
+        printRow(std::to_string(stacked).c_str(), scene, renderScene(wav, scene));
+    }
+}
+
+KAZE_BENCHMARK(MixerReverbBuses)
+{
+    const auto wav = testing::makeSineWav(SampleRate, SampleRate);
+    printHeader("reverb buses");
+
+    Double baseline = 0;
+    for (const Int buses : {0, 1, 2, 4, 8})
+    {
+        // The baseline routes through one plain bus, so that mostly the reverbs differ
+        const Scene scene{.voices = 16, .busDepth = buses == 0 ? 1 : 0, .reverbBuses = buses};
+        const auto timing = renderScene(wav, scene);
+        printRow(std::to_string(buses).c_str(), scene, timing);
+
+        if (buses == 0)
+        {
+            baseline = timing.nsPerFrame;
+            continue;
+        }
+
+        // One second of audio at the sample rate, against one second of a core
+        const auto perReverb = (timing.nsPerFrame - baseline) / buses;
+        std::printf("%16s %18s %14.1f ns/frame per reverb, %.2f%% of a core\n", "", "", perReverb,
+            perReverb * SampleRate / 1e7);
+    }
+}
+
+KAZE_BENCHMARK(MixerMasterDynamics)
+{
+    const auto wav = testing::makeSineWav(SampleRate, SampleRate);
+    const std::pair<const char *, MasterDynamics> chains[] = {
+        {"none", MasterDynamics::None},
+        {"limiter", MasterDynamics::Limiter},
+        {"compressor", MasterDynamics::Compressor},
+        {"comp+lookahead", MasterDynamics::CompressorLookahead},
+    };
+    printHeader("master dynamics");
+
+    for (const auto &[name, master] : chains)
+    {
+        const Scene scene{.voices = 16, .master = master};
+        printRow(name, scene, renderScene(wav, scene));
+    }
+}
+
+KAZE_BENCHMARK(MixerSpatialized)
+{
+    const auto wav = testing::makeSineWav(SampleRate, SampleRate, 1);
+    printHeader("voices");
+    for (const Int voices : {16, 256, 1024})
+    {
+        for (const auto spatialized : {False, True})
+        {
+            const Scene scene{.voices = voices, .spatialized = spatialized};
+            printRow((std::to_string(voices) + (spatialized ? " positioned" : " flat")).c_str(), scene,
+                renderScene(wav, scene));
+        }
+    }
+}
+
+KAZE_BENCHMARK(MixerConvolution)
+{
+    // Only the head partitions count against the callback; the tails run on the convolution thread
+    const auto wav = testing::makeSineWav(SampleRate, SampleRate);
+    printHeader("impulse seconds");
+    for (const auto seconds : {0.0, 1.0, 4.0})
+    {
+        for (const Int bufferFrames : {256, 512})
+        {
+            const Scene scene{.voices = 16, .bufferFrames = bufferFrames, .impulseSeconds = seconds};
+            printRow((std::to_string(static_cast<Int>(seconds)) + " s, " + std::to_string(bufferFrames) +
+                " frames").c_str(), scene, renderScene(wav, scene));
+        }
+    }
+}
+
+KAZE_BENCHMARK(MixerBusDepth)
+{
+    const auto wav = testing::makeSineWav(SampleRate, SampleRate);
+    printHeader("bus depth");
+    for (const Int depth : {0, 1, 2, 4, 8, 16})
+    {
+        const Scene scene{.busDepth = depth};
+        printRow(std::to_string(depth).c_str(), scene, renderScene(wav, scene));
+    }
+}
+
+KAZE_BENCHMARK(MixerFadePoints)
+{
+    const auto wav = testing::makeSineWav(SampleRate, SampleRate);
+    printHeader("fade points");
+    for (const Int fadePoints : {0, 1, 16, 256})
+    {
+        const Scene scene{.fadePoints = fadePoints};
+        printRow(std::to_string(fadePoints).c_str(), scene, renderScene(wav, scene));
+    }
+}
+
+KAZE_BENCHMARK(MixerBufferSize)
+{
+    const auto wav = testing::makeSineWav(SampleRate, SampleRate);
+    printHeader("buffer frames");
+    for (const Int bufferFrames : {64, 128, 256, 512, 1024, 2048, 4096})
+    {
+        const Scene scene{.bufferFrames = bufferFrames};
+        printRow(std::to_string(bufferFrames).c_str(), scene, renderScene(wav, scene));
+    }
+}
+
+KAZE_BENCHMARK(MixerChannels)
+{
+    const struct {
+        const char *name;
+        Int sourceChannels;
+        Int outputChannels;
+    } layouts[] = {
+        {"mono -> stereo", 1, 2},
+        {"stereo -> stereo", 2, 2},
+        {"mono -> 5.1", 1, 6},
+        {"stereo -> 5.1", 2, 6},
+        {"stereo -> 7.1", 2, 8},
+    };
+
+    printHeader("layout");
+    for (const auto &[name, sourceChannels, outputChannels] : layouts)
+    {
+        const auto wav = testing::makeSineWav(SampleRate, SampleRate, sourceChannels);
+        const Scene scene{.outputChannels = outputChannels};
+        printRow(name, scene, renderScene(wav, scene));
+    }
+}
@@ -0,0 +1,63 @@
+#include <benchmarks.h>
+
+#include <kaze/snd/effects/DelayEffect.h>
+#include <kaze/snd/sources/AudioBus.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+
+namespace {
+    constexpr Int BufferFrames = 512;
+    constexpr Int VoicesPerBus = 16;
+    constexpr Double Seconds = 5;
+
+    /// Render `busCount` sibling buses, each mixing several voices through a delay line
+    auto renderBuses(const List<Ubyte> &wav, const Int busCount, const Int mixerThreads) -> bench::RenderTiming
+    {
+        const auto device = new OfflineAudioDevice;
+        AudioEngine engine(device);
+        if ( !engine.open({.samplerate = 48000, .bufferFrameSize = BufferFrames, .mixerThreads = mixerThreads}) )
+            return {};
+
+        const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()),
+            Sound::Decoded | Sound::Looping);
+        for (Int i = 0; i < busCount; ++i)
+        {
+            const auto bus = engine.createBus(False);
+            bus->addEffect<DelayEffect>(2, 4800 + i * 37, 0.5f, 0.3f);
+            for (Int v = 0; v < VoicesPerBus; ++v)
+                engine.playSound(sound, False, bus);
+        }
+        engine.update();
+
+        const auto timing = bench::timeRender(engine, *device, Seconds);
+        engine.close();
+        return timing;
+    }
+}
+
+KAZE_BENCHMARK(ParallelMixing)
+{
+    const auto hardwareThreads = static_cast<Int>(std::thread::hardware_concurrency());
+    const auto mixerThreads = std::clamp(hardwareThreads - 1, 1, 7);
+    const auto wav = testing::makeSineWav(48000, 48000);
+
+    std::printf("%d voices per bus, %d-frame buffers, %d mixer threads\n",
+        VoicesPerBus, BufferFrames, mixerThreads);
+    std::printf("%6s %16s %16s %16s %16s %8s\n",
+        "buses", "serial ns/frame", "serial worst us", "parallel ns/frame", "parallel worst us", "speedup");
+
+    for (const Int busCount : {1, 2, 4, 8, 16})
+    {
+        const auto serial = renderBuses(wav, busCount, 0);
+        const auto parallel = renderBuses(wav, busCount, mixerThreads);
+        std::printf("%6d %16.1f %16.1f %16.1f %16.1f %7.2fx\n", busCount,
+            serial.nsPerFrame, serial.worstNs / 1000,
+            parallel.nsPerFrame, parallel.worstNs / 1000,
+            parallel.nsPerFrame > 0 ? serial.nsPerFrame / parallel.nsPerFrame : 0.0);
+    }
+}
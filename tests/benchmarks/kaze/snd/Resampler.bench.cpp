@@ -0,0 +1,68 @@
+#include <benchmarks.h>
+
+#include <kaze/snd/AudioSource.h>
+
+#include <cstdio>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+
+namespace {
+    constexpr Int SampleRate = 48000;
+    constexpr Int BufferFrames = 512;
+    constexpr Int Voices = 64;
+    constexpr Double Seconds = 2;
+
+    /// Render voices at `pitch` offline and time its callbacks
+    auto renderPitched(const List<Ubyte> &wav, const Float pitch, const ResampleQuality quality,
+        const Sound::InitFlags flags) -> bench::RenderTiming
+    {
+        const auto device = new OfflineAudioDevice;
+        AudioEngine engine(device);
+        if ( !engine.open({.samplerate = SampleRate, .bufferFrameSize = BufferFrames}) )
+            return {};
+
+        const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()), flags);
+        for (Int i = 0; i < Voices; ++i)
+        {
+            const auto voice = engine.playSound(sound);
+            voice->setPitch(pitch);
+            voice->setResampleQuality(quality);
+        }
+        engine.update();
+
+        const auto timing = bench::timeRender(engine, *device, Seconds);
+        engine.close();
+        return timing;
+    }
+}
+
+KAZE_BENCHMARK(ResamplerQuality)
+{
+    const auto wav = testing::makeSineWav(SampleRate, SampleRate);
+    const struct {
+        const char *name;
+        Sound::InitFlags flags;
+    } sources[] = {
+        {"decoded", Sound::Decoded | Sound::Looping},
+        {"streamed", Sound::Stream | Sound::Looping},
+    };
+
+    std::printf("%d voices, %d-frame buffers\n", Voices, BufferFrames);
+    std::printf("%10s %8s %16s %16s %16s\n", "source", "pitch", "off ns/f/voice", "linear ns/f/voice",
+        "sinc ns/f/voice");
+
+    for (const auto &[name, flags] : sources)
+    {
+        const auto unpitched = renderPitched(wav, 1.f, ResampleQuality::Sinc, flags);
+        std::printf("%10s %8.2f %16.2f %16s %16s\n", name, 1.f, unpitched.nsPerFrame / Voices, "-", "-");
+
+        for (const Float pitch : {.5f, .89f, 1.5f, 2.f, 3.5f})
+        {
+            const auto linear = renderPitched(wav, pitch, ResampleQuality::Linear, flags);
+            const auto sinc = renderPitched(wav, pitch, ResampleQuality::Sinc, flags);
+            std::printf("%10s %8.2f %16s %16.2f %16.2f\n", name, pitch, "-",
+                linear.nsPerFrame / Voices, sinc.nsPerFrame / Voices);
+        }
+    }
+}
@@ -0,0 +1,10 @@
+#include "wav.h"
+
+#include <cmath>
+
+namespace testing {
+    auto makeSineWav(const Int frequency, const Int frames, const Int channels) -> List<Ubyte>
+    {
+        return makeWav(frequency, frames, channels, [](const Int i) { return std::sin(i * 0.05) * 8000; });
+    }
+}
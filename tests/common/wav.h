@@ -0,0 +1,39 @@
+#pragma once
+#include <kaze/core/lib.h>
+
+/// WAV files generated in memory, shared by the unit tests and benchmarks
+namespace testing {
+    USING_KAZE_NAMESPACE;
+
+    /// \returns a 16-bit .wav file with every channel of frame `i` set to `getSample(i)`
+    template <typename TGetSample>
+    auto makeWav(const Int frequency, const Int frames, const Int channels, TGetSample getSample) -> List<Ubyte>
+    {
+        List<Ubyte> wav;
+        const auto write = [&wav](const Uint value, const Int bytes) {
+            for (Int i = 0; i < bytes; ++i)
+                wav.emplace_back(static_cast<Ubyte>(value >> (i * 8)));
+        };
+        const auto writeTag = [&wav](const char *tag) {
+            wav.insert(wav.end(), tag, tag + 4);
+        };
+
+        const auto dataSize = static_cast<Uint>(frames * channels * sizeof(Int16));
+        writeTag("RIFF"); write(36 + dataSize, 4); writeTag("WAVE");
+        writeTag("fmt "); write(16, 4); write(1, 2); write(channels, 2);
+        write(frequency, 4); write(frequency * channels * 2, 4); write(channels * 2, 2); write(16, 2);
+        writeTag("data"); write(dataSize, 4);
+
+        for (Int i = 0; i < frames; ++i)
+        {
+            const auto sample = static_cast<Int16>(getSample(i));
+            for (Int c = 0; c < channels; ++c)
+                write(static_cast<Uint16>(sample), 2);
+        }
+
+        return wav;
+    }
+
+    /// \returns a 16-bit .wav file containing a sine tone, the same in every channel
+    auto makeSineWav(Int frequency, Int frames, Int channels = 2) -> List<Ubyte>;
+}
@@ -0,0 +1,131 @@
+#include <doctest/doctest.h>
+#include <kaze/core/CommandRing.h>
+
+#include <thread>
+
+USING_KAZE_NAMESPACE;
+
+namespace {
+    List<Int> *g_log;
+
+    struct PushValue {
+        Int value;
+        auto operator()() -> void { g_log->emplace_back(value); }
+    };
+
+    struct PushNegative {
+        Int value;
+        auto operator()() -> void { g_log->emplace_back(-value); }
+    };
+
+    using TestRing = CommandRing< Variant<PushValue, PushNegative> >;
+}
+
+TEST_SUITE("CommandRing")
+{
+    TEST_CASE("Capacity rounds up to a power of two")
+    {
+        CHECK(TestRing(3).capacity() == 4);
+        CHECK(TestRing(16).capacity() == 16);
+        CHECK(TestRing(17).capacity() == 32);
+    }
+
+    TEST_CASE("Commands run in push order")
+    {
+        List<Int> log;
+        g_log = &log;
+
+        TestRing ring(8);
+        ring.pushCommand(PushValue{1});
+        ring.pushCommand(PushNegative{2});
+        ring.pushCommand(PushValue{3});
+        CHECK(ring.size() == 3);
+
+        ring.processCommands();
+        CHECK(log == List<Int>{1, -2, 3});
+        CHECK(ring.size() == 0);
+
+        const auto stats = ring.getStats();
+        CHECK(stats.pushed == 3);
+        CHECK(stats.processed == 3);
+        CHECK(stats.overflowed == 0);
+        CHECK(stats.highWater == 3);
+    }
+
+    TEST_CASE("Wraps around the ring")
+    {
+        List<Int> log;
+        g_log = &log;
+
+        TestRing ring(4);
+        for (Int i = 0; i < 10; ++i)
+        {
+            ring.pushCommand(PushValue{i});
+            ring.pushCommand(PushValue{i + 100});
+            ring.processCommands();
+        }
+
+        CHECK(log.size() == 20);
+        CHECK(log[18] == 9);
+        CHECK(log[19] == 109);
+        CHECK(ring.getStats().overflowed == 0);
+    }
+
+    TEST_CASE("Overflow spills without losing order")
+    {
+        List<Int> log;
+        g_log = &log;
+
+        TestRing ring(4);
+        for (Int i = 0; i < 10; ++i)
+            ring.pushCommand(PushValue{i});
+
+        CHECK(ring.size() == 10);
+        CHECK(ring.getStats().overflowed == 6);
+
+        ring.processCommands();
+        CHECK(log == List<Int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+        CHECK(ring.size() == 0);
+
+        // After draining, pushes go back into the ring
+        ring.pushCommand(PushValue{10});
+        ring.processCommands();
+        CHECK(log.back() == 10);
+        CHECK(ring.getStats().overflowed == 6);
+        CHECK(ring.getStats().processed == 11);
+    }
+
+    TEST_CASE("Producer and consumer on separate threads")
+    {
+        List<Int> log;
+        g_log = &log;
+
+        constexpr Int Count = 100000;
+        TestRing ring(64);
+
+        std::atomic<Bool> done{};
+        auto producer = std::thread([&ring, &done]() {
+            for (Int i = 0; i < Count; ++i)
+                ring.pushCommand(PushValue{i});
+            done.store(True, std::memory_order_release);
+        });
+
+        while ( !done.load(std::memory_order_acquire) || ring.size() > 0 )
+            ring.processCommands();
+        producer.join();
+        ring.processCommandsBlocking();
+
+        REQUIRE(log.size() == Count);
+        Bool inOrder = True;
+        for (Int i = 0; i < Count; ++i)
+        {
+            if (log[i] != i)
+            {
+                inOrder = False;
+                break;
+            }
+        }
+        CHECK(inOrder);
+        CHECK(ring.getStats().processed == Count);
+    }
+}
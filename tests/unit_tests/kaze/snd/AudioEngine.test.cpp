@@ -0,0 +1,1056 @@
+#include <doctest/doctest.h>
+
+#include <kaze/snd/AudioDevice.h>
+#include <kaze/snd/AudioEngine.h>
+#include <kaze/snd/backend/offline/OfflineAudioDevice.h>
+#include <kaze/snd/conv/StreamThread.h>
+#include <kaze/snd/effects/DelayEffect.h>
+#include <kaze/snd/sources/AudioBus.h>
+#include <kaze/snd/sources/PCMSource.h>
+#include <kaze/snd/sources/StreamSource.h>
+
+#include <kaze/core/endian.h>
+#include <kaze/core/errors.h>
+
+#include <testing.h>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+using namespace testing;
+
+namespace {
+    /// Renders on its own thread as fast as possible, standing in for a hardware device
+    class RenderThreadDevice final : public AudioDevice {
+    public:
+        ~RenderThreadDevice() override { close(); }
+
+        auto open(const AudioDeviceOpen &config) -> Bool override
+        {
+            m_spec = AudioSpec(config.frequency, 2, SampleFormat(sizeof(float) * CHAR_BIT, true, Endian::isBig(), true));
+            m_buffer.resize(config.frameBufferSize * m_spec.bytesPerFrame(), 0);
+            m_callback = config.audioCallback;
+            m_userdata = config.userdata;
+            m_isOpen = True;
+            return True;
+        }
+
+        auto close() -> void override
+        {
+            suspend();
+            m_isOpen = False;
+        }
+
+        auto suspend() -> void override
+        {
+            m_isRunning.store(False, std::memory_order_release);
+            if (m_thread.joinable())
+                m_thread.join();
+        }
+
+        auto resume() -> void override
+        {
+            if (m_isRunning.load(std::memory_order_acquire))
+                return;
+
+            m_isRunning.store(True, std::memory_order_release);
+            m_thread = std::thread([this]() {
+                while (m_isRunning.load(std::memory_order_acquire))
+                {
+                    m_callback(m_userdata, &m_buffer);
+                    m_callbackCount.fetch_add(1, std::memory_order_relaxed);
+
+                    auto peak = m_peak.load(std::memory_order_relaxed);
+                    for (auto sample = (const float *)m_buffer.data(),
+                        end = (const float *)(m_buffer.data() + m_buffer.size()); sample != end; ++sample)
+                    {
+                        peak = std::max(peak, std::abs(*sample));
+                    }
+                    m_peak.store(peak, std::memory_order_relaxed);
+                }
+            });
+        }
+
+        [[nodiscard]] auto getDefaultSampleRate() const -> Int override { return 48000; }
+        [[nodiscard]] auto isOpen() const -> Bool override { return m_isOpen; }
+        [[nodiscard]] auto isRunning() const -> Bool override { return m_isRunning.load(std::memory_order_acquire); }
+        [[nodiscard]] auto getId() const -> Uint override { return 1; }
+        [[nodiscard]] auto getSpec() const -> const AudioSpec & override { return m_spec; }
+        [[nodiscard]] auto getBufferSize() const -> Int override { return static_cast<Int>(m_buffer.size()); }
+
+        [[nodiscard]] auto getCallbackCount() const -> Uint64 { return m_callbackCount.load(std::memory_order_relaxed); }
+
+        /// \returns the greatest absolute sample value rendered so far
+        [[nodiscard]] auto getPeak() const -> Float { return m_peak.load(std::memory_order_relaxed); }
+
+    private:
+        AudioSpec m_spec{};
+        AlignedList<Uint8, 16> m_buffer{};
+        AudioCallback m_callback{};
+        void *m_userdata{};
+        Bool m_isOpen{};
+        std::atomic<Bool> m_isRunning{};
+        std::atomic<Uint64> m_callbackCount{};
+        std::atomic<Float> m_peak{};
+        std::thread m_thread{};
+    };
+}
+
+TEST_SUITE("AudioEngine")
+{
+    TEST_CASE("Create and release sources while rendering")
+    {
+        const auto device = new RenderThreadDevice;
+        AudioEngine engine(device);
+        REQUIRE(engine.open({.samplerate = 48000, .bufferFrameSize = 128}));
+
+        const auto wav = makeSineWav(48000, 480);
+        const auto oneShot = engine.createSound(MemView<void>(wav.data(), wav.size()), Sound::OneShot);
+        const auto looping = engine.createSound(MemView<void>(wav.data(), wav.size()), Sound::Looping);
+        REQUIRE(oneShot);
+        REQUIRE(looping);
+
+        List< Handle<AudioSource> > voices;
+        for (Int i = 0; i < 2000; ++i)
+        {
+            // One-shots release themselves on the audio thread when finished
+            engine.playSound(oneShot);
+
+            voices.emplace_back(engine.playSound(looping));
+            if (voices.size() > 16)
+            {
+                voices.front()->release();
+                voices.erase(voices.begin());
+            }
+
+            if (i % 50 == 0)
+            {
+                const auto bus = engine.createBus(False);
+                REQUIRE(bus);
+                engine.playSound(looping, False, bus);
+                engine.playSound(oneShot, False, bus);
+                bus->release(i % 100 == 0);
+            }
+
+            engine.update();
+        }
+
+        // Let the device finish with everything that was sent
+        const auto callbackTarget = device->getCallbackCount() + 8;
+        while (device->getCallbackCount() < callbackTarget)
+        {
+            engine.update();
+            std::this_thread::yield();
+        }
+
+        engine.close();
+
+        const auto stats = engine.getCommandStats();
+        CHECK(device->getCallbackCount() > 0);
+        CHECK(stats.immediate.processed == stats.immediate.pushed);
+        CHECK(stats.deferred.pushed > 0);
+        CHECK(stats.deferred.processed == stats.deferred.pushed);
+    }
+
+    TEST_CASE("Releases that overflow the deferred ring wait for room instead of blocking")
+    {
+        const auto device = new OfflineAudioDevice;
+        AudioEngine engine(device);
+        REQUIRE(engine.open({.samplerate = 48000, .bufferFrameSize = 256}));
+
+        const auto wav = makeSineWav(48000, 480);
+        const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()),
+            Sound::Decoded | Sound::Looping);
+        REQUIRE(sound);
+
+        // Release more voices in one callback than the deferred ring holds
+        const auto capacity = engine.getCommandStats().deferred.capacity;
+        const auto voiceCount = static_cast<Int>(capacity + capacity / 2);
+        List< Handle<AudioSource> > voices;
+        for (Int i = 0; i < voiceCount; ++i)
+        {
+            voices.emplace_back(engine.playSound(sound));
+            REQUIRE(voices.back().isValid());
+        }
+        device->render(256);
+
+        for (auto &voice : voices)
+            voice->release();
+        device->render(256);
+
+        // The audio thread filled the ring without spilling, and kept the rest out of the mix
+        auto stats = engine.getCommandStats();
+        CHECK(stats.deferred.pushed == capacity);
+        CHECK(stats.deferred.overflowed == 0);
+
+        const auto samples = reinterpret_cast<const Float *>(device->getBuffer().data());
+        CHECK(std::all_of(samples, samples + 256 * 2, [](const Float sample) { return sample == 0; }));
+
+        // Each update makes room for the callback after it to hand off the rest
+        for (Int i = 0; i < 4 && engine.getCommandStats().deferred.processed < static_cast<Uint64>(voiceCount); ++i)
+        {
+            engine.update();
+            device->render(256);
+        }
+        engine.update();
+
+        stats = engine.getCommandStats();
+        CHECK(stats.deferred.pushed == static_cast<Uint64>(voiceCount));
+        CHECK(stats.deferred.processed == static_cast<Uint64>(voiceCount));
+        CHECK(stats.deferred.overflowed == 0);
+
+        engine.releaseSound(sound);
+        engine.close();
+    }
+
+    TEST_CASE("Decoded sounds play from a shared PCM buffer")
+    {
+        const auto device = new RenderThreadDevice;
+        AudioEngine engine(device);
+        REQUIRE(engine.open({.samplerate = 48000, .bufferFrameSize = 128}));
+
+        const auto wav = makeSineWav(48000, 4800);
+        const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()),
+            Sound::Decoded | Sound::OneShot);
+        REQUIRE(sound);
+
+        constexpr Int VoiceCount = 8;
+        for (Int i = 0; i < VoiceCount; ++i)
+            REQUIRE(engine.playSound(sound));
+
+        // The sound no longer needs to be alive once its instances hold the buffer
+        engine.releaseSound(sound);
+
+        // Wait for every one-shot to finish and be released
+        for (Int i = 0; i < 10000 && engine.getCommandStats().deferred.processed < VoiceCount; ++i)
+        {
+            engine.update();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+
+        CHECK(engine.getCommandStats().deferred.processed == VoiceCount);
+        CHECK(device->getPeak() > 0.1f);
+        engine.close();
+    }
+
+    TEST_CASE("Prefetched streams decode on the stream thread")
+    {
+        const auto device = new RenderThreadDevice;
+        AudioEngine engine(device);
+        REQUIRE(engine.open({.samplerate = 48000, .bufferFrameSize = 128}));
+
+        const auto wav = makeSineWav(48000, 48000);
+        const auto oneShot = engine.createSound(MemView<void>(wav.data(), wav.size()),
+            Sound::Prefetch | Sound::OneShot);
+        const auto looping = engine.createSound(MemView<void>(wav.data(), wav.size()),
+            Sound::Prefetch | Sound::Looping);
+        REQUIRE(oneShot);
+        REQUIRE(looping);
+
+        REQUIRE(engine.playSound(oneShot));
+        const auto voice = engine.playSound(looping);
+        REQUIRE(voice);
+
+        const auto stream = voice.getAs<StreamSource>();
+        REQUIRE(stream);
+        CHECK(stream->isPrefetching());
+
+        // Wait for the one-shot to reach its end and be released
+        for (Int i = 0; i < 20000 && engine.getCommandStats().deferred.processed < 1; ++i)
+        {
+            engine.update();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+
+        const auto stats = stream->getPrefetchStats();
+        CHECK(engine.getCommandStats().deferred.processed == 1);
+        CHECK(stats.blocksDecoded > 0);
+        CHECK(stats.capacityFrames == PrefetchStream::DefaultBlockCount * PrefetchStream::DefaultBlockFrames);
+        CHECK(device->getPeak() > 0.1f);
+
+        voice->release();
+        engine.close();
+    }
+
+    TEST_CASE("Streams stay readable after the stream thread stops until they are released")
+    {
+        const auto wav = makeSineWav(48000, 48000);
+        const auto spec = AudioSpec(48000, 2, SampleFormat(sizeof(Float) * CHAR_BIT, true, Endian::isBig(), true));
+
+        AudioDecoder decoder;
+        REQUIRE(decoder.openConstMem(MemView<void>(wav.data(), wav.size()), spec));
+
+        StreamThread thread;
+        const auto stream = new PrefetchStream(std::move(decoder));
+        stream->fill();
+        thread.add(stream);
+        CHECK(thread.isRunning());
+
+        // A context closing stops the thread before every source has released its stream
+        thread.stop();
+        CHECK_FALSE(thread.isRunning());
+
+        List<Float> output(256 * 2);
+        CHECK(stream->read(reinterpret_cast<Ubyte *>(output.data()), 256) == 256);
+
+        // Releasing deletes it right away, without restarting the thread
+        thread.release(stream);
+        CHECK_FALSE(thread.isRunning());
+    }
+
+    TEST_CASE("Compressed sounds share decoded blocks between instances")
+    {
+        const auto wav = makeSineWav(48000, 48000);
+        const auto mem = MemView<void>(wav.data(), wav.size());
+        const auto spec = AudioSpec(48000, 2, SampleFormat(sizeof(Float) * CHAR_BIT, true, Endian::isBig(), true));
+
+        AudioDecoder reference;
+        REQUIRE(reference.openConstMem(mem, spec));
+        List<Float> expected(48000 * 2);
+        REQUIRE(reference.readFrames(expected.data(), 48000) == 48000);
+
+        // Fill and read on this thread, standing in for the stream thread and the audio thread
+        const auto readStream = [](PrefetchStream &stream, const Int64 frames) -> List<Float> {
+            List<Float> output(frames * 2);
+            for (Int64 copied = 0; copied < frames;)
+            {
+                stream.fill();
+                copied += stream.read(reinterpret_cast<Ubyte *>(output.data() + copied * 2), frames - copied);
+            }
+            return output;
+        };
+        const auto slice = [&expected](const Int64 start, const Int64 frames) -> List<Float> {
+            return {expected.begin() + start * 2, expected.begin() + (start + frames) * 2};
+        };
+
+        SUBCASE("Cached streams play the decoder's frames from any position")
+        {
+            BlockCache cache;
+            const auto key = cache.makeKey();
+
+            AudioDecoder decoder;
+            REQUIRE(decoder.openConstMem(mem, spec));
+            PrefetchStream stream(std::move(decoder), 4, 0, &cache, key);
+            CHECK(readStream(stream, 3000) == slice(0, 3000));
+
+            // Seeks land partway into a block, whose earlier frames are skipped
+            stream.seek(10000);
+            CHECK(readStream(stream, 5000) == slice(10000, 5000));
+            const auto misses = cache.getStats().misses;
+
+            // A second stream replays the first's blocks without decoding them again
+            AudioDecoder looping;
+            REQUIRE(looping.openConstMem(mem, spec));
+            looping.setLooping(True);
+            PrefetchStream replay(std::move(looping), 4, 0, &cache, key);
+            CHECK(readStream(replay, 12000) == slice(0, 12000));
+            CHECK(cache.getStats().misses == misses);
+            CHECK(cache.getStats().hits >= 5);
+
+            // Loops wrap around from the short last block
+            replay.seek(47000);
+            auto wrapped = slice(47000, 1000);
+            const auto start = slice(0, 1000);
+            wrapped.insert(wrapped.end(), start.begin(), start.end());
+            CHECK(readStream(replay, 2000) == wrapped);
+            CHECK(cache.getBytes(key) == cache.getStats().bytes);
+        }
+
+        SUBCASE("Instances of a compressed sound share the engine's cache")
+        {
+            const auto device = new OfflineAudioDevice;
+            AudioEngine engine(device);
+            REQUIRE(engine.open({.samplerate = 48000, .bufferFrameSize = 256}));
+
+            const auto sound = engine.createSound(mem, Sound::Compressed);
+            REQUIRE(sound);
+            CHECK(sound->getMemoryUsage().fileBytes == wav.size());
+            CHECK(sound->getMemoryUsage().cachedBytes == 0);
+
+            // Each instance decodes a ring's worth of blocks when played; the second finds them cached
+            const auto first = engine.playSound(sound);
+            const auto second = engine.playSound(sound);
+            REQUIRE(first);
+            REQUIRE(second);
+            CHECK(first.getAs<StreamSource>()->isPrefetching());
+
+            constexpr auto BlockBytes = BlockCache::BlockFrames * 2 * sizeof(Float);
+            auto stats = engine.getBlockCacheStats();
+            CHECK(stats.misses == PrefetchStream::DefaultBlockCount);
+            CHECK(stats.hits == PrefetchStream::DefaultBlockCount);
+            CHECK(stats.getHitRate() == doctest::Approx(.5));
+            CHECK(stats.bytes == PrefetchStream::DefaultBlockCount * BlockBytes);
+            CHECK(sound->getMemoryUsage().cachedBytes == stats.bytes);
+
+            engine.setBlockCacheCapacity(3 * BlockBytes);
+            stats = engine.getBlockCacheStats();
+            CHECK(stats.blocks == 3);
+            CHECK(stats.capacity == 3 * BlockBytes);
+
+            engine.releaseSound(sound);
+            CHECK(engine.getBlockCacheStats().bytes == 0);
+            engine.close();
+        }
+    }
+
+    TEST_CASE("Voice limits virtualize and restore voices")
+    {
+        const auto device = new RenderThreadDevice;
+        AudioEngine engine(device);
+        REQUIRE(engine.open({.samplerate = 48000, .bufferFrameSize = 128}));
+
+        const auto wav = makeSineWav(48000, 4800);
+        const auto music = engine.createSound(MemView<void>(wav.data(), wav.size()), Sound::Looping);
+        const auto footstep = engine.createSound(MemView<void>(wav.data(), wav.size()),
+            Sound::Decoded | Sound::Looping);
+        REQUIRE(music);
+        REQUIRE(footstep);
+
+        engine.setMaxVoices(4);
+        footstep->setMaxVoices(2);
+        music->setPriority(1);
+
+        // Footsteps over their own limit take over the oldest footstep
+        const auto step0 = engine.playSound(footstep);
+        const auto step1 = engine.playSound(footstep);
+        const auto step2 = engine.playSound(footstep);
+        CHECK(engine.isVirtual(step0));
+        CHECK( !engine.isVirtual(step1) );
+        CHECK( !engine.isVirtual(step2) );
+
+        // Higher priority music takes over footsteps once the global limit is reached, but never the reverse
+        List< Handle<AudioSource> > tracks;
+        for (Int i = 0; i < 3; ++i)
+            tracks.emplace_back(engine.playSound(music));
+        for (const auto &track : tracks)
+            CHECK( !engine.isVirtual(track) );
+
+        auto stats = engine.getVoiceStats();
+        CHECK(stats.active == 4);
+        CHECK(stats.virtualized == 2);
+        CHECK(stats.stolen == 2);
+
+        // Equal priority may take over a slot
+        const auto step3 = engine.playSound(footstep);
+        CHECK( !engine.isVirtual(step3) );
+        CHECK(engine.isVirtual(step2));
+
+        // Virtual voices keep time without being mixed
+        const auto clock = step0->getClock();
+        const auto callbackTarget = device->getCallbackCount() + 8;
+        while (device->getCallbackCount() < callbackTarget)
+        {
+            engine.update();
+            std::this_thread::yield();
+        }
+        CHECK(step0->getClock() > clock);
+        CHECK(step0->isVirtual());
+
+        // Freed slots go back to virtual voices during update, as long as their sound's own limit allows
+        tracks[0]->release();
+        tracks[1]->release();
+        engine.update();
+
+        stats = engine.getVoiceStats();
+        CHECK(stats.active == 3);
+        CHECK(stats.virtualized == 2);
+        CHECK(stats.stolen == 3);
+        CHECK( !engine.isVirtual(step0) ); // oldest footstep is restored first
+        CHECK(engine.isVirtual(step1));
+
+        engine.close();
+    }
+
+    TEST_CASE("Parallel mixing matches mixing on the audio thread")
+    {
+        const auto wav = makeSineWav(48000, 4800);
+
+        // Renders a graph with sibling, nested, and paused buses
+        const auto renderGraph = [&wav](const Int mixerThreads) -> List<Float> {
+            return renderOffline({.samplerate = 48000, .bufferFrameSize = 256, .mixerThreads = mixerThreads},
+                [&](AudioEngine &engine) {
+                    REQUIRE(engine.getMixerThreadCount() == mixerThreads);
+
+                    const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()),
+                        Sound::Decoded | Sound::Looping);
+                    REQUIRE(sound);
+
+                    List< Handle<AudioBus> > buses;
+                    for (Int i = 0; i < 6; ++i)
+                    {
+                        // Every third bus nests under the previous one
+                        const auto bus = engine.createBus(False, i % 3 == 2 ? buses.back() : Handle<AudioBus>{});
+                        REQUIRE(bus);
+                        bus->addEffect<DelayEffect>(2, 100 + i * 37, 0.4f, 0.3f);
+                        bus->setVolume(0.2f + 0.1f * static_cast<Float>(i));
+                        for (Int v = 0; v <= i; ++v)
+                            engine.playSound(sound, False, bus);
+                        buses.emplace_back(bus);
+                    }
+
+                    return [bus = buses[1]](const Int i) {
+                        if (i == 16) // pause partway through a buffer, forcing the parent to render its children itself
+                            bus->pauseAt(bus->getParentClock() + 300);
+                        if (i == 32)
+                            bus->setPaused(False);
+                    };
+                }, 64);
+        };
+
+        const auto serial = renderGraph(0);
+        const auto parallel = renderGraph(3);
+        REQUIRE(serial.size() == parallel.size());
+        CHECK(*std::max_element(serial.begin(), serial.end()) > 0.1f);
+        CHECK(std::memcmp(serial.data(), parallel.data(), serial.size() * sizeof(Float)) == 0);
+    }
+
+    TEST_CASE("Graphs beyond the parallel mixer's bounds mix on the audio thread")
+    {
+        const auto wav = makeSineWav(48000, 4800);
+
+        // Renders a chain of nested buses deeper than the mixer collects, then shortens it to fit
+        const auto renderChain = [&wav](const Int mixerThreads) -> List<Float> {
+            return renderOffline({.samplerate = 48000, .bufferFrameSize = 256, .mixerThreads = mixerThreads},
+                [&wav](AudioEngine &engine) {
+                    const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()),
+                        Sound::Decoded | Sound::Looping);
+                    REQUIRE(sound);
+
+                    List< Handle<AudioBus> > buses;
+                    for (Size i = 0; i < AudioContext::MaxMixerBusDepth + 4; ++i)
+                    {
+                        const auto bus = engine.createBus(False, buses.empty() ? Handle<AudioBus>{} : buses.back());
+                        REQUIRE(bus);
+                        bus->setVolume(0.9f);
+                        engine.playSound(sound, False, bus);
+                        buses.emplace_back(bus);
+                    }
+
+                    return [bus = buses[AudioContext::MaxMixerBusDepth / 2]](const Int i) {
+                        if (i == 16)
+                            bus->release(True);
+                    };
+                }, 32);
+        };
+
+        const auto serial = renderChain(0);
+        const auto parallel = renderChain(2);
+        REQUIRE(serial.size() == parallel.size());
+        CHECK(*std::max_element(serial.begin(), serial.end()) > 0.1f);
+        CHECK(std::memcmp(serial.data(), parallel.data(), serial.size() * sizeof(Float)) == 0);
+    }
+
+    TEST_CASE("Buses take more sources than they reserve up front")
+    {
+        constexpr Int VoiceCount = 300;
+        const auto wav = makeSineWav(48000, 4800);
+
+        // Renders voices connected to a bus before the first callback, then moves them to the master bus
+        const auto render = [&wav](const Int voiceCount) -> List<Float> {
+            return renderOffline({.samplerate = 48000, .bufferFrameSize = 256}, [&wav, voiceCount](AudioEngine &engine) {
+                const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()),
+                    Sound::Decoded | Sound::Looping);
+                REQUIRE(sound);
+
+                const auto bus = engine.createBus(False);
+                REQUIRE(bus);
+                bus->setVolume(1.f / VoiceCount);
+                for (Int i = 0; i < voiceCount; ++i)
+                    REQUIRE(engine.playSound(sound, False, bus));
+
+                return [bus](const Int i) {
+                    if (i == 4)
+                        bus->release(False);
+                };
+            }, 8);
+        };
+
+        const auto single = render(1);
+        const auto many = render(VoiceCount);
+        REQUIRE(single.size() == many.size());
+        CHECK(*std::max_element(single.begin(), single.end()) > 0.1f);
+
+        Int mismatches = 0;
+        for (Size i = 0; i < many.size(); ++i)
+        {
+            const auto expected = single[i] * VoiceCount;
+            if (std::abs(many[i] - expected) > 1e-4f * std::max(1.f, std::abs(expected)))
+                ++mismatches;
+        }
+        CHECK(mismatches == 0);
+    }
+
+    TEST_CASE("Fade points ramp between their values across buffers")
+    {
+        const auto wav = makeSineWav(48000, 4800);
+        constexpr Int BufferFrames = 256;
+        constexpr Int BufferCount = 16;
+
+        // Renders a looping voice, optionally with fade points
+        const auto render = [&wav](const Bool withFade) -> List<Float> {
+            return renderOffline({.samplerate = 48000, .bufferFrameSize = BufferFrames}, [&](AudioEngine &engine) {
+                const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()),
+                    Sound::Decoded | Sound::Looping);
+                const auto voice = engine.playSound(sound);
+                REQUIRE(voice);
+                if (withFade)
+                {
+                    voice->addFadePoint(3000, .5f);
+                    voice->addFadePoint(300, 1.f);
+                    voice->addFadePoint(1300, 0.f);
+                }
+            }, BufferCount);
+        };
+
+        const auto expectedGain = [](const Int frame) -> Float {
+            if (frame < 300) return 1.f;
+            if (frame < 1300) return 1.f - static_cast<Float>(frame - 300) / 1000.f;
+            if (frame < 3000) return .5f * static_cast<Float>(frame - 1300) / 1700.f;
+            return .5f;
+        };
+
+        const auto dry = render(False);
+        const auto faded = render(True);
+        REQUIRE(dry.size() == faded.size());
+
+        Int mismatches = 0;
+        for (Size i = 0; i < dry.size(); ++i)
+        {
+            if (std::abs(dry[i] * expectedGain(static_cast<Int>(i / 2)) - faded[i]) > 1e-5f)
+                ++mismatches;
+        }
+        CHECK(mismatches == 0);
+    }
+
+    TEST_CASE("Pitched voices play through their input at the pitch rate")
+    {
+        const auto wav = makeSineWav(48000, 4800);
+        constexpr Int BufferFrames = 256;
+        constexpr Int BufferCount = 8;
+
+        // Renders a looping voice at `pitch`
+        const auto render = [&wav](const Float pitch, const ResampleQuality quality) -> List<Float> {
+            return renderOffline({.samplerate = 48000, .bufferFrameSize = BufferFrames}, [&](AudioEngine &engine) {
+                const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()),
+                    Sound::Decoded | Sound::Looping);
+                const auto voice = engine.playSound(sound);
+                REQUIRE(voice);
+                voice->setPitch(pitch);
+                voice->setResampleQuality(quality);
+                CHECK(voice->getPitch() == pitch);
+            }, BufferCount);
+        };
+
+        const auto dry = render(1.f, ResampleQuality::Sinc);
+
+        SUBCASE("Linear interpolation lands on every other input frame an octave up")
+        {
+            const auto pitched = render(2.f, ResampleQuality::Linear);
+            Int mismatches = 0;
+            for (Size frame = 0; frame < pitched.size() / 4; ++frame)
+            {
+                if (pitched[frame * 2] != dry[frame * 4] || pitched[frame * 2 + 1] != dry[frame * 4 + 1])
+                    ++mismatches;
+            }
+            CHECK(mismatches == 0);
+        }
+
+        SUBCASE("Sinc interpolation passes through the input frames an octave down")
+        {
+            const auto pitched = render(.5f, ResampleQuality::Sinc);
+            Int mismatches = 0;
+            for (Size frame = 16; frame < pitched.size() / 2; frame += 2) // past the silent history
+            {
+                if (std::abs(pitched[frame * 2] - dry[frame]) > 1e-4f)
+                    ++mismatches;
+            }
+            CHECK(mismatches == 0);
+        }
+    }
+
+    TEST_CASE("Sources keep their channel count and are mixed into the output layout")
+    {
+        constexpr Int BufferFrames = 256;
+        constexpr Int BufferCount = 4;
+        const auto stereoWav = makeSineWav(48000, 4800);
+        const auto monoWav = makeSineWav(48000, 4800, 1);
+
+        // Renders one voice of `wav` into an output of `channels`, with its panner's right channel at `right`
+        const auto render = [](const List<Ubyte> &wav, const Sound::InitFlags flags, const Int channels,
+            const Float right) -> List<Float> {
+            return renderOffline({.samplerate = 48000, .bufferFrameSize = BufferFrames, .channels = channels},
+                [&](AudioEngine &engine) {
+                    REQUIRE(engine.getSpec().channels == channels);
+
+                    const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()), flags);
+                    const auto voice = engine.playSound(sound);
+                    REQUIRE(voice);
+                    voice->getPannerEffect()->right(right);
+                }, BufferCount);
+        };
+
+        for (const auto flags : {Sound::Decoded, Sound::Stream})
+        {
+            CAPTURE(flags);
+            const auto stereo = render(stereoWav, flags, 2, 1.f);
+
+            SUBCASE("Mono plays as a duplicated stereo channel")
+            {
+                CHECK(render(monoWav, flags, 2, 1.f) == stereo);
+            }
+
+            SUBCASE("Mono is panned while upmixing")
+            {
+                const auto expected = render(stereoWav, flags, 2, .3f);
+                const auto actual = render(monoWav, flags, 2, .3f);
+                REQUIRE(actual.size() == expected.size());
+
+                Int mismatches = 0;
+                for (Size i = 0; i < actual.size(); ++i)
+                {
+                    if (std::abs(actual[i] - expected[i]) > 1e-5f)
+                        ++mismatches;
+                }
+                CHECK(mismatches == 0);
+            }
+
+            SUBCASE("Stereo fills the front pair of 5.1")
+            {
+                constexpr Int Channels = 6;
+                const auto surround = render(stereoWav, flags, Channels, 1.f);
+                REQUIRE(surround.size() == stereo.size() / 2 * Channels);
+
+                Int mismatches = 0;
+                for (Size frame = 0; frame < stereo.size() / 2; ++frame)
+                {
+                    const auto samples = surround.data() + frame * Channels;
+                    if (samples[0] != stereo[frame * 2] || samples[1] != stereo[frame * 2 + 1])
+                        ++mismatches;
+                    for (Int c = 2; c < Channels; ++c)
+                    {
+                        if (samples[c] != 0)
+                            ++mismatches;
+                    }
+                }
+                CHECK(mismatches == 0);
+            }
+        }
+    }
+
+    TEST_CASE("Mono buses downmix their sources")
+    {
+        const auto wav = makeSineWav(48000, 4800);
+        const auto output = renderOffline({.samplerate = 48000, .bufferFrameSize = 128}, [&wav](AudioEngine &engine) {
+            const auto bus = engine.createBus(False, {}, 1);
+            REQUIRE(bus);
+            CHECK(bus->getChannels() == 1);
+            CHECK(engine.createBus(False, bus)->getChannels() == 1);
+
+            const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()), Sound::Decoded);
+            const auto voice = engine.playSound(sound, False, bus);
+            REQUIRE(voice);
+            CHECK(voice->getChannels() == 2);
+        }, 1);
+
+        // Both halves of the downmixed sine come back on each side of the output
+        Int mismatches = 0;
+        Bool isSilent = True;
+        for (Int frame = 0; frame < 128; ++frame)
+        {
+            if (output[frame * 2] != output[frame * 2 + 1])
+                ++mismatches;
+            if (output[frame * 2] != 0)
+                isSilent = False;
+        }
+        CHECK(mismatches == 0);
+        CHECK_FALSE(isSilent);
+    }
+
+    TEST_CASE("Voices unpaused partway through a buffer start on the unpause frame")
+    {
+        constexpr Int BufferFrames = 256, UnpauseFrame = 100;
+        const auto wav = makeSineWav(48000, 4800);
+
+        // Renders one voice, paused until `unpauseFrame` if it is above zero
+        const auto render = [&wav](const Int unpauseFrame) -> List<Float> {
+            return renderOffline({.samplerate = 48000, .bufferFrameSize = BufferFrames}, [&](AudioEngine &engine) {
+                const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()), Sound::Decoded);
+                const auto voice = engine.playSound(sound, unpauseFrame > 0);
+                REQUIRE(voice);
+                if (unpauseFrame > 0)
+                    REQUIRE(voice->unpauseAt(voice->getParentClock() + unpauseFrame));
+            }, 2);
+        };
+
+        const auto dry = render(0);
+        const auto delayed = render(UnpauseFrame);
+        REQUIRE(dry.size() == delayed.size());
+
+        Int mismatches = 0;
+        for (Size i = 0; i < delayed.size(); ++i)
+        {
+            const auto frame = static_cast<Int>(i / 2);
+            const auto expected = frame < UnpauseFrame ? 0 : dry[i - UnpauseFrame * 2];
+            if (delayed[i] != expected)
+                ++mismatches;
+        }
+        CHECK(mismatches == 0);
+    }
+
+    TEST_CASE("The profiler times callbacks, sources and effects")
+    {
+        const auto wav = makeSineWav(48000, 4800);
+
+        for (const auto mixerThreads : {0, 2})
+        {
+            CAPTURE(mixerThreads);
+            const auto device = new OfflineAudioDevice;
+            AudioEngine engine(device);
+            REQUIRE(engine.open({.samplerate = 48000, .bufferFrameSize = 256, .mixerThreads = mixerThreads}));
+
+            const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()),
+                Sound::Decoded | Sound::Looping);
+            const auto bus = engine.createBus(False);
+            const auto delay = bus->addEffect<DelayEffect>(2, 300, 0.4f, 0.3f);
+            const auto voice = engine.playSound(sound, False, bus);
+            REQUIRE(voice);
+
+            // Nothing is measured until enabled
+            device->render(256);
+            engine.update();
+            CHECK_FALSE(engine.isProfilerEnabled());
+            CHECK(engine.getProfilerStats().callbacks == 0);
+
+            engine.setProfilerEnabled(True);
+            CHECK(engine.isProfilerEnabled());
+            for (Int i = 0; i < AudioProfiler::WindowCallbacks + 8; ++i)
+            {
+                device->render(256);
+                if (i % 4 == 0)
+                    engine.update();
+            }
+            engine.update();
+
+            const auto stats = engine.getProfilerStats(16);
+            CHECK(stats.callbacks == AudioProfiler::WindowCallbacks);
+            CHECK(stats.deadlineMs == doctest::Approx(256.0 / 48.0));
+            CHECK(stats.averageMs > 0);
+            CHECK(stats.maxMs >= stats.averageMs);
+            CHECK(stats.averageLoad == doctest::Approx(stats.averageMs / stats.deadlineMs * 100.0));
+            CHECK(stats.droppedCallbacks == 0);
+
+            const auto find = [](const List<AudioProfileEntry> &entries, const void *object) {
+                return std::find_if(entries.begin(), entries.end(), [object](const AudioProfileEntry &entry) {
+                    return entry.object == object;
+                });
+            };
+
+            const auto voiceEntry = find(stats.sources, voice.get());
+            REQUIRE(voiceEntry != stats.sources.end());
+            CHECK(voiceEntry->kind == ProfileKind::Source);
+            CHECK(*voiceEntry->type == typeid(PCMSource));
+
+            const auto busEntry = find(stats.sources, bus.get());
+            REQUIRE(busEntry != stats.sources.end());
+            CHECK(busEntry->kind == ProfileKind::Bus);
+
+            const auto delayEntry = find(stats.effects, delay.get());
+            REQUIRE(delayEntry != stats.effects.end());
+            CHECK(delayEntry->kind == ProfileKind::Effect);
+            CHECK(delayEntry->averageMs > 0);
+            CHECK(delayEntry->maxMs >= delayEntry->averageMs);
+
+            if (mixerThreads == 0) // self times never overlap on a single thread
+            {
+                Double share = 0;
+                for (const auto &entry : stats.sources)
+                    share += entry.share;
+                for (const auto &entry : stats.effects)
+                    share += entry.share;
+                CHECK(share <= 1.0);
+            }
+
+            // Lists are sorted and trimmed to the requested count
+            const auto top = engine.getProfilerStats(1);
+            REQUIRE(top.effects.size() == 1);
+            CHECK(top.effects[0].averageMs == std::max_element(stats.effects.begin(), stats.effects.end(),
+                [](const AudioProfileEntry &a, const AudioProfileEntry &b) {
+                    return a.averageMs < b.averageMs;
+                })->averageMs);
+
+            engine.close();
+        }
+    }
+
+    TEST_CASE("Volume changes ramp across one block")
+    {
+        constexpr Int BufferFrames = 256;
+        const auto wav = makeSineWav(48000, 4800);
+
+
+        // Renders two buffers of a voice, changing its volume to `volume` in between
+        const auto render = [&wav](const Float volume) -> List<Float> {
+            return renderOffline({.samplerate = 48000, .bufferFrameSize = BufferFrames}, [&](AudioEngine &engine) {
+                const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()), Sound::Decoded);
+                const auto voice = engine.playSound(sound);
+                REQUIRE(voice);
+
+                return [voice, volume](const Int i) {
+                    if (i == 1)
+                        voice->setVolume(volume);
+                };
+            }, 2);
+        };
+
+        const auto dry = render(1.f);
+        const auto faded = render(0);
+        REQUIRE(dry.size() == faded.size());
+
+        // The first buffer is untouched, the second fades out linearly instead of cutting off
+        Int mismatches = 0;
+        for (Int i = 0; i < BufferFrames * 2; ++i)
+        {
+            if (faded[i] != dry[i])
+                ++mismatches;
+        }
+        for (Int frame = 0; frame < BufferFrames; ++frame)
+        {
+            const auto gain = 1.f - static_cast<Float>(frame) / BufferFrames;
+            for (Int c = 0; c < 2; ++c)
+            {
+                const auto i = (BufferFrames + frame) * 2 + c;
+                if (std::abs(faded[i] - dry[i] * gain) > 1e-5f)
+                    ++mismatches;
+            }
+        }
+        CHECK(mismatches == 0);
+        CHECK(std::abs(faded[BufferFrames * 2]) > 0);
+    }
+
+    TEST_CASE("Pan changes on mono voices ramp across one block")
+    {
+        constexpr Int BufferFrames = 256;
+        const auto wav = makeSineWav(48000, 4800, 1);
+
+
+        // Renders two buffers of a mono voice, moving its panner's right channel to `right` in between
+        const auto render = [&wav](const Float right, const Bool positioned) -> List<Float> {
+            return renderOffline({.samplerate = 48000, .bufferFrameSize = BufferFrames}, [&](AudioEngine &engine) {
+                const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()), Sound::Decoded);
+                const auto voice = engine.playSound(sound);
+                REQUIRE(voice);
+                if (positioned)
+                    REQUIRE(engine.setEmitter(voice, Emitter{}));
+                engine.update();
+
+                return [voice, right](const Int i) {
+                    if (i == 1)
+                        voice->getPannerEffect()->right(right);
+                };
+            }, 2);
+        };
+
+        for (const auto positioned : {False, True})
+        {
+            CAPTURE(positioned);
+            const auto dry = render(1.f, positioned);
+            const auto panned = render(0, positioned);
+            REQUIRE(dry.size() == panned.size());
+
+            // The right channel's share moves over to the left frame by frame, instead of at the block boundary
+            Int mismatches = 0;
+            Float gain = 1.f, largestStep = 0;
+            Int lastFrame = -1;
+            for (Int frame = 0; frame < BufferFrames; ++frame)
+            {
+                const auto shift = static_cast<Float>(frame) / BufferFrames;
+                const auto i = (BufferFrames + frame) * 2;
+                if (std::abs(panned[i] - dry[i] * (1.f + shift)) > 1e-5f ||
+                    std::abs(panned[i + 1] - dry[i + 1] * (1.f - shift)) > 1e-5f)
+                    ++mismatches;
+
+                // Gain step per frame of the right channel, measured where the signal is loud enough to divide by
+                if (std::abs(dry[i + 1]) > .05f)
+                {
+                    const auto nextGain = panned[i + 1] / dry[i + 1];
+                    const auto step = std::abs(nextGain - gain) / static_cast<Float>(frame - lastFrame);
+                    largestStep = std::max(largestStep, step);
+                    gain = nextGain;
+                    lastFrame = frame;
+                }
+            }
+            CHECK(mismatches == 0);
+            CHECK(largestStep < 1.5f / BufferFrames);
+            CHECK(std::equal(dry.begin(), dry.begin() + BufferFrames * 2, panned.begin()));
+        }
+    }
+
+    TEST_CASE("Analyzer taps meter loudness, peaks and the spectrum")
+    {
+        constexpr Int BufferFrames = 512, Buffers = 300;
+
+        // A sine at -23 dBFS in both channels reads -23 LUFS, per EBU Tech 3341. Its frequency is centered on a bin
+        // of the spectrum.
+        constexpr Double Amplitude = 0.0707945784, Frequency = 48000.0 / AnalyzerTaps::SpectrumSize * 43;
+        const auto wav = makeWav(48000, 48000 * 4, 2, [](const Int i) {
+            return std::round(std::sin(2.0 * 3.14159265358979323846 * Frequency * i / 48000.0) * Amplitude * 32768);
+        });
+
+        const auto device = new OfflineAudioDevice;
+        AudioEngine engine(device);
+        REQUIRE(engine.open({.samplerate = 48000, .bufferFrameSize = BufferFrames}));
+
+        const auto silent = engine.getAnalyzerReading(0);
+        REQUIRE(silent);
+        CHECK(silent->frames == 0);
+        CHECK(std::isinf(silent->momentaryLoudness));
+        CHECK(silent->spectrum == Null);
+        CHECK(engine.getAnalyzerReading(AnalyzerTaps::MaxTaps) == Null);
+
+        engine.getMasterBus()->setAnalyzerTap(0);
+        engine.setAnalyzerSpectrum(0, True);
+        CHECK(engine.getAnalyzerSpectrum(0));
+
+        const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()), Sound::Decoded);
+        REQUIRE(engine.playSound(sound));
+        for (Int i = 0; i < Buffers; ++i)
+        {
+            device->render(BufferFrames);
+            engine.update();
+        }
+
+        const auto reading = engine.getAnalyzerReading(0);
+        REQUIRE(reading);
+        CHECK(reading->frames == static_cast<Uint64>(BufferFrames * Buffers));
+        CHECK(reading->momentaryLoudness == doctest::Approx(-23.0).epsilon(.1 / 23));
+        CHECK(reading->shortTermLoudness == doctest::Approx(-23.0).epsilon(.1 / 23));
+        CHECK(reading->samplePeak == doctest::Approx(Amplitude).epsilon(1e-3));
+        CHECK(reading->truePeak >= reading->samplePeak);
+        CHECK(reading->truePeak < reading->samplePeak * 1.01f);
+
+        REQUIRE(reading->spectrum);
+        REQUIRE(reading->bins == AnalyzerTaps::SpectrumSize / 2 + 1);
+        const auto loudest = std::max_element(reading->spectrum, reading->spectrum + reading->bins);
+        CHECK(loudest - reading->spectrum == 43);
+        CHECK(*loudest == doctest::Approx(Amplitude).epsilon(1e-2));
+
+        // One source per tap: another can only take it over once the first lets go
+        const auto bus = engine.createBus(False);
+        REQUIRE(bus);
+        bus->setAnalyzerTap(0);
+        CHECK(getError().code == Error::LogicErr);
+        CHECK(bus->getAnalyzerTap() == -1);
+        clearError();
+
+        engine.getMasterBus()->setAnalyzerTap(-1);
+        bus->setAnalyzerTap(0);
+        CHECK(bus->getAnalyzerTap() == 0);
+
+        engine.close();
+    }
+}
@@ -0,0 +1,87 @@
+#include <doctest/doctest.h>
+
+#include <kaze/snd/AudioParam.h>
+#include <kaze/snd/effects/DelayEffect.h>
+#include <kaze/snd/effects/PanEffect.h>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+
+TEST_SUITE("snd/AudioParam")
+{
+    TEST_CASE("Values are clamped to the range, and rounded for whole-number types")
+    {
+        AudioParam gain("Gain", ParamType::Float, 2.f, 0, 1.f);
+        CHECK(gain.get() == 1.f);
+        gain.set(-1.f);
+        CHECK(gain.get() == 0);
+        gain.set(.25f);
+        CHECK(gain.get() == .25f);
+
+        AudioParam mode("Mode", ParamType::Enum, 1.4f, 0, 3.f);
+        CHECK(mode.getInt() == 1);
+        mode.set(2.6f);
+        CHECK(mode.getInt() == 3);
+        mode.set(10.f);
+        CHECK(mode.getInt() == 3);
+    }
+
+    TEST_CASE("Float parameters ramp from the last block's value to the latest target")
+    {
+        AudioParam gain("Gain", ParamType::Float, 1.f, 0, 1.f);
+
+        // Values set before the first block are not ramped into
+        gain.set(.5f);
+        auto ramp = gain.nextRamp();
+        CHECK(ramp.isSteady());
+        CHECK(ramp.end == .5f);
+
+        // Only the latest of several changes within a block is heard
+        gain.set(.1f);
+        gain.set(0);
+        ramp = gain.nextRamp();
+        CHECK(ramp.start == .5f);
+        CHECK(ramp.end == 0);
+        CHECK(gain.current() == 0);
+
+        ramp = gain.nextRamp();
+        CHECK(ramp.isSteady());
+
+        gain.reset(1.f);
+        gain.set(0);
+        CHECK(gain.nextRamp().isSteady());
+    }
+
+    TEST_CASE("Whole-number parameters jump")
+    {
+        AudioParam frames("Frames", ParamType::Int, 10.f, 0, 100.f);
+        CHECK(frames.nextRamp().end == 10.f);
+        frames.set(50.f);
+        const auto ramp = frames.nextRamp();
+        CHECK(ramp.isSteady());
+        CHECK(ramp.end == 50.f);
+    }
+
+    TEST_CASE("Effects expose their parameters by index")
+    {
+        PanEffect pan;
+        REQUIRE(pan.getParamCount() == PanEffect::ParamCount);
+        CHECK(StringView(pan.getParam(PanEffect::Left)->getName()) == "Left");
+        CHECK(pan.getParam(PanEffect::ParamCount) == nullptr);
+
+        CHECK(pan.setParam(PanEffect::Right, .25f));
+        CHECK(pan.right() == .25f);
+        pan.left(4.f);
+        CHECK(pan.left() == 1.f);
+
+        DelayEffect delay;
+        REQUIRE(delay.init_(1000, .5f, .2f, 4000));
+        CHECK(delay.getParam(DelayEffect::DelayTime)->getType() == ParamType::Int);
+        delay.delayTime(3000);
+        CHECK(delay.delayTime() == 3000);
+        delay.delayTime(10000);
+        CHECK(delay.delayTime() == 4000);
+        delay.delayTime(1);
+        CHECK(delay.delayTime() == DelayEffect::MinDelayTime);
+    }
+}
@@ -0,0 +1,53 @@
+#include <doctest/doctest.h>
+
+#include <kaze/snd/MixerThreadPool.h>
+
+#include <atomic>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+
+TEST_SUITE("snd/MixerThreadPool")
+{
+    TEST_CASE("Back-to-back batches of growing size run each index exactly once")
+    {
+        constexpr Int MaxCount = 64;
+        constexpr Int Rounds = 2000;
+
+        struct Batch {
+            std::atomic<Int> runs[MaxCount]{};
+            Int count{};
+        };
+
+        MixerThreadPool pool;
+        pool.start(3);
+        REQUIRE(pool.getThreadCount() == 3);
+
+        // Two batches, alternated so that a task run late for the last batch lands in the other's counts
+        Batch batches[2];
+        Int failures = 0;
+        for (Int round = 0; round < Rounds; ++round)
+        {
+            auto &batch = batches[round % 2];
+            batch.count = 2 + round % (MaxCount - 1);
+            for (auto &runs : batch.runs)
+                runs.store(0, std::memory_order_relaxed);
+
+            pool.run(batch.count, [](void *userdata, const Int index) {
+                auto &batch = *static_cast<Batch *>(userdata);
+                if (index < batch.count)
+                    batch.runs[index].fetch_add(1, std::memory_order_relaxed);
+            }, &batch);
+
+            for (Int i = 0; i < MaxCount; ++i)
+            {
+                if (batch.runs[i].load(std::memory_order_relaxed) != (i < batch.count ? 1 : 0))
+                    ++failures;
+            }
+        }
+
+        pool.stop();
+        CHECK(failures == 0);
+        CHECK(pool.getThreadCount() == 0);
+    }
+}
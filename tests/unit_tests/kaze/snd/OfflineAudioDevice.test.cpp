@@ -0,0 +1,253 @@
+#include <doctest/doctest.h>
+
+#include <kaze/snd/AudioEngine.h>
+#include <kaze/snd/backend/offline/OfflineAudioDevice.h>
+#include <kaze/snd/sources/AudioBus.h>
+
+#include <kaze/core/io/io.h>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+
+namespace {
+    /// Fills each buffer with the index of the sample since the device opened
+    auto rampCallback(void *userdata, AlignedList<Uint8, 16> *buffer) -> void
+    {
+        auto &counter = *static_cast<Float *>(userdata);
+        const auto samples = reinterpret_cast<Float *>(buffer->data());
+        for (Size i = 0, count = buffer->size() / sizeof(Float); i < count; ++i)
+            samples[i] = counter++;
+    }
+
+    /// `rampCallback` rendering straight into the device's memory
+    auto rampRenderCallback(void *userdata, Uint8 *output, const Int64 bytes) -> void
+    {
+        auto &counter = *static_cast<Float *>(userdata);
+        const auto samples = reinterpret_cast<Float *>(output);
+        for (Int64 i = 0, count = bytes / static_cast<Int64>(sizeof(Float)); i < count; ++i)
+            samples[i] = counter++;
+    }
+
+    /// Outputs silence, taking longer than the buffer lasts while `*userdata` is set
+    auto slowCallback(void *userdata, AlignedList<Uint8, 16> *buffer) -> void
+    {
+        if (*static_cast<const Bool *>(userdata))
+            std::this_thread::sleep_for(std::chrono::milliseconds(12));
+        std::memset(buffer->data(), 0, buffer->size());
+    }
+}
+
+TEST_SUITE("OfflineAudioDevice")
+{
+    TEST_CASE("Manual clock renders whole buffers on demand")
+    {
+        Float counter = 0;
+        OfflineAudioDevice device;
+        REQUIRE(device.open({.frequency = 0, .frameBufferSize = 128, .audioCallback = rampCallback,
+            .userdata = &counter}));
+        CHECK(device.getSpec().freq == 48000);
+        CHECK(device.getBufferSize() == 128 * 2 * sizeof(Float));
+
+        // Nothing renders until resumed
+        CHECK(device.render(128) == 0);
+
+        device.resume();
+        CHECK(device.render(1000) == 1024);
+        CHECK(device.render(128) == 128);
+        CHECK(counter == 1152 * 2);
+
+        const auto stats = device.getStats();
+        CHECK(stats.frames == 1152);
+        CHECK(stats.callbacks == 9);
+        CHECK(stats.worstNs <= stats.renderNs);
+        CHECK(stats.getFramesPerSecond() > 0);
+    }
+
+    TEST_CASE("Render callbacks write straight into the device buffer")
+    {
+        Float counter = 0;
+        OfflineAudioDevice device;
+        REQUIRE(device.open({.frequency = 0, .frameBufferSize = 64, .audioCallback = Null, .userdata = &counter,
+            .renderCallback = rampRenderCallback}) == False); // a buffer callback is still required as fallback
+        REQUIRE(device.open({.frequency = 0, .frameBufferSize = 64, .audioCallback = rampCallback,
+            .userdata = &counter, .renderCallback = rampRenderCallback}));
+
+        const auto data = device.getBuffer().data();
+        CHECK(reinterpret_cast<std::uintptr_t>(data) % AudioRenderAlignment == 0);
+
+        device.resume();
+        CHECK(device.render(128) == 128);
+        CHECK(counter == 256);
+
+        // The buffer was filled in place rather than traded for another
+        CHECK(device.getBuffer().data() == data);
+        const auto samples = reinterpret_cast<const Float *>(device.getBuffer().data());
+        CHECK(samples[0] == 128);
+        CHECK(samples[127] == 255);
+    }
+
+    TEST_CASE("Latency monitor counts near misses and underruns and adapts the period")
+    {
+        AudioLatencyMonitor monitor;
+        monitor.prepare(256, 128, 1024, 48000, True);
+        CHECK(monitor.isAdaptive());
+        CHECK(monitor.getPeriodFrames() == 256);
+
+        // 256 frames last 5333333 ns at 48 kHz
+        monitor.record(1'000'000, 256, False);
+        CHECK( !monitor.hasPendingPeriod() );
+        monitor.record(4'500'000, 256, False); // 84%: a near miss grows the period
+        CHECK(monitor.hasPendingPeriod());
+        CHECK(monitor.getPeriodFrames() == 512);
+
+        // Nothing changes until the device has applied the last period
+        monitor.record(20'000'000, 256, True);
+        CHECK(monitor.getPeriodFrames() == 512);
+        monitor.applyPeriod(512);
+        monitor.record(20'000'000, 512, True);
+        monitor.applyPeriod(monitor.getPeriodFrames());
+        monitor.record(30'000'000, 1024, True);
+        CHECK( !monitor.hasPendingPeriod() ); // already at the upper bound
+
+        // Light load halves the period once it has lasted `StableSeconds`
+        for (Int i = 0; i < 48000 * AudioLatencyMonitor::StableSeconds / 1024; ++i)
+            monitor.record(1'000'000, 1024, False);
+        CHECK( !monitor.hasPendingPeriod() );
+        monitor.record(1'000'000, 1024, False);
+        CHECK(monitor.getPeriodFrames() == 512);
+
+        const auto histogram = monitor.getHistogram();
+        CHECK(histogram.callbacks == 240);
+        CHECK(histogram.nearMisses == 1);
+        CHECK(histogram.underruns == 3);
+        CHECK(histogram.load[0] == 235);
+        CHECK(histogram.load[1] == 1);
+        CHECK(histogram.load[8] == 1);
+        CHECK(histogram.load[AudioLatencyHistogram::Buckets - 1] == 3);
+        CHECK(histogram.worstMs == doctest::Approx(30.0));
+        CHECK(histogram.periodChanges == 3);
+        CHECK(histogram.latencyMs == doctest::Approx(512 / 48.0));
+
+        monitor.reset();
+        CHECK(monitor.getHistogram().callbacks == 0);
+        CHECK(monitor.getUnderrunCount() == 3);
+    }
+
+    TEST_CASE("Adaptive period grows after an overrun without reallocating the buffer")
+    {
+        Bool slow = False;
+        OfflineAudioDevice device;
+        REQUIRE(device.open({.frequency = 48000, .frameBufferSize = 256, .audioCallback = slowCallback,
+            .userdata = &slow, .minFrameBufferSize = 128, .maxFrameBufferSize = 1024}));
+        CHECK(device.getBufferSize() == 256 * 2 * sizeof(Float));
+        CHECK(device.getMaxBufferSize() == 1024 * 2 * sizeof(Float));
+        const auto data = device.getBuffer().data();
+
+        device.resume();
+        CHECK(device.render(256) == 256);
+
+        // 12 ms is more than a 256 frame buffer lasts, which the device counts as an underrun
+        slow = True;
+        CHECK(device.render(256) == 256);
+        slow = False;
+        CHECK(device.render(512) == 512);
+        CHECK(device.getBufferSize() == 512 * 2 * sizeof(Float));
+        CHECK(device.getBuffer().data() == data);
+
+        const auto histogram = device.getLatencyMonitor()->getHistogram();
+        CHECK(histogram.callbacks == 3);
+        CHECK(histogram.underruns == 1);
+        CHECK(histogram.periodFrames == 512);
+        CHECK(histogram.minPeriodFrames == 128);
+        CHECK(histogram.maxPeriodFrames == 1024);
+    }
+
+    TEST_CASE("Engine reports the device's latency histogram")
+    {
+        const auto device = new OfflineAudioDevice;
+        AudioEngine engine(device);
+        REQUIRE(engine.open({.samplerate = 48000, .bufferFrameSize = 2048, .minBufferFrameSize = 1024,
+            .maxBufferFrameSize = 4096}));
+        CHECK(engine.getBufferSize() == 2048 * 2 * sizeof(Float));
+
+        // An empty mix takes nowhere near the 43 ms a buffer lasts
+        device->render(2048 * 4);
+        const auto histogram = engine.getLatencyHistogram();
+        CHECK(histogram.callbacks == 4);
+        CHECK(histogram.underruns == 0);
+        CHECK(histogram.periodFrames == 2048);
+        CHECK(histogram.maxPeriodFrames == 4096);
+        CHECK(histogram.latencyMs == doctest::Approx(2048 / 48.0));
+
+        engine.resetLatencyHistogram();
+        CHECK(engine.getLatencyHistogram().callbacks == 0);
+        engine.close();
+    }
+
+    TEST_CASE("Recording writes a float .wav file")
+    {
+        const auto path = (std::filesystem::temp_directory_path() / "kaze_offline_device_test.wav").string();
+
+        Float counter = 0;
+        OfflineAudioDevice device;
+        REQUIRE(device.open({.frequency = 44100, .frameBufferSize = 64, .audioCallback = rampCallback,
+            .userdata = &counter}));
+        device.resume();
+        device.render(64); // not recorded
+
+        REQUIRE(device.startRecording(path));
+        CHECK(device.isRecording());
+        device.render(640);
+        device.close();
+        CHECK( !device.isRecording() );
+
+        Ubyte *data;
+        Size size;
+        REQUIRE(file::load(path, &data, &size));
+        std::filesystem::remove(path);
+
+        constexpr Size DataSize = 640 * 2 * sizeof(Float);
+        REQUIRE(size == 44 + DataSize);
+        CHECK(std::memcmp(data, "RIFF", 4) == 0);
+        CHECK(std::memcmp(data + 8, "WAVEfmt ", 8) == 0);
+        CHECK(data[20] == 3); // IEEE float
+        CHECK(data[22] == 2); // channels
+        CHECK((data[24] | data[25] << 8) == 44100);
+        CHECK(data[34] == 32); // bits per sample
+        CHECK(std::memcmp(data + 36, "data", 4) == 0);
+        CHECK((data[40] | data[41] << 8 | data[42] << 16) == DataSize);
+
+        // Samples follow on from the buffer rendered before recording started
+        Float first, last;
+        std::memcpy(&first, data + 44, sizeof(Float));
+        std::memcpy(&last, data + size - sizeof(Float), sizeof(Float));
+        CHECK(first == 128);
+        CHECK(last == 128 + 1280 - 1);
+        memory::free(data);
+    }
+
+    TEST_CASE("Null device runs the engine on a simulated realtime clock")
+    {
+        AudioEngine engine(AudioDevice::create(AudioDeviceType::Null));
+        REQUIRE(engine.open({.samplerate = 48000, .bufferFrameSize = 256}));
+
+        const auto bus = engine.createBus(False);
+        REQUIRE(bus);
+
+        // 20 buffers take about 107 ms in realtime
+        const auto start = std::chrono::steady_clock::now();
+        while (bus->getParentClock() < 20 * 256)
+        {
+            engine.update();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        CHECK(std::chrono::steady_clock::now() - start > std::chrono::milliseconds(80));
+
+        engine.close();
+    }
+}
@@ -0,0 +1,192 @@
+#include <doctest/doctest.h>
+
+#include <kaze/snd/AudioEngine.h>
+#include <kaze/snd/SoundBank.h>
+#include <kaze/snd/SoundBankBuilder.h>
+#include <kaze/snd/backend/offline/OfflineAudioDevice.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+
+namespace {
+    struct WavMarker {
+        Uint frame;
+        const char *label;
+    };
+
+    /// \returns a 16-bit .wav file holding a sine tone, with a cue point and label for each marker
+    auto makeWav(const Int frequency, const Int frames, const Int channels, const List<WavMarker> &markers = {})
+        -> List<Ubyte>
+    {
+        List<Ubyte> body;
+        const auto write = [&body](const Uint value, const Int bytes) {
+            for (Int i = 0; i < bytes; ++i)
+                body.emplace_back(static_cast<Ubyte>(value >> (i * 8)));
+        };
+        const auto writeTag = [&body](const char *tag) {
+            body.insert(body.end(), tag, tag + 4);
+        };
+
+        writeTag("WAVE");
+        writeTag("fmt "); write(16, 4); write(1, 2); write(channels, 2);
+        write(frequency, 4); write(frequency * channels * 2, 4); write(channels * 2, 2); write(16, 2);
+
+        writeTag("data"); write(static_cast<Uint>(frames * channels * 2), 4);
+        for (Int i = 0; i < frames; ++i)
+        {
+            const auto sample = static_cast<Int16>(std::sin(i * 0.05) * 8000);
+            for (Int c = 0; c < channels; ++c)
+                write(static_cast<Uint16>(sample), 2);
+        }
+
+        if ( !markers.empty() )
+        {
+            // Cue offsets are in bytes of sample data
+            writeTag("cue "); write(4 + 24 * static_cast<Uint>(markers.size()), 4);
+            write(static_cast<Uint>(markers.size()), 4);
+            for (Uint id = 0; id < markers.size(); ++id)
+            {
+                write(id, 4); write(0, 4); writeTag("data"); write(0, 4); write(0, 4);
+                write(markers[id].frame * channels * 2, 4);
+            }
+
+            List<Ubyte> labels;
+            for (Uint id = 0; id < markers.size(); ++id)
+            {
+                const auto length = static_cast<Uint>(std::strlen(markers[id].label)) + 1;
+                const auto padded = length + (length & 1);
+                labels.insert(labels.end(), {'l', 'a', 'b', 'l'});
+                for (Int i = 0; i < 4; ++i) labels.emplace_back(static_cast<Ubyte>((4 + length) >> (i * 8)));
+                for (Int i = 0; i < 4; ++i) labels.emplace_back(static_cast<Ubyte>(id >> (i * 8)));
+                labels.insert(labels.end(), markers[id].label, markers[id].label + length);
+                labels.resize(labels.size() + padded - length, 0);
+            }
+
+            writeTag("LIST"); write(4 + static_cast<Uint>(labels.size()), 4); writeTag("adtl");
+            body.insert(body.end(), labels.begin(), labels.end());
+        }
+
+        List<Ubyte> wav = {'R', 'I', 'F', 'F'};
+        for (Int i = 0; i < 4; ++i) wav.emplace_back(static_cast<Ubyte>(body.size() >> (i * 8)));
+        wav.insert(wav.end(), body.begin(), body.end());
+        return wav;
+    }
+}
+
+TEST_SUITE("SoundBank")
+{
+    TEST_CASE("Builder packs sounds that the bank finds by name")
+    {
+        const auto click = makeWav(44100, 441, 1, {{300, "hit"}, {100, "start"}});
+        const auto music = makeWav(48000, 4800, 2);
+
+        SoundBankBuilder builder;
+        REQUIRE(builder.add("ui/click", MemView<void>(click.data(), click.size())));
+        REQUIRE(builder.add("music", MemView<void>(music.data(), music.size())));
+        CHECK( !builder.add("music", MemView<void>(music.data(), music.size())) ); // names are unique
+        CHECK( !builder.add("noise", MemView<void>(music.data(), 12)) );           // data must decode
+        CHECK(builder.getCount() == 2);
+
+        List<Ubyte> data;
+        REQUIRE(builder.build(&data));
+
+        SoundBank bank;
+        REQUIRE(bank.openConstMem(MemView<void>(data.data(), data.size())));
+        CHECK(bank.getEntryCount() == 2);
+        CHECK(bank.find("missing") == Null);
+
+        const auto entry = bank.find("ui/click");
+        REQUIRE(entry);
+        CHECK(bank.getName(*entry) == "ui/click");
+        CHECK(entry->codec == SoundBankCodec::Wav);
+        CHECK(entry->frameLength == 441);
+        CHECK(entry->payloadOffset % SoundBankAlignment == 0);
+
+        const auto spec = bank.getSpec(*entry);
+        CHECK(spec.freq == 44100);
+        CHECK(spec.channels == 1);
+        CHECK(spec.format.bits() == 16);
+        CHECK( !spec.format.isFloat() );
+
+        // File data is stored as-is
+        const auto payload = bank.getPayload(*entry);
+        REQUIRE(payload.size() == click.size());
+        CHECK(std::memcmp(payload.data(), click.data(), click.size()) == 0);
+
+        // Markers come back sorted by position, at the native rate
+        List<AudioMarker> markers;
+        REQUIRE(bank.getMarkers(*entry, &markers));
+        REQUIRE(markers.size() == 2);
+        CHECK(markers[0].label == "start");
+        CHECK(markers[0].position == 100);
+        CHECK(markers[1].label == "hit");
+        CHECK(markers[1].position == 300);
+
+        const auto musicEntry = bank.find("music");
+        REQUIRE(musicEntry);
+        CHECK(musicEntry->markerCount == 0);
+        CHECK(bank.getSpec(*musicEntry).channels == 2);
+
+        // Damaged banks are refused
+        SoundBank damaged;
+        CHECK( !damaged.openConstMem(MemView<void>(data.data(), data.size() - 1)) );
+        data[0] = 'X';
+        CHECK( !damaged.openConstMem(MemView<void>(data.data(), data.size())) );
+        CHECK( !damaged.isOpen() );
+    }
+
+    TEST_CASE("Sounds open from a mapped bank without copying")
+    {
+        const auto path = (std::filesystem::temp_directory_path() / "kaze_sound_bank_test.ksb").string();
+        const auto click = makeWav(44100, 441, 1, {{441, "end"}});
+        const auto music = makeWav(48000, 4800, 2);
+
+        SoundBankBuilder builder;
+        REQUIRE(builder.add("ui/click", MemView<void>(click.data(), click.size())));
+        REQUIRE(builder.add("music", MemView<void>(music.data(), music.size())));
+        REQUIRE(builder.write(path));
+
+        SoundBank bank;
+        REQUIRE(bank.openFile(path));
+        CHECK(bank.isMapped());
+
+        const auto device = new OfflineAudioDevice;
+        AudioEngine engine(device);
+        REQUIRE(engine.open({.samplerate = 48000, .bufferFrameSize = 256}));
+
+        const auto clickSound = engine.createSound(bank, "ui/click", Sound::OneShot);
+        REQUIRE(clickSound);
+        CHECK( !engine.createSound(bank, "missing", Sound::None) );
+
+        // The sound reads the bank's memory, with its markers converted to the engine's rate
+        const auto payload = bank.getPayload(*bank.find("ui/click"));
+        CHECK(clickSound->getMemoryUsage().fileBytes == payload.size());
+        REQUIRE(clickSound->getMarkerCount() == 1);
+        CHECK(clickSound->getMarker(0).label == "end");
+        CHECK(clickSound->getMarker(0).position == 480);
+
+        const auto musicSound = engine.createSound(bank, "music", Sound::Decoded);
+        REQUIRE(musicSound);
+        REQUIRE(engine.playSound(musicSound));
+        REQUIRE(engine.playSound(clickSound));
+
+        device->render(256);
+        const auto samples = reinterpret_cast<const Float *>(device->getBuffer().data());
+        Float peak = 0;
+        for (Int i = 0; i < 256 * 2; ++i)
+            peak = std::max(peak, std::abs(samples[i]));
+        CHECK(peak > 0.1f);
+
+        engine.releaseSound(clickSound);
+        engine.releaseSound(musicSound);
+        engine.close();
+
+        bank.close();
+        std::filesystem::remove(path);
+    }
+}
@@ -0,0 +1,85 @@
+#include <doctest/doctest.h>
+
+#include <kaze/snd/AudioEngine.h>
+#include <kaze/snd/Spatializer.h>
+#include <kaze/snd/sources/PCMSource.h>
+
+#include <testing.h>
+
+#include <utility>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+using namespace testing;
+
+TEST_SUITE("snd/Spatializer")
+{
+    TEST_CASE("Emitters are panned and attenuated around the listener")
+    {
+        constexpr Int BufferFrames = 256, Buffers = 8;
+        const auto wav = makeSineWav(48000, 48000, 1);
+
+        // Energy of each output channel for a mono voice positioned by `emitter`, or unpositioned if null
+        const auto render = [&wav](const Emitter *emitter, const Listener &listener) -> std::pair<Double, Double> {
+            const auto output = renderOffline({.samplerate = 48000, .bufferFrameSize = BufferFrames},
+                [&](AudioEngine &engine) {
+                    const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()), Sound::Decoded);
+                    const auto voice = engine.playSound(sound);
+                    REQUIRE(voice);
+
+                    engine.setListener(listener);
+                    if (emitter)
+                        REQUIRE(engine.setEmitter(voice, *emitter));
+                    engine.update();
+                }, Buffers);
+
+            Double left = 0, right = 0;
+            for (Size i = 0; i < output.size(); i += 2)
+            {
+                left += static_cast<Double>(output[i]) * output[i];
+                right += static_cast<Double>(output[i + 1]) * output[i + 1];
+            }
+            return {left, right};
+        };
+
+        const auto [dryLeft, dryRight] = render(Null, {});
+        REQUIRE(dryLeft > 0);
+
+        SUBCASE("Emitters to the listener's right play on the right")
+        {
+            const Emitter emitter{.position = {10.f, 0}};
+            const auto [left, right] = render(&emitter, {});
+            CHECK(left == 0);
+            CHECK(right > 0);
+
+            // Turned half around, the listener hears it on the left
+            const auto [turnedLeft, turnedRight] = render(&emitter, {.rotation = 3.14159265f});
+            CHECK(turnedLeft == doctest::Approx(right).epsilon(1e-4));
+            CHECK(turnedRight < right * 1e-6);
+        }
+
+        SUBCASE("Emitters at the listener play centered at constant power")
+        {
+            const Emitter emitter{};
+            const auto [left, right] = render(&emitter, {});
+            CHECK(left == doctest::Approx(dryLeft * .5).epsilon(1e-4));
+            CHECK(right == doctest::Approx(left));
+        }
+
+        SUBCASE("Distance attenuates along the emitter's curve")
+        {
+            const auto energyAt = [&render](const Float distance, const AttenuationCurve curve) {
+                const Emitter emitter{.position = {0, distance}, .maxDistance = 20.f, .curve = curve};
+                const auto [left, right] = render(&emitter, {});
+                return left + right;
+            };
+
+            // Inverse: 1 / d; inverse square: 1 / d^2; linear: silent at the maximum distance
+            const auto close = energyAt(2.f, AttenuationCurve::Inverse);
+            CHECK(close / energyAt(10.f, AttenuationCurve::Inverse) == doctest::Approx(25.0).epsilon(1e-3));
+            CHECK(energyAt(2.f, AttenuationCurve::InverseSquare) / close == doctest::Approx(.25).epsilon(1e-3));
+            CHECK(energyAt(20.f, AttenuationCurve::Linear) == 0);
+            CHECK(energyAt(10.f, AttenuationCurve::None) == doctest::Approx(dryLeft));
+        }
+    }
+}
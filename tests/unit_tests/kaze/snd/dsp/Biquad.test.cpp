@@ -0,0 +1,87 @@
+#include <doctest/doctest.h>
+
+#include <kaze/snd/dsp/Biquad.h>
+
+#include <cmath>
+#include <complex>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+
+namespace {
+    constexpr Int SampleRate = 48000;
+
+    /// \returns the magnitude response of `coefs` in dB at `frequency`
+    auto getResponseDb(const dsp::BiquadCoefs &coefs, const Double frequency) -> Double
+    {
+        const auto w = 2.0 * 3.14159265358979323846 * frequency / SampleRate;
+        const auto z1 = std::polar(1.0, -w), z2 = std::polar(1.0, -2.0 * w);
+        const Double b0 = coefs.b0, b1 = coefs.b1, b2 = coefs.b2, a1 = coefs.a1, a2 = coefs.a2;
+        const auto response = (b0 + b1 * z1 + b2 * z2) / (1.0 + a1 * z1 + a2 * z2);
+        return 20.0 * std::log10(std::abs(response));
+    }
+}
+
+TEST_SUITE("snd/dsp/Biquad")
+{
+    TEST_CASE("Designs have the cookbook responses")
+    {
+        const auto lowPass = dsp::makeBiquad({FilterType::LowPass, 1000.f, 0.7071f, 0}, SampleRate);
+        CHECK(std::abs(getResponseDb(lowPass, 10)) < 0.01);
+        CHECK(getResponseDb(lowPass, 1000) == doctest::Approx(-3.01).epsilon(0.01));
+        CHECK(getResponseDb(lowPass, 8000) < -30);
+
+        const auto highPass = dsp::makeBiquad({FilterType::HighPass, 1000.f, 0.7071f, 0}, SampleRate);
+        CHECK(getResponseDb(highPass, 125) < -30);
+        CHECK(std::abs(getResponseDb(highPass, 16000)) < 0.05);
+
+        const auto peak = dsp::makeBiquad({FilterType::Peaking, 2000.f, 1.f, 6.f}, SampleRate);
+        CHECK(getResponseDb(peak, 2000) == doctest::Approx(6).epsilon(0.001));
+        CHECK(std::abs(getResponseDb(peak, 20)) < 0.01);
+
+        const auto shelf = dsp::makeBiquad({FilterType::LowShelf, 200.f, 0.7071f, -12.f}, SampleRate);
+        CHECK(getResponseDb(shelf, 10) == doctest::Approx(-12).epsilon(0.01));
+        CHECK(std::abs(getResponseDb(shelf, 10000)) < 0.05);
+    }
+
+    TEST_CASE("Cascades glide between designs and settle to exact silence")
+    {
+        constexpr Int64 Frames = 512;
+        dsp::BiquadCascade cascade;
+        cascade.prepare(2, 2);
+
+        List<Float> samples(Frames * 2, 0);
+        samples[0] = samples[1] = 1.f; // impulse
+
+        const dsp::BiquadDesign from[] = {
+            {FilterType::LowPass, 200.f, 4.f, 0},
+            {FilterType::LowPass, 200.f, 4.f, 0},
+        };
+        const dsp::BiquadDesign to[] = {
+            {FilterType::LowPass, 2000.f, 4.f, 0},
+            {FilterType::LowPass, 2000.f, 4.f, 0},
+        };
+
+        cascade.process(samples.data(), Frames, from, to, 2, SampleRate);
+        for (const auto sample : samples)
+            REQUIRE(std::isfinite(sample));
+        CHECK(samples[Frames * 2 - 2] == samples[Frames * 2 - 1]);
+
+        // A resonant tail decays on silence, and its state is flushed instead of lingering in denormals
+        Bool isSilent = False;
+        for (Int block = 0; block < 400 && !isSilent; ++block)
+        {
+            std::fill(samples.begin(), samples.end(), 0.f);
+            cascade.process(samples.data(), Frames, to, to, 2, SampleRate);
+
+            isSilent = True;
+            for (const auto sample : samples)
+            {
+                REQUIRE(std::fpclassify(sample) != FP_SUBNORMAL);
+                if (sample != 0)
+                    isSilent = False;
+            }
+        }
+        CHECK(isSilent);
+    }
+}
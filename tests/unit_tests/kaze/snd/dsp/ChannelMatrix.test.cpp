@@ -0,0 +1,59 @@
+#include <doctest/doctest.h>
+
+#include <kaze/snd/dsp/ChannelMatrix.h>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+
+TEST_SUITE("snd/dsp/ChannelMatrix")
+{
+    TEST_CASE("Mono and stereo convert between each other")
+    {
+        Float matrix[2];
+        REQUIRE(dsp::makeChannelMatrix(1, 2, matrix));
+        CHECK(matrix[0] == 1.f);
+        CHECK(matrix[1] == 1.f);
+
+        REQUIRE(dsp::makeChannelMatrix(2, 1, matrix));
+        CHECK(matrix[0] == .5f);
+        CHECK(matrix[1] == .5f);
+    }
+
+    TEST_CASE("Matching layouts pass through")
+    {
+        for (Int channels = 1; channels <= dsp::MaxChannels; ++channels)
+        {
+            CAPTURE(channels);
+            Float matrix[dsp::MaxChannels * dsp::MaxChannels];
+            REQUIRE(dsp::makeChannelMatrix(channels, channels, matrix));
+            for (Int out = 0; out < channels; ++out)
+            {
+                for (Int in = 0; in < channels; ++in)
+                    CHECK(matrix[out * channels + in] == (in == out ? 1.f : 0.f));
+            }
+        }
+    }
+
+    TEST_CASE("5.1 folds down to stereo")
+    {
+        Float matrix[2 * 6];
+        REQUIRE(dsp::makeChannelMatrix(6, 2, matrix));
+
+        // FL FR C LFE BL BR
+        const Float left[] = {1.f, 0, .70710678f, 0, .70710678f, 0};
+        const Float right[] = {0, 1.f, .70710678f, 0, 0, .70710678f};
+        for (Int in = 0; in < 6; ++in)
+        {
+            CAPTURE(in);
+            CHECK(matrix[in] == doctest::Approx(left[in]));
+            CHECK(matrix[6 + in] == doctest::Approx(right[in]));
+        }
+    }
+
+    TEST_CASE("Unsupported channel counts are rejected")
+    {
+        Float matrix[1];
+        CHECK_FALSE(dsp::makeChannelMatrix(0, 2, matrix));
+        CHECK_FALSE(dsp::makeChannelMatrix(2, dsp::MaxChannels + 1, matrix));
+    }
+}
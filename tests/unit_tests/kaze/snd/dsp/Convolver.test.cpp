@@ -0,0 +1,188 @@
+#include <doctest/doctest.h>
+
+#include <kaze/snd/dsp/Convolver.h>
+#include <kaze/snd/dsp/Fft.h>
+
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <random>
+#include <thread>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+
+namespace {
+    auto makeNoise(const Int64 count, const Uint seed) -> List<Float>
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<Float> dist(-1.f, 1.f);
+        List<Float> samples(count);
+        for (auto &sample : samples)
+            sample = dist(rng);
+        return samples;
+    }
+
+    /// Convolve interleaved stereo frames with a stereo response sample by sample, delayed by a block
+    auto convolveDirect(const List<Float> &input, const List<Float> &ir, const Int64 delay) -> List<Float>
+    {
+        const auto frames = static_cast<Int64>(input.size() / 2), irFrames = static_cast<Int64>(ir.size() / 2);
+        List<Float> output(input.size());
+        for (Int64 n = delay; n < frames; ++n)
+        {
+            for (Int c = 0; c < 2; ++c)
+            {
+                Double sum = 0;
+                for (Int64 k = 0; k < irFrames && k <= n - delay; ++k)
+                    sum += static_cast<Double>(ir[k * 2 + c]) * input[(n - delay - k) * 2 + c];
+                output[n * 2 + c] = static_cast<Float>(sum);
+            }
+        }
+
+        return output;
+    }
+}
+
+TEST_SUITE("snd/dsp/Convolver")
+{
+    TEST_CASE("Forward transform matches the DFT and inverts back to the signal")
+    {
+        for (const Int64 size : {8, 16, 64, 512})
+        {
+            CAPTURE(size);
+            dsp::Fft fft;
+            fft.prepare(size);
+            REQUIRE(fft.bins() == size / 2 + 1);
+
+            const auto signal = makeNoise(size, 1);
+            List<Float> re(fft.bins()), im(fft.bins());
+            fft.forward(signal.data(), re.data(), im.data());
+
+            for (Int64 k = 0; k < fft.bins(); ++k)
+            {
+                std::complex<Double> expected{};
+                for (Int64 n = 0; n < size; ++n)
+                    expected += std::polar<Double>(signal[n], -2.0 * 3.14159265358979323846 * k * n / size);
+                CHECK(re[k] == doctest::Approx(expected.real()).epsilon(1e-4).scale(size));
+                CHECK(im[k] == doctest::Approx(expected.imag()).epsilon(1e-4).scale(size));
+            }
+
+            List<Float> output(size);
+            fft.inverse(re.data(), im.data(), output.data());
+            for (Int64 n = 0; n < size; ++n)
+                CHECK(output[n] / static_cast<Float>(size) == doctest::Approx(signal[n]).epsilon(1e-5).scale(1));
+        }
+    }
+
+    TEST_CASE("Partitioned convolution matches direct convolution one block late")
+    {
+        // Long enough for tail partitions, and an odd length so the last partition is partly empty
+        constexpr Int64 IrFrames = dsp::Convolver::BlockFrames * 9 + 37;
+        constexpr Int64 Frames = IrFrames + dsp::Convolver::BlockFrames * 4;
+        const auto ir = makeNoise(IrFrames * 2, 2);
+        const auto input = makeNoise(Frames * 2, 3);
+        const auto expected = convolveDirect(input, ir, dsp::Convolver::BlockFrames);
+
+        const auto check = [&](const List<Float> &output) {
+            Double error = 0, peak = 0;
+            for (Size i = 0; i < output.size(); ++i)
+            {
+                error = std::max(error, std::abs(static_cast<Double>(output[i]) - expected[i]));
+                peak = std::max(peak, std::abs(static_cast<Double>(expected[i])));
+            }
+            CHECK(error < peak * 1e-5);
+        };
+
+        SUBCASE("Tails summed inline, in uneven buffers")
+        {
+            dsp::Convolver convolver;
+            convolver.prepare(ir.data(), IrFrames, 2, 2);
+            CHECK(convolver.getPartitionCount() == 10);
+
+            auto output = input;
+            for (Int64 offset = 0, size = 1; offset < Frames; offset += size, size = size * 3 % 700 + 1)
+            {
+                size = std::min(size, Frames - offset);
+                convolver.process(output.data() + offset * 2, size, 2, 1.f, 1.f);
+            }
+            check(output);
+        }
+
+        SUBCASE("Tails summed on a worker")
+        {
+            dsp::Convolver convolver;
+            convolver.prepare(ir.data(), IrFrames, 2, 2);
+
+            std::atomic<Bool> running{True};
+            std::thread worker([&]() {
+                while (running.load(std::memory_order_acquire))
+                    convolver.runPending();
+            });
+
+            auto output = input;
+            for (Int64 offset = 0; offset < Frames; offset += 128)
+                convolver.process(output.data() + offset * 2, std::min<Int64>(128, Frames - offset), 2, 1.f, 1.f);
+
+            running.store(False, std::memory_order_release);
+            worker.join();
+            check(output);
+        }
+
+        SUBCASE("Tails abandoned by a worker held mid-tail")
+        {
+            dsp::Convolver convolver;
+            convolver.prepare(ir.data(), IrFrames, 2, 2);
+
+            // The worker stops in the first partition it sums, until released
+            struct Hold {
+                std::atomic<Bool> entered{}, released{};
+            } hold;
+            std::atomic<Bool> running{True};
+            std::thread worker([&]() {
+                while (running.load(std::memory_order_acquire))
+                {
+                    convolver.runPending([](void *userdata) {
+                        const auto hold = static_cast<Hold *>(userdata);
+                        if (hold->entered.exchange(True, std::memory_order_acq_rel))
+                            return;
+                        while ( !hold->released.load(std::memory_order_acquire) )
+                            std::this_thread::yield();
+                    }, &hold);
+                }
+            });
+
+            // Every block must still be processed while the worker sits on a tail the audio side needs
+            auto output = input;
+            constexpr auto BlockFrames = dsp::Convolver::BlockFrames;
+            constexpr Int HoldBlocks = dsp::Convolver::HeadPartitions * 3;
+            Int heldBlocks = 0;
+            for (Int64 offset = 0; offset < Frames; offset += BlockFrames)
+            {
+                convolver.process(output.data() + offset * 2, std::min(BlockFrames, Frames - offset), 2, 1.f, 1.f);
+                while ( !hold.entered.load(std::memory_order_acquire) )
+                    std::this_thread::yield();
+
+                if ( !hold.released.load(std::memory_order_relaxed) && ++heldBlocks == HoldBlocks )
+                    hold.released.store(True, std::memory_order_release);
+            }
+
+            hold.released.store(True, std::memory_order_release);
+            running.store(False, std::memory_order_release);
+            worker.join();
+            CHECK(heldBlocks == HoldBlocks);
+            check(output);
+        }
+    }
+
+    TEST_CASE("Dry signal passes through at no wet")
+    {
+        const auto ir = makeNoise(dsp::Convolver::BlockFrames * 6, 4);
+        dsp::Convolver convolver;
+        convolver.prepare(ir.data(), dsp::Convolver::BlockFrames * 6, 1, 1);
+
+        const auto input = makeNoise(3000 * 3, 5);
+        auto output = input;
+        convolver.process(output.data(), 3000, 3, 0, 0);
+        CHECK(output == input);
+    }
+}
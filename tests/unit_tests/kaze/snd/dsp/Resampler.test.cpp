@@ -0,0 +1,127 @@
+#include <doctest/doctest.h>
+
+#include <kaze/snd/dsp/Resampler.h>
+
+#include <algorithm>
+#include <cmath>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+
+namespace {
+    /// Run `resampler` for `buffers` buffers of `frames` frames, feeding it input whose left and right channels
+    /// hold the input frame index and its negative
+    /// \returns every output frame's left channel
+    auto resampleRamp(dsp::Resampler &resampler, const Double rate, const Int64 frames, const Int buffers) -> List<Float>
+    {
+        List<Float> left;
+        List<Float> output(frames * 2);
+        Int64 inputFrame = 0;
+        for (Int i = 0; i < buffers; ++i)
+        {
+            const auto needed = resampler.getInputFramesNeeded(frames, rate);
+            auto input = resampler.prepareInput(needed);
+            for (Int64 k = 0; k < needed; ++k, ++inputFrame)
+            {
+                input[k * 2] = static_cast<Float>(inputFrame);
+                input[k * 2 + 1] = -static_cast<Float>(inputFrame);
+            }
+
+            resampler.process(output.data(), frames, rate);
+            for (Int64 k = 0; k < frames; ++k)
+                left.emplace_back(output[k * 2]);
+        }
+
+        return left;
+    }
+}
+
+TEST_SUITE("snd/dsp/Resampler")
+{
+    TEST_CASE("Linear quality interpolates between input frames")
+    {
+        dsp::Resampler resampler;
+        resampler.setQuality(ResampleQuality::Linear);
+
+        const auto output = resampleRamp(resampler, 0.75, 100, 5);
+        for (Size k = 0; k < output.size(); ++k)
+        {
+            CAPTURE(k);
+            CHECK(output[k] == doctest::Approx(0.75 * static_cast<Double>(k)));
+        }
+    }
+
+    TEST_CASE("Sinc quality follows a smooth input across buffers")
+    {
+        dsp::Resampler resampler;
+        const auto output = resampleRamp(resampler, 1.3, 64, 8);
+
+        // A ramp is reproduced once the window no longer reaches back into the silent start
+        for (Size k = 16; k < output.size(); ++k)
+        {
+            CAPTURE(k);
+            CHECK(output[k] == doctest::Approx(1.3 * static_cast<Double>(k)).epsilon(0.01));
+        }
+    }
+
+    TEST_CASE("Input is consumed at the resampling rate")
+    {
+        for (const auto quality : {ResampleQuality::Linear, ResampleQuality::Sinc})
+        {
+            dsp::Resampler resampler;
+            resampler.setQuality(quality);
+
+            Int64 consumed = 0;
+            List<Float> output(128 * 2);
+            for (Int i = 0; i < 32; ++i)
+            {
+                const auto needed = resampler.getInputFramesNeeded(128, 2.5);
+                std::fill_n(resampler.prepareInput(needed), needed * 2, 0.f);
+                resampler.process(output.data(), 128, 2.5);
+                consumed += needed;
+            }
+
+            // All but the frames read ahead for the window
+            CHECK(consumed - resampler.getBufferedFrames() == 32 * 128 * 5 / 2);
+        }
+    }
+
+    TEST_CASE("Draining plays out read-ahead input unchanged")
+    {
+        dsp::Resampler resampler;
+        resampleRamp(resampler, 2.0, 32, 1);
+
+        const auto buffered = resampler.getBufferedFrames();
+        REQUIRE(buffered > 0);
+
+        List<Float> output(buffered * 2 + 8);
+        CHECK(resampler.drain(output.data(), buffered + 4) == buffered);
+        for (Int64 k = 0; k < buffered; ++k)
+        {
+            CHECK(output[k * 2] == static_cast<Float>(64 + k));
+            CHECK(output[k * 2 + 1] == -static_cast<Float>(64 + k));
+        }
+
+        CHECK(resampler.getBufferedFrames() == 0);
+        CHECK(resampler.getInputFramesNeeded(0, 2.0) == 0);
+    }
+
+    TEST_CASE("Reserved input covers the fastest rate")
+    {
+        // Debug builds assert if `prepareInput` would grow past the reserve
+        for (const auto quality : {ResampleQuality::Linear, ResampleQuality::Sinc})
+        {
+            dsp::Resampler reserved, unreserved;
+            reserved.setQuality(quality);
+            unreserved.setQuality(quality);
+            reserved.reserve(256);
+            CHECK(reserved.getMaxFrames() == 256);
+
+            for (const auto rate : {dsp::Resampler::MaxRate, 1.7, dsp::Resampler::MinRate, dsp::Resampler::MaxRate})
+            {
+                CAPTURE(rate);
+                CHECK(resampleRamp(reserved, rate, 256, 4) == resampleRamp(unreserved, rate, 256, 4));
+            }
+        }
+    }
+}
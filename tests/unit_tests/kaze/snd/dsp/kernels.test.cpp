@@ -0,0 +1,320 @@
+#include <doctest/doctest.h>
+
+#include <kaze/snd/dsp/kernels.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+
+namespace {
+    /// Sample counts covering empty, sub-vector, odd, and multi-iteration lengths
+    constexpr Int64 Counts[] = {0, 2, 6, 14, 30, 62, 130, 1026};
+
+    /// Extra space for offsetting buffers out of alignment
+    constexpr Int64 Padding = 4;
+
+    auto makeNoise(const Int64 count, const Uint seed) -> List<Float>
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<Float> dist(-1.f, 1.f);
+        List<Float> samples(count + Padding);
+        for (auto &sample : samples)
+            sample = dist(rng);
+        return samples;
+    }
+
+    auto isBitExact(const List<Float> &a, const List<Float> &b) -> Bool
+    {
+        return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(Float)) == 0;
+    }
+
+    /// \returns every kernel set other than the scalar reference that can run on this machine
+    auto getVectorKernelSets() -> List< std::pair<const char *, const dsp::Kernels *> >
+    {
+        List< std::pair<const char *, const dsp::Kernels *> > sets;
+        const std::pair<const char *, dsp::KernelSet> candidates[] = {
+            {"SSE", dsp::KernelSet::SSE},
+            {"AVX2", dsp::KernelSet::AVX2},
+            {"Neon", dsp::KernelSet::Neon},
+            {"Wasm", dsp::KernelSet::Wasm},
+        };
+
+        for (const auto &[name, set] : candidates)
+        {
+            if (const auto kernels = dsp::getKernels(set))
+                sets.emplace_back(name, kernels);
+        }
+
+        return sets;
+    }
+}
+
+TEST_SUITE("snd/dsp/kernels")
+{
+    TEST_CASE("Scalar reference and selected kernels are available")
+    {
+        REQUIRE(dsp::getKernels(dsp::KernelSet::Scalar) != nullptr);
+        CHECK(dsp::getKernels(dsp::getKernelSet()) == &dsp::getKernels());
+    }
+
+    TEST_CASE("Vector kernels are bit-exact with the scalar reference")
+    {
+        const auto &ref = *dsp::getKernels(dsp::KernelSet::Scalar);
+
+        for (const auto &[name, kernels] : getVectorKernelSets())
+        {
+            CAPTURE(name);
+            for (const auto count : Counts)
+            {
+                CAPTURE(count);
+                for (const Int64 offset : {0, 1}) // aligned and unaligned buffers
+                {
+                    CAPTURE(offset);
+                    const auto a = makeNoise(count, 1), b = makeNoise(count, 2);
+                    const auto c = makeNoise(count, 3), d = makeNoise(count, 4);
+                    const auto dest = makeNoise(count, 5);
+
+                    {
+                        INFO("mix");
+                        auto expected = dest, actual = dest;
+                        ref.mix(expected.data() + offset, a.data() + offset, count);
+                        kernels->mix(actual.data() + offset, a.data() + offset, count);
+                        CHECK(isBitExact(expected, actual));
+                    }
+
+                    {
+                        INFO("mix4");
+                        auto expected = dest, actual = dest;
+                        ref.mix4(expected.data() + offset, a.data() + offset, b.data() + offset,
+                            c.data() + offset, d.data() + offset, count);
+                        kernels->mix4(actual.data() + offset, a.data() + offset, b.data() + offset,
+                            c.data() + offset, d.data() + offset, count);
+                        CHECK(isBitExact(expected, actual));
+                    }
+
+                    {
+                        INFO("scale");
+                        auto expected = dest, actual = dest;
+                        ref.scale(a.data() + offset, expected.data() + offset, 0.3f, count);
+                        kernels->scale(a.data() + offset, actual.data() + offset, 0.3f, count);
+                        CHECK(isBitExact(expected, actual));
+                    }
+
+                    {
+                        INFO("pan");
+                        auto expected = dest, actual = dest;
+                        ref.pan(a.data() + offset, expected.data() + offset, 0.7f, 0.2f, count);
+                        kernels->pan(a.data() + offset, actual.data() + offset, 0.7f, 0.2f, count);
+                        CHECK(isBitExact(expected, actual));
+
+                        INFO("in place");
+                        auto inPlace = a;
+                        kernels->pan(inPlace.data() + offset, inPlace.data() + offset, 0.7f, 0.2f, count);
+                        CHECK(std::equal(inPlace.begin() + offset, inPlace.begin() + offset + count,
+                            expected.begin() + offset));
+                    }
+
+                    {
+                        INFO("delay");
+                        auto expected = dest, actual = dest;
+                        auto expectedBuffer = b, actualBuffer = b;
+                        ref.delay(a.data() + offset, expected.data() + offset, expectedBuffer.data() + offset,
+                            0.6f, 0.4f, 0.35f, count);
+                        kernels->delay(a.data() + offset, actual.data() + offset, actualBuffer.data() + offset,
+                            0.6f, 0.4f, 0.35f, count);
+                        CHECK(isBitExact(expected, actual));
+                        CHECK(isBitExact(expectedBuffer, actualBuffer));
+                    }
+
+                    for (const Int channels : {1, 2, 6})
+                    {
+                        INFO("fade, channels: " << channels);
+                        auto expected = dest, actual = dest;
+                        ref.fade(expected.data() + offset, count / channels, channels, 37, 0.25f, 0.5f / 48000);
+                        kernels->fade(actual.data() + offset, count / channels, channels, 37, 0.25f, 0.5f / 48000);
+                        CHECK(isBitExact(expected, actual));
+                    }
+
+                    for (const Int channels : {1, 2, 6})
+                    {
+                        INFO("peak, channels: " << channels);
+                        auto expected = dest, actual = dest;
+                        ref.peak(a.data() + offset, expected.data() + offset, count / channels, channels);
+                        kernels->peak(a.data() + offset, actual.data() + offset, count / channels, channels);
+                        CHECK(isBitExact(expected, actual));
+                    }
+
+                    {
+                        INFO("spatialize");
+                        const auto positions = makeNoise(count * 4, 13), shape = makeNoise(count * 7, 14);
+                        List<Float> radius(count), squared(count), inner(count), outer(count), rolloff(count),
+                            constant(count), slope(count);
+                        for (Int64 i = 0; i < count; ++i)
+                        {
+                            radius[i] = std::abs(shape[i]) + .01f;
+                            squared[i] = static_cast<Float>(i % 2);
+                            inner[i] = std::abs(shape[count + i]);
+                            outer[i] = inner[i] + std::abs(shape[count * 2 + i]) * 10.f;
+                            rolloff[i] = std::abs(shape[count * 3 + i]) * 2.f;
+                            constant[i] = std::abs(shape[count * 4 + i]) + .1f;
+                            slope[i] = i % 3 == 0 ? 0 : std::abs(shape[count * 5 + i]);
+                        }
+
+                        // Emitters spread over a few units around the listener, some inside their radius
+                        const dsp::SpatialEmitters emitters{
+                            .x = positions.data() + offset, .y = positions.data() + count + offset,
+                            .velocityX = positions.data() + count * 2, .velocityY = positions.data() + count * 3,
+                            .radius = radius.data(), .squared = squared.data(), .inner = inner.data(),
+                            .outer = outer.data(), .rolloff = rolloff.data(), .offset = constant.data(),
+                            .slope = slope.data(), .count = count - offset,
+                        };
+                        const dsp::SpatialListener listener{.x = .1f, .y = -.2f, .rightX = .6f, .rightY = .8f,
+                            .time = .02f};
+
+                        auto expectedLeft = dest, actualLeft = dest, expectedRight = b, actualRight = b;
+                        ref.spatialize(emitters, listener, expectedLeft.data() + offset,
+                            expectedRight.data() + offset);
+                        kernels->spatialize(emitters, listener, actualLeft.data() + offset,
+                            actualRight.data() + offset);
+                        CHECK(isBitExact(expectedLeft, actualLeft));
+                        CHECK(isBitExact(expectedRight, actualRight));
+                    }
+
+                    for (const auto [srcChannels, destChannels] : {std::pair{1, 2}, {2, 2}, {1, 6}, {2, 6}})
+                    {
+                        INFO("mixPanned, " << srcChannels << " -> " << destChannels);
+                        const auto frames = count / std::max(srcChannels, destChannels);
+                        auto expected = dest, actual = dest;
+                        ref.mixPanned(expected.data() + offset, destChannels, a.data() + offset, srcChannels, frames,
+                            29, 0.3f, 0.9f, 0.4f / 512, -0.7f / 512);
+                        kernels->mixPanned(actual.data() + offset, destChannels, a.data() + offset, srcChannels,
+                            frames, 29, 0.3f, 0.9f, 0.4f / 512, -0.7f / 512);
+                        CHECK(isBitExact(expected, actual));
+                    }
+
+                    // Every pass of the largest power of two that fits
+                    const auto size = count >= 2 ? static_cast<Int64>(std::bit_floor(static_cast<Uint64>(count))) : 0;
+                    for (Int64 half = 1; half < size; half *= 2)
+                    {
+                        INFO("fftPass, half: " << half);
+                        const auto twiddleRe = makeNoise(half, 13), twiddleIm = makeNoise(half, 14);
+                        auto expectedRe = dest, actualRe = dest, expectedIm = c, actualIm = c;
+                        ref.fftPass(expectedRe.data() + offset, expectedIm.data() + offset, twiddleRe.data(),
+                            twiddleIm.data(), half, size);
+                        kernels->fftPass(actualRe.data() + offset, actualIm.data() + offset, twiddleRe.data(),
+                            twiddleIm.data(), half, size);
+                        CHECK(isBitExact(expectedRe, actualRe));
+                        CHECK(isBitExact(expectedIm, actualIm));
+                    }
+
+                    {
+                        INFO("truePeak");
+                        const auto coefs = makeNoise(dsp::TruePeakPhases * dsp::TruePeakTaps, 9);
+                        const auto frames = std::max<Int64>(count - (dsp::TruePeakTaps - 1), 0);
+                        const auto expected = ref.truePeak(a.data() + offset, frames, coefs.data());
+                        const auto actual = kernels->truePeak(a.data() + offset, frames, coefs.data());
+                        CHECK(std::bit_cast<Uint>(expected) == std::bit_cast<Uint>(actual));
+                    }
+
+                    {
+                        INFO("spectrumMac");
+                        auto expectedRe = dest, actualRe = dest, expectedIm = c, actualIm = c;
+                        ref.spectrumMac(expectedRe.data() + offset, expectedIm.data() + offset, a.data() + offset,
+                            b.data() + offset, d.data() + offset, a.data() + Padding, count);
+                        kernels->spectrumMac(actualRe.data() + offset, actualIm.data() + offset, a.data() + offset,
+                            b.data() + offset, d.data() + offset, a.data() + Padding, count);
+                        CHECK(isBitExact(expectedRe, actualRe));
+                        CHECK(isBitExact(expectedIm, actualIm));
+                    }
+
+                    for (const auto [srcChannels, destChannels] : {std::pair{1, 2}, {2, 1}, {1, 6}, {2, 6}, {2, 8}, {6, 2}})
+                    {
+                        INFO("mixMatrix, " << srcChannels << " -> " << destChannels);
+                        const auto matrix = makeNoise(srcChannels * destChannels, 8);
+                        const auto frames = count / std::max(srcChannels, destChannels);
+                        auto expected = dest, actual = dest;
+                        ref.mixMatrix(expected.data() + offset, destChannels, a.data() + offset, srcChannels,
+                            matrix.data(), frames);
+                        kernels->mixMatrix(actual.data() + offset, destChannels, a.data() + offset, srcChannels,
+                            matrix.data(), frames);
+                        CHECK(isBitExact(expected, actual));
+                    }
+
+                    for (const Int channels : {1, 2, 6})
+                    {
+                        INFO("biquad, channels: " << channels);
+                        const dsp::BiquadCoefs coefs[] = {
+                            {0.2f, 0.4f, 0.2f, -0.6f, 0.3f},
+                            {0.9f, -1.5f, 0.7f, -1.4f, 0.55f},
+                            {1.1f, -0.3f, 0.05f, 0.2f, -0.1f},
+                        };
+                        const auto initialState = makeNoise(3 * channels * 2, 9);
+                        auto expected = dest, actual = dest;
+                        auto expectedState = initialState, actualState = initialState;
+                        ref.biquad(expected.data() + offset, count / channels, channels, coefs, 3,
+                            expectedState.data());
+                        kernels->biquad(actual.data() + offset, count / channels, channels, coefs, 3,
+                            actualState.data());
+                        CHECK(isBitExact(expected, actual));
+                        CHECK(isBitExact(expectedState, actualState));
+                    }
+
+                    {
+                        INFO("fdn");
+                        // Short lines, so that the ring wraps and feeds back within the longer counts
+                        constexpr Uint64 RingFrames = 64;
+                        const auto initialLines = makeNoise(RingFrames * dsp::FdnLines, 10);
+                        const auto gains = makeNoise(dsp::FdnLines * 4, 11);
+                        const auto lowpass = makeNoise(dsp::FdnLines, 12);
+
+                        const auto makeState = [&](List<Float> &lines) {
+                            dsp::FdnState state{.lines = lines.data(), .mask = RingFrames - 1, .position = 61,
+                                .delays = {1, 7, 13, 22, 31, 40, 52, 63}, .damping = 0.45f};
+                            for (Int i = 0; i < dsp::FdnLines; ++i)
+                            {
+                                state.inputGains[i] = gains[i];
+                                state.feedbackGains[i] = std::abs(gains[dsp::FdnLines + i]) * 0.9f;
+                                state.leftGains[i] = gains[dsp::FdnLines * 2 + i];
+                                state.rightGains[i] = gains[dsp::FdnLines * 3 + i];
+                                state.lowpass[i] = lowpass[i];
+                            }
+                            return state;
+                        };
+
+                        auto expectedLines = initialLines, actualLines = initialLines;
+                        auto expectedState = makeState(expectedLines), actualState = makeState(actualLines);
+                        auto expectedLeft = dest, actualLeft = dest, expectedRight = dest, actualRight = dest;
+                        ref.fdn(a.data() + offset, expectedLeft.data() + offset, expectedRight.data() + offset,
+                            count, &expectedState);
+                        kernels->fdn(a.data() + offset, actualLeft.data() + offset, actualRight.data() + offset,
+                            count, &actualState);
+                        CHECK(isBitExact(expectedLeft, actualLeft));
+                        CHECK(isBitExact(expectedRight, actualRight));
+                        CHECK(isBitExact(expectedLines, actualLines));
+                        CHECK(std::memcmp(expectedState.lowpass, actualState.lowpass, sizeof(expectedState.lowpass))
+                            == 0);
+                        CHECK(expectedState.position == actualState.position);
+                    }
+
+                    {
+                        INFO("resampleStereo");
+                        const auto input = makeNoise(count * 2 + dsp::ResampleTaps * 2, 6);
+                        const auto table = makeNoise(dsp::ResamplePhases * dsp::ResampleTaps * 2, 7);
+                        constexpr auto Step = static_cast<Uint64>(1.37 * 4294967296.0);
+                        auto expected = dest, actual = dest;
+                        ref.resampleStereo(expected.data() + offset, count / 2, input.data() + offset,
+                            0x12345678, Step, table.data());
+                        kernels->resampleStereo(actual.data() + offset, count / 2, input.data() + offset,
+                            0x12345678, Step, table.data());
+                        CHECK(isBitExact(expected, actual));
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#include <doctest/doctest.h>
+
+#include <kaze/snd/AudioEngine.h>
+#include <kaze/snd/effects/CompressorEffect.h>
+#include <kaze/snd/sources/AudioBus.h>
+#include <kaze/snd/sources/PCMSource.h>
+
+#include <testing.h>
+
+#include <cmath>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+using namespace testing;
+
+TEST_SUITE("snd/effects/CompressorEffect")
+{
+    TEST_CASE("Compressors duck under a sidechain tap")
+    {
+        constexpr Int BufferFrames = 512, Buffers = 40;
+        const auto wav = makeSineWav(48000, 48000);
+
+        // Energy of a music bus compressed by the level of a voice that is itself muted
+        const auto render = [&wav](const Bool playKey, Float *outGainReduction) -> Double {
+            const auto output = renderOffline({.samplerate = 48000, .bufferFrameSize = BufferFrames},
+                [&](AudioEngine &engine) {
+                    const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()), Sound::Decoded);
+
+                    const auto music = engine.createBus(False);
+                    const auto compressor = music->addEffect<CompressorEffect>(0, -30.f, 10.f, 1.f, 50.f, 0);
+                    REQUIRE(compressor);
+                    REQUIRE(engine.playSound(sound, False, music));
+
+                    if (playKey)
+                    {
+                        const auto mutedBus = engine.createBus(False);
+                        mutedBus->setVolume(0);
+                        const auto key = engine.playSound(sound, True, mutedBus);
+                        REQUIRE(key);
+                        key->setSidechainTap(0);
+                        key->setPaused(False);
+                    }
+
+                    return [compressor, outGainReduction](const Int i) {
+                        if (i == Buffers - 1)
+                            *outGainReduction = compressor->gainReduction();
+                    };
+                }, Buffers);
+
+            Double energy = 0;
+            for (auto i = output.size() / 2; i < output.size(); ++i)
+                energy += static_cast<Double>(output[i]) * output[i];
+            return energy;
+        };
+
+        Float dryReduction, duckedReduction;
+        const auto dry = render(False, &dryReduction);
+        const auto ducked = render(True, &duckedReduction);
+        CHECK(dryReduction == 0);
+        CHECK(duckedReduction > 10.f);
+        CHECK(10.0 * std::log10(dry / ducked) > 10.0);
+    }
+}
@@ -0,0 +1,60 @@
+#include <doctest/doctest.h>
+
+#include <kaze/snd/AudioEngine.h>
+#include <kaze/snd/dsp/Convolver.h>
+#include <kaze/snd/effects/ConvolutionEffect.h>
+#include <kaze/snd/sources/AudioBus.h>
+
+#include <testing.h>
+
+#include <algorithm>
+#include <cmath>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+using namespace testing;
+
+TEST_SUITE("snd/effects/ConvolutionEffect")
+{
+    TEST_CASE("Convolution places echoes of the impulse response one block late")
+    {
+        constexpr Int BufferFrames = 512, Buffers = 60;
+        const auto click = makeWav(48000, 480, 2, [](const Int i) { return i == 0 ? 16000 : 0; });
+
+        // Echoes at half and a quarter of the direct sound, the last well into the worker's partitions
+        const auto impulse = makeWav(48000, 20001, 2, [](const Int i) {
+            return i == 0 ? 16000 : i == 3000 ? 8000 : i == 20000 ? 4000 : 0;
+        });
+
+        const auto response = renderOffline({.samplerate = 48000, .bufferFrameSize = BufferFrames},
+            [&](AudioEngine &engine) {
+                const auto bus = engine.createBus(False);
+                const auto convolution = bus->addEffect<ConvolutionEffect>(0, 1.f);
+                REQUIRE(convolution);
+                REQUIRE(convolution->loadImpulse(MemView<void>(impulse.data(), impulse.size()), False));
+                CHECK(convolution->getImpulseFrames() == 20001);
+
+                const auto sound = engine.createSound(MemView<void>(click.data(), click.size()), Sound::Decoded);
+                REQUIRE(engine.playSound(sound, False, bus));
+            }, Buffers);
+
+        const auto it = std::find_if(response.begin(), response.end(), [](const Float x) {
+            return std::abs(x) > 1e-3f;
+        });
+        REQUIRE(it != response.end());
+        const auto first = static_cast<Size>(it - response.begin()) / 2;
+        CHECK(first >= dsp::Convolver::BlockFrames);
+
+        const auto direct = response[first * 2];
+        REQUIRE(direct > 0);
+        CHECK(response[first * 2 + 1] == doctest::Approx(direct).epsilon(1e-4));
+        CHECK(response[(first + 3000) * 2] == doctest::Approx(direct * .5f).epsilon(1e-3));
+        CHECK(response[(first + 20000) * 2] == doctest::Approx(direct * .25f).epsilon(1e-3));
+
+        // Silence between the echoes
+        Float between = 0;
+        for (auto i = first + 1; i < first + 2990; ++i)
+            between = std::max(between, std::abs(response[i * 2]));
+        CHECK(between < direct * 1e-3f);
+    }
+}
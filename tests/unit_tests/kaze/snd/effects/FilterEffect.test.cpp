@@ -0,0 +1,46 @@
+#include <doctest/doctest.h>
+
+#include <kaze/snd/AudioEngine.h>
+#include <kaze/snd/effects/FilterEffect.h>
+#include <kaze/snd/sources/PCMSource.h>
+
+#include <testing.h>
+
+#include <cmath>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+using namespace testing;
+
+TEST_SUITE("snd/effects/FilterEffect")
+{
+    TEST_CASE("Filters attenuate outside their pass band")
+    {
+        constexpr Int BufferFrames = 256;
+        const auto wav = makeSineWav(48000, 48000); // about 380 Hz
+
+        // RMS of the left channel after the filter has settled
+        const auto render = [&wav](const FilterType type, const Float frequency) -> Double {
+            const auto output = renderOffline({.samplerate = 48000, .bufferFrameSize = BufferFrames},
+                [&](AudioEngine &engine) {
+                    const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()), Sound::Decoded);
+                    const auto voice = engine.playSound(sound);
+                    REQUIRE(voice);
+                    if (type != FilterType::Count)
+                        REQUIRE(voice->addEffect<FilterEffect>(2, type, frequency, 0.7071f, 0.f, 2));
+                }, 16);
+
+            Double sum = 0;
+            Int64 count = 0;
+            for (auto i = static_cast<Size>(BufferFrames * 8) * 2; i < output.size(); i += 2, ++count)
+                sum += output[i] * output[i];
+            return std::sqrt(sum / static_cast<Double>(count));
+        };
+
+        const auto dry = render(FilterType::Count, 0);
+        REQUIRE(dry > 0);
+        CHECK(render(FilterType::LowPass, 100.f) < dry * 0.05);
+        CHECK(render(FilterType::HighPass, 100.f) > dry * 0.9);
+        CHECK(render(FilterType::LowPass, 4000.f) > dry * 0.9);
+    }
+}
@@ -0,0 +1,48 @@
+#include <doctest/doctest.h>
+
+#include <kaze/snd/AudioEngine.h>
+#include <kaze/snd/effects/LimiterEffect.h>
+#include <kaze/snd/sources/AudioBus.h>
+
+#include <testing.h>
+
+#include <algorithm>
+#include <cmath>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+using namespace testing;
+
+TEST_SUITE("snd/effects/LimiterEffect")
+{
+    TEST_CASE("Limiters on the master bus hold peaks under their ceiling")
+    {
+        constexpr Int Buffers = 40;
+        const auto wav = makeSineWav(48000, 48000);
+
+        Float gainReduction = 0;
+        const auto output = renderOffline({.samplerate = 48000, .bufferFrameSize = 512}, [&](AudioEngine &engine) {
+            const auto limiter = engine.getMasterBus()->addEffect<LimiterEffect>(0, -6.f, 50.f, 5);
+            REQUIRE(limiter);
+
+            // Eight voices in phase peak near 2, four times the ceiling
+            const auto sound = engine.createSound(MemView<void>(wav.data(), wav.size()), Sound::Decoded);
+            for (Int i = 0; i < 8; ++i)
+                REQUIRE(engine.playSound(sound));
+
+            return [limiter, &gainReduction](const Int i) {
+                if (i == Buffers - 1)
+                    gainReduction = limiter->gainReduction();
+            };
+        }, Buffers);
+
+        Float peak = 0;
+        for (const auto sample : output)
+            peak = std::max(peak, std::abs(sample));
+
+        const auto ceiling = std::pow(10.f, -6.f / 20.f);
+        CHECK(peak <= ceiling);
+        CHECK(peak > ceiling * .9f);
+        CHECK(gainReduction == doctest::Approx(12.0).epsilon(.1));
+    }
+}
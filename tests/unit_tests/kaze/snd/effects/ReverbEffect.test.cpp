@@ -0,0 +1,77 @@
+#include <doctest/doctest.h>
+
+#include <kaze/snd/AudioEngine.h>
+#include <kaze/snd/effects/ReverbEffect.h>
+#include <kaze/snd/sources/AudioBus.h>
+
+#include <testing.h>
+
+#include <algorithm>
+#include <cmath>
+
+USING_KAZE_NAMESPACE;
+using namespace KSND_NS;
+using namespace testing;
+
+TEST_SUITE("snd/effects/ReverbEffect")
+{
+    TEST_CASE("Reverb tails decay by 60 dB over their decay time")
+    {
+        constexpr Int BufferFrames = 512, Buffers = 188; // two seconds
+        const auto click = makeWav(48000, 480, 2, [](const Int i) { return i == 0 ? 16000 : 0; });
+
+        // Fully wet impulse response of a reverb on a bus, interleaved in stereo
+        const auto render = [&click](const Float decayTime, const Int preDelay) -> List<Float> {
+            return renderOffline({.samplerate = 48000, .bufferFrameSize = BufferFrames}, [&](AudioEngine &engine) {
+                const auto bus = engine.createBus(False);
+                REQUIRE(bus->addEffect<ReverbEffect>(0, decayTime, 0.f, 1.f, preDelay, 1.f));
+                const auto sound = engine.createSound(MemView<void>(click.data(), click.size()), Sound::Decoded);
+                REQUIRE(engine.playSound(sound, False, bus));
+            }, Buffers);
+        };
+
+        // Drop in dB of the energy left in the tail from one time to another, by backward integration
+        const auto getDecay = [](const List<Float> &response, const Double from, const Double to) -> Double {
+            const auto getEnergyAfter = [&response](const Double seconds) {
+                Double energy = 0;
+                for (auto i = static_cast<Size>(seconds * 48000) * 2; i < response.size(); ++i)
+                    energy += static_cast<Double>(response[i]) * response[i];
+                return energy;
+            };
+            return 10.0 * std::log10(getEnergyAfter(from) / getEnergyAfter(to));
+        };
+
+        const auto getFirstSound = [](const List<Float> &response) -> Size {
+            const auto it = std::find_if(response.begin(), response.end(), [](const Float x) { return x != 0; });
+            return static_cast<Size>(it - response.begin()) / 2;
+        };
+
+        const auto shortTail = render(1.f, 0);
+        const auto longTail = render(2.f, 0);
+        for (const auto &response : {shortTail, longTail})
+        {
+            CHECK(std::all_of(response.begin(), response.end(), [](const Float x) { return std::isfinite(x); }));
+        }
+
+        // Over half a second, a 1 s tail falls by 30 dB and a 2 s tail by 15 dB
+        CHECK(getDecay(shortTail, .2, .7) == doctest::Approx(30.0).epsilon(.15));
+        CHECK(getDecay(longTail, .2, .7) == doctest::Approx(15.0).epsilon(.15));
+
+        // Both sides carry the tail, but different ones
+        Double leftEnergy = 0, rightEnergy = 0, crossEnergy = 0;
+        for (Size i = 0; i < shortTail.size(); i += 2)
+        {
+            leftEnergy += static_cast<Double>(shortTail[i]) * shortTail[i];
+            rightEnergy += static_cast<Double>(shortTail[i + 1]) * shortTail[i + 1];
+            crossEnergy += static_cast<Double>(shortTail[i]) * shortTail[i + 1];
+        }
+        REQUIRE(leftEnergy > 0);
+        REQUIRE(rightEnergy > 0);
+        CHECK(std::abs(crossEnergy) / std::sqrt(leftEnergy * rightEnergy) < 0.3);
+
+        // Pre-delay holds back the first echo
+        const auto first = getFirstSound(shortTail);
+        CHECK(first < 2400);
+        CHECK(getFirstSound(render(1.f, 50)) >= first + 2400);
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <doctest/doctest.h>
+
+#include <kaze/core/lib.h>
+
+#include <kaze/snd/AudioEngine.h>
+#include <kaze/snd/backend/offline/OfflineAudioDevice.h>
+
+#include <wav.h>
+
+#include <type_traits>
+
+namespace testing {
+    USING_KAZE_NAMESPACE;
+
+    /// Open an engine on an offline device and render a number of buffers from it, updating the engine after each.
+    /// \param[in]  init     engine parameters
+    /// \param[in]  setup    called with the open engine to create its sources and effects. It may return a callback,
+    ///                      which is called with the buffer index before each buffer is rendered.
+    /// \param[in]  buffers  number of buffers of `init.bufferFrameSize` frames to render
+    /// \returns every rendered sample, interleaved in the engine's output channels
+    template <typename TSetup>
+    auto renderOffline(const snd::AudioEngineInit &init, TSetup setup, const Int buffers) -> List<Float>
+    {
+        const auto device = new snd::OfflineAudioDevice;
+        snd::AudioEngine engine(device);
+        REQUIRE(engine.open(init));
+
+        List<Float> output;
+        const auto render = [&](auto &&beforeBuffer) {
+            output.reserve(static_cast<Size>(buffers) * init.bufferFrameSize * engine.getSpec().channels);
+            for (Int i = 0; i < buffers; ++i)
+            {
+                beforeBuffer(i);
+                REQUIRE(device->render(init.bufferFrameSize) == init.bufferFrameSize);
+                engine.update();
+
+                const auto samples = reinterpret_cast<const Float *>(device->getBuffer().data());
+                output.insert(output.end(), samples, samples + device->getBuffer().size() / sizeof(Float));
+            }
+        };
+
+        if constexpr (std::is_void_v<decltype(setup(engine))>)
+        {
+            setup(engine);
+            render([](Int) { });
+        }
+        else
+        {
+            render(setup(engine));
+        }
+
+        engine.close();
+        return output;
+    }
+}
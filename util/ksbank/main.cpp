@@ -0,0 +1,132 @@
+/// ksbank: packs sound files into a kaze sound bank
+///
+/// Usage: ksbank -o <bank> [name=]<path>...
+///   Each path is a sound file, named after its file name without extension unless a name is given, or a directory,
+///   whose sound files are added recursively and named by their path relative to it, e.g. `ui/click`, under an
+///   optional `name/` prefix.
+#include <kaze/core/main.h>
+#include <kaze/core/errors.h>
+#include <kaze/snd/SoundBankBuilder.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+
+USING_KAZE_NAMESPACE;
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr const char *Extensions[] = {".wav", ".flac", ".mp3", ".ogg"};
+
+    auto printUsage() -> void
+    {
+        std::fprintf(stderr,
+            "usage: ksbank -o <bank> [name=]<path>...\n"
+            "  path  sound file (.wav, .flac, .mp3, .ogg), named after its file name without extension,\n"
+            "        or directory of sound files, named by their path relative to it without extension\n"
+            "  name  name to look the sound up by instead of its file name, or prefix for a directory's sounds\n");
+    }
+
+    auto printError(const String &context) -> void
+    {
+        std::fprintf(stderr, "ksbank: %s: %s\n", context.c_str(), getError().message.c_str());
+    }
+
+    auto isSoundFile(const fs::path &path) -> Bool
+    {
+        auto extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+            [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return std::find(std::begin(Extensions), std::end(Extensions), extension) != std::end(Extensions);
+    }
+
+    auto addPath(snd::SoundBankBuilder &builder, const String &arg) -> Bool
+    {
+        String name;
+        fs::path path = arg;
+        if (const auto equals = arg.find('='); equals != String::npos)
+        {
+            name = arg.substr(0, equals);
+            path = arg.substr(equals + 1);
+        }
+
+        if ( !fs::is_directory(path) )
+        {
+            if (name.empty())
+                name = path.stem().string();
+            if ( !builder.addFile(name, path.string()) )
+            {
+                printError(path.string());
+                return False;
+            }
+
+            return True;
+        }
+
+        // Sort for the same bank on every file system
+        List<fs::path> files;
+        for (const auto &entry : fs::recursive_directory_iterator(path))
+        {
+            if (entry.is_regular_file() && isSoundFile(entry.path()))
+                files.emplace_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+
+        for (const auto &file : files)
+        {
+            auto fileName = fs::relative(file, path).replace_extension().generic_string();
+            if ( !name.empty() )
+                fileName = name + "/" + fileName;
+
+            if ( !builder.addFile(fileName, file.string()) )
+            {
+                printError(file.string());
+                return False;
+            }
+        }
+
+        return True;
+    }
+}
+
+auto kaze::kmain(int argc, char *argv[]) -> Int
+{
+    String outputPath;
+    List<String> inputs;
+    for (int i = 1; i < argc; ++i)
+    {
+        const String arg = argv[i];
+        if (arg == "-o" && i + 1 < argc)
+            outputPath = argv[++i];
+        else if (arg == "-h" || arg == "--help")
+        {
+            printUsage();
+            return 0;
+        }
+        else
+            inputs.emplace_back(arg);
+    }
+
+    if (outputPath.empty() || inputs.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    snd::SoundBankBuilder builder;
+    for (const auto &input : inputs)
+    {
+        if ( !addPath(builder, input) )
+            return 1;
+    }
+
+    if ( !builder.write(outputPath) )
+    {
+        printError(outputPath);
+        return 1;
+    }
+
+    std::printf("ksbank: wrote %d sounds to %s\n", builder.getCount(), outputPath.c_str());
+    return 0;
+}